@@ -51,6 +51,11 @@ class MockEtcdClientImpl : public curve::kvstorage::KVStorageClient {
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
                                      const std::string&));
+    MOCK_METHOD3(GetWithModRevision,
+                 int(const std::string&, std::string*, int64_t*));
+    MOCK_METHOD3(TxnNWithCompare,
+                 int(const std::vector<Compare>&,
+                     const std::vector<Operation>&, int64_t*));
     MOCK_METHOD1(GetCurrentRevision, int(int64_t*));
     MOCK_METHOD6(ListWithLimitAndRevision,
                  int(const std::string&, const std::string&, int64_t, int64_t,
@@ -173,6 +173,24 @@ int AioRead(int fd, CurveAioContext* aioctx);
  */
 int AioWrite(int fd, CurveAioContext* aioctx);
 
+/**
+ * @brief Asynchronous vectored read, data is read into iov directly
+ * @param fd file descriptor
+ * @param aioctx async request context, buf and length are set by iov
+ * @param iov scatter buffers, must be kept valid until callback
+ * @return 0 means success, otherwise it means failure
+ */
+int AioReadv(int fd, CurveAioContext* aioctx, CurveIOVector* iov);
+
+/**
+ * @brief Asynchronous vectored write, iov is sent without being linearized
+ * @param fd file descriptor
+ * @param aioctx async request context, buf and length are set by iov
+ * @param iov gather buffers, must be kept valid until callback
+ * @return 0 means success, otherwise it means failure
+ */
+int AioWritev(int fd, CurveAioContext* aioctx, CurveIOVector* iov);
+
 /**
  * @brief Asynchronous discard operation
  * @param fd file descriptor
@@ -343,7 +361,8 @@ class FileClient;
 
 enum class UserDataType {
     RawBuffer,  // char*
-    IOBuffer   // butil::IOBuf*
+    IOBuffer,   // butil::IOBuf*
+    IOVector    // CurveIOVector*
 };
 
 // 存储用户信息
@@ -460,6 +479,24 @@ class CurveClient {
     virtual int AioWrite(int fd, CurveAioContext* aioctx,
                          UserDataType dataType);
 
+    /**
+     * @brief Async vectored read
+     * @param fd file descriptor
+     * @param aioctx async request context, buf and length are set by iov
+     * @param iov scatter buffers, must be kept valid until callback
+     * @return return error code, 0(LIBCURVE_ERROR::OK) means success
+     */
+    virtual int AioReadv(int fd, CurveAioContext* aioctx, CurveIOVector* iov);
+
+    /**
+     * @brief Async vectored write
+     * @param fd file descriptor
+     * @param aioctx async request context, buf and length are set by iov
+     * @param iov gather buffers, must be kept valid until callback
+     * @return return error code, 0(LIBCURVE_ERROR::OK) means success
+     */
+    virtual int AioWritev(int fd, CurveAioContext* aioctx, CurveIOVector* iov);
+
     /**
      * @brief Async Discard
      * @param fd file descriptor
@@ -26,6 +26,7 @@
 
 #include <unistd.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 enum LIBCURVE_ERROR {
     // success
@@ -116,4 +117,13 @@ typedef struct CurveAioContext {
     void*               buf;
 } CurveAioContext;
 
+/**
+ * scatter-gather buffers of a vectored io, used by AioReadv/AioWritev,
+ * iov and the buffers must be kept valid until the io callback is called
+ */
+typedef struct CurveIOVector {
+    const struct iovec* iov;
+    int                 iovcnt;
+} CurveIOVector;
+
 #endif  // INCLUDE_CLIENT_LIBCURVE_DEFINE_H_
@@ -0,0 +1,350 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#include "nebd/src/common/shm_ring.h"
+
+#include <errno.h>
+#include <glog/logging.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+
+namespace nebd {
+namespace common {
+
+namespace {
+
+constexpr size_t kCacheLineSize = 64;
+constexpr size_t kPageSize = 4096;
+constexpr uint32_t kMaxEntries = 65536;
+constexpr uint32_t kMaxSlotSize = 64 * 1024 * 1024;
+
+size_t RoundUp(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+bool IsPowerOfTwo(uint32_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+}  // namespace
+
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entries;
+    uint32_t slotSize;
+    // producer and consumer indexes are on separate cache lines
+    alignas(kCacheLineSize) std::atomic<uint32_t> sqHead;
+    alignas(kCacheLineSize) std::atomic<uint32_t> sqTail;
+    alignas(kCacheLineSize) std::atomic<uint32_t> cqHead;
+    alignas(kCacheLineSize) std::atomic<uint32_t> cqTail;
+};
+
+static size_t RequestsOffset() {
+    return RoundUp(sizeof(ShmRingHeader), kCacheLineSize);
+}
+
+static size_t CompletionsOffset(uint32_t entries) {
+    return RoundUp(RequestsOffset() + entries * sizeof(ShmRequest),
+                   kCacheLineSize);
+}
+
+static size_t DataOffset(uint32_t entries) {
+    return RoundUp(CompletionsOffset(entries) +
+                       entries * sizeof(ShmCompletion),
+                   kPageSize);
+}
+
+size_t ShmRing::MappingSize(uint32_t entries, uint32_t slotSize) {
+    return DataOffset(entries) + static_cast<size_t>(entries) * slotSize;
+}
+
+ShmRing::ShmRing(void* addr, size_t size)
+    : addr_(addr),
+      size_(size),
+      header_(static_cast<ShmRingHeader*>(addr)),
+      requests_(reinterpret_cast<ShmRequest*>(static_cast<char*>(addr) +
+                                              RequestsOffset())),
+      completions_(nullptr),
+      data_(nullptr),
+      entries_(header_->entries),
+      slotSize_(header_->slotSize) {
+    completions_ = reinterpret_cast<ShmCompletion*>(
+        static_cast<char*>(addr) + CompletionsOffset(entries_));
+    data_ = static_cast<char*>(addr) + DataOffset(entries_);
+}
+
+ShmRing::~ShmRing() {
+    munmap(addr_, size_);
+}
+
+ShmRing* ShmRing::Create(int memfd, uint32_t entries, uint32_t slotSize) {
+    if (!IsPowerOfTwo(entries) || entries > kMaxEntries || slotSize == 0 ||
+        slotSize > kMaxSlotSize) {
+        LOG(ERROR) << "Invalid shm ring option, entries = " << entries
+                   << ", slot size = " << slotSize;
+        return nullptr;
+    }
+
+    size_t size = MappingSize(entries, slotSize);
+    if (ftruncate(memfd, size) != 0) {
+        LOG(ERROR) << "Truncate shm failed, size = " << size
+                   << ", error = " << strerror(errno);
+        return nullptr;
+    }
+
+    void* addr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (addr == MAP_FAILED) {
+        LOG(ERROR) << "Map shm failed, size = " << size
+                   << ", error = " << strerror(errno);
+        return nullptr;
+    }
+
+    ShmRingHeader* header = new (addr) ShmRingHeader();
+    header->magic = kShmRingMagic;
+    header->version = kShmRingVersion;
+    header->entries = entries;
+    header->slotSize = slotSize;
+    header->sqHead.store(0, std::memory_order_relaxed);
+    header->sqTail.store(0, std::memory_order_relaxed);
+    header->cqHead.store(0, std::memory_order_relaxed);
+    header->cqTail.store(0, std::memory_order_relaxed);
+
+    return new ShmRing(addr, size);
+}
+
+ShmRing* ShmRing::Attach(int memfd) {
+    struct stat st;
+    if (fstat(memfd, &st) != 0) {
+        LOG(ERROR) << "Stat shm failed, error = " << strerror(errno);
+        return nullptr;
+    }
+
+    size_t size = st.st_size;
+    if (size < DataOffset(0)) {
+        LOG(ERROR) << "Shm is too small, size = " << size;
+        return nullptr;
+    }
+
+    void* addr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (addr == MAP_FAILED) {
+        LOG(ERROR) << "Map shm failed, size = " << size
+                   << ", error = " << strerror(errno);
+        return nullptr;
+    }
+
+    const ShmRingHeader* header = static_cast<const ShmRingHeader*>(addr);
+    if (header->magic != kShmRingMagic ||
+        header->version != kShmRingVersion ||
+        !IsPowerOfTwo(header->entries) || header->entries > kMaxEntries ||
+        header->slotSize == 0 || header->slotSize > kMaxSlotSize ||
+        MappingSize(header->entries, header->slotSize) > size) {
+        LOG(ERROR) << "Invalid shm header, magic = " << header->magic
+                   << ", version = " << header->version
+                   << ", entries = " << header->entries
+                   << ", slot size = " << header->slotSize
+                   << ", shm size = " << size;
+        munmap(addr, size);
+        return nullptr;
+    }
+
+    return new ShmRing(addr, size);
+}
+
+bool ShmRing::PushRequest(const ShmRequest& request) {
+    uint32_t tail = header_->sqTail.load(std::memory_order_relaxed);
+    uint32_t head = header_->sqHead.load(std::memory_order_acquire);
+    if (tail - head >= entries_) {
+        return false;
+    }
+
+    requests_[tail & (entries_ - 1)] = request;
+    header_->sqTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::PopRequest(ShmRequest* request) {
+    uint32_t head = header_->sqHead.load(std::memory_order_relaxed);
+    uint32_t tail = header_->sqTail.load(std::memory_order_acquire);
+    if (head == tail || tail - head > entries_) {
+        return false;
+    }
+
+    *request = requests_[head & (entries_ - 1)];
+    header_->sqHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::PushCompletion(const ShmCompletion& completion) {
+    uint32_t tail = header_->cqTail.load(std::memory_order_relaxed);
+    uint32_t head = header_->cqHead.load(std::memory_order_acquire);
+    if (tail - head >= entries_) {
+        return false;
+    }
+
+    completions_[tail & (entries_ - 1)] = completion;
+    header_->cqTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::PopCompletion(ShmCompletion* completion) {
+    uint32_t head = header_->cqHead.load(std::memory_order_relaxed);
+    uint32_t tail = header_->cqTail.load(std::memory_order_acquire);
+    if (head == tail || tail - head > entries_) {
+        return false;
+    }
+
+    *completion = completions_[head & (entries_ - 1)];
+    header_->cqHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+char* ShmRing::SlotData(uint32_t slot) const {
+    return data_ + static_cast<size_t>(slot) * slotSize_;
+}
+
+void NotifyEventFd(int efd) {
+    uint64_t value = 1;
+    ssize_t n = 0;
+    do {
+        n = write(efd, &value, sizeof(value));
+    } while (n < 0 && errno == EINTR);
+
+    LOG_IF(ERROR, n < 0 && errno != EAGAIN)
+        << "Notify eventfd failed, error = " << strerror(errno);
+}
+
+void DrainEventFd(int efd) {
+    uint64_t value = 0;
+    ssize_t n = 0;
+    do {
+        n = read(efd, &value, sizeof(value));
+    } while (n < 0 && errno == EINTR);
+}
+
+int SendWithFds(int sock, const void* buf, size_t len,
+                const int* fds, int nfds) {
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(buf);
+    iov.iov_len = len;
+
+    char control[CMSG_SPACE(sizeof(int) * kShmAttachFdNum)];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (nfds > 0) {
+        if (nfds > kShmAttachFdNum) {
+            return -1;
+        }
+
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    }
+
+    ssize_t n = 0;
+    do {
+        n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+
+    if (n != static_cast<ssize_t>(len)) {
+        LOG(ERROR) << "Send message failed, error = " << strerror(errno);
+        return -1;
+    }
+
+    return 0;
+}
+
+int RecvWithFds(int sock, void* buf, size_t len, int* fds, int nfds) {
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = len;
+
+    char control[CMSG_SPACE(sizeof(int) * kShmAttachFdNum)];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (nfds > 0) {
+        if (nfds > kShmAttachFdNum) {
+            return -1;
+        }
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+    }
+
+    ssize_t n = 0;
+    do {
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+
+    if (n != static_cast<ssize_t>(len)) {
+        LOG(ERROR) << "Receive message failed, received = " << n
+                   << ", error = " << strerror(errno);
+        return -1;
+    }
+
+    if (nfds == 0) {
+        return 0;
+    }
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS) {
+        LOG(ERROR) << "No fds received";
+        return -1;
+    }
+
+    int received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+    if (received != nfds || (msg.msg_flags & MSG_CTRUNC)) {
+        LOG(ERROR) << "Unexpected fds received, expected = " << nfds
+                   << ", received = " << received;
+        for (int i = 0; i < received; ++i) {
+            close(data[i]);
+        }
+        return -1;
+    }
+
+    memcpy(fds, data, sizeof(int) * nfds);
+    return 0;
+}
+
+}  // namespace common
+}  // namespace nebd
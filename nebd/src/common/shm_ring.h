@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#ifndef NEBD_SRC_COMMON_SHM_RING_H_
+#define NEBD_SRC_COMMON_SHM_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace nebd {
+namespace common {
+
+constexpr uint32_t kShmRingMagic = 0x4e454244;  // "NEBD"
+constexpr uint32_t kShmRingVersion = 1;
+
+enum class ShmRequestOp : uint32_t {
+    kRead = 0,
+    kWrite = 1,
+};
+
+struct ShmRingHeader;
+
+// part1提交给part2的请求描述符，数据位于slot对应的数据区
+struct ShmRequest {
+    uint32_t slot;
+    uint32_t op;
+    uint64_t offset;
+    uint64_t length;
+};
+
+// part2返回给part1的完成事件
+struct ShmCompletion {
+    uint32_t slot;
+    int32_t ret;
+};
+
+/**
+ * 共享内存布局：
+ * | header | request ring | completion ring | data slots |
+ *
+ * request ring只由part1写、part2读，completion ring只由part2写、part1读，
+ * 每个环都是单生产者单消费者，多线程生产时由调用方加锁。
+ * data slots与请求一一对应，同一时刻最多有entries个请求在处理中，
+ * 因此两个环都不会溢出。
+ */
+class ShmRing {
+ public:
+    ~ShmRing();
+
+    /**
+     * @brief 计算共享内存大小
+     * @param entries 请求槽数量，必须是2的幂
+     * @param slotSize 每个请求槽的数据区大小
+     */
+    static size_t MappingSize(uint32_t entries, uint32_t slotSize);
+
+    /**
+     * @brief 在memfd上创建并初始化共享内存
+     * @return 成功返回ShmRing，失败返回nullptr
+     */
+    static ShmRing* Create(int memfd, uint32_t entries, uint32_t slotSize);
+
+    /**
+     * @brief 映射对端创建的共享内存，并检查其布局
+     * @return 成功返回ShmRing，失败返回nullptr
+     */
+    static ShmRing* Attach(int memfd);
+
+    bool PushRequest(const ShmRequest& request);
+    bool PopRequest(ShmRequest* request);
+
+    bool PushCompletion(const ShmCompletion& completion);
+    bool PopCompletion(ShmCompletion* completion);
+
+    char* SlotData(uint32_t slot) const;
+
+    uint32_t Entries() const {
+        return entries_;
+    }
+
+    uint32_t SlotSize() const {
+        return slotSize_;
+    }
+
+ private:
+    ShmRing(void* addr, size_t size);
+
+    void* addr_;
+    size_t size_;
+    ShmRingHeader* header_;
+    ShmRequest* requests_;
+    ShmCompletion* completions_;
+    char* data_;
+    uint32_t entries_;
+    uint32_t slotSize_;
+};
+
+/**
+ * @brief 通知eventfd
+ */
+void NotifyEventFd(int efd);
+
+/**
+ * @brief 清空eventfd的计数
+ */
+void DrainEventFd(int efd);
+
+/**
+ * @brief 通过unix socket发送消息，同时传递文件描述符
+ * @return 成功返回0，失败返回-1
+ */
+int SendWithFds(int sock, const void* buf, size_t len,
+                const int* fds, int nfds);
+
+/**
+ * @brief 从unix socket接收消息和文件描述符
+ * @param[out] fds 接收到的文件描述符，数量必须与nfds一致
+ * @return 成功返回0，失败返回-1
+ */
+int RecvWithFds(int sock, void* buf, size_t len, int* fds, int nfds);
+
+// part1打开共享内存通道时发送给part2的握手消息，
+// 同时传递memfd、请求eventfd和完成eventfd
+struct ShmAttachRequest {
+    uint32_t magic;
+    int32_t fd;
+};
+
+struct ShmAttachResponse {
+    int32_t ret;
+};
+
+constexpr int kShmAttachFdNum = 3;
+
+// part1关闭通道前发送给part2的消息。part2收到后不再从请求环中取请求，
+// 等已经取出的请求全部完成、完成事件全部写入完成环之后再回复，
+// part1收到回复后才能将请求环中剩余的请求交给rpc通道重新发送
+struct ShmDetachRequest {
+    uint32_t magic;
+};
+
+struct ShmDetachResponse {
+    int32_t ret;
+};
+
+// part2共享内存通道的监听地址为rpc监听地址加上该后缀
+constexpr char kShmAddressSuffix[] = ".shm";
+
+}  // namespace common
+}  // namespace nebd
+
+#endif  // NEBD_SRC_COMMON_SHM_RING_H_
@@ -128,6 +128,16 @@ void NebdClient::Uninit() {
         heartbeatMgr_->Stop();
     }
 
+    // stop shm channels, requests part2 never picked up are resent by rpc
+    std::unordered_map<int, std::shared_ptr<ShmChannel>> shmChannels;
+    {
+        nebd::common::WriteLockGuard lk(shmLock_);
+        shmChannels.swap(shmChannels_);
+    }
+    for (auto& channel : shmChannels) {
+        channel.second->Stop();
+    }
+
     // stop exec queue
     for (auto& q : rpcTaskQueues_) {
         bthread::execution_queue_stop(q);
@@ -195,10 +205,13 @@ int NebdClient::Open(const char* filename, const NebdOpenFlags* flags) {
     }
 
     metaCache_->AddFileInfo({fd, filename, fileLock});
+    OpenShmChannel(fd);
     return fd;
 }
 
 int NebdClient::Close(int fd) {
+    CloseShmChannel(fd);
+
     auto task = [&](brpc::Controller* cntl,
                     brpc::Channel* channel,
                     bool* rpcFailed) -> int64_t {
@@ -379,6 +392,14 @@ int NebdClient::Discard(int fd, NebdClientAioContext* aioctx) {
 }
 
 int NebdClient::AioRead(int fd, NebdClientAioContext* aioctx) {
+    if (SubmitByShm(fd, aioctx)) {
+        return 0;
+    }
+
+    return AioReadByRpc(fd, aioctx);
+}
+
+int NebdClient::AioReadByRpc(int fd, NebdClientAioContext* aioctx) {
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
         nebd::client::ReadRequest request;
@@ -403,6 +424,14 @@ static void EmptyDeleter(void* m) {
 }
 
 int NebdClient::AioWrite(int fd, NebdClientAioContext* aioctx) {
+    if (SubmitByShm(fd, aioctx)) {
+        return 0;
+    }
+
+    return AioWriteByRpc(fd, aioctx);
+}
+
+int NebdClient::AioWriteByRpc(int fd, NebdClientAioContext* aioctx) {
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
         nebd::client::WriteRequest request;
@@ -425,6 +454,62 @@ int NebdClient::AioWrite(int fd, NebdClientAioContext* aioctx) {
     return 0;
 }
 
+void NebdClient::FallbackToRpc(int fd, NebdClientAioContext* aioctx) {
+    if (aioctx->op == LIBAIO_OP::LIBAIO_OP_READ) {
+        AioReadByRpc(fd, aioctx);
+    } else {
+        AioWriteByRpc(fd, aioctx);
+    }
+}
+
+void NebdClient::OpenShmChannel(int fd) {
+    if (!option_.shmOption.enable) {
+        return;
+    }
+
+    auto channel = std::make_shared<ShmChannel>(
+        fd, option_.shmOption,
+        [this](int channelFd, NebdClientAioContext* aioctx) {
+            FallbackToRpc(channelFd, aioctx);
+        });
+    int ret = channel->Init(option_.serverAddress +
+                            nebd::common::kShmAddressSuffix);
+    if (ret != 0) {
+        LOG(WARNING) << "Init shm channel failed, io will be sent by rpc, "
+                     << "fd = " << fd;
+        return;
+    }
+
+    nebd::common::WriteLockGuard lk(shmLock_);
+    shmChannels_[fd] = std::move(channel);
+}
+
+void NebdClient::CloseShmChannel(int fd) {
+    std::shared_ptr<ShmChannel> channel;
+    {
+        nebd::common::WriteLockGuard lk(shmLock_);
+        auto iter = shmChannels_.find(fd);
+        if (iter == shmChannels_.end()) {
+            return;
+        }
+
+        channel = std::move(iter->second);
+        shmChannels_.erase(iter);
+    }
+
+    channel->Stop();
+}
+
+bool NebdClient::SubmitByShm(int fd, NebdClientAioContext* aioctx) {
+    nebd::common::ReadLockGuard lk(shmLock_);
+    auto iter = shmChannels_.find(fd);
+    if (iter == shmChannels_.end()) {
+        return false;
+    }
+
+    return iter->second->Submit(aioctx);
+}
+
 int NebdClient::Flush(int fd, NebdClientAioContext* aioctx) {
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
@@ -572,6 +657,8 @@ int NebdClient::InitNebdClientOption(Configuration* conf) {
 
     option_.requestOption = requestOption;
 
+    InitShmOption(conf, &option_.shmOption);
+
     ret = conf->GetStringValue("log.path", &option_.logOption.logPath);
     LOG_IF(ERROR, ret != true) << "Load log.path failed";
     RETURN_IF_FALSE(ret);
@@ -599,6 +686,39 @@ int NebdClient::InitHeartBeatOption(Configuration* conf,
     return 0;
 }
 
+void NebdClient::InitShmOption(Configuration* conf, ShmOption* shmOption) {
+    bool ret = conf->GetBoolValue("shm.enable", &shmOption->enable);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.enable failed, use default value "
+        << shmOption->enable;
+
+    ret = conf->GetUInt32Value("shm.ringEntries", &shmOption->ringEntries);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.ringEntries failed, use default value "
+        << shmOption->ringEntries;
+
+    uint32_t slotSizeKB = 0;
+    ret = conf->GetUInt32Value("shm.slotSizeKB", &slotSizeKB);
+    if (ret) {
+        shmOption->slotSize = slotSizeKB * 1024;
+    } else {
+        LOG(WARNING) << "Load shm.slotSizeKB failed, use default value "
+                     << shmOption->slotSize / 1024;
+    }
+
+    ret = conf->GetUInt32Value("shm.detachTimeoutMs",
+                               &shmOption->detachTimeoutMs);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.detachTimeoutMs failed, use default value "
+        << shmOption->detachTimeoutMs;
+
+    ret = conf->GetUInt32Value("shm.reconnectIntervalMs",
+                               &shmOption->reconnectIntervalMs);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.reconnectIntervalMs failed, use default value "
+        << shmOption->reconnectIntervalMs;
+}
+
 int NebdClient::InitChannel() {
     brpc::FLAGS_health_check_interval =
         option_.requestOption.rpcHealthCheckIntervalS;
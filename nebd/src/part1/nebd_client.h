@@ -29,14 +29,17 @@
 #include <functional>
 #include <string>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "nebd/src/part1/nebd_common.h"
 #include "nebd/src/common/configuration.h"
+#include "nebd/src/common/rw_lock.h"
 #include "nebd/proto/client.pb.h"
 #include "nebd/src/part1/libnebd.h"
 #include "nebd/src/part1/heartbeat_manager.h"
 #include "nebd/src/part1/nebd_metacache.h"
+#include "nebd/src/part1/shm_channel.h"
 
 #include "include/curve_compiler_specific.h"
 
@@ -154,6 +157,8 @@ class NebdClient {
     int InitHeartBeatOption(Configuration* conf,
                             HeartbeatOption* hearbeatOption);
 
+    void InitShmOption(Configuration* conf, ShmOption* shmOption);
+
     int InitChannel();
 
     void InitLogger(const LogOption& logOption);
@@ -167,6 +172,27 @@ class NebdClient {
     std::string ReplaceSlash(const std::string& str);
 
     int64_t ExecuteSyncRpc(RpcTask task);
+
+    int AioReadByRpc(int fd, NebdClientAioContext* aioctx);
+
+    int AioWriteByRpc(int fd, NebdClientAioContext* aioctx);
+
+    // 共享内存通道无法处理的请求，重新通过rpc发送
+    void FallbackToRpc(int fd, NebdClientAioContext* aioctx);
+
+    /**
+     * @brief 为打开的文件建立共享内存通道，失败时该文件的读写请求走rpc
+     */
+    void OpenShmChannel(int fd);
+
+    void CloseShmChannel(int fd);
+
+    /**
+     * @brief 尝试通过共享内存通道发送读写请求
+     * @return 成功提交返回true，否则返回false
+     */
+    bool SubmitByShm(int fd, NebdClientAioContext* aioctx);
+
     // 心跳管理模块
     std::shared_ptr<HeartbeatManager> heartbeatMgr_;
     // 缓存模块
@@ -178,6 +204,10 @@ class NebdClient {
 
     std::atomic<uint64_t> logId_{1};
 
+    // 各文件的共享内存通道
+    nebd::common::RWLock shmLock_;
+    std::unordered_map<int, std::shared_ptr<ShmChannel>> shmChannels_;
+
  private:
     using AsyncRpcTask = std::function<void()>;
 
@@ -43,6 +43,20 @@ struct RequestOption {
     uint32_t rpcSendExecQueueNum = 2;
 };
 
+// 共享内存数据通道配置项
+struct ShmOption {
+    // 是否通过共享内存与part2交换读写数据
+    bool enable = false;
+    // 每个文件的请求槽数量，必须是2的幂
+    uint32_t ringEntries = 64;
+    // 每个请求槽的大小，超过该大小的请求通过rpc发送
+    uint32_t slotSize = 256 * 1024;
+    // 关闭通道时等待part2确认detach的超时时间
+    uint32_t detachTimeoutMs = 10000;
+    // 与part2断开后重新建立通道的间隔，连续失败时逐渐增大
+    uint32_t reconnectIntervalMs = 1000;
+};
+
 // 日志配置项
 struct LogOption {
     // 日志存放目录
@@ -57,6 +71,8 @@ struct NebdClientOption {
     std::string fileLockPath;
     // rpc request配置项
     RequestOption requestOption;
+    // 共享内存数据通道配置项
+    ShmOption shmOption;
     // 日志配置项
     LogOption logOption;
 };
@@ -0,0 +1,471 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#include "nebd/src/part1/shm_channel.h"
+
+#include <errno.h>
+#include <glog/logging.h>
+#include <linux/memfd.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "nebd/src/common/timeutility.h"
+#include "nebd/src/part1/async_request_closure.h"
+
+namespace nebd {
+namespace client {
+
+using nebd::common::DrainEventFd;
+using nebd::common::NotifyEventFd;
+using nebd::common::ShmAttachRequest;
+using nebd::common::ShmAttachResponse;
+using nebd::common::ShmCompletion;
+using nebd::common::ShmDetachRequest;
+using nebd::common::ShmDetachResponse;
+using nebd::common::ShmRequest;
+using nebd::common::ShmRequestOp;
+using nebd::common::TimeUtility;
+
+namespace {
+
+// 建立连接时等待part2握手回复的超时时间
+constexpr int kConnectTimeoutMs = 3000;
+// 连续重连失败时，重连间隔最多增大到配置值的倍数
+constexpr uint32_t kMaxReconnectBackoff = 64;
+
+}  // namespace
+
+ShmConnection::~ShmConnection() {
+    // close part2's connection first, so it stops touching the mapping
+    for (int* pfd : {&sock, &requestEventFd, &completionEventFd, &memfd}) {
+        if (*pfd >= 0) {
+            close(*pfd);
+            *pfd = -1;
+        }
+    }
+}
+
+ShmChannel::ShmChannel(int fd, const ShmOption& option, ShmFallback fallback)
+    : fd_(fd),
+      option_(option),
+      fallback_(std::move(fallback)),
+      broken_(true),
+      running_(false) {}
+
+ShmChannel::~ShmChannel() {
+    Stop();
+}
+
+int ShmChannel::Init(const std::string& address) {
+    address_ = address;
+    std::shared_ptr<ShmConnection> conn = Connect();
+    if (conn == nullptr) {
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        conn_ = std::move(conn);
+        ResetSlots();
+        broken_ = false;
+    }
+
+    running_.store(true, std::memory_order_release);
+    completionThread_ = std::thread(&ShmChannel::CompletionLoop, this);
+    return 0;
+}
+
+std::shared_ptr<ShmConnection> ShmChannel::Connect() {
+    auto conn = std::make_shared<ShmConnection>();
+    std::string name = "nebd-shm-" + std::to_string(fd_);
+    conn->memfd = syscall(SYS_memfd_create, name.c_str(), MFD_CLOEXEC);
+    if (conn->memfd < 0) {
+        LOG(ERROR) << "Create memfd failed, fd = " << fd_
+                   << ", error = " << strerror(errno);
+        return nullptr;
+    }
+
+    conn->ring.reset(ShmRing::Create(conn->memfd, option_.ringEntries,
+                                     option_.slotSize));
+    if (conn->ring == nullptr) {
+        LOG(ERROR) << "Create shm ring failed, fd = " << fd_;
+        return nullptr;
+    }
+
+    conn->requestEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    conn->completionEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (conn->requestEventFd < 0 || conn->completionEventFd < 0) {
+        LOG(ERROR) << "Create eventfd failed, fd = " << fd_
+                   << ", error = " << strerror(errno);
+        return nullptr;
+    }
+
+    conn->sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn->sock < 0) {
+        LOG(ERROR) << "Create socket failed, error = " << strerror(errno);
+        return nullptr;
+    }
+
+    // a stuck part2 must not block Init or the reconnecting thread
+    struct timeval tv;
+    tv.tv_sec = kConnectTimeoutMs / 1000;
+    tv.tv_usec = kConnectTimeoutMs % 1000 * 1000;
+    if (setsockopt(conn->sock, SOL_SOCKET, SO_RCVTIMEO, &tv,
+                   sizeof(tv)) != 0 ||
+        setsockopt(conn->sock, SOL_SOCKET, SO_SNDTIMEO, &tv,
+                   sizeof(tv)) != 0) {
+        LOG(ERROR) << "Set socket timeout failed, error = "
+                   << strerror(errno);
+        return nullptr;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (address_.size() >= sizeof(addr.sun_path)) {
+        LOG(ERROR) << "Shm address is too long, address = " << address_;
+        return nullptr;
+    }
+    memcpy(addr.sun_path, address_.c_str(), address_.size());
+
+    if (connect(conn->sock, reinterpret_cast<struct sockaddr*>(&addr),
+                sizeof(addr)) != 0) {
+        LOG(WARNING) << "Connect to " << address_
+                     << " failed, error = " << strerror(errno);
+        return nullptr;
+    }
+
+    ShmAttachRequest request;
+    request.magic = nebd::common::kShmRingMagic;
+    request.fd = fd_;
+    int fds[nebd::common::kShmAttachFdNum] = {
+        conn->memfd, conn->requestEventFd, conn->completionEventFd};
+    if (nebd::common::SendWithFds(conn->sock, &request, sizeof(request), fds,
+                                  nebd::common::kShmAttachFdNum) != 0) {
+        LOG(ERROR) << "Send attach request failed, fd = " << fd_;
+        return nullptr;
+    }
+
+    ShmAttachResponse response;
+    if (nebd::common::RecvWithFds(conn->sock, &response, sizeof(response),
+                                  nullptr, 0) != 0 ||
+        response.ret != 0) {
+        LOG(ERROR) << "Attach shm channel failed, fd = " << fd_;
+        return nullptr;
+    }
+
+    LOG(INFO) << "Shm channel established, fd = " << fd_
+              << ", entries = " << conn->ring->Entries()
+              << ", slot size = " << conn->ring->SlotSize();
+    return conn;
+}
+
+void ShmChannel::ResetSlots() {
+    inflight_.assign(option_.ringEntries, nullptr);
+    freeSlots_.clear();
+    for (uint32_t i = option_.ringEntries; i > 0; --i) {
+        freeSlots_.push_back(i - 1);
+    }
+}
+
+void ShmChannel::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    std::shared_ptr<ShmConnection> conn;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        broken_ = true;
+        conn = conn_;
+    }
+
+    if (conn != nullptr) {
+        // ask part2 to stop picking up requests, the completion thread
+        // resends the remaining ones only after part2 acknowledges it,
+        // if part2 is gone the send fails and the thread sees the hangup
+        ShmDetachRequest request;
+        request.magic = nebd::common::kShmRingMagic;
+        nebd::common::SendWithFds(conn->sock, &request, sizeof(request),
+                                  nullptr, 0);
+        NotifyEventFd(conn->completionEventFd);
+    }
+
+    sleeper_.interrupt();
+    if (completionThread_.joinable()) {
+        completionThread_.join();
+    }
+}
+
+bool ShmChannel::IsConnected() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return !broken_;
+}
+
+bool ShmChannel::Submit(NebdClientAioContext* aioctx) {
+    if (aioctx->op != LIBAIO_OP::LIBAIO_OP_READ &&
+        aioctx->op != LIBAIO_OP::LIBAIO_OP_WRITE) {
+        return false;
+    }
+
+    if (aioctx->length > option_.slotSize) {
+        return false;
+    }
+
+    std::shared_ptr<ShmConnection> conn;
+    uint32_t slot = 0;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (broken_ || freeSlots_.empty()) {
+            return false;
+        }
+
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        inflight_[slot] = aioctx;
+        conn = conn_;
+    }
+
+    ShmRequest request;
+    request.slot = slot;
+    request.offset = aioctx->offset;
+    request.length = aioctx->length;
+    if (aioctx->op == LIBAIO_OP::LIBAIO_OP_WRITE) {
+        request.op = static_cast<uint32_t>(ShmRequestOp::kWrite);
+        memcpy(conn->ring->SlotData(slot), aioctx->buf, aioctx->length);
+    } else {
+        request.op = static_cast<uint32_t>(ShmRequestOp::kRead);
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (broken_ || conn_ != conn) {
+            // if the slot no longer holds the request, it was taken by
+            // TakeInflightRequests and is already resent or failed there
+            bool taken = inflight_[slot] != aioctx;
+            if (!taken) {
+                inflight_[slot] = nullptr;
+            }
+            return taken;
+        }
+
+        // every inflight request owns a slot, so ring never overflows
+        CHECK(conn->ring->PushRequest(request));
+    }
+
+    NotifyEventFd(conn->requestEventFd);
+    return true;
+}
+
+void ShmChannel::CompletionLoop() {
+    std::shared_ptr<ShmConnection> conn;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        conn = conn_;
+    }
+
+    uint32_t backoff = 1;
+    while (conn != nullptr) {
+        bool fenced = ServeConnection(conn);
+        // handle completions posted before part2 detached or exited
+        HandleCompletions(*conn);
+        if (fenced) {
+            FallbackInflightRequests();
+        } else {
+            FailInflightRequests();
+        }
+        conn.reset();
+
+        // part2 may be restarting, keep trying until the channel is stopped
+        while (sleeper_.wait_for(std::chrono::milliseconds(
+                   static_cast<uint64_t>(option_.reconnectIntervalMs) *
+                   backoff))) {
+            backoff = std::min(backoff * 2, kMaxReconnectBackoff);
+            conn = Connect();
+            if (conn == nullptr) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (!running_.load(std::memory_order_acquire)) {
+                conn.reset();
+                break;
+            }
+            conn_ = conn;
+            ResetSlots();
+            broken_ = false;
+            backoff = 1;
+            break;
+        }
+    }
+}
+
+bool ShmChannel::ServeConnection(
+    const std::shared_ptr<ShmConnection>& conn) {
+    struct pollfd fds[2];
+    fds[0].fd = conn->completionEventFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = conn->sock;
+    fds[1].events = POLLIN | POLLRDHUP;
+
+    uint64_t deadline = 0;
+    while (true) {
+        int timeout = -1;
+        if (!running_.load(std::memory_order_acquire)) {
+            uint64_t now = TimeUtility::GetTimeofDayMs();
+            if (deadline == 0) {
+                deadline = now + option_.detachTimeoutMs;
+            }
+            if (now >= deadline) {
+                LOG(ERROR) << "Wait part2 to detach shm channel timeout"
+                           << ", fd = " << fd_;
+                return false;
+            }
+            timeout = deadline - now;
+        }
+
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        int ret = poll(fds, 2, timeout);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG(ERROR) << "Poll shm channel failed, fd = " << fd_
+                       << ", error = " << strerror(errno);
+            return false;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            DrainEventFd(conn->completionEventFd);
+            HandleCompletions(*conn);
+        }
+
+        if (fds[1].revents & (POLLIN | POLLRDHUP | POLLHUP | POLLERR)) {
+            // part2 only replies or closes the connection after all
+            // requests it picked up are completed
+            ShmDetachResponse response;
+            ssize_t n = recv(conn->sock, &response, sizeof(response),
+                             MSG_DONTWAIT);
+            if (n == static_cast<ssize_t>(sizeof(response))) {
+                LOG(INFO) << "Shm channel detached by part2, fd = " << fd_;
+            } else {
+                LOG(WARNING) << "Shm channel disconnected by part2, fd = "
+                             << fd_;
+            }
+            return true;
+        }
+    }
+}
+
+void ShmChannel::HandleCompletions(const ShmConnection& conn) {
+    ShmCompletion completion;
+    while (conn.ring->PopCompletion(&completion)) {
+        if (completion.slot >= conn.ring->Entries()) {
+            LOG(ERROR) << "Invalid completion slot " << completion.slot
+                       << ", fd = " << fd_;
+            continue;
+        }
+
+        NebdClientAioContext* aioctx = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            aioctx = inflight_[completion.slot];
+            inflight_[completion.slot] = nullptr;
+        }
+
+        if (aioctx == nullptr) {
+            LOG(ERROR) << "Completion of idle slot " << completion.slot
+                       << ", fd = " << fd_;
+            continue;
+        }
+
+        bool ok = completion.ret >= 0;
+        if (ok && aioctx->op == LIBAIO_OP::LIBAIO_OP_READ) {
+            memcpy(aioctx->buf, conn.ring->SlotData(completion.slot),
+                   aioctx->length);
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            freeSlots_.push_back(completion.slot);
+        }
+
+        if (ok) {
+            aioctx->ret = 0;
+            aioctx->cb(aioctx);
+        } else {
+            LOG(WARNING) << OpTypeToString(aioctx->op)
+                         << " by shm failed, retry by rpc, fd = " << fd_
+                         << ", offset = " << aioctx->offset
+                         << ", length = " << aioctx->length;
+            fallback_(fd_, aioctx);
+        }
+    }
+}
+
+std::vector<NebdClientAioContext*> ShmChannel::TakeInflightRequests() {
+    std::vector<NebdClientAioContext*> requests;
+    std::lock_guard<std::mutex> lk(mtx_);
+    broken_ = true;
+    conn_.reset();
+    for (auto& aioctx : inflight_) {
+        if (aioctx != nullptr) {
+            requests.push_back(aioctx);
+            aioctx = nullptr;
+        }
+    }
+    return requests;
+}
+
+void ShmChannel::FallbackInflightRequests() {
+    std::vector<NebdClientAioContext*> requests = TakeInflightRequests();
+    LOG_IF(WARNING, !requests.empty())
+        << "Resend " << requests.size()
+        << " inflight requests by rpc, fd = " << fd_;
+    for (auto* aioctx : requests) {
+        fallback_(fd_, aioctx);
+    }
+}
+
+void ShmChannel::FailInflightRequests() {
+    std::vector<NebdClientAioContext*> requests = TakeInflightRequests();
+    LOG_IF(ERROR, !requests.empty())
+        << "Fail " << requests.size() << " inflight requests, "
+        << "part2 may still process them, fd = " << fd_;
+    for (auto* aioctx : requests) {
+        aioctx->ret = -1;
+        aioctx->cb(aioctx);
+    }
+}
+
+}  // namespace client
+}  // namespace nebd
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#ifndef NEBD_SRC_PART1_SHM_CHANNEL_H_
+#define NEBD_SRC_PART1_SHM_CHANNEL_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/common/interrupt_sleep.h"
+#include "nebd/src/common/shm_ring.h"
+#include "nebd/src/part1/libnebd.h"
+#include "nebd/src/part1/nebd_common.h"
+
+namespace nebd {
+namespace client {
+
+using nebd::common::ShmRing;
+
+// 通过共享内存无法完成的请求，交给rpc通道重新发送
+using ShmFallback = std::function<void(int fd, NebdClientAioContext* aioctx)>;
+
+// 与part2之间一次连接所使用的共享内存和文件描述符，
+// part2重启后重新建立连接时整体替换，最后一个引用释放时关闭
+struct ShmConnection {
+    ~ShmConnection();
+
+    int memfd = -1;
+    // part1 -> part2 请求通知
+    int requestEventFd = -1;
+    // part2 -> part1 完成通知
+    int completionEventFd = -1;
+    // 与part2的连接，part2的通道释放或者进程退出时该连接会被关闭
+    int sock = -1;
+    std::unique_ptr<ShmRing> ring;
+};
+
+/**
+ * ShmChannel是单个文件的共享内存数据通道。
+ * 读写请求的数据放在共享内存的请求槽中，请求描述符通过共享内存环传递给part2，
+ * 双方通过eventfd互相通知，避免了rpc的序列化、socket收发以及数据拷贝。
+ * 以下情况请求会交给rpc通道处理：
+ * 1. 没有空闲的请求槽，或者请求大小超过请求槽的大小
+ * 2. part2返回失败，由rpc通道按照原有的重试逻辑处理
+ * 3. 与part2的连接断开，或者关闭通道时part2确认不再处理请求环中的请求，
+ *    剩余未完成的请求通过rpc通道重新发送
+ * part2的通道只有在所有取出的请求都完成之后才会关闭连接，
+ * 因此连接断开时请求环中剩余的请求不会再被part2执行，可以安全地重新发送。
+ * 连接断开后后台线程会定期重新建立连接，期间请求都通过rpc发送。
+ */
+class ShmChannel {
+ public:
+    ShmChannel(int fd, const ShmOption& option, ShmFallback fallback);
+    ~ShmChannel();
+
+    /**
+     * @brief 创建共享内存，并与part2建立共享内存通道
+     * @param address part2监听的共享内存通道地址
+     * @return 成功返回0，失败返回-1
+     */
+    int Init(const std::string& address);
+
+    /**
+     * @brief 停止通道。先等待part2确认不再处理请求环中的请求，
+     *        再将未完成的请求交给rpc通道处理；
+     *        超时未收到确认时无法判断请求是否已经执行，未完成的请求返回失败
+     */
+    void Stop();
+
+    /**
+     * @brief 通过共享内存发送读写请求
+     * @return 请求成功提交返回true，否则返回false，由调用方通过rpc发送
+     */
+    bool Submit(NebdClientAioContext* aioctx);
+
+    /**
+     * @brief 共享内存通道当前是否可用
+     */
+    bool IsConnected();
+
+ private:
+    std::shared_ptr<ShmConnection> Connect();
+
+    void ResetSlots();
+
+    void CompletionLoop();
+
+    // 处理连接上的完成事件，直到连接断开或者part2确认detach
+    // @return part2已经不会再处理请求环中的请求返回true，等待确认超时返回false
+    bool ServeConnection(const std::shared_ptr<ShmConnection>& conn);
+
+    void HandleCompletions(const ShmConnection& conn);
+
+    // part2不再处理请求环中的请求后，将所有未完成的请求交给rpc通道
+    void FallbackInflightRequests();
+
+    // 无法确认part2是否执行了未完成的请求，只能将其返回失败
+    void FailInflightRequests();
+
+    // 取出所有未完成的请求，并将通道标记为不可用
+    std::vector<NebdClientAioContext*> TakeInflightRequests();
+
+ private:
+    int fd_;
+    ShmOption option_;
+    ShmFallback fallback_;
+    std::string address_;
+
+    // 保护conn_、inflight_、freeSlots_、broken_以及请求环的写入
+    std::mutex mtx_;
+    std::shared_ptr<ShmConnection> conn_;
+    std::vector<NebdClientAioContext*> inflight_;
+    std::vector<uint32_t> freeSlots_;
+    bool broken_;
+
+    std::atomic<bool> running_;
+    nebd::common::InterruptibleSleeper sleeper_;
+    std::thread completionThread_;
+};
+
+}  // namespace client
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART1_SHM_CHANNEL_H_
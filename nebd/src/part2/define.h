@@ -124,6 +124,10 @@ const char HEARTBEATTIMEOUTSEC[] = "heartbeat.timeout.sec";
 const char HEARTBEATCHECKINTERVALMS[] = "heartbeat.check.interval.ms";
 const char CURVECLIENTCONFPATH[] = "curveclient.confPath";
 const char RESPONSERETURNRPCWHENIOERROR[] = "response.returnRpcWhenIoError";
+const char SHMENABLE[] = "shm.enable";
+const char REQUESTBATCHENABLE[] = "request.batch.enable";
+const char REQUESTBATCHMAXMERGEBYTES[] = "request.batch.maxMergeBytes";
+const char REQUESTBATCHMAXMERGEREQUESTS[] = "request.batch.maxMergeRequests";
 
 }  // namespace server
 }  // namespace nebd
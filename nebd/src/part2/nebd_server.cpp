@@ -95,6 +95,10 @@ int NebdServer::Fini() {
         brpc::AskToQuit();
     }
 
+    if (shmService_ != nullptr) {
+        shmService_->Stop();
+    }
+
     if (fileManager_ != nullptr) {
         fileManager_->Fini();
     }
@@ -148,7 +152,23 @@ bool NebdServer::InitCurveRequestExecutor() {
         return false;
     }
 
-    CurveRequestExecutor::GetInstance().Init(curveClient_);
+    CurveRequestBatchOption batchOption;
+    getOk = conf_.GetBoolValue(REQUESTBATCHENABLE, &batchOption.enable);
+    LOG_IF(WARNING, !getOk) << "get " << REQUESTBATCHENABLE
+                            << " fail, use default value "
+                            << batchOption.enable;
+    getOk = conf_.GetUInt32Value(REQUESTBATCHMAXMERGEBYTES,
+                                 &batchOption.maxMergeBytes);
+    LOG_IF(WARNING, !getOk) << "get " << REQUESTBATCHMAXMERGEBYTES
+                            << " fail, use default value "
+                            << batchOption.maxMergeBytes;
+    getOk = conf_.GetUInt32Value(REQUESTBATCHMAXMERGEREQUESTS,
+                                 &batchOption.maxMergeRequests);
+    LOG_IF(WARNING, !getOk) << "get " << REQUESTBATCHMAXMERGEREQUESTS
+                            << " fail, use default value "
+                            << batchOption.maxMergeRequests;
+
+    CurveRequestExecutor::GetInstance().Init(curveClient_, batchOption);
     return true;
 }
 
@@ -209,6 +229,20 @@ bool NebdServer::InitHeartbeatManager() {
     return true;
 }
 
+bool NebdServer::StartShmService() {
+    bool enable = false;
+    bool ret = conf_.GetBoolValue(SHMENABLE, &enable);
+    LOG_IF(WARNING, !ret) << "get " << SHMENABLE
+                          << " fail, use default value " << enable;
+    if (!enable) {
+        return true;
+    }
+
+    shmService_ = std::make_shared<NebdShmService>(fileManager_);
+    return shmService_->Start(listenAddress_ +
+                              nebd::common::kShmAddressSuffix) == 0;
+}
+
 bool NebdServer::StartServer() {
     // add service
     bool returnRpcWhenIoError;
@@ -244,6 +278,12 @@ bool NebdServer::StartServer() {
         LOG(ERROR) << "Address already in use";
         return -1;
     }
+    if (!StartShmService()) {
+        LOG(ERROR) << "NebdServer start shm service fail";
+        fileLock.ReleaseFileLock();
+        return false;
+    }
+
     int startBrpcServerRes = server_.StartAtSockFile(
                                     listenAddress_.c_str(), &option);
     if (0 != startBrpcServerRes) {
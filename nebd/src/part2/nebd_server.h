@@ -30,6 +30,7 @@
 #include "nebd/src/part2/file_manager.h"
 #include "nebd/src/part2/heartbeat_manager.h"
 #include "nebd/src/part2/request_executor_curve.h"
+#include "nebd/src/part2/shm_service.h"
 
 namespace nebd {
 namespace server {
@@ -89,6 +90,12 @@ class NebdServer {
      */
     bool InitHeartbeatManager();
 
+    /**
+     * @brief 启动共享内存数据通道服务，未开启时不启动
+     * @return false-启动失败 true-启动成功或未开启
+     */
+    bool StartShmService();
+
     /**
      * @brief 启动brpc service
      * @return false-启动service失败 true-启动service成功
@@ -111,6 +118,8 @@ class NebdServer {
     std::shared_ptr<HeartbeatManager> heartbeatManager_;
     // curveclient
     std::shared_ptr<CurveClient> curveClient_;
+    // 共享内存数据通道服务
+    std::shared_ptr<NebdShmService> shmService_;
 };
 
 }  // namespace server
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-17
+ * Author: curve
+ */
+
+#include "nebd/src/part2/request_batcher.h"
+
+#include <glog/logging.h>
+
+#include <memory>
+
+#include "nebd/src/part2/request_executor_curve.h"
+
+namespace nebd {
+namespace server {
+
+namespace {
+
+bool IsBatchable(const NebdServerAioContext* aioctx) {
+    return aioctx->op == LIBAIO_OP::LIBAIO_OP_READ ||
+           aioctx->op == LIBAIO_OP::LIBAIO_OP_WRITE;
+}
+
+}  // namespace
+
+CurveRequestBatcher::CurveRequestBatcher(const std::string& fileName,
+                                         int curveFd, CurveClient* client,
+                                         const CurveRequestBatchOption& option)
+    : fileName_(fileName),
+      curveFd_(curveFd),
+      client_(client),
+      option_(option),
+      started_(false) {}
+
+CurveRequestBatcher::~CurveRequestBatcher() {
+    Stop();
+}
+
+int CurveRequestBatcher::Start() {
+    int rc = bthread::execution_queue_start(&queueId_, nullptr,
+                                            &CurveRequestBatcher::Process,
+                                            this);
+    if (rc != 0) {
+        LOG(ERROR) << "Start request queue failed, file: " << fileName_;
+        return -1;
+    }
+
+    const std::string prefix = "nebd_server_file_" + fileName_;
+    queueDepth_.expose_as(prefix, "queue_depth");
+    batchSize_.expose_as(prefix, "batch_size");
+    mergedRequests_.expose_as(prefix, "merged_requests");
+
+    started_ = true;
+    return 0;
+}
+
+void CurveRequestBatcher::Stop() {
+    if (!started_) {
+        return;
+    }
+
+    started_ = false;
+    bthread::execution_queue_stop(queueId_);
+    bthread::execution_queue_join(queueId_);
+
+    // 未完成的请求仍然持有队列，文件重新打开时新队列需要使用同样的指标名
+    queueDepth_.hide();
+    batchSize_.hide();
+    mergedRequests_.hide();
+}
+
+int CurveRequestBatcher::Submit(NebdServerAioContext* aioctx) {
+    if (!IsBatchable(aioctx)) {
+        return -1;
+    }
+
+    queueDepth_ << 1;
+    int rc = bthread::execution_queue_execute(queueId_, aioctx);
+    if (rc != 0) {
+        LOG(ERROR) << "Push request into queue failed, file: " << fileName_;
+        queueDepth_ << -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+int CurveRequestBatcher::Process(
+    void* meta, bthread::TaskIterator<NebdServerAioContext*>& iter) {  // NOLINT
+    CurveRequestBatcher* batcher = static_cast<CurveRequestBatcher*>(meta);
+    if (iter.is_queue_stopped()) {
+        return 0;
+    }
+
+    std::vector<NebdServerAioContext*> requests;
+    for (; iter; ++iter) {
+        requests.push_back(*iter);
+    }
+
+    std::vector<std::vector<NebdServerAioContext*>> batches;
+    SplitIntoBatches(requests, batcher->option_, &batches);
+    for (const auto& batch : batches) {
+        batcher->SubmitBatch(batch);
+    }
+
+    return 0;
+}
+
+void CurveRequestBatcher::SplitIntoBatches(
+    const std::vector<NebdServerAioContext*>& requests,
+    const CurveRequestBatchOption& option,
+    std::vector<std::vector<NebdServerAioContext*>>* batches) {
+    uint64_t batchBytes = 0;
+    for (auto* req : requests) {
+        if (!batches->empty()) {
+            auto& batch = batches->back();
+            const NebdServerAioContext* last = batch.back();
+            if (last->op == req->op &&
+                last->offset + static_cast<off_t>(last->size) == req->offset &&
+                batch.size() < option.maxMergeRequests &&
+                batchBytes + req->size <= option.maxMergeBytes) {
+                batch.push_back(req);
+                batchBytes += req->size;
+                continue;
+            }
+        }
+
+        batches->emplace_back(1, req);
+        batchBytes = req->size;
+    }
+}
+
+void CurveRequestBatcher::SubmitBatch(
+    const std::vector<NebdServerAioContext*>& batch) {
+    const NebdServerAioContext* first = batch.front();
+    const bool isRead = first->op == LIBAIO_OP::LIBAIO_OP_READ;
+
+    CurveAioCombineContext* ctx = new CurveAioCombineContext();
+    ctx->batcher = shared_from_this();
+    ctx->curveCtx.offset = first->offset;
+    ctx->curveCtx.op = isRead ? LIBCURVE_OP::LIBCURVE_OP_READ
+                              : LIBCURVE_OP::LIBCURVE_OP_WRITE;
+    ctx->curveCtx.cb = CurveAioCallback;
+
+    if (batch.size() == 1) {
+        ctx->nebdCtx = batch.front();
+        ctx->curveCtx.length = first->size;
+        ctx->curveCtx.buf = first->buf;
+    } else {
+        ctx->nebdCtx = nullptr;
+        ctx->merged = new CurveMergedRequest();
+        ctx->merged->requests = batch;
+
+        size_t length = 0;
+        for (auto* req : batch) {
+            length += req->size;
+            if (!isRead) {
+                ctx->merged->data.append(
+                    *reinterpret_cast<butil::IOBuf*>(req->buf));
+            }
+        }
+
+        ctx->curveCtx.length = length;
+        ctx->curveCtx.buf = &ctx->merged->data;
+        mergedRequests_ << batch.size();
+    }
+
+    batchSize_ << batch.size();
+
+    int ret = isRead ? client_->AioRead(curveFd_, &ctx->curveCtx,
+                                        curve::client::UserDataType::IOBuffer)
+                     : client_->AioWrite(curveFd_, &ctx->curveCtx,
+                                         curve::client::UserDataType::IOBuffer);
+    if (ret != LIBCURVE_ERROR::OK) {
+        LOG(ERROR) << "Submit batched request failed, file: " << fileName_
+                   << ", offset: " << ctx->curveCtx.offset
+                   << ", length: " << ctx->curveCtx.length
+                   << ", requests: " << batch.size();
+        ctx->curveCtx.ret = -LIBCURVE_ERROR::FAILED;
+        OnBatchDone(ctx);
+    }
+}
+
+void CurveRequestBatcher::OnBatchDone(CurveAioCombineContext* ctx) {
+    std::unique_ptr<CurveAioCombineContext> ctxGuard(ctx);
+    const int ret = ctx->curveCtx.ret;
+
+    if (ctx->merged == nullptr) {
+        queueDepth_ << -1;
+        ctx->nebdCtx->ret = ret;
+        ctx->nebdCtx->cb(ctx->nebdCtx);
+        return;
+    }
+
+    std::unique_ptr<CurveMergedRequest> merged(ctx->merged);
+    for (auto* req : merged->requests) {
+        if (ret >= 0 && req->op == LIBAIO_OP::LIBAIO_OP_READ) {
+            merged->data.cutn(reinterpret_cast<butil::IOBuf*>(req->buf),
+                              req->size);
+        }
+        req->ret = ret < 0 ? ret : static_cast<int>(req->size);
+    }
+
+    queueDepth_ << -static_cast<int64_t>(merged->requests.size());
+
+    for (auto* req : merged->requests) {
+        req->cb(req);
+    }
+}
+
+}  // namespace server
+}  // namespace nebd
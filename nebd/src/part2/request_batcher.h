@@ -0,0 +1,134 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-17
+ * Author: curve
+ */
+
+#ifndef NEBD_SRC_PART2_REQUEST_BATCHER_H_
+#define NEBD_SRC_PART2_REQUEST_BATCHER_H_
+
+#include <bthread/execution_queue.h>
+#include <butil/iobuf.h>
+#include <bvar/bvar.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/client/libcurve.h"
+#include "nebd/src/part2/define.h"
+
+namespace nebd {
+namespace server {
+
+using ::curve::client::CurveClient;
+
+class CurveAioCombineContext;
+
+// 请求合并配置项
+struct CurveRequestBatchOption {
+    // 是否开启请求批量提交
+    bool enable = false;
+    // 合并后请求的最大字节数
+    uint32_t maxMergeBytes = 1024 * 1024;
+    // 单个合并请求最多包含的请求个数
+    uint32_t maxMergeRequests = 32;
+};
+
+// 合并后的请求，记录被合并的原始请求以及合并后的数据
+struct CurveMergedRequest {
+    std::vector<NebdServerAioContext*> requests;
+    butil::IOBuf data;
+};
+
+/**
+ * CurveRequestBatcher是单个文件的请求队列。
+ * 读写请求先进入执行队列，执行队列每次取出当前所有的待处理请求，
+ * 将其中相邻的同类型请求合并成一个请求后再提交给curve client，
+ * 合并请求完成后再拆分返回给各个原始请求。
+ * 提交给curve client的请求持有队列的引用，文件关闭后队列直到这些请求完成才释放，
+ * 因此队列必须通过std::shared_ptr创建。
+ */
+class CurveRequestBatcher
+    : public std::enable_shared_from_this<CurveRequestBatcher> {
+ public:
+    CurveRequestBatcher(const std::string& fileName, int curveFd,
+                        CurveClient* client,
+                        const CurveRequestBatchOption& option);
+
+    ~CurveRequestBatcher();
+
+    /**
+     * @brief 启动执行队列
+     * @return 成功返回0，失败返回-1
+     */
+    int Start();
+
+    /**
+     * @brief 停止执行队列，并等待已经入队的请求提交完成
+     */
+    void Stop();
+
+    /**
+     * @brief 将读写请求放入队列
+     * @return 成功返回0，失败返回-1
+     */
+    int Submit(NebdServerAioContext* aioctx);
+
+    /**
+     * @brief 提交给curve client的请求完成后调用
+     */
+    void OnBatchDone(CurveAioCombineContext* ctx);
+
+    /**
+     * @brief 将请求按照提交顺序划分为多个批次，
+     *        每个批次内的请求类型相同、地址连续，且不超过合并限制
+     */
+    static void SplitIntoBatches(
+        const std::vector<NebdServerAioContext*>& requests,
+        const CurveRequestBatchOption& option,
+        std::vector<std::vector<NebdServerAioContext*>>* batches);
+
+ private:
+    static int Process(void* meta,
+                       bthread::TaskIterator<NebdServerAioContext*>& iter);  // NOLINT
+
+    void SubmitBatch(const std::vector<NebdServerAioContext*>& batch);
+
+ private:
+    std::string fileName_;
+    int curveFd_;
+    CurveClient* client_;
+    CurveRequestBatchOption option_;
+
+    bool started_;
+    bthread::ExecutionQueueId<NebdServerAioContext*> queueId_;
+
+    // 已入队但尚未完成的请求个数
+    bvar::Adder<int64_t> queueDepth_;
+    // 每次提交给curve client的请求所包含的原始请求个数
+    bvar::IntRecorder batchSize_;
+    // 被合并的原始请求个数
+    bvar::Adder<uint64_t> mergedRequests_;
+};
+
+}  // namespace server
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART2_REQUEST_BATCHER_H_
@@ -84,8 +84,10 @@ FileNameParser::Parse(const std::string& fileName) {
     return std::make_pair(fileName.substr(beginPos, length), confPath);
 }
 
-void CurveRequestExecutor::Init(const std::shared_ptr<CurveClient> &client) {
+void CurveRequestExecutor::Init(const std::shared_ptr<CurveClient> &client,
+                                const CurveRequestBatchOption& batchOption) {
     client_ = client;
+    batchOption_ = batchOption;
 }
 
 std::shared_ptr<NebdFileInstance> CurveRequestExecutor::Open(
@@ -110,6 +112,7 @@ std::shared_ptr<NebdFileInstance> CurveRequestExecutor::Open(
                 openFlags->SerializeAsString();
         }
 
+        StartRequestBatcher(curveFileInstance.get());
         return curveFileInstance;
     }
 
@@ -147,6 +150,7 @@ CurveRequestExecutor::Reopen(const std::string& filename,
             curveFileInstance->xattr[kOpenFlagsAttrKey] =
                 xattr.at(kOpenFlagsAttrKey);
         }
+        StartRequestBatcher(curveFileInstance.get());
         return curveFileInstance;
     }
 
@@ -159,6 +163,11 @@ int CurveRequestExecutor::Close(NebdFileInstance* fd) {
         return -1;
     }
 
+    CurveRequestBatcher* batcher = GetRequestBatcher(fd);
+    if (batcher != nullptr) {
+        batcher->Stop();
+    }
+
     int res = client_->Close(curveFd);
     if (res != LIBCURVE_ERROR::OK) {
         return -1;
@@ -236,6 +245,11 @@ int CurveRequestExecutor::AioRead(
         return -1;
     }
 
+    CurveRequestBatcher* batcher = GetRequestBatcher(fd);
+    if (batcher != nullptr) {
+        return batcher->Submit(aioctx);
+    }
+
     CurveAioCombineContext *curveCombineCtx = new CurveAioCombineContext();
     curveCombineCtx->nebdCtx = aioctx;
     int ret = FromNebdCtxToCurveCtx(aioctx, &curveCombineCtx->curveCtx);
@@ -261,6 +275,11 @@ int CurveRequestExecutor::AioWrite(
         return -1;
     }
 
+    CurveRequestBatcher* batcher = GetRequestBatcher(fd);
+    if (batcher != nullptr) {
+        return batcher->Submit(aioctx);
+    }
+
     CurveAioCombineContext *curveCombineCtx = new CurveAioCombineContext();
     curveCombineCtx->nebdCtx = aioctx;
     int ret = FromNebdCtxToCurveCtx(aioctx, &curveCombineCtx->curveCtx);
@@ -319,6 +338,35 @@ std::string CurveRequestExecutor::GetFileNameFromNebdFileInstance(
     return curveFileInstance->fileName;
 }
 
+void CurveRequestExecutor::StartRequestBatcher(
+    CurveFileInstance* fileInstance) {
+    if (!batchOption_.enable) {
+        return;
+    }
+
+    auto batcher = std::make_shared<CurveRequestBatcher>(
+        fileInstance->fileName, fileInstance->fd, client_.get(),
+        batchOption_);
+    if (batcher->Start() != 0) {
+        LOG(WARNING) << "Start request batcher failed, requests will be "
+                        "submitted one by one, file: "
+                     << fileInstance->fileName;
+        return;
+    }
+
+    fileInstance->batcher = std::move(batcher);
+}
+
+CurveRequestBatcher* CurveRequestExecutor::GetRequestBatcher(
+    NebdFileInstance* fd) {
+    auto curveFileInstance = dynamic_cast<CurveFileInstance *>(fd);
+    if (curveFileInstance == nullptr) {
+        return nullptr;
+    }
+
+    return curveFileInstance->batcher.get();
+}
+
 int CurveRequestExecutor::FromNebdCtxToCurveCtx(
         NebdServerAioContext *nebdCtx, CurveAioContext *curveCtx) {
     curveCtx->offset = nebdCtx->offset;
@@ -352,6 +400,15 @@ void CurveAioCallback(struct CurveAioContext* curveCtx) {
     auto curveCombineCtx = reinterpret_cast<CurveAioCombineContext *>(
         reinterpret_cast<char *>(curveCtx) -
         offsetof(CurveAioCombineContext, curveCtx));
+    if (curveCombineCtx->batcher != nullptr) {
+        // the file may be closed meanwhile, keep the batcher alive until
+        // OnBatchDone returns, it releases the context
+        std::shared_ptr<CurveRequestBatcher> batcher =
+            curveCombineCtx->batcher;
+        batcher->OnBatchDone(curveCombineCtx);
+        return;
+    }
+
     curveCombineCtx->nebdCtx->ret = curveCtx->ret;
     curveCombineCtx->nebdCtx->cb(curveCombineCtx->nebdCtx);
     delete curveCombineCtx;
@@ -28,6 +28,7 @@
 #include <utility>
 #include "nebd/src/part2/request_executor.h"
 #include "nebd/src/part2/define.h"
+#include "nebd/src/part2/request_batcher.h"
 #include "include/client/libcurve.h"
 
 namespace nebd {
@@ -42,12 +43,18 @@ class CurveFileInstance : public NebdFileInstance {
 
     int fd = -1;
     std::string fileName;
+    // 开启请求合并时，文件的读写请求队列
+    std::shared_ptr<CurveRequestBatcher> batcher;
 };
 
 class CurveAioCombineContext {
  public:
     NebdServerAioContext* nebdCtx;
     CurveAioContext curveCtx;
+    // 通过请求队列提交的请求所属的队列，请求完成前队列不会被释放
+    std::shared_ptr<CurveRequestBatcher> batcher;
+    // 多个请求合并后提交时，记录被合并的请求，此时nebdCtx为空
+    CurveMergedRequest* merged = nullptr;
 };
 void CurveAioCallback(struct CurveAioContext* curveCtx);
 
@@ -74,7 +81,9 @@ class CurveRequestExecutor : public NebdRequestExecutor {
         return executor;
     }
     ~CurveRequestExecutor() {}
-    void Init(const std::shared_ptr<CurveClient> &client);
+    void Init(const std::shared_ptr<CurveClient> &client,
+              const CurveRequestBatchOption& batchOption =
+                  CurveRequestBatchOption());
     std::shared_ptr<NebdFileInstance> Open(const std::string& filename,
                                            const OpenFlags* openflags) override;
     std::shared_ptr<NebdFileInstance> Reopen(
@@ -125,8 +134,21 @@ class CurveRequestExecutor : public NebdRequestExecutor {
      */
      int FromNebdOpToCurveOp(LIBAIO_OP op, LIBCURVE_OP *out);
 
+    /**
+     * @brief 开启请求合并时，为打开的文件创建请求队列
+     * @param[in] fileInstance 打开的文件
+     */
+    void StartRequestBatcher(CurveFileInstance* fileInstance);
+
+    /**
+     * @brief 获取文件的请求队列
+     * @return 未开启请求合并时返回nullptr
+     */
+    CurveRequestBatcher* GetRequestBatcher(NebdFileInstance* fd);
+
  private:
     std::shared_ptr<::curve::client::CurveClient> client_;
+    CurveRequestBatchOption batchOption_;
 };
 
 }  // namespace server
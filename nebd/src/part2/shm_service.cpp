@@ -0,0 +1,561 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#include "nebd/src/part2/shm_service.h"
+
+#include <brpc/closure_guard.h>
+#include <butil/iobuf.h>
+#include <errno.h>
+#include <glog/logging.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <utility>
+#include <vector>
+
+#include "nebd/src/common/timeutility.h"
+
+namespace nebd {
+namespace server {
+
+using nebd::common::DrainEventFd;
+using nebd::common::NotifyEventFd;
+using nebd::common::ShmAttachRequest;
+using nebd::common::ShmAttachResponse;
+using nebd::common::ShmDetachRequest;
+using nebd::common::ShmDetachResponse;
+using nebd::common::ShmRequestOp;
+using nebd::common::TimeUtility;
+
+namespace {
+
+constexpr int kAcceptPollTimeoutMs = 1000;
+// 建立连接后等待part1发送握手请求的超时时间
+constexpr uint64_t kAttachTimeoutMs = 3000;
+// 存在暂存的完成事件时，重新写入完成环的间隔
+constexpr int kPendingCompletionRetryMs = 1;
+
+// 已经建立但还没有收到握手请求的连接
+struct PendingAttach {
+    int sock;
+    uint64_t deadlineMs;
+};
+
+// 共享内存请求的上下文，记录请求所属的通道和请求槽
+struct ShmServerAioContext : public NebdServerAioContext {
+    NebdShmFileChannelPtr channel;
+    uint32_t slot = 0;
+};
+
+void EmptyDeleter(void*) {}
+
+void NebdShmServiceCallback(NebdServerAioContext* context) {
+    CHECK(context != nullptr);
+    std::unique_ptr<ShmServerAioContext> contextGuard(
+        static_cast<ShmServerAioContext*>(context));
+    std::unique_ptr<butil::IOBuf> iobufGuard(
+        reinterpret_cast<butil::IOBuf*>(context->buf));
+    brpc::ClosureGuard doneGuard(context->done);
+
+    int ret = context->ret;
+    if (ret < 0) {
+        LOG(ERROR) << *context;
+    } else if (context->op == LIBAIO_OP::LIBAIO_OP_READ) {
+        if (iobufGuard->size() != context->size) {
+            LOG(ERROR) << "Read data size mismatch, expected "
+                       << context->size << ", got " << iobufGuard->size();
+            ret = -1;
+        } else {
+            iobufGuard->copy_to(
+                contextGuard->channel->SlotData(contextGuard->slot),
+                context->size);
+        }
+    }
+
+    contextGuard->channel->Complete(contextGuard->slot, ret);
+}
+
+}  // namespace
+
+NebdShmFileChannel::NebdShmFileChannel(int fd, NebdFileManagerPtr fileManager,
+                                       std::unique_ptr<ShmRing> ring,
+                                       int requestEventFd,
+                                       int completionEventFd, int sock)
+    : fd_(fd),
+      fileManager_(std::move(fileManager)),
+      ring_(std::move(ring)),
+      requestEventFd_(requestEventFd),
+      completionEventFd_(completionEventFd),
+      sock_(sock),
+      inflight_(0),
+      running_(false),
+      stopped_(false) {}
+
+NebdShmFileChannel::~NebdShmFileChannel() {
+    Stop();
+
+    {
+        std::lock_guard<std::mutex> lk(completionMtx_);
+        FlushPendingCompletions();
+        LOG_IF(ERROR, !pendingCompletions_.empty())
+            << "Drop " << pendingCompletions_.size()
+            << " completions on closed shm channel, fd = " << fd_;
+    }
+
+    close(sock_);
+    close(requestEventFd_);
+    close(completionEventFd_);
+}
+
+void NebdShmFileChannel::Start() {
+    running_.store(true, std::memory_order_release);
+    requestThread_ = std::thread(&NebdShmFileChannel::RequestLoop, this);
+}
+
+void NebdShmFileChannel::Stop() {
+    running_.store(false, std::memory_order_release);
+    NotifyEventFd(requestEventFd_);
+    {
+        std::lock_guard<std::mutex> lk(completionMtx_);
+        inflightCv_.notify_all();
+    }
+    if (requestThread_.joinable()) {
+        requestThread_.join();
+    }
+}
+
+void NebdShmFileChannel::RequestLoop() {
+    struct pollfd fds[2];
+    fds[0].fd = requestEventFd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = sock_;
+    fds[1].events = POLLIN | POLLRDHUP;
+
+    while (running_.load(std::memory_order_acquire)) {
+        int timeout = -1;
+        {
+            std::lock_guard<std::mutex> lk(completionMtx_);
+            if (!pendingCompletions_.empty()) {
+                timeout = kPendingCompletionRetryMs;
+            }
+        }
+
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        int ret = poll(fds, 2, timeout);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG(ERROR) << "Poll shm channel failed, fd = " << fd_
+                       << ", error = " << strerror(errno);
+            break;
+        }
+
+        if (timeout >= 0) {
+            RetryPendingCompletions();
+        }
+
+        if (fds[0].revents & POLLIN) {
+            DrainEventFd(requestEventFd_);
+            if (!HandleRequests()) {
+                // 不再取新的请求，已经取出的请求完成后通道析构时关闭连接，
+                // part1随后将未完成的请求交给rpc重新发送
+                LOG(ERROR) << "Tear down shm channel on protocol violation"
+                           << ", fd = " << fd_;
+                break;
+            }
+        }
+
+        if (fds[1].revents & (POLLIN | POLLRDHUP | POLLHUP | POLLERR)) {
+            ShmDetachRequest request;
+            ssize_t n = recv(sock_, &request, sizeof(request), MSG_DONTWAIT);
+            if (n == static_cast<ssize_t>(sizeof(request)) &&
+                request.magic == nebd::common::kShmRingMagic) {
+                LOG(INFO) << "Detach shm channel by part1, fd = " << fd_;
+                Detach();
+            } else {
+                LOG(INFO) << "Shm channel closed by part1, fd = " << fd_;
+            }
+            break;
+        }
+    }
+
+    stopped_.store(true, std::memory_order_release);
+}
+
+bool NebdShmFileChannel::HandleRequests() {
+    ShmRequest request;
+    while (ring_->PopRequest(&request)) {
+        if (!HandleRequest(request)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NebdShmFileChannel::HandleRequest(const ShmRequest& request) {
+    // 无法通过完成事件回复越界的请求槽，part1的请求计数也就无法归零
+    if (request.slot >= ring_->Entries()) {
+        LOG(ERROR) << "Invalid shm request slot, fd = " << fd_
+                   << ", slot = " << request.slot;
+        return false;
+    }
+
+    // every request picked up is completed exactly once by Complete
+    {
+        std::lock_guard<std::mutex> lk(completionMtx_);
+        ++inflight_;
+    }
+
+    if (request.length > ring_->SlotSize() ||
+        (request.op != static_cast<uint32_t>(ShmRequestOp::kRead) &&
+         request.op != static_cast<uint32_t>(ShmRequestOp::kWrite))) {
+        LOG(ERROR) << "Invalid shm request, fd = " << fd_
+                   << ", slot = " << request.slot
+                   << ", op = " << request.op
+                   << ", length = " << request.length;
+        Complete(request.slot, -1);
+        return true;
+    }
+
+    ShmServerAioContext* context = new (std::nothrow) ShmServerAioContext();
+    if (context == nullptr) {
+        LOG(ERROR) << "Allocate shm aio context failed, fd = " << fd_
+                   << ", slot = " << request.slot;
+        Complete(request.slot, -1);
+        return true;
+    }
+
+    context->channel = shared_from_this();
+    context->slot = request.slot;
+    context->offset = request.offset;
+    context->size = request.length;
+    context->cb = NebdShmServiceCallback;
+
+    butil::IOBuf* buf = new butil::IOBuf();
+    context->buf = buf;
+
+    int rc = 0;
+    if (request.op == static_cast<uint32_t>(ShmRequestOp::kWrite)) {
+        // reference data in shared memory directly
+        context->op = LIBAIO_OP::LIBAIO_OP_WRITE;
+        buf->append_user_data(SlotData(request.slot), request.length,
+                              EmptyDeleter);
+        rc = fileManager_->AioWrite(fd_, context);
+    } else {
+        context->op = LIBAIO_OP::LIBAIO_OP_READ;
+        rc = fileManager_->AioRead(fd_, context);
+    }
+
+    if (rc < 0) {
+        LOG(ERROR) << "Submit shm request failed, fd = " << fd_
+                   << ", " << *context;
+        uint32_t slot = request.slot;
+        delete buf;
+        delete context;
+        Complete(slot, -1);
+    }
+    return true;
+}
+
+void NebdShmFileChannel::Complete(uint32_t slot, int ret) {
+    ShmCompletion completion;
+    completion.slot = slot;
+    completion.ret = ret;
+
+    {
+        std::lock_guard<std::mutex> lk(completionMtx_);
+        // keep completions in order, and never drop one when part1 has
+        // not consumed the completion ring yet
+        if (!pendingCompletions_.empty() ||
+            !ring_->PushCompletion(completion)) {
+            pendingCompletions_.push_back(completion);
+            FlushPendingCompletions();
+        }
+        --inflight_;
+        inflightCv_.notify_all();
+    }
+
+    NotifyEventFd(completionEventFd_);
+}
+
+void NebdShmFileChannel::FlushPendingCompletions() {
+    size_t pushed = 0;
+    while (pushed < pendingCompletions_.size() &&
+           ring_->PushCompletion(pendingCompletions_[pushed])) {
+        ++pushed;
+    }
+    pendingCompletions_.erase(pendingCompletions_.begin(),
+                              pendingCompletions_.begin() + pushed);
+}
+
+void NebdShmFileChannel::RetryPendingCompletions() {
+    {
+        std::lock_guard<std::mutex> lk(completionMtx_);
+        FlushPendingCompletions();
+    }
+
+    NotifyEventFd(completionEventFd_);
+}
+
+void NebdShmFileChannel::Detach() {
+    {
+        std::unique_lock<std::mutex> lk(completionMtx_);
+        while (running_.load(std::memory_order_acquire) &&
+               (inflight_ != 0 || !pendingCompletions_.empty())) {
+            inflightCv_.wait_for(
+                lk, std::chrono::milliseconds(kPendingCompletionRetryMs));
+            FlushPendingCompletions();
+        }
+
+        // stopped by the service, part1 sees the connection closed after
+        // all inflight requests finish
+        if (inflight_ != 0 || !pendingCompletions_.empty()) {
+            return;
+        }
+    }
+
+    NotifyEventFd(completionEventFd_);
+
+    // all completions are in the ring before the reply, requests left in
+    // the request ring are never picked up by this channel
+    ShmDetachResponse response;
+    response.ret = 0;
+    if (nebd::common::SendWithFds(sock_, &response, sizeof(response),
+                                  nullptr, 0) != 0) {
+        LOG(ERROR) << "Send shm detach response failed, fd = " << fd_;
+    }
+}
+
+NebdShmService::NebdShmService(NebdFileManagerPtr fileManager)
+    : fileManager_(std::move(fileManager)), listenFd_(-1), running_(false) {}
+
+NebdShmService::~NebdShmService() {
+    Stop();
+}
+
+int NebdShmService::Start(const std::string& address) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (address.size() >= sizeof(addr.sun_path)) {
+        LOG(ERROR) << "Shm address is too long, address = " << address;
+        return -1;
+    }
+    memcpy(addr.sun_path, address.c_str(), address.size());
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        LOG(ERROR) << "Create socket failed, error = " << strerror(errno);
+        return -1;
+    }
+
+    // remove socket file left by last run, caller holds the server file lock
+    unlink(address.c_str());
+    if (bind(listenFd_, reinterpret_cast<struct sockaddr*>(&addr),
+             sizeof(addr)) != 0 ||
+        listen(listenFd_, SOMAXCONN) != 0) {
+        LOG(ERROR) << "Listen on " << address
+                   << " failed, error = " << strerror(errno);
+        close(listenFd_);
+        listenFd_ = -1;
+        return -1;
+    }
+
+    // let everyone can connect to this socket
+    if (chmod(address.c_str(), 0777) != 0) {
+        LOG(ERROR) << "chmod " << address
+                   << " mode to 0777 failed, error: " << strerror(errno);
+        close(listenFd_);
+        listenFd_ = -1;
+        unlink(address.c_str());
+        return -1;
+    }
+
+    address_ = address;
+    running_.store(true, std::memory_order_release);
+    acceptThread_ = std::thread(&NebdShmService::AcceptLoop, this);
+    LOG(INFO) << "Shm service started, address = " << address;
+    return 0;
+}
+
+void NebdShmService::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (acceptThread_.joinable()) {
+        acceptThread_.join();
+    }
+
+    close(listenFd_);
+    listenFd_ = -1;
+    unlink(address_.c_str());
+
+    std::list<NebdShmFileChannelPtr> channels;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        channels.swap(channels_);
+    }
+    for (auto& channel : channels) {
+        channel->Stop();
+    }
+
+    LOG(INFO) << "Shm service stopped";
+}
+
+void NebdShmService::AcceptLoop() {
+    // connections are handled only after the attach request arrives,
+    // so a slow or stuck part1 never blocks the others
+    std::vector<PendingAttach> pending;
+    std::vector<struct pollfd> fds;
+
+    while (running_.load(std::memory_order_acquire)) {
+        fds.clear();
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (const auto& attach : pending) {
+            fds.push_back({attach.sock, POLLIN, 0});
+        }
+
+        int ret = poll(fds.data(), fds.size(), kAcceptPollTimeoutMs);
+        ReapChannels();
+        if (ret < 0) {
+            continue;
+        }
+
+        uint64_t now = TimeUtility::GetTimeofDayMs();
+        std::vector<PendingAttach> waiting;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (fds[i + 1].revents != 0) {
+                HandleAttach(pending[i].sock);
+            } else if (now >= pending[i].deadlineMs) {
+                LOG(WARNING) << "Wait shm attach request timeout";
+                close(pending[i].sock);
+            } else {
+                waiting.push_back(pending[i]);
+            }
+        }
+        pending.swap(waiting);
+
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        int sock = accept4(listenFd_, nullptr, nullptr,
+                           SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (sock < 0) {
+            LOG(WARNING) << "Accept failed, error = " << strerror(errno);
+            continue;
+        }
+
+        pending.push_back({sock, now + kAttachTimeoutMs});
+    }
+
+    for (const auto& attach : pending) {
+        close(attach.sock);
+    }
+}
+
+void NebdShmService::HandleAttach(int sock) {
+    ShmAttachRequest request;
+    int fds[nebd::common::kShmAttachFdNum] = {-1, -1, -1};
+    if (nebd::common::RecvWithFds(sock, &request, sizeof(request), fds,
+                                  nebd::common::kShmAttachFdNum) != 0) {
+        LOG(ERROR) << "Receive shm attach request failed";
+        close(sock);
+        return;
+    }
+
+    // memfd is only needed for mapping
+    int memfd = fds[0];
+    int requestEventFd = fds[1];
+    int completionEventFd = fds[2];
+
+    ShmAttachResponse response;
+    response.ret = -1;
+
+    std::unique_ptr<ShmRing> ring;
+    if (request.magic != nebd::common::kShmRingMagic) {
+        LOG(ERROR) << "Invalid shm attach request, magic = " << request.magic;
+    } else if (fileManager_->GetFileEntity(request.fd) == nullptr) {
+        LOG(ERROR) << "Attach shm channel to unknown file, fd = "
+                   << request.fd;
+    } else {
+        ring.reset(ShmRing::Attach(memfd));
+    }
+    close(memfd);
+
+    if (ring == nullptr) {
+        nebd::common::SendWithFds(sock, &response, sizeof(response),
+                                  nullptr, 0);
+        close(requestEventFd);
+        close(completionEventFd);
+        close(sock);
+        return;
+    }
+
+    auto channel = std::make_shared<NebdShmFileChannel>(
+        request.fd, fileManager_, std::move(ring), requestEventFd,
+        completionEventFd, sock);
+
+    response.ret = 0;
+    if (nebd::common::SendWithFds(sock, &response, sizeof(response),
+                                  nullptr, 0) != 0) {
+        LOG(ERROR) << "Send shm attach response failed, fd = " << request.fd;
+        return;
+    }
+
+    channel->Start();
+    LOG(INFO) << "Shm channel attached, fd = " << request.fd;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    channels_.push_back(std::move(channel));
+}
+
+void NebdShmService::ReapChannels() {
+    std::list<NebdShmFileChannelPtr> stopped;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (auto iter = channels_.begin(); iter != channels_.end();) {
+            if ((*iter)->IsStopped()) {
+                stopped.push_back(std::move(*iter));
+                iter = channels_.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    // inflight requests hold the channel, it is released after they finish
+    for (auto& channel : stopped) {
+        channel->Stop();
+        LOG(INFO) << "Shm channel detached, fd = " << channel->Fd();
+    }
+}
+
+}  // namespace server
+}  // namespace nebd
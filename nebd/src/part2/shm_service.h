@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#ifndef NEBD_SRC_PART2_SHM_SERVICE_H_
+#define NEBD_SRC_PART2_SHM_SERVICE_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/common/shm_ring.h"
+#include "nebd/src/part2/file_manager.h"
+
+namespace nebd {
+namespace server {
+
+using nebd::common::ShmCompletion;
+using nebd::common::ShmRing;
+using nebd::common::ShmRequest;
+
+/**
+ * 单个文件的共享内存通道。
+ * 由part1通过共享内存环提交读写请求，写请求直接引用共享内存中的数据，
+ * 读请求完成后将数据拷贝到共享内存，然后通过完成环通知part1。
+ * 未完成的请求持有通道，通道只有在所有取出的请求完成后才会释放并关闭连接，
+ * part1据此判断请求环中剩余的请求不会再被执行。
+ */
+class NebdShmFileChannel
+    : public std::enable_shared_from_this<NebdShmFileChannel> {
+ public:
+    NebdShmFileChannel(int fd, NebdFileManagerPtr fileManager,
+                       std::unique_ptr<ShmRing> ring, int requestEventFd,
+                       int completionEventFd, int sock);
+
+    ~NebdShmFileChannel();
+
+    void Start();
+
+    void Stop();
+
+    // part1断开连接或者detach后，通道停止处理新的请求
+    bool IsStopped() const {
+        return stopped_.load(std::memory_order_acquire);
+    }
+
+    int Fd() const {
+        return fd_;
+    }
+
+    /**
+     * @brief 请求完成后通知part1
+     * @param slot 请求对应的请求槽
+     * @param ret 请求的返回值
+     */
+    void Complete(uint32_t slot, int ret);
+
+    char* SlotData(uint32_t slot) const {
+        return ring_->SlotData(slot);
+    }
+
+ private:
+    void RequestLoop();
+
+    // 返回false表示part1违反了协议，需要断开通道
+    bool HandleRequests();
+
+    bool HandleRequest(const ShmRequest& request);
+
+    // 等待已经取出的请求全部完成，然后回复part1的detach请求
+    void Detach();
+
+    // 将暂存的完成事件写入完成环，调用方需持有completionMtx_
+    void FlushPendingCompletions();
+
+    void RetryPendingCompletions();
+
+ private:
+    int fd_;
+    NebdFileManagerPtr fileManager_;
+    std::unique_ptr<ShmRing> ring_;
+    int requestEventFd_;
+    int completionEventFd_;
+    int sock_;
+
+    // 完成事件由多个回调线程写入，需要加锁，同时保护以下成员
+    std::mutex completionMtx_;
+    std::condition_variable inflightCv_;
+    // 已经从请求环取出但还没有写入完成事件的请求数量
+    uint32_t inflight_;
+    // 完成环已满时暂存的完成事件，等part1消费后再写入
+    std::vector<ShmCompletion> pendingCompletions_;
+
+    std::atomic<bool> running_;
+    std::atomic<bool> stopped_;
+    std::thread requestThread_;
+};
+
+using NebdShmFileChannelPtr = std::shared_ptr<NebdShmFileChannel>;
+
+/**
+ * 监听part1建立共享内存通道的请求，并管理所有共享内存通道
+ */
+class NebdShmService {
+ public:
+    explicit NebdShmService(NebdFileManagerPtr fileManager);
+
+    ~NebdShmService();
+
+    /**
+     * @brief 在unix socket地址上监听，并启动后台线程
+     * @return 成功返回0，失败返回-1
+     */
+    int Start(const std::string& address);
+
+    void Stop();
+
+ private:
+    void AcceptLoop();
+
+    // 处理已经可读的连接上的握手请求
+    void HandleAttach(int sock);
+
+    // 回收已经断开的通道
+    void ReapChannels();
+
+ private:
+    NebdFileManagerPtr fileManager_;
+    std::string address_;
+    int listenFd_;
+
+    std::mutex mtx_;
+    std::list<NebdShmFileChannelPtr> channels_;
+
+    std::atomic<bool> running_;
+    std::thread acceptThread_;
+};
+
+}  // namespace server
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART2_SHM_SERVICE_H_
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-14
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <linux/memfd.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <memory>
+
+#include "nebd/src/common/shm_ring.h"
+
+namespace nebd {
+namespace common {
+
+class ShmRingTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        memfd_ = syscall(SYS_memfd_create, "shm_ring_test", MFD_CLOEXEC);
+        ASSERT_GE(memfd_, 0);
+    }
+
+    void TearDown() override {
+        close(memfd_);
+    }
+
+    int memfd_ = -1;
+};
+
+TEST_F(ShmRingTest, CreateAndAttachTest) {
+    // entries must be power of two
+    ASSERT_EQ(nullptr, ShmRing::Create(memfd_, 3, 4096));
+    ASSERT_EQ(nullptr, ShmRing::Create(memfd_, 4, 0));
+
+    // empty memfd can't be attached
+    ASSERT_EQ(nullptr, ShmRing::Attach(memfd_));
+
+    std::unique_ptr<ShmRing> producer(ShmRing::Create(memfd_, 4, 4096));
+    ASSERT_NE(nullptr, producer);
+    std::unique_ptr<ShmRing> consumer(ShmRing::Attach(memfd_));
+    ASSERT_NE(nullptr, consumer);
+    ASSERT_EQ(4, consumer->Entries());
+    ASSERT_EQ(4096, consumer->SlotSize());
+
+    // data slots are shared
+    memset(producer->SlotData(3), 'a', 4096);
+    ASSERT_EQ('a', consumer->SlotData(3)[0]);
+    ASSERT_EQ('a', consumer->SlotData(3)[4095]);
+}
+
+TEST_F(ShmRingTest, AttachInvalidHeaderTest) {
+    std::unique_ptr<ShmRing> ring(ShmRing::Create(memfd_, 4, 4096));
+    ASSERT_NE(nullptr, ring);
+
+    // truncated mapping can't hold all slots
+    ASSERT_EQ(0, ftruncate(memfd_, ShmRing::MappingSize(4, 4096) - 1));
+    ASSERT_EQ(nullptr, ShmRing::Attach(memfd_));
+}
+
+TEST_F(ShmRingTest, RequestAndCompletionTest) {
+    std::unique_ptr<ShmRing> part1(ShmRing::Create(memfd_, 4, 4096));
+    ASSERT_NE(nullptr, part1);
+    std::unique_ptr<ShmRing> part2(ShmRing::Attach(memfd_));
+    ASSERT_NE(nullptr, part2);
+
+    ShmRequest request;
+    ASSERT_FALSE(part2->PopRequest(&request));
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        request.slot = i;
+        request.op = static_cast<uint32_t>(ShmRequestOp::kWrite);
+        request.offset = i * 4096;
+        request.length = 4096;
+        ASSERT_TRUE(part1->PushRequest(request));
+    }
+    // ring is full
+    ASSERT_FALSE(part1->PushRequest(request));
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(part2->PopRequest(&request));
+        ASSERT_EQ(i, request.slot);
+        ASSERT_EQ(i * 4096, request.offset);
+
+        ShmCompletion completion;
+        completion.slot = request.slot;
+        completion.ret = 0;
+        ASSERT_TRUE(part2->PushCompletion(completion));
+    }
+    ASSERT_FALSE(part2->PopRequest(&request));
+
+    // indexes wrap around
+    ASSERT_TRUE(part1->PushRequest(request));
+    ASSERT_TRUE(part2->PopRequest(&request));
+    ASSERT_EQ(3, request.slot);
+
+    ShmCompletion completion;
+    for (uint32_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(part1->PopCompletion(&completion));
+        ASSERT_EQ(i, completion.slot);
+        ASSERT_EQ(0, completion.ret);
+    }
+    ASSERT_FALSE(part1->PopCompletion(&completion));
+}
+
+TEST(ShmFdPassingTest, SendAndRecvTest) {
+    int socks[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, socks));
+
+    int efd = eventfd(0, EFD_NONBLOCK);
+    ASSERT_GE(efd, 0);
+
+    ShmAttachRequest request;
+    request.magic = kShmRingMagic;
+    request.fd = 10;
+    int fds[kShmAttachFdNum] = {efd, efd, efd};
+    ASSERT_EQ(0, SendWithFds(socks[0], &request, sizeof(request), fds,
+                             kShmAttachFdNum));
+
+    ShmAttachRequest received;
+    int receivedFds[kShmAttachFdNum] = {-1, -1, -1};
+    ASSERT_EQ(0, RecvWithFds(socks[1], &received, sizeof(received),
+                             receivedFds, kShmAttachFdNum));
+    ASSERT_EQ(kShmRingMagic, received.magic);
+    ASSERT_EQ(10, received.fd);
+
+    // received fd refers to the same eventfd
+    NotifyEventFd(receivedFds[0]);
+    uint64_t value = 0;
+    ASSERT_EQ(sizeof(value), read(efd, &value, sizeof(value)));
+    ASSERT_EQ(1, value);
+
+    // message without fds is rejected when fds are expected
+    ShmAttachResponse response;
+    response.ret = 0;
+    ASSERT_EQ(0, SendWithFds(socks[0], &response, sizeof(response),
+                             nullptr, 0));
+    ASSERT_EQ(-1, RecvWithFds(socks[1], &response, sizeof(response),
+                              receivedFds, kShmAttachFdNum));
+
+    for (int fd : receivedFds) {
+        close(fd);
+    }
+    close(efd);
+    close(socks[0]);
+    close(socks[1]);
+}
+
+}  // namespace common
+}  // namespace nebd
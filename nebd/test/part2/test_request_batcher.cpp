@@ -0,0 +1,271 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-17
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <bvar/bvar.h>
+
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "nebd/src/part2/request_batcher.h"
+#include "nebd/src/part2/request_executor_curve.h"
+#include "nebd/test/part2/mock_curve_client.h"
+
+namespace nebd {
+namespace server {
+
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace {
+
+std::mutex g_mtx;
+std::condition_variable g_cv;
+int g_doneCount = 0;
+
+void BatcherTestCallback(NebdServerAioContext* context) {
+    (void)context;
+    std::lock_guard<std::mutex> lk(g_mtx);
+    ++g_doneCount;
+    g_cv.notify_all();
+}
+
+void WaitDone(int count) {
+    std::unique_lock<std::mutex> lk(g_mtx);
+    g_cv.wait(lk, [count]() { return g_doneCount >= count; });
+}
+
+// fill read data with 'a' + offset / 4096, and complete it
+int FakeAioRead(int fd, CurveAioContext* ctx, curve::client::UserDataType) {
+    (void)fd;
+    butil::IOBuf* buf = static_cast<butil::IOBuf*>(ctx->buf);
+    for (uint64_t off = ctx->offset; off < ctx->offset + ctx->length;
+         off += 4096) {
+        buf->append(std::string(4096, 'a' + off / 4096));
+    }
+    ctx->ret = ctx->length;
+    ctx->cb(ctx);
+    return LIBCURVE_ERROR::OK;
+}
+
+}  // namespace
+
+class RequestBatcherTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        g_doneCount = 0;
+        client_ = std::make_shared<MockCurveClient>();
+    }
+
+    void TearDown() override {
+        for (auto* ctx : contexts_) {
+            delete reinterpret_cast<butil::IOBuf*>(ctx->buf);
+            delete ctx;
+        }
+    }
+
+    NebdServerAioContext* NewContext(LIBAIO_OP op, off_t offset,
+                                     size_t size) {
+        NebdServerAioContext* ctx = new NebdServerAioContext();
+        ctx->op = op;
+        ctx->offset = offset;
+        ctx->size = size;
+        ctx->cb = BatcherTestCallback;
+        butil::IOBuf* buf = new butil::IOBuf();
+        if (op == LIBAIO_OP::LIBAIO_OP_WRITE) {
+            buf->append(std::string(size, 'a' + offset / 4096));
+        }
+        ctx->buf = buf;
+        contexts_.push_back(ctx);
+        return ctx;
+    }
+
+    std::shared_ptr<MockCurveClient> client_;
+    std::vector<NebdServerAioContext*> contexts_;
+};
+
+TEST_F(RequestBatcherTest, SplitIntoBatchesTest) {
+    CurveRequestBatchOption option;
+    option.maxMergeBytes = 16 * 1024;
+    option.maxMergeRequests = 3;
+
+    std::vector<NebdServerAioContext*> requests{
+        NewContext(LIBAIO_OP::LIBAIO_OP_WRITE, 0, 4096),
+        NewContext(LIBAIO_OP::LIBAIO_OP_WRITE, 4096, 4096),
+        // not adjacent
+        NewContext(LIBAIO_OP::LIBAIO_OP_WRITE, 16384, 4096),
+        // different op
+        NewContext(LIBAIO_OP::LIBAIO_OP_READ, 20480, 4096),
+        NewContext(LIBAIO_OP::LIBAIO_OP_READ, 24576, 4096),
+        NewContext(LIBAIO_OP::LIBAIO_OP_READ, 28672, 4096),
+        // exceed request count limit
+        NewContext(LIBAIO_OP::LIBAIO_OP_READ, 32768, 4096),
+        // exceed bytes limit
+        NewContext(LIBAIO_OP::LIBAIO_OP_READ, 36864, 16384)};
+
+    std::vector<std::vector<NebdServerAioContext*>> batches;
+    CurveRequestBatcher::SplitIntoBatches(requests, option, &batches);
+
+    ASSERT_EQ(5, batches.size());
+    ASSERT_EQ(2, batches[0].size());
+    ASSERT_EQ(1, batches[1].size());
+    ASSERT_EQ(3, batches[2].size());
+    ASSERT_EQ(1, batches[3].size());
+    ASSERT_EQ(1, batches[4].size());
+    ASSERT_EQ(requests[6], batches[3][0]);
+}
+
+TEST_F(RequestBatcherTest, ReadDispatchTest) {
+    CurveRequestBatchOption option;
+    option.enable = true;
+    auto batcher = std::make_shared<CurveRequestBatcher>(
+        "/test", 1, client_.get(), option);
+    ASSERT_EQ(0, batcher->Start());
+
+    EXPECT_CALL(*client_, AioRead(1, _, _))
+        .Times(AnyNumber())
+        .WillRepeatedly(Invoke(FakeAioRead));
+
+    const int kRequests = 8;
+    for (int i = 0; i < kRequests; ++i) {
+        ASSERT_EQ(0, batcher->Submit(NewContext(LIBAIO_OP::LIBAIO_OP_READ,
+                                               i * 4096, 4096)));
+    }
+    WaitDone(kRequests);
+
+    // no matter how requests are merged, each one gets its own data
+    for (int i = 0; i < kRequests; ++i) {
+        auto* ctx = contexts_[i];
+        ASSERT_EQ(4096, ctx->ret);
+        ASSERT_EQ(std::string(4096, 'a' + i),
+                  reinterpret_cast<butil::IOBuf*>(ctx->buf)->to_string());
+    }
+
+    batcher->Stop();
+}
+
+TEST_F(RequestBatcherTest, WriteFailTest) {
+    CurveRequestBatchOption option;
+    option.enable = true;
+    auto batcher = std::make_shared<CurveRequestBatcher>(
+        "/test", 1, client_.get(), option);
+    ASSERT_EQ(0, batcher->Start());
+
+    EXPECT_CALL(*client_, AioWrite(1, _, _))
+        .Times(AnyNumber())
+        .WillRepeatedly(Return(-LIBCURVE_ERROR::FAILED));
+
+    // discard is not queued
+    ASSERT_EQ(-1, batcher->Submit(
+                      NewContext(LIBAIO_OP::LIBAIO_OP_DISCARD, 0, 4096)));
+
+    const int kRequests = 4;
+    for (int i = 0; i < kRequests; ++i) {
+        ASSERT_EQ(0, batcher->Submit(NewContext(LIBAIO_OP::LIBAIO_OP_WRITE,
+                                               i * 4096, 4096)));
+    }
+    WaitDone(kRequests);
+
+    // submit failure is returned to every request
+    for (int i = 1; i <= kRequests; ++i) {
+        ASSERT_LT(contexts_[i]->ret, 0);
+    }
+
+    batcher->Stop();
+}
+
+TEST_F(RequestBatcherTest, BatcherOutlivesFileTest) {
+    CurveRequestBatchOption option;
+    option.enable = true;
+    auto batcher = std::make_shared<CurveRequestBatcher>(
+        "/test", 1, client_.get(), option);
+    ASSERT_EQ(0, batcher->Start());
+
+    std::mutex mtx;
+    std::vector<CurveAioContext*> inflight;
+    EXPECT_CALL(*client_, AioWrite(1, _, _))
+        .Times(AnyNumber())
+        .WillRepeatedly(Invoke([&](int, CurveAioContext* ctx,
+                                   curve::client::UserDataType) {
+            std::lock_guard<std::mutex> lk(mtx);
+            inflight.push_back(ctx);
+            return LIBCURVE_ERROR::OK;
+        }));
+
+    const int kRequests = 4;
+    for (int i = 0; i < kRequests; ++i) {
+        ASSERT_EQ(0, batcher->Submit(NewContext(LIBAIO_OP::LIBAIO_OP_WRITE,
+                                                i * 4096, 4096)));
+    }
+
+    // 文件关闭后，未完成的请求仍然持有队列
+    batcher->Stop();
+    std::weak_ptr<CurveRequestBatcher> weak = batcher;
+    batcher.reset();
+    ASSERT_FALSE(weak.expired());
+
+    std::vector<CurveAioContext*> requests;
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        requests.swap(inflight);
+    }
+    ASSERT_FALSE(requests.empty());
+    for (auto* ctx : requests) {
+        ctx->ret = ctx->length;
+        ctx->cb(ctx);
+    }
+
+    WaitDone(kRequests);
+    for (int i = 0; i < kRequests; ++i) {
+        ASSERT_EQ(4096, contexts_[i]->ret);
+    }
+    ASSERT_TRUE(weak.expired());
+}
+
+TEST_F(RequestBatcherTest, ReopenFileMetricTest) {
+    CurveRequestBatchOption option;
+    option.enable = true;
+    const size_t exposed = bvar::Variable::count_exposed();
+    auto batcher = std::make_shared<CurveRequestBatcher>(
+        "/test", 1, client_.get(), option);
+    ASSERT_EQ(0, batcher->Start());
+    ASSERT_EQ(exposed + 3, bvar::Variable::count_exposed());
+
+    // 关闭后的队列可能仍被未完成的请求持有，不能占用指标名
+    batcher->Stop();
+    ASSERT_EQ(exposed, bvar::Variable::count_exposed());
+
+    auto reopened = std::make_shared<CurveRequestBatcher>(
+        "/test", 2, client_.get(), option);
+    ASSERT_EQ(0, reopened->Start());
+    ASSERT_EQ(exposed + 3, bvar::Variable::count_exposed());
+    reopened->Stop();
+    ASSERT_EQ(exposed, bvar::Variable::count_exposed());
+}
+
+}  // namespace server
+}  // namespace nebd
@@ -0,0 +1,448 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2022-10-20
+ * Author: curve
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <butil/iobuf.h>
+#include <linux/memfd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/common/shm_ring.h"
+#include "nebd/src/part1/shm_channel.h"
+#include "nebd/src/part2/shm_service.h"
+#include "nebd/test/part2/mock_file_entity.h"
+#include "nebd/test/part2/mock_file_manager.h"
+
+namespace nebd {
+namespace server {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+using nebd::client::ShmChannel;
+using nebd::common::NotifyEventFd;
+using nebd::common::ShmRequestOp;
+
+const char kShmAddress[] = "./nebd_shm_service_test.sock";
+const int kTestFd = 1;
+const int kUnknownFd = 2;
+const size_t kTestLength = 4096;
+
+// part1侧的请求，aioctx必须是第一个成员，回调中据此转换
+struct ShmTestRequest {
+    NebdClientAioContext aioctx;
+    std::vector<char> data;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+};
+
+void ShmTestCallback(NebdClientAioContext* aioctx) {
+    ShmTestRequest* request = reinterpret_cast<ShmTestRequest*>(aioctx);
+    std::lock_guard<std::mutex> lk(request->mtx);
+    request->done = true;
+    request->cv.notify_all();
+}
+
+bool WaitDone(ShmTestRequest* request, int timeoutMs) {
+    std::unique_lock<std::mutex> lk(request->mtx);
+    return request->cv.wait_for(lk, std::chrono::milliseconds(timeoutMs),
+                                [request] { return request->done; });
+}
+
+bool WaitFor(std::function<bool()> cond, int timeoutMs) {
+    for (int i = 0; i < timeoutMs / 10; ++i) {
+        if (cond()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return cond();
+}
+
+class ShmServiceTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        fileManager_ = std::make_shared<MockFileManager>();
+        EXPECT_CALL(*fileManager_, GetFileEntity(kTestFd))
+            .WillRepeatedly(Return(std::make_shared<MockFileEntity>()));
+        EXPECT_CALL(*fileManager_, GetFileEntity(kUnknownFd))
+            .WillRepeatedly(Return(nullptr));
+
+        service_.reset(new NebdShmService(fileManager_));
+        ASSERT_EQ(0, service_->Start(kShmAddress));
+
+        option_.enable = true;
+        option_.ringEntries = 4;
+        option_.slotSize = kTestLength;
+        option_.detachTimeoutMs = 3000;
+        option_.reconnectIntervalMs = 100;
+    }
+
+    void TearDown() override {
+        channel_.reset();
+        service_->Stop();
+    }
+
+    void CreateChannel(int fd) {
+        channel_.reset(new ShmChannel(
+            fd, option_, [this](int, NebdClientAioContext* aioctx) {
+                std::lock_guard<std::mutex> lk(fallbackMtx_);
+                fallbacks_.push_back(aioctx);
+            }));
+    }
+
+    size_t FallbackCount() {
+        std::lock_guard<std::mutex> lk(fallbackMtx_);
+        return fallbacks_.size();
+    }
+
+    void InitRequest(ShmTestRequest* request, ::LIBAIO_OP op, char c) {
+        request->data.assign(kTestLength, c);
+        request->aioctx.offset = 0;
+        request->aioctx.length = kTestLength;
+        request->aioctx.ret = -1;
+        request->aioctx.op = op;
+        request->aioctx.cb = ShmTestCallback;
+        request->aioctx.buf = request->data.data();
+        request->aioctx.retryCount = 0;
+    }
+
+ protected:
+    std::shared_ptr<MockFileManager> fileManager_;
+    std::unique_ptr<NebdShmService> service_;
+    ShmOption option_;
+    std::unique_ptr<ShmChannel> channel_;
+
+    std::mutex fallbackMtx_;
+    std::vector<NebdClientAioContext*> fallbacks_;
+};
+
+TEST_F(ShmServiceTest, ReadWriteTest) {
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+    ASSERT_TRUE(channel_->IsConnected());
+
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([](int, NebdServerAioContext* context) {
+            butil::IOBuf* buf = reinterpret_cast<butil::IOBuf*>(context->buf);
+            EXPECT_EQ(std::string(kTestLength, 'a'), buf->to_string());
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    ShmTestRequest write;
+    InitRequest(&write, ::LIBAIO_OP_WRITE, 'a');
+    ASSERT_TRUE(channel_->Submit(&write.aioctx));
+    ASSERT_TRUE(WaitDone(&write, 3000));
+    ASSERT_EQ(0, write.aioctx.ret);
+
+    EXPECT_CALL(*fileManager_, AioRead(kTestFd, _))
+        .WillOnce(Invoke([](int, NebdServerAioContext* context) {
+            butil::IOBuf* buf = reinterpret_cast<butil::IOBuf*>(context->buf);
+            std::string data(context->size, 'b');
+            buf->append(data.data(), data.size());
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    ShmTestRequest read;
+    InitRequest(&read, ::LIBAIO_OP_READ, 0);
+    ASSERT_TRUE(channel_->Submit(&read.aioctx));
+    ASSERT_TRUE(WaitDone(&read, 3000));
+    ASSERT_EQ(0, read.aioctx.ret);
+    ASSERT_EQ(std::string(kTestLength, 'b'),
+              std::string(read.data.begin(), read.data.end()));
+
+    ASSERT_EQ(0, FallbackCount());
+}
+
+TEST_F(ShmServiceTest, FailedRequestFallbackTest) {
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+
+    // part2提交失败和执行失败的请求都交给rpc通道
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Return(-1));
+    EXPECT_CALL(*fileManager_, AioRead(kTestFd, _))
+        .WillOnce(Invoke([](int, NebdServerAioContext* context) {
+            context->ret = -1;
+            context->cb(context);
+            return 0;
+        }));
+
+    ShmTestRequest write;
+    InitRequest(&write, ::LIBAIO_OP_WRITE, 'a');
+    ASSERT_TRUE(channel_->Submit(&write.aioctx));
+    ShmTestRequest read;
+    InitRequest(&read, ::LIBAIO_OP_READ, 0);
+    ASSERT_TRUE(channel_->Submit(&read.aioctx));
+
+    ASSERT_TRUE(WaitFor([this] { return FallbackCount() == 2; }, 3000));
+    ASSERT_FALSE(write.done);
+    ASSERT_FALSE(read.done);
+}
+
+TEST_F(ShmServiceTest, RequestFallbackToRpcTest) {
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+
+    // 超过请求槽大小以及非读写请求走rpc
+    ShmTestRequest request;
+    InitRequest(&request, ::LIBAIO_OP_WRITE, 'a');
+    request.aioctx.length = kTestLength + 1;
+    ASSERT_FALSE(channel_->Submit(&request.aioctx));
+    InitRequest(&request, ::LIBAIO_OP_FLUSH, 0);
+    ASSERT_FALSE(channel_->Submit(&request.aioctx));
+
+    // 请求槽用完之后走rpc
+    std::vector<NebdServerAioContext*> contexts;
+    std::mutex mtx;
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .Times(option_.ringEntries)
+        .WillRepeatedly(Invoke([&](int, NebdServerAioContext* context) {
+            std::lock_guard<std::mutex> lk(mtx);
+            contexts.push_back(context);
+            return 0;
+        }));
+    std::vector<std::unique_ptr<ShmTestRequest>> requests;
+    for (uint32_t i = 0; i < option_.ringEntries; ++i) {
+        requests.emplace_back(new ShmTestRequest());
+        InitRequest(requests.back().get(), ::LIBAIO_OP_WRITE, 'a');
+        ASSERT_TRUE(channel_->Submit(&requests.back()->aioctx));
+    }
+    InitRequest(&request, ::LIBAIO_OP_WRITE, 'a');
+    ASSERT_FALSE(channel_->Submit(&request.aioctx));
+
+    ASSERT_TRUE(WaitFor([&] {
+        std::lock_guard<std::mutex> lk(mtx);
+        return contexts.size() == option_.ringEntries;
+    }, 3000));
+    for (auto* context : contexts) {
+        context->ret = 0;
+        context->cb(context);
+    }
+    for (auto& r : requests) {
+        ASSERT_TRUE(WaitDone(r.get(), 3000));
+        ASSERT_EQ(0, r->aioctx.ret);
+    }
+    ASSERT_EQ(0, FallbackCount());
+}
+
+TEST_F(ShmServiceTest, AttachUnknownFileTest) {
+    CreateChannel(kUnknownFd);
+    ASSERT_EQ(-1, channel_->Init(kShmAddress));
+    ASSERT_FALSE(channel_->IsConnected());
+}
+
+TEST_F(ShmServiceTest, AttachNotBlockedBySlowClientTest) {
+    // 只建立连接而不发送握手请求的客户端不能阻塞其他客户端
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(sock, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, kShmAddress, sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(0, connect(sock, reinterpret_cast<struct sockaddr*>(&addr),
+                         sizeof(addr)));
+
+    auto start = std::chrono::steady_clock::now();
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_LT(elapsed, std::chrono::milliseconds(1000));
+
+    close(sock);
+}
+
+TEST_F(ShmServiceTest, StopWaitForInflightRequestsTest) {
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+
+    std::atomic<NebdServerAioContext*> context(nullptr);
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([&](int, NebdServerAioContext* ctx) {
+            context.store(ctx);
+            return 0;
+        }));
+    ShmTestRequest write;
+    InitRequest(&write, ::LIBAIO_OP_WRITE, 'a');
+    ASSERT_TRUE(channel_->Submit(&write.aioctx));
+    ASSERT_TRUE(WaitFor([&] { return context.load() != nullptr; }, 3000));
+
+    // part2正在执行的请求完成之前，Stop不能将其交给rpc重新发送
+    std::atomic<bool> stopped(false);
+    std::thread stopper([&] {
+        channel_->Stop();
+        stopped.store(true);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_FALSE(stopped.load());
+    ASSERT_FALSE(write.done);
+    ASSERT_EQ(0, FallbackCount());
+
+    // 通道停止之后的请求都走rpc
+    ShmTestRequest read;
+    InitRequest(&read, ::LIBAIO_OP_READ, 0);
+    ASSERT_FALSE(channel_->Submit(&read.aioctx));
+
+    context.load()->ret = 0;
+    context.load()->cb(context.load());
+    stopper.join();
+
+    ASSERT_TRUE(write.done);
+    ASSERT_EQ(0, write.aioctx.ret);
+    ASSERT_EQ(0, FallbackCount());
+}
+
+TEST_F(ShmServiceTest, StopDetachTimeoutTest) {
+    option_.detachTimeoutMs = 200;
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+
+    std::atomic<NebdServerAioContext*> context(nullptr);
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([&](int, NebdServerAioContext* ctx) {
+            context.store(ctx);
+            return 0;
+        }));
+    ShmTestRequest write;
+    InitRequest(&write, ::LIBAIO_OP_WRITE, 'a');
+    ASSERT_TRUE(channel_->Submit(&write.aioctx));
+    ASSERT_TRUE(WaitFor([&] { return context.load() != nullptr; }, 3000));
+
+    // 无法确认part2是否执行了请求，请求返回失败而不是重新发送
+    channel_->Stop();
+    ASSERT_TRUE(write.done);
+    ASSERT_EQ(-1, write.aioctx.ret);
+    ASSERT_EQ(0, FallbackCount());
+
+    context.load()->ret = 0;
+    context.load()->cb(context.load());
+}
+
+TEST_F(ShmServiceTest, ReconnectAfterPart2RestartTest) {
+    CreateChannel(kTestFd);
+    ASSERT_EQ(0, channel_->Init(kShmAddress));
+
+    service_->Stop();
+    ASSERT_TRUE(WaitFor([this] { return !channel_->IsConnected(); }, 3000));
+    ShmTestRequest write;
+    InitRequest(&write, ::LIBAIO_OP_WRITE, 'a');
+    ASSERT_FALSE(channel_->Submit(&write.aioctx));
+
+    service_.reset(new NebdShmService(fileManager_));
+    ASSERT_EQ(0, service_->Start(kShmAddress));
+    ASSERT_TRUE(WaitFor([this] { return channel_->IsConnected(); }, 5000));
+
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([](int, NebdServerAioContext* context) {
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    ASSERT_TRUE(channel_->Submit(&write.aioctx));
+    ASSERT_TRUE(WaitDone(&write, 3000));
+    ASSERT_EQ(0, write.aioctx.ret);
+    ASSERT_EQ(0, FallbackCount());
+}
+
+TEST_F(ShmServiceTest, InvalidSlotTearDownChannelTest) {
+    int memfd = syscall(SYS_memfd_create, "nebd_shm_service_test",
+                        MFD_CLOEXEC);
+    ASSERT_GE(memfd, 0);
+    std::unique_ptr<ShmRing> clientRing(
+        ShmRing::Create(memfd, 4, kTestLength));
+    ASSERT_NE(nullptr, clientRing);
+    std::unique_ptr<ShmRing> serverRing(ShmRing::Attach(memfd));
+    ASSERT_NE(nullptr, serverRing);
+    close(memfd);
+
+    int requestEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int completionEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(requestEventFd, 0);
+    ASSERT_GE(completionEventFd, 0);
+    int socks[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, socks));
+
+    std::atomic<NebdServerAioContext*> context(nullptr);
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([&](int, NebdServerAioContext* ctx) {
+            context.store(ctx);
+            return 0;
+        }));
+
+    auto channel = std::make_shared<NebdShmFileChannel>(
+        kTestFd, fileManager_, std::move(serverRing), requestEventFd,
+        completionEventFd, socks[1]);
+    channel->Start();
+
+    ShmRequest request;
+    request.slot = 0;
+    request.op = static_cast<uint32_t>(ShmRequestOp::kWrite);
+    request.offset = 0;
+    request.length = kTestLength;
+    ASSERT_TRUE(clientRing->PushRequest(request));
+    request.slot = 100;
+    ASSERT_TRUE(clientRing->PushRequest(request));
+    NotifyEventFd(requestEventFd);
+
+    // 越界的请求槽无法回复，通道停止处理请求
+    ASSERT_TRUE(WaitFor([&] { return channel->IsStopped(); }, 3000));
+    ASSERT_TRUE(WaitFor([&] { return context.load() != nullptr; }, 3000));
+    channel->Stop();
+    channel.reset();
+
+    // 已经取出的请求完成之前不能关闭连接
+    char c;
+    ASSERT_EQ(-1, recv(socks[0], &c, 1, MSG_DONTWAIT));
+    ASSERT_EQ(EAGAIN, errno);
+
+    // 请求完成后通道析构并关闭连接，part1据此将剩余的请求交给rpc
+    context.load()->ret = 0;
+    context.load()->cb(context.load());
+    ShmCompletion completion;
+    ASSERT_TRUE(clientRing->PopCompletion(&completion));
+    ASSERT_EQ(0, completion.slot);
+    ASSERT_EQ(0, completion.ret);
+    ASSERT_FALSE(clientRing->PopCompletion(&completion));
+    ASSERT_EQ(0, recv(socks[0], &c, 1, MSG_DONTWAIT));
+    close(socks[0]);
+}
+
+}  // namespace server
+}  // namespace nebd
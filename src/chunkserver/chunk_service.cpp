@@ -26,6 +26,8 @@
 #include <brpc/closure_guard.h>
 #include <brpc/controller.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <cerrno>
 #include <vector>
@@ -35,6 +37,7 @@
 #include "src/chunkserver/chunkserver_metrics.h"
 #include "src/chunkserver/op_request.h"
 #include "src/chunkserver/chunk_service_closure.h"
+#include "src/chunkserver/clone_access_tracker.h"
 #include "src/common/fast_align.h"
 
 #include "include/curve_compiler_specific.h"
@@ -44,6 +47,126 @@ namespace chunkserver {
 
 using ::curve::common::is_aligned;
 
+namespace {
+
+// DeleteChunks中所有chunk op共享的上下文，最后一个op完成时汇总结果
+struct DeleteChunksContext {
+    DeleteChunksContext(const DeleteChunksRequest *req,
+                        DeleteChunksResponse *resp,
+                        Closure *d)
+        : response(resp), done(d),
+          requests(req->chunkid_size()), responses(req->chunkid_size()),
+          pending(req->chunkid_size()) {}
+
+    void Finish() {
+        brpc::ClosureGuard doneGuard(done);
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        for (const auto &resp : responses) {
+            CHUNK_OP_STATUS status = resp.status();
+            if (status == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS ||
+                status == CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_NOTEXIST) {
+                continue;
+            }
+            response->set_status(status);
+            if (resp.has_redirect()) {
+                response->set_redirect(resp.redirect());
+            }
+            // 非leader时优先返回重定向，方便mds直接切换leader重试
+            if (status == CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED) {
+                break;
+            }
+        }
+    }
+
+    DeleteChunksResponse *response;
+    Closure *done;
+    std::vector<ChunkRequest> requests;
+    std::vector<ChunkResponse> responses;
+    std::atomic<int> pending;
+};
+
+class DeleteChunksItemClosure : public Closure {
+ public:
+    explicit DeleteChunksItemClosure(std::shared_ptr<DeleteChunksContext> ctx)
+        : ctx_(ctx) {}
+
+    void Run() override {
+        std::unique_ptr<DeleteChunksItemClosure> selfGuard(this);
+        if (ctx_->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ctx_->Finish();
+        }
+    }
+
+ private:
+    std::shared_ptr<DeleteChunksContext> ctx_;
+};
+
+// CreateCloneChunks/RecoverChunks拆分成单个chunk的op时共享的上下文，
+// 最后一个op完成时汇总结果
+struct CloneChunksContext {
+    CloneChunksContext(const ChunkRequest *req,
+                       ChunkResponse *resp,
+                       Closure *d)
+        : response(resp), done(d),
+          requests(req->clonechunks_size()),
+          responses(req->clonechunks_size()),
+          pending(req->clonechunks_size()) {}
+
+    void Finish() {
+        brpc::ClosureGuard doneGuard(done);
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        uint64_t appliedIndex = 0;
+        for (size_t i = 0; i < responses.size(); ++i) {
+            const ChunkResponse &resp = responses[i];
+            appliedIndex = std::max(appliedIndex, resp.appliedindex());
+            CHUNK_OP_STATUS status = resp.status();
+            if (status == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+                continue;
+            }
+            if (status == CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_EXIST) {
+                response->add_existchunks(requests[i].chunkid());
+                continue;
+            }
+            if (response->status() ==
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED) {
+                continue;
+            }
+            // 非leader时优先返回重定向，方便克隆服务直接切换leader重试
+            response->set_status(status);
+            if (resp.has_redirect()) {
+                response->set_redirect(resp.redirect());
+            }
+        }
+        if (appliedIndex > 0) {
+            response->set_appliedindex(appliedIndex);
+        }
+    }
+
+    ChunkResponse *response;
+    Closure *done;
+    std::vector<ChunkRequest> requests;
+    std::vector<ChunkResponse> responses;
+    std::atomic<int> pending;
+};
+
+class CloneChunksItemClosure : public Closure {
+ public:
+    explicit CloneChunksItemClosure(std::shared_ptr<CloneChunksContext> ctx)
+        : ctx_(ctx) {}
+
+    void Run() override {
+        std::unique_ptr<CloneChunksItemClosure> selfGuard(this);
+        if (ctx_->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ctx_->Finish();
+        }
+    }
+
+ private:
+    std::shared_ptr<CloneChunksContext> ctx_;
+};
+
+}  // namespace
+
 ChunkServiceImpl::ChunkServiceImpl(
         const ChunkServiceOptions& chunkServiceOptions,
         const std::shared_ptr<EpochMap>& epochMap)
@@ -315,6 +438,22 @@ void ChunkServiceImpl::RecoverChunk(RpcController *controller,
         return;
     }
 
+    // 带上同一copyset中最近被读穿透的chunk，克隆服务据此调整恢复顺序
+    // 当前请求的chunk已经在恢复了，不再返回
+    auto accessTracker = chunkServiceOptions_.cloneAccessTracker;
+    if (nullptr != accessTracker) {
+        accessTracker->Remove(request->logicpoolid(),
+                              request->copysetid(),
+                              request->chunkid());
+        std::vector<ChunkID> hotChunks;
+        accessTracker->List(request->logicpoolid(),
+                            request->copysetid(),
+                            &hotChunks);
+        for (ChunkID chunkId : hotChunks) {
+            response->add_hotclonechunks(chunkId);
+        }
+    }
+
     // RecoverChunk请求和ReadChunk请求共用ReadChunkRequest
     std::shared_ptr<ReadChunkRequest> req =
         std::make_shared<ReadChunkRequest>(nodePtr,
@@ -480,6 +619,18 @@ void ChunkServiceImpl::GetChunkInfo(RpcController *controller,
         response->add_chunksn(chunkInfo.curSn);
         if (chunkInfo.snapSn > 0)
             response->add_chunksn(chunkInfo.snapSn);
+        // 返回快照数据相对于更早快照的变化块，供增量快照跳过未变化的数据
+        ChangedBlocks changedBlocks;
+        ret = nodePtr->GetDataStore()->GetChunkChangedBlocks(
+            request->chunkid(), &changedBlocks);
+        if (CSErrorCode::Success == ret && changedBlocks.bitmap != nullptr) {
+            const Bitmap& bitmap = *changedBlocks.bitmap;
+            response->set_changedbasesn(changedBlocks.baseSn);
+            response->set_changedblocksize(
+                chunkInfo.chunkSize / bitmap.Size());
+            response->set_changedbitmap(bitmap.GetBitmap(),
+                                        (bitmap.Size() + 8 - 1) / 8);
+        }
         response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
     } else if (CSErrorCode::ChunkNotExistError == ret) {
         // 2.chunk文件不存在，返回的版本集合为空
@@ -577,6 +728,252 @@ void ChunkServiceImpl::UpdateEpoch(RpcController *controller,
     }
 }
 
+void ChunkServiceImpl::DeleteChunks(RpcController *controller,
+                                    const DeleteChunksRequest *request,
+                                    DeleteChunksResponse *response,
+                                    Closure *done) {
+    // 批量请求没有按操作类型统计的metric，只参与inflight流控，
+    // 每个chunk都是一个op，按chunk个数计入inflight
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               nullptr,
+                                               nullptr,
+                                               done,
+                                               request->chunkid_size());
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "DeleteChunks: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    bool deleteSnap =
+        request->optype() == CHUNK_OP_TYPE::CHUNK_OP_DELETE_SNAP;
+    if ((request->optype() != CHUNK_OP_TYPE::CHUNK_OP_DELETE && !deleteSnap)
+        || (deleteSnap && !request->has_correctedsn())) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(ERROR) << "delete chunks failed, invalid request: "
+                   << request->ShortDebugString();
+        return;
+    }
+
+    if (request->chunkid_size() == 0) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "delete chunks failed, copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    auto ctx = std::make_shared<DeleteChunksContext>(
+        request, response, doneGuard.release());
+    for (int i = 0; i < request->chunkid_size(); ++i) {
+        ChunkRequest *chunkRequest = &ctx->requests[i];
+        chunkRequest->set_optype(request->optype());
+        chunkRequest->set_logicpoolid(request->logicpoolid());
+        chunkRequest->set_copysetid(request->copysetid());
+        chunkRequest->set_chunkid(request->chunkid(i));
+        if (deleteSnap) {
+            chunkRequest->set_correctedsn(request->correctedsn());
+        } else if (request->has_sn()) {
+            chunkRequest->set_sn(request->sn());
+        }
+
+        ChunkResponse *chunkResponse = &ctx->responses[i];
+        Closure *itemDone = new DeleteChunksItemClosure(ctx);
+        std::shared_ptr<ChunkOpRequest> req;
+        if (deleteSnap) {
+            req = std::make_shared<DeleteSnapshotRequest>(
+                nodePtr, controller, chunkRequest, chunkResponse, itemDone);
+        } else {
+            req = std::make_shared<DeleteChunkRequest>(
+                nodePtr, controller, chunkRequest, chunkResponse, itemDone);
+        }
+        req->Process();
+    }
+}
+
+void ChunkServiceImpl::CreateCloneChunks(RpcController *controller,
+                                         const ChunkRequest *request,
+                                         ChunkResponse *response,
+                                         Closure *done) {
+    // 批量请求中每个chunk都是一个op，按chunk个数计入inflight流控
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done,
+                                               request->clonechunks_size());
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "CreateCloneChunks: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    // 请求创建的chunk大小和copyset配置的大小不一致
+    for (const auto &item : request->clonechunks()) {
+        if (item.size() != maxChunkSize_) {
+            response->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            LOG(ERROR) << "Invalid chunk size: " << item.ShortDebugString()
+                       << " copyset size: " << maxChunkSize_;
+            return;
+        }
+    }
+
+    if (request->clonechunks_size() == 0) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "create clone chunks failed, "
+                     << "copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    // 所有chunk在一条raft日志中创建
+    if (chunkServiceOptions_.createCloneChunksInOneLog) {
+        std::shared_ptr<CreateCloneChunksRequest>
+            req = std::make_shared<CreateCloneChunksRequest>(
+                nodePtr, controller, request, response, doneGuard.release());
+        req->Process();
+        return;
+    }
+
+    auto ctx = std::make_shared<CloneChunksContext>(
+        request, response, doneGuard.release());
+    for (int i = 0; i < request->clonechunks_size(); ++i) {
+        const CloneChunkItem &item = request->clonechunks(i);
+        ChunkRequest *chunkRequest = &ctx->requests[i];
+        chunkRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE);
+        chunkRequest->set_logicpoolid(request->logicpoolid());
+        chunkRequest->set_copysetid(request->copysetid());
+        chunkRequest->set_chunkid(item.chunkid());
+        chunkRequest->set_sn(item.sn());
+        chunkRequest->set_correctedsn(item.correctedsn());
+        chunkRequest->set_size(item.size());
+        chunkRequest->set_location(item.location());
+
+        std::shared_ptr<CreateCloneChunkRequest>
+            req = std::make_shared<CreateCloneChunkRequest>(
+                nodePtr, controller, chunkRequest, &ctx->responses[i],
+                new CloneChunksItemClosure(ctx));
+        req->Process();
+    }
+}
+
+void ChunkServiceImpl::RecoverChunks(RpcController *controller,
+                                     const ChunkRequest *request,
+                                     ChunkResponse *response,
+                                     Closure *done) {
+    // 批量请求中每个chunk都是一个op，按chunk个数计入inflight流控
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done,
+                                               request->clonechunks_size());
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "RecoverChunks: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    // 判断request参数是否合法
+    for (const auto &item : request->clonechunks()) {
+        if (!CheckRequestOffsetAndLength(item.offset(), item.size())) {
+            response->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            LOG(ERROR) << "Invalid recover request: "
+                       << item.ShortDebugString()
+                       << " max size: " << maxChunkSize_;
+            return;
+        }
+    }
+
+    if (request->clonechunks_size() == 0) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "recover chunks failed, copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    auto accessTracker = chunkServiceOptions_.cloneAccessTracker;
+    if (nullptr != accessTracker) {
+        for (const auto &item : request->clonechunks()) {
+            accessTracker->Remove(request->logicpoolid(),
+                                  request->copysetid(),
+                                  item.chunkid());
+        }
+        std::vector<ChunkID> hotChunks;
+        accessTracker->List(request->logicpoolid(),
+                            request->copysetid(),
+                            &hotChunks);
+        for (ChunkID chunkId : hotChunks) {
+            response->add_hotclonechunks(chunkId);
+        }
+    }
+
+    // 每个chunk的恢复仍然是单独的RecoverChunk op，paste的数据各自走raft
+    auto ctx = std::make_shared<CloneChunksContext>(
+        request, response, doneGuard.release());
+    for (int i = 0; i < request->clonechunks_size(); ++i) {
+        const CloneChunkItem &item = request->clonechunks(i);
+        ChunkRequest *chunkRequest = &ctx->requests[i];
+        chunkRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+        chunkRequest->set_logicpoolid(request->logicpoolid());
+        chunkRequest->set_copysetid(request->copysetid());
+        chunkRequest->set_chunkid(item.chunkid());
+        chunkRequest->set_offset(item.offset());
+        chunkRequest->set_size(item.size());
+
+        std::shared_ptr<ReadChunkRequest> req =
+            std::make_shared<ReadChunkRequest>(
+                nodePtr, chunkServiceOptions_.cloneManager, controller,
+                chunkRequest, &ctx->responses[i],
+                new CloneChunksItemClosure(ctx));
+        req->Process();
+    }
+}
+
 bool ChunkServiceImpl::CheckRequestOffsetAndLength(uint32_t offset,
                                                    uint32_t len) const {
     // 检查offset+len是否越界
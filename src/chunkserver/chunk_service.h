@@ -83,6 +83,24 @@ class ChunkServiceImpl : public ChunkService {
                       ChunkResponse *response,
                       Closure *done);
 
+    /**
+     * 批量创建同一个copyset上的clone chunk，已存在的chunk通过
+     * response的existChunks返回。打开createCloneChunksInOneLog时所有
+     * chunk在一条raft日志中创建，否则每个chunk作为单独的op走raft
+     */
+    void CreateCloneChunks(RpcController *controller,
+                           const ChunkRequest *request,
+                           ChunkResponse *response,
+                           Closure *done);
+    /**
+     * 批量恢复同一个copyset上的clone chunk，每个chunk作为单独的
+     * RecoverChunk op处理，所有op完成后汇总结果返回
+     */
+    void RecoverChunks(RpcController *controller,
+                       const ChunkRequest *request,
+                       ChunkResponse *response,
+                       Closure *done);
+
     void GetChunkInfo(RpcController *controller,
                       const GetChunkInfoRequest *request,
                       GetChunkInfoResponse *response,
@@ -98,6 +116,15 @@ class ChunkServiceImpl : public ChunkService {
                     UpdateEpochResponse *response,
                     Closure *done);
 
+    /**
+     * 批量删除同一个copyset上的chunk或chunk快照，每个chunk仍然作为
+     * 单独的op走raft，所有op完成后汇总结果返回
+     */
+    void DeleteChunks(RpcController *controller,
+                      const DeleteChunksRequest *request,
+                      DeleteChunksResponse *response,
+                      Closure *done);
+
  private:
     /**
      * 验证op request的offset和length是否越界和对齐
@@ -46,7 +46,7 @@ void ChunkServiceClosure::Run() {
     // 这一行必须放在brpcDone_调用之后，ut里需要测试inflightio超过限制时的表现
     // 会在传进来的closure里面加一个sleep来控制inflightio个数
     if (nullptr != inflightThrottle_) {
-        inflightThrottle_->Decrement();
+        inflightThrottle_->Decrement(inflightCount_);
     }
 }
 
@@ -41,15 +41,17 @@ class ChunkServiceClosure : public braft::Closure {
             std::shared_ptr<InflightThrottle> inflightThrottle,
             const ChunkRequest *request,
             ChunkResponse *response,
-            google::protobuf::Closure *done)
+            google::protobuf::Closure *done,
+            uint64_t inflightCount = 1)
         : inflightThrottle_(inflightThrottle)
         , request_(request)
         , response_(response)
         , brpcDone_(done)
-        , receivedTimeUs_(common::TimeUtility::GetTimeofDayUs()) {
+        , receivedTimeUs_(common::TimeUtility::GetTimeofDayUs())
+        , inflightCount_(inflightCount) {
             // closure创建的什么加1，closure调用的时候减1
             if (nullptr != inflightThrottle_) {
-                inflightThrottle_->Increment();
+                inflightThrottle_->Increment(inflightCount_);
             }
             // 统计请求数量
             OnRequest();
@@ -85,6 +87,8 @@ class ChunkServiceClosure : public braft::Closure {
     google::protobuf::Closure *brpcDone_;
     // 接受到请求的时间
     uint64_t receivedTimeUs_;
+    // 计入inflight流控的op个数，批量请求中每个chunk算一个op
+    uint64_t inflightCount_;
 };
 
 }  // namespace chunkserver
@@ -172,6 +172,7 @@ int ChunkServer::Run(int argc, char** argv) {
     // 远端拷贝管理模块选项
     CopyerOptions copyerOptions;
     InitCopyerOptions(&conf, &copyerOptions);
+    copyerOptions.sourceCacheOptions.fs = fs;
     auto copyer = std::make_shared<OriginCopyer>();
     LOG_IF(FATAL, copyer->Init(copyerOptions) != 0)
         << "Failed to initialize clone copyer.";
@@ -183,8 +184,20 @@ int ChunkServer::Run(int argc, char** argv) {
     LOG_IF(FATAL, !conf.GetUInt32Value("clone.slice_size", &sliceSize));
     bool enablePaste = false;
     LOG_IF(FATAL, !conf.GetBoolValue("clone.enable_paste", &enablePaste));
-    cloneOptions.core =
-        std::make_shared<CloneCore>(sliceSize, enablePaste, copyer);
+    // 读穿透记录相关的配置项可以不配置，使用默认值
+    uint32_t hotChunkTrackNum;
+    if (!conf.GetUInt32Value("clone.hot_chunk_track_num", &hotChunkTrackNum)) {
+        hotChunkTrackNum = 64;
+    }
+    uint32_t hotChunkExpireSec;
+    if (!conf.GetUInt32Value("clone.hot_chunk_expire_sec",
+                             &hotChunkExpireSec)) {
+        hotChunkExpireSec = 300;
+    }
+    auto cloneAccessTracker = std::make_shared<CloneAccessTracker>(
+        hotChunkTrackNum, hotChunkExpireSec);
+    cloneOptions.core = std::make_shared<CloneCore>(
+        sliceSize, enablePaste, copyer, cloneAccessTracker);
     LOG_IF(FATAL, cloneManager_.Init(cloneOptions) != 0)
         << "Failed to initialize clone manager.";
 
@@ -342,6 +355,12 @@ int ChunkServer::Run(int argc, char** argv) {
     chunkServiceOptions.copysetNodeManager = copysetNodeManager_;
     chunkServiceOptions.cloneManager = &cloneManager_;
     chunkServiceOptions.inflightThrottle = inflightThrottle;
+    chunkServiceOptions.cloneAccessTracker = cloneAccessTracker;
+    // 不配置时每个chunk单独一条raft日志，兼容未升级的chunkserver
+    if (!conf.GetBoolValue("clone.create_chunks_in_one_log",
+                           &chunkServiceOptions.createCloneChunksInOneLog)) {
+        chunkServiceOptions.createCloneChunksInOneLog = false;
+    }
 
     ChunkServiceImpl chunkService(chunkServiceOptions, epochMap);
     ret = server.AddService(&chunkService,
@@ -659,6 +678,25 @@ void ChunkServer::InitCopyerOptions(
     } else {
         copyerOptions->s3Client = std::make_shared<S3Adapter>();
     }
+
+    // 源端数据缓存相关的配置项可以不配置，默认不开启
+    CloneSourceCacheOptions *cacheOptions = &copyerOptions->sourceCacheOptions;
+    if (!conf->GetUInt64Value("clone.source_cache_memory_bytes",
+                              &cacheOptions->memoryBytes)) {
+        cacheOptions->memoryBytes = 0;
+    }
+    if (!conf->GetUInt64Value("clone.source_cache_disk_bytes",
+                              &cacheOptions->diskBytes)) {
+        cacheOptions->diskBytes = 0;
+    }
+    if (cacheOptions->diskBytes > 0) {
+        LOG_IF(FATAL, !conf->GetStringValue("clone.source_cache_disk_path",
+            &cacheOptions->diskPath));
+    }
+    if (!conf->GetStringValue("clone.local_datastore_path",
+                              &copyerOptions->localDataStorePath)) {
+        copyerOptions->localDataStorePath = "";
+    }
 }
 
 void ChunkServer::InitCloneOptions(
@@ -698,6 +736,19 @@ void ChunkServer::InitHeartbeatOptions(
         &heartbeatOptions->intervalSec));
     LOG_IF(FATAL, !conf->GetUInt32Value("mds.heartbeat_timeout",
         &heartbeatOptions->timeout));
+    // 增量心跳相关的配置项可以不配置，使用默认值
+    if (!conf->GetBoolValue("mds.heartbeat_delta_report",
+        &heartbeatOptions->enableDeltaReport)) {
+        heartbeatOptions->enableDeltaReport = true;
+    }
+    if (!conf->GetUInt32Value("mds.heartbeat_full_report_interval",
+        &heartbeatOptions->fullReportInterval)) {
+        heartbeatOptions->fullReportInterval = 30;
+    }
+    if (!conf->GetUInt32Value("mds.heartbeat_stats_change_percent",
+        &heartbeatOptions->statsChangePercent)) {
+        heartbeatOptions->statsChangePercent = 20;
+    }
 }
 
 void ChunkServer::InitRegisterOptions(
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/chunkserver/clone_access_tracker.h"
+
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::common::LockGuard;
+using curve::common::TimeUtility;
+
+void CloneAccessTracker::Record(LogicPoolID logicPoolId,
+                                CopysetID copysetId,
+                                ChunkID chunkId) {
+    if (maxChunkNum_ == 0) {
+        return;
+    }
+    uint64_t now = TimeUtility::GetTimeofDaySec();
+    LockGuard lg(mtx_);
+    AccessList &list = accesses_[ToGroupNid(logicPoolId, copysetId)];
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        if (it->first == chunkId) {
+            list.erase(it);
+            break;
+        }
+    }
+    list.emplace_front(chunkId, now);
+    while (list.size() > maxChunkNum_) {
+        list.pop_back();
+    }
+}
+
+void CloneAccessTracker::Remove(LogicPoolID logicPoolId,
+                                CopysetID copysetId,
+                                ChunkID chunkId) {
+    LockGuard lg(mtx_);
+    auto iter = accesses_.find(ToGroupNid(logicPoolId, copysetId));
+    if (iter == accesses_.end()) {
+        return;
+    }
+    AccessList &list = iter->second;
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        if (it->first == chunkId) {
+            list.erase(it);
+            break;
+        }
+    }
+    if (list.empty()) {
+        accesses_.erase(iter);
+    }
+}
+
+void CloneAccessTracker::List(LogicPoolID logicPoolId,
+                              CopysetID copysetId,
+                              std::vector<ChunkID> *chunkIds) {
+    uint64_t now = TimeUtility::GetTimeofDaySec();
+    LockGuard lg(mtx_);
+    auto iter = accesses_.find(ToGroupNid(logicPoolId, copysetId));
+    if (iter == accesses_.end()) {
+        return;
+    }
+    AccessList &list = iter->second;
+    // 按访问时间排序，从尾部清理过期的记录
+    while (!list.empty() && list.back().second + expireSec_ < now) {
+        list.pop_back();
+    }
+    for (const auto &access : list) {
+        chunkIds->push_back(access.first);
+    }
+    if (list.empty()) {
+        accesses_.erase(iter);
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_CHUNKSERVER_CLONE_ACCESS_TRACKER_H_
+#define SRC_CHUNKSERVER_CLONE_ACCESS_TRACKER_H_
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "include/chunkserver/chunkserver_common.h"
+#include "src/common/concurrent/concurrent.h"
+
+namespace curve {
+namespace chunkserver {
+
+/**
+ * 记录每个copyset最近被用户读穿透到源端的clone chunk，
+ * 通过RecoverChunk的响应告诉克隆服务，让这些chunk优先恢复。
+ * 每个copyset只保留最近的若干个chunk，超过有效期的记录不再返回。
+ */
+class CloneAccessTracker {
+ public:
+    /**
+     * @param maxChunkNum 每个copyset最多记录的chunk数量，为0时不记录
+     * @param expireSec 记录的有效期，单位s
+     */
+    CloneAccessTracker(uint32_t maxChunkNum, uint32_t expireSec)
+        : maxChunkNum_(maxChunkNum)
+        , expireSec_(expireSec) {}
+    virtual ~CloneAccessTracker() {}
+
+    /**
+     * 记录一次读穿透，已记录的chunk移到最前面
+     */
+    void Record(LogicPoolID logicPoolId, CopysetID copysetId,
+                ChunkID chunkId);
+
+    /**
+     * 克隆服务已经开始恢复该chunk，不再需要返回
+     */
+    void Remove(LogicPoolID logicPoolId, CopysetID copysetId,
+                ChunkID chunkId);
+
+    /**
+     * 获取copyset中仍在有效期内的记录，最近访问的在前
+     * @param[out] chunkIds 记录的chunk id
+     */
+    void List(LogicPoolID logicPoolId, CopysetID copysetId,
+              std::vector<ChunkID> *chunkIds);
+
+ private:
+    // chunk id和最近一次访问的时间
+    using AccessList = std::list<std::pair<ChunkID, uint64_t>>;
+
+    uint32_t maxChunkNum_;
+    uint32_t expireSec_;
+    curve::common::Mutex mtx_;
+    std::unordered_map<GroupNid, AccessList> accesses_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_CLONE_ACCESS_TRACKER_H_
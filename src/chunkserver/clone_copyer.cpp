@@ -21,6 +21,10 @@
  */
 
 #include "src/chunkserver/clone_copyer.h"
+
+#include <algorithm>
+#include <atomic>
+
 #include "src/chunkserver/clone_core.h"
 #include "src/common/timeutility.h"
 
@@ -82,9 +86,15 @@ void OriginCopyer::DeleteExpiredCurveCache(void* arg) {
     }
 }
 
+// 缓存的数据块列表个数，每个列表只有chunk的分片数个数据块
+static constexpr uint64_t kChunkBlockMapCacheCount = 4096;
+// 同时映射的local快照pack文件个数
+static constexpr uint32_t kLocalMappedPackCount = 64;
+
 OriginCopyer::OriginCopyer()
     : curveClient_(nullptr)
-    , s3Client_(nullptr) {}
+    , s3Client_(nullptr)
+    , blockMapCache_(kChunkBlockMapCacheCount) {}
 
 int OriginCopyer::Init(const CopyerOptions& options) {
     curveFileTimeoutSec_ = options.curveFileTimeoutSec;
@@ -106,6 +116,21 @@ int OriginCopyer::Init(const CopyerOptions& options) {
     } else {
         LOG(WARNING) << "s3 adapter is disabled.";
     }
+    if (!options.localDataStorePath.empty()) {
+        localReader_ = std::make_shared<SnapshotLocalReader>(
+            options.localDataStorePath, kLocalMappedPackCount);
+    } else {
+        LOG(WARNING) << "Local snapshot data store is disabled.";
+    }
+    const CloneSourceCacheOptions& cacheOptions = options.sourceCacheOptions;
+    if (s3Client_ != nullptr &&
+        (cacheOptions.memoryBytes > 0 || cacheOptions.diskBytes > 0)) {
+        sourceCache_ = std::make_shared<CloneSourceCache>();
+        if (sourceCache_->Init(cacheOptions) != 0) {
+            LOG(ERROR) << "Init clone source cache failed.";
+            return -1;
+        }
+    }
     bthread::TimerThreadOptions timerOptions;
     timerOptions.bvar_prefix = "curve file lastUsedSec";
     int rc = timer_.start(&timerOptions);
@@ -163,6 +188,21 @@ void OriginCopyer::DownloadAsync(DownloadClosure* done) {
                        context->size, context->buf,
                        done);
         doneGuard.release();
+    } else if (type == OriginType::S3BlockOrigin) {
+        DownloadFromS3Block(originPath, context->offset,
+                            context->size, context->buf,
+                            done);
+        doneGuard.release();
+    } else if (type == OriginType::LocalOrigin) {
+        DownloadFromLocal(originPath, context->offset,
+                          context->size, context->buf,
+                          done);
+        doneGuard.release();
+    } else if (type == OriginType::LocalBlockOrigin) {
+        DownloadFromLocalBlock(originPath, context->offset,
+                               context->size, context->buf,
+                               done);
+        doneGuard.release();
     } else {
         LOG(ERROR) << "Unknown origin location."
                    << "location: " << context->location;
@@ -183,6 +223,20 @@ void OriginCopyer::DownloadFromS3(const string& objectName,
         return;
     }
 
+    if (sourceCache_ != nullptr) {
+        GetS3Range(objectName, off, size, false,
+            [=] (CloneSourceCache::Data data) {
+                brpc::ClosureGuard doneGuard(done);
+                if (data == nullptr || data->size() < size) {
+                    done->SetFailed();
+                    return;
+                }
+                memcpy(buf, data->data(), size);
+            });
+        doneGuard.release();
+        return;
+    }
+
     GetObjectAsyncCallBack cb =
         [=] (const S3Adapter* adapter,
              const std::shared_ptr<GetObjectAsyncContext>& context) {
@@ -204,6 +258,280 @@ void OriginCopyer::DownloadFromS3(const string& objectName,
     doneGuard.release();
 }
 
+int OriginCopyer::GetChunkBlockMap(const string& objectName,
+    std::shared_ptr<ChunkBlockMap>* blockMap) {
+    if (blockMapCache_.Get(objectName, blockMap)) {
+        return 0;
+    }
+    std::string data;
+    const Aws::String awsKey(objectName.c_str(), objectName.size());
+    int ret = s3Client_->GetObject(awsKey, &data);
+    if (ret < 0) {
+        LOG(ERROR) << "Failed to get chunk block map."
+                   << "objectName: " << objectName;
+        return -1;
+    }
+    auto map = std::make_shared<ChunkBlockMap>();
+    if (!map->ParseFromString(data) || map->blocksize() == 0) {
+        LOG(ERROR) << "Failed to parse chunk block map."
+                   << "objectName: " << objectName;
+        return -1;
+    }
+    blockMapCache_.Put(objectName, map);
+    *blockMap = map;
+    return 0;
+}
+
+void OriginCopyer::GetS3Range(const string& objectName,
+                              off_t off,
+                              size_t size,
+                              bool trimToActual,
+                              const CloneSourceCache::DoneCallback& done) {
+    auto fetch = [=] (const CloneSourceCache::DoneCallback& fetched) {
+        auto data = std::make_shared<std::string>(size, '\0');
+        GetObjectAsyncCallBack cb =
+            [=] (const S3Adapter* adapter,
+                 const std::shared_ptr<GetObjectAsyncContext>& context) {
+                (void)adapter;
+                if (context->retCode != 0) {
+                    fetched(nullptr);
+                    return;
+                }
+                if (trimToActual) {
+                    data->resize(std::min(context->actualLen, data->size()));
+                }
+                fetched(data);
+            };
+
+        auto context = std::make_shared<GetObjectAsyncContext>();
+        context->key = objectName;
+        context->buf = &(*data)[0];
+        context->offset = off;
+        context->len = size;
+        context->cb = cb;
+        s3Client_->GetObjectAsync(context);
+    };
+
+    if (sourceCache_ == nullptr) {
+        fetch(done);
+        return;
+    }
+    sourceCache_->Get(CloneSourceCache::RangeKey(objectName, off, size),
+                      fetch, done);
+}
+
+struct S3BlockDownloadContext {
+    DownloadClosure* done;
+    // 未完成的数据块请求数，额外加1防止发起请求过程中提前回调
+    std::atomic<uint32_t> pending;
+    std::atomic<bool> failed;
+
+    void FinishOne(bool success) {
+        if (!success) {
+            failed.store(true);
+        }
+        if (pending.fetch_sub(1) == 1) {
+            if (failed.load()) {
+                done->SetFailed();
+            }
+            done->Run();
+        }
+    }
+};
+
+void OriginCopyer::DownloadFromS3Block(const string& objectName,
+                                      off_t off,
+                                      size_t size,
+                                      char* buf,
+                                      DownloadClosure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    if (s3Client_ == nullptr) {
+        LOG(ERROR) << "Failed to get s3 object."
+                   << "s3 adapter is disabled";
+        done->SetFailed();
+        return;
+    }
+
+    std::shared_ptr<ChunkBlockMap> blockMap;
+    if (GetChunkBlockMap(objectName, &blockMap) != 0) {
+        done->SetFailed();
+        return;
+    }
+    uint64_t blockSize = blockMap->blocksize();
+    uint64_t begin = off;
+    uint64_t end = off + size;
+    if (size == 0 ||
+        (end - 1) / blockSize >=
+            static_cast<uint64_t>(blockMap->blocks_size())) {
+        LOG(ERROR) << "Download range out of chunk block map."
+                   << "objectName: " << objectName
+                   << ", offset: " << off
+                   << ", size: " << size;
+        done->SetFailed();
+        return;
+    }
+
+    auto downloadCtx = std::make_shared<S3BlockDownloadContext>();
+    downloadCtx->done = done;
+    downloadCtx->pending.store(1);
+    downloadCtx->failed.store(false);
+    doneGuard.release();
+
+    for (uint64_t index = begin / blockSize;
+         index * blockSize < end; index++) {
+        uint64_t blockOff = index * blockSize;
+        uint64_t copyBegin = std::max(begin, blockOff);
+        uint64_t copyEnd = std::min(end, blockOff + blockSize);
+        char* dst = buf + (copyBegin - begin);
+        const auto& block = blockMap->blocks(index);
+        if (block.hash().empty()) {
+            memset(dst, 0, copyEnd - copyBegin);
+            continue;
+        }
+
+        // 数据块对象长度不超过压缩后的上限，按上限读取，以实际长度解压
+        size_t storeLen = curve::snapshotcloneserver::SnapshotBlockCodec::
+            MaxStoreLength(block.compresstype(), blockSize);
+        std::string blockKey = curve::snapshotcloneserver::
+            SnapshotBlockCodec::BlockObjectKey(block);
+        uint64_t skip = copyBegin - blockOff;
+        size_t copyLen = copyEnd - copyBegin;
+        auto compressType = block.compresstype();
+        downloadCtx->pending.fetch_add(1);
+        GetS3Range(blockKey, 0, storeLen, true,
+            [=] (CloneSourceCache::Data storeBuf) {
+                bool success = (storeBuf != nullptr);
+                if (success) {
+                    // 请求覆盖整个数据块时直接解压到目标缓冲区
+                    std::unique_ptr<char[]> data;
+                    char* out = dst;
+                    if (copyLen != blockSize) {
+                        data.reset(new char[blockSize]);
+                        out = data.get();
+                    }
+                    success = curve::snapshotcloneserver::SnapshotBlockCodec::
+                        Decompress(compressType, *storeBuf, blockSize, out);
+                    LOG_IF(ERROR, !success)
+                        << "Failed to decompress block."
+                        << "key: " << blockKey;
+                    if (success && data != nullptr) {
+                        memcpy(dst, data.get() + skip, copyLen);
+                    }
+                }
+                downloadCtx->FinishOne(success);
+            });
+    }
+    downloadCtx->FinishOne(true);
+}
+
+void OriginCopyer::DownloadFromLocal(const string& objectName,
+                                     off_t off,
+                                     size_t size,
+                                     char* buf,
+                                     DownloadClosure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    if (localReader_ == nullptr) {
+        LOG(ERROR) << "Failed to read local snapshot chunk."
+                   << "local snapshot data store is disabled";
+        done->SetFailed();
+        return;
+    }
+    if (localReader_->ReadChunk(objectName, off, size, buf) != 0) {
+        done->SetFailed();
+    }
+}
+
+int OriginCopyer::GetLocalChunkBlockMap(const string& objectName,
+    std::shared_ptr<ChunkBlockMap>* blockMap) {
+    // 与s3上同名对象的数据块列表区分
+    std::string cacheKey =
+        LocationOperator::GenerateLocalBlockLocation(objectName);
+    if (blockMapCache_.Get(cacheKey, blockMap)) {
+        return 0;
+    }
+    std::string data;
+    if (localReader_->ReadChunk(objectName, &data) != 0) {
+        LOG(ERROR) << "Failed to get local chunk block map."
+                   << "objectName: " << objectName;
+        return -1;
+    }
+    auto map = std::make_shared<ChunkBlockMap>();
+    if (!map->ParseFromString(data) || map->blocksize() == 0) {
+        LOG(ERROR) << "Failed to parse local chunk block map."
+                   << "objectName: " << objectName;
+        return -1;
+    }
+    blockMapCache_.Put(cacheKey, map);
+    *blockMap = map;
+    return 0;
+}
+
+void OriginCopyer::DownloadFromLocalBlock(const string& objectName,
+                                          off_t off,
+                                          size_t size,
+                                          char* buf,
+                                          DownloadClosure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    if (localReader_ == nullptr) {
+        LOG(ERROR) << "Failed to read local snapshot chunk."
+                   << "local snapshot data store is disabled";
+        done->SetFailed();
+        return;
+    }
+
+    std::shared_ptr<ChunkBlockMap> blockMap;
+    if (GetLocalChunkBlockMap(objectName, &blockMap) != 0) {
+        done->SetFailed();
+        return;
+    }
+    uint64_t blockSize = blockMap->blocksize();
+    uint64_t begin = off;
+    uint64_t end = off + size;
+    if (size == 0 ||
+        (end - 1) / blockSize >=
+            static_cast<uint64_t>(blockMap->blocks_size())) {
+        LOG(ERROR) << "Download range out of chunk block map."
+                   << "objectName: " << objectName
+                   << ", offset: " << off
+                   << ", size: " << size;
+        done->SetFailed();
+        return;
+    }
+
+    std::unique_ptr<char[]> data;
+    for (uint64_t index = begin / blockSize;
+         index * blockSize < end; index++) {
+        uint64_t blockOff = index * blockSize;
+        uint64_t copyBegin = std::max(begin, blockOff);
+        uint64_t copyEnd = std::min(end, blockOff + blockSize);
+        char* dst = buf + (copyBegin - begin);
+        const auto& block = blockMap->blocks(index);
+        if (block.hash().empty()) {
+            memset(dst, 0, copyEnd - copyBegin);
+            continue;
+        }
+
+        // 请求覆盖整个数据块时直接解压到目标缓冲区
+        char* out = dst;
+        if (copyEnd - copyBegin != blockSize) {
+            if (data == nullptr) {
+                data.reset(new char[blockSize]);
+            }
+            out = data.get();
+        }
+        if (localReader_->ReadBlock(block, blockSize, out) != 0) {
+            LOG(ERROR) << "Failed to read local block."
+                       << "objectName: " << objectName
+                       << ", index: " << index;
+            done->SetFailed();
+            return;
+        }
+        if (out != dst) {
+            memcpy(dst, out + (copyBegin - blockOff), copyEnd - copyBegin);
+        }
+    }
+}
+
 void OriginCopyer::DownloadFromCurve(const string& fileName,
                                     off_t off,
                                     size_t size,
@@ -36,6 +36,10 @@
 #include "src/client/client_common.h"
 #include "include/client/libcurve.h"
 #include "src/common/s3_adapter.h"
+#include "src/common/lru_cache.h"
+#include "src/common/snapshotclone/snapshot_block.h"
+#include "src/common/snapshotclone/snapshot_local_reader.h"
+#include "src/chunkserver/clone_source_cache.h"
 
 namespace curve {
 namespace chunkserver {
@@ -47,6 +51,9 @@ using curve::common::LocationOperator;
 using curve::common::OriginType;
 using curve::common::GetObjectAsyncCallBack;
 using curve::common::GetObjectAsyncContext;
+using curve::common::LRUCache;
+using curve::snapshotcloneserver::ChunkBlockMap;
+using curve::snapshotcloneserver::SnapshotLocalReader;
 using std::string;
 
 class DownloadClosure;
@@ -64,6 +71,10 @@ struct CopyerOptions {
     std::shared_ptr<S3Adapter> s3Client;
     // curve file's time to live
     uint64_t curveFileTimeoutSec;
+    // s3上源端数据的共享缓存，内存和本地盘的容量都为0时不开启
+    CloneSourceCacheOptions sourceCacheOptions;
+    // 挂载的local快照数据存储目录，为空时不支持从local快照克隆/恢复
+    std::string localDataStorePath;
 };
 
 struct AsyncDownloadContext {
@@ -123,6 +134,54 @@ class OriginCopyer {
                        size_t size,
                        char* buf,
                        DownloadClosure* done);
+    /**
+     * 从CHUNK_DATA_BLOCK格式的快照chunk对象下载数据，
+     * 先读取数据块列表，再并发读取并解压请求范围覆盖的数据块
+     */
+    void DownloadFromS3Block(const string& objectName,
+                            off_t off,
+                            size_t size,
+                            char* buf,
+                            DownloadClosure* done);
+    /**
+     * 获取快照chunk对象的数据块列表，优先从缓存中获取
+     * @return: 成功返回0，失败返回-1
+     */
+    int GetChunkBlockMap(const string& objectName,
+                         std::shared_ptr<ChunkBlockMap>* blockMap);
+    /**
+     * 读取s3对象中的一段数据，开启了源端数据缓存时优先从缓存获取，
+     * 并合并相同数据的并发下载
+     * @param trimToActual: 是否按对象的实际长度截断读到的数据
+     */
+    void GetS3Range(const string& objectName,
+                    off_t off,
+                    size_t size,
+                    bool trimToActual,
+                    const CloneSourceCache::DoneCallback& done);
+    /**
+     * 从挂载的local快照数据存储目录读取CHUNK_DATA_RAW格式的快照chunk
+     */
+    void DownloadFromLocal(const string& objectName,
+                           off_t off,
+                           size_t size,
+                           char* buf,
+                           DownloadClosure* done);
+    /**
+     * 从挂载的local快照数据存储目录读取CHUNK_DATA_BLOCK格式的快照chunk，
+     * 数据块列表中记录了数据块在pack文件中的位置，直接从映射的pack文件解压
+     */
+    void DownloadFromLocalBlock(const string& objectName,
+                                off_t off,
+                                size_t size,
+                                char* buf,
+                                DownloadClosure* done);
+    /**
+     * 获取local快照chunk的数据块列表，优先从缓存中获取
+     * @return: 成功返回0，失败返回-1
+     */
+    int GetLocalChunkBlockMap(const string& objectName,
+                              std::shared_ptr<ChunkBlockMap>* blockMap);
     void DownloadFromCurve(const string& fileName,
                           off_t off,
                           size_t size,
@@ -143,6 +202,13 @@ class OriginCopyer {
     std::shared_ptr<FileClient> curveClient_;
     // 负责跟s3交互
     std::shared_ptr<S3Adapter>  s3Client_;
+    // 读取local快照数据存储，未配置目录时为nullptr
+    std::shared_ptr<SnapshotLocalReader> localReader_;
+    // 快照chunk对象名->数据块列表，快照数据不可修改，缓存无需失效，
+    // local快照的数据块列表以完整的location为key
+    LRUCache<std::string, std::shared_ptr<ChunkBlockMap>> blockMapCache_;
+    // s3上源端数据的共享缓存，未开启时为nullptr
+    std::shared_ptr<CloneSourceCache> sourceCache_;
     // 保护fdMap_的互斥锁
     std::mutex  mtx_;
     // 文件名->文件fd 的映射
@@ -180,6 +180,7 @@ int CloneCore::CloneReadByLocalInfo(
                                                shared_from_this(),
                                                downloadCtx,
                                                doneGuard.release());
+        RecordReadThrough(readRequest);
         copyer_->DownloadAsync(downloadClosure);
         return 0;
     }
@@ -215,6 +216,7 @@ void CloneCore::CloneReadByRequestInfo(std::shared_ptr<ReadChunkRequest>
                                     shared_from_this(),
                                     downloadCtx,
                                     doneGuard.release());
+    RecordReadThrough(readRequest);
     copyer_->DownloadAsync(downloadClosure);
     return;
 }
@@ -466,5 +468,17 @@ inline void CloneCore::SetResponse(
     readRequest->response_->set_status(status);
 }
 
+void CloneCore::RecordReadThrough(
+    std::shared_ptr<ReadChunkRequest> readRequest) {
+    const ChunkRequest* request = readRequest->request_;
+    if (accessTracker_ == nullptr ||
+        CHUNK_OP_TYPE::CHUNK_OP_READ != request->optype()) {
+        return;
+    }
+    accessTracker_->Record(request->logicpoolid(),
+                           request->copysetid(),
+                           request->chunkid());
+}
+
 }  // namespace chunkserver
 }  // namespace curve
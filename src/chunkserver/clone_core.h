@@ -33,6 +33,7 @@
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/common/timeutility.h"
 #include "src/chunkserver/clone_copyer.h"
+#include "src/chunkserver/clone_access_tracker.h"
 #include "src/chunkserver/datastore/define.h"
 
 namespace curve {
@@ -115,10 +116,12 @@ class CloneCore : public std::enable_shared_from_this<CloneCore> {
     friend class DownloadClosure;
  public:
     CloneCore(uint32_t sliceSize, bool enablePaste,
-              std::shared_ptr<OriginCopyer> copyer)
+              std::shared_ptr<OriginCopyer> copyer,
+              std::shared_ptr<CloneAccessTracker> accessTracker = nullptr)
         : sliceSize_(sliceSize)
         , enablePaste_(enablePaste)
-        , copyer_(copyer) {}
+        , copyer_(copyer)
+        , accessTracker_(accessTracker) {}
     virtual ~CloneCore() {}
 
     /**
@@ -190,6 +193,9 @@ class CloneCore : public std::enable_shared_from_this<CloneCore> {
     inline void SetResponse(std::shared_ptr<ReadChunkRequest> readRequest,
                             CHUNK_OP_STATUS status);
 
+    // 用户的读请求需要从源端拷贝数据时记录该chunk，recover请求不记录
+    void RecordReadThrough(std::shared_ptr<ReadChunkRequest> readRequest);
+
  private:
     // 每次拷贝的slice的大小
     uint32_t sliceSize_;
@@ -197,6 +203,8 @@ class CloneCore : public std::enable_shared_from_this<CloneCore> {
     bool enablePaste_;
     // 负责从源端下载数据
     std::shared_ptr<OriginCopyer> copyer_;
+    // 记录读穿透到源端的clone chunk，为nullptr时不记录
+    std::shared_ptr<CloneAccessTracker> accessTracker_;
 };
 
 }  // namespace chunkserver
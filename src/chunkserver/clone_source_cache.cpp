@@ -0,0 +1,255 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/chunkserver/clone_source_cache.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+
+namespace curve {
+namespace chunkserver {
+
+CloneSourceCache::CloneSourceCache()
+    : memoryBytes_(0),
+      diskBytes_(0),
+      diskFileSeq_(0),
+      hitCount_(0),
+      fetchCount_(0) {}
+
+int CloneSourceCache::Init(const CloneSourceCacheOptions& options) {
+    options_ = options;
+    if (options_.diskBytes == 0) {
+        return 0;
+    }
+    if (options_.fs == nullptr || options_.diskPath.empty()) {
+        LOG(ERROR) << "Clone source disk cache needs local filesystem"
+                   << " and cache path.";
+        return -1;
+    }
+    // 上次运行留下的缓存文件没有索引，直接清空
+    if (options_.fs->DirExists(options_.diskPath)) {
+        std::vector<std::string> names;
+        if (options_.fs->List(options_.diskPath, &names) != 0) {
+            LOG(ERROR) << "Failed to list clone source cache dir: "
+                       << options_.diskPath;
+            return -1;
+        }
+        for (const auto& name : names) {
+            options_.fs->Delete(options_.diskPath + "/" + name);
+        }
+    } else if (options_.fs->Mkdir(options_.diskPath) != 0) {
+        LOG(ERROR) << "Failed to create clone source cache dir: "
+                   << options_.diskPath;
+        return -1;
+    }
+    LOG(INFO) << "Init clone source cache success"
+              << ", memoryBytes: " << options_.memoryBytes
+              << ", diskBytes: " << options_.diskBytes
+              << ", diskPath: " << options_.diskPath;
+    return 0;
+}
+
+std::string CloneSourceCache::RangeKey(const std::string& objectName,
+                                       uint64_t offset,
+                                       uint64_t length) {
+    return objectName + ":" + std::to_string(offset) + ":" +
+           std::to_string(length);
+}
+
+void CloneSourceCache::Get(const std::string& key,
+                           const FetchFunc& fetch,
+                           const DoneCallback& done) {
+    Data data;
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        auto iter = memoryIndex_.find(key);
+        if (iter != memoryIndex_.end()) {
+            memoryList_.splice(memoryList_.begin(), memoryList_, iter->second);
+            data = iter->second->second;
+        } else {
+            auto waiter = inflight_.find(key);
+            if (waiter != inflight_.end()) {
+                // 相同的数据正在下载，等待下载结果
+                hitCount_.fetch_add(1);
+                waiter->second.push_back(done);
+                return;
+            }
+            inflight_[key].push_back(done);
+        }
+    }
+    if (data != nullptr) {
+        hitCount_.fetch_add(1);
+        done(data);
+        return;
+    }
+
+    data = ReadDisk(key);
+    if (data != nullptr) {
+        hitCount_.fetch_add(1);
+        OnFetched(key, data, false);
+        return;
+    }
+    fetchCount_.fetch_add(1);
+    fetch([this, key] (Data fetched) {
+        OnFetched(key, fetched, true);
+    });
+}
+
+void CloneSourceCache::OnFetched(const std::string& key,
+                                 Data data,
+                                 bool fromSource) {
+    if (data != nullptr && fromSource) {
+        WriteDisk(key, data);
+    }
+    std::vector<DoneCallback> waiters;
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (data != nullptr) {
+            PutMemoryLocked(key, data);
+        }
+        auto iter = inflight_.find(key);
+        if (iter != inflight_.end()) {
+            waiters.swap(iter->second);
+            inflight_.erase(iter);
+        }
+    }
+    for (const auto& waiter : waiters) {
+        waiter(data);
+    }
+}
+
+void CloneSourceCache::PutMemoryLocked(const std::string& key, Data data) {
+    if (data->size() > options_.memoryBytes ||
+        memoryIndex_.count(key) > 0) {
+        return;
+    }
+    memoryList_.emplace_front(key, data);
+    memoryIndex_[key] = memoryList_.begin();
+    memoryBytes_ += data->size();
+    while (memoryBytes_ > options_.memoryBytes) {
+        auto& oldest = memoryList_.back();
+        memoryBytes_ -= oldest.second->size();
+        memoryIndex_.erase(oldest.first);
+        memoryList_.pop_back();
+    }
+}
+
+CloneSourceCache::Data CloneSourceCache::ReadDisk(const std::string& key) {
+    if (options_.diskBytes == 0) {
+        return nullptr;
+    }
+    DiskEntry entry;
+    {
+        std::unique_lock<std::mutex> lock(diskMtx_);
+        auto iter = diskIndex_.find(key);
+        if (iter == diskIndex_.end()) {
+            return nullptr;
+        }
+        diskList_.splice(diskList_.begin(), diskList_, iter->second);
+        entry = iter->second->second;
+    }
+    // 文件可能在读之前被淘汰删除，此时按未命中处理
+    int fd = options_.fs->Open(entry.path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    auto data = std::make_shared<std::string>(entry.size, '\0');
+    int ret = options_.fs->Read(fd, &(*data)[0], 0, entry.size);
+    options_.fs->Close(fd);
+    if (ret != static_cast<int>(entry.size)) {
+        LOG(WARNING) << "Failed to read clone source cache file: "
+                     << entry.path << ", ret: " << ret;
+        return nullptr;
+    }
+    return data;
+}
+
+void CloneSourceCache::WriteDisk(const std::string& key, Data data) {
+    if (data->size() > options_.diskBytes) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(diskMtx_);
+        if (diskIndex_.count(key) > 0) {
+            return;
+        }
+    }
+    DiskEntry entry;
+    entry.path = options_.diskPath + "/" +
+                 std::to_string(diskFileSeq_.fetch_add(1));
+    entry.size = data->size();
+    int fd = options_.fs->Open(entry.path, O_CREAT | O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        LOG(WARNING) << "Failed to create clone source cache file: "
+                     << entry.path;
+        return;
+    }
+    int ret = options_.fs->Write(fd, data->data(), 0, data->size());
+    options_.fs->Close(fd);
+    if (ret != static_cast<int>(data->size())) {
+        LOG(WARNING) << "Failed to write clone source cache file: "
+                     << entry.path << ", ret: " << ret;
+        options_.fs->Delete(entry.path);
+        return;
+    }
+
+    std::vector<std::string> evicted;
+    {
+        std::unique_lock<std::mutex> lock(diskMtx_);
+        if (diskIndex_.count(key) > 0) {
+            evicted.push_back(entry.path);
+        } else {
+            diskList_.emplace_front(key, entry);
+            diskIndex_[key] = diskList_.begin();
+            diskBytes_ += entry.size;
+            while (diskBytes_ > options_.diskBytes) {
+                auto& oldest = diskList_.back();
+                diskBytes_ -= oldest.second.size;
+                evicted.push_back(oldest.second.path);
+                diskIndex_.erase(oldest.first);
+                diskList_.pop_back();
+            }
+        }
+    }
+    RemoveDiskFiles(evicted);
+}
+
+void CloneSourceCache::RemoveDiskFiles(const std::vector<std::string>& paths) {
+    for (const auto& path : paths) {
+        int ret = options_.fs->Delete(path);
+        LOG_IF(WARNING, ret != 0)
+            << "Failed to delete clone source cache file: " << path;
+    }
+}
+
+uint64_t CloneSourceCache::GetMemoryBytes() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    return memoryBytes_;
+}
+
+uint64_t CloneSourceCache::GetDiskBytes() {
+    std::unique_lock<std::mutex> lock(diskMtx_);
+    return diskBytes_;
+}
+
+}  // namespace chunkserver
+}  // namespace curve
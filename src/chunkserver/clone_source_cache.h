@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_CHUNKSERVER_CLONE_SOURCE_CACHE_H_
+#define SRC_CHUNKSERVER_CLONE_SOURCE_CACHE_H_
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/fs/local_filesystem.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::fs::LocalFileSystem;
+
+struct CloneSourceCacheOptions {
+    // 内存中缓存的数据总量上限，为0时不使用内存缓存
+    uint64_t memoryBytes = 0;
+    // 本地盘上缓存的数据总量上限，为0时不使用本地盘缓存
+    uint64_t diskBytes = 0;
+    // 本地盘缓存目录，每次启动时清空
+    std::string diskPath;
+    // 读写本地盘缓存文件
+    std::shared_ptr<LocalFileSystem> fs;
+};
+
+/**
+ * @brief chunkserver上所有clone chunk共享的源端数据缓存
+ * @detail
+ *  同一个快照克隆出的多个卷在同一个chunkserver上会反复下载相同的源端数据，
+ *  这里按对象名和数据范围缓存下载到的数据，先放内存，同时写一份到本地盘，
+ *  内存淘汰后还可以从本地盘读取。两级缓存都按数据量做LRU淘汰。
+ *  同一份数据的并发请求只会向源端发起一次下载，其他请求等待下载结果。
+ *  快照数据不可修改，缓存的数据无需失效。
+ */
+class CloneSourceCache {
+ public:
+    using Data = std::shared_ptr<const std::string>;
+    // 获取数据完成后的回调，失败时data为nullptr
+    using DoneCallback = std::function<void(Data data)>;
+    // 向源端发起一次下载，完成后调用传入的回调
+    using FetchFunc = std::function<void(const DoneCallback& fetched)>;
+
+    CloneSourceCache();
+
+    /**
+     * 初始化，清空本地盘缓存目录
+     * @param options: 配置信息
+     * @return: 成功返回0，失败返回-1
+     */
+    int Init(const CloneSourceCacheOptions& options);
+
+    /**
+     * 获取一份数据，缓存未命中且没有相同的下载正在进行时调用fetch下载，
+     * 下载成功的数据加入缓存，失败的不缓存，之后的请求会重新下载
+     * @param key: 数据的标识，见RangeKey
+     * @param fetch: 从源端下载数据
+     * @param done: 获取到数据后的回调，命中内存缓存时在当前线程同步调用
+     */
+    void Get(const std::string& key,
+             const FetchFunc& fetch,
+             const DoneCallback& done);
+
+    /**
+     * 对象中一段数据的缓存标识
+     */
+    static std::string RangeKey(const std::string& objectName,
+                                uint64_t offset,
+                                uint64_t length);
+
+    uint64_t GetMemoryBytes();
+
+    uint64_t GetDiskBytes();
+
+    uint64_t GetHitCount() const {
+        return hitCount_.load();
+    }
+
+    uint64_t GetFetchCount() const {
+        return fetchCount_.load();
+    }
+
+ private:
+    struct DiskEntry {
+        std::string path;
+        uint64_t size;
+    };
+    using MemoryList = std::list<std::pair<std::string, Data>>;
+    using DiskList = std::list<std::pair<std::string, DiskEntry>>;
+
+    void OnFetched(const std::string& key, Data data, bool fromSource);
+
+    void PutMemoryLocked(const std::string& key, Data data);
+
+    Data ReadDisk(const std::string& key);
+
+    void WriteDisk(const std::string& key, Data data);
+
+    void RemoveDiskFiles(const std::vector<std::string>& paths);
+
+ private:
+    CloneSourceCacheOptions options_;
+
+    // 保护内存缓存和正在下载的请求
+    std::mutex mtx_;
+    // 按访问时间排序，最近访问的在前面
+    MemoryList memoryList_;
+    std::unordered_map<std::string, MemoryList::iterator> memoryIndex_;
+    uint64_t memoryBytes_;
+    // 正在下载的数据->等待下载结果的回调
+    std::unordered_map<std::string, std::vector<DoneCallback>> inflight_;
+
+    // 保护本地盘缓存的索引，读写文件不持有该锁
+    std::mutex diskMtx_;
+    DiskList diskList_;
+    std::unordered_map<std::string, DiskList::iterator> diskIndex_;
+    uint64_t diskBytes_;
+    // 本地盘缓存文件名的序号
+    std::atomic<uint64_t> diskFileSeq_;
+
+    std::atomic<uint64_t> hitCount_;
+    std::atomic<uint64_t> fetchCount_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_CLONE_SOURCE_CACHE_H_
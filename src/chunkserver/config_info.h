@@ -41,6 +41,7 @@ using curve::chunkserver::concurrent::ConcurrentApplyModule;
 class FilePool;
 class CopysetNodeManager;
 class CloneManager;
+class CloneAccessTracker;
 
 /**
  * copyset node的配置选项
@@ -146,6 +147,11 @@ struct ChunkServiceOptions {
     CopysetNodeManager *copysetNodeManager;
     CloneManager *cloneManager;
     std::shared_ptr<InflightThrottle> inflightThrottle;
+    // 读穿透的clone chunk记录，通过RecoverChunk的响应返回给克隆服务
+    std::shared_ptr<CloneAccessTracker> cloneAccessTracker;
+    // CreateCloneChunks是否把所有chunk放在一条raft日志中，老版本的
+    // chunkserver无法apply这种日志，所以需要复制组的副本都升级后才能打开
+    bool createCloneChunksInOneLog = false;
 };
 
 inline CopysetNodeOptions::CopysetNodeOptions()
@@ -272,6 +272,15 @@ void CopysetNode::InitRaftNodeOptions(const CopysetNodeOptions &options) {
         new scoped_refptr<braft::FileSystemAdaptor>(cfa);
 }
 
+bool CopysetNode::IsApplyBarrier(CHUNK_OP_TYPE optype) {
+    /**
+     * 并发apply按chunk id把op分到不同的队列，涉及多个chunk的op需要等
+     * 之前的op都apply完再执行，且执行完之后才能apply后面的op，
+     * 保证这些chunk上的op仍然按日志顺序apply
+     */
+    return optype == CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH;
+}
+
 void CopysetNode::on_apply(::braft::Iterator &iter) {
     for (; iter.valid(); iter.next()) {
         // 放在bthread中异步执行，避免阻塞当前状态机的执行
@@ -293,9 +302,9 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             CHECK(nullptr != chunkClosure)
                 << "ChunkClosure dynamic cast failed";
             std::shared_ptr<ChunkOpRequest>& opRequest = chunkClosure->request_;
-            concurrentapply_->Push(opRequest->ChunkId(), opRequest->OpType(),
-                                   &ChunkOpRequest::OnApply, opRequest,
-                                   iter.index(), doneGuard.release());
+            PushApplyTask(opRequest->ChunkId(), opRequest->OpType(),
+                          &ChunkOpRequest::OnApply, opRequest,
+                          iter.index(), doneGuard.release());
         } else {
             // 获取log entry
             butil::IOBuf log = iter.data();
@@ -310,9 +319,9 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             auto opReq = ChunkOpRequest::Decode(log, &request, &data,
                                                 iter.index(), GetLeaderId());
             auto chunkId = request.chunkid();
-            concurrentapply_->Push(chunkId, request.optype(),
-                                   &ChunkOpRequest::OnApplyFromLog, opReq,
-                                   dataStore_, std::move(request), data);
+            PushApplyTask(chunkId, request.optype(),
+                          &ChunkOpRequest::OnApplyFromLog, opReq,
+                          dataStore_, std::move(request), data);
         }
     }
 }
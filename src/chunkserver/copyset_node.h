@@ -33,6 +33,7 @@
 #include <climits>
 #include <memory>
 #include <deque>
+#include <utility>
 
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
 #include "src/chunkserver/datastore/chunkserver_datastore.h"
@@ -460,6 +461,31 @@ class CopysetNode : public braft::StateMachine,
         return ToGroupIdString(logicPoolId_, copysetId_);
     }
 
+    // 是否需要等前后的op都apply完再单独apply
+    static bool IsApplyBarrier(CHUNK_OP_TYPE optype);
+
+    /**
+     * 把op放入并发apply队列，屏障op在之前的op都apply完之后才放入，
+     * 并且等它apply完才返回
+     * @param chunkId: 按chunk id把op分到不同的队列
+     * @param optype: op类型
+     * @param f: apply的任务
+     * @param args: 任务的参数
+     */
+    template <class F, class... Args>
+    void PushApplyTask(ChunkID chunkId, CHUNK_OP_TYPE optype,
+                       F&& f, Args&&... args) {
+        bool barrier = IsApplyBarrier(optype);
+        if (barrier) {
+            concurrentapply_->Flush();
+        }
+        concurrentapply_->Push(chunkId, optype, std::forward<F>(f),
+                               std::forward<Args>(args)...);
+        if (barrier) {
+            concurrentapply_->Flush();
+        }
+    }
+
  private:
     // 逻辑池 id
     LogicPoolID logicPoolId_;
@@ -42,6 +42,7 @@ ChunkFileMetaPage::ChunkFileMetaPage(const ChunkFileMetaPage& metaPage) {
     } else {
         bitmap = nullptr;
     }
+    changedBlocks = metaPage.changedBlocks;
 }
 
 ChunkFileMetaPage& ChunkFileMetaPage::operator =(
@@ -58,6 +59,7 @@ ChunkFileMetaPage& ChunkFileMetaPage::operator =(
     } else {
         bitmap = nullptr;
     }
+    changedBlocks = metaPage.changedBlocks;
     return *this;
 }
 
@@ -85,6 +87,8 @@ void ChunkFileMetaPage::encode(char* buf) {
     }
     uint32_t crc = ::curve::common::CRC32(buf, len);
     memcpy(buf + len, &crc, sizeof(crc));
+    len += sizeof(crc);
+    changedBlocks.encode(buf + len);
 }
 
 CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
@@ -116,6 +120,8 @@ CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
         LOG(ERROR) << "Checking Crc32 failed.";
         return CSErrorCode::CrcCheckError;
     }
+    len += sizeof(recordCrc);
+    changedBlocks.decode(buf + len);
 
     // TODO(yyk) check version compatibility, currrent simple error handing,
     // need detailed implementation later
@@ -141,6 +147,9 @@ CSChunkFile::CSChunkFile(std::shared_ptr<LocalFileSystem> lfs,
       size_(options.chunkSize),
       blockSize_(options.blockSize),
       metaPageSize_(options.metaPageSize),
+      changedBlockSize_(std::max<ChunkSizeType>(options.blockSize,
+                                                options.metaPageSize)),
+      trackChangedBlocks_(false),
       chunkId_(options.id),
       baseDir_(options.baseDir),
       isCloneChunk_(false),
@@ -160,6 +169,12 @@ CSChunkFile::CSChunkFile(std::shared_ptr<LocalFileSystem> lfs,
         uint32_t bits = size_ / blockSize_;
         metaPage_.bitmap = std::make_shared<Bitmap>(bits);
     }
+    trackChangedBlocks_ = changedBlocksFitMetaPage();
+    if (metaPage_.location.empty() && trackChangedBlocks_) {
+        // A new chunk has no data before, all writes are changes
+        metaPage_.changedBlocks.Reset(kInvalidSeq,
+                                      size_ / changedBlockSize_);
+    }
     if (metric_ != nullptr) {
         metric_->chunkFileCount << 1;
     }
@@ -247,6 +262,11 @@ CSErrorCode CSChunkFile::Open(bool createFile) {
         }
         isCloneChunk_ = true;
     }
+    // The location of a clone chunk is known only after loading
+    trackChangedBlocks_ = changedBlocksFitMetaPage();
+    if (!trackChangedBlocks_) {
+        metaPage_.changedBlocks = ChangedBlocks();
+    }
     return errCode;
 }
 
@@ -348,6 +368,8 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
                                                  chunkFilePool_,
                                                  options);
         CHECK(snapshot_ != nullptr) << "Failed to new CSSnapshot!";
+        // The snapshot takes over the blocks changed before it
+        snapshot_->SetChangedBlocks(metaPage_.changedBlocks);
         CSErrorCode errorCode = snapshot_->Open(true);
         if (errorCode != CSErrorCode::Success) {
             delete snapshot_;
@@ -368,6 +390,16 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
     if (sn > metaPage_.sn) {
         ChunkFileMetaPage tempMeta = metaPage_;
         tempMeta.sn = sn;
+        // The snapshot of current sequence has taken over the changed
+        // blocks, restart tracking from it. Also checked after restart in
+        // case the snapshot was created but the metapage was not updated.
+        if (trackChangedBlocks_ && snapshot_ != nullptr &&
+            snapshot_->GetSn() == metaPage_.sn) {
+            tempMeta.changedBlocks.Reset(metaPage_.sn,
+                                         size_ / changedBlockSize_);
+        }
+        // Mark the blocks of this write in the same metapage update
+        markChangedBlocks(&tempMeta.changedBlocks, offset, length);
         CSErrorCode errorCode = updateMetaPage(&tempMeta);
         if (errorCode != CSErrorCode::Success) {
             LOG(ERROR) << "Update metapage failed."
@@ -377,6 +409,22 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
             return errorCode;
         }
         metaPage_.sn = tempMeta.sn;
+        metaPage_.changedBlocks = tempMeta.changedBlocks;
+    }
+    // The changed blocks must be persisted before the data, otherwise the
+    // incremental snapshot may miss the data written before a crash
+    if (needMarkChangedBlocks(offset, length)) {
+        ChunkFileMetaPage tempMeta = metaPage_;
+        markChangedBlocks(&tempMeta.changedBlocks, offset, length);
+        CSErrorCode errorCode = updateMetaPage(&tempMeta);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Update changed blocks failed."
+                       << "ChunkID: " << chunkId_
+                       << ",request sn: " << sn
+                       << ",chunk sn: " << metaPage_.sn;
+            return errorCode;
+        }
+        metaPage_.changedBlocks = tempMeta.changedBlocks;
     }
     // If it is cow, copy the data to the snapshot file first
     if (needCow(sn)) {
@@ -466,6 +514,30 @@ CSErrorCode CSChunkFile::Paste(const char * buf, off_t offset, size_t length) {
                              &uncopiedRange,
                              nullptr);
 
+    // The pasted blocks are changed as well, mark them before the data
+    // is written like Write does
+    ChunkFileMetaPage tempMeta = metaPage_;
+    bool needMark = false;
+    for (auto& range : uncopiedRange) {
+        off_t markOff = range.beginIndex * blockSize_;
+        size_t markSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
+        if (needMarkChangedBlocks(markOff, markSize)) {
+            markChangedBlocks(&tempMeta.changedBlocks, markOff, markSize);
+            needMark = true;
+        }
+    }
+    if (needMark) {
+        CSErrorCode errorCode = updateMetaPage(&tempMeta);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Update changed blocks failed."
+                       << "ChunkID: " << chunkId_
+                       << ", offset: " << offset
+                       << ", length: " << length;
+            return errorCode;
+        }
+        metaPage_.changedBlocks = tempMeta.changedBlocks;
+    }
+
     // For the unwritten range, write the corresponding data
     off_t pasteOff;
     size_t pasteSize;
@@ -782,6 +854,15 @@ void CSChunkFile::GetInfo(CSChunkInfo* info)  {
         info->bitmap = nullptr;
 }
 
+void CSChunkFile::GetChangedBlocks(ChangedBlocks* changedBlocks) {
+    ReadLockGuard readGuard(rwLock_);
+    if (snapshot_ != nullptr) {
+        *changedBlocks = snapshot_->GetChangedBlocks();
+    } else {
+        *changedBlocks = metaPage_.changedBlocks;
+    }
+}
+
 CSErrorCode CSChunkFile::GetHash(off_t offset,
                                  size_t length,
                                  std::string* hash)  {
@@ -962,6 +1043,55 @@ CSErrorCode CSChunkFile::copy2Snapshot(off_t offset, size_t length) {
     return CSErrorCode::Success;
 }
 
+bool CSChunkFile::changedBlocksFitMetaPage() {
+    size_t bitmapBytes = (size_ / blockSize_ + 8 - 1) / 8;
+    // version, sn, correctedSn, location size, crc
+    size_t chunkMetaSize = sizeof(uint8_t) + 2 * sizeof(SequenceNum) +
+                           sizeof(size_t) + sizeof(uint32_t);
+    // location, bits and bitmap of the clone chunk
+    if (!metaPage_.location.empty()) {
+        chunkMetaSize += metaPage_.location.size() + sizeof(uint32_t) +
+                         bitmapBytes;
+    }
+    // version, damaged, sn, bits, bitmap, crc of the snapshot
+    size_t snapMetaSize = sizeof(uint8_t) + sizeof(bool) +
+                          sizeof(SequenceNum) + sizeof(uint32_t) +
+                          bitmapBytes + sizeof(uint32_t);
+    size_t trackSize = ChangedBlocks::EncodedSize(size_ / changedBlockSize_);
+    if (std::max(chunkMetaSize, snapMetaSize) + trackSize > metaPageSize_) {
+        LOG_FIRST_N(WARNING, 1) << "Changed blocks not fit in metapage, "
+                                << "disable changed block tracking."
+                                << "ChunkID: " << chunkId_
+                                << ", location: " << metaPage_.location
+                                << ", chunk size: " << size_
+                                << ", block size: " << blockSize_
+                                << ", page size: " << metaPageSize_;
+        return false;
+    }
+    return true;
+}
+
+bool CSChunkFile::needMarkChangedBlocks(off_t offset, size_t length) {
+    if (metaPage_.changedBlocks.bitmap == nullptr) {
+        return false;
+    }
+    uint32_t beginIndex = offset / changedBlockSize_;
+    uint32_t endIndex = (offset + length - 1) / changedBlockSize_;
+    return metaPage_.changedBlocks.bitmap->NextClearBit(beginIndex, endIndex)
+           != Bitmap::NO_POS;
+}
+
+void CSChunkFile::markChangedBlocks(ChangedBlocks* changedBlocks,
+                                    off_t offset,
+                                    size_t length) {
+    if (changedBlocks->bitmap == nullptr) {
+        return;
+    }
+    uint32_t beginIndex = offset / changedBlockSize_;
+    uint32_t endIndex = (offset + length - 1) / changedBlockSize_;
+    changedBlocks->bitmap->Set(beginIndex, endIndex);
+}
+
 CSErrorCode CSChunkFile::flush() {
     ChunkFileMetaPage tempMeta = metaPage_;
     bool needUpdateMeta = dirtyPages_.size() > 0;
@@ -64,7 +64,8 @@ struct DataStoreMetric;
  * sn: 8 bytes
  * correctedSn: 8 bytes
  * crc: 4 bytes
- * padding: 4075 bytes
+ * changed blocks: see ChangedBlocks
+ * padding: remaining bytes
  */
 struct ChunkFileMetaPage {
     // File format version
@@ -79,6 +80,8 @@ struct ChunkFileMetaPage {
     // Indicates the state of the page in the current Chunk,
     // if it is not CloneChunk, it is nullptr
     std::shared_ptr<Bitmap> bitmap;
+    // Blocks written since the snapshot of changedBlocks.baseSn
+    ChangedBlocks changedBlocks;
 
     ChunkFileMetaPage() : version(FORMAT_VERSION)
                         , sn(0)
@@ -240,6 +243,14 @@ class CSChunkFile {
      * @return: return error code
      */
     CSErrorCode DeleteSnapshotOrCorrectSn(SequenceNum correctedSn);
+    /**
+     * Get the changed blocks of the chunk data that the snapshot dump will
+     * read: the snapshot file if exists, otherwise the chunk file
+     * There may be concurrency, add read lock
+     * @param[out] changedBlocks: the changed blocks, bitmap is nullptr if
+     * the chunk is not tracked
+     */
+    void GetChangedBlocks(ChangedBlocks* changedBlocks);
     /**
      * Get chunk info
      * @param[out]: the chunk info getted
@@ -316,6 +327,21 @@ class CSChunkFile {
      * to a normal chunk
      */
     CSErrorCode flush();
+    /**
+     * Whether the changed blocks fit in the metapage together with the
+     * chunk metapage and the snapshot metapage, tracking is disabled if not
+     */
+    bool changedBlocksFitMetaPage();
+    /**
+     * Whether the write range has blocks not marked as changed
+     */
+    bool needMarkChangedBlocks(off_t offset, size_t length);
+    /**
+     * Mark the write range as changed in the changed blocks
+     */
+    void markChangedBlocks(ChangedBlocks* changedBlocks,
+                           off_t offset,
+                           size_t length);
 
     inline string path() {
         return baseDir_ + "/" +
@@ -411,6 +437,11 @@ class CSChunkFile {
     ChunkSizeType size_;
     ChunkSizeType blockSize_;
     PageSizeType metaPageSize_;
+    // The granularity of changed block tracking, not smaller than the
+    // metapage size to keep the tracking bitmap fit in the metapage
+    ChunkSizeType changedBlockSize_;
+    // Whether the changed blocks are tracked
+    bool trackChangedBlocks_;
     // chunk id
     ChunkID chunkId_;
     // The directory where the chunk is located
@@ -380,6 +380,18 @@ CSErrorCode CSDataStore::GetChunkInfo(ChunkID id,
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSDataStore::GetChunkChangedBlocks(ChunkID id,
+                                    ChangedBlocks* changedBlocks) {
+    auto chunkFile = metaCache_.Get(id);
+    if (chunkFile == nullptr) {
+        LOG(INFO) << "Get changed blocks failed, Chunk not exists."
+                  << "ChunkID = " << id;
+        return CSErrorCode::ChunkNotExistError;
+    }
+    chunkFile->GetChangedBlocks(changedBlocks);
+    return CSErrorCode::Success;
+}
+
 CSErrorCode CSDataStore::GetChunkHash(ChunkID id,
                                       off_t offset,
                                       size_t length,
@@ -310,6 +310,16 @@ class CSDataStore {
     virtual CSErrorCode GetChunkInfo(ChunkID id,
                                      CSChunkInfo* chunkInfo);
 
+    /**
+     * Get the blocks changed since an earlier snapshot of the chunk,
+     * used by incremental snapshot to skip the unchanged data
+     * @param id: the id of the chunk requested
+     * @param changedBlocks: the changed blocks, bitmap is nullptr if the
+     * chunk is not tracked
+     */
+    virtual CSErrorCode GetChunkChangedBlocks(ChunkID id,
+                                              ChangedBlocks* changedBlocks);
+
     /**
      * Get the hash value of Chunk
      * @param id[in]: chunk id
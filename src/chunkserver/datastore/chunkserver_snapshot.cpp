@@ -27,6 +27,83 @@
 namespace curve {
 namespace chunkserver {
 
+// "CBT1", marks the changed block tracking area in metapage
+static const uint32_t kChangedBlocksMagic = 0x31544243;
+
+ChangedBlocks::ChangedBlocks(const ChangedBlocks& rhs) {
+    baseSn = rhs.baseSn;
+    if (rhs.bitmap != nullptr) {
+        bitmap = std::make_shared<Bitmap>(rhs.bitmap->Size(),
+                                          rhs.bitmap->GetBitmap());
+    } else {
+        bitmap = nullptr;
+    }
+}
+
+ChangedBlocks& ChangedBlocks::operator =(const ChangedBlocks& rhs) {
+    if (this == &rhs)
+        return *this;
+    baseSn = rhs.baseSn;
+    if (rhs.bitmap != nullptr) {
+        bitmap = std::make_shared<Bitmap>(rhs.bitmap->Size(),
+                                          rhs.bitmap->GetBitmap());
+    } else {
+        bitmap = nullptr;
+    }
+    return *this;
+}
+
+void ChangedBlocks::encode(char* buf) const {
+    if (bitmap == nullptr) {
+        return;
+    }
+    size_t len = 0;
+    memcpy(buf, &kChangedBlocksMagic, sizeof(kChangedBlocksMagic));
+    len += sizeof(kChangedBlocksMagic);
+    memcpy(buf + len, &baseSn, sizeof(baseSn));
+    len += sizeof(baseSn);
+    uint32_t bits = bitmap->Size();
+    memcpy(buf + len, &bits, sizeof(bits));
+    len += sizeof(bits);
+    size_t bitmapBytes = (bits + 8 - 1) / 8;
+    memcpy(buf + len, bitmap->GetBitmap(), bitmapBytes);
+    len += bitmapBytes;
+    uint32_t crc = ::curve::common::CRC32(buf, len);
+    memcpy(buf + len, &crc, sizeof(crc));
+}
+
+void ChangedBlocks::decode(const char* buf) {
+    baseSn = 0;
+    bitmap = nullptr;
+    size_t len = 0;
+    uint32_t magic = 0;
+    memcpy(&magic, buf, sizeof(magic));
+    len += sizeof(magic);
+    // Written by the versions without tracking
+    if (magic != kChangedBlocksMagic) {
+        return;
+    }
+    SequenceNum sn = 0;
+    memcpy(&sn, buf + len, sizeof(sn));
+    len += sizeof(sn);
+    uint32_t bits = 0;
+    memcpy(&bits, buf + len, sizeof(bits));
+    len += sizeof(bits);
+    size_t bitmapBytes = (bits + 8 - 1) / 8;
+    const char* bitmapBuf = buf + len;
+    len += bitmapBytes;
+    uint32_t crc = ::curve::common::CRC32(buf, len);
+    uint32_t recordCrc;
+    memcpy(&recordCrc, buf + len, sizeof(recordCrc));
+    // The tracking is only an optimization, fall back to not tracked
+    if (crc != recordCrc) {
+        LOG(WARNING) << "Checking changed blocks crc32 failed.";
+        return;
+    }
+    baseSn = sn;
+    bitmap = std::make_shared<Bitmap>(bits, bitmapBuf);
+}
+
 void SnapshotMetaPage::encode(char* buf) {
     size_t len = 0;
     memcpy(buf, &version, sizeof(version));
@@ -43,6 +120,8 @@ void SnapshotMetaPage::encode(char* buf) {
     len += bitmapBytes;
     uint32_t crc = ::curve::common::CRC32(buf, len);
     memcpy(buf + len, &crc, sizeof(crc));
+    len += sizeof(crc);
+    changedBlocks.encode(buf + len);
 }
 
 CSErrorCode SnapshotMetaPage::decode(const char* buf) {
@@ -67,6 +146,8 @@ CSErrorCode SnapshotMetaPage::decode(const char* buf) {
         LOG(ERROR) << "Checking Crc32 failed.";
         return CSErrorCode::CrcCheckError;
     }
+    len += sizeof(recordCrc);
+    changedBlocks.decode(buf + len);
 
     // TODO(yyk) judge version compatibility, simple processing at present,
     // detailed implementation later
@@ -89,6 +170,7 @@ SnapshotMetaPage::SnapshotMetaPage(const SnapshotMetaPage& metaPage) {
         std::make_shared<Bitmap>(metaPage.bitmap->Size(),
                                  metaPage.bitmap->GetBitmap());
     bitmap = newMap;
+    changedBlocks = metaPage.changedBlocks;
 }
 
 SnapshotMetaPage& SnapshotMetaPage::operator =(
@@ -102,6 +184,7 @@ SnapshotMetaPage& SnapshotMetaPage::operator =(
         std::make_shared<Bitmap>(metaPage.bitmap->Size(),
                                  metaPage.bitmap->GetBitmap());
     bitmap = newMap;
+    changedBlocks = metaPage.changedBlocks;
     return *this;
 }
 
@@ -206,6 +289,14 @@ SequenceNum CSSnapshot::GetSn() const {
     return metaPage_.sn;
 }
 
+void CSSnapshot::SetChangedBlocks(const ChangedBlocks& changedBlocks) {
+    metaPage_.changedBlocks = changedBlocks;
+}
+
+const ChangedBlocks& CSSnapshot::GetChangedBlocks() const {
+    return metaPage_.changedBlocks;
+}
+
 std::shared_ptr<const Bitmap> CSSnapshot::GetPageStatus() const {
     return metaPage_.bitmap;
 }
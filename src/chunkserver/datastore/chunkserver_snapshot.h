@@ -54,7 +54,8 @@ struct DataStoreMetric;
  * bits: 4 bytes
  * bitmap: (bits + 8 - 1) / 8 bytes
  * crc: 4 bytes
- * padding: (4096 - 18 - (bits + 8 - 1) / 8) bytes
+ * changed blocks: see ChangedBlocks
+ * padding: remaining bytes
  */
 struct SnapshotMetaPage {
     // File format version number
@@ -65,6 +66,9 @@ struct SnapshotMetaPage {
     SequenceNum sn;
     // bitmap  representing the current snapshot page status
     std::shared_ptr<Bitmap> bitmap;
+    // Blocks changed between this snapshot and the snapshot of baseSn,
+    // taken over from the chunk when the snapshot file is created
+    ChangedBlocks changedBlocks;
 
     SnapshotMetaPage() : version(FORMAT_VERSION)
                        , damaged(false)
@@ -125,6 +129,18 @@ class CSSnapshot {
      * @return: Return the snapshot sequence number
      */
     SequenceNum GetSn() const;
+    /**
+     * Set the changed blocks of the snapshot, must be called before
+     * creating the snapshot file by Open
+     * @param changedBlocks: the changed blocks taken over from the chunk
+     */
+    void SetChangedBlocks(const ChangedBlocks& changedBlocks);
+    /**
+     * Get the blocks changed between this snapshot and the snapshot of
+     * changedBlocks.baseSn
+     * @return: changed blocks, bitmap is nullptr if not tracked
+     */
+    const ChangedBlocks& GetChangedBlocks() const;
     /**
      * Get a bitmap representing the page status of the snapshot file
      * @return: return bitmap
@@ -141,6 +141,56 @@ struct CSChunkInfo {
     }
 };
 
+// Changed block tracking of a chunk, used by incremental snapshot to
+// transfer only the blocks changed since an earlier snapshot
+struct ChangedBlocks {
+    // Blocks written by requests whose sequence number is larger than
+    // baseSn are marked in the bitmap, kInvalidSeq means the blocks
+    // written since the chunk was created
+    SequenceNum baseSn;
+    // One bit per block, nullptr means the chunk is not tracked
+    std::shared_ptr<Bitmap> bitmap;
+
+    ChangedBlocks() : baseSn(0), bitmap(nullptr) {}
+    ChangedBlocks(const ChangedBlocks& rhs);
+    ChangedBlocks& operator = (const ChangedBlocks& rhs);
+
+    /**
+     * Reset tracking from the given sequence, all bits are cleared
+     * @param sn: the new base sequence number
+     * @param bits: the number of blocks of the chunk
+     */
+    void Reset(SequenceNum sn, uint32_t bits) {
+        baseSn = sn;
+        bitmap = std::make_shared<Bitmap>(bits);
+    }
+
+    /**
+     * Encode after the crc of metapage, so that the metapage can still be
+     * decoded by the versions without tracking
+     * magic: 4 bytes
+     * baseSn: 8 bytes
+     * bits: 4 bytes
+     * bitmap: (bits + 8 - 1) / 8 bytes
+     * crc: 4 bytes
+     * @param buf: the start of the tracking area
+     */
+    void encode(char* buf) const;
+    /**
+     * The encoded length of the tracking area
+     * @param bits: the number of blocks of the chunk
+     */
+    static size_t EncodedSize(uint32_t bits) {
+        return sizeof(uint32_t) + sizeof(SequenceNum) + sizeof(uint32_t) +
+               (bits + 8 - 1) / 8 + sizeof(uint32_t);
+    }
+    /**
+     * Decode the tracking area, mark as not tracked if magic or crc mismatch
+     * @param buf: the start of the tracking area
+     */
+    void decode(const char* buf);
+};
+
 }  // namespace chunkserver
 }  // namespace curve
 
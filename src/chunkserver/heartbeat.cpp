@@ -29,6 +29,7 @@
 
 #include <vector>
 #include <memory>
+#include <set>
 
 #include "src/fs/fs_common.h"
 #include "src/common/timeutility.h"
@@ -96,6 +97,11 @@ int Heartbeat::Init(const HeartbeatOptions &options) {
 
     // init scanManager
     scanMan_ = options.scanManager;
+
+    reportSeq_ = ::curve::common::TimeUtility::GetTimeofDayUs();
+    ackedReportSeq_ = 0;
+    deltaReportCount_ = 0;
+    reportedCopysets_.clear();
     return 0;
 }
 
@@ -310,12 +316,80 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
     return 0;
 }
 
+void Heartbeat::BuildDeltaRequest(HeartbeatRequest* req) {
+    req->set_reportseq(++reportSeq_);
+
+    // mds没有确认过上一次心跳，或者到了定期全量上报的时间
+    if (ackedReportSeq_ == 0 ||
+        deltaReportCount_ >= options_.fullReportInterval) {
+        deltaReportCount_ = 0;
+        return;
+    }
+    ++deltaReportCount_;
+    req->set_basereportseq(ackedReportSeq_);
+
+    std::set<GroupNid> current;
+    google::protobuf::RepeatedPtrField<curve::mds::heartbeat::CopySetInfo>
+        changed;
+    for (auto& info : *req->mutable_copysetinfos()) {
+        GroupNid groupId = ToGroupNid(info.logicalpoolid(), info.copysetid());
+        current.emplace(groupId);
+        auto iter = reportedCopysets_.find(groupId);
+        if (iter == reportedCopysets_.end() ||
+            HeartbeatHelper::CopySetInfoChanged(iter->second, info,
+                options_.statsChangePercent)) {
+            changed.Add()->Swap(&info);
+        }
+    }
+    req->mutable_copysetinfos()->Swap(&changed);
+
+    for (auto& item : reportedCopysets_) {
+        if (current.count(item.first) == 0) {
+            auto removed = req->add_removedcopysets();
+            removed->set_logicalpoolid(GetPoolID(item.first));
+            removed->set_copysetid(GetCopysetID(item.first));
+        }
+    }
+}
+
+void Heartbeat::UpdateReportedCopysets(const HeartbeatRequest& req,
+                                       const HeartbeatResponse& resp) {
+    if (!req.has_reportseq()) {
+        return;
+    }
+
+    // 老版本的mds不会设置needFullReport，此时一直全量上报
+    if (!resp.has_needfullreport() || resp.needfullreport()) {
+        ackedReportSeq_ = 0;
+        reportedCopysets_.clear();
+        return;
+    }
+
+    if (!req.has_basereportseq()) {
+        reportedCopysets_.clear();
+    }
+    for (const auto& info : req.copysetinfos()) {
+        reportedCopysets_[ToGroupNid(info.logicalpoolid(), info.copysetid())] =
+            info;
+    }
+    for (const auto& removed : req.removedcopysets()) {
+        reportedCopysets_.erase(
+            ToGroupNid(removed.logicalpoolid(), removed.copysetid()));
+    }
+    ackedReportSeq_ = req.reportseq();
+}
+
 void Heartbeat::DumpHeartbeatRequest(const HeartbeatRequest& request) {
     DVLOG(6) << "Heartbeat request: Chunkserver ID: "
              << request.chunkserverid()
              << ", IP: " << request.ip() << ", port: " << request.port()
              << ", copyset count: " << request.copysetcount()
-             << ", leader count: " << request.leadercount();
+             << ", leader count: " << request.leadercount()
+             << ", report seq: " << request.reportseq()
+             << ", base report seq: " << request.basereportseq()
+             << ", reported copyset count: " << request.copysetinfos_size()
+             << ", removed copyset count: "
+             << request.removedcopysets_size();
     for (int i = 0; i < request.copysetinfos_size(); i ++) {
         const curve::mds::heartbeat::CopySetInfo& info =
             request.copysetinfos(i);
@@ -587,6 +661,9 @@ void Heartbeat::HeartbeatWorker() {
             ::sleep(errorIntervalSec);
             continue;
         }
+        if (options_.enableDeltaReport) {
+            BuildDeltaRequest(&req);
+        }
 
         LOG(INFO) << "sending heartbeat info";
         ret = SendHeartbeat(req, &resp);
@@ -595,6 +672,7 @@ void Heartbeat::HeartbeatWorker() {
             ::sleep(errorIntervalSec);
             continue;
         }
+        UpdateReportedCopysets(req, resp);
 
         LOG(INFO) << "executing heartbeat info";
         ret = ExecTask(resp);
@@ -69,6 +69,12 @@ struct HeartbeatOptions {
     uint32_t                timeout;
     CopysetNodeManager*     copysetNodeManager;
     ScanManager*            scanManager;
+    // 是否开启增量心跳，只上报有变化的copyset
+    bool                    enableDeltaReport = false;
+    // 开启增量心跳时，每隔多少次心跳进行一次全量上报
+    uint32_t                fullReportInterval = 0;
+    // copyset统计信息变化超过该百分比时才在增量心跳中上报
+    uint32_t                statsChangePercent = 0;
 
     std::shared_ptr<LocalFileSystem> fs;
     std::shared_ptr<FilePool> chunkFilePool;
@@ -129,6 +135,17 @@ class Heartbeat {
      */
     int BuildRequest(HeartbeatRequest* request);
 
+    /*
+     * 开启增量心跳时，去掉请求中相对上一次上报没有变化的copyset
+     */
+    void BuildDeltaRequest(HeartbeatRequest* request);
+
+    /*
+     * 心跳发送成功后，根据mds的回应更新已上报的copyset信息
+     */
+    void UpdateReportedCopysets(const HeartbeatRequest& request,
+                                const HeartbeatResponse& response);
+
     /*
      * 发送心跳消息
      */
@@ -187,6 +204,19 @@ class Heartbeat {
     uint64_t startUpTime_;
 
     ScanManager *scanMan_;
+
+    // 以下为增量心跳的状态，只在心跳线程中访问
+    // 心跳序号，以启动时间初始化，保证重启后不会与之前的序号重复
+    uint64_t reportSeq_;
+
+    // mds确认过的上一次心跳的序号，为0时需要全量上报
+    uint64_t ackedReportSeq_;
+
+    // 距离上一次全量上报的心跳次数
+    uint32_t deltaReportCount_;
+
+    // mds已知的各copyset的信息
+    std::map<GroupNid, curve::mds::heartbeat::CopySetInfo> reportedCopysets_;
 };
 
 }  // namespace chunkserver
@@ -23,6 +23,7 @@
 #include <butil/endpoint.h>
 #include <brpc/channel.h>
 #include <brpc/controller.h>
+#include <algorithm>
 #include <string>
 #include "src/chunkserver/heartbeat_helper.h"
 #include "include/chunkserver/chunkserver_common.h"
@@ -140,6 +141,53 @@ bool HeartbeatHelper::ChunkServerLoadCopySetFin(const std::string peerId) {
     return rep.copysetloadfin();
 }
 
+bool HeartbeatHelper::CopySetInfoChanged(
+    const ::curve::mds::heartbeat::CopySetInfo &last,
+    const ::curve::mds::heartbeat::CopySetInfo &cur,
+    uint32_t statsChangePercent) {
+    if (last.epoch() != cur.epoch() ||
+        last.leaderpeer().address() != cur.leaderpeer().address() ||
+        last.peers_size() != cur.peers_size()) {
+        return true;
+    }
+    for (int i = 0; i < cur.peers_size(); i++) {
+        if (last.peers(i).address() != cur.peers(i).address()) {
+            return true;
+        }
+    }
+
+    // 正在进行的配置变更需要每次都上报，mds根据它推进operator
+    if (last.has_configchangeinfo() || cur.has_configchangeinfo()) {
+        return true;
+    }
+
+    if (last.scaning() != cur.scaning() ||
+        last.lastscansec() != cur.lastscansec() ||
+        last.scanmap_size() != cur.scanmap_size()) {
+        return true;
+    }
+
+    if (last.has_stats() != cur.has_stats()) {
+        return true;
+    }
+    if (!cur.has_stats()) {
+        return false;
+    }
+    const auto &ls = last.stats();
+    const auto &cs = cur.stats();
+    return StatChanged(ls.readrate(), cs.readrate(), statsChangePercent) ||
+           StatChanged(ls.writerate(), cs.writerate(), statsChangePercent) ||
+           StatChanged(ls.readiops(), cs.readiops(), statsChangePercent) ||
+           StatChanged(ls.writeiops(), cs.writeiops(), statsChangePercent);
+}
+
+bool HeartbeatHelper::StatChanged(uint32_t last, uint32_t cur,
+    uint32_t statsChangePercent) {
+    uint64_t diff = last > cur ? last - cur : cur - last;
+    return diff * 100 > static_cast<uint64_t>(std::max(last, cur)) *
+                        statsChangePercent;
+}
+
 }  // namespace chunkserver
 }  // namespace curve
 
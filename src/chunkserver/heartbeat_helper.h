@@ -90,6 +90,26 @@ class HeartbeatHelper {
      * @return false-copyset加载完毕 true-copyset未加载完成
      */
     static bool ChunkServerLoadCopySetFin(const std::string ipPort);
+
+    /**
+     * 判断copyset的信息相对上一次上报是否有变化，用于增量心跳
+     * epoch、leader、成员、配置变更、scan信息任一不同即认为有变化，
+     * 统计信息的变化超过statsChangePercent才认为有变化
+     *
+     * @param[in] last 上一次上报给mds的copyset信息
+     * @param[in] cur 本次构建的copyset信息
+     * @param[in] statsChangePercent 统计信息变化的百分比阈值
+     *
+     * @return true-有变化，需要上报 false-无变化
+     */
+    static bool CopySetInfoChanged(
+        const ::curve::mds::heartbeat::CopySetInfo &last,
+        const ::curve::mds::heartbeat::CopySetInfo &cur,
+        uint32_t statsChangePercent);
+
+ private:
+    static bool StatChanged(uint32_t last, uint32_t cur,
+        uint32_t statsChangePercent);
 };
 }  // namespace chunkserver
 }  // namespace curve
@@ -53,17 +53,17 @@ class InflightThrottle {
     }
 
     /**
-     * @brief: inflight request计数加1
+     * @brief: inflight request计数加count，批量请求按其中的op个数计数
      */
-    inline void Increment() {
-        inflightRequestCount_.fetch_add(1, std::memory_order_relaxed);
+    inline void Increment(uint64_t count = 1) {
+        inflightRequestCount_.fetch_add(count, std::memory_order_relaxed);
     }
 
     /**
-     * @brief: inflight request计数减1
+     * @brief: inflight request计数减count
      */
-    inline void Decrement() {
-        inflightRequestCount_.fetch_sub(1, std::memory_order_relaxed);
+    inline void Decrement(uint64_t count = 1) {
+        inflightRequestCount_.fetch_sub(count, std::memory_order_relaxed);
     }
 
  private:
@@ -167,6 +167,8 @@ std::shared_ptr<ChunkOpRequest> ChunkOpRequest::Decode(butil::IOBuf log,
             return std::make_shared<PasteChunkInternalRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE:
             return std::make_shared<CreateCloneChunkRequest>();
+        case CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH:
+            return std::make_shared<CreateCloneChunksRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_SCAN:
             return std::make_shared<ScanChunkRequest>(index, leaderId);
         default:LOG(ERROR) << "Unknown chunk op";
@@ -704,6 +706,76 @@ void CreateCloneChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datast
     }
 }
 
+void CreateCloneChunksRequest::OnApply(uint64_t index,
+                                       ::google::protobuf::Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+    for (const auto &item : request_->clonechunks()) {
+        auto ret = datastore_->CreateCloneChunk(item.chunkid(),
+                                                item.sn(),
+                                                item.correctedsn(),
+                                                item.size(),
+                                                item.location());
+        if (CSErrorCode::Success == ret) {
+            continue;
+        } else if (CSErrorCode::InternalError == ret ||
+                   CSErrorCode::CrcCheckError == ret ||
+                   CSErrorCode::FileFormatError == ret) {
+            LOG(FATAL) << "create clone failed: "
+                       << ", chunk: " << item.ShortDebugString()
+                       << ", copyset: " << node_->GetCopysetId();
+            response_->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+        } else if (CSErrorCode::ChunkConflictError == ret) {
+            LOG(WARNING) << "create clone chunk exist: "
+                         << ", chunk: " << item.ShortDebugString();
+            response_->add_existchunks(item.chunkid());
+        } else {
+            // 已创建的chunk不回滚，克隆服务重试时作为已存在的chunk处理
+            LOG(ERROR) << "create clone failed: "
+                       << ", chunk: " << item.ShortDebugString();
+            response_->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+        }
+    }
+
+    if (response_->status() == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+        node_->UpdateAppliedIndex(index);
+    }
+    response_->set_appliedindex(MaxAppliedIndex(node_, index));
+}
+
+void CreateCloneChunksRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,  //NOLINT
+                                              const ChunkRequest &request,
+                                              const butil::IOBuf &data) {
+    (void)data;
+    // NOTE: 处理过程中优先使用参数传入的datastore/request
+    for (const auto &item : request.clonechunks()) {
+        auto ret = datastore->CreateCloneChunk(item.chunkid(),
+                                               item.sn(),
+                                               item.correctedsn(),
+                                               item.size(),
+                                               item.location());
+        if (CSErrorCode::Success == ret) {
+            continue;
+        }
+
+        if (CSErrorCode::ChunkConflictError == ret) {
+            LOG(WARNING) << "create clone chunk exist: "
+                         << ", chunk: " << item.ShortDebugString();
+        } else if (CSErrorCode::InternalError == ret ||
+                   CSErrorCode::CrcCheckError == ret ||
+                   CSErrorCode::FileFormatError == ret) {
+            LOG(FATAL) << "create clone failed:"
+                       << ", chunk: " << item.ShortDebugString();
+        } else {
+            LOG(ERROR) << "create clone failed: "
+                       << ", chunk: " << item.ShortDebugString();
+        }
+    }
+}
+
 void PasteChunkInternalRequest::Process() {
     brpc::ClosureGuard doneGuard(done_);
     /**
@@ -331,6 +331,32 @@ class CreateCloneChunkRequest : public ChunkOpRequest {
                         const butil::IOBuf &data) override;
 };
 
+/**
+ * 批量创建同一copyset上的clone chunk，所有chunk在一条raft日志中创建。
+ * 涉及多个chunk，在CopysetNode::on_apply中作为屏障单独apply
+ */
+class CreateCloneChunksRequest : public ChunkOpRequest {
+ public:
+    CreateCloneChunksRequest() :
+        ChunkOpRequest() {}
+    CreateCloneChunksRequest(std::shared_ptr<CopysetNode> nodePtr,
+                             RpcController *cntl,
+                             const ChunkRequest *request,
+                             ChunkResponse *response,
+                             ::google::protobuf::Closure *done) :
+        ChunkOpRequest(nodePtr,
+                       cntl,
+                       request,
+                       response,
+                       done) {}
+    virtual ~CreateCloneChunksRequest() = default;
+
+    void OnApply(uint64_t index, ::google::protobuf::Closure *done) override;
+    void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
+                        const ChunkRequest &request,
+                        const butil::IOBuf &data) override;
+};
+
 class PasteChunkInternalRequest : public ChunkOpRequest {
  public:
     PasteChunkInternalRequest() :
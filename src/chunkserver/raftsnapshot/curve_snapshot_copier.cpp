@@ -39,11 +39,21 @@
 //          Zheng,Pengfei(zhengpengfei@baidu.com)
 //          Xiong,Kai(xiongkai@baidu.com)
 
+#include <algorithm>
+#include <memory>
 #include "src/chunkserver/raftsnapshot/curve_snapshot_copier.h"
+#include "src/chunkserver/raftsnapshot/curve_snapshot_file_reader.h"
 
 namespace curve {
 namespace chunkserver {
 
+DEFINE_bool(raft_enable_delta_install_snapshot, true,
+            "only download the differing blocks of chunk files which"
+            " already exist on the follower when installing snapshot");
+
+// 增量下载时一次下载的连续数据块的最大长度，避免占用过多内存
+const size_t kMaxDeltaRangeBytes = 4 * 1024 * 1024;
+
 CurveSnapshotCopier::CurveSnapshotCopier(CurveSnapshotStorage* storage,
                                          bool filter_before_copy_remote,
                                          braft::FileSystemAdaptor* fs,
@@ -57,6 +67,9 @@ CurveSnapshotCopier::CurveSnapshotCopier(CurveSnapshotStorage* storage,
     , _storage(storage)
     , _reader(NULL)
     , _cur_session(NULL)
+    , _delta_unsupported(false)
+    , _delta_reused_bytes(0)
+    , _delta_downloaded_bytes(0)
 {}
 
 CurveSnapshotCopier::~CurveSnapshotCopier() {
@@ -335,41 +348,48 @@ void CurveSnapshotCopier::copy_file(const std::string& filename, bool attch) {
     }
     braft::LocalFileMeta meta;
     _remote_snapshot.get_file_meta(filename, &meta);
-    std::unique_lock<braft::raft_mutex_t> lck(_mutex);
-    if (_cancelled) {
-        set_error(ECANCELED, "%s", berror(ECANCELED));
-        return;
-    }
-    scoped_refptr<braft::RemoteFileCopier::Session> session
-        = _copier.start_to_copy_to_file(filename, file_path, NULL);
-    if (session == NULL) {
-        LOG(WARNING) << "Fail to copy " << filename
-                     << " path: " << _writer->get_path();
-        set_error(-1, "Fail to copy %s", filename.c_str());
+    // 本地已有该chunk文件时只下载不同的数据块
+    bool delta_copied = copy_file_delta(filename, file_path);
+    if (!ok()) {
         return;
     }
-    _cur_session = session.get();
-    lck.unlock();
-    session->join();
-    lck.lock();
-    _cur_session = NULL;
-    lck.unlock();
-    if (!session->status().ok()) {
-        // 如果是文件不存在，那么删除刚开始open的文件
-        if (session->status().error_code() == ENOENT) {
-            bool rc = _fs->delete_file(file_path, false);
-            if (!rc) {
-                LOG(ERROR) << "Fail to delete file" << file_path
-                           << " : " << ::berror(errno);
-                set_error(errno,
-                          "Fail to create delete file " + file_path);
-            }
+    if (!delta_copied) {
+        std::unique_lock<braft::raft_mutex_t> lck(_mutex);
+        if (_cancelled) {
+            set_error(ECANCELED, "%s", berror(ECANCELED));
+            return;
+        }
+        scoped_refptr<braft::RemoteFileCopier::Session> session
+            = _copier.start_to_copy_to_file(filename, file_path, NULL);
+        if (session == NULL) {
+            LOG(WARNING) << "Fail to copy " << filename
+                         << " path: " << _writer->get_path();
+            set_error(-1, "Fail to copy %s", filename.c_str());
             return;
         }
+        _cur_session = session.get();
+        lck.unlock();
+        session->join();
+        lck.lock();
+        _cur_session = NULL;
+        lck.unlock();
+        if (!session->status().ok()) {
+            // 如果是文件不存在，那么删除刚开始open的文件
+            if (session->status().error_code() == ENOENT) {
+                bool rc = _fs->delete_file(file_path, false);
+                if (!rc) {
+                    LOG(ERROR) << "Fail to delete file" << file_path
+                               << " : " << ::berror(errno);
+                    set_error(errno,
+                              "Fail to create delete file " + file_path);
+                }
+                return;
+            }
 
-        set_error(session->status().error_code(),
-                  session->status().error_cstr());
-        return;
+            set_error(session->status().error_code(),
+                      session->status().error_cstr());
+            return;
+        }
     }
     // 如果是attach file，那么不需要持久化file meta信息
     if (!attch && _writer->add_file(filename, &meta) != 0) {
@@ -382,6 +402,176 @@ void CurveSnapshotCopier::copy_file(const std::string& filename, bool attch) {
     }
 }
 
+bool CurveSnapshotCopier::copy_file_delta(const std::string& filename,
+                                          const std::string& file_path) {
+    // 快照目录外的文件(即copyset的chunk文件)才可能在本地已存在，
+    // 相对于writer目录的路径和相对于快照目录的路径指向同一个本地文件
+    if (!FLAGS_raft_enable_delta_install_snapshot || _delta_unsupported ||
+        filename == get_rfilename(filename)) {
+        return false;
+    }
+    std::string local_path = _writer->get_path() + '/' + filename;
+    if (!_fs->path_exists(local_path) || _fs->directory_exists(local_path)) {
+        return false;
+    }
+
+    // 老版本的leader不支持校验和虚拟文件，返回EPERM，此时回退为全量下载，
+    // 并且不再为剩下的文件请求校验和
+    butil::IOBuf buf;
+    int rc = copy_to_iobuf(
+                CurveSnapshotFileReader::checksum_filename(filename), &buf);
+    if (rc == EPERM) {
+        LOG(WARNING) << "Leader does not support delta install snapshot"
+                     << ", copy remaining files entirely"
+                     << " path: " << _writer->get_path();
+        _delta_unsupported = true;
+        return false;
+    }
+    if (rc != 0) {
+        LOG_IF(WARNING, rc != ECANCELED)
+            << "Fail to copy checksum of " << filename
+            << ", rc: " << rc << ", fallback to copy whole file";
+        return false;
+    }
+    CurveSnapshotPbChecksum checksum;
+    butil::IOBufAsZeroCopyInputStream wrapper(buf);
+    if (!checksum.ParseFromZeroCopyStream(&wrapper) ||
+        checksum.block_size() == 0 ||
+        static_cast<uint64_t>(checksum.block_crc_size()) !=
+            (checksum.file_size() + checksum.block_size() - 1) /
+                checksum.block_size() ||
+        checksum.block_sha1_size() != checksum.block_crc_size()) {
+        LOG(WARNING) << "Bad checksum format of " << filename;
+        return false;
+    }
+
+    butil::File::Error e;
+    std::unique_ptr<braft::FileAdaptor> local(
+        _fs->open(local_path, O_RDONLY | O_CLOEXEC, NULL, &e));
+    if (local == nullptr) {
+        LOG(WARNING) << "Fail to open " << local_path
+                     << " : " << butil::File::ErrorToString(e);
+        return false;
+    }
+    // chunk文件大小固定，大小不同说明不是同一个文件，直接全量下载
+    if (local->size() != static_cast<ssize_t>(checksum.file_size())) {
+        LOG(INFO) << "Size of " << local_path << " is " << local->size()
+                  << ", remote size is " << checksum.file_size();
+        return false;
+    }
+    std::unique_ptr<braft::FileAdaptor> dest(_fs->open(file_path,
+        O_TRUNC | O_WRONLY | O_CREAT | O_CLOEXEC, NULL, &e));
+    if (dest == nullptr) {
+        LOG(WARNING) << "Fail to open " << file_path
+                     << " : " << butil::File::ErrorToString(e);
+        return false;
+    }
+
+    // 相同的数据块从本地拷贝，不同的数据块合并成连续的range后从leader下载
+    const uint64_t block_size = checksum.block_size();
+    const uint64_t file_size = checksum.file_size();
+    uint64_t range_begin = 0;
+    uint64_t range_end = 0;
+    uint64_t reused_bytes = 0;
+    for (int i = 0; i < checksum.block_crc_size() && ok(); ++i) {
+        uint64_t offset = i * block_size;
+        size_t length = std::min(block_size, file_size - offset);
+        butil::IOPortal data;
+        if (local->read(&data, offset, length) !=
+                static_cast<ssize_t>(length)) {
+            LOG(WARNING) << "Fail to read " << local_path
+                         << ", offset: " << offset << ", length: " << length;
+            return false;
+        }
+        // crc32c不同的数据块一定不同，相同时再用sha1确认，避免crc32c碰撞时
+        // 复用了错误的数据
+        if (CurveSnapshotFileReader::block_crc(data) == checksum.block_crc(i) &&
+            CurveSnapshotFileReader::block_sha1(data) ==
+                checksum.block_sha1(i)) {
+            if (dest->write(data, offset) != static_cast<ssize_t>(length)) {
+                LOG(WARNING) << "Fail to write " << file_path
+                             << ", offset: " << offset;
+                return false;
+            }
+            reused_bytes += length;
+            continue;
+        }
+        if (range_end != offset ||
+            range_end - range_begin >= kMaxDeltaRangeBytes) {
+            if (range_end > range_begin &&
+                copy_range(filename, dest.get(), range_begin,
+                           range_end - range_begin) != 0) {
+                return false;
+            }
+            range_begin = offset;
+        }
+        range_end = offset + length;
+    }
+    if (ok() && range_end > range_begin &&
+        copy_range(filename, dest.get(), range_begin,
+                   range_end - range_begin) != 0) {
+        return false;
+    }
+    if (!ok()) {
+        return false;
+    }
+    if (!dest->sync()) {
+        LOG(WARNING) << "Fail to sync " << file_path;
+        return false;
+    }
+    _delta_reused_bytes += reused_bytes;
+    _delta_downloaded_bytes += file_size - reused_bytes;
+    LOG(INFO) << "Copied " << filename << " by delta, reused bytes: "
+              << reused_bytes << ", downloaded bytes: "
+              << file_size - reused_bytes
+              << " path: " << _writer->get_path();
+    return true;
+}
+
+int CurveSnapshotCopier::copy_range(const std::string& filename,
+                                    braft::FileAdaptor* dest,
+                                    off_t offset,
+                                    size_t length) {
+    butil::IOBuf data;
+    int rc = copy_to_iobuf(CurveSnapshotFileReader::range_filename(
+                                        filename, offset, length), &data);
+    if (rc != 0) {
+        LOG_IF(WARNING, rc != ECANCELED) << "Fail to copy " << filename
+                                         << ", offset: " << offset
+                                         << ", length: " << length
+                                         << ", rc: " << rc;
+        return -1;
+    }
+    if (data.size() != length ||
+        dest->write(data, offset) != static_cast<ssize_t>(length)) {
+        LOG(WARNING) << "Fail to write " << filename << ", offset: " << offset
+                     << ", length: " << length << ", copied: " << data.size();
+        return -1;
+    }
+    return 0;
+}
+
+int CurveSnapshotCopier::copy_to_iobuf(const std::string& filename,
+                                       butil::IOBuf* buf) {
+    std::unique_lock<braft::raft_mutex_t> lck(_mutex);
+    if (_cancelled) {
+        set_error(ECANCELED, "%s", berror(ECANCELED));
+        return ECANCELED;
+    }
+    scoped_refptr<braft::RemoteFileCopier::Session> session
+        = _copier.start_to_copy_to_iobuf(filename, buf, NULL);
+    _cur_session = session.get();
+    lck.unlock();
+    session->join();
+    lck.lock();
+    _cur_session = NULL;
+    if (_cancelled) {
+        set_error(ECANCELED, "%s", berror(ECANCELED));
+        return ECANCELED;
+    }
+    return session->status().error_code();
+}
+
 std::string CurveSnapshotCopier::get_rfilename(const std::string& filename) {
     std::string rfilename;
     auto pos = filename.rfind("../");
@@ -43,6 +43,7 @@
 #define SRC_CHUNKSERVER_RAFTSNAPSHOT_CURVE_SNAPSHOT_COPIER_H_
 
 #include <braft/storage.h>
+#include <gflags/gflags.h>
 #include <vector>
 #include <string>
 #include "src/chunkserver/raftsnapshot/curve_snapshot.h"
@@ -51,6 +52,8 @@
 namespace curve {
 namespace chunkserver {
 
+DECLARE_bool(raft_enable_delta_install_snapshot);
+
 class CurveSnapshotStorage;
 
 class CurveSnapshotCopier : public braft::SnapshotCopier {
@@ -65,6 +68,12 @@ class CurveSnapshotCopier : public braft::SnapshotCopier {
     virtual braft::SnapshotReader* get_reader() { return _reader; }
     void start();
     int init(const std::string& uri);
+    // 增量下载的文件中从本地复用的字节数
+    uint64_t delta_reused_bytes() const { return _delta_reused_bytes; }
+    // 增量下载的文件中从leader下载的字节数
+    uint64_t delta_downloaded_bytes() const {
+        return _delta_downloaded_bytes;
+    }
 
  private:
     static void* start_copy(void* arg);
@@ -75,6 +84,20 @@ class CurveSnapshotCopier : public braft::SnapshotCopier {
                            braft::SnapshotReader* last_snapshot);
     void filter();
     void copy_file(const std::string& filename, bool attach = false);
+    /**
+     * 本地已经存在同名chunk文件时，从leader获取文件的分块校验和，
+     * 相同的数据块从本地文件拷贝，不同的数据块才从leader下载
+     * @return 增量下载成功返回true，返回false时需要全量下载
+     */
+    bool copy_file_delta(const std::string& filename,
+                         const std::string& file_path);
+    // 下载文件[offset, offset + length)范围的数据并写入dest
+    int copy_range(const std::string& filename,
+                   braft::FileAdaptor* dest,
+                   off_t offset,
+                   size_t length);
+    // 下载leader上的文件到内存，返回错误码
+    int copy_to_iobuf(const std::string& filename, butil::IOBuf* buf);
     // 这里的filename是相对于快照目录的路径，为了先把文件下载到临时目录，需要把前面的..去掉
     std::string get_rfilename(const std::string& filename);
 
@@ -90,6 +113,10 @@ class CurveSnapshotCopier : public braft::SnapshotCopier {
     braft::RemoteFileCopier::Session* _cur_session;
     CurveSnapshot _remote_snapshot;
     braft::RemoteFileCopier _copier;
+    // leader不支持增量下载时，后面的文件直接全量下载
+    bool _delta_unsupported;
+    uint64_t _delta_reused_bytes;
+    uint64_t _delta_downloaded_bytes;
 };
 }  // namespace chunkserver
 }  // namespace curve
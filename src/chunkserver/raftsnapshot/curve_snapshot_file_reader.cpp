@@ -39,11 +39,18 @@
 //          Zheng,Pengfei(zhengpengfei@baidu.com)
 //          Xiong,Kai(xiongkai@baidu.com)
 
+#include <butil/crc32c.h>
+#include <butil/sha1.h>
+#include <algorithm>
 #include "src/chunkserver/raftsnapshot/curve_snapshot_file_reader.h"
 
 namespace curve {
 namespace chunkserver {
 
+DEFINE_int32(raft_snapshot_checksum_block_size, 128 * 1024,
+             "block size of checksum when installing snapshot by delta,"
+             " should be aligned with raft_max_byte_count_per_rpc");
+
 CurveSnapshotAttachMetaTable::CurveSnapshotAttachMetaTable() {}
 
 CurveSnapshotAttachMetaTable::~CurveSnapshotAttachMetaTable() {}
@@ -137,6 +144,34 @@ int CurveSnapshotFileReader::read_file(butil::IOBuf* out,
         }
         return ret;
     }
+    const std::string checksum_prefix(BRAFT_SNAPSHOT_CHECKSUM_PREFIX);
+    if (filename.compare(0, checksum_prefix.size(), checksum_prefix) == 0) {
+        return read_checksum(out, filename.substr(checksum_prefix.size()),
+                             offset, max_count, read_count, is_eof);
+    }
+    const std::string range_prefix(BRAFT_SNAPSHOT_RANGE_PREFIX);
+    if (filename.compare(0, range_prefix.size(), range_prefix) == 0) {
+        // 虚拟文件的offset相对于range的起始位置，读取范围不超过range的结尾
+        std::string real_filename;
+        off_t range_offset = 0;
+        size_t range_length = 0;
+        if (!parse_range_filename(filename, &real_filename,
+                                  &range_offset, &range_length)) {
+            return EINVAL;
+        }
+        if (offset >= static_cast<off_t>(range_length)) {
+            *read_count = 0;
+            *is_eof = true;
+            return 0;
+        }
+        int ret = read_file(out, real_filename, range_offset + offset,
+                            std::min(max_count, range_length - offset),
+                            read_partly, read_count, is_eof);
+        if (ret == 0 && offset + *read_count >= range_length) {
+            *is_eof = true;
+        }
+        return ret;
+    }
     braft::LocalFileMeta file_meta;
     if (_meta_table.get_file_meta(filename, &file_meta) != 0 &&
         _attach_meta_table.get_attach_file_meta(filename, nullptr)) {
@@ -173,5 +208,164 @@ int CurveSnapshotFileReader::read_file(butil::IOBuf* out,
                                     offset, new_max_count, read_count, is_eof);
 }
 
+int CurveSnapshotFileReader::read_checksum(butil::IOBuf* out,
+                                           const std::string &filename,
+                                           off_t offset,
+                                           size_t max_count,
+                                           size_t* read_count,
+                                           bool* is_eof) const {
+    braft::LocalFileMeta file_meta;
+    if (_meta_table.get_file_meta(filename, &file_meta) != 0 &&
+        _attach_meta_table.get_attach_file_meta(filename, nullptr)) {
+        return EPERM;
+    }
+    if (FLAGS_raft_snapshot_checksum_block_size <= 0) {
+        return EINVAL;
+    }
+
+    // 校验和只计算一次，follower分多次读取或者被限流后重试时直接使用
+    BAIDU_SCOPED_LOCK(_checksum_mutex);
+    Checksum& checksum = _checksums[filename];
+    if (!checksum.done) {
+        int ret = compute_checksum(filename, &file_meta, &checksum);
+        if (ret != 0) {
+            if (ret != EAGAIN) {
+                _checksums.erase(filename);
+            }
+            return ret;
+        }
+    }
+    butil::IOBuf buf = checksum.data;
+    buf.pop_front(offset);
+    buf.cutn(out, max_count);
+    *read_count = out->size();
+    *is_eof = buf.empty();
+    if (*is_eof) {
+        _checksums.erase(filename);
+    }
+    return 0;
+}
+
+int CurveSnapshotFileReader::compute_checksum(const std::string &filename,
+                                              braft::LocalFileMeta* file_meta,
+                                              Checksum* checksum) const {
+    if (checksum->next_offset == 0) {
+        checksum->pb.set_block_size(FLAGS_raft_snapshot_checksum_block_size);
+    }
+    const size_t block_size = checksum->pb.block_size();
+    bool throttle = _snapshot_throttle &&
+                braft::FLAGS_raft_enable_throttle_when_install_snapshot;
+    bool eof = false;
+    while (!eof) {
+        // 计算校验和需要读整个文件，和普通的读文件一样受throttle限制
+        int64_t start = butil::cpuwide_time_us();
+        size_t acquired = block_size;
+        if (throttle) {
+            acquired = _snapshot_throttle->throttled_by_throughput(block_size);
+            if (acquired < block_size) {
+                if (acquired > 0) {
+                    _snapshot_throttle->return_unused_throughput(
+                        acquired, 0, butil::cpuwide_time_us() - start);
+                }
+                LOG(INFO) << "Read checksum throttled, path: " << path()
+                          << ", file: " << filename
+                          << ", offset: " << checksum->next_offset;
+                return EAGAIN;
+            }
+        }
+        butil::IOBuf block;
+        size_t count = 0;
+        int ret = LocalDirReader::read_file_with_meta(&block, filename,
+                            file_meta, checksum->next_offset, block_size,
+                            &count, &eof);
+        if (throttle && count < acquired) {
+            _snapshot_throttle->return_unused_throughput(
+                acquired, count, butil::cpuwide_time_us() - start);
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        if (count == 0) {
+            break;
+        }
+        checksum->pb.add_block_crc(block_crc(block));
+        checksum->pb.add_block_sha1(block_sha1(block));
+        checksum->next_offset += count;
+    }
+    checksum->pb.set_file_size(checksum->next_offset);
+
+    butil::IOBufAsZeroCopyOutputStream wrapper(&checksum->data);
+    if (!checksum->pb.SerializeToZeroCopyStream(&wrapper)) {
+        LOG(ERROR) << "Fail to serialize checksum of " << filename;
+        return EIO;
+    }
+    checksum->done = true;
+    return 0;
+}
+
+std::string CurveSnapshotFileReader::checksum_filename(
+                                        const std::string& filename) {
+    return BRAFT_SNAPSHOT_CHECKSUM_PREFIX + filename;
+}
+
+std::string CurveSnapshotFileReader::range_filename(
+                                        const std::string& filename,
+                                        off_t offset,
+                                        size_t length) {
+    return BRAFT_SNAPSHOT_RANGE_PREFIX + std::to_string(offset) + "/" +
+           std::to_string(length) + "/" + filename;
+}
+
+bool CurveSnapshotFileReader::parse_range_filename(const std::string& name,
+                                                   std::string* filename,
+                                                   off_t* offset,
+                                                   size_t* length) {
+    const std::string prefix(BRAFT_SNAPSHOT_RANGE_PREFIX);
+    if (name.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    // filename本身可能包含'/'，只切分出前两段
+    size_t offset_end = name.find('/', prefix.size());
+    if (offset_end == std::string::npos) {
+        return false;
+    }
+    size_t length_end = name.find('/', offset_end + 1);
+    if (length_end == std::string::npos || length_end + 1 >= name.size()) {
+        return false;
+    }
+    std::string offset_str = name.substr(prefix.size(),
+                                         offset_end - prefix.size());
+    std::string length_str = name.substr(offset_end + 1,
+                                         length_end - offset_end - 1);
+    if (offset_str.empty() || length_str.empty() ||
+        offset_str.size() > 18 || length_str.size() > 18 ||
+        offset_str.find_first_not_of("0123456789") != std::string::npos ||
+        length_str.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    *offset = std::stoll(offset_str);
+    *length = std::stoull(length_str);
+    *filename = name.substr(length_end + 1);
+    return true;
+}
+
+uint32_t CurveSnapshotFileReader::block_crc(const butil::IOBuf& data) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < data.backing_block_num(); ++i) {
+        butil::StringPiece block = data.backing_block(i);
+        crc = butil::crc32c::Extend(crc, block.data(), block.size());
+    }
+    return crc;
+}
+
+std::string CurveSnapshotFileReader::block_sha1(const butil::IOBuf& data) {
+    const std::string buf = data.to_string();
+    unsigned char hash[butil::kSHA1Length];
+    butil::SHA1HashBytes(reinterpret_cast<const unsigned char*>(buf.data()),
+                         buf.size(), hash);
+    return std::string(reinterpret_cast<const char*>(hash),
+                       butil::kSHA1Length);
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -44,6 +44,8 @@
 
 #include <braft/file_reader.h>
 #include <braft/snapshot.h>
+#include <braft/util.h>
+#include <gflags/gflags.h>
 #include <utility>
 #include <vector>
 #include <string>
@@ -54,6 +56,8 @@
 namespace curve {
 namespace chunkserver {
 
+DECLARE_int32(raft_snapshot_checksum_block_size);
+
 /**
  * snapshot attachment文件元数据表，同上面的
  * CurveSnapshotAttachMetaTable接口，主要提供attach文件元数据信息
@@ -113,10 +117,57 @@ class CurveSnapshotFileReader : public braft::LocalDirReader {
         return _meta_table;
     }
 
+    // 增量install snapshot时获取文件分块校验和的虚拟文件名
+    static std::string checksum_filename(const std::string& filename);
+    // 增量install snapshot时获取文件中一段数据的虚拟文件名
+    static std::string range_filename(const std::string& filename,
+                                      off_t offset,
+                                      size_t length);
+    // 解析range_filename生成的虚拟文件名，格式错误返回false
+    static bool parse_range_filename(const std::string& name,
+                                     std::string* filename,
+                                     off_t* offset,
+                                     size_t* length);
+    // 计算一个数据块的crc32c校验和
+    static uint32_t block_crc(const butil::IOBuf& data);
+    // 计算一个数据块的sha1，crc32c相同时用于进一步确认数据相同
+    static std::string block_sha1(const butil::IOBuf& data);
+
  private:
+    // 文件的校验和，被throttle限制时记录已经计算到的位置，下次接着计算
+    struct Checksum {
+        CurveSnapshotPbChecksum pb;
+        off_t next_offset = 0;
+        bool done = false;
+        // 计算完成后序列化的结果
+        butil::IOBuf data;
+    };
+
+    /**
+     * 按FLAGS_raft_snapshot_checksum_block_size分块计算文件的校验和，
+     * 序列化后返回[offset, offset + max_count)范围内的数据
+     */
+    int read_checksum(butil::IOBuf* out,
+                      const std::string &filename,
+                      off_t offset,
+                      size_t max_count,
+                      size_t* read_count,
+                      bool* is_eof) const;
+
+    /**
+     * 从checksum->next_offset开始继续计算校验和，读盘计入snapshot throttle，
+     * 被限流时返回EAGAIN，已经计算的部分保留在checksum中
+     */
+    int compute_checksum(const std::string &filename,
+                         braft::LocalFileMeta* file_meta,
+                         Checksum* checksum) const;
+
     braft::LocalSnapshotMetaTable _meta_table;
     CurveSnapshotAttachMetaTable _attach_meta_table;
     scoped_refptr<braft::SnapshotThrottle> _snapshot_throttle;
+    // 正在被follower读取的文件校验和，follower读完后删除
+    mutable braft::raft_mutex_t _checksum_mutex;
+    mutable std::map<std::string, Checksum> _checksums;
 };
 
 }  // namespace chunkserver
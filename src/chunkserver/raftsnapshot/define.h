@@ -37,6 +37,11 @@ const char RAFT_LOG_DIR[]  = "log";
 #define BRAFT_SNAPSHOT_META_FILE        "__raft_snapshot_meta"
 #define BRAFT_SNAPSHOT_ATTACH_META_FILE "__raft_snapshot_attach_meta"
 #define BRAFT_PROTOBUF_FILE_TEMP ".tmp"
+// 增量install snapshot时使用的虚拟文件，不落盘，由leader读请求时生成
+// 文件的分块校验和: BRAFT_SNAPSHOT_CHECKSUM_PREFIX + filename
+#define BRAFT_SNAPSHOT_CHECKSUM_PREFIX  "__raft_snapshot_checksum__/"
+// 文件的一段数据: BRAFT_SNAPSHOT_RANGE_PREFIX + offset/length/filename
+#define BRAFT_SNAPSHOT_RANGE_PREFIX     "__raft_snapshot_range__/"
 
 }  // namespace chunkserver
 }  // namespace curve
@@ -172,7 +172,11 @@ void ClientClosure::Run() {
 
     bool needRetry = false;
 
-    if (cntl_->Failed()) {
+    if (cntl_->Failed() && cntlstatus_ == brpc::ENOMETHOD &&
+        IsCloneChunkBatchOp(reqCtx_->optype_)) {
+        // 老版本的chunkserver没有批量接口，重试也不会成功
+        OnMethodNotFound();
+    } else if (cntl_->Failed()) {
         needRetry = true;
         OnRpcFailed();
     } else {
@@ -325,6 +329,8 @@ void ClientClosure::OnSuccess() {
 
     auto duration = cntl_->latency_us();
     MetricHelper::LatencyRecord(fileMetric_, duration, reqCtx_->optype_);
+    MetricHelper::StripeLatencyRecord(fileMetric_, reqCtx_->stripePos_,
+                                      duration);
     MetricHelper::IncremRPCQPSCount(
         fileMetric_, reqCtx_->rawlength_, reqCtx_->optype_);
 }
@@ -372,6 +378,19 @@ void ClientClosure::OnEpochTooOld() {
         << butil::endpoint2str(cntl_->remote_side()).c_str();
 }
 
+void ClientClosure::OnMethodNotFound() {
+    status_ = cntl_->ErrorCode();
+    reqDone_->SetFailed(status_);
+
+    LOG(WARNING) << OpTypeToString(reqCtx_->optype_)
+        << " not supported, error: " << cntl_->ErrorText()
+        << ", " << *reqCtx_
+        << ", IO id = " << reqDone_->GetIOTracker()->GetID()
+        << ", request id = " << reqCtx_->id_
+        << ", remote side = "
+        << butil::endpoint2str(cntl_->remote_side()).c_str();
+}
+
 void ClientClosure::OnRedirected() {
     LOG(WARNING) << OpTypeToString(reqCtx_->optype_) << " redirected, "
         << *reqCtx_
@@ -564,6 +583,15 @@ void GetChunkInfoClosure::OnSuccess() {
         reqCtx_->chunkinfodetail_->chunkSn.push_back(
             chunkinforesponse_->chunksn(i));
     }
+    if (chunkinforesponse_->has_changedbitmap()) {
+        reqCtx_->chunkinfodetail_->changedTracked = true;
+        reqCtx_->chunkinfodetail_->changedBaseSn =
+            chunkinforesponse_->changedbasesn();
+        reqCtx_->chunkinfodetail_->changedBlockSize =
+            chunkinforesponse_->changedblocksize();
+        reqCtx_->chunkinfodetail_->changedBitmap =
+            chunkinforesponse_->changedbitmap();
+    }
 }
 
 void GetChunkInfoClosure::OnRedirected() {
@@ -598,6 +626,17 @@ void CreateCloneChunkClosure::SendRetryRequest() {
                               done_);
 }
 
+void RecoverChunkClosure::OnSuccess() {
+    ClientClosure::OnSuccess();
+
+    if (reqCtx_->hotChunks_ == nullptr) {
+        return;
+    }
+    for (int i = 0; i < response_->hotclonechunks_size(); ++i) {
+        reqCtx_->hotChunks_->push_back(response_->hotclonechunks(i));
+    }
+}
+
 void RecoverChunkClosure::SendRetryRequest() {
     client_->RecoverChunk(reqCtx_->idinfo_,
                           reqCtx_->offset_,
@@ -605,6 +644,40 @@ void RecoverChunkClosure::SendRetryRequest() {
                           done_);
 }
 
+void CreateCloneChunksClosure::OnSuccess() {
+    ClientClosure::OnSuccess();
+
+    if (reqCtx_->existChunks_ == nullptr) {
+        return;
+    }
+    for (int i = 0; i < response_->existchunks_size(); ++i) {
+        reqCtx_->existChunks_->push_back(response_->existchunks(i));
+    }
+}
+
+void CreateCloneChunksClosure::SendRetryRequest() {
+    client_->CreateCloneChunks(reqCtx_->idinfo_,
+                               reqCtx_->cloneChunks_,
+                               done_);
+}
+
+void RecoverChunksClosure::OnSuccess() {
+    ClientClosure::OnSuccess();
+
+    if (reqCtx_->hotChunks_ == nullptr) {
+        return;
+    }
+    for (int i = 0; i < response_->hotclonechunks_size(); ++i) {
+        reqCtx_->hotChunks_->push_back(response_->hotclonechunks(i));
+    }
+}
+
+void RecoverChunksClosure::SendRetryRequest() {
+    client_->RecoverChunks(reqCtx_->idinfo_,
+                           reqCtx_->cloneChunks_,
+                           done_);
+}
+
 int ClientClosure::UpdateLeaderWithRedirectInfo(const std::string& leaderInfo) {
     ChunkServerID leaderId = 0;
     PeerAddr leaderAddr;
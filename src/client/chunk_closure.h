@@ -116,6 +116,9 @@ class ClientClosure : public Closure {
     // 非法参数
     void OnInvalidRequest();
 
+    // chunkserver没有对应的rpc接口
+    void OnMethodNotFound();
+
     // 发送重试请求
     virtual void SendRetryRequest() = 0;
 
@@ -305,6 +308,25 @@ class RecoverChunkClosure : public ClientClosure {
     RecoverChunkClosure(CopysetClient* client, Closure* done)
         : ClientClosure(client, done) {}
 
+    void OnSuccess() override;
+    void SendRetryRequest() override;
+};
+
+class CreateCloneChunksClosure : public ClientClosure {
+ public:
+    CreateCloneChunksClosure(CopysetClient* client, Closure* done)
+        : ClientClosure(client, done) {}
+
+    void OnSuccess() override;
+    void SendRetryRequest() override;
+};
+
+class RecoverChunksClosure : public ClientClosure {
+ public:
+    RecoverChunksClosure(CopysetClient* client, Closure* done)
+        : ClientClosure(client, done) {}
+
+    void OnSuccess() override;
     void SendRetryRequest() override;
 };
 
@@ -63,6 +63,8 @@ enum class OpType {
     RECOVER_CHUNK,
     GET_CHUNK_INFO,
     DISCARD,
+    CREATE_CLONE_BATCH,
+    RECOVER_CHUNK_BATCH,
     UNKNOWN
 };
 
@@ -98,6 +100,12 @@ typedef struct ChunkIDInfo {
 // 保存每个chunk对应的版本信息
 typedef struct ChunkInfoDetail {
     std::vector<uint64_t> chunkSn;
+    // chunk是否跟踪了变化块，为true时changedBitmap中标记了
+    // 版本号大于changedBaseSn的写入所修改的块
+    bool changedTracked = false;
+    uint64_t changedBaseSn = 0;
+    uint32_t changedBlockSize = 0;
+    std::string changedBitmap;
 } ChunkInfoDetail_t;
 
 typedef struct LeaseSession {
@@ -256,12 +264,35 @@ inline const char *OpTypeToString(OpType optype) {
         return "GetChunkInfo";
     case OpType::DISCARD:
         return "Discard";
+    case OpType::CREATE_CLONE_BATCH:
+        return "CreateCloneChunks";
+    case OpType::RECOVER_CHUNK_BATCH:
+        return "RecoverChunks";
     case OpType::UNKNOWN:
     default:
         return "Unknown";
     }
 }
 
+// 批量创建或恢复clone chunk的请求，老版本的chunkserver没有对应的rpc接口
+inline bool IsCloneChunkBatchOp(OpType optype) {
+    return optype == OpType::CREATE_CLONE_BATCH ||
+           optype == OpType::RECOVER_CHUNK_BATCH;
+}
+
+// 批量创建或恢复同一copyset上的clone chunk时的单个chunk
+struct CloneChunkItem {
+    ChunkID chunkId = 0;
+    // CreateCloneChunks时chunk的location、版本号和大小
+    std::string location;
+    uint64_t sn = 0;
+    uint64_t correctedSn = 0;
+    // CreateCloneChunks时为chunk大小，RecoverChunks时为恢复的数据长度
+    uint64_t len = 0;
+    // RecoverChunks时恢复的数据在chunk内的偏移
+    uint64_t offset = 0;
+};
+
 struct ClusterContext {
     std::string clusterId;
 };
@@ -273,8 +304,16 @@ class SnapCloneClosure : public google::protobuf::Closure {
     void SetRetCode(int retCode) { ret = retCode; }
     int GetRetCode() { return ret; }
 
+    // RecoverChunk返回的同一copyset中最近被读穿透的chunk
+    std::vector<ChunkID>* GetHotChunks() { return &hotChunks; }
+
+    // CreateCloneChunks返回的已经存在的chunk
+    std::vector<ChunkID>* GetExistChunks() { return &existChunks; }
+
  private:
     int ret;
+    std::vector<ChunkID> hotChunks;
+    std::vector<ChunkID> existChunks;
 };
 
 class ClientDummyServerInfo {
@@ -309,6 +348,14 @@ class ClientDummyServerInfo {
 
 inline void TrivialDeleter(void*) {}
 
+inline size_t IOVectorLength(const CurveIOVector& iov) {
+    size_t length = 0;
+    for (int i = 0; i < iov.iovcnt; ++i) {
+        length += iov.iov[i].iov_len;
+    }
+    return length;
+}
+
 inline const char *FileStatusToName(FileStatus status) {
     switch (status) {
     case FileStatus::Created:
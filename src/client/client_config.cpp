@@ -40,6 +40,38 @@ namespace client {
 
 static constexpr int kDefaultDummyServerPort = 9000;
 
+// parse cpu list like "0-3,6", empty list is valid
+static bool ParseCPUList(const std::string& str, std::vector<uint32_t>* cpus) {
+    cpus->clear();
+    std::vector<std::string> items;
+    common::SplitString(str, ",", &items);
+    for (const auto& item : items) {
+        std::vector<std::string> range;
+        common::SplitString(item, "-", &range);
+        uint32_t first = 0;
+        uint32_t last = 0;
+        if (range.size() == 1) {
+            if (!common::StringToUl(range[0], &first)) {
+                return false;
+            }
+            last = first;
+        } else if (range.size() == 2) {
+            if (!common::StringToUl(range[0], &first) ||
+                !common::StringToUl(range[1], &last) || first > last) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+
+        for (uint32_t cpu = first; cpu <= last; ++cpu) {
+            cpus->push_back(cpu);
+        }
+    }
+
+    return true;
+}
+
 int ClientConfig::Init(const std::string& configpath) {
     conf_.SetConfigPath(configpath);
 
@@ -67,6 +99,12 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no global.fileIOSplitMaxSizeKB info";           // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value("global.segmentPrefetchNum",
+          &fileServiceOption_.ioOpt.ioSplitOpt.segmentPrefetchNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no global.segmentPrefetchNum info, using default value "
+        << fileServiceOption_.ioOpt.ioSplitOpt.segmentPrefetchNum;
+
     ret = conf_.GetBoolValue("chunkserver.enableAppliedIndexRead",
           &fileServiceOption_.ioOpt.ioSenderOpt.chunkserverEnableAppliedIndexRead);        // NOLINT
     LOG_IF(ERROR, ret == false) << "config no chunkserver.enableAppliedIndexRead info";     // NOLINT
@@ -156,11 +194,64 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no schedule.threadpoolSize info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value("schedule.queueNum",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleQueueNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.queueNum info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleQueueNum;
+
+    ret = conf_.GetBoolValue("schedule.dispatchByCPU",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.dispatchByCPU);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.dispatchByCPU info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.dispatchByCPU;
+
+    std::string cpuAffinity;
+    ret = conf_.GetStringValue("schedule.cpuAffinity", &cpuAffinity);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.cpuAffinity info, schedule threads are not "
+           "bound to cpu";
+    if (ret && !ParseCPUList(cpuAffinity,
+                    &fileServiceOption_.ioOpt.reqSchdulerOpt.cpuAffinity)) {
+        LOG(ERROR) << "schedule.cpuAffinity is invalid: " << cpuAffinity;
+        return -1;
+    }
+
+    ret = conf_.GetBoolValue("schedule.merge.enable",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.mergeOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.merge.enable info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.mergeOpt.enable;
+
+    ret = conf_.GetUInt32Value("schedule.merge.maxMergeBytes",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.mergeOpt.maxMergeBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.merge.maxMergeBytes info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.mergeOpt.maxMergeBytes;
+
+    ret = conf_.GetUInt32Value("schedule.merge.maxMergeRequests",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.mergeOpt.maxMergeRequests);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.merge.maxMergeRequests info, using default value "  // NOLINT
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.mergeOpt.maxMergeRequests;
+
     ret = conf_.GetUInt32Value("mds.refreshTimesPerLease",
         &fileServiceOption_.leaseOpt.mdsRefreshTimesPerLease);
     LOG_IF(ERROR, ret == false) << "config no mds.refreshTimesPerLease info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetBoolValue("mds.enableBatchRefreshSession",
+        &fileServiceOption_.leaseOpt.enableBatchRefresh);
+    LOG_IF(WARNING, ret == false)
+        << "config no mds.enableBatchRefreshSession info, using default value "
+        << fileServiceOption_.leaseOpt.enableBatchRefresh;
+
+    ret = conf_.GetUInt32Value("mds.maxBatchRefreshSessionNum",
+        &fileServiceOption_.leaseOpt.maxBatchRefreshNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no mds.maxBatchRefreshSessionNum info, using default value "
+        << fileServiceOption_.leaseOpt.maxBatchRefreshNum;
+
     fileServiceOption_.ioOpt.reqSchdulerOpt.ioSenderOpt =
         fileServiceOption_.ioOpt.ioSenderOpt;
 
@@ -252,6 +343,34 @@ int ClientConfig::Init(const std::string& configpath) {
         << "config no closefd.timeInterval info, using default value "
         << fileServiceOption_.ioOpt.closeFdThreadOption.fdCloseTimeInterval;
 
+    ret = conf_.GetBoolValue(
+        "sourcecache.enable",
+        &fileServiceOption_.ioOpt.sourceCacheOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no sourcecache.enable info, using default value "
+        << fileServiceOption_.ioOpt.sourceCacheOpt.enable;
+
+    ret = conf_.GetUInt32Value(
+        "sourcecache.blockSize",
+        &fileServiceOption_.ioOpt.sourceCacheOpt.blockSize);
+    LOG_IF(WARNING, ret == false)
+        << "config no sourcecache.blockSize info, using default value "
+        << fileServiceOption_.ioOpt.sourceCacheOpt.blockSize;
+
+    ret = conf_.GetUInt32Value(
+        "sourcecache.capacityMB",
+        &fileServiceOption_.ioOpt.sourceCacheOpt.capacityMB);
+    LOG_IF(WARNING, ret == false)
+        << "config no sourcecache.capacityMB info, using default value "
+        << fileServiceOption_.ioOpt.sourceCacheOpt.capacityMB;
+
+    ret = conf_.GetUInt32Value(
+        "sourcecache.prefetchBlocks",
+        &fileServiceOption_.ioOpt.sourceCacheOpt.prefetchBlocks);
+    LOG_IF(WARNING, ret == false)
+        << "config no sourcecache.prefetchBlocks info, using default value "
+        << fileServiceOption_.ioOpt.sourceCacheOpt.prefetchBlocks;
+
     ret = conf_.GetBoolValue(
         "throttle.enable",
         &fileServiceOption_.ioOpt.throttleOption.enable);
@@ -25,6 +25,9 @@
 
 #include <bvar/bvar.h>
 
+#include <memory>
+#include <mutex>
+
 #include <string>
 #include <vector>
 
@@ -136,6 +139,13 @@ struct FileMetric {
 
     DiscardMetric discardMetric;
 
+    // scheduler合并相邻请求时，被合并掉的子请求qps
+    PerSecondMetric mergedRequestQPS;
+
+    // 条带化文件每个条带位置上的rpc延迟，在第一次条带化io时初始化
+    std::once_flag stripeMetricFlag;
+    std::vector<std::unique_ptr<bvar::LatencyRecorder>> stripeRPCLatency;
+
     explicit FileMetric(const std::string& name)
         : filename(name),
           inflightRPCNum(prefix, filename + "_inflight_rpc_num"),
@@ -149,7 +159,8 @@ struct FileMetric {
           userDiscard(prefix, filename + "_discard"),
           getLeaderRetryQPS(prefix, filename + "_get_leader_retry_rpc"),
           suspendRPCMetric(prefix, filename + "_suspend_io_num"),
-          discardMetric(prefix + filename) {}
+          discardMetric(prefix + filename),
+          mergedRequestQPS(prefix, filename + "_merged_request") {}
 };
 
 // 用于全局mds接口统计信息调用信息统计
@@ -170,6 +181,8 @@ struct MDSClientMetric {
     InterfaceMetric getFile;
     // RefreshSession接口统计信息
     InterfaceMetric refreshSession;
+    // RefreshSessions接口统计信息
+    InterfaceMetric refreshSessions;
     // GetServerList接口统计信息
     InterfaceMetric getServerList;
     // GetOrAllocateSegment接口统计信息
@@ -211,6 +224,7 @@ struct MDSClientMetric {
           closeFile(prefix, "closeFile"),
           getFile(prefix, "getFileInfo"),
           refreshSession(prefix, "refreshSession"),
+          refreshSessions(prefix, "refreshSessions"),
           getServerList(prefix, "getServerList"),
           getOrAllocateSegment(prefix, "getOrAllocateSegment"),
           deAllocateSegment(prefix, "deAllocateSegment"),
@@ -493,6 +507,34 @@ class MetricHelper {
         }
     }
 
+    static void InitStripeMetric(FileMetric* fm, uint64_t stripeCount) {
+        if (fm == nullptr) {
+            return;
+        }
+
+        std::call_once(fm->stripeMetricFlag, [fm, stripeCount]() {
+            for (uint64_t i = 0; i < stripeCount; ++i) {
+                fm->stripeRPCLatency.emplace_back(new bvar::LatencyRecorder(
+                    fm->prefix, fm->filename + "_stripe_" + std::to_string(i) +
+                                    "_rpc_latency"));
+            }
+        });
+    }
+
+    static void StripeLatencyRecord(FileMetric* fm, int32_t stripePos,
+                                    uint64_t duration) {
+        if (fm != nullptr && stripePos >= 0 &&
+            static_cast<size_t>(stripePos) < fm->stripeRPCLatency.size()) {
+            *fm->stripeRPCLatency[stripePos] << duration;
+        }
+    }
+
+    static void IncremMergedRequestCount(FileMetric* fm, uint64_t count) {
+        if (fm != nullptr) {
+            fm->mergedRequestQPS.count << count;
+        }
+    }
+
     static void DecremIOSuspendNum(FileMetric* fm) {
         if (fm != nullptr) {
             fm->suspendRPCMetric.count.get_value() > 0
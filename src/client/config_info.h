@@ -87,6 +87,10 @@ struct MetaServerOption {
  */
 struct LeaseOption {
     uint32_t mdsRefreshTimesPerLease = 5;
+    // 同一进程打开的多个文件是否通过一个rpc批量续约
+    bool enableBatchRefresh = false;
+    // 批量续约时一个rpc最多续约的文件个数
+    uint32_t maxBatchRefreshNum = 256;
 };
 
 /**
@@ -166,16 +170,38 @@ struct IOSenderOption {
     FailureRequestOption failRequestOpt;
 };
 
+/**
+ * scheduler合并相邻请求的配置
+ * @enable: 是否开启请求合并
+ * @maxMergeBytes: 合并之后单个请求的最大字节数
+ * @maxMergeRequests: 单个合并请求最多包含的子请求数量
+ */
+struct RequestMergeOption {
+    bool enable = false;
+    uint32_t maxMergeBytes = 128 * 1024;
+    uint32_t maxMergeRequests = 32;
+};
+
 /**
  * scheduler模块基本配置信息，schedule模块是用于分发用户请求，每个文件有自己的schedule
  * 线程池，线程池中的线程各自配置一个队列
  * @scheduleQueueCapacity: schedule模块配置的队列深度
- * @scheduleThreadpoolSize: schedule模块线程池大小
+ * @scheduleThreadpoolSize: schedule模块每个队列的线程池大小
+ * @scheduleQueueNum: schedule模块的队列数量，request按照chunk index分发到
+ *                    各个队列，条带化文件的各个条带因此可以被并行下发
+ * @dispatchByCPU: 读写request按照提交线程当前所在的cpu分发到各个队列，
+ *                 不同cpu上的提交线程不再竞争同一个队列的锁
+ * @cpuAffinity: 第i个队列的处理线程绑定到cpuAffinity[i % size]上，为空时不绑定
+ * @mergeOpt: 同一chunk上相邻读写请求的合并配置
  */
 struct RequestScheduleOption {
     uint32_t scheduleQueueCapacity = 1024;
     uint32_t scheduleThreadpoolSize = 2;
+    uint32_t scheduleQueueNum = 1;
+    bool dispatchByCPU = false;
+    std::vector<uint32_t> cpuAffinity;
     IOSenderOption ioSenderOpt;
+    RequestMergeOption mergeOpt;
 };
 
 /**
@@ -215,9 +241,12 @@ struct MetaCacheOption {
  * @fileIOSplitMaxSizeKB:
  * 用户下发IO大小client没有限制，但是client会将用户的IO进行拆分，
  *                        发向同一个chunkserver的请求锁携带的数据大小不能超过该值。
+ * @segmentPrefetchNum: 顺序写分配segment时，同一个rpc中额外预分配的后续segment个数，
+ *                      为0时不预分配
  */
 struct IOSplitOption {
     uint64_t fileIOSplitMaxSizeKB = 64;
+    uint32_t segmentPrefetchNum = 0;
 };
 
 /**
@@ -248,6 +277,20 @@ struct CloseFdThreadOption {
     uint32_t fdCloseTimeInterval = 600;
 };
 
+/**
+ * shared cache of clone source data in SourceReader
+ * @enable: whether to cache data read from clone source
+ * @blockSize: cache and read unit of source data, must be power of two
+ * @capacityMB: max size of cached source data
+ * @prefetchBlocks: number of blocks to read ahead after each source read
+ */
+struct SourceCacheOption {
+    bool enable = false;
+    uint32_t blockSize = 1024 * 1024;
+    uint32_t capacityMB = 1024;
+    uint32_t prefetchBlocks = 0;
+};
+
 struct ThrottleOption {
     bool enable = false;
 };
@@ -262,6 +305,7 @@ struct IOOption {
     TaskThreadOption taskThreadOpt;
     RequestScheduleOption reqSchdulerOpt;
     CloseFdThreadOption closeFdThreadOption;
+    SourceCacheOption sourceCacheOpt;
     ThrottleOption throttleOption;
     DiscardOption discardOption;
 };
@@ -243,6 +243,30 @@ int CopysetClient::RecoverChunk(const ChunkIDInfo& idinfo,
     return DoRPCTask(idinfo, task, done);
 }
 
+int CopysetClient::CreateCloneChunks(const ChunkIDInfo& idinfo,
+                                     const std::vector<CloneChunkItem>& chunks,
+                                     Closure* done) {
+    auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
+        CreateCloneChunksClosure* createClonesDone =
+            new CreateCloneChunksClosure(this, done);
+        senderPtr->CreateCloneChunks(idinfo, createClonesDone, chunks);
+    };
+
+    return DoRPCTask(idinfo, task, done);
+}
+
+int CopysetClient::RecoverChunks(const ChunkIDInfo& idinfo,
+                                 const std::vector<CloneChunkItem>& chunks,
+                                 Closure* done) {
+    auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
+        RecoverChunksClosure* recoverChunksDone =
+            new RecoverChunksClosure(this, done);
+        senderPtr->RecoverChunks(idinfo, recoverChunksDone, chunks);
+    };
+
+    return DoRPCTask(idinfo, task, done);
+}
+
 int CopysetClient::DoRPCTask(const ChunkIDInfo& idinfo,
     std::function<void(Closure* done,
     std::shared_ptr<RequestSender> senderptr)> task, Closure *done) {
@@ -27,6 +27,7 @@
 #include <butil/iobuf.h>
 
 #include <string>
+#include <vector>
 #include <memory>
 
 #include "include/curve_compiler_specific.h"
@@ -182,6 +183,28 @@ class CopysetClient {
                   uint64_t len,
                   Closure *done);
 
+    /**
+    * @brief 批量创建同一copyset上的clone chunk
+    * @param idinfo chunk所在的copyset，chunk id为第一个chunk的id
+    * @param:chunks 需要创建的chunk
+    * @param done:上一层异步回调的closure
+    * @return 错误码
+    */
+    int CreateCloneChunks(const ChunkIDInfo& idinfo,
+                  const std::vector<CloneChunkItem>& chunks,
+                  Closure *done);
+
+   /**
+    * @brief 批量恢复同一copyset上的chunk数据
+    * @param idinfo chunk所在的copyset，chunk id为第一个chunk的id
+    * @param:chunks 需要恢复的chunk及其偏移和长度
+    * @param done:上一层异步回调的closure
+    * @return 错误码
+    */
+    int RecoverChunks(const ChunkIDInfo& idinfo,
+                  const std::vector<CloneChunkItem>& chunks,
+                  Closure *done);
+
     /**
      * @brief 如果csId对应的RequestSender不健康，就进行重置
      * @param csId chunkserver id
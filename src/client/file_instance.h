@@ -124,6 +124,15 @@ class CURVE_CACHELINE_ALIGNMENT FileInstance {
         return leaseExecutor_.get();
     }
 
+    /**
+     * 由SessionRefresher批量续约，需要在Open之前设置
+     */
+    void SetSessionRefresher(SessionRefresher* refresher) {
+        if (leaseExecutor_ != nullptr) {
+            leaseExecutor_->SetSessionRefresher(refresher);
+        }
+    }
+
     int GetFileInfo(const std::string& filename,
         FInfo_t* fi, FileEpoch_t *fEpoch);
 
@@ -21,6 +21,8 @@
  */
 
 #include <glog/logging.h>
+#include <brpc/errno.pb.h>
+#include <sched.h>
 
 #include <algorithm>
 #include <memory>
@@ -65,6 +67,7 @@ IOTracker::IOTracker(IOManager* iomanager,
     reqlist_.clear();
     reqcount_.store(0, std::memory_order_release);
     opStartTimePoint_ = curve::common::TimeUtility::GetTimeofDayUs();
+    submitCPU_  = sched_getcpu();
 }
 
 void IOTracker::ReleaseAllSegmentLocks() {
@@ -130,6 +133,7 @@ void IOTracker::DoRead(MDSClient* mdsclient, const FInfo_t* fileInfo,
             r->done_->SetFileMetric(fileMetric_);
             r->done_->SetIOManager(iomanager_);
             r->subIoIndex_ = subIoIndex++;
+            r->submitCPU_ = submitCPU_;
         });
 
         reqcount_.store(reqlist_.size(), std::memory_order_release);
@@ -205,6 +209,19 @@ void IOTracker::DoWrite(MDSClient* mdsclient, const FInfo_t* fileInfo,
         case UserDataType::IOBuffer:
             writeData_ = *reinterpret_cast<const butil::IOBuf*>(data_);
             break;
+        case UserDataType::IOVector: {
+            // reference each segment, data is never linearized
+            const CurveIOVector* iov =
+                reinterpret_cast<const CurveIOVector*>(data_);
+            for (int i = 0; i < iov->iovcnt; ++i) {
+                if (iov->iov[i].iov_len > 0) {
+                    writeData_.append_user_data(iov->iov[i].iov_base,
+                                                iov->iov[i].iov_len,
+                                                TrivialDeleter);
+                }
+            }
+            break;
+        }
     }
 
     if (throttle) {
@@ -222,6 +239,7 @@ void IOTracker::DoWrite(MDSClient* mdsclient, const FInfo_t* fileInfo,
             r->done_->SetFileMetric(fileMetric_);
             r->done_->SetIOManager(iomanager_);
             r->subIoIndex_ = subIoIndex++;
+            r->submitCPU_ = submitCPU_;
         });
         ret = scheduler_->ScheduleRequest(reqlist_);
     } else {
@@ -417,6 +435,7 @@ void IOTracker::RecoverChunk(const ChunkIDInfo& cinfo, uint64_t offset,
 
         newreqNode->rawlength_   = len;
         newreqNode->offset_      = offset;
+        newreqNode->hotChunks_   = scc->GetHotChunks();
         FillCommonFields(cinfo, newreqNode);
 
         reqlist_.push_back(newreqNode);
@@ -432,6 +451,74 @@ void IOTracker::RecoverChunk(const ChunkIDInfo& cinfo, uint64_t offset,
     }
 }
 
+void IOTracker::CreateCloneChunks(LogicPoolID lpid, CopysetID cpid,
+                                  const std::vector<CloneChunkItem>& chunks,
+                                  SnapCloneClosure* scc) {
+    type_ = OpType::CREATE_CLONE_BATCH;
+    scc_ = scc;
+
+    int ret = -1;
+    do {
+        if (chunks.empty()) {
+            break;
+        }
+        RequestContext* newreqNode = RequestContext::NewInitedRequestContext();
+        if (newreqNode == nullptr) {
+            break;
+        }
+
+        newreqNode->cloneChunks_ = chunks;
+        newreqNode->existChunks_ = scc->GetExistChunks();
+        FillCommonFields(ChunkIDInfo(chunks[0].chunkId, lpid, cpid),
+                         newreqNode);
+
+        reqlist_.push_back(newreqNode);
+        reqcount_.store(reqlist_.size(), std::memory_order_release);
+
+        ret = scheduler_->ScheduleRequest(reqlist_);
+    } while (false);
+
+    if (ret == -1) {
+        LOG(ERROR) << "CreateCloneChunks request schedule failed,"
+                   << " return and recycle resource!";
+        ReturnOnFail();
+    }
+}
+
+void IOTracker::RecoverChunks(LogicPoolID lpid, CopysetID cpid,
+                              const std::vector<CloneChunkItem>& chunks,
+                              SnapCloneClosure* scc) {
+    type_ = OpType::RECOVER_CHUNK_BATCH;
+    scc_ = scc;
+
+    int ret = -1;
+    do {
+        if (chunks.empty()) {
+            break;
+        }
+        RequestContext* newreqNode = RequestContext::NewInitedRequestContext();
+        if (newreqNode == nullptr) {
+            break;
+        }
+
+        newreqNode->cloneChunks_ = chunks;
+        newreqNode->hotChunks_   = scc->GetHotChunks();
+        FillCommonFields(ChunkIDInfo(chunks[0].chunkId, lpid, cpid),
+                         newreqNode);
+
+        reqlist_.push_back(newreqNode);
+        reqcount_.store(reqlist_.size(), std::memory_order_release);
+
+        ret = scheduler_->ScheduleRequest(reqlist_);
+    } while (false);
+
+    if (ret == -1) {
+        LOG(ERROR) << "RecoverChunks request schedule failed,"
+                   << " return and recycle resource!";
+        ReturnOnFail();
+    }
+}
+
 void IOTracker::FillCommonFields(ChunkIDInfo idinfo, RequestContext* req) {
     req->optype_      = type_;
     req->idinfo_      = idinfo;
@@ -440,7 +527,10 @@ void IOTracker::FillCommonFields(ChunkIDInfo idinfo, RequestContext* req) {
 
 void IOTracker::HandleResponse(RequestContext* reqctx) {
     int errorcode = reqctx->done_->GetErrorCode();
-    if (errorcode != 0) {
+    if (errorcode == brpc::ENOMETHOD && IsCloneChunkBatchOp(type_)) {
+        // 老版本的chunkserver没有批量接口，由调用方改用单个chunk的接口
+        errcode_ = LIBCURVE_ERROR::NOT_SUPPORT;
+    } else if (errorcode != 0) {
         ChunkServerErr2LibcurveErr(static_cast<CHUNK_OP_STATUS>(errorcode),
                                    &errcode_);
     }
@@ -497,6 +587,19 @@ void IOTracker::Done() {
                     }
                     break;
                 }
+                case UserDataType::IOVector: {
+                    const CurveIOVector* iov =
+                        reinterpret_cast<const CurveIOVector*>(data_);
+                    size_t nc = 0;
+                    for (int i = 0; i < iov->iovcnt; ++i) {
+                        nc += readData.copy_to(iov->iov[i].iov_base,
+                                               iov->iov[i].iov_len, nc);
+                    }
+                    if (nc != length_) {
+                        errcode_ = LIBCURVE_ERROR::FAILED;
+                    }
+                    break;
+                }
             }
 
             if (errcode_ != LIBCURVE_ERROR::OK) {
@@ -525,6 +628,9 @@ void IOTracker::Done() {
                 LIBCURVE_ERROR::EXISTS == errcode_) {
                 // if CreateCloneChunk return Exists
                 // no error should be reported
+            } else if (LIBCURVE_ERROR::NOT_SUPPORT == errcode_) {
+                LOG(WARNING) << OpTypeToString(type_)
+                             << " is not supported by chunkserver";
             } else {
                 LOG(ERROR) << "IO Error, OpType = " << OpTypeToString(type_);
             }
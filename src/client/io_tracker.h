@@ -173,6 +173,29 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     void RecoverChunk(const ChunkIDInfo& chunkIdInfo, uint64_t offset,
                       uint64_t len, SnapCloneClosure* scc);
 
+    /**
+     * @brief 批量创建同一copyset上的clone chunk，已存在的chunk通过
+     *        scc->GetExistChunks()返回
+     * @param:lpid 逻辑池id
+     * @param:cpid copyset id
+     * @param:chunks 需要创建的chunk
+     * @param: scc是异步回调
+     */
+    void CreateCloneChunks(LogicPoolID lpid, CopysetID cpid,
+                           const std::vector<CloneChunkItem>& chunks,
+                           SnapCloneClosure* scc);
+
+    /**
+     * @brief 批量恢复同一copyset上的chunk数据
+     * @param:lpid 逻辑池id
+     * @param:cpid copyset id
+     * @param:chunks 需要恢复的chunk及其偏移和长度
+     * @param: scc是异步回调
+     */
+    void RecoverChunks(LogicPoolID lpid, CopysetID cpid,
+                       const std::vector<CloneChunkItem>& chunks,
+                       SnapCloneClosure* scc);
+
     /**
      * Wait用于同步接口等待，因为用户下来的IO被client内部线程接管之后
      * 调用就可以向上返回了，但是用户的同步IO语意是要等到结果返回才能向上
@@ -210,6 +233,11 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
         userDataType_ = dataType;
     }
 
+    // cpu of the thread which submitted this io, -1 if unknown
+    int GetSubmitCPU() const {
+        return submitCPU_;
+    }
+
     /**
      * @brief prepare space to store read data
      * @param subIoCount #space to store read data
@@ -361,6 +389,11 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
 
     bool disableStripe_;
 
+    // cpu of the submitting thread, captured when the tracker is created in
+    // the caller's thread, because aio is split and scheduled later on the
+    // iomanager's task thread
+    int submitCPU_;
+
     // read/write operations will hold segment's read lock,
     // so store corresponding segment lock and release after operations finished
     std::vector<FileSegment*> segmentLocks_;
@@ -98,6 +98,20 @@ int IOManager4Chunk::RecoverChunk(const ChunkIDInfo& chunkIdInfo,
     return 0;
 }
 
+int IOManager4Chunk::CreateCloneChunks(LogicPoolID lpid, CopysetID cpid,
+    const std::vector<CloneChunkItem>& chunks, SnapCloneClosure* scc) {
+    IOTracker* ioTracker = new IOTracker(this, &mc_, scheduler_);
+    ioTracker->CreateCloneChunks(lpid, cpid, chunks, scc);
+    return 0;
+}
+
+int IOManager4Chunk::RecoverChunks(LogicPoolID lpid, CopysetID cpid,
+    const std::vector<CloneChunkItem>& chunks, SnapCloneClosure* scc) {
+    IOTracker* ioTracker = new IOTracker(this, &mc_, scheduler_);
+    ioTracker->RecoverChunks(lpid, cpid, chunks, scc);
+    return 0;
+}
+
 void IOManager4Chunk::HandleAsyncIOResponse(IOTracker* iotracker) {
     delete iotracker;
 }
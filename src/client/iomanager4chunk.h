@@ -26,6 +26,7 @@
 #include <atomic>
 #include <mutex>    // NOLINT
 #include <string>
+#include <vector>
 #include <condition_variable>   // NOLINT
 
 #include "src/client/metacache.h"
@@ -108,6 +109,30 @@ class IOManager4Chunk : public IOManager {
     int RecoverChunk(const ChunkIDInfo& chunkIdInfo, uint64_t offset,
                      uint64_t len, SnapCloneClosure* scc);
 
+    /**
+     * @brief 批量创建同一copyset上的clone chunk
+     * @param lpid 逻辑池id
+     * @param cpid copyset id
+     * @param chunks 需要创建的chunk
+     * @param scc 异步回调，已存在的chunk通过scc->GetExistChunks()返回
+     * @return 成功返回0， 否则-1
+     */
+    int CreateCloneChunks(LogicPoolID lpid, CopysetID cpid,
+                          const std::vector<CloneChunkItem>& chunks,
+                          SnapCloneClosure* scc);
+
+    /**
+     * @brief 批量恢复同一copyset上的chunk数据
+     * @param lpid 逻辑池id
+     * @param cpid copyset id
+     * @param chunks 需要恢复的chunk及其偏移和长度
+     * @param scc 异步回调
+     * @return 成功返回0， 否则-1
+     */
+    int RecoverChunks(LogicPoolID lpid, CopysetID cpid,
+                      const std::vector<CloneChunkItem>& chunks,
+                      SnapCloneClosure* scc);
+
     /**
      * 因为curve client底层都是异步IO，每个IO会分配一个IOtracker跟踪IO
      * 当这个IO做完之后，底层需要告知当前io manager来释放这个IOTracker，
@@ -24,6 +24,7 @@
 #include "src/common/timeutility.h"
 #include "src/client/lease_executor.h"
 #include "src/client/service_helper.h"
+#include "src/client/session_refresher.h"
 
 using curve::common::TimeUtility;
 
@@ -40,13 +41,18 @@ LeaseExecutor::LeaseExecutor(const LeaseOption& leaseOpt,
       leasesession_(),
       isleaseAvaliable_(true),
       failedrefreshcount_(0),
-      task_() {}
+      task_(),
+      refresher_(nullptr) {}
 
 LeaseExecutor::~LeaseExecutor() {
     if (task_) {
         task_->Stop();
         task_->WaitTaskExit();
     }
+
+    if (refresher_ != nullptr) {
+        refresher_->Unregister(this);
+    }
 }
 
 bool LeaseExecutor::Start(const FInfo_t& fi, const LeaseSession_t& lease) {
@@ -69,6 +75,14 @@ bool LeaseExecutor::Start(const FInfo_t& fi, const LeaseSession_t& lease) {
     auto interval =
         leasesession_.leaseTime / leaseoption_.mdsRefreshTimesPerLease;
 
+    if (refresher_ != nullptr) {
+        refresher_->Register(this, interval);
+        LOG(INFO) << "LeaseExecutor for " << fullFileName_
+                  << " registered to session refresher, lease interval is "
+                  << interval << " us";
+        return true;
+    }
+
     task_.reset(new (std::nothrow) RefreshSessionTask(this, interval));
     if (task_ == nullptr) {
         LOG(ERROR) << "Allocate RefreshSessionTask failed, filename = "
@@ -86,15 +100,32 @@ bool LeaseExecutor::Start(const FInfo_t& fi, const LeaseSession_t& lease) {
 }
 
 bool LeaseExecutor::RefreshLease() {
-    if (!LeaseValid()) {
-        LOG(INFO) << "lease not valid!";
-        iomanager_->LeaseTimeoutBlockIO();
-    }
+    BlockIOIfLeaseInvalid();
 
     LeaseRefreshResult response;
     LIBCURVE_ERROR ret = mdsclient_->RefreshSession(
         fullFileName_, userinfo_, leasesession_.sessionID, &response);
 
+    return HandleRefreshResult(ret, response);
+}
+
+RefreshSessionInfo LeaseExecutor::GetRefreshSessionInfo() const {
+    RefreshSessionInfo info;
+    info.filename = fullFileName_;
+    info.userinfo = userinfo_;
+    info.sessionid = leasesession_.sessionID;
+    return info;
+}
+
+void LeaseExecutor::BlockIOIfLeaseInvalid() {
+    if (!LeaseValid()) {
+        LOG(INFO) << "lease not valid!";
+        iomanager_->LeaseTimeoutBlockIO();
+    }
+}
+
+bool LeaseExecutor::HandleRefreshResult(LIBCURVE_ERROR ret,
+                                        const LeaseRefreshResult& response) {
     if (LIBCURVE_ERROR::FAILED == ret) {
         LOG(WARNING) << "Refresh session rpc failed, filename = "
                      << fullFileName_;
@@ -143,6 +174,13 @@ void LeaseExecutor::Stop() {
 
         LOG(INFO) << "LeaseExecutor for " << fullFileName_ << " stopped";
     }
+
+    if (refresher_ != nullptr) {
+        refresher_->Unregister(this);
+
+        LOG(INFO) << "LeaseExecutor for " << fullFileName_
+                  << " unregistered from session refresher";
+    }
 }
 
 bool LeaseExecutor::LeaseValid() {
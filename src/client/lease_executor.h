@@ -39,6 +39,7 @@ namespace curve {
 namespace client {
 
 class RefreshSessionTask;
+class SessionRefresher;
 
 /**
  * lease refresh结果，session如果不存在就不需要再续约
@@ -120,6 +121,33 @@ class LeaseExecutor : public LeaseExecutorBase {
      */
     void ResetRefreshSessionTask();
 
+    /**
+     * @brief 设置批量续约执行者，需要在Start之前设置，
+     *        设置后不再启动单独的续约任务，由SessionRefresher统一续约
+     */
+    void SetSessionRefresher(SessionRefresher* refresher) {
+        refresher_ = refresher;
+    }
+
+    /**
+     * @brief 获取续约需要的文件信息，批量续约使用
+     */
+    RefreshSessionInfo GetRefreshSessionInfo() const;
+
+    /**
+     * @brief 续约之前，如果lease已经失效则阻塞IO
+     */
+    void BlockIOIfLeaseInvalid();
+
+    /**
+     * @brief 处理续约结果
+     * @param ret 续约rpc的返回值
+     * @param response 续约结果
+     * @return 是否继续续约
+     */
+    bool HandleRefreshResult(LIBCURVE_ERROR ret,
+                             const LeaseRefreshResult& response);
+
  private:
     /**
      *  一个lease期间会续约rfreshTimesPerLease次，每次续约失败就递增
@@ -161,6 +189,9 @@ class LeaseExecutor : public LeaseExecutorBase {
 
     // refresh session定时任务，会间隔固定时间执行一次
     std::unique_ptr<RefreshSessionTask> task_;
+
+    // 批量续约执行者，不为空时由其负责续约
+    SessionRefresher*       refresher_;
 };
 
 // RefreshSessin定期任务
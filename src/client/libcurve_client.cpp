@@ -108,6 +108,16 @@ int CurveClient::AioWrite(int fd, CurveAioContext* aioctx,
     return fileClient_->AioWrite(fd, aioctx, dataType);
 }
 
+int CurveClient::AioReadv(int fd, CurveAioContext* aioctx,
+                          CurveIOVector* iov) {
+    return fileClient_->AioReadv(fd, aioctx, iov);
+}
+
+int CurveClient::AioWritev(int fd, CurveAioContext* aioctx,
+                           CurveIOVector* iov) {
+    return fileClient_->AioWritev(fd, aioctx, iov);
+}
+
 int CurveClient::AioDiscard(int fd, CurveAioContext* aioctx) {
     return fileClient_->AioDiscard(fd, aioctx);
 }
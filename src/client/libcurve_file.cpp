@@ -176,6 +176,12 @@ int FileClient::Init(const std::string& configpath) {
 
     mdsClient_ = std::move(tmpMdsClient);
 
+    const LeaseOption& leaseOpt = clientconfig_.GetFileServiceOption().leaseOpt;
+    if (leaseOpt.enableBatchRefresh) {
+        sessionRefresher_.reset(new SessionRefresher(
+            mdsClient_.get(), leaseOpt.maxBatchRefreshNum));
+    }
+
     int rc2 = csClient_->Init(clientconfig_.GetFileServiceOption().csClientOpt);
     if (rc2 != 0) {
         LOG(ERROR) << "Init ChunkServer Client failed!";
@@ -205,6 +211,7 @@ void FileClient::UnInit() {
     fileserviceMap_.clear();
     fileserviceFileNameMap_.clear();
 
+    sessionRefresher_.reset();
     mdsClient_.reset();
     inited_ = false;
 }
@@ -238,6 +245,11 @@ int FileClient::Open(const std::string &filename, const UserInfo_t &userinfo,
         return -1;
     }
 
+    // files opened with their own config may connect to other mds
+    if (sessionRefresher_ != nullptr && openflags.confPath.empty()) {
+        fileserv->SetSessionRefresher(sessionRefresher_.get());
+    }
+
     int ret = fileserv->Open();
     if (ret != LIBCURVE_ERROR::OK) {
         LOG(ERROR) << "Open file failed, filename: " << filename
@@ -435,6 +447,32 @@ int FileClient::AioWrite(int fd, CurveAioContext *aioctx,
     return ret;
 }
 
+int FileClient::AioReadv(int fd, CurveAioContext *aioctx,
+                         CurveIOVector *iov) {
+    if (iov == nullptr || iov->iovcnt < 0 ||
+        (iov->iovcnt > 0 && iov->iov == nullptr)) {
+        LOG(ERROR) << "invalid io vector!";
+        return -LIBCURVE_ERROR::PARAM_ERROR;
+    }
+
+    aioctx->buf = iov;
+    aioctx->length = IOVectorLength(*iov);
+    return AioRead(fd, aioctx, UserDataType::IOVector);
+}
+
+int FileClient::AioWritev(int fd, CurveAioContext *aioctx,
+                          CurveIOVector *iov) {
+    if (iov == nullptr || iov->iovcnt < 0 ||
+        (iov->iovcnt > 0 && iov->iov == nullptr)) {
+        LOG(ERROR) << "invalid io vector!";
+        return -LIBCURVE_ERROR::PARAM_ERROR;
+    }
+
+    aioctx->buf = iov;
+    aioctx->length = IOVectorLength(*iov);
+    return AioWrite(fd, aioctx, UserDataType::IOVector);
+}
+
 int FileClient::AioDiscard(int fd, CurveAioContext *aioctx) {
     ReadLockGuard lk(rwlock_);
     auto iter = fileserviceMap_.find(fd);
@@ -895,6 +933,24 @@ int AioWrite(int fd, CurveAioContext *aioctx) {
     return globalclient->AioWrite(fd, aioctx);
 }
 
+int AioReadv(int fd, CurveAioContext *aioctx, CurveIOVector *iov) {
+    if (globalclient == nullptr) {
+        LOG(ERROR) << "not inited!";
+        return -LIBCURVE_ERROR::FAILED;
+    }
+
+    return globalclient->AioReadv(fd, aioctx, iov);
+}
+
+int AioWritev(int fd, CurveAioContext *aioctx, CurveIOVector *iov) {
+    if (globalclient == nullptr) {
+        LOG(ERROR) << "not inited!";
+        return -LIBCURVE_ERROR::FAILED;
+    }
+
+    return globalclient->AioWritev(fd, aioctx, iov);
+}
+
 int AioDiscard(int fd, CurveAioContext *aioctx) {
     if (globalclient == nullptr) {
         LOG(ERROR) << "Not inited!";
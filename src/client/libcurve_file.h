@@ -33,6 +33,7 @@
 #include "include/client/libcurve.h"
 #include "src/client/client_common.h"
 #include "src/client/file_instance.h"
+#include "src/client/session_refresher.h"
 #include "src/common/concurrent/rw_lock.h"
 #include "src/client/chunkserver_broadcaster.h"
 
@@ -154,6 +155,24 @@ class FileClient {
     virtual int AioWrite(int fd, CurveAioContext* aioctx,
                          UserDataType dataType = UserDataType::RawBuffer);
 
+    /**
+     * @brief Asynchronous vectored read, data is read into iov directly
+     * @param fd file descriptor
+     * @param aioctx async request context, buf and length are set by iov
+     * @param iov scatter buffers, must be kept valid until callback
+     * @return 0 means success, otherwise it means failure
+     */
+    virtual int AioReadv(int fd, CurveAioContext* aioctx, CurveIOVector* iov);
+
+    /**
+     * @brief Asynchronous vectored write, iov is sent without being copied
+     * @param fd file descriptor
+     * @param aioctx async request context, buf and length are set by iov
+     * @param iov gather buffers, must be kept valid until callback
+     * @return 0 means success, otherwise it means failure
+     */
+    virtual int AioWritev(int fd, CurveAioContext* aioctx, CurveIOVector* iov);
+
     /**
      * @brief Asynchronous discard operation
      * @param fd file descriptor
@@ -324,6 +343,9 @@ class FileClient {
     // fileclient对应的全局mdsclient
     std::shared_ptr<MDSClient> mdsClient_;
 
+    // 通过全局mdsclient批量续约使用默认配置打开的文件
+    std::unique_ptr<SessionRefresher> sessionRefresher_;
+
     // chunkserver client
     std::shared_ptr<ChunkServerClient> csClient_;
     // chunkserver broadCaster
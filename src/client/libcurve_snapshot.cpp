@@ -250,6 +250,18 @@ int SnapshotClient::RecoverChunk(const ChunkIDInfo &chunkidinfo,
     return iomanager4chunk_.RecoverChunk(chunkidinfo, offset, len, scc);
 }
 
+int SnapshotClient::CreateCloneChunks(LogicPoolID lpid, CopysetID cpid,
+                                      const std::vector<CloneChunkItem> &chunks,
+                                      SnapCloneClosure *scc) {
+    return iomanager4chunk_.CreateCloneChunks(lpid, cpid, chunks, scc);
+}
+
+int SnapshotClient::RecoverChunks(LogicPoolID lpid, CopysetID cpid,
+                                  const std::vector<CloneChunkItem> &chunks,
+                                  SnapCloneClosure *scc) {
+    return iomanager4chunk_.RecoverChunks(lpid, cpid, chunks, scc);
+}
+
 int SnapshotClient::ReadChunkSnapshot(ChunkIDInfo cidinfo, uint64_t seq,
                                       uint64_t offset, uint64_t len, char *buf,
                                       SnapCloneClosure *scc) {
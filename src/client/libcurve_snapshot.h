@@ -207,6 +207,36 @@ class SnapshotClient {
                    uint64_t offset, uint64_t len,
                    SnapCloneClosure* scc);
 
+  /**
+   * @brief 批量创建同一copyset上的clone chunk，一次rpc完成
+   *
+   * @param:lpid 逻辑池id
+   * @param:cpid copyset id
+   * @param:chunks 需要创建的chunk
+   * @param: scc是异步回调，已存在的chunk通过scc->GetExistChunks()返回，
+   *         chunkserver不支持时返回-LIBCURVE_ERROR::NOT_SUPPORT
+   *
+   * @return 错误码
+   */
+  int CreateCloneChunks(LogicPoolID lpid, CopysetID cpid,
+                        const std::vector<CloneChunkItem> &chunks,
+                        SnapCloneClosure* scc);
+
+  /**
+   * @brief 批量恢复同一copyset上的chunk数据，一次rpc完成
+   *
+   * @param:lpid 逻辑池id
+   * @param:cpid copyset id
+   * @param:chunks 需要恢复的chunk及其偏移和长度
+   * @param: scc是异步回调，chunkserver不支持时返回
+   *         -LIBCURVE_ERROR::NOT_SUPPORT
+   *
+   * @return 错误码
+   */
+  int RecoverChunks(LogicPoolID lpid, CopysetID cpid,
+                    const std::vector<CloneChunkItem> &chunks,
+                    SnapCloneClosure* scc);
+
   /**
    * @brief 通知mds完成Clone Meta
    *
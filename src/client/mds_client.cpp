@@ -45,6 +45,52 @@ using curve::mds::StatusCode;
 using curve::common::ChunkServerLocation;
 using curve::mds::topology::CopySetServerInfo;
 
+namespace {
+
+LIBCURVE_ERROR RefreshSessionResponse2Result(
+    const ReFreshSessionResponse &response, LeaseRefreshResult *resp,
+    LeaseSession *lease) {
+    switch (response.statuscode()) {
+    case StatusCode::kSessionNotExist:
+    case StatusCode::kFileNotExists:
+        resp->status = LeaseRefreshResult::Status::NOT_EXIST;
+        break;
+    case StatusCode::kOwnerAuthFail:
+        resp->status = LeaseRefreshResult::Status::FAILED;
+        return LIBCURVE_ERROR::AUTHFAIL;
+        break;
+    case StatusCode::kOK:
+        if (response.has_fileinfo()) {
+            FileEpoch_t fEpoch;
+            ServiceHelper::ProtoFileInfo2Local(response.fileinfo(),
+                                               &resp->finfo,
+                                               &fEpoch);
+            resp->status = LeaseRefreshResult::Status::OK;
+        } else {
+            LOG(WARNING) << "session response has no fileinfo!";
+            return LIBCURVE_ERROR::FAILED;
+        }
+        if (nullptr != lease) {
+            if (!response.has_protosession()) {
+                LOG(WARNING) << "session response has no protosession";
+                return LIBCURVE_ERROR::FAILED;
+            }
+            ProtoSession leasesession = response.protosession();
+            lease->sessionID = leasesession.sessionid();
+            lease->leaseTime = leasesession.leasetime();
+            lease->createTime = leasesession.createtime();
+        }
+        break;
+    default:
+        resp->status = LeaseRefreshResult::Status::FAILED;
+        return LIBCURVE_ERROR::FAILED;
+        break;
+    }
+    return LIBCURVE_ERROR::OK;
+}
+
+}  // namespace
+
 // rpc发送和mds地址切换状态机
 int RPCExcutorRetryPolicy::DoRPCTask(RPCFunc rpctask, uint64_t maxRetryTimeMS) {
     // 记录上一次正在服务的mds index
@@ -727,41 +773,62 @@ LIBCURVE_ERROR MDSClient::RefreshSession(const std::string &filename,
                 << ", status code = " << StatusCode_Name(stcode);
         }
 
-        switch (stcode) {
-        case StatusCode::kSessionNotExist:
-        case StatusCode::kFileNotExists:
-            resp->status = LeaseRefreshResult::Status::NOT_EXIST;
-            break;
-        case StatusCode::kOwnerAuthFail:
-            resp->status = LeaseRefreshResult::Status::FAILED;
-            return LIBCURVE_ERROR::AUTHFAIL;
-            break;
-        case StatusCode::kOK:
-            if (response.has_fileinfo()) {
-                FileEpoch_t fEpoch;
-                ServiceHelper::ProtoFileInfo2Local(response.fileinfo(),
-                                                   &resp->finfo,
-                                                   &fEpoch);
-                resp->status = LeaseRefreshResult::Status::OK;
-            } else {
-                LOG(WARNING) << "session response has no fileinfo!";
-                return LIBCURVE_ERROR::FAILED;
-            }
-            if (nullptr != lease) {
-                if (!response.has_protosession()) {
-                    LOG(WARNING) << "session response has no protosession";
-                    return LIBCURVE_ERROR::FAILED;
-                }
-                ProtoSession leasesession = response.protosession();
-                lease->sessionID = leasesession.sessionid();
-                lease->leaseTime = leasesession.leasetime();
-                lease->createTime = leasesession.createtime();
+        return RefreshSessionResponse2Result(response, resp, lease);
+    };
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
+LIBCURVE_ERROR MDSClient::RefreshSessions(
+    const std::vector<RefreshSessionInfo> &sessions,
+    std::vector<LeaseRefreshResult> *results,
+    std::vector<LIBCURVE_ERROR> *rets) {
+    auto task = RPCTaskDefine {
+        (void)addrindex;
+        (void)rpctimeoutMS;
+        RefreshSessionsResponse response;
+        mdsClientMetric_.refreshSessions.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.refreshSessions.latency);
+        MDSClientBase::RefreshSessions(sessions, &response, cntl, channel);
+        if (cntl->Failed()) {
+            // mds of old version doesn't provide this rpc, no need to retry
+            if (cntl->ErrorCode() == brpc::ENOMETHOD) {
+                LOG(WARNING) << "RefreshSessions not supported by mds, "
+                             << cntl->ErrorText();
+                return LIBCURVE_ERROR::NOT_SUPPORT;
             }
-            break;
-        default:
-            resp->status = LeaseRefreshResult::Status::FAILED;
+
+            mdsClientMetric_.refreshSessions.eps.count << 1;
+            LOG(WARNING) << "Fail to send RefreshSessionsRequest, "
+                         << cntl->ErrorText()
+                         << ", session num = " << sessions.size();
+            return -cntl->ErrorCode();
+        }
+
+        if (response.statuscode() != StatusCode::kOK ||
+            response.sessions_size() != static_cast<int>(sessions.size())) {
+            LOG(WARNING) << "RefreshSessions NOT OK, status code = "
+                         << StatusCode_Name(response.statuscode())
+                         << ", session num = " << sessions.size()
+                         << ", response session num = "
+                         << response.sessions_size();
             return LIBCURVE_ERROR::FAILED;
-            break;
+        }
+
+        results->assign(sessions.size(), LeaseRefreshResult());
+        rets->assign(sessions.size(), LIBCURVE_ERROR::OK);
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            const ReFreshSessionResponse &session = response.sessions(i);
+            if (session.statuscode() != StatusCode::kOK) {
+                LOG(WARNING) << "RefreshSession NOT OK: filename = "
+                             << sessions[i].filename
+                             << ", owner = " << sessions[i].userinfo.owner
+                             << ", sessionid = " << sessions[i].sessionid
+                             << ", status code = "
+                             << StatusCode_Name(session.statuscode());
+            }
+            (*rets)[i] = RefreshSessionResponse2Result(
+                session, &(*results)[i], nullptr);
         }
         return LIBCURVE_ERROR::OK;
     };
@@ -1026,10 +1093,43 @@ LIBCURVE_ERROR MDSClient::SetCloneFileStatus(const std::string &filename,
         rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
 }
 
+namespace {
+
+void PageFileSegment2SegmentInfo(const PageFileSegment& pfs,
+                                 SegmentInfo* segInfo) {
+    segInfo->chunksize = pfs.chunksize();
+    segInfo->segmentsize = pfs.segmentsize();
+    segInfo->startoffset = pfs.startoffset();
+    LogicPoolID logicpoolid = pfs.logicalpoolid();
+    segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
+
+    int chunksNum = pfs.chunks_size();
+    for (int i = 0; i < chunksNum; i++) {
+        ChunkID chunkid = pfs.chunks(i).chunkid();
+        CopysetID copysetid = pfs.chunks(i).copysetid();
+        segInfo->lpcpIDInfo.cpidVec.push_back(copysetid);
+        segInfo->chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+    }
+}
+
+}  // namespace
+
 LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
                                                const FInfo_t *fi,
                                                const FileEpoch_t *fEpoch,
                                                SegmentInfo *segInfo) {
+    std::vector<SegmentInfo> segInfos;
+    LIBCURVE_ERROR ret =
+        GetOrAllocateSegments(allocate, offset, 1, fi, fEpoch, &segInfos);
+    if (ret == LIBCURVE_ERROR::OK) {
+        *segInfo = std::move(segInfos[0]);
+    }
+    return ret;
+}
+
+LIBCURVE_ERROR MDSClient::GetOrAllocateSegments(
+    bool allocate, uint64_t offset, uint32_t segmentNum, const FInfo_t *fi,
+    const FileEpoch_t *fEpoch, std::vector<SegmentInfo> *segInfos) {
     auto task = RPCTaskDefine {
         (void)addrindex;
         (void)rpctimeoutMS;
@@ -1037,7 +1137,8 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
         mdsClientMetric_.getOrAllocateSegment.qps.count << 1;
         LatencyGuard lg(&mdsClientMetric_.getOrAllocateSegment.latency);
         MDSClientBase::GetOrAllocateSegment(allocate, offset, fi, fEpoch,
-                                            &response, cntl, channel);
+                                            segmentNum, &response, cntl,
+                                            channel);
         if (cntl->Failed()) {
             mdsClientMetric_.getOrAllocateSegment.eps.count << 1;
             LOG(WARNING) << "allocate segment failed, error code = "
@@ -1068,25 +1169,22 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
             break;
         }
 
-        PageFileSegment pfs = response.pagefilesegment();
-        segInfo->chunksize = pfs.chunksize();
-        segInfo->segmentsize = pfs.segmentsize();
-        segInfo->startoffset = pfs.startoffset();
-        LogicPoolID logicpoolid = pfs.logicalpoolid();
-        segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
-
-        int chunksNum = pfs.chunks_size();
-        if (allocate && chunksNum <= 0) {
+        if (allocate && response.pagefilesegment().chunks_size() <= 0) {
             LOG(WARNING) << "MDS allocate segment, but no chunkinfo!";
             // Now, we will retry until allocate segment success
             return -LIBCURVE_ERROR::RETRY_UNTIL_SUCCESS;
         }
 
-        for (int i = 0; i < chunksNum; i++) {
-            ChunkID chunkid = pfs.chunks(i).chunkid();
-            CopysetID copysetid = pfs.chunks(i).copysetid();
-            segInfo->lpcpIDInfo.cpidVec.push_back(copysetid);
-            segInfo->chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+        segInfos->clear();
+        segInfos->emplace_back();
+        PageFileSegment2SegmentInfo(response.pagefilesegment(),
+                                    &segInfos->back());
+        for (const auto& pfs : response.extrasegments()) {
+            if (pfs.chunks_size() <= 0) {
+                continue;
+            }
+            segInfos->emplace_back();
+            PageFileSegment2SegmentInfo(pfs, &segInfos->back());
         }
         return LIBCURVE_ERROR::OK;
     };
@@ -233,6 +233,23 @@ class MDSClient : public MDSClientBase,
                                         const FileEpoch_t *fEpoch,
                                         SegmentInfo *segInfo);
 
+    /**
+     * Get or Alloc segmentNum consecutive segments in one rpc
+     * @param: allocate  ture for allocate, false for get only
+     * @param: offset  first segment start offset
+     * @param: segmentNum  number of segments wanted
+     * @param: fi file info
+     * @param: fEpoch  file epoch info
+     * @param[out]: segInfos segments returned, the first one is the segment
+     *              at offset, the following ones are best effort
+     * @return: same as GetOrAllocateSegment
+     */
+    LIBCURVE_ERROR GetOrAllocateSegments(bool allocate, uint64_t offset,
+                                         uint32_t segmentNum,
+                                         const FInfo_t *fi,
+                                         const FileEpoch_t *fEpoch,
+                                         std::vector<SegmentInfo> *segInfos);
+
     /**
      * @brief Send DeAllocateSegment request to current working MDS
      * @param fileInfo current file info
@@ -382,6 +399,20 @@ class MDSClient : public MDSClientBase,
                                   const std::string &sessionid,
                                   LeaseRefreshResult *resp,
                                   LeaseSession *lease = nullptr);
+
+    /**
+     * 一次rpc续约多个文件，用于同一进程打开多个文件时减少续约rpc
+     * @param: sessions是要续约的文件信息
+     * @param[out]: results是每个文件的续约结果
+     * @param[out]: rets是每个文件的返回值，含义与RefreshSession的返回值相同
+     * @return: rpc成功返回LIBCURVE_ERROR::OK，
+     *          mds不支持批量续约返回LIBCURVE_ERROR::NOT_SUPPORT，
+     *          否则返回LIBCURVE_ERROR::FAILED
+     */
+    LIBCURVE_ERROR RefreshSessions(
+        const std::vector<RefreshSessionInfo> &sessions,
+        std::vector<LeaseRefreshResult> *results,
+        std::vector<LIBCURVE_ERROR> *rets);
     /**
      * 关闭文件，需要携带sessionid，这样mds端会在数据库删除该session信息
      * @param: filename是要续约的文件名
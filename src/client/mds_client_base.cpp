@@ -267,6 +267,29 @@ void MDSClientBase::RefreshSession(const std::string& filename,
     stub.RefreshSession(cntl, &request, response, nullptr);
 }
 
+void MDSClientBase::RefreshSessions(
+    const std::vector<RefreshSessionInfo>& sessions,
+    RefreshSessionsResponse* response,
+    brpc::Controller* cntl,
+    brpc::Channel* channel) {
+    RefreshSessionsRequest request;
+    request.set_clientversion(curve::common::CurveVersion());
+    FillClienIpPortIfRegistered(&request);
+    for (const auto& info : sessions) {
+        ReFreshSessionRequest* session = request.add_sessions();
+        session->set_filename(info.filename);
+        session->set_sessionid(info.sessionid);
+        FillUserInfo(session, info.userinfo);
+    }
+
+    LOG_EVERY_N(INFO, 10) << "RefreshSessions: session num = "
+                          << sessions.size()
+                          << ", log id = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.RefreshSessions(cntl, &request, response, nullptr);
+}
+
 void MDSClientBase::CheckSnapShotStatus(const std::string& filename,
                                         const UserInfo_t& userinfo,
                                         uint64_t seq,
@@ -383,6 +406,7 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
                                          uint64_t offset,
                                          const FInfo_t* fi,
                                          const FileEpoch_t *fEpoch,
+                                         uint32_t segmentNum,
                                          GetOrAllocateSegmentResponse* response,
                                          brpc::Controller* cntl,
                                          brpc::Channel* channel) {
@@ -397,11 +421,15 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
     if (allocate && fEpoch != nullptr && fEpoch->epoch != 0) {
         request.set_epoch(fEpoch->epoch);
     }
+    if (segmentNum > 1) {
+        request.set_segmentnum(segmentNum);
+    }
     FillUserInfo(&request, fi->userinfo);
 
     LOG(INFO) << "GetOrAllocateSegment: filename = " << fi->fullPathName
               << ", allocate = " << allocate << ", owner = " << fi->owner
               << ", offset = " << offset << ", segment offset = " << seg_offset
+              << ", segment num = " << segmentNum
               << ", log id = " << cntl->log_id();
 
     curve::mds::CurveFSService_Stub stub(channel);
@@ -59,6 +59,8 @@ using curve::mds::DeleteSnapShotRequest;
 using curve::mds::DeleteSnapShotResponse;
 using curve::mds::ReFreshSessionRequest;
 using curve::mds::ReFreshSessionResponse;
+using curve::mds::RefreshSessionsRequest;
+using curve::mds::RefreshSessionsResponse;
 using curve::mds::ListDirRequest;
 using curve::mds::ListDirResponse;
 using curve::mds::ChangeOwnerRequest;
@@ -92,6 +94,13 @@ using curve::mds::topology::ListPoolsetResponse;
 
 extern const char* kRootUserName;
 
+// 批量续约时单个文件的续约信息
+struct RefreshSessionInfo {
+    std::string filename;
+    UserInfo_t userinfo;
+    std::string sessionid;
+};
+
 // MDSClientBase将所有与mds的RPC接口抽离，与业务逻辑解耦
 // 这里只负责rpc的发送，具体的业务处理逻辑通过reponse和controller向上
 // 返回给调用者，有调用者处理
@@ -246,6 +255,18 @@ class MDSClientBase {
                         ReFreshSessionResponse* response,
                         brpc::Controller* cntl,
                         brpc::Channel* channel);
+
+    /**
+     * 一次rpc续约多个文件的session
+     * @param: sessions是要续约的文件信息
+     * @param[out]: response为该rpc的response，提供给外部处理
+     * @param[in|out]: cntl既是入参，也是出参，返回RPC状态
+     * @param[in]:channel是当前与mds建立的通道
+     */
+    void RefreshSessions(const std::vector<RefreshSessionInfo>& sessions,
+                         RefreshSessionsResponse* response,
+                         brpc::Controller* cntl,
+                         brpc::Channel* channel);
     /**
      * 获取快照状态
      * @param: filenam文件名
@@ -340,6 +361,7 @@ class MDSClientBase {
      * @param: offset  segment start offset
      * @param: fi file info
      * @param: fEpoch  file epoch info
+     * @param: segmentNum  number of consecutive segments wanted
      * @param[out]: reponse  rpc response
      * @param[in|out]: cntl  rpc controller
      * @param[in]:channel  rpc channel
@@ -348,6 +370,7 @@ class MDSClientBase {
                               uint64_t offset,
                               const FInfo_t* fi,
                               const FileEpoch_t *fEpoch,
+                              uint32_t segmentNum,
                               GetOrAllocateSegmentResponse* response,
                               brpc::Controller* cntl,
                               brpc::Channel* channel);
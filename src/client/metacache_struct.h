@@ -320,6 +320,8 @@ class FileSegment {
 
     void AcquireReadLock() { rwlock_.RDLock(); }
 
+    bool TryAcquireReadLock() { return rwlock_.TryRDLock() == 0; }
+
     void AcquireWriteLock() { rwlock_.WRLock(); }
 
     void ReleaseLock() { rwlock_.Unlock(); }
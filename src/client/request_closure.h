@@ -101,6 +101,13 @@ class CURVE_CACHELINE_ALIGNMENT RequestClosure
         ioManager_ = ioManager;
     }
 
+    /**
+     * @brief 获取所属的iomanager
+     */
+    IOManager* GetIOManager() const {
+        return ioManager_;
+    }
+
     /**
      * @brief 设置当前closure重试次数
      */
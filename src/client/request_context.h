@@ -27,6 +27,7 @@
 
 #include <atomic>
 #include <string>
+#include <vector>
 
 #include "src/client/client_common.h"
 #include "src/client/request_closure.h"
@@ -85,6 +86,16 @@ struct CURVE_CACHELINE_ALIGNMENT RequestContext {
     // subIoIndex_ is an index of serveral requests
     uint32_t subIoIndex_ = 0;
 
+    // index of the chunk in file, requests are dispatched to scheduler
+    // queues by this index
+    ChunkIndex chunkIndex_ = 0;
+
+    // position of the stripe unit in its stripe, -1 for non-striped io
+    int32_t stripePos_ = -1;
+
+    // cpu of the thread which submitted the user io, -1 if unknown
+    int submitCPU_ = -1;
+
     // read data of current request
     butil::IOBuf readData_;
 
@@ -107,6 +118,15 @@ struct CURVE_CACHELINE_ALIGNMENT RequestContext {
     // 这个对应的GetChunkInfo的出参
     ChunkInfoDetail*    chunkinfodetail_ = nullptr;
 
+    // 这个对应的RecoverChunk返回的读穿透chunk
+    std::vector<ChunkID>* hotChunks_ = nullptr;
+
+    // CreateCloneChunks/RecoverChunks请求中同一copyset上的chunk，
+    // 此时idinfo_的chunk id为第一个chunk的id
+    std::vector<CloneChunkItem> cloneChunks_;
+    // 这个对应的CreateCloneChunks返回的已存在的chunk
+    std::vector<ChunkID>* existChunks_ = nullptr;
+
     // clone chunk请求需要携带源chunk的location及所需要创建的chunk的大小
     uint32_t            chunksize_ = 0;
     std::string         location_;
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * File Created: 2022-10-11
+ * Author: curve
+ */
+
+#include "src/client/request_merger.h"
+
+#include <glog/logging.h>
+
+#include "src/client/client_metric.h"
+
+namespace curve {
+namespace client {
+
+void MergedRequestClosure::Run() {
+    ReleaseInflightRPCToken();
+    if (IsSuspendRPC()) {
+        MetricHelper::DecremIOSuspendNum(GetMetric());
+    }
+
+    RequestContext* merged = GetReqCtx();
+    const int errcode = GetErrorCode();
+    const bool copyReadData = merged->optype_ == OpType::READ && errcode == 0;
+
+    std::vector<RequestContext*> subRequests;
+    subRequests.swap(subRequests_);
+    for (auto* sub : subRequests) {
+        if (copyReadData) {
+            merged->readData_.cutn(&sub->readData_, sub->rawlength_);
+        }
+        sub->done_->SetFailed(errcode);
+    }
+
+    // merged request owns this closure, so release it before running
+    // sub-requests' closures, the last one may destroy its IOTracker
+    merged->UnInit();
+    delete merged;
+
+    for (auto* sub : subRequests) {
+        sub->done_->Run();
+    }
+}
+
+bool RequestMerger::IsMergeable(const RequestContext* req) {
+    if (req->optype_ != OpType::READ && req->optype_ != OpType::WRITE) {
+        return false;
+    }
+
+    // requests that read from clone source, retried requests and merged
+    // requests are sent as they are
+    return req->idinfo_.chunkExist && !req->sourceInfo_.IsValid() &&
+           req->done_->GetRetriedTimes() == 0 && !IsMergedRequest(req);
+}
+
+bool RequestMerger::CanMerge(const RequestContext* last,
+                             const RequestContext* next, uint64_t mergedBytes,
+                             uint32_t mergedCount,
+                             const RequestMergeOption& opt) {
+    if (!IsMergeable(next)) {
+        return false;
+    }
+
+    if (mergedCount >= opt.maxMergeRequests ||
+        mergedBytes + next->rawlength_ > opt.maxMergeBytes) {
+        return false;
+    }
+
+    if (last->optype_ != next->optype_ ||
+        last->idinfo_.lpid_ != next->idinfo_.lpid_ ||
+        last->idinfo_.cpid_ != next->idinfo_.cpid_ ||
+        last->idinfo_.cid_ != next->idinfo_.cid_ ||
+        last->seq_ != next->seq_) {
+        return false;
+    }
+
+    if (next->optype_ == OpType::WRITE &&
+        (last->fileId_ != next->fileId_ || last->epoch_ != next->epoch_)) {
+        return false;
+    }
+
+    if (next->optype_ == OpType::READ &&
+        last->appliedindex_ != next->appliedindex_) {
+        return false;
+    }
+
+    return static_cast<uint64_t>(last->offset_) + last->rawlength_ ==
+           static_cast<uint64_t>(next->offset_);
+}
+
+RequestContext* RequestMerger::Merge(
+    const std::vector<RequestContext*>& subRequests) {
+    if (subRequests.size() < 2) {
+        return nullptr;
+    }
+
+    RequestContext* merged = new (std::nothrow) RequestContext();
+    if (merged == nullptr) {
+        LOG(ERROR) << "Allocate merged RequestContext failed";
+        return nullptr;
+    }
+
+    const RequestContext* first = subRequests.front();
+    merged->idinfo_ = first->idinfo_;
+    merged->optype_ = first->optype_;
+    merged->offset_ = first->offset_;
+    merged->fileId_ = first->fileId_;
+    merged->epoch_ = first->epoch_;
+    merged->seq_ = first->seq_;
+    merged->appliedindex_ = first->appliedindex_;
+    merged->chunkIndex_ = first->chunkIndex_;
+    merged->stripePos_ = first->stripePos_;
+
+    for (const auto* sub : subRequests) {
+        merged->rawlength_ += sub->rawlength_;
+        if (merged->optype_ == OpType::WRITE) {
+            merged->writeData_.append(sub->writeData_);
+        }
+    }
+
+    MergedRequestClosure* done =
+        new (std::nothrow) MergedRequestClosure(merged, subRequests);
+    if (done == nullptr) {
+        LOG(ERROR) << "Allocate MergedRequestClosure failed";
+        delete merged;
+        return nullptr;
+    }
+
+    done->SetIOTracker(first->done_->GetIOTracker());
+    done->SetIOManager(first->done_->GetIOManager());
+    done->SetFileMetric(first->done_->GetMetric());
+    merged->done_ = done;
+
+    // the first sub-request is sent as the merged one, only the following
+    // ones are merged away
+    MetricHelper::IncremMergedRequestCount(first->done_->GetMetric(),
+                                           subRequests.size() - 1);
+
+    DVLOG(9) << "merged " << subRequests.size() << " requests, " << *merged;
+    return merged;
+}
+
+bool RequestMerger::IsMergedRequest(const RequestContext* req) {
+    return dynamic_cast<MergedRequestClosure*>(req->done_) != nullptr;
+}
+
+}  // namespace client
+}  // namespace curve
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * File Created: 2022-10-11
+ * Author: curve
+ */
+
+#ifndef SRC_CLIENT_REQUEST_MERGER_H_
+#define SRC_CLIENT_REQUEST_MERGER_H_
+
+#include <vector>
+
+#include "src/client/config_info.h"
+#include "src/client/request_closure.h"
+#include "src/client/request_context.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * MergedRequestClosure is the closure of a request merged from several
+ * adjacent sub-requests. When the merged rpc returns, it dispatches the
+ * result (error code and read data) to each sub-request and runs their own
+ * closures, so IOTracker still sees one response per sub-request.
+ */
+class MergedRequestClosure : public RequestClosure {
+ public:
+    MergedRequestClosure(RequestContext* reqctx,
+                         std::vector<RequestContext*> subRequests)
+        : RequestClosure(reqctx), subRequests_(std::move(subRequests)) {}
+
+    void Run() override;
+
+    const std::vector<RequestContext*>& GetSubRequests() const {
+        return subRequests_;
+    }
+
+ private:
+    std::vector<RequestContext*> subRequests_;
+};
+
+/**
+ * RequestMerger merges contiguous read or write requests on the same chunk
+ * into one larger request before they are sent to chunkserver.
+ */
+class RequestMerger {
+ public:
+    /**
+     * @brief Check whether a request can be merged with others
+     */
+    static bool IsMergeable(const RequestContext* req);
+
+    /**
+     * @brief Check whether `next` can be appended after `last`
+     * @param last the last request of current merge group
+     * @param next the candidate request
+     * @param mergedBytes total bytes of current merge group
+     * @param mergedCount number of requests in current merge group
+     * @param opt merge options
+     */
+    static bool CanMerge(const RequestContext* last, const RequestContext* next,
+                         uint64_t mergedBytes, uint32_t mergedCount,
+                         const RequestMergeOption& opt);
+
+    /**
+     * @brief Build a merged request from contiguous sub-requests
+     * @param subRequests sub-requests sorted by offset, at least two
+     * @return merged request on success, nullptr otherwise
+     */
+    static RequestContext* Merge(const std::vector<RequestContext*>& subRequests);
+
+    /**
+     * @brief Check whether a request is built by Merge
+     */
+    static bool IsMergedRequest(const RequestContext* req);
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_REQUEST_MERGER_H_
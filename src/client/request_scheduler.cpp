@@ -24,14 +24,30 @@
 
 #include <brpc/closure_guard.h>
 #include <glog/logging.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "src/client/request_context.h"
 #include "src/client/request_closure.h"
 #include "src/client/chunk_closure.h"
+#include "src/client/request_merger.h"
 
 namespace curve {
 namespace client {
 
+namespace {
+
+void BindCurrentThreadToCPU(uint32_t cpu) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    LOG_IF(WARNING, rc != 0) << "Bind schedule thread to cpu " << cpu
+                             << " failed, error = " << rc;
+}
+
+}  // namespace
+
 RequestScheduler::~RequestScheduler() {}
 
 int RequestScheduler::Init(const RequestScheduleOption& reqSchdulerOpt,
@@ -40,19 +56,29 @@ int RequestScheduler::Init(const RequestScheduleOption& reqSchdulerOpt,
     blockIO_.store(false);
     reqschopt_ = reqSchdulerOpt;
 
-    int rc = 0;
-    rc = queue_.Init(reqschopt_.scheduleQueueCapacity);
-    if (0 != rc) {
+    if (reqschopt_.scheduleQueueNum == 0) {
+        LOG(ERROR) << "scheduleQueueNum must be greater than 0";
         return -1;
     }
 
-    rc = threadPool_.Init(reqschopt_.scheduleThreadpoolSize,
-                          std::bind(&RequestScheduler::Process, this));
-    if (0 != rc) {
-        return -1;
+    queues_.clear();
+    for (uint32_t i = 0; i < reqschopt_.scheduleQueueNum; ++i) {
+        std::unique_ptr<ScheduleQueue> q(new ScheduleQueue());
+        int rc = q->queue.Init(reqschopt_.scheduleQueueCapacity);
+        if (0 != rc) {
+            return -1;
+        }
+
+        rc = q->threadPool.Init(reqschopt_.scheduleThreadpoolSize,
+                                std::bind(&RequestScheduler::Process, this, i));
+        if (0 != rc) {
+            return -1;
+        }
+
+        queues_.emplace_back(std::move(q));
     }
 
-    rc = client_.Init(metaCache, reqschopt_.ioSenderOpt, this, fm);
+    int rc = client_.Init(metaCache, reqschopt_.ioSenderOpt, this, fm);
     if (0 != rc) {
         return -1;
     }
@@ -61,31 +87,65 @@ int RequestScheduler::Init(const RequestScheduleOption& reqSchdulerOpt,
               << "scheduleQueueCapacity = "
               << reqschopt_.scheduleQueueCapacity
               << ", scheduleThreadpoolSize = "
-              << reqschopt_.scheduleThreadpoolSize;
+              << reqschopt_.scheduleThreadpoolSize
+              << ", scheduleQueueNum = " << reqschopt_.scheduleQueueNum
+              << ", dispatchByCPU = " << reqschopt_.dispatchByCPU
+              << ", cpuAffinity size = " << reqschopt_.cpuAffinity.size()
+              << ", merge enable = " << reqschopt_.mergeOpt.enable
+              << ", maxMergeBytes = " << reqschopt_.mergeOpt.maxMergeBytes
+              << ", maxMergeRequests = "
+              << reqschopt_.mergeOpt.maxMergeRequests;
     return 0;
 }
 
 int RequestScheduler::Run() {
     if (!running_.exchange(true, std::memory_order_acq_rel)) {
-        stop_.store(false, std::memory_order_release);
-        threadPool_.Start();
+        for (auto& q : queues_) {
+            q->stop.store(false, std::memory_order_release);
+            q->threadPool.Start();
+        }
     }
     return 0;
 }
 
 int RequestScheduler::Fini() {
     if (running_.exchange(false, std::memory_order_acq_rel)) {
-        for (int i = 0; i < threadPool_.NumOfThreads(); ++i) {
-            // notify the wait thread
-            BBQItem<RequestContext *> stopReq(nullptr, true);
-            queue_.PutBack(stopReq);
+        for (auto& q : queues_) {
+            for (int i = 0; i < q->threadPool.NumOfThreads(); ++i) {
+                // notify the wait thread
+                BBQItem<RequestContext *> stopReq(nullptr, true);
+                q->queue.PutBack(stopReq);
+            }
+        }
+
+        for (auto& q : queues_) {
+            q->threadPool.Stop();
         }
-        threadPool_.Stop();
     }
 
     return 0;
 }
 
+uint32_t RequestScheduler::GetQueueIndex(const RequestContext* req) const {
+    if (queues_.size() == 1) {
+        return 0;
+    }
+
+    // user io is dispatched by chunk index, so stripe units of a striped
+    // file are spread across queues while io on one chunk keeps its order
+    const bool userIO =
+        req->optype_ == OpType::READ || req->optype_ == OpType::WRITE;
+    if (userIO && reqschopt_.dispatchByCPU && req->submitCPU_ >= 0) {
+        // like blk-mq, submitters on different cpus use different queues.
+        // the cpu is captured in the caller's thread, here we may run on
+        // the iomanager's task thread
+        return static_cast<uint32_t>(req->submitCPU_) % queues_.size();
+    }
+
+    uint64_t key = userIO ? req->chunkIndex_ : req->idinfo_.cid_;
+    return key % queues_.size();
+}
+
 int RequestScheduler::ScheduleRequest(
     const std::vector<RequestContext*>& requests) {
     if (running_.load(std::memory_order_acquire)) {
@@ -100,7 +160,7 @@ int RequestScheduler::ScheduleRequest(
             }
 
             BBQItem<RequestContext *> req(it);
-            queue_.PutBack(req);
+            SelectQueue(it)->queue.PutBack(req);
         }
         return 0;
     }
@@ -110,7 +170,7 @@ int RequestScheduler::ScheduleRequest(
 int RequestScheduler::ScheduleRequest(RequestContext *request) {
     if (running_.load(std::memory_order_acquire)) {
         BBQItem<RequestContext *> req(request);
-        queue_.PutBack(req);
+        SelectQueue(request)->queue.PutBack(req);
         return 0;
     }
     return -1;
@@ -119,7 +179,7 @@ int RequestScheduler::ScheduleRequest(RequestContext *request) {
 int RequestScheduler::ReSchedule(RequestContext *request) {
     if (running_.load(std::memory_order_acquire)) {
         BBQItem<RequestContext *> req(request);
-        queue_.PutFront(req);
+        SelectQueue(request)->queue.PutFront(req);
         return 0;
     }
     return -1;
@@ -140,25 +200,72 @@ void RequestScheduler::WakeupBlockQueueAtExit() {
     leaseRefreshcv_.notify_all();
 }
 
-void RequestScheduler::Process() {
+void RequestScheduler::Process(uint32_t index) {
+    if (!reqschopt_.cpuAffinity.empty()) {
+        BindCurrentThreadToCPU(
+            reqschopt_.cpuAffinity[index % reqschopt_.cpuAffinity.size()]);
+    }
+
+    ScheduleQueue* q = queues_[index].get();
     while ((running_.load(std::memory_order_acquire) ||
-            !queue_.Empty())  // flush all request in the queue
-           && !stop_.load(std::memory_order_acquire)) {
+            !q->queue.Empty())  // flush all request in the queue
+           && !q->stop.load(std::memory_order_acquire)) {
         WaitValidSession();
-        BBQItem<RequestContext*> item = queue_.TakeFront();
+        BBQItem<RequestContext*> item = q->queue.TakeFront();
         if (!item.IsStop()) {
             RequestContext* req = item.Item();
+            if (reqschopt_.mergeOpt.enable) {
+                req = MergeAdjacentRequests(q, req);
+            }
             ProcessOne(req);
         } else {
             /**
-             * 一旦遇到stop item，所有线程都可以退出，因为此时
+             * 一旦遇到stop item，该队列的所有线程都可以退出，因为此时
              * queue里面所有的request都被处理完了
              */
-            stop_.store(true, std::memory_order_release);
+            q->stop.store(true, std::memory_order_release);
         }
     }
 }
 
+RequestContext* RequestScheduler::MergeAdjacentRequests(ScheduleQueue* queue,
+                                                        RequestContext* ctx) {
+    if (!RequestMerger::IsMergeable(ctx)) {
+        return ctx;
+    }
+
+    std::vector<RequestContext*> subRequests{ctx};
+    uint64_t mergedBytes = ctx->rawlength_;
+    BBQItem<RequestContext*> next(nullptr);
+    // only merge requests that are already queued, never wait for more
+    while (queue->queue.TryTakeFrontIf(
+        [&](BBQItem<RequestContext*>& item) {
+            return !item.IsStop() &&
+                   RequestMerger::CanMerge(subRequests.back(), item.Item(),
+                                           mergedBytes, subRequests.size(),
+                                           reqschopt_.mergeOpt);
+        },
+        &next)) {
+        subRequests.push_back(next.Item());
+        mergedBytes += next.Item()->rawlength_;
+    }
+
+    if (subRequests.size() == 1) {
+        return ctx;
+    }
+
+    RequestContext* merged = RequestMerger::Merge(subRequests);
+    if (merged != nullptr) {
+        return merged;
+    }
+
+    // fallback to send sub-requests one by one
+    for (size_t i = 1; i < subRequests.size(); ++i) {
+        ProcessOne(subRequests[i]);
+    }
+    return ctx;
+}
+
 void RequestScheduler::ProcessOne(RequestContext* ctx) {
     brpc::ClosureGuard guard(ctx->done_);
 
@@ -196,6 +303,14 @@ void RequestScheduler::ProcessOne(RequestContext* ctx) {
             client_.RecoverChunk(ctx->idinfo_, ctx->offset_, ctx->rawlength_,
                                  guard.release());
             break;
+        case OpType::CREATE_CLONE_BATCH:
+            client_.CreateCloneChunks(ctx->idinfo_, ctx->cloneChunks_,
+                                      guard.release());
+            break;
+        case OpType::RECOVER_CHUNK_BATCH:
+            client_.RecoverChunks(ctx->idinfo_, ctx->cloneChunks_,
+                                  guard.release());
+            break;
         default:
             /* TODO(wudemiao) 后期整个链路错误发统一了在处理 */
             ctx->done_->SetFailed(-1);
@@ -23,6 +23,7 @@
 #ifndef SRC_CLIENT_REQUEST_SCHEDULER_H_
 #define SRC_CLIENT_REQUEST_SCHEDULER_H_
 
+#include <memory>
 #include <vector>
 
 #include "src/common/uncopyable.h"
@@ -50,7 +51,6 @@ class RequestScheduler : public Uncopyable {
  public:
     RequestScheduler()
         : running_(false),
-          stop_(true),
           client_(),
           blockingQueue_(true) {}
     virtual ~RequestScheduler();
@@ -128,18 +128,52 @@ class RequestScheduler : public Uncopyable {
     /**
      * 测试使用，获取队列
      */
-    BoundedBlockingDeque<BBQItem<RequestContext*>>* GetQueue() {
-        return &queue_;
+    BoundedBlockingDeque<BBQItem<RequestContext*>>* GetQueue(
+        uint32_t index = 0) {
+        return &queues_[index]->queue;
     }
 
+    /**
+     * 测试使用，获取request被分发到的队列
+     */
+    uint32_t GetQueueIndex(const RequestContext* req) const;
+
  private:
+    /**
+     * 每个调度队列及其处理线程
+     */
+    struct ScheduleQueue {
+        // 存放 request 的队列
+        BoundedBlockingDeque<BBQItem<RequestContext *>> queue;
+        // 处理 request 的线程池
+        ThreadPool threadPool;
+        // stop thread pool 标记，当调用 Scheduler Fini
+        // 之后且 queue 里面的 request 都处理完了，就可以
+        // 让该队列的所有处理线程退出了
+        std::atomic<bool> stop{true};
+    };
+
     /**
      * Thread pool的运行函数，会从queue中取request进行处理
+     * @param index: 线程所处理的队列下标
      */
-    void Process();
+    void Process(uint32_t index);
 
     void ProcessOne(RequestContext* ctx);
 
+    ScheduleQueue* SelectQueue(const RequestContext* req) {
+        return queues_[GetQueueIndex(req)].get();
+    }
+
+    /**
+     * 从队列中取出与ctx相邻的请求并与其合并
+     * @param queue: ctx所在的队列
+     * @param ctx: 已经从队列中取出的请求
+     * @return 合并之后的请求，没有可以合并的请求时返回ctx本身
+     */
+    RequestContext* MergeAdjacentRequests(ScheduleQueue* queue,
+                                          RequestContext* ctx);
+
     void WaitValidSession() {
         // lease续约失败的时候需要阻塞IO直到续约成功
         if (blockIO_.load(std::memory_order_acquire) && blockingQueue_) {
@@ -153,16 +187,12 @@ class RequestScheduler : public Uncopyable {
  private:
     // 线程池和queue容量的配置参数
     RequestScheduleOption reqschopt_;
-    // 存放 request 的队列
-    BoundedBlockingDeque<BBQItem<RequestContext *>> queue_;
-    // 处理 request 的线程池
-    ThreadPool threadPool_;
+    // 调度队列，默认同一个chunk的request总是被分发到同一个队列，
+    // 因此同一个chunk上的request保持提交时的顺序；开启dispatchByCPU之后
+    // 读写request按照提交线程所在的cpu分发
+    std::vector<std::unique_ptr<ScheduleQueue>> queues_;
     // Scheduler 运行标记，只有运行了，才接收 request
     std::atomic<bool> running_;
-    // stop thread pool 标记，当调用 Scheduler Fini
-    // 之后且 queue 里面的 request 都处理完了，就可以
-    // 让所有处理线程退出了
-    std::atomic<bool> stop_;
     // 访问复制组Chunk的客户端
     CopysetClient client_;
     // 续约失败，卡住IO
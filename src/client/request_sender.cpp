@@ -278,6 +278,66 @@ int RequestSender::RecoverChunk(const ChunkIDInfo& idinfo,
     return 0;
 }
 
+int RequestSender::CreateCloneChunks(
+    const ChunkIDInfo& idinfo,
+    ClientClosure *done,
+    const std::vector<CloneChunkItem>& chunks) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller *cntl = new brpc::Controller();
+    ChunkResponse *response = new ChunkResponse();
+
+    UpdateRpcRPS(done, OpType::CREATE_CLONE_BATCH);
+    SetRpcStuff(done, cntl, response);
+
+    ChunkRequest request;
+    request.set_optype(
+        curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    for (const auto& chunk : chunks) {
+        auto item = request.add_clonechunks();
+        item->set_chunkid(chunk.chunkId);
+        item->set_location(chunk.location);
+        item->set_sn(chunk.sn);
+        item->set_correctedsn(chunk.correctedSn);
+        item->set_size(chunk.len);
+    }
+
+    ChunkService_Stub stub(&channel_);
+    stub.CreateCloneChunks(cntl, &request, response, doneGuard.release());
+
+    return 0;
+}
+
+int RequestSender::RecoverChunks(const ChunkIDInfo& idinfo,
+                                 ClientClosure *done,
+                                 const std::vector<CloneChunkItem>& chunks) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller *cntl = new brpc::Controller();
+    ChunkResponse *response = new ChunkResponse();
+
+    UpdateRpcRPS(done, OpType::RECOVER_CHUNK_BATCH);
+    SetRpcStuff(done, cntl, response);
+
+    ChunkRequest request;
+    request.set_optype(curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    for (const auto& chunk : chunks) {
+        auto item = request.add_clonechunks();
+        item->set_chunkid(chunk.chunkId);
+        item->set_offset(chunk.offset);
+        item->set_size(chunk.len);
+    }
+
+    ChunkService_Stub stub(&channel_);
+    stub.RecoverChunks(cntl, &request, response, doneGuard.release());
+
+    return 0;
+}
+
 int RequestSender::ResetSender(ChunkServerID chunkServerId,
                                butil::EndPoint serverEndPoint) {
     chunkServerId_ = chunkServerId;
@@ -28,6 +28,7 @@
 #include <butil/iobuf.h>
 
 #include <string>
+#include <vector>
 
 #include "src/client/client_config.h"
 #include "src/client/client_common.h"
@@ -163,6 +164,31 @@ class RequestSender {
     */
     int RecoverChunk(const ChunkIDInfo& idinfo,
                      ClientClosure* done, uint64_t offset, uint64_t len);
+
+    /**
+    * @brief 批量创建同一copyset上的clone chunk
+    * @param idinfo chunk所在的copyset，chunk id为第一个chunk的id
+    * @param done:上一层异步回调的closure
+    * @param:chunks 需要创建的chunk
+    *
+    * @return 错误码
+    */
+    int CreateCloneChunks(const ChunkIDInfo& idinfo,
+                          ClientClosure* done,
+                          const std::vector<CloneChunkItem>& chunks);
+
+   /**
+    * @brief 批量恢复同一copyset上的chunk数据
+    * @param idinfo chunk所在的copyset，chunk id为第一个chunk的id
+    * @param done:上一层异步回调的closure
+    * @param:chunks 需要恢复的chunk及其偏移和长度
+    *
+    * @return 错误码
+    */
+    int RecoverChunks(const ChunkIDInfo& idinfo,
+                      ClientClosure* done,
+                      const std::vector<CloneChunkItem>& chunks);
+
     /**
      * 重置和Chunk Server的链接
      * @param chunkServerId:Chunk Server唯一标识
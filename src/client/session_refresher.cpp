@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * File Created: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/client/session_refresher.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+namespace curve {
+namespace client {
+
+SessionRefresher::SessionRefresher(MDSClient* mdsclient,
+                                   uint32_t maxBatchSize)
+    : mdsclient_(mdsclient),
+      maxBatchSize_(std::max(maxBatchSize, 1u)),
+      executors_(),
+      intervalUs_(0),
+      task_(),
+      batchSupported_(true) {}
+
+SessionRefresher::~SessionRefresher() {
+    std::lock_guard<bthread::Mutex> lk(taskMtx_);
+    if (task_ != nullptr) {
+        task_->Stop();
+        task_->WaitTaskExit();
+        task_.reset();
+    }
+}
+
+void SessionRefresher::Register(LeaseExecutor* executor,
+                                uint64_t intervalUs) {
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        executors_.insert(executor);
+        if (intervalUs_ != 0 && intervalUs_ <= intervalUs) {
+            return;
+        }
+        intervalUs_ = intervalUs;
+    }
+
+    // start the task, or restart it with a shorter interval
+    std::lock_guard<bthread::Mutex> lk(taskMtx_);
+    if (task_ != nullptr) {
+        task_->Stop();
+        task_->WaitTaskExit();
+    }
+
+    uint64_t interval = 0;
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        interval = intervalUs_;
+    }
+
+    task_.reset(new RefreshSessionTask(this, interval));
+    timespec abstime = butil::microseconds_from_now(interval);
+    brpc::PeriodicTaskManager::StartTaskAt(task_.get(), abstime);
+
+    LOG(INFO) << "Session refresher started, refresh interval is "
+              << interval << " us";
+}
+
+void SessionRefresher::Unregister(LeaseExecutor* executor) {
+    RemoveExecutor(executor);
+
+    // the running refresh may still use the executor
+    std::lock_guard<bthread::Mutex> lk(refreshMtx_);
+}
+
+size_t SessionRefresher::ExecutorNum() const {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    return executors_.size();
+}
+
+bool SessionRefresher::RefreshLease() {
+    std::lock_guard<bthread::Mutex> refreshLk(refreshMtx_);
+
+    std::vector<LeaseExecutor*> executors;
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        executors.assign(executors_.begin(), executors_.end());
+    }
+
+    for (size_t start = 0; start < executors.size(); start += maxBatchSize_) {
+        size_t end = std::min(executors.size(),
+                              start + static_cast<size_t>(maxBatchSize_));
+        std::vector<LeaseExecutor*> batch(executors.begin() + start,
+                                          executors.begin() + end);
+        if (batchSupported_.load(std::memory_order_relaxed)) {
+            RefreshBatch(batch);
+        } else {
+            RefreshEach(batch);
+        }
+    }
+
+    return true;
+}
+
+void SessionRefresher::RefreshBatch(
+    const std::vector<LeaseExecutor*>& executors) {
+    std::vector<RefreshSessionInfo> sessions;
+    sessions.reserve(executors.size());
+    for (auto* executor : executors) {
+        executor->BlockIOIfLeaseInvalid();
+        sessions.emplace_back(executor->GetRefreshSessionInfo());
+    }
+
+    std::vector<LeaseRefreshResult> results;
+    std::vector<LIBCURVE_ERROR> rets;
+    LIBCURVE_ERROR ret = mdsclient_->RefreshSessions(sessions, &results,
+                                                     &rets);
+    if (ret == LIBCURVE_ERROR::NOT_SUPPORT) {
+        LOG(WARNING) << "mds doesn't support RefreshSessions, "
+                        "refresh session of each file instead";
+        batchSupported_.store(false, std::memory_order_relaxed);
+        RefreshEach(executors);
+        return;
+    }
+
+    for (size_t i = 0; i < executors.size(); ++i) {
+        bool goOn = ret == LIBCURVE_ERROR::OK
+                        ? executors[i]->HandleRefreshResult(rets[i],
+                                                            results[i])
+                        : executors[i]->HandleRefreshResult(
+                              LIBCURVE_ERROR::FAILED, LeaseRefreshResult());
+        if (!goOn) {
+            RemoveExecutor(executors[i]);
+        }
+    }
+}
+
+void SessionRefresher::RefreshEach(
+    const std::vector<LeaseExecutor*>& executors) {
+    for (auto* executor : executors) {
+        if (!executor->RefreshLease()) {
+            RemoveExecutor(executor);
+        }
+    }
+}
+
+void SessionRefresher::RemoveExecutor(LeaseExecutor* executor) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    executors_.erase(executor);
+}
+
+}  // namespace client
+}  // namespace curve
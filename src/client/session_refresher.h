@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * File Created: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_CLIENT_SESSION_REFRESHER_H_
+#define SRC_CLIENT_SESSION_REFRESHER_H_
+
+#include <bthread/mutex.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "src/client/lease_executor.h"
+#include "src/client/mds_client.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * SessionRefresher refreshes sessions of all files opened by one client
+ * process. Instead of each LeaseExecutor sending its own RefreshSession
+ * rpc, registered executors are refreshed together by one periodic task,
+ * at most maxBatchSize files per RefreshSessions rpc, and each result is
+ * dispatched back to its executor.
+ *
+ * If mds doesn't support RefreshSessions, it falls back to refreshing
+ * each file separately.
+ */
+class SessionRefresher : public LeaseExecutorBase {
+ public:
+    SessionRefresher(MDSClient* mdsclient, uint32_t maxBatchSize);
+
+    ~SessionRefresher();
+
+    /**
+     * @brief add executor to refresh
+     * @param intervalUs refresh interval of the executor, the task runs
+     *        with the minimum interval of all executors
+     */
+    void Register(LeaseExecutor* executor, uint64_t intervalUs);
+
+    /**
+     * @brief remove executor, and wait for the running refresh to finish,
+     *        so the executor can be destroyed safely after return
+     */
+    void Unregister(LeaseExecutor* executor);
+
+    /**
+     * @brief refresh all registered executors, called by periodic task
+     * @return always true to keep the task running
+     */
+    bool RefreshLease() override;
+
+    size_t ExecutorNum() const;
+
+ private:
+    void RefreshBatch(const std::vector<LeaseExecutor*>& executors);
+
+    void RefreshEach(const std::vector<LeaseExecutor*>& executors);
+
+    void RemoveExecutor(LeaseExecutor* executor);
+
+ private:
+    MDSClient* mdsclient_;
+
+    uint32_t maxBatchSize_;
+
+    // protect executors_ and intervalUs_
+    mutable bthread::Mutex mtx_;
+    std::set<LeaseExecutor*> executors_;
+    uint64_t intervalUs_;
+
+    // held during refreshing, Unregister waits on it
+    bthread::Mutex refreshMtx_;
+
+    // protect task_, only used when (re)starting and stopping the task
+    bthread::Mutex taskMtx_;
+    std::unique_ptr<RefreshSessionTask> task_;
+
+    // mds of old version doesn't support RefreshSessions
+    std::atomic<bool> batchSupported_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_SESSION_REFRESHER_H_
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * Project: curve
+ * File Created: 2022-10-12
+ * Author: curve
+ */
+
+#include "src/client/source_cache.h"
+
+#include <atomic>
+#include <utility>
+
+namespace curve {
+namespace client {
+
+namespace {
+
+// SourceReader::SetOption may create a new cache while in-flight reads still
+// hold the old one, so every instance exposes its metrics under its own name
+std::string CacheMetricPrefix() {
+    static std::atomic<uint64_t> instances(0);
+    const std::string prefix = "curve_client_source_cache";
+    uint64_t id = instances.fetch_add(1, std::memory_order_relaxed);
+    return id == 0 ? prefix : prefix + "_" + std::to_string(id);
+}
+
+}  // namespace
+
+SourceCache::SourceCache(const SourceCacheOption& option)
+    : option_(option),
+      cache_(static_cast<uint64_t>(option.capacityMB) * 1024 * 1024 /
+                 option.blockSize,
+             std::make_shared<curve::common::CacheMetrics>(
+                 CacheMetricPrefix())) {}
+
+std::string SourceCache::BlockKey(const std::string& fileName,
+                                  uint64_t fileId, uint64_t blockIndex) {
+    return fileName + ":" + std::to_string(fileId) + ":" +
+           std::to_string(blockIndex);
+}
+
+SourceCache::LookupResult SourceCache::Lookup(const std::string& fileName,
+                                              uint64_t fileId,
+                                              uint64_t blockIndex,
+                                              butil::IOBuf* data,
+                                              Waiter waiter) {
+    const std::string key = BlockKey(fileName, fileId, blockIndex);
+    butil::IOBuf block;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (cache_.Get(key, &block)) {
+        if (data != nullptr) {
+            *data = std::move(block);
+        }
+        return LookupResult::kHit;
+    }
+
+    auto iter = inflight_.find(key);
+    if (iter != inflight_.end()) {
+        if (waiter) {
+            iter->second.emplace_back(std::move(waiter));
+        }
+        return LookupResult::kWait;
+    }
+
+    inflight_.emplace(key, std::vector<Waiter>{});
+    return LookupResult::kFetch;
+}
+
+void SourceCache::OnFetched(const std::string& fileName, uint64_t fileId,
+                            uint64_t blockIndex, bool ok,
+                            const butil::IOBuf& data) {
+    const std::string key = BlockKey(fileName, fileId, blockIndex);
+    std::vector<Waiter> waiters;
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (ok) {
+            cache_.Put(key, data);
+        }
+
+        auto iter = inflight_.find(key);
+        if (iter != inflight_.end()) {
+            waiters.swap(iter->second);
+            inflight_.erase(iter);
+        }
+    }
+
+    for (auto& waiter : waiters) {
+        waiter(ok, data);
+    }
+}
+
+}  // namespace client
+}  // namespace curve
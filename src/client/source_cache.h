@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * Project: curve
+ * File Created: 2022-10-12
+ * Author: curve
+ */
+
+#ifndef SRC_CLIENT_SOURCE_CACHE_H_
+#define SRC_CLIENT_SOURCE_CACHE_H_
+
+#include <butil/iobuf.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "src/client/config_info.h"
+#include "src/common/lru_cache.h"
+
+namespace curve {
+namespace client {
+
+struct SourceBlockCacheTraits {
+    static uint64_t CountBytes(const butil::IOBuf& value) {
+        return value.size();
+    }
+};
+
+/**
+ * SourceCache caches fixed-size blocks of clone source files, it is shared
+ * by all clone volumes opened in current process. Clone sources are
+ * read-only, so cached blocks never need to be invalidated. Blocks are keyed
+ * by source file name and id, so a source deleted and recreated with the
+ * same name never hits blocks of the old file.
+ *
+ * Concurrent misses on the same block are de-duplicated, only the first
+ * caller fetches it from the source and the others wait for its result.
+ */
+class SourceCache {
+ public:
+    enum class LookupResult {
+        // block is cached, data is returned
+        kHit,
+        // block is being fetched by others, waiter will be called later
+        kWait,
+        // block is neither cached nor being fetched, caller should fetch it
+        // and call OnFetched afterwards
+        kFetch,
+    };
+
+    using Waiter = std::function<void(bool ok, const butil::IOBuf& data)>;
+
+    explicit SourceCache(const SourceCacheOption& option);
+
+    /**
+     * @brief Lookup one block
+     * @param fileName source file name
+     * @param fileId id of the source file, a source recreated with the
+     *        same name has a different id and doesn't hit old blocks
+     * @param blockIndex index of the block in source file
+     * @param[out] data block data if it is cached, can be nullptr
+     * @param waiter called when the block is fetched by others,
+     *        if waiter is empty, kWait is returned without waiting
+     */
+    LookupResult Lookup(const std::string& fileName, uint64_t fileId,
+                        uint64_t blockIndex, butil::IOBuf* data,
+                        Waiter waiter);
+
+    /**
+     * @brief Called by fetcher after block is read from source
+     * @param ok whether the block is read successfully
+     * @param data block data
+     */
+    void OnFetched(const std::string& fileName, uint64_t fileId,
+                   uint64_t blockIndex, bool ok, const butil::IOBuf& data);
+
+    uint32_t BlockSize() const {
+        return option_.blockSize;
+    }
+
+    uint32_t PrefetchBlocks() const {
+        return option_.prefetchBlocks;
+    }
+
+ private:
+    static std::string BlockKey(const std::string& fileName,
+                                uint64_t fileId, uint64_t blockIndex);
+
+ private:
+    SourceCacheOption option_;
+
+    // protects inflight_ and keeps lookup and insertion atomic
+    std::mutex mtx_;
+
+    curve::common::LRUCache<std::string, butil::IOBuf,
+                            curve::common::CacheTraits<std::string>,
+                            SourceBlockCacheTraits> cache_;
+
+    // blocks being fetched, and their waiters
+    std::unordered_map<std::string, std::vector<Waiter>> inflight_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_SOURCE_CACHE_H_
@@ -22,9 +22,12 @@
 
 #include "src/client/source_reader.h"
 
+#include <algorithm>
+
 #include "include/client/libcurve.h"
 #include "src/client/libcurve_file.h"
 #include "src/client/request_closure.h"
+#include "src/client/request_context.h"
 #include "src/client/file_instance.h"
 
 namespace curve {
@@ -35,6 +38,158 @@ struct CurveAioCombineContext {
     CurveAioContext curveCtx;
 };
 
+namespace {
+
+uint64_t SourceOffset(const RequestContext* reqCtx) {
+    return reqCtx->sourceInfo_.cloneFileOffset + reqCtx->offset_;
+}
+
+// SourceReadTask tracks a group of contiguous requests on the same source
+// file, which are served by whole blocks from the source cache
+struct SourceReadTask {
+    std::vector<RequestContext*> reqs;
+    uint64_t alignedStart = 0;
+    std::vector<butil::IOBuf> blocks;
+    // one for each fetch or wait, plus one held during dispatching
+    std::atomic<uint32_t> pending{1};
+    std::atomic<bool> failed{false};
+
+    void OnBlockReady() {
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Finish();
+        }
+    }
+
+    void Finish() {
+        std::vector<RequestClosure*> dones;
+        butil::IOBuf data;
+        if (!failed.load(std::memory_order_acquire)) {
+            for (auto& block : blocks) {
+                data.append(block);
+            }
+        }
+
+        uint64_t pos = alignedStart;
+        for (auto* reqCtx : reqs) {
+            if (failed.load(std::memory_order_acquire)) {
+                reqCtx->done_->SetFailed(LIBCURVE_ERROR::FAILED);
+            } else {
+                data.pop_front(SourceOffset(reqCtx) - pos);
+                data.cutn(&reqCtx->readData_, reqCtx->rawlength_);
+                pos = SourceOffset(reqCtx) + reqCtx->rawlength_;
+                reqCtx->done_->SetFailed(LIBCURVE_ERROR::OK);
+            }
+            dones.push_back(reqCtx->done_);
+        }
+
+        delete this;
+
+        for (auto* done : dones) {
+            done->Run();
+        }
+    }
+};
+
+// SourceFetch reads a run of contiguous blocks from the source,
+// task is nullptr for prefetch
+struct SourceFetch {
+    std::shared_ptr<SourceCache> cache;
+    SourceReadTask* task = nullptr;
+    std::string fileName;
+    uint64_t fileId = 0;
+    uint64_t firstBlock = 0;
+    uint64_t firstTaskBlock = 0;
+    uint32_t blockCount = 0;
+    butil::IOBuf data;
+};
+
+struct SourceFetchContext {
+    SourceFetch* fetch;
+    CurveAioContext curveCtx;
+};
+
+void SourceFetchCallback(struct CurveAioContext* context) {
+    auto fetchCombineCtx = reinterpret_cast<SourceFetchContext*>(
+        reinterpret_cast<char*>(context) -
+        offsetof(SourceFetchContext, curveCtx));
+    SourceFetch* fetchCtx = fetchCombineCtx->fetch;
+
+    const uint32_t blockSize = fetchCtx->cache->BlockSize();
+    const bool ok = context->ret >= 0 &&
+                    fetchCtx->data.size() ==
+                        static_cast<uint64_t>(blockSize) * fetchCtx->blockCount;
+    LOG_IF(ERROR, !ok) << "Read source failed, filename = "
+                       << fetchCtx->fileName
+                       << ", offset = " << context->offset
+                       << ", length = " << context->length
+                       << ", ret = " << context->ret;
+
+    for (uint32_t i = 0; i < fetchCtx->blockCount; ++i) {
+        butil::IOBuf block;
+        if (ok) {
+            fetchCtx->data.cutn(&block, blockSize);
+        }
+
+        if (fetchCtx->task != nullptr && ok) {
+            fetchCtx->task->blocks[fetchCtx->firstTaskBlock + i] = block;
+        }
+
+        fetchCtx->cache->OnFetched(fetchCtx->fileName, fetchCtx->fileId,
+                                   fetchCtx->firstBlock + i, ok, block);
+    }
+
+    if (fetchCtx->task != nullptr) {
+        if (!ok) {
+            fetchCtx->task->failed.store(true, std::memory_order_release);
+        }
+        fetchCtx->task->OnBlockReady();
+    }
+
+    delete fetchCtx;
+    delete fetchCombineCtx;
+}
+
+/**
+ * @brief read blocks [firstBlock, firstBlock + blockCount) from the source
+ * @return true if the read is issued, otherwise SourceFetchCallback
+ *         has already been called with failure
+ */
+bool FetchBlocks(FileInstance* file, const std::shared_ptr<SourceCache>& cache,
+                 const std::string& fileName, SourceReadTask* task,
+                 uint64_t firstBlock, uint64_t firstTaskBlock,
+                 uint32_t blockCount) {
+    const uint32_t blockSize = cache->BlockSize();
+    SourceFetch* fetchCtx = new SourceFetch();
+    fetchCtx->cache = cache;
+    fetchCtx->task = task;
+    fetchCtx->fileName = fileName;
+    fetchCtx->fileId = file->GetCurrentFileInfo().id;
+    fetchCtx->firstBlock = firstBlock;
+    fetchCtx->firstTaskBlock = firstTaskBlock;
+    fetchCtx->blockCount = blockCount;
+
+    SourceFetchContext* fetchCombineCtx = new SourceFetchContext();
+    fetchCombineCtx->fetch = fetchCtx;
+    fetchCombineCtx->curveCtx.offset = firstBlock * blockSize;
+    fetchCombineCtx->curveCtx.length =
+        static_cast<size_t>(blockSize) * blockCount;
+    fetchCombineCtx->curveCtx.buf = &fetchCtx->data;
+    fetchCombineCtx->curveCtx.op = LIBCURVE_OP::LIBCURVE_OP_READ;
+    fetchCombineCtx->curveCtx.cb = SourceFetchCallback;
+
+    int ret = file->AioRead(&fetchCombineCtx->curveCtx,
+                            UserDataType::IOBuffer);
+    if (ret != LIBCURVE_ERROR::OK) {
+        fetchCombineCtx->curveCtx.ret = -LIBCURVE_ERROR::FAILED;
+        SourceFetchCallback(&fetchCombineCtx->curveCtx);
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace
+
 void CurveAioCallback(struct CurveAioContext* context) {
     auto curveCombineCtx = reinterpret_cast<CurveAioCombineContext *>(
         reinterpret_cast<char *>(context) -
@@ -88,6 +243,39 @@ void SourceReader::Stop() {
 
 void SourceReader::SetOption(const FileServiceOption& opt) {
     fileOption_ = opt;
+
+    const SourceCacheOption& cacheOpt = fileOption_.ioOpt.sourceCacheOpt;
+    if (!cacheOpt.enable) {
+        std::lock_guard<std::mutex> lk(cacheMtx_);
+        cache_.reset();
+        return;
+    }
+
+    if (cacheOpt.blockSize == 0 ||
+        (cacheOpt.blockSize & (cacheOpt.blockSize - 1)) != 0) {
+        LOG(ERROR) << "Invalid sourcecache.blockSize " << cacheOpt.blockSize
+                   << ", source cache is disabled";
+        std::lock_guard<std::mutex> lk(cacheMtx_);
+        cache_.reset();
+        return;
+    }
+
+    // in-flight reads keep using the old cache until they finish
+    std::shared_ptr<SourceCache> cache =
+        std::make_shared<SourceCache>(cacheOpt);
+    {
+        std::lock_guard<std::mutex> lk(cacheMtx_);
+        cache_.swap(cache);
+    }
+    LOG(INFO) << "SourceReader cache enabled, block size = "
+              << cacheOpt.blockSize
+              << ", capacity = " << cacheOpt.capacityMB << "MB"
+              << ", prefetch blocks = " << cacheOpt.prefetchBlocks;
+}
+
+std::shared_ptr<SourceCache> SourceReader::GetCache() {
+    std::lock_guard<std::mutex> lk(cacheMtx_);
+    return cache_;
 }
 
 std::unordered_map<std::string, SourceReader::ReadHandler>&
@@ -153,6 +341,17 @@ int SourceReader::Read(const std::vector<RequestContext*>& reqCtxVec,
     static std::once_flag flag;
     std::call_once(flag, []() { GetInstance().Run(); });
 
+    std::shared_ptr<SourceCache> cache = GetCache();
+    if (cache != nullptr) {
+        return ReadWithCache(cache, reqCtxVec, userInfo, mdsClient);
+    }
+
+    return ReadDirectly(reqCtxVec, userInfo, mdsClient);
+}
+
+int SourceReader::ReadDirectly(const std::vector<RequestContext*>& reqCtxVec,
+                               const UserInfo& userInfo,
+                               MDSClient* mdsClient) {
     for (auto reqCtx : reqCtxVec) {
         brpc::ClosureGuard doneGuard(reqCtx->done_);
         std::string fileName = reqCtx->sourceInfo_.cloneFileSource;
@@ -186,6 +385,142 @@ int SourceReader::Read(const std::vector<RequestContext*>& reqCtxVec,
     return 0;
 }
 
+int SourceReader::ReadWithCache(const std::shared_ptr<SourceCache>& cache,
+                                const std::vector<RequestContext*>& reqCtxVec,
+                                const UserInfo& userInfo,
+                                MDSClient* mdsClient) {
+    std::vector<RequestContext*> sorted(reqCtxVec);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const RequestContext* lhs, const RequestContext* rhs) {
+                  if (lhs->sourceInfo_.cloneFileSource !=
+                      rhs->sourceInfo_.cloneFileSource) {
+                      return lhs->sourceInfo_.cloneFileSource <
+                             rhs->sourceInfo_.cloneFileSource;
+                  }
+                  return SourceOffset(lhs) < SourceOffset(rhs);
+              });
+
+    const uint64_t blockSize = cache->BlockSize();
+    size_t begin = 0;
+    while (begin < sorted.size()) {
+        // group contiguous requests on the same source file
+        const std::string& fileName =
+            sorted[begin]->sourceInfo_.cloneFileSource;
+        size_t end = begin + 1;
+        while (end < sorted.size() &&
+               sorted[end]->sourceInfo_.cloneFileSource == fileName &&
+               SourceOffset(sorted[end]) == SourceOffset(sorted[end - 1]) +
+                                                sorted[end - 1]->rawlength_) {
+            ++end;
+        }
+
+        SourceReadTask* task = new SourceReadTask();
+        task->reqs.assign(sorted.begin() + begin, sorted.begin() + end);
+        begin = end;
+
+        const uint64_t startOffset = SourceOffset(task->reqs.front());
+        const uint64_t endOffset =
+            SourceOffset(task->reqs.back()) + task->reqs.back()->rawlength_;
+        const uint64_t firstBlock = startOffset / blockSize;
+        const uint64_t lastBlock = (endOffset + blockSize - 1) / blockSize;
+        task->alignedStart = firstBlock * blockSize;
+        task->blocks.resize(lastBlock - firstBlock);
+
+        ReadHandler* handler = GetReadHandler(fileName, userInfo, mdsClient);
+        if (handler == nullptr) {
+            LOG(ERROR) << "Get ReadHandler failed, filename = " << fileName;
+            task->failed.store(true, std::memory_order_release);
+            task->OnBlockReady();
+            continue;
+        }
+
+        // lookup every block, fetch runs of missing blocks in one read
+        const uint64_t fileId = handler->file_->GetCurrentFileInfo().id;
+        uint64_t runStart = 0;
+        uint32_t runLength = 0;
+        auto flushRun = [&]() {
+            if (runLength == 0) {
+                return;
+            }
+            task->pending.fetch_add(1, std::memory_order_acq_rel);
+            FetchBlocks(handler->file_, cache, fileName, task,
+                        firstBlock + runStart, runStart, runLength);
+            runLength = 0;
+        };
+
+        for (uint64_t i = 0; i < task->blocks.size(); ++i) {
+            task->pending.fetch_add(1, std::memory_order_acq_rel);
+            auto res = cache->Lookup(
+                fileName, fileId, firstBlock + i, &task->blocks[i],
+                [task, i](bool ok, const butil::IOBuf& data) {
+                    if (ok) {
+                        task->blocks[i] = data;
+                    } else {
+                        task->failed.store(true, std::memory_order_release);
+                    }
+                    task->OnBlockReady();
+                });
+
+            if (res == SourceCache::LookupResult::kWait) {
+                flushRun();
+                continue;
+            }
+
+            // hit or fetch, no waiter is registered
+            task->pending.fetch_sub(1, std::memory_order_acq_rel);
+            if (res == SourceCache::LookupResult::kHit) {
+                flushRun();
+            } else {
+                if (runLength == 0) {
+                    runStart = i;
+                }
+                ++runLength;
+            }
+        }
+        flushRun();
+
+        FileInstance* file = handler->file_;
+        task->OnBlockReady();
+
+        if (cache->PrefetchBlocks() > 0) {
+            Prefetch(cache, file, fileName, lastBlock * blockSize);
+        }
+    }
+
+    return 0;
+}
+
+void SourceReader::Prefetch(const std::shared_ptr<SourceCache>& cache,
+                            FileInstance* file, const std::string& fileName,
+                            uint64_t endOffset) {
+    const uint64_t blockSize = cache->BlockSize();
+    const FInfo fileInfo = file->GetCurrentFileInfo();
+    const uint64_t fileLength = fileInfo.length;
+    const uint64_t firstBlock = endOffset / blockSize;
+    const uint64_t lastBlock =
+        std::min(firstBlock + cache->PrefetchBlocks(), fileLength / blockSize);
+
+    uint64_t runStart = 0;
+    uint32_t runLength = 0;
+    for (uint64_t index = firstBlock; index <= lastBlock; ++index) {
+        if (index < lastBlock &&
+            cache->Lookup(fileName, fileInfo.id, index, nullptr, nullptr) ==
+                SourceCache::LookupResult::kFetch) {
+            if (runLength == 0) {
+                runStart = index;
+            }
+            ++runLength;
+            continue;
+        }
+
+        if (runLength > 0) {
+            FetchBlocks(file, cache, fileName, nullptr, runStart, 0,
+                        runLength);
+            runLength = 0;
+        }
+    }
+}
+
 void SourceReader::Closefd() {
     const std::chrono::seconds sleepSec(
         fileOption_.ioOpt.closeFdThreadOption.fdCloseTimeInterval);
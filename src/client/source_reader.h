@@ -33,6 +33,7 @@
 #include <memory>
 
 #include "src/client/config_info.h"
+#include "src/client/source_cache.h"
 #include "src/common/interruptible_sleeper.h"
 
 namespace curve {
@@ -110,6 +111,32 @@ class SourceReader {
     ReadHandler* GetReadHandler(const std::string& fileName,
                                 const UserInfo& userInfo, MDSClient* mdsclient);
 
+    /**
+     * @brief read each request from the source separately
+     */
+    int ReadDirectly(const std::vector<RequestContext*>& reqCtxVec,
+                     const UserInfo& userInfo, MDSClient* mdsClient);
+
+    /**
+     * @brief read through the shared source cache, contiguous requests on
+     *        the same source file are merged into one block-aligned read
+     */
+    int ReadWithCache(const std::shared_ptr<SourceCache>& cache,
+                      const std::vector<RequestContext*>& reqCtxVec,
+                      const UserInfo& userInfo, MDSClient* mdsClient);
+
+    /**
+     * @brief read ahead blocks following [0, endOffset) into the cache
+     */
+    void Prefetch(const std::shared_ptr<SourceCache>& cache,
+                  FileInstance* file, const std::string& fileName,
+                  uint64_t endOffset);
+
+    /**
+     * @brief get the current source cache, nullptr if disabled
+     */
+    std::shared_ptr<SourceCache> GetCache();
+
  private:
     // the mutex lock for readHandlers_
     curve::common::RWLock rwLock_;
@@ -125,6 +152,12 @@ class SourceReader {
     std::unique_ptr<curve::common::InterruptibleSleeper> sleeper_;
 
     FileServiceOption fileOption_;
+
+    // shared cache of source data, nullptr if disabled.
+    // SetOption may replace it while reads are in flight, so readers and
+    // fetches hold their own reference taken under cacheMtx_
+    std::mutex cacheMtx_;
+    std::shared_ptr<SourceCache> cache_;
 };
 
 }  // namespace client
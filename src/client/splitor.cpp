@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 
+#include "src/client/client_metric.h"
 #include "src/client/file_instance.h"
 #include "src/client/mds_client.h"
 #include "src/client/metacache_struct.h"
@@ -65,6 +66,8 @@ int Splitor::IO2ChunkRequests(IOTracker* iotracker, MetaCache* metaCache,
         return SplitForNormal(iotracker, metaCache, targetlist, data, offset,
                               length, mdsclient, fileInfo, fEpoch);
     } else {
+        MetricHelper::InitStripeMetric(iotracker->fileMetric_,
+                                       fileInfo->stripeCount);
         return SplitForStripe(iotracker, metaCache, targetlist, data, offset,
                               length, mdsclient, fileInfo, fEpoch);
     }
@@ -195,6 +198,7 @@ bool Splitor::AssignInternal(IOTracker* iotracker, MetaCache* metaCache,
                 ctx->epoch_ = 0;
             }
             ctx->appliedindex_ = appliedindex_;
+            ctx->chunkIndex_ = chunkidx;
             ctx->sourceInfo_ =
                 CalcRequestSourceInfo(iotracker, metaCache, chunkidx);
         }
@@ -224,10 +228,19 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
                                    const FInfo* fileInfo,
                                    const FileEpoch_t *fEpoch,
                                    ChunkIndex chunkidx) {
-    SegmentInfo segmentInfo;
-    LIBCURVE_ERROR errCode = mdsClient->GetOrAllocateSegment(
-        allocateIfNotExist, offset, fileInfo, fEpoch, &segmentInfo);
+    // prefetched segments are locked until their chunk infos are cached,
+    // so that they can't be discarded in the meantime
+    std::vector<FileSegment*> prefetchSegments;
+    if (allocateIfNotExist) {
+        LockPrefetchSegments(offset, metaCache, fileInfo, &prefetchSegments);
+    }
+
+    std::vector<SegmentInfo> segmentInfos;
+    LIBCURVE_ERROR errCode = mdsClient->GetOrAllocateSegments(
+        allocateIfNotExist, offset, prefetchSegments.size() + 1, fileInfo,
+        fEpoch, &segmentInfos);
 
+    bool ret = true;
     if (errCode != LIBCURVE_ERROR::OK) {
         if (errCode == LIBCURVE_ERROR::NOT_ALLOCATE) {
             // this chunkIdInfo(0, 0, 0) identify
@@ -235,32 +248,88 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
             ChunkIDInfo chunkIdInfo(0, 0, 0);
             chunkIdInfo.chunkExist = false;
             metaCache->UpdateChunkInfoByIndex(chunkidx, chunkIdInfo);
-            return true;
-        }
-        if (errCode == LIBCURVE_ERROR::EPOCH_TOO_OLD) {
+        } else if (errCode == LIBCURVE_ERROR::EPOCH_TOO_OLD) {
             LOG(WARNING) << "GetOrAllocateSegmen epoch too old, filename: "
                          << fileInfo->filename << ", offset: " << offset;
-            return false;
+            ret = false;
         } else {
             LOG(ERROR) << "GetOrAllocateSegmen failed, filename: "
                        << fileInfo->filename << ", offset: " << offset;
-            return false;
+            ret = false;
+        }
+    } else {
+        ret = UpdateSegmentInfo(segmentInfos[0], mdsClient, metaCache,
+                                fileInfo);
+        for (size_t i = 1; ret && i < segmentInfos.size(); ++i) {
+            // failure of prefetched segments doesn't affect current io
+            UpdateSegmentInfo(segmentInfos[i], mdsClient, metaCache,
+                              fileInfo);
         }
     }
 
-    const auto chunksize = fileInfo->chunksize;
-    uint32_t count = 0;
-    for (const auto& chunkIdInfo : segmentInfo.chunkvec) {
-        uint64_t chunkIdx =
-            (segmentInfo.startoffset + count * chunksize) / chunksize;
-        metaCache->UpdateChunkInfoByIndex(chunkIdx, chunkIdInfo);
-        ++count;
+    for (auto* segment : prefetchSegments) {
+        segment->ReleaseLock();
+    }
+
+    return ret;
+}
+
+void Splitor::LockPrefetchSegments(uint64_t offset,
+                                   MetaCache* metaCache,
+                                   const FInfo* fileInfo,
+                                   std::vector<FileSegment*>* segments) {
+    const uint32_t prefetchNum = iosplitopt_.segmentPrefetchNum;
+    const uint64_t segmentSize = fileInfo->segmentsize;
+    const uint64_t chunkSize = fileInfo->chunksize;
+    if (prefetchNum == 0 || segmentSize == 0 || chunkSize == 0) {
+        return;
+    }
+
+    const SegmentIndex segmentIndex = offset / segmentSize;
+    const uint64_t chunksPerSegment = segmentSize / chunkSize;
+    if (segmentIndex == 0) {
+        return;
     }
 
+    // only prefetch when previous segment is allocated, which means
+    // the file is being written sequentially
+    ChunkIDInfo chunkIdInfo;
+    MetaCacheErrorType errCode = metaCache->GetChunkInfoByIndex(
+        segmentIndex * chunksPerSegment - 1, &chunkIdInfo);
+    if (errCode != MetaCacheErrorType::OK || !chunkIdInfo.chunkExist) {
+        return;
+    }
+
+    for (uint32_t i = 1; i <= prefetchNum; ++i) {
+        SegmentIndex next = segmentIndex + i;
+        if ((next + 1) * segmentSize > fileInfo->length) {
+            break;
+        }
+
+        errCode = metaCache->GetChunkInfoByIndex(next * chunksPerSegment,
+                                                 &chunkIdInfo);
+        if (!NeedGetOrAllocateSegment(errCode, OpType::WRITE, chunkIdInfo,
+                                      metaCache)) {
+            break;
+        }
+
+        // segment may be being discarded, skip it
+        FileSegment* segment = metaCache->GetFileSegment(next);
+        if (!segment->TryAcquireReadLock()) {
+            break;
+        }
+        segments->push_back(segment);
+    }
+}
+
+bool Splitor::UpdateSegmentInfo(const SegmentInfo& segmentInfo,
+                                MDSClient* mdsClient,
+                                MetaCache* metaCache,
+                                const FInfo* fileInfo) {
     std::vector<CopysetInfo<ChunkServerID>> copysetInfos;
-    errCode = mdsClient->GetServerList(segmentInfo.lpcpIDInfo.lpid,
-                                       segmentInfo.lpcpIDInfo.cpidVec,
-                                       &copysetInfos);
+    LIBCURVE_ERROR errCode = mdsClient->GetServerList(
+        segmentInfo.lpcpIDInfo.lpid, segmentInfo.lpcpIDInfo.cpidVec,
+        &copysetInfos);
 
     if (errCode == LIBCURVE_ERROR::FAILED) {
         std::string failedCopysets;
@@ -288,6 +357,17 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
                                      copysetInfo.cpid_, copysetInfo);
     }
 
+    // chunk infos are cached after their copysets, otherwise io to these
+    // chunks can't find the copyset
+    const auto chunksize = fileInfo->chunksize;
+    uint32_t count = 0;
+    for (const auto& chunkIdInfo : segmentInfo.chunkvec) {
+        uint64_t chunkIdx =
+            (segmentInfo.startoffset + count * chunksize) / chunksize;
+        metaCache->UpdateChunkInfoByIndex(chunkIdx, chunkIdInfo);
+        ++count;
+    }
+
     return true;
 }
 
@@ -373,6 +453,7 @@ int Splitor::SplitForStripe(IOTracker* iotracker, MetaCache* metaCache,
         uint64_t curChunkOffset = blockInChunkStartOff + blockOff;
         uint64_t requestLength = std::min((stripeUnit - blockOff), left);
 
+        const size_t prevSize = targetlist->size();
         if (!AssignInternal(iotracker, metaCache, targetlist, data,
                             curChunkOffset, requestLength, mdsclient,
                             fileInfo, fEpoch, curChunkIndex)) {
@@ -386,6 +467,10 @@ int Splitor::SplitForStripe(IOTracker* iotracker, MetaCache* metaCache,
             return -1;
         }
 
+        for (size_t i = prevSize; i < targetlist->size(); ++i) {
+            (*targetlist)[i]->stripePos_ = static_cast<int32_t>(stripepos);
+        }
+
         left -= requestLength;
         cur += requestLength;
     }
@@ -135,6 +135,24 @@ class Splitor {
                                      const FileEpoch_t *fEpoch,
                                      ChunkIndex chunkidx);
 
+    /**
+     * 顺序写时锁住需要预分配的后续segment，前一个segment已分配时认为是顺序写
+     * @param: offset 当前需要分配的segment内的偏移
+     * @param[out]: segments 已经加上读锁的后续segment，由调用者释放
+     */
+    static void LockPrefetchSegments(uint64_t offset,
+                                     MetaCache* metaCache,
+                                     const FInfo* fileInfo,
+                                     std::vector<FileSegment*>* segments);
+
+    /**
+     * 获取segment所在copyset的信息，并更新到metacache
+     */
+    static bool UpdateSegmentInfo(const SegmentInfo& segmentInfo,
+                                  MDSClient* mdsClient,
+                                  MetaCache* metaCache,
+                                  const FInfo* fileInfo);
+
     static int SplitForNormal(IOTracker* iotracker, MetaCache* metaCache,
                               std::vector<RequestContext*>* targetlist,
                               butil::IOBuf* data, off_t offset, size_t length,
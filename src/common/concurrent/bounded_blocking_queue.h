@@ -131,6 +131,24 @@ class BoundedBlockingDeque : public Uncopyable {
         return back;
     }
 
+    /**
+     * 非阻塞地取出队首元素，仅当队列非空且队首元素满足pred时才会取出
+     * @param pred: 判断队首元素是否可以取出
+     * @param[out] out: 取出的队首元素
+     * @return 取出成功返回true，否则返回false
+     */
+    template <typename Pred>
+    bool TryTakeFrontIf(Pred pred, T *out) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (deque_.empty() || !pred(deque_.front())) {
+            return false;
+        }
+        *out = std::move(deque_.front());
+        deque_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
     bool Empty() const {
         std::lock_guard<std::mutex> guard(mutex_);
         return deque_.empty();
@@ -32,6 +32,27 @@ std::string LocationOperator::GenerateS3Location(
     return location;
 }
 
+std::string LocationOperator::GenerateS3BlockLocation(
+    const std::string& objectName) {
+    std::string location(objectName);
+    location.append(kOriginTypeSeprator).append(S3_BLOCK_TYPE);
+    return location;
+}
+
+std::string LocationOperator::GenerateLocalLocation(
+    const std::string& objectName) {
+    std::string location(objectName);
+    location.append(kOriginTypeSeprator).append(LOCAL_TYPE);
+    return location;
+}
+
+std::string LocationOperator::GenerateLocalBlockLocation(
+    const std::string& objectName) {
+    std::string location(objectName);
+    location.append(kOriginTypeSeprator).append(LOCAL_BLOCK_TYPE);
+    return location;
+}
+
 std::string LocationOperator::GenerateCurveLocation(
     const std::string& fileName, off_t offset) {
     std::string location(fileName);
@@ -62,6 +83,12 @@ OriginType LocationOperator::ParseLocation(
         type = OriginType::CurveOrigin;
     } else if (typeStr.compare(S3_TYPE) == 0) {
         type = OriginType::S3Origin;
+    } else if (typeStr.compare(S3_BLOCK_TYPE) == 0) {
+        type = OriginType::S3BlockOrigin;
+    } else if (typeStr.compare(LOCAL_TYPE) == 0) {
+        type = OriginType::LocalOrigin;
+    } else if (typeStr.compare(LOCAL_BLOCK_TYPE) == 0) {
+        type = OriginType::LocalBlockOrigin;
     }
 
     return type;
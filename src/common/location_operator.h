@@ -31,6 +31,9 @@ namespace common {
 
 const char CURVE_TYPE[] = "cs";
 const char S3_TYPE[] = "s3";
+const char S3_BLOCK_TYPE[] = "s3block";
+const char LOCAL_TYPE[] = "local";
+const char LOCAL_BLOCK_TYPE[] = "localblock";
 const char kOriginTypeSeprator[] = "@";
 const char kOriginPathSeprator[] = ":";
 
@@ -38,6 +41,9 @@ enum class OriginType {
     S3Origin = 0,
     CurveOrigin = 1,
     InvalidOrigin = 2,
+    S3BlockOrigin = 3,
+    LocalOrigin = 4,
+    LocalBlockOrigin = 5,
 };
 
 class LocationOperator {
@@ -49,6 +55,28 @@ class LocationOperator {
      * @return:生成的location
      */
     static std::string GenerateS3Location(const std::string& objectName);
+    /**
+     * 生成分块存储的s3 location，object中保存的是数据块列表
+     * location格式:${objectname}@s3block
+     * @param objectName:s3上object的名称
+     * @return:生成的location
+     */
+    static std::string GenerateS3BlockLocation(const std::string& objectName);
+    /**
+     * 生成local快照数据存储的location，chunkserver从挂载的共享目录读取
+     * location格式:${objectname}@local
+     * @param objectName:快照数据对象的名称
+     * @return:生成的location
+     */
+    static std::string GenerateLocalLocation(const std::string& objectName);
+    /**
+     * 生成local快照数据存储中分块存储的location，对象中保存的是数据块列表
+     * location格式:${objectname}@localblock
+     * @param objectName:快照数据对象的名称
+     * @return:生成的location
+     */
+    static std::string GenerateLocalBlockLocation(
+        const std::string& objectName);
     /**
      * 生成curve的location
      * location格式:${filename}:${offset}@cs
@@ -59,6 +87,9 @@ class LocationOperator {
      * 解析数据源的位置信息
      * location格式:
      * s3示例：${objectname}@s3
+     * s3分块示例：${objectname}@s3block
+     * local示例：${objectname}@local
+     * local分块示例：${objectname}@localblock
      * curve示例：${filename}:${offset}@cs
      *
      * @param location[in]:数据源的位置，其格式为originPath@originType
@@ -67,11 +67,19 @@ const char DISCARDSEGMENTKEYEND[] = "14";
 const char BLOCKSIZEKEY[] = "15blocksize";
 const char CHUNKSIZEKEY[] = "15chunksize";
 
+const char SEGMENTALLOCCHANGEKEYPREFIX[] = "16";
+const char SEGMENTALLOCCHANGEKEYEND[] = "17";
+const char SEGMENTALLOCJOURNALKEY[] = "17segmentallocjournal";
+
+const char SNAPBLOCKREFKEYPREFIX[] = "18";
+const char SNAPBLOCKREFKEYEND[] = "19";
+
 // TODO(hzsunjianliang): if use single prefix for snapshot file?
 const int COMMON_PREFIX_LENGTH = 2;
 const int LEADER_PREFIX_LENGTH = 8;
 const int SEGMENTKEYLEN = 18;
 const int DISCARDSEGMENTKEYLEN = 26;
+const int SEGMENTALLOCCHANGEKEYLEN = 18;
 
 constexpr int kDefaultPoolsetId = 1;
 constexpr char kDefaultPoolsetName[] = "default";
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/common/snapshotclone/snapshot_block.h"
+
+#include <butil/sha1.h>
+#include <butil/strings/string_number_conversions.h>
+#include <butil/third_party/snappy/snappy.h>
+#include <zlib.h>
+
+#include <cstring>
+
+namespace curve {
+namespace snapshotcloneserver {
+
+const char* kSnapshotBlockPrefix = "snapblock/";
+
+bool SnapshotBlockCodec::IsZeroBlock(const char *buf, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    return buf[0] == 0 && std::memcmp(buf, buf + 1, len - 1) == 0;
+}
+
+std::string SnapshotBlockCodec::CalcBlockHash(const char *buf, size_t len) {
+    unsigned char hash[butil::kSHA1Length];
+    butil::SHA1HashBytes(reinterpret_cast<const unsigned char*>(buf),
+                         len, hash);
+    return butil::HexEncode(hash, butil::kSHA1Length);
+}
+
+std::string SnapshotBlockCodec::BlockObjectKey(const ChunkBlock &block) {
+    return std::string(kSnapshotBlockPrefix) + block.hash() + "." +
+           CompressTypeName(block.compresstype());
+}
+
+bool SnapshotBlockCodec::Compress(BlockCompressType type,
+                                  const char *buf,
+                                  size_t len,
+                                  std::string *out) {
+    switch (type) {
+        case BLOCK_COMPRESS_NONE:
+            out->assign(buf, len);
+            return true;
+        case BLOCK_COMPRESS_SNAPPY:
+            butil::snappy::Compress(buf, len, out);
+            return true;
+        case BLOCK_COMPRESS_ZLIB: {
+            uLongf outLen = compressBound(len);
+            out->resize(outLen);
+            int ret = compress2(reinterpret_cast<Bytef*>(&(*out)[0]),
+                                &outLen,
+                                reinterpret_cast<const Bytef*>(buf),
+                                len,
+                                Z_BEST_SPEED);
+            if (ret != Z_OK) {
+                return false;
+            }
+            out->resize(outLen);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+size_t SnapshotBlockCodec::MaxStoreLength(BlockCompressType type,
+                                          size_t len) {
+    switch (type) {
+        case BLOCK_COMPRESS_SNAPPY:
+            return butil::snappy::MaxCompressedLength(len);
+        case BLOCK_COMPRESS_ZLIB:
+            return compressBound(len);
+        default:
+            return len;
+    }
+}
+
+bool SnapshotBlockCodec::Decompress(BlockCompressType type,
+                                    const std::string &in,
+                                    size_t len,
+                                    char *out) {
+    return Decompress(type, in.data(), in.size(), len, out);
+}
+
+bool SnapshotBlockCodec::Decompress(BlockCompressType type,
+                                    const char *in,
+                                    size_t inLen,
+                                    size_t len,
+                                    char *out) {
+    switch (type) {
+        case BLOCK_COMPRESS_NONE:
+            if (inLen != len) {
+                return false;
+            }
+            std::memcpy(out, in, len);
+            return true;
+        case BLOCK_COMPRESS_SNAPPY: {
+            size_t outLen = 0;
+            if (!butil::snappy::GetUncompressedLength(
+                    in, inLen, &outLen) || outLen != len) {
+                return false;
+            }
+            return butil::snappy::RawUncompress(in, inLen, out);
+        }
+        case BLOCK_COMPRESS_ZLIB: {
+            uLongf outLen = len;
+            int ret = uncompress(reinterpret_cast<Bytef*>(out),
+                                 &outLen,
+                                 reinterpret_cast<const Bytef*>(in),
+                                 inLen);
+            return ret == Z_OK && outLen == len;
+        }
+        default:
+            return false;
+    }
+}
+
+bool SnapshotBlockCodec::ParseCompressType(const std::string &str,
+                                           BlockCompressType *type) {
+    if (str == "none") {
+        *type = BLOCK_COMPRESS_NONE;
+    } else if (str == "snappy") {
+        *type = BLOCK_COMPRESS_SNAPPY;
+    } else if (str == "zlib") {
+        *type = BLOCK_COMPRESS_ZLIB;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string SnapshotBlockCodec::CompressTypeName(BlockCompressType type) {
+    switch (type) {
+        case BLOCK_COMPRESS_NONE:
+            return "none";
+        case BLOCK_COMPRESS_SNAPPY:
+            return "snappy";
+        case BLOCK_COMPRESS_ZLIB:
+            return "zlib";
+        default:
+            return "unknown";
+    }
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
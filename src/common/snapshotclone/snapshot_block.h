@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_COMMON_SNAPSHOTCLONE_SNAPSHOT_BLOCK_H_
+#define SRC_COMMON_SNAPSHOTCLONE_SNAPSHOT_BLOCK_H_
+
+#include <cstddef>
+#include <string>
+
+#include "proto/snapshotcloneserver.pb.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+// 快照数据块对象名前缀
+extern const char* kSnapshotBlockPrefix;
+
+/**
+ * @brief CHUNK_DATA_BLOCK格式快照数据块的编解码
+ *        快照服务器转储时使用，chunkserver从快照克隆时读取
+ */
+class SnapshotBlockCodec {
+ public:
+    /**
+     * @brief 判断数据块是否全零，全零块不存储对象
+     */
+    static bool IsZeroBlock(const char *buf, size_t len);
+
+    /**
+     * @brief 计算数据块内容的sha1，返回hex字符串
+     */
+    static std::string CalcBlockHash(const char *buf, size_t len);
+
+    /**
+     * @brief 数据块对象名 ${prefix}${hash}.${compressType}
+     *        压缩方式不同的相同内容存储为不同对象
+     */
+    static std::string BlockObjectKey(const ChunkBlock &block);
+
+    /**
+     * @brief 压缩数据块
+     *
+     * @param type 压缩方式
+     * @param buf 数据块内容
+     * @param len 数据块长度
+     * @param[out] out 压缩后数据
+     *
+     * @return 成功返回true，失败返回false
+     */
+    static bool Compress(BlockCompressType type,
+                         const char *buf,
+                         size_t len,
+                         std::string *out);
+
+    /**
+     * @brief 数据块对象长度的上限，读取数据块对象时使用
+     */
+    static size_t MaxStoreLength(BlockCompressType type, size_t len);
+
+    /**
+     * @brief 解压数据块
+     *
+     * @param type 压缩方式
+     * @param in 数据块对象内容
+     * @param len 数据块未压缩长度
+     * @param[out] out 解压后数据，长度为len
+     *
+     * @return 成功返回true，失败或长度不匹配返回false
+     */
+    static bool Decompress(BlockCompressType type,
+                           const std::string &in,
+                           size_t len,
+                           char *out);
+
+    /**
+     * @brief 解压数据块，输入可以直接是内存映射中的数据块对象
+     *
+     * @param type 压缩方式
+     * @param in 数据块对象内容
+     * @param inLen 数据块对象长度
+     * @param len 数据块未压缩长度
+     * @param[out] out 解压后数据，长度为len
+     *
+     * @return 成功返回true，失败或长度不匹配返回false
+     */
+    static bool Decompress(BlockCompressType type,
+                           const char *in,
+                           size_t inLen,
+                           size_t len,
+                           char *out);
+
+    /**
+     * @brief 解析配置中的压缩方式: none/snappy/zlib
+     */
+    static bool ParseCompressType(const std::string &str,
+                                  BlockCompressType *type);
+
+    static std::string CompressTypeName(BlockCompressType type);
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_COMMON_SNAPSHOTCLONE_SNAPSHOT_BLOCK_H_
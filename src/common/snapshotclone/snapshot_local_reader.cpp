@@ -0,0 +1,282 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/common/snapshotclone/snapshot_local_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "src/common/crc32.h"
+#include "src/common/snapshotclone/snapshot_block.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+const char SnapshotLocalLayout::kMetaDir[] = "/meta/";
+const char SnapshotLocalLayout::kChunkDir[] = "/chunk/";
+const char SnapshotLocalLayout::kPackDir[] = "/pack/";
+const char SnapshotLocalLayout::kTmpDir[] = "/tmp/";
+const char SnapshotLocalLayout::kPackSuffix[] = ".pack";
+const char SnapshotLocalLayout::kPackIdxSuffix[] = ".idx";
+
+std::string SnapshotLocalLayout::EncodeFileName(const std::string &key) {
+    std::string out;
+    out.reserve(key.size());
+    for (char c : key) {
+        if (c == '%') {
+            out += "%25";
+        } else if (c == '/') {
+            out += "%2F";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string SnapshotLocalLayout::ChunkPath(const std::string &root,
+                                           const std::string &chunkKey) {
+    return root + kChunkDir + EncodeFileName(chunkKey);
+}
+
+std::string SnapshotLocalLayout::PackPath(const std::string &root,
+                                          uint64_t packId) {
+    return root + kPackDir + std::to_string(packId) + kPackSuffix;
+}
+
+std::string SnapshotLocalLayout::PackIdxPath(const std::string &root,
+                                             uint64_t packId) {
+    return root + kPackDir + std::to_string(packId) + kPackIdxSuffix;
+}
+
+namespace {
+
+// 读取完整的len字节，NFS上的pread可能返回不足的长度
+int PreadFull(int fd, char *buf, uint64_t offset, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t ret = ::pread(fd, buf + done, len - done, offset + done);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (ret == 0) {
+            // 超出文件长度
+            return -1;
+        }
+        done += ret;
+    }
+    return 0;
+}
+
+}  // namespace
+
+SnapshotLocalReader::PackMapping::~PackMapping() {
+    if (addr != nullptr) {
+        ::munmap(addr, size);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+SnapshotLocalReader::SnapshotLocalReader(const std::string &rootPath,
+                                         uint32_t maxMappedPacks)
+    : rootPath_(rootPath),
+      maxMappedPacks_(maxMappedPacks > 0 ? maxMappedPacks : 1) {}
+
+int SnapshotLocalReader::ReadChunk(const std::string &chunkKey,
+                                   uint64_t offset, size_t len, char *buf) {
+    std::string path = SnapshotLocalLayout::ChunkPath(rootPath_, chunkKey);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "Open snapshot chunk file fail, errno = " << errno
+                   << ", path = " << path;
+        return -1;
+    }
+    int ret = PreadFull(fd, buf, offset, len);
+    ::close(fd);
+    if (ret < 0) {
+        LOG(ERROR) << "Read snapshot chunk file fail, ret = " << ret
+                   << ", path = " << path
+                   << ", offset = " << offset
+                   << ", len = " << len;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotLocalReader::ReadChunk(const std::string &chunkKey,
+                                   std::string *data) {
+    std::string path = SnapshotLocalLayout::ChunkPath(rootPath_, chunkKey);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "Open snapshot chunk file fail, errno = " << errno
+                   << ", path = " << path;
+        return -1;
+    }
+    struct stat info;
+    int ret = ::fstat(fd, &info);
+    if (ret == 0) {
+        data->resize(info.st_size);
+        ret = PreadFull(fd, &(*data)[0], 0, info.st_size);
+    }
+    ::close(fd);
+    if (ret < 0) {
+        LOG(ERROR) << "Read snapshot chunk file fail, ret = " << ret
+                   << ", path = " << path;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotLocalReader::ReadBlock(const ChunkBlock &block, size_t blockSize,
+                                   char *out) {
+    if (!block.has_packid() || !block.has_packoffset() ||
+        !block.has_storelength() || !block.has_storecrc()) {
+        LOG(ERROR) << "Block has no pack location, blockKey = "
+                   << SnapshotBlockCodec::BlockObjectKey(block);
+        return -1;
+    }
+    uint64_t end = block.packoffset() + block.storelength();
+    PackMappingPtr mapping = GetPackMapping(block.packid(), end);
+    if (mapping == nullptr) {
+        return -1;
+    }
+
+    // 映射由mapping持有，读取期间不会被释放
+    const char *store = nullptr;
+    std::string buf;
+    if (mapping->addr != nullptr && end <= mapping->size) {
+        store = mapping->addr + block.packoffset();
+    } else {
+        buf.resize(block.storelength());
+        int ret = PreadFull(mapping->fd, &buf[0], block.packoffset(),
+                            block.storelength());
+        if (ret < 0) {
+            LOG(ERROR) << "Read pack file fail, ret = " << ret
+                       << ", packId = " << block.packid()
+                       << ", offset = " << block.packoffset();
+            DropPackMapping(block.packid(), mapping);
+            return -1;
+        }
+        store = buf.data();
+    }
+    if (curve::common::CRC32(store, block.storelength()) !=
+        block.storecrc()) {
+        // 缓存的映射可能已过期，下次重新打开
+        LOG(ERROR) << "Data block crc mismatch, packId = " << block.packid()
+                   << ", blockKey = "
+                   << SnapshotBlockCodec::BlockObjectKey(block);
+        DropPackMapping(block.packid(), mapping);
+        return -1;
+    }
+    if (!SnapshotBlockCodec::Decompress(block.compresstype(), store,
+            block.storelength(), blockSize, out)) {
+        LOG(ERROR) << "Decompress data block fail, blockKey = "
+                   << SnapshotBlockCodec::BlockObjectKey(block);
+        return -1;
+    }
+    return 0;
+}
+
+SnapshotLocalReader::PackMappingPtr SnapshotLocalReader::GetPackMapping(
+    uint64_t packId, uint64_t end) {
+    {
+        std::lock_guard<std::mutex> guard(mtx_);
+        auto it = mappings_.find(packId);
+        if (it != mappings_.end() && end <= it->second->size) {
+            lru_.remove(packId);
+            lru_.push_back(packId);
+            return it->second;
+        }
+    }
+
+    // 打开和映射文件不持锁，并发打开同一个pack时以后放入的为准
+    PackMappingPtr mapping = OpenPackMapping(packId);
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto it = mappings_.find(packId);
+    if (it != mappings_.end()) {
+        lru_.remove(packId);
+    }
+    mappings_[packId] = mapping;
+    lru_.push_back(packId);
+    while (mappings_.size() > maxMappedPacks_) {
+        // 被淘汰的映射由正在读取的请求释放
+        mappings_.erase(lru_.front());
+        lru_.pop_front();
+    }
+    return mapping;
+}
+
+SnapshotLocalReader::PackMappingPtr SnapshotLocalReader::OpenPackMapping(
+    uint64_t packId) {
+    std::string path = SnapshotLocalLayout::PackPath(rootPath_, packId);
+    auto mapping = std::make_shared<PackMapping>();
+    mapping->fd = ::open(path.c_str(), O_RDONLY);
+    if (mapping->fd < 0) {
+        LOG(ERROR) << "Open pack file fail, errno = " << errno
+                   << ", path = " << path;
+        return nullptr;
+    }
+    struct stat info;
+    if (::fstat(mapping->fd, &info) < 0) {
+        LOG(ERROR) << "Fstat pack file fail, errno = " << errno
+                   << ", path = " << path;
+        return nullptr;
+    }
+    mapping->size = info.st_size;
+    if (mapping->size > 0) {
+        void *addr = ::mmap(nullptr, mapping->size, PROT_READ, MAP_SHARED,
+                            mapping->fd, 0);
+        if (addr != MAP_FAILED) {
+            mapping->addr = static_cast<char*>(addr);
+        } else {
+            LOG(WARNING) << "mmap pack file fail, read with pread"
+                         << ", errno = " << errno
+                         << ", path = " << path;
+        }
+    }
+    return mapping;
+}
+
+void SnapshotLocalReader::DropPackMapping(uint64_t packId,
+                                          const PackMappingPtr &mapping) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto it = mappings_.find(packId);
+    if (it != mappings_.end() && it->second == mapping) {
+        mappings_.erase(it);
+        lru_.remove(packId);
+    }
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_COMMON_SNAPSHOTCLONE_SNAPSHOT_LOCAL_READER_H_
+#define SRC_COMMON_SNAPSHOTCLONE_SNAPSHOT_LOCAL_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "proto/snapshotcloneserver.pb.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief local快照数据存储的目录结构，快照服务器写入，
+ *        chunkserver挂载同一目录后据此读取快照数据
+ *  - meta/  快照的chunk索引数据，每个对象一个文件
+ *  - chunk/ CHUNK_DATA_RAW格式的chunk数据或CHUNK_DATA_BLOCK格式的
+ *           数据块列表，每个对象一个文件
+ *  - pack/  数据块，追加写入大的pack文件
+ *  - tmp/   转储中的chunk和待重命名的对象
+ */
+class SnapshotLocalLayout {
+ public:
+    static const char kMetaDir[];
+    static const char kChunkDir[];
+    static const char kPackDir[];
+    static const char kTmpDir[];
+    static const char kPackSuffix[];
+    static const char kPackIdxSuffix[];
+
+    /**
+     * @brief 对象名转换为文件名，转义其中的'/'
+     */
+    static std::string EncodeFileName(const std::string &key);
+
+    /**
+     * @brief chunk数据或数据块列表对象的文件路径
+     */
+    static std::string ChunkPath(const std::string &root,
+                                 const std::string &chunkKey);
+
+    static std::string PackPath(const std::string &root, uint64_t packId);
+
+    static std::string PackIdxPath(const std::string &root, uint64_t packId);
+};
+
+/**
+ * @brief 读取local快照数据存储中的快照数据，chunkserver从快照克隆/恢复时使用
+ * @detail
+ *  chunk数据文件直接pread到请求的缓冲区。
+ *  pack文件只追加写入、不会截断，其中的数据块全部不再被引用后才整个删除，
+ *  而正在克隆/恢复的快照引用的数据块不会被删除，
+ *  因此按打开时的长度只读映射整个pack文件，数据块直接从映射中解压，
+ *  不再经过系统调用和额外的拷贝。
+ *  读取期间持有映射的引用，淘汰或重新映射后由最后一个读取者释放；
+ *  数据块超出已映射的范围(pack文件仍在写入)时重新映射，
+ *  映射失败时退化为pread读取。
+ */
+class SnapshotLocalReader {
+ public:
+    /**
+     * @param rootPath 挂载的local快照数据存储根目录
+     * @param maxMappedPacks 最多同时映射的pack文件数
+     */
+    SnapshotLocalReader(const std::string &rootPath,
+                        uint32_t maxMappedPacks);
+
+    virtual ~SnapshotLocalReader() {}
+
+    /**
+     * @brief 读取chunk数据或数据块列表对象中的一段数据
+     *
+     * @param chunkKey 对象名
+     * @param offset 数据在对象中的偏移
+     * @param len 数据长度，超出对象长度时失败
+     * @param[out] buf 读取的数据
+     *
+     * @return 0 成功/ -1 失败
+     */
+    virtual int ReadChunk(const std::string &chunkKey, uint64_t offset,
+                          size_t len, char *buf);
+
+    /**
+     * @brief 读取整个数据块列表对象
+     *
+     * @param chunkKey 对象名
+     * @param[out] data 对象内容
+     *
+     * @return 0 成功/ -1 失败
+     */
+    virtual int ReadChunk(const std::string &chunkKey, std::string *data);
+
+    /**
+     * @brief 读取数据块并解压，校验数据块对象的crc
+     *
+     * @param block 带有pack文件位置的数据块信息
+     * @param blockSize 数据块未压缩的长度
+     * @param[out] out 解压后的数据块，长度为blockSize
+     *
+     * @return 0 成功/ -1 失败
+     */
+    virtual int ReadBlock(const ChunkBlock &block, size_t blockSize,
+                          char *out);
+
+ private:
+    struct PackMapping {
+        PackMapping() : fd(-1), addr(nullptr), size(0) {}
+        ~PackMapping();
+
+        int fd;
+        // 映射失败时为nullptr，通过fd读取
+        char *addr;
+        // 映射时pack文件的长度
+        uint64_t size;
+    };
+    using PackMappingPtr = std::shared_ptr<PackMapping>;
+
+    /**
+     * @brief 获取覆盖[0, end)的映射，返回的映射在持有期间不会被释放
+     */
+    PackMappingPtr GetPackMapping(uint64_t packId, uint64_t end);
+
+    PackMappingPtr OpenPackMapping(uint64_t packId);
+
+    /**
+     * @brief 丢弃缓存的映射，下次读取时重新打开
+     */
+    void DropPackMapping(uint64_t packId, const PackMappingPtr &mapping);
+
+ private:
+    std::string rootPath_;
+    uint32_t maxMappedPacks_;
+
+    std::mutex mtx_;
+    std::map<uint64_t, PackMappingPtr> mappings_;
+    // 最近使用的pack在末尾
+    std::list<uint64_t> lru_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_COMMON_SNAPSHOTCLONE_SNAPSHOT_LOCAL_READER_H_
@@ -96,6 +96,31 @@ int EtcdClientImp::Get(const std::string &key, std::string *out) {
     return errCode;
 }
 
+int EtcdClientImp::GetWithModRevision(const std::string &key,
+    std::string *out, int64_t *modRevision) {
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientGet_return res = EtcdClientGet(
+            timeout_, const_cast<char*>(key.c_str()), key.size());
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *out = std::string(res.r1, res.r1 + res.r2);
+            *modRevision = res.r4;
+            free(res.r1);
+        } else if (res.r0 == EtcdErrCode::EtcdKeyNotExist) {
+            *modRevision = 0;
+        } else {
+            LOG(WARNING) << "get key err: " << res.r0
+                         << ", retry:" << retry << ", needRetry:" << needRetry;
+        }
+    } while (needRetry && ++retry <= retryTimes_);
+
+    return errCode;
+}
+
 int EtcdClientImp::List(const std::string& startKey, const std::string& endKey,
                         std::vector<std::string>* out) {
     assert(out != nullptr);
@@ -207,6 +232,52 @@ int EtcdClientImp::TxnN(const std::vector<Operation> &ops) {
     return errCode;
 }
 
+int EtcdClientImp::TxnNRewithRevision(const std::vector<Operation> &ops,
+    int64_t *revision) {
+    if (ops.empty()) {
+        LOG(ERROR) << "do not support empty Txn";
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientTxnNRewithRevision_return res = EtcdClientTxnNRewithRevision(
+            timeout_, const_cast<Operation*>(ops.data()), ops.size());
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *revision = res.r1;
+        }
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+    } while (needRetry && ++retry <= retryTimes_);
+    return errCode;
+}
+
+int EtcdClientImp::TxnNWithCompare(const std::vector<Compare> &cmps,
+    const std::vector<Operation> &ops, int64_t *revision) {
+    if (cmps.empty() || ops.empty()) {
+        LOG(ERROR) << "do not support Txn without compares or operations";
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientTxnNWithCompare_return res = EtcdClientTxnNWithCompare(
+            timeout_, const_cast<Compare*>(cmps.data()), cmps.size(),
+            const_cast<Operation*>(ops.data()), ops.size());
+        if (res.r0 == EtcdErrCode::EtcdOK ||
+            res.r0 == EtcdErrCode::EtcdTxnCompareFailed) {
+            *revision = res.r1;
+        }
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+    } while (needRetry && ++retry <= retryTimes_);
+    return errCode;
+}
+
 int EtcdClientImp::GetCurrentRevision(int64_t *revision) {
     bool needRetry = false;
     int retry = 0;
@@ -338,6 +409,7 @@ bool EtcdClientImp::NeedRetry(int errCode) {
         case EtcdErrCode::EtcdUnauthenticated:
         case EtcdErrCode::EtcdTxnUnkownOp:
         case EtcdErrCode::EtcdKeyNotExist:
+        case EtcdErrCode::EtcdTxnCompareFailed:
             return false;
 
         case EtcdErrCode::EtcdDeadlineExceeded:
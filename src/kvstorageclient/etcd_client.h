@@ -67,6 +67,19 @@ class KVStorageClient {
      */
     virtual int Get(const std::string &key, std::string *out) = 0;
 
+    /**
+     * @brief GetWithModRevision Get the value and the mod revision of
+     *        the specified key
+     *
+     * @param[in] key
+     * @param[out] value
+     * @param[out] modRevision Version number of the last modification of key
+     *
+     * @return error code
+     */
+    virtual int GetWithModRevision(const std::string &key, std::string *out,
+        int64_t *modRevision) = 0;
+
     /**
      * @brief List Get all the values ​​between [startKey, endKey)
      *
@@ -120,6 +133,18 @@ class KVStorageClient {
     */
     virtual int TxnN(const std::vector<Operation> &ops) = 0;
 
+    /**
+     * @brief TxnNRewithRevision Operate transactions in the order of
+     *        ops[0] ops[1] ..., any number of operations is supported
+     *
+     * @param[in] ops Operation set
+     * @param[out] revision Version number of the transaction
+     *
+     * @return error code
+     */
+    virtual int TxnNRewithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) = 0;
+
     /**
      * @brief CompareAndSwap Transaction, to achieve CAS
      *
@@ -131,6 +156,21 @@ class KVStorageClient {
      */
     virtual int CompareAndSwap(const std::string &key, const std::string &preV,
         const std::string &target) = 0;
+
+    /**
+     * @brief TxnNWithCompare Operate transactions in the order of
+     *        ops[0] ops[1] ... only if all the compares on the mod revision
+     *        of keys hold, the mod revision of a missing key is 0
+     *
+     * @param[in] cmps Compare set, must not be empty
+     * @param[in] ops Operation set
+     * @param[out] revision Version number of the transaction
+     *
+     * @return error code, EtcdTxnCompareFailed if any compare fails
+     *         and none of the operations is applied
+     */
+    virtual int TxnNWithCompare(const std::vector<Compare> &cmps,
+        const std::vector<Operation> &ops, int64_t *revision) = 0;
 };
 
 // encapsulate the c header file of etcd generated by go compilation
@@ -161,6 +201,9 @@ class EtcdClientImp : public KVStorageClient {
 
     int Get(const std::string &key, std::string *out) override;
 
+    int GetWithModRevision(const std::string &key, std::string *out,
+        int64_t *modRevision) override;
+
     int List(const std::string &startKey,
         const std::string &endKey, std::vector<std::string> *values) override;
 
@@ -174,9 +217,15 @@ class EtcdClientImp : public KVStorageClient {
 
     int TxnN(const std::vector<Operation> &ops) override;
 
+    int TxnNRewithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) override;
+
     int CompareAndSwap(const std::string &key, const std::string &preV,
         const std::string &target) override;
 
+    int TxnNWithCompare(const std::vector<Compare> &cmps,
+        const std::vector<Operation> &ops, int64_t *revision) override;
+
     virtual int GetCurrentRevision(int64_t *revision);
 
     /**
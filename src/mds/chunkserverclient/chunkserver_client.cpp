@@ -35,6 +35,7 @@ using ::curve::mds::topology::ONLINE;
 using ::curve::chunkserver::ChunkService_Stub;
 using ::curve::chunkserver::ChunkRequest;
 using ::curve::chunkserver::ChunkResponse;
+using ::curve::chunkserver::DeleteChunksResponse;
 using ::curve::chunkserver::CHUNK_OP_TYPE;
 using ::curve::chunkserver::CHUNK_OP_STATUS;
 
@@ -228,6 +229,106 @@ int ChunkServerClient::DeleteChunk(ChunkServerIdType leaderId,
     return kMdsSuccess;
 }
 
+int ChunkServerClient::DeleteChunks(ChunkServerIdType leaderId,
+    LogicalPoolID logicalPoolId,
+    CopysetID copysetId,
+    const std::vector<ChunkID> &chunkIds,
+    uint64_t sn) {
+    DeleteChunksRequest request;
+    request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE);
+    request.set_logicpoolid(logicalPoolId);
+    request.set_copysetid(copysetId);
+    for (ChunkID chunkId : chunkIds) {
+        request.add_chunkid(chunkId);
+    }
+    request.set_sn(sn);
+    return SendDeleteChunks(leaderId, request);
+}
+
+int ChunkServerClient::DeleteChunkSnapshotsOrCorrectSn(
+    ChunkServerIdType leaderId,
+    LogicalPoolID logicalPoolId,
+    CopysetID copysetId,
+    const std::vector<ChunkID> &chunkIds,
+    uint64_t correctedSn) {
+    DeleteChunksRequest request;
+    request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE_SNAP);
+    request.set_logicpoolid(logicalPoolId);
+    request.set_copysetid(copysetId);
+    for (ChunkID chunkId : chunkIds) {
+        request.add_chunkid(chunkId);
+    }
+    request.set_correctedsn(correctedSn);
+    return SendDeleteChunks(leaderId, request);
+}
+
+int ChunkServerClient::SendDeleteChunks(ChunkServerIdType leaderId,
+                                        const DeleteChunksRequest &request) {
+    ChannelPtr channelPtr;
+    int res = GetOrInitChannel(leaderId, &channelPtr);
+    if (res != kMdsSuccess) {
+        return res;
+    }
+    ChunkService_Stub stub(channelPtr.get());
+
+    brpc::Controller cntl;
+    DeleteChunksResponse response;
+    uint32_t retry = 0;
+    do {
+        cntl.Reset();
+        cntl.set_timeout_ms(rpcTimeoutMs_);
+        stub.DeleteChunks(&cntl, &request, &response, nullptr);
+        LOG(INFO) << "Send DeleteChunks[log_id=" << cntl.log_id()
+                  << "] from " << cntl.local_side()
+                  << " to " << cntl.remote_side()
+                  << ", optype = " << request.optype()
+                  << ", logicalPoolId = " << request.logicpoolid()
+                  << ", copysetId = " << request.copysetid()
+                  << ", chunk count = " << request.chunkid_size();
+        if (cntl.ErrorCode() == brpc::ENOMETHOD) {
+            LOG(WARNING) << "DeleteChunks is not supported by "
+                         << cntl.remote_side();
+            return kCsClientNotSupport;
+        }
+        if (cntl.Failed()) {
+            LOG(WARNING) << "Send DeleteChunks error, "
+                       << "cntl.errorText = "
+                       << cntl.ErrorText()
+                       << ", retry, time = "
+                       << retry;
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(rpcRetryIntervalMs_));
+        }
+        retry++;
+    } while (cntl.Failed() && retry < rpcRetryTimes_);
+
+    if (cntl.Failed()) {
+        LOG(ERROR) << "Send DeleteChunks error, retry fail,"
+                   << "cntl.errorText = "
+                   << cntl.ErrorText() << std::endl;
+        return kRpcFail;
+    }
+
+    switch (response.status()) {
+        case CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS:
+            return kMdsSuccess;
+        case CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED:
+            LOG(INFO) << "Received DeleteChunks, not leader, redirect."
+                      << " [log_id=" << cntl.log_id()
+                      << "] from " << cntl.remote_side()
+                      << ". [DeleteChunksResponse] "
+                      << response.ShortDebugString();
+            return kCsClientNotLeader;
+        default:
+            LOG(ERROR) << "Received DeleteChunks error, [log_id="
+                       << cntl.log_id()
+                       << "] from " << cntl.remote_side()
+                       << ". [DeleteChunksResponse] "
+                       << response.ShortDebugString();
+            return kCsClientReturnFail;
+    }
+}
+
 int ChunkServerClient::GetLeader(ChunkServerIdType csId,
     LogicalPoolID logicalPoolId,
     CopysetID copysetId,
@@ -28,6 +28,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology.h"
@@ -39,6 +40,7 @@
 using ::curve::mds::topology::Topology;
 using ::curve::mds::topology::ChunkServerIdType;
 using ::curve::common::ChannelPool;
+using ::curve::chunkserver::DeleteChunksRequest;
 
 namespace curve {
 namespace mds {
@@ -94,6 +96,36 @@ class ChunkServerClient {
         ChunkID chunkId,
         uint64_t sn);
 
+    /**
+     * @brief delete chunks in the same copyset by one rpc
+     *
+     * @param leaderId
+     * @param logicalPoolId
+     * @param copysetId
+     * @param chunkIds chunks to delete
+     * @param sn file version number
+     *
+     * @return error code, kCsClientNotSupport if the chunkserver doesn't
+     *         support batch deletion
+     */
+    virtual int DeleteChunks(ChunkServerIdType leaderId,
+        LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t sn);
+
+    /**
+     * @brief the batch version of DeleteChunkSnapshotOrCorrectSn
+     *
+     * @return error code, kCsClientNotSupport if the chunkserver doesn't
+     *         support batch deletion
+     */
+    virtual int DeleteChunkSnapshotsOrCorrectSn(ChunkServerIdType leaderId,
+        LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t correctedSn);
+
     /**
      * @brief get the leader
      * @detail
@@ -126,6 +158,9 @@ class ChunkServerClient {
     int GetOrInitChannel(ChunkServerIdType csId,
                          ChannelPtr* channelPtr);
 
+    int SendDeleteChunks(ChunkServerIdType leaderId,
+                         const DeleteChunksRequest &request);
+
     std::shared_ptr<Topology> topology_;
     uint32_t rpcTimeoutMs_;
     uint32_t rpcRetryTimes_;
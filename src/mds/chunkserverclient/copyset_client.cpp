@@ -152,6 +152,108 @@ int CopysetClient::DeleteChunk(LogicalPoolID logicalPoolId,
     return ret;
 }
 
+int CopysetClient::DeleteChunks(LogicalPoolID logicalPoolId,
+                               CopysetID copysetId,
+                               const std::vector<ChunkID> &chunkIds,
+                               uint64_t sn) {
+    int ret = SendToLeader(logicalPoolId, copysetId,
+        [&](ChunkServerIdType leaderId) {
+            return chunkserverClient_->DeleteChunks(
+                leaderId, logicalPoolId, copysetId, chunkIds, sn);
+        });
+    if (ret != kCsClientNotSupport) {
+        return ret;
+    }
+
+    // chunkserver of old version, delete chunks one by one
+    for (ChunkID chunkId : chunkIds) {
+        ret = DeleteChunk(logicalPoolId, copysetId, chunkId, sn);
+        if (ret != kMdsSuccess) {
+            return ret;
+        }
+    }
+    return kMdsSuccess;
+}
+
+int CopysetClient::DeleteChunkSnapshotsOrCorrectSn(
+    LogicalPoolID logicalPoolId,
+    CopysetID copysetId,
+    const std::vector<ChunkID> &chunkIds,
+    uint64_t correctedSn) {
+    int ret = SendToLeader(logicalPoolId, copysetId,
+        [&](ChunkServerIdType leaderId) {
+            return chunkserverClient_->DeleteChunkSnapshotsOrCorrectSn(
+                leaderId, logicalPoolId, copysetId, chunkIds, correctedSn);
+        });
+    if (ret != kCsClientNotSupport) {
+        return ret;
+    }
+
+    // chunkserver of old version, handle chunks one by one
+    for (ChunkID chunkId : chunkIds) {
+        ret = DeleteChunkSnapshotOrCorrectSn(
+            logicalPoolId, copysetId, chunkId, correctedSn);
+        if (ret != kMdsSuccess) {
+            return ret;
+        }
+    }
+    return kMdsSuccess;
+}
+
+int CopysetClient::SendToLeader(
+    LogicalPoolID logicalPoolId,
+    CopysetID copysetId,
+    const std::function<int(ChunkServerIdType)> &send) {
+    int ret = kMdsFail;
+    CopySetInfo copyset;
+    if (true != topo_->GetCopySet(
+        CopySetKey(logicalPoolId, copysetId),
+        &copyset)) {
+        LOG(ERROR) << "GetCopySet fail.";
+        return kMdsFail;
+    }
+
+    ChunkServerIdType leaderId = copyset.GetLeader();
+    if (leaderId != UNINTIALIZE_ID) {
+        ret = send(leaderId);
+        if (kMdsSuccess == ret || kCsClientNotSupport == ret) {
+            return ret;
+        }
+    }
+
+    uint32_t retry = 0;
+    while ((retry < updateLeaderRetryTimes_) &&
+           ((UNINTIALIZE_ID == leaderId) ||
+            (kCsClientCSOffline == ret) ||
+            (kRpcFail == ret) ||
+            (kCsClientNotLeader == ret))) {
+        std::this_thread::sleep_for(
+                std::chrono::milliseconds(updateLeaderRetryIntervalMs_));
+        ret = UpdateLeader(&copyset);
+        if (ret < 0) {
+            LOG(ERROR) << "UpdateLeader fail."
+                       << " logicalPoolId = " << logicalPoolId
+                       << ", copysetId = " << copysetId;
+            break;
+        }
+
+        leaderId = copyset.GetLeader();
+        LOG(INFO) << "UpdateLeader success, new leaderId = " << leaderId;
+
+        if (leaderId != UNINTIALIZE_ID) {
+            ret = send(leaderId);
+            if (kMdsSuccess == ret || kCsClientNotSupport == ret) {
+                break;
+            }
+        } else {
+            LOG(ERROR) << "UpdateLeader success, but leaderId is uninit.";
+            return kMdsFail;
+        }
+        retry++;
+    }
+    return ret;
+}
+
 int CopysetClient::UpdateLeader(CopySetInfo *copyset) {
     LogicalPoolID logicalPoolId = copyset->GetLogicalPoolId();
     CopysetID copysetId = copyset->GetId();
@@ -23,7 +23,9 @@
 #ifndef SRC_MDS_CHUNKSERVERCLIENT_COPYSET_CLIENT_H_
 #define SRC_MDS_CHUNKSERVERCLIENT_COPYSET_CLIENT_H_
 
+#include <functional>
 #include <memory>
+#include <vector>
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology.h"
 
@@ -92,6 +94,33 @@ class CopysetClient {
         ChunkID chunkId,
         uint64_t sn);
 
+    /**
+     * @brief delete chunks in the same copyset by one rpc, fall back to
+     *        deleting chunks one by one if chunkserver doesn't support it
+     *
+     * @param logicPoolId
+     * @param copysetId
+     * @param chunkIds
+     * @param sn file version number
+     *
+     * @return error code
+     */
+    int DeleteChunks(LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t sn);
+
+    /**
+     * @brief the batch version of DeleteChunkSnapshotOrCorrectSn, fall back
+     *        to handling chunks one by one if chunkserver doesn't support it
+     *
+     * @return error code
+     */
+    int DeleteChunkSnapshotsOrCorrectSn(LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t correctedSn);
+
     /**
      * @brief update leader
      *
@@ -101,6 +130,19 @@ class CopysetClient {
      */
     int UpdateLeader(CopySetInfo *copyset);
 
+ private:
+    /**
+     * @brief send request to the leader of the copyset, update leader and
+     *        retry if leader is unknown, offline or changed
+     *
+     * @param send send request to the given leader and return error code
+     *
+     * @return error code
+     */
+    int SendToLeader(LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::function<int(ChunkServerIdType)> &send);
+
  private:
     std::shared_ptr<Topology> topo_;
     std::shared_ptr<ChunkServerClient> chunkserverClient_;
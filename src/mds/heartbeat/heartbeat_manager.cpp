@@ -37,6 +37,7 @@ using ::curve::mds::topology::ChunkServerStatus;
 using ::curve::mds::topology::ChunkServerStat;
 using ::curve::mds::topology::CopysetStat;
 using ::curve::mds::topology::SplitPeerId;
+using ::curve::common::LockGuard;
 
 namespace curve {
 namespace mds {
@@ -119,8 +120,47 @@ void HeartbeatManager::UpdateChunkServerDiskStatus(
     }
 }
 
+void HeartbeatManager::BuildCopysetStat(
+    const ChunkServerHeartbeatRequest &request,
+    const ::curve::mds::heartbeat::CopySetInfo &info,
+    CopysetStat *cstat) {
+    cstat->logicalPoolId = info.logicalpoolid();
+    cstat->copysetId = info.copysetid();
+
+    // TODO(xuchaojie): use id instead when new protocol supported
+    std::string leaderPeer = info.leaderpeer().address();
+    std::string leaderIp;
+    uint32_t leaderPort;
+    if (SplitPeerId(leaderPeer, &leaderIp, &leaderPort)) {
+        cstat->leader =
+            topology_->FindChunkServerNotRetired(leaderIp, leaderPort);
+        if (UNINTIALIZE_ID == cstat->leader) {
+            LOG(INFO) << "hearbeat receive from chunkserver(id:"
+                << request.chunkserverid()
+                << ",ip:"<< request.ip() << ",port:" << request.port()
+                << "), in which copyset(" << cstat->logicalPoolId
+                << "," << cstat->copysetId << ") dose not have leader.";
+        }
+    } else {
+        LOG(ERROR) << "hearbeat failed on SplitPeerId, "
+                   << "peerId string = " << leaderPeer;
+    }
+    if (info.has_stats()) {
+        cstat->readRate = info.stats().readrate();
+        cstat->writeRate = info.stats().writerate();
+        cstat->readIOPS = info.stats().readiops();
+        cstat->writeIOPS = info.stats().writeiops();
+    } else {
+        LOG(WARNING) << "hearbeat manager receive request "
+                     << "copyset {" << cstat->logicalPoolId
+                     << ", " << cstat->copysetId << "} "
+                     << "do not have CopysetStatistics";
+    }
+}
+
 void HeartbeatManager::UpdateChunkServerStatistics(
-    const ChunkServerHeartbeatRequest &request) {
+    const ChunkServerHeartbeatRequest &request,
+    const ChunkServerReport *report) {
     ChunkServerStat stat;
     stat.leaderCount = request.leadercount();
     stat.copysetCount = request.copysetcount();
@@ -137,45 +177,18 @@ void HeartbeatManager::UpdateChunkServerStatistics(
             stat.chunkFilepoolSize = request.stats().chunkfilepoolsize();
         }
 
-        for (int i = 0; i < request.copysetinfos_size(); i++) {
-            CopysetStat cstat;
-            cstat.logicalPoolId = request.copysetinfos(i).logicalpoolid();
-            cstat.copysetId = request.copysetinfos(i).copysetid();
-
-            // TODO(xuchaojie): use id instead when new protocol supported
-            std::string leaderPeer =
-                request.copysetinfos(i).leaderpeer().address();
-            std::string leaderIp;
-            uint32_t leaderPort;
-            if (SplitPeerId(leaderPeer, &leaderIp, &leaderPort)) {
-                cstat.leader =
-                    topology_->FindChunkServerNotRetired(
-                    leaderIp, leaderPort);
-                if (UNINTIALIZE_ID == cstat.leader) {
-                    LOG(INFO) << "hearbeat receive from chunkserver(id:"
-                        << request.chunkserverid()
-                        << ",ip:"<< request.ip() << ",port:" << request.port()
-                        << "), in which copyset(" << cstat.logicalPoolId
-                        << "," << cstat.copysetId << ") dose not have leader.";
-                }
-            } else {
-                LOG(ERROR) << "hearbeat failed on SplitPeerId, "
-                           << "peerId string = " << leaderPeer;
+        if (report != nullptr) {
+            // delta heartbeat only carries changed copysets
+            for (const auto &item : report->copysets) {
+                stat.copysetStats.push_back(item.second.stat);
             }
-            if (request.copysetinfos(i).has_stats()) {
-                cstat.readRate = request.copysetinfos(i).stats().readrate();
-                cstat.writeRate = request.copysetinfos(i).stats().writerate();
-                cstat.readIOPS = request.copysetinfos(i).stats().readiops();
-                cstat.writeIOPS = request.copysetinfos(i).stats().writeiops();
-            } else {
-                LOG(WARNING) << "hearbeat manager receive request "
-                             << "copyset {" << cstat.logicalPoolId
-                             << ", " << cstat.copysetId << "} "
-                             << "do not have CopysetStatistics";
+        } else {
+            for (int i = 0; i < request.copysetinfos_size(); i++) {
+                CopysetStat cstat;
+                BuildCopysetStat(request, request.copysetinfos(i), &cstat);
+                stat.copysetStats.push_back(cstat);
             }
-            stat.copysetStats.push_back(cstat);
         }
-
     } else {
         LOG(WARNING) << "hearbeat manager receive request "
                      << "do not have ChunkServerStatisticInfo";
@@ -183,6 +196,57 @@ void HeartbeatManager::UpdateChunkServerStatistics(
     topologyStat_->UpdateChunkServerStat(request.chunkserverid(), stat);
 }
 
+std::shared_ptr<HeartbeatManager::ChunkServerReport>
+HeartbeatManager::GetChunkServerReport(ChunkServerIdType csId) {
+    LockGuard guard(reportsMtx_);
+    auto &report = reports_[csId];
+    if (report == nullptr) {
+        report = std::make_shared<ChunkServerReport>();
+    }
+    return report;
+}
+
+bool HeartbeatManager::MergeCopySetReport(
+    const ChunkServerHeartbeatRequest &request, ChunkServerReport *report) {
+    bool complete = true;
+    if (!request.has_basereportseq()) {
+        report->copysets.clear();
+    } else if (report->seq == 0 || report->seq != request.basereportseq()) {
+        // mds restarted or switched, or the last heartbeat is handled but
+        // the response is lost
+        LOG(WARNING) << "heartbeatManager receive delta heartbeat from "
+                     << "chunkserver " << request.chunkserverid()
+                     << " based on seq " << request.basereportseq()
+                     << ", but last merged seq is " << report->seq;
+        complete = false;
+    }
+
+    for (const auto &removed : request.removedcopysets()) {
+        report->copysets.erase(
+            CopySetKey(removed.logicalpoolid(), removed.copysetid()));
+    }
+    for (const auto &info : request.copysetinfos()) {
+        ReportedCopySet &reported = report->copysets[
+            CopySetKey(info.logicalpoolid(), info.copysetid())];
+        reported.info = info;
+        reported.stat = CopysetStat();
+        BuildCopysetStat(request, info, &reported.stat);
+    }
+
+    if (complete && request.has_basereportseq() &&
+        report->copysets.size() != request.copysetcount()) {
+        LOG(WARNING) << "heartbeatManager merge delta heartbeat from "
+                     << "chunkserver " << request.chunkserverid()
+                     << " get " << report->copysets.size()
+                     << " copysets, but " << request.copysetcount()
+                     << " copysets on chunkserver";
+        complete = false;
+    }
+
+    report->seq = complete ? request.reportseq() : 0;
+    return complete;
+}
+
 void HeartbeatManager::ChunkServerHeartbeat(
     const ChunkServerHeartbeatRequest &request,
     ChunkServerHeartbeatResponse *response) {
@@ -207,51 +271,88 @@ void HeartbeatManager::ChunkServerHeartbeat(
 
     UpdateChunkServerDiskStatus(request);
 
-    UpdateChunkServerStatistics(request);
+    // chunkserver supporting delta heartbeat reports reportSeq
+    std::shared_ptr<ChunkServerReport> report;
+    ::curve::common::UniqueLock reportLock;
+    if (request.has_reportseq()) {
+        report = GetChunkServerReport(request.chunkserverid());
+        reportLock = ::curve::common::UniqueLock(report->mtx);
+        response->set_needfullreport(
+            !MergeCopySetReport(request, report.get()));
+    }
+
+    UpdateChunkServerStatistics(request, report.get());
 
     UpdateChunkServerVersion(request);
 
+    bool isDelta = request.has_basereportseq();
     // no copyset info in the request
-    if (request.copysetinfos_size() == 0) {
+    if (isDelta ? request.copysetcount() == 0
+                : request.copysetinfos_size() == 0) {
         response->set_statuscode(HeartbeatStatusCode::hbRequestNoCopyset);
     }
     // dealing with copysets included in the heartbeat request
     for (auto &value : request.copysetinfos()) {
-        // discard copysets of invalid logical pool
-        ::curve::mds::topology::LogicalPool lPool;
-        if (topology_->GetLogicalPool(value.logicalpoolid(), &lPool)) {
-            if (lPool.GetLogicalPoolAvaliableFlag() != true) {
-                continue;
-            }
-        }
-        // convert copysetInfo from heartbeat format to topology format
-        ::curve::mds::topology::CopySetInfo reportCopySetInfo;
-        if (!FromHeartbeatCopySetInfoToTopologyOne(value,
-                &reportCopySetInfo)) {
-            LOG(ERROR) << "heartbeatManager receive copyset("
-                       << value.logicalpoolid() << ","
-                       << value.copysetid()
-                       << ") information, but can not transfer to topology one";
-            response->set_statuscode(
-                            HeartbeatStatusCode::hbAnalyseCopysetError);
+        HandleCopySetInfo(request.chunkserverid(), value, response);
+    }
+
+    if (!isDelta) {
+        return;
+    }
+
+    // operators can only be dispatched by the heartbeat of the leader,
+    // so copysets with operator are handled even if they are not changed
+    std::set<CopySetKey> handled;
+    for (auto &value : request.copysetinfos()) {
+        handled.emplace(value.logicalpoolid(), value.copysetid());
+    }
+    for (const auto &key : coordinator_->GetOperatorCopySets()) {
+        auto iter = report->copysets.find(key);
+        if (iter == report->copysets.end() || handled.count(key) != 0 ||
+            iter->second.stat.leader != request.chunkserverid()) {
             continue;
         }
+        HandleCopySetInfo(request.chunkserverid(), iter->second.info,
+                          response);
+    }
+}
 
-        // forward reported copyset info to CopysetConfGenerator
-        CopySetConf conf;
-        ConfigChangeInfo configChInfo;
-        if (copysetConfGenerator_->GenCopysetConf(
-                request.chunkserverid(), reportCopySetInfo,
-                value.configchangeinfo(), &conf)) {
-            CopySetConf *res = response->add_needupdatecopysets();
-            *res = conf;
+void HeartbeatManager::HandleCopySetInfo(ChunkServerIdType reportId,
+    const ::curve::mds::heartbeat::CopySetInfo &value,
+    ChunkServerHeartbeatResponse *response) {
+    // discard copysets of invalid logical pool
+    ::curve::mds::topology::LogicalPool lPool;
+    if (topology_->GetLogicalPool(value.logicalpoolid(), &lPool)) {
+        if (lPool.GetLogicalPoolAvaliableFlag() != true) {
+            return;
         }
+    }
+    // convert copysetInfo from heartbeat format to topology format
+    ::curve::mds::topology::CopySetInfo reportCopySetInfo;
+    if (!FromHeartbeatCopySetInfoToTopologyOne(value,
+            &reportCopySetInfo)) {
+        LOG(ERROR) << "heartbeatManager receive copyset("
+                   << value.logicalpoolid() << ","
+                   << value.copysetid()
+                   << ") information, but can not transfer to topology one";
+        response->set_statuscode(
+                        HeartbeatStatusCode::hbAnalyseCopysetError);
+        return;
+    }
 
-        // if a copyset is the leader, update (e.g. epoch) topology according
-        // to its info
-        if (request.chunkserverid() == reportCopySetInfo.GetLeader()) {
-            topoUpdater_->UpdateTopo(reportCopySetInfo);
-        }
+    // forward reported copyset info to CopysetConfGenerator
+    CopySetConf conf;
+    if (copysetConfGenerator_->GenCopysetConf(
+            reportId, reportCopySetInfo,
+            value.configchangeinfo(), &conf)) {
+        CopySetConf *res = response->add_needupdatecopysets();
+        *res = conf;
+    }
+
+    // if a copyset is the leader, update (e.g. epoch) topology according
+    // to its info
+    if (reportId == reportCopySetInfo.GetLeader()) {
+        topoUpdater_->UpdateTopo(reportCopySetInfo);
     }
 }
 
@@ -45,10 +45,13 @@ using ::curve::mds::topology::PoolIdType;
 using ::curve::mds::topology::CopySetIdType;
 using ::curve::mds::topology::Topology;
 using ::curve::mds::topology::TopologyStat;
+using ::curve::mds::topology::CopysetStat;
+using ::curve::mds::topology::CopySetKey;
 using ::curve::mds::schedule::Coordinator;
 
 using ::curve::common::Thread;
 using ::curve::common::Atomic;
+using ::curve::common::Mutex;
 using ::curve::common::RWLock;
 using ::curve::common::InterruptibleSleeper;
 
@@ -111,6 +114,50 @@ class HeartbeatManager {
                                 ChunkServerHeartbeatResponse *response);
 
  private:
+    struct ReportedCopySet {
+        ::curve::mds::heartbeat::CopySetInfo info;
+        CopysetStat stat;
+    };
+
+    // copysets reported by a chunkserver supporting delta heartbeat,
+    // delta heartbeats are merged into it
+    struct ChunkServerReport {
+        Mutex mtx;
+        // sequence of the last merged heartbeat, 0 if unknown
+        uint64_t seq = 0;
+        std::map<CopySetKey, ReportedCopySet> copysets;
+    };
+
+    std::shared_ptr<ChunkServerReport> GetChunkServerReport(
+        ChunkServerIdType csId);
+
+    /**
+     * @brief Merge copysets of the heartbeat into the last report
+     *
+     * @param request Heartbeat request with reportSeq
+     * @param report Copysets last reported by the chunkserver
+     *
+     * @return false if the merged copysets may be incomplete, and the
+     *         chunkserver should send a full heartbeat next time
+     */
+    bool MergeCopySetReport(const ChunkServerHeartbeatRequest &request,
+                            ChunkServerReport *report);
+
+    /**
+     * @brief Handle one copyset reported by the chunkserver, generate
+     *        config for it and update topology if it's reported by leader
+     */
+    void HandleCopySetInfo(ChunkServerIdType reportId,
+                           const ::curve::mds::heartbeat::CopySetInfo &info,
+                           ChunkServerHeartbeatResponse *response);
+
+    /**
+     * @brief Convert copyset statistics from heartbeat format
+     */
+    void BuildCopysetStat(const ChunkServerHeartbeatRequest &request,
+                          const ::curve::mds::heartbeat::CopySetInfo &info,
+                          CopysetStat *cstat);
+
     /**
      * @brief Update disk status data of chunkserver
      *
@@ -123,9 +170,12 @@ class HeartbeatManager {
      * @brief Update statistical data of chunkserver
      *
      * @param request Heartbeat request
+     * @param report Merged copysets, copyset statistics are taken from it
+     *        instead of the request if not nullptr
      */
     void UpdateChunkServerStatistics(
-        const ChunkServerHeartbeatRequest &request);
+        const ChunkServerHeartbeatRequest &request,
+        const ChunkServerReport *report);
 
     /**
      * @brief Update version of chunkserver
@@ -195,6 +245,9 @@ class HeartbeatManager {
     Atomic<bool> isStop_;
     InterruptibleSleeper sleeper_;
     int chunkserverHealthyCheckerRunInter_;
+
+    Mutex reportsMtx_;
+    std::map<ChunkServerIdType, std::shared_ptr<ChunkServerReport>> reports_;
 };
 
 }  // namespace heartbeat
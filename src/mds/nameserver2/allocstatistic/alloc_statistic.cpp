@@ -24,7 +24,9 @@
 
 #include <glog/logging.h>
 
+#include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "proto/nameserver2.pb.h"
@@ -37,9 +39,19 @@
 using ::curve::common::Thread;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
+using ::curve::common::SEGMENTALLOCCHANGEKEYEND;
+using ::curve::common::SEGMENTALLOCCHANGEKEYPREFIX;
+using ::curve::common::SEGMENTALLOCJOURNALKEY;
 
 namespace curve {
 namespace mds {
+
+// etcd limits the number of operations in a transaction to 128 by default,
+// the puts of all logical pools are counted in each fold transaction
+const size_t kMaxTxnOps = 128;
+// folds of different mds conflict only around a leader change
+const int kMaxFoldRetryTimes = 3;
+
 int AllocStatistic::Init() {
     // get the current revision
     int res = client_->GetCurrentRevision(&curRevision_);
@@ -50,13 +62,49 @@ int AllocStatistic::Init() {
 
     res = AllocStatisticHelper::GetExistSegmentAllocValues(
         &existSegmentAllocValues_, client_);
-    return res;
+    if (res != 0) {
+        return res;
+    }
+
+    // without the journal, part1 is needed to count the segments
+    std::string journal;
+    res = client_->Get(SEGMENTALLOCJOURNALKEY, &journal);
+    if (res == EtcdErrCode::EtcdKeyNotExist) {
+        LOG(INFO) << "segment alloc journal not exist, calculate segment "
+                  << "alloc at revision " << curRevision_;
+        return 0;
+    } else if (res != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get segment alloc journal fail, errCode: " << res;
+        return -1;
+    }
+
+    std::map<PoolIdType, int64_t> changes;
+    if (AllocStatisticHelper::GetSegmentAllocChanges(client_, &changes) != 0) {
+        return -1;
+    }
+    for (auto &item : changes) {
+        existSegmentAllocValues_[item.first] += item.second;
+    }
+
+    {
+        WriteLockGuard guard(segmentAllocLock_);
+        segmentAlloc_ = existSegmentAllocValues_;
+    }
+    segmentAllocFromEtcdOK_.store(true);
+    currentValueAvalible_.store(true);
+    journalReady_.store(true);
+    LOG(INFO) << "load segment alloc from journal ok, pending changes of "
+              << changes.size() << " logical pools";
+    return 0;
 }
 
 void AllocStatistic::Run() {
     stop_.store(false);
-    periodicPersist_ = Thread(&AllocStatistic::CalculateSegmentAlloc, this);
-    calculateAlloc_ = Thread(&AllocStatistic::PeriodicPersist, this);
+    if (!journalReady_.load()) {
+        calculateAlloc_ =
+            Thread(&AllocStatistic::CalculateSegmentAlloc, this);
+    }
+    periodicPersist_ = Thread(&AllocStatistic::PeriodicPersist, this);
 }
 
 void AllocStatistic::Stop() {
@@ -64,7 +112,9 @@ void AllocStatistic::Stop() {
         LOG(INFO) << "start stop AllocStatistic...";
         sleeper_.interrupt();
         periodicPersist_.join();
-        calculateAlloc_.join();
+        if (calculateAlloc_.joinable()) {
+            calculateAlloc_.join();
+        }
         LOG(INFO) << "stop AllocStatistic ok!";
     }
 }
@@ -133,13 +183,24 @@ void AllocStatistic::DeAllocSpace(
 void AllocStatistic::CalculateSegmentAlloc() {
     // get the alloc data before revision from Etcd
     int res;
+    std::map<PoolIdType, int64_t> journalBase;
     do {
         res =  AllocStatisticHelper::CalculateSegmentAlloc(
             curRevision_, client_, &segmentAlloc_);
+        if (res == 0) {
+            journalBase = segmentAlloc_;
+            res = AllocStatisticHelper::CalculateJournalBase(
+                curRevision_, client_, &journalBase);
+        }
     } while (HandleResult(res));
 
     LOG(INFO) << "calculate segment alloc revision not bigger than "
               << curRevision_ << " ok";
+    {
+        WriteLockGuard guard(journalBaseLock_);
+        journalBase_ = std::move(journalBase);
+    }
+    journalBaseOK_.store(true);
     // set fetch data from etcd success
     segmentAllocFromEtcdOK_.store(true);
 
@@ -184,6 +245,11 @@ void AllocStatistic::PeriodicPersist() {
     std::map<PoolIdType, int64_t> lastPersist;
     while (sleeper_.wait_for(
         std::chrono::milliseconds(periodicPersistInterMs_))) {
+        if (journalReady_.load() || journalBaseOK_.load()) {
+            FoldSegmentAllocChanges();
+            continue;
+        }
+
         std::map<PoolIdType, int64_t> curPersist = GetLatestSegmentAllocInfo();
         if (true == curPersist.empty()) {
             continue;
@@ -220,6 +286,146 @@ void AllocStatistic::PeriodicPersist() {
     lastPersist.clear();
 }
 
+void AllocStatistic::FoldSegmentAllocChanges() {
+    for (int i = 0; i < kMaxFoldRetryTimes; ++i) {
+        int errCode = TryFoldSegmentAllocChanges();
+        if (errCode != EtcdErrCode::EtcdTxnCompareFailed) {
+            return;
+        }
+        LOG(INFO) << "segment alloc values changed by others, fold again";
+    }
+}
+
+int AllocStatistic::TryFoldSegmentAllocChanges() {
+    // read the journal key before the persisted values, any fold in between
+    // changes its mod revision and fails the compare of the txn below
+    std::string journal;
+    int64_t journalRevision;
+    int errCode = client_->GetWithModRevision(
+        SEGMENTALLOCJOURNALKEY, &journal, &journalRevision);
+    if (errCode == EtcdErrCode::EtcdKeyNotExist) {
+        journal = std::to_string(curRevision_);
+    } else if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get segment alloc journal fail, errCode: " << errCode;
+        return errCode;
+    }
+
+    bool establish = !journalReady_.load();
+    if (establish && errCode == EtcdErrCode::EtcdOK) {
+        // established by another mds, the base of this mds is not needed
+        LOG(INFO) << "segment alloc journal established by others";
+        establish = false;
+        journalReady_.store(true);
+    }
+
+    std::map<PoolIdType, int64_t> persist;
+    if (establish) {
+        ReadLockGuard guard(journalBaseLock_);
+        persist = journalBase_;
+    } else if (AllocStatisticHelper::GetExistSegmentAllocValues(
+                   &persist, client_) != 0) {
+        return EtcdErrCode::EtcdInternal;
+    }
+
+    std::vector<std::pair<std::string, std::string>> changes;
+    errCode = client_->List(SEGMENTALLOCCHANGEKEYPREFIX,
+                            SEGMENTALLOCCHANGEKEYEND, &changes);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "list segment alloc changes fail, errCode: " << errCode;
+        return errCode;
+    }
+    if (changes.empty() && !establish) {
+        return EtcdErrCode::EtcdOK;
+    }
+
+    size_t pos = 0;
+    do {
+        // a txn holds a put for each pool, a delete for each folded change
+        // and the put of the journal key
+        size_t end = pos;
+        while (end < changes.size()) {
+            PoolIdType lid;
+            int64_t change;
+            bool decoded = NameSpaceStorageCodec::DecodeSegmentAllocChangeValue(
+                changes[end].second, &lid, &change);
+            size_t opNum = persist.size() + (end - pos) + 1 + 1;
+            if (decoded && persist.find(lid) == persist.end()) {
+                ++opNum;
+            }
+            if (opNum > kMaxTxnOps) {
+                break;
+            }
+
+            if (decoded) {
+                persist[lid] += change;
+            } else {
+                LOG(ERROR) << "decode segment alloc change: "
+                           << changes[end].second << " fail, drop it";
+            }
+            ++end;
+        }
+        if (end == pos && pos < changes.size()) {
+            LOG(ERROR) << "fold segment alloc changes fail, " << persist.size()
+                       << " logical pools exceed the txn operation limit";
+            return EtcdErrCode::EtcdOutOfRange;
+        }
+
+        std::vector<std::string> allocKeys;
+        std::vector<std::string> allocValues;
+        for (auto &item : persist) {
+            allocKeys.emplace_back(
+                NameSpaceStorageCodec::EncodeSegmentAllocKey(item.first));
+            allocValues.emplace_back(
+                NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                    item.first, item.second));
+        }
+
+        // the persisted values and the folded changes are updated together
+        std::vector<Operation> ops;
+        for (size_t i = 0; i < allocKeys.size(); ++i) {
+            ops.emplace_back(Operation{OpType::OpPut,
+                const_cast<char *>(allocKeys[i].c_str()),
+                const_cast<char *>(allocValues[i].c_str()),
+                static_cast<int>(allocKeys[i].size()),
+                static_cast<int>(allocValues[i].size())});
+        }
+        for (size_t i = pos; i < end; ++i) {
+            ops.emplace_back(Operation{OpType::OpDelete,
+                const_cast<char *>(changes[i].first.c_str()), "",
+                static_cast<int>(changes[i].first.size()), 0});
+        }
+        ops.emplace_back(Operation{OpType::OpPut,
+            const_cast<char *>(SEGMENTALLOCJOURNALKEY),
+            const_cast<char *>(journal.c_str()),
+            static_cast<int>(strlen(SEGMENTALLOCJOURNALKEY)),
+            static_cast<int>(journal.size())});
+        std::vector<Compare> cmps{Compare{CompareOp::CmpEqual,
+            const_cast<char *>(SEGMENTALLOCJOURNALKEY),
+            static_cast<int>(strlen(SEGMENTALLOCJOURNALKEY)),
+            journalRevision}};
+
+        int64_t revision;
+        errCode = client_->TxnNWithCompare(cmps, ops, &revision);
+        if (errCode != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "fold " << end - pos << " segment alloc changes "
+                       << "fail, errCode: " << errCode;
+            return errCode;
+        }
+        journalRevision = revision;
+
+        if (establish) {
+            LOG(INFO) << "segment alloc journal established, revision: "
+                      << revision;
+            establish = false;
+            journalReady_.store(true);
+        }
+        pos = end;
+    } while (pos < changes.size());
+
+    LOG(INFO) << "fold " << changes.size() << " segment alloc changes ok";
+    return EtcdErrCode::EtcdOK;
+}
+
 void AllocStatistic::DoMerge() {
     // combine the alloc data before and after the revision
     std::set<PoolIdType> logicalPools = GetCurrentLogicalPools();
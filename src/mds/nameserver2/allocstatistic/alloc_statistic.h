@@ -62,6 +62,13 @@ using ::curve::kvstorage::EtcdClientImp;
  * provide segment allocation data according to current statistical status:
  * 1. If all of part1 are completed, get data from mergeMap_
  * 2. If part1 is not completed, get data from existSegmentAllocValues_
+ *
+ * alloc journal:
+ * every segment put/delete also records its alloc change in the same etcd
+ * transaction. Once a full scan establishes the base, the periodic persist
+ * folds the recorded changes into the persisted values and deletes them,
+ * so the persisted values plus pending changes are always exact. Then the
+ * next mds leader only loads them in Init, and part1 is skipped.
  */
 
 class AllocStatistic {
@@ -79,7 +86,8 @@ class AllocStatistic {
     AllocStatistic(uint64_t periodicPersistInterMs, uint64_t retryInterMs,
                    std::shared_ptr<EtcdClientImp> client)
         : client_(client), segmentAllocFromEtcdOK_(false),
-          currentValueAvalible_(false), retryInterMs_(retryInterMs),
+          currentValueAvalible_(false), journalReady_(false),
+          journalBaseOK_(false), retryInterMs_(retryInterMs),
           periodicPersistInterMs_(periodicPersistInterMs), stop_(true) {}
 
     ~AllocStatistic() { Stop(); }
@@ -94,7 +102,8 @@ class AllocStatistic {
     int Init();
 
     /**
-     * @brief Run 1. get all the segments under the specified revision
+     * @brief Run 1. get all the segments under the specified revision,
+     *               skipped if the alloc journal is loaded in Init
      *            2. persist the statistics of allocated segment size in memory
      *               under each logicalPool regularly
      */
@@ -149,6 +158,24 @@ class AllocStatistic {
      */
     void PeriodicPersist();
 
+    /**
+     * @brief FoldSegmentAllocChanges Add the recorded alloc changes to the
+     *                                persisted values and delete them, the
+     *                                first fold also establishes the journal.
+     *                                Retry if another mds folded concurrently
+     */
+    void FoldSegmentAllocChanges();
+
+    /**
+     * @brief TryFoldSegmentAllocChanges Fold the changes once, every fold
+     *        transaction puts the journal key and requires its mod revision
+     *        unchanged since the persisted values were read
+     *
+     * @return EtcdTxnCompareFailed if the persisted values were changed
+     *         by others, otherwise EtcdOK or the error code
+     */
+    int TryFoldSegmentAllocChanges();
+
     /**
      * @brief HandleResult Dealing with the situation that error occur when
      *                     obtaining all segment records of specified revision
@@ -215,6 +242,15 @@ class AllocStatistic {
     // It can be used after at least one merge
     Atomic<bool> currentValueAvalible_;
 
+    // whether the persisted values plus the alloc changes in Etcd are exact
+    Atomic<bool> journalReady_;
+
+    // base of the alloc changes, calculated by the full scan, used to
+    // establish the journal
+    std::map<PoolIdType, int64_t> journalBase_;
+    RWLock journalBaseLock_;
+    Atomic<bool> journalBaseOK_;
+
     // Retry interval in case of error in ms
     uint64_t retryInterMs_;
 
@@ -32,6 +32,10 @@
 namespace curve {
 namespace mds {
 
+using ::curve::common::DISCARDSEGMENTKEYEND;
+using ::curve::common::DISCARDSEGMENTKEYPREFIX;
+using ::curve::common::SEGMENTALLOCCHANGEKEYEND;
+using ::curve::common::SEGMENTALLOCCHANGEKEYPREFIX;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTINFOKEYEND;
@@ -119,5 +123,100 @@ int AllocStatisticHelper::CalculateSegmentAlloc(
               << " ms";
     return 0;
 }
+
+int AllocStatisticHelper::GetSegmentAllocChanges(
+    const std::shared_ptr<EtcdClientImp> &client,
+    std::map<PoolIdType, int64_t> *out) {
+    std::vector<std::string> changeVec;
+    int res = client->List(SEGMENTALLOCCHANGEKEYPREFIX,
+                           SEGMENTALLOCCHANGEKEYEND, &changeVec);
+    if (res != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "list [" << SEGMENTALLOCCHANGEKEYPREFIX << ","
+                   << SEGMENTALLOCCHANGEKEYEND << ") fail, errorCode: " << res;
+        return -1;
+    }
+
+    for (auto &item : changeVec) {
+        PoolIdType lid;
+        int64_t change;
+        if (!NameSpaceStorageCodec::DecodeSegmentAllocChangeValue(
+                item, &lid, &change)) {
+            LOG(ERROR) << "decode segment alloc change: " << item << " fail";
+            return -1;
+        }
+        (*out)[lid] += change;
+    }
+    return 0;
+}
+
+int AllocStatisticHelper::CalculateJournalBase(
+    int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+    std::map<PoolIdType, int64_t> *out) {
+    // discarded segments are released when they are cleaned
+    int res = ListWithRevision(DISCARDSEGMENTKEYPREFIX, DISCARDSEGMENTKEYEND,
+        revision, client, [out](const std::string &value) {
+            DiscardSegmentInfo info;
+            if (!NameSpaceStorageCodec::DecodeDiscardSegment(value, &info)) {
+                LOG(ERROR) << "decode discard segment fail";
+                return false;
+            }
+            const PageFileSegment &segment = info.pagefilesegment();
+            (*out)[segment.logicalpoolid()] += segment.segmentsize();
+            return true;
+        });
+    if (res != 0) {
+        return res;
+    }
+
+    return ListWithRevision(SEGMENTALLOCCHANGEKEYPREFIX,
+        SEGMENTALLOCCHANGEKEYEND, revision, client,
+        [out](const std::string &value) {
+            PoolIdType lid;
+            int64_t change;
+            if (!NameSpaceStorageCodec::DecodeSegmentAllocChangeValue(
+                    value, &lid, &change)) {
+                LOG(ERROR) << "decode segment alloc change: " << value
+                           << " fail";
+                return false;
+            }
+            (*out)[lid] -= change;
+            return true;
+        });
+}
+
+int AllocStatisticHelper::ListWithRevision(
+    const std::string &startKey, const std::string &endKey, int64_t revision,
+    const std::shared_ptr<EtcdClientImp> &client,
+    const std::function<bool(const std::string &)> &handler) {
+    std::string start = startKey;
+    std::vector<std::string> values;
+    std::string lastKey;
+    do {
+        values.clear();
+        lastKey.clear();
+
+        int res = client->ListWithLimitAndRevision(start, endKey, GETBUNDLE,
+                                                   revision, &values, &lastKey);
+        if (res != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "list [" << start << "," << endKey
+                       << ") at revision: " << revision
+                       << " with bundle: " << GETBUNDLE
+                       << " fail, errCode: " << res;
+            return -1;
+        }
+
+        // lastKey of the previous bundle is returned again
+        size_t startPos = (start == startKey) ? 0 : 1;
+        for (; startPos < values.size(); startPos++) {
+            if (!handler(values[startPos])) {
+                return -1;
+            }
+        }
+
+        start = lastKey;
+    } while (values.size() >= GETBUNDLE);
+
+    return 0;
+}
 }  // namespace mds
 }  // namespace curve
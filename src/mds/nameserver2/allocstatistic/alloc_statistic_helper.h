@@ -23,8 +23,10 @@
 #ifndef SRC_MDS_NAMESERVER2_ALLOCSTATISTIC_ALLOC_STATISTIC_HELPER_H_
 #define SRC_MDS_NAMESERVER2_ALLOCSTATISTIC_ALLOC_STATISTIC_HELPER_H_
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <string>
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
 
@@ -45,6 +47,32 @@ class AllocStatisticHelper {
     static int CalculateSegmentAlloc(
         int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
         std::map<PoolIdType, int64_t> *out);
+
+    // sum up the pending segment alloc changes of each logical pool
+    static int GetSegmentAllocChanges(
+        const std::shared_ptr<EtcdClientImp> &client,
+        std::map<PoolIdType, int64_t> *out);
+
+    /**
+     * @brief CalculateJournalBase Turn the segment alloc counted by
+     *        CalculateSegmentAlloc into the base of alloc changes, i.e.
+     *        add segments in DiscardSegmentTable which are not cleaned yet,
+     *        and subtract changes recorded not later than revision, as
+     *        they are already counted
+     *
+     * @param[in] revision revision of the segment alloc in out
+     * @param[in,out] out segment alloc of each logical pool
+     */
+    static int CalculateJournalBase(
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        std::map<PoolIdType, int64_t> *out);
+
+ private:
+    // list values in [startKey, endKey) at revision in bundles
+    static int ListWithRevision(
+        const std::string &startKey, const std::string &endKey,
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        const std::function<bool(const std::string &)> &handler);
 };
 }  // namespace mds
 }  // namespace curve
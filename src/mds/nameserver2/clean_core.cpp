@@ -22,8 +22,54 @@
 
 #include "src/mds/nameserver2/clean_core.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <utility>
+
+#include "src/common/concurrent/count_down_event.h"
+
 namespace curve {
 namespace mds {
+
+CleanCore::CleanCore(std::shared_ptr<NameServerStorage> storage,
+                     std::shared_ptr<CopysetClient> copysetClient,
+                     std::shared_ptr<AllocStatistic> allocStatistic,
+                     const CleanOption &option)
+    : storage_(storage),
+      copysetClient_(copysetClient),
+      allocStatistic_(allocStatistic),
+      option_(option) {
+    if (option_.segmentNumPerRound == 0) {
+        option_.segmentNumPerRound = 1;
+    }
+
+    if (option_.deleteConcurrency > 1) {
+        deletePool_.reset(new curve::common::TaskThreadPool<>());
+        int ret = deletePool_->Start(option_.deleteConcurrency);
+        if (ret != 0) {
+            LOG(ERROR) << "start delete chunk thread pool failed, "
+                       << "concurrency = " << option_.deleteConcurrency;
+            deletePool_.reset();
+        }
+    }
+
+    if (option_.deleteChunksPerSecond > 0) {
+        deleteThrottle_.reset(
+            new curve::common::LeakyBucket("mds_clean_delete_chunk"));
+        deleteThrottle_->SetLimit(option_.deleteChunksPerSecond, 0, 0);
+    }
+}
+
+CleanCore::~CleanCore() {
+    if (deleteThrottle_ != nullptr) {
+        deleteThrottle_->Stop();
+    }
+    if (deletePool_ != nullptr) {
+        deletePool_->Stop();
+    }
+}
+
 StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
                                         TaskProgress* progress) {
     if (fileInfo.segmentsize() == 0) {
@@ -32,49 +78,77 @@ StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
     }
     uint32_t  segmentNum = fileInfo.length() / fileInfo.segmentsize();
     uint64_t segmentSize = fileInfo.segmentsize();
-    for (uint32_t i = 0; i < segmentNum; i++) {
-        // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(fileInfo.parentid(),
-                                                    i * segmentSize,
-                                                    &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
-            LOG(ERROR) << "cleanSnapShot File Error: "
-            << "GetSegment Error, inodeid = " << fileInfo.id()
-            << ", filename = " << fileInfo.filename()
-            << ", offset = " << i * segmentSize
-            << ", sequenceNum = " << fileInfo.seqnum();
+    // 删除快照时如果chunk不存在快照，则需要修改chunk的correctedSn
+    // 防止删除快照后，后续的写触发chunk的快照
+    // correctSn为创建快照后文件的版本号，也就是快照版本号+1
+    SeqNum correctSn = fileInfo.seqnum() + 1;
+
+    // resume from the checkpoint persisted before restart
+    FileInfo checkpoint(fileInfo);
+    uint32_t startSegment = std::min<uint64_t>(
+        fileInfo.cleanedoffset() / segmentSize, segmentNum);
+    if (startSegment > 0) {
+        LOG(INFO) << "cleanSnapShot File resume from offset "
+                  << startSegment * segmentSize
+                  << ", inodeid = " << fileInfo.id()
+                  << ", filename = " << fileInfo.filename();
+    }
+
+    for (uint32_t i = startSegment; i < segmentNum;
+         i += option_.segmentNumPerRound) {
+        uint32_t roundEnd =
+            std::min(segmentNum, i + option_.segmentNumPerRound);
+
+        // load segments
+        std::vector<PageFileSegment> segments;
+        for (uint32_t j = i; j < roundEnd; j++) {
+            PageFileSegment segment;
+            StoreStatus storeRet = storage_->GetSegment(fileInfo.parentid(),
+                                                        j * segmentSize,
+                                                        &segment);
+            if (storeRet == StoreStatus::KeyNotExist) {
+                continue;
+            } else if (storeRet !=  StoreStatus::OK) {
+                LOG(ERROR) << "cleanSnapShot File Error: "
+                << "GetSegment Error, inodeid = " << fileInfo.id()
+                << ", filename = " << fileInfo.filename()
+                << ", offset = " << j * segmentSize
+                << ", sequenceNum = " << fileInfo.seqnum();
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kSnapshotFileDeleteError;
+            }
+            segments.emplace_back(std::move(segment));
+        }
+
+        // delete chunks in chunkserver
+        int ret = DeleteChunks(segments, true, correctSn);
+        if (ret != 0) {
+            LOG(ERROR) << "CleanSnapShotFile Error: "
+                << "DeleteChunkSnapshotOrCorrectSn Error"
+                << ", ret = " << ret
+                << ", inodeid = " << fileInfo.id()
+                << ", filename = " << fileInfo.filename()
+                << ", correctSn = " << correctSn;
             progress->SetStatus(TaskStatus::FAILED);
             return StatusCode::kSnapshotFileDeleteError;
         }
 
-        // delete chunks in chunkserver
-        LogicalPoolID logicalPoolID = segment.logicalpoolid();
-        uint32_t chunkNum = segment.chunks_size();
-        for (uint32_t j = 0; j != chunkNum; j++) {
-            // 删除快照时如果chunk不存在快照，则需要修改chunk的correctedSn
-            // 防止删除快照后，后续的写触发chunk的快照
-            // correctSn为创建快照后文件的版本号，也就是快照版本号+1
-            SeqNum correctSn = fileInfo.seqnum() + 1;
-            int ret = copysetClient_->DeleteChunkSnapshotOrCorrectSn(
-                logicalPoolID,
-                segment.chunks()[j].copysetid(),
-                segment.chunks()[j].chunkid(),
-                correctSn);
-            if (ret != 0) {
-                LOG(ERROR) << "CleanSnapShotFile Error: "
-                    << "DeleteChunkSnapshotOrCorrectSn Error"
-                    << ", ret = " << ret
-                    << ", inodeid = " << fileInfo.id()
-                    << ", filename = " << fileInfo.filename()
-                    << ", correctSn = " << correctSn;
-                progress->SetStatus(TaskStatus::FAILED);
-                return StatusCode::kSnapshotFileDeleteError;
+        // persist the checkpoint, a failure only causes redoing this round
+        bool hasChunk = std::any_of(segments.begin(), segments.end(),
+            [](const PageFileSegment& segment) {
+                return segment.chunks_size() > 0;
+            });
+        if (hasChunk && roundEnd < segmentNum) {
+            checkpoint.set_cleanedoffset(roundEnd * segmentSize);
+            StoreStatus storeRet = storage_->PutFile(checkpoint);
+            if (storeRet != StoreStatus::OK) {
+                LOG(WARNING) << "cleanSnapShot File persist checkpoint fail"
+                             << ", inodeid = " << fileInfo.id()
+                             << ", filename = " << fileInfo.filename()
+                             << ", offset = " << roundEnd * segmentSize;
             }
         }
-        progress->SetProgress(100 * (i+1) / segmentNum);
+        progress->SetProgress(100 * roundEnd / segmentNum);
     }
 
     // delete the storage
@@ -104,23 +178,33 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
 
     int  segmentNum = commonFile.length() / commonFile.segmentsize();
     uint64_t segmentSize = commonFile.segmentsize();
-    for (int i = 0; i != segmentNum; i++) {
-        // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
-                                    i * segmentSize, &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-                << "GetSegment Error, inodeid = " << commonFile.id()
-                << ", filename = " << commonFile.filename()
-                << ", offset = " << i * segmentSize;
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
+    int segmentNumPerRound = option_.segmentNumPerRound;
+    // deleted segments are the checkpoint, a restarted task skips them
+    for (int i = 0; i < segmentNum; i += segmentNumPerRound) {
+        int roundEnd = std::min(segmentNum, i + segmentNumPerRound);
+
+        // load segments
+        std::vector<PageFileSegment> segments;
+        std::vector<uint64_t> offsets;
+        for (int j = i; j < roundEnd; j++) {
+            PageFileSegment segment;
+            StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
+                                        j * segmentSize, &segment);
+            if (storeRet == StoreStatus::KeyNotExist) {
+                continue;
+            } else if (storeRet !=  StoreStatus::OK) {
+                LOG(ERROR) << "Clean common File Error: "
+                    << "GetSegment Error, inodeid = " << commonFile.id()
+                    << ", filename = " << commonFile.filename()
+                    << ", offset = " << j * segmentSize;
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kCommonFileDeleteError;
+            }
+            segments.emplace_back(std::move(segment));
+            offsets.push_back(j * segmentSize);
         }
 
-        int ret = DeleteChunksInSegment(segment, commonFile.seqnum());
+        int ret = DeleteChunks(segments, false, commonFile.seqnum());
         if (ret != 0) {
             LOG(ERROR) << "Clean common File Error: "
                        << ", ret = " << ret
@@ -131,22 +215,27 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
             return StatusCode::kCommonFileDeleteError;
         }
 
-        // delete segment
-        int64_t revision;
-        storeRet = storage_->DeleteSegment(
-            commonFile.id(), i * segmentSize, &revision);
-        if (storeRet != StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-            << "DeleteSegment Error, inodeid = " << commonFile.id()
-            << ", filename = " << commonFile.filename()
-            << ", offset = " << i * segmentSize
-            << ", sequenceNum = " << commonFile.seqnum();
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
+        // delete segments
+        for (size_t j = 0; j < segments.size(); j++) {
+            int64_t revision;
+            StoreStatus storeRet = storage_->DeleteSegment(
+                commonFile.id(), segments[j], &revision);
+            if (storeRet == StoreStatus::KeyNotExist) {
+                // deleted already, the space has been deallocated
+                continue;
+            } else if (storeRet != StoreStatus::OK) {
+                LOG(ERROR) << "Clean common File Error: "
+                << "DeleteSegment Error, inodeid = " << commonFile.id()
+                << ", filename = " << commonFile.filename()
+                << ", offset = " << offsets[j]
+                << ", sequenceNum = " << commonFile.seqnum();
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kCommonFileDeleteError;
+            }
+            allocStatistic_->DeAllocSpace(segments[j].logicalpoolid(),
+                segments[j].segmentsize(), revision);
         }
-        allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
-            segment.segmentsize(), revision);
-        progress->SetProgress(100 * (i + 1) / segmentNum);
+        progress->SetProgress(100 * roundEnd / segmentNum);
     }
 
     // delete the storage
@@ -182,7 +271,7 @@ StatusCode CleanCore::CleanDiscardSegment(
     timer.start();
 
     // delete chunks
-    int ret = DeleteChunksInSegment(segment, seq);
+    int ret = DeleteChunks({segment}, false, seq);
     if (ret != 0) {
         LOG(ERROR) << "CleanDiscardSegment failed, DeleteChunk Error, ret = "
                    << ret << ", filename = " << fileInfo.filename()
@@ -194,18 +283,18 @@ StatusCode CleanCore::CleanDiscardSegment(
 
     // delete segment
     int64_t revision;
-    auto storeRet = storage_->CleanDiscardSegment(segment.segmentsize(),
-                                                  cleanSegmentKey, &revision);
-    if (storeRet != StoreStatus::OK) {
+    auto storeRet = storage_->CleanDiscardSegment(segment, cleanSegmentKey,
+                                                  &revision);
+    if (storeRet == StoreStatus::OK) {
+        allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
+                                      segment.segmentsize(), revision);
+    } else if (storeRet != StoreStatus::KeyNotExist) {
         LOG(ERROR) << "CleanDiscardSegment failed, filename = "
                    << fileInfo.filename()
                    << ", offset = " << segment.startoffset();
         progress->SetStatus(TaskStatus::FAILED);
         return StatusCode::KInternalError;
     }
-
-    allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
-                                  segment.segmentsize(), revision);
     progress->SetProgress(100);
     progress->SetStatus(TaskStatus::SUCCESS);
 
@@ -218,27 +307,92 @@ StatusCode CleanCore::CleanDiscardSegment(
     return StatusCode::kOK;
 }
 
-int CleanCore::DeleteChunksInSegment(const PageFileSegment& segment,
-                                     const SeqNum& seq) {
-    const LogicalPoolID logicalPoolId = segment.logicalpoolid();
-    for (int i = 0; i < segment.chunks_size(); ++i) {
-        int ret = copysetClient_->DeleteChunk(
-            logicalPoolId,
-            segment.chunks()[i].copysetid(),
-            segment.chunks()[i].chunkid(),
-            seq);
+int CleanCore::DeleteChunks(const std::vector<PageFileSegment>& segments,
+                            bool deleteSnapshot, SeqNum sn) {
+    // group chunks by copyset
+    std::map<std::pair<LogicalPoolID, CopysetID>, std::vector<ChunkID>>
+        copysetChunks;
+    for (const auto& segment : segments) {
+        for (const auto& chunk : segment.chunks()) {
+            copysetChunks[{segment.logicalpoolid(), chunk.copysetid()}]
+                .push_back(chunk.chunkid());
+        }
+    }
 
-        if (ret != 0) {
-            LOG(ERROR) << "DeleteChunk failed, ret = " << ret
-                       << ", logicalpoolid = " << logicalPoolId
-                       << ", copysetid = " << segment.chunks()[i].copysetid()
-                       << ", chunkid = " << segment.chunks()[i].chunkid()
-                       << ", seq = " << seq;
-            return ret;
+    std::vector<DeleteBatch> batches;
+    size_t batchSize = std::max<uint32_t>(option_.batchDeleteChunkNum, 1);
+    for (auto& item : copysetChunks) {
+        const auto& chunkIds = item.second;
+        for (size_t i = 0; i < chunkIds.size(); i += batchSize) {
+            size_t end = std::min(chunkIds.size(), i + batchSize);
+            batches.push_back(DeleteBatch{item.first.first, item.first.second,
+                std::vector<ChunkID>(chunkIds.begin() + i,
+                                     chunkIds.begin() + end)});
         }
     }
 
-    return 0;
+    if (deletePool_ == nullptr || batches.size() <= 1) {
+        for (const auto& batch : batches) {
+            int ret = SendDeleteBatch(batch, deleteSnapshot, sn);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        return 0;
+    }
+
+    // stop sending the remaining batches after any failure
+    std::atomic<int> result(0);
+    curve::common::CountDownEvent counter(batches.size());
+    for (const auto& batch : batches) {
+        deletePool_->Enqueue([&, deleteSnapshot, sn]() {
+            if (result.load(std::memory_order_relaxed) == 0) {
+                int ret = SendDeleteBatch(batch, deleteSnapshot, sn);
+                if (ret != 0) {
+                    int expected = 0;
+                    result.compare_exchange_strong(expected, ret);
+                }
+            }
+            counter.Signal();
+        });
+    }
+    counter.Wait();
+
+    return result.load();
+}
+
+int CleanCore::SendDeleteBatch(const DeleteBatch& batch, bool deleteSnapshot,
+                               SeqNum sn) {
+    if (deleteThrottle_ != nullptr) {
+        deleteThrottle_->Add(batch.chunkIds.size());
+    }
+
+    int ret = 0;
+    if (option_.batchDeleteChunkNum == 0) {
+        ChunkID chunkId = batch.chunkIds[0];
+        ret = deleteSnapshot ?
+            copysetClient_->DeleteChunkSnapshotOrCorrectSn(
+                batch.logicalPoolId, batch.copysetId, chunkId, sn) :
+            copysetClient_->DeleteChunk(
+                batch.logicalPoolId, batch.copysetId, chunkId, sn);
+    } else {
+        ret = deleteSnapshot ?
+            copysetClient_->DeleteChunkSnapshotsOrCorrectSn(
+                batch.logicalPoolId, batch.copysetId, batch.chunkIds, sn) :
+            copysetClient_->DeleteChunks(
+                batch.logicalPoolId, batch.copysetId, batch.chunkIds, sn);
+    }
+
+    if (ret != 0) {
+        LOG(ERROR) << (deleteSnapshot ? "DeleteChunkSnapshot" : "DeleteChunk")
+                   << " failed, ret = " << ret
+                   << ", logicalpoolid = " << batch.logicalPoolId
+                   << ", copysetid = " << batch.copysetId
+                   << ", first chunkid = " << batch.chunkIds[0]
+                   << ", chunk count = " << batch.chunkIds.size()
+                   << ", sn = " << sn;
+    }
+    return ret;
 }
 
 }  // namespace mds
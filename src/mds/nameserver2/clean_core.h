@@ -25,6 +25,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/leaky_bucket.h"
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/nameserver2/task_progress.h"
@@ -38,14 +41,29 @@ using ::curve::mds::topology::Topology;
 namespace curve {
 namespace mds {
 
+struct CleanOption {
+    // max number of chunks deleted by one rpc,
+    // 0 means chunks are deleted one by one
+    uint32_t batchDeleteChunkNum = 0;
+    // number of segments whose chunks are deleted together in one round,
+    // segments and checkpoint are updated after each round
+    uint32_t segmentNumPerRound = 1;
+    // number of threads sending delete requests for all clean tasks,
+    // 0 or 1 means requests are sent one by one by the task thread
+    uint32_t deleteConcurrency = 0;
+    // max number of chunks deleted per second by all clean tasks,
+    // 0 means no limit
+    uint64_t deleteChunksPerSecond = 0;
+};
+
 class CleanCore {
  public:
     CleanCore(std::shared_ptr<NameServerStorage> storage,
         std::shared_ptr<CopysetClient> copysetClient,
-        std::shared_ptr<AllocStatistic> allocStatistic)
-        : storage_(storage),
-          copysetClient_(copysetClient),
-          allocStatistic_(allocStatistic) {}
+        std::shared_ptr<AllocStatistic> allocStatistic,
+        const CleanOption &option = CleanOption());
+
+    ~CleanCore();
 
     /**
      * @brief 删除快照文件，更新task状态
@@ -74,12 +92,40 @@ class CleanCore {
                                    TaskProgress* progress);
 
  private:
-    int DeleteChunksInSegment(const PageFileSegment& segment,
-                              const SeqNum& seq);
+    // chunks of the same copyset deleted by one request
+    struct DeleteBatch {
+        LogicalPoolID logicalPoolId;
+        CopysetID copysetId;
+        std::vector<ChunkID> chunkIds;
+    };
+
+    /**
+     * @brief delete chunks (or chunk snapshots) of the segments, chunks are
+     *        grouped by copyset and batches are sent in parallel
+     *
+     * @param segments segments whose chunks to delete
+     * @param deleteSnapshot delete chunk snapshots or chunks
+     * @param sn file seqnum when deleting chunks, or the correctedSn when
+     *        deleting chunk snapshots
+     *
+     * @return 0 if all chunks are deleted, otherwise the error code of
+     *         one failed request
+     */
+    int DeleteChunks(const std::vector<PageFileSegment>& segments,
+                     bool deleteSnapshot, SeqNum sn);
+
+    int SendDeleteBatch(const DeleteBatch& batch, bool deleteSnapshot,
+                        SeqNum sn);
 
     std::shared_ptr<NameServerStorage> storage_;
     std::shared_ptr<CopysetClient> copysetClient_;
     std::shared_ptr<AllocStatistic> allocStatistic_;
+
+    CleanOption option_;
+    // shared by all clean tasks to limit the concurrency of deletion
+    std::unique_ptr<curve::common::TaskThreadPool<>> deletePool_;
+    // shared by all clean tasks to limit the rate of deletion
+    std::unique_ptr<curve::common::LeakyBucket> deleteThrottle_;
 };
 
 }  // namespace mds
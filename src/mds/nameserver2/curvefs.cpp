@@ -25,6 +25,7 @@
 #include <google/protobuf/util/message_differencer.h>
 #include <memory>
 #include <chrono>    //NOLINT
+#include <algorithm>
 #include <set>
 #include <utility>
 #include <map>
@@ -1260,6 +1261,21 @@ StatusCode CurveFS::GetOrAllocateSegment(const std::string & filename,
         PageFileSegment *segment) {
     assert(segment != nullptr);
 
+    std::vector<PageFileSegment> segments;
+    auto ret = GetOrAllocateSegments(filename, offset, allocateIfNoExist, 1,
+                                     &segments);
+    if (ret == StatusCode::kOK) {
+        segment->Swap(&segments[0]);
+    }
+    return ret;
+}
+
+StatusCode CurveFS::GetOrAllocateSegments(const std::string & filename,
+        offset_t offset, bool allocateIfNoExist, uint32_t segmentNum,
+        std::vector<PageFileSegment> *segments) {
+    assert(segments != nullptr);
+    segments->clear();
+
     FileInfo  fileInfo;
     auto ret = GetFileInfo(filename, &fileInfo);
     if (ret != StatusCode::kOK) {
@@ -1282,47 +1298,92 @@ StatusCode CurveFS::GetOrAllocateSegment(const std::string & filename,
         return StatusCode::kParaError;
     }
 
-    auto storeRet = storage_->GetSegment(fileInfo.id(), offset, segment);
-    if (storeRet == StoreStatus::OK) {
-        return StatusCode::kOK;
-    } else if (storeRet == StoreStatus::KeyNotExist) {
-        if (allocateIfNoExist == false) {
-            LOG(INFO) << "file = " << filename <<", segment offset = " << offset
-                      << ", not allocated";
-            return  StatusCode::kSegmentNotAllocated;
-        } else {
-            // TODO(hzsunjianliang): check the user and define the logical pool
-            auto ifok = chunkSegAllocator_->AllocateChunkSegment(
-                    fileInfo.filetype(), fileInfo.segmentsize(),
-                    fileInfo.chunksize(),
-                    fileInfo.has_poolset() ? fileInfo.poolset()
-                                           : kDefaultPoolsetName,
-                    offset, segment);
-            if (ifok == false) {
-                LOG(ERROR) << "AllocateChunkSegment error";
-                return StatusCode::kSegmentAllocateError;
+    segmentNum = std::max(1u, std::min(segmentNum, kMaxBatchSegmentNum));
+
+    // newly allocated segments, stored together after all are allocated
+    std::vector<PageFileSegment> allocated;
+    for (uint32_t i = 0; i < segmentNum; ++i) {
+        offset_t segOffset = offset + i * fileInfo.segmentsize();
+        if (segOffset + fileInfo.segmentsize() > fileInfo.length()) {
+            break;
+        }
+
+        PageFileSegment segment;
+        auto storeRet = storage_->GetSegment(fileInfo.id(), segOffset,
+                                             &segment);
+        if (storeRet == StoreStatus::OK) {
+            segments->emplace_back(std::move(segment));
+            continue;
+        } else if (storeRet != StoreStatus::KeyNotExist) {
+            if (i == 0) {
+                return StatusCode::KInternalError;
             }
-            int64_t revision;
-            if (storage_->PutSegment(fileInfo.id(), offset, segment, &revision)
-                != StoreStatus::OK) {
-                LOG(ERROR) << "PutSegment fail, fileInfo.id() = "
-                           << fileInfo.id()
-                           << ", offset = "
-                           << offset;
-                return StatusCode::kStorageError;
+            break;
+        }
+
+        if (allocateIfNoExist == false) {
+            if (i == 0) {
+                LOG(INFO) << "file = " << filename
+                          << ", segment offset = " << segOffset
+                          << ", not allocated";
+                return  StatusCode::kSegmentNotAllocated;
             }
-            allocStatistic_->AllocSpace(segment->logicalpoolid(),
-                    segment->segmentsize(),
-                    revision);
+            continue;
+        }
 
-            LOG(INFO) << "alloc segment success, fileInfo.id() = "
-                      << fileInfo.id()
-                      << ", offset = " << offset;
-            return StatusCode::kOK;
+        // TODO(hzsunjianliang): check the user and define the logical pool
+        auto ifok = chunkSegAllocator_->AllocateChunkSegment(
+                fileInfo.filetype(), fileInfo.segmentsize(),
+                fileInfo.chunksize(),
+                fileInfo.has_poolset() ? fileInfo.poolset()
+                                       : kDefaultPoolsetName,
+                segOffset, &segment);
+        if (ifok == false) {
+            LOG(ERROR) << "AllocateChunkSegment error, offset = "
+                       << segOffset;
+            if (i == 0) {
+                return StatusCode::kSegmentAllocateError;
+            }
+            break;
         }
-    }  else {
-        return StatusCode::KInternalError;
+        allocated.push_back(segment);
+        segments->emplace_back(std::move(segment));
+    }
+
+    if (allocated.empty()) {
+        return StatusCode::kOK;
+    }
+
+    int64_t revision;
+    StoreStatus storeRet;
+    if (allocated.size() == 1) {
+        storeRet = storage_->PutSegment(fileInfo.id(),
+                                        allocated[0].startoffset(),
+                                        &allocated[0], &revision);
+    } else {
+        storeRet = storage_->PutSegments(fileInfo.id(), allocated,
+                                         &revision);
     }
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "PutSegment fail, fileInfo.id() = "
+                   << fileInfo.id()
+                   << ", offset = " << offset
+                   << ", segment num = " << allocated.size();
+        segments->clear();
+        return StatusCode::kStorageError;
+    }
+
+    for (const auto& segment : allocated) {
+        allocStatistic_->AllocSpace(segment.logicalpoolid(),
+                segment.segmentsize(),
+                revision);
+    }
+
+    LOG(INFO) << "alloc segment success, fileInfo.id() = "
+              << fileInfo.id()
+              << ", offset = " << offset
+              << ", segment num = " << allocated.size();
+    return StatusCode::kOK;
 }
 
 StatusCode CurveFS::DeAllocateSegment(const std::string& fileName,
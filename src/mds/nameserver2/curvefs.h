@@ -77,6 +77,9 @@ struct CurveFSOption {
     std::map<std::string, std::string> poolsetRules;
 };
 
+// max number of segments returned by one GetOrAllocateSegments call
+const uint32_t kMaxBatchSegmentNum = 16;
+
 struct AllocatedSize {
     // The size of the segment allocated by MDS to the file
     uint64_t total;
@@ -300,6 +303,27 @@ class CurveFS {
         offset_t offset,
         bool allocateIfNoExist, PageFileSegment *segment);
 
+    /**
+     *  @brief query or allocate segmentNum consecutive segments start at
+     *         offset, newly allocated segments are stored in one transaction
+     *
+     *  @param filename
+     *  @param offset
+     *  @param allocateIfNoExist: If the segment does not exist,
+     *                            whether or not creating a new one
+     *  @param segmentNum: number of segments wanted, at most
+     *                     kMaxBatchSegmentNum
+     *  @param segments: the first one is the segment at offset, the
+     *                   following ones are best effort and may be less
+     *                   than segmentNum - 1 or not consecutive
+     *  @return StatusCode::kOK if succeeded
+     */
+    StatusCode GetOrAllocateSegments(
+        const std::string & filename,
+        offset_t offset,
+        bool allocateIfNoExist, uint32_t segmentNum,
+        std::vector<PageFileSegment> *segments);
+
     /**
      * @brief deallocate file segment start at offset
      * @param filename
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/mds/nameserver2/file_info_cache.h"
+
+#include <functional>
+
+using ::curve::common::CacheMetrics;
+using ::curve::common::LockGuard;
+
+namespace curve {
+namespace mds {
+
+FileInfoCache::FileInfoCache(const FileInfoCacheOption &option,
+                             const std::string &metricPrefix)
+    : option_(option),
+      cacheMetrics_(std::make_shared<CacheMetrics>(metricPrefix)),
+      negativeHit_(metricPrefix, "cache_negative_hit"),
+      hitRatio_(metricPrefix, "cache_hit_ratio", &FileInfoCache::GetHitRatio,
+                this) {
+    if (option_.shardNum == 0) {
+        option_.shardNum = 1;
+    }
+
+    uint64_t shardCapacity =
+        (option_.capacity + option_.shardNum - 1) / option_.shardNum;
+    for (uint32_t i = 0; i < option_.shardNum; ++i) {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->lru.reset(new ::curve::common::LRUCache<std::string,
+                         FileInfoPtr, ::curve::common::CacheTraits<std::string>,
+                         FileInfoCacheTraits>(shardCapacity, cacheMetrics_));
+        shards_.emplace_back(std::move(shard));
+    }
+}
+
+FileInfoCache::Shard *FileInfoCache::GetShard(const std::string &key) {
+    return shards_[std::hash<std::string>()(key) % shards_.size()].get();
+}
+
+FileInfoCacheResult FileInfoCache::Get(const std::string &key,
+                                       FileInfo *fileInfo,
+                                       uint64_t *version) {
+    Shard *shard = GetShard(key);
+    FileInfoPtr value;
+    {
+        LockGuard guard(shard->mutex);
+        *version = shard->version;
+        if (!shard->lru->Get(key, &value)) {
+            return FileInfoCacheResult::kMiss;
+        }
+    }
+
+    if (value == nullptr) {
+        negativeHit_ << 1;
+        return FileInfoCacheResult::kNegativeHit;
+    }
+
+    fileInfo->CopyFrom(*value);
+    return FileInfoCacheResult::kHit;
+}
+
+void FileInfoCache::Fill(const std::string &key, const FileInfo *fileInfo,
+                         uint64_t version) {
+    if (fileInfo == nullptr && !option_.cacheNegative) {
+        return;
+    }
+
+    FileInfoPtr value;
+    if (fileInfo != nullptr) {
+        value = std::make_shared<const FileInfo>(*fileInfo);
+    }
+
+    Shard *shard = GetShard(key);
+    LockGuard guard(shard->mutex);
+    // the shard is updated during the lookup, the result may be stale
+    if (shard->version != version) {
+        return;
+    }
+    shard->lru->Put(key, value);
+}
+
+void FileInfoCache::Put(const std::string &key, const FileInfo &fileInfo) {
+    FileInfoPtr value = std::make_shared<const FileInfo>(fileInfo);
+
+    Shard *shard = GetShard(key);
+    LockGuard guard(shard->mutex);
+    ++shard->version;
+    shard->lru->Put(key, value);
+}
+
+void FileInfoCache::Remove(const std::string &key) {
+    Shard *shard = GetShard(key);
+    LockGuard guard(shard->mutex);
+    ++shard->version;
+    shard->lru->Remove(key);
+}
+
+uint64_t FileInfoCache::Size() {
+    uint64_t size = 0;
+    for (auto &shard : shards_) {
+        size += shard->lru->Size();
+    }
+    return size;
+}
+
+double FileInfoCache::GetHitRatio(void *arg) {
+    FileInfoCache *cache = static_cast<FileInfoCache *>(arg);
+    uint64_t hit = cache->cacheMetrics_->cacheHit.get_value();
+    uint64_t miss = cache->cacheMetrics_->cacheMiss.get_value();
+    if (hit + miss == 0) {
+        return 0;
+    }
+    return static_cast<double>(hit) / (hit + miss);
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_FILE_INFO_CACHE_H_
+#define SRC_MDS_NAMESERVER2_FILE_INFO_CACHE_H_
+
+#include <bvar/bvar.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "proto/nameserver2.pb.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/lru_cache.h"
+
+namespace curve {
+namespace mds {
+
+struct FileInfoCacheOption {
+    // max number of entries in all shards
+    uint64_t capacity = 0;
+    // number of shards, each shard has its own lock
+    uint32_t shardNum = 32;
+    // whether to cache the result of looking up a non-existent file
+    bool cacheNegative = true;
+};
+
+using FileInfoPtr = std::shared_ptr<const FileInfo>;
+
+struct FileInfoCacheTraits {
+    static uint64_t CountBytes(const FileInfoPtr &v) {
+        return v == nullptr ? 0 : v->ByteSize();
+    }
+};
+
+enum class FileInfoCacheResult {
+    // file info is returned
+    kHit = 0,
+    // file is known to be not exist
+    kNegativeHit = 1,
+    // nothing cached, caller should lookup the storage
+    kMiss = 2,
+};
+
+/**
+ * FileInfoCache caches the decoded FileInfo of a store key, which is
+ * encoded by (parentId, filename). Negative entries record files known
+ * to be absent, so repeated lookups of non-existent paths won't reach etcd.
+ *
+ * Every update bumps the version of the shard. Results loaded from the
+ * storage are filled only if the version is unchanged since the lookup
+ * started, so a slow lookup can't overwrite a concurrent update.
+ */
+class FileInfoCache {
+ public:
+    FileInfoCache(const FileInfoCacheOption &option,
+                  const std::string &metricPrefix);
+
+    /**
+     * @brief lookup cached file info of the key
+     *
+     * @param[in] key store key of the file
+     * @param[out] fileInfo file info, valid only if kHit is returned
+     * @param[out] version version of the shard, used by Fill on kMiss
+     */
+    FileInfoCacheResult Get(const std::string &key, FileInfo *fileInfo,
+                            uint64_t *version);
+
+    /**
+     * @brief fill the result loaded from storage,
+     *        fileInfo is nullptr if the file is not exist
+     */
+    void Fill(const std::string &key, const FileInfo *fileInfo,
+              uint64_t version);
+
+    // cache file info after it is written to storage
+    void Put(const std::string &key, const FileInfo &fileInfo);
+
+    // invalidate the key before it is modified in storage
+    void Remove(const std::string &key);
+
+    uint64_t Size();
+
+ private:
+    struct Shard {
+        ::curve::common::Mutex mutex;
+        uint64_t version = 0;
+        std::unique_ptr<::curve::common::LRUCache<std::string, FileInfoPtr,
+            ::curve::common::CacheTraits<std::string>,
+            FileInfoCacheTraits>> lru;
+    };
+
+    Shard *GetShard(const std::string &key);
+
+    static double GetHitRatio(void *arg);
+
+ private:
+    FileInfoCacheOption option_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    std::shared_ptr<::curve::common::CacheMetrics> cacheMetrics_;
+    // lookups of non-existent files served by the cache
+    bvar::Adder<uint64_t> negativeHit_;
+    bvar::PassiveStatus<double> hitRatio_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_FILE_INFO_CACHE_H_
@@ -20,6 +20,7 @@
  * Author: tongguangxun
  */
 
+#include <atomic>
 #include <vector>
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/common/string_util.h"
@@ -35,6 +36,8 @@ using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::DISCARDSEGMENTKEYLEN;
 using ::curve::common::DISCARDSEGMENTKEYPREFIX;
 using ::curve::common::DISCARDSEGMENTKEYEND;
+using ::curve::common::SEGMENTALLOCCHANGEKEYLEN;
+using ::curve::common::SEGMENTALLOCCHANGEKEYPREFIX;
 
 namespace curve {
 namespace mds {
@@ -149,6 +152,35 @@ bool NameSpaceStorageCodec::DecodeSegmentAllocValue(
     return true;
 }
 
+std::string NameSpaceStorageCodec::EncodeSegmentAllocChangeKey() {
+    // process start time and a sequence make the key unique across restarts
+    static const uint64_t startTimeUs =
+        curve::common::TimeUtility::GetTimeofDayUs();
+    static std::atomic<uint64_t> sequence(0);
+
+    std::string storeKey;
+    storeKey.resize(SEGMENTALLOCCHANGEKEYLEN);
+    ::memcpy(&(storeKey[0]), SEGMENTALLOCCHANGEKEYPREFIX, COMMON_PREFIX_LENGTH);
+    ::curve::common::EncodeBigEndian(&(storeKey[2]), startTimeUs);
+    ::curve::common::EncodeBigEndian(&(storeKey[10]), sequence.fetch_add(1));
+    return storeKey;
+}
+
+std::string NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(
+    uint16_t lid, int64_t change) {
+    return EncodeSegmentAllocValue(lid, static_cast<uint64_t>(change));
+}
+
+bool NameSpaceStorageCodec::DecodeSegmentAllocChangeValue(
+    const std::string &value, uint16_t *lid, int64_t *change) {
+    uint64_t tmp;
+    if (!DecodeSegmentAllocValue(value, lid, &tmp)) {
+        return false;
+    }
+    *change = static_cast<int64_t>(tmp);
+    return true;
+}
+
 bool NameSpaceStorageCodec::EncodeDiscardSegment(const DiscardSegmentInfo& info,
                                                  std::string* out) {
     return info.SerializeToString(out);
@@ -57,6 +57,13 @@ class NameSpaceStorageCodec {
     static std::string EncodeSegmentAllocValue(uint16_t lid, uint64_t alloc);
     static bool DecodeSegmentAllocValue(
         const std::string &value, uint16_t *lid, uint64_t *alloc);
+
+    // key of a segment alloc change record, unique in the mds process
+    static std::string EncodeSegmentAllocChangeKey();
+    static std::string EncodeSegmentAllocChangeValue(uint16_t lid,
+                                                     int64_t change);
+    static bool DecodeSegmentAllocChangeValue(
+        const std::string &value, uint16_t *lid, int64_t *change);
 };
 
 inline bool isPathValid(const std::string path) {
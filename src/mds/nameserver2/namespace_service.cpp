@@ -467,10 +467,25 @@ void NameSpaceService::GetOrAllocateSegment(
         }
     }
 
-    retCode = kCurveFS.GetOrAllocateSegment(request->filename(),
-                request->offset(),
-                request->allocateifnotexist(),
-                response->mutable_pagefilesegment());
+    if (request->has_segmentnum() && request->segmentnum() > 1) {
+        std::vector<PageFileSegment> segments;
+        retCode = kCurveFS.GetOrAllocateSegments(request->filename(),
+                    request->offset(),
+                    request->allocateifnotexist(),
+                    request->segmentnum(),
+                    &segments);
+        if (retCode == StatusCode::kOK) {
+            response->mutable_pagefilesegment()->Swap(&segments[0]);
+            for (size_t i = 1; i < segments.size(); ++i) {
+                response->add_extrasegments()->Swap(&segments[i]);
+            }
+        }
+    } else {
+        retCode = kCurveFS.GetOrAllocateSegment(request->filename(),
+                    request->offset(),
+                    request->allocateifnotexist(),
+                    response->mutable_pagefilesegment());
+    }
 
     if (retCode != StatusCode::kOK)  {
         response->set_statuscode(retCode);
@@ -494,12 +509,15 @@ void NameSpaceService::GetOrAllocateSegment(
                 << ", cost " << expiredTime.ExpiredMs() << " ms";
         }
         response->clear_pagefilesegment();
+        response->clear_extrasegments();
     } else {
         response->set_statuscode(StatusCode::kOK);
         LOG(INFO) << "logid = " << cntl->log_id()
                   << ", GetOrAllocateSegment ok, filename = "
                   << request->filename() << ", offset = " << request->offset()
                   << ", allocateTag = " << request->allocateifnotexist()
+                  << ", segment num = "
+                  << response->extrasegments_size() + 1
                   << ", cost " << expiredTime.ExpiredMs() << " ms";
     }
     return;
@@ -1637,6 +1655,46 @@ void NameSpaceService::RefreshSession(
                     ::google::protobuf::Closure* done) {
     brpc::ClosureGuard doneGuard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    RefreshSessionInternal(cntl, request, response);
+}
+
+void NameSpaceService::RefreshSessions(
+                    ::google::protobuf::RpcController* controller,
+                    const ::curve::mds::RefreshSessionsRequest* request,
+                    ::curve::mds::RefreshSessionsResponse* response,
+                    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    for (int i = 0; i < request->sessions_size(); ++i) {
+        // client info in batch request applies to all files
+        ReFreshSessionRequest session(request->sessions(i));
+        if (!session.has_clientversion() && request->has_clientversion()) {
+            session.set_clientversion(request->clientversion());
+        }
+        if (!session.has_clientip() && request->has_clientip()) {
+            session.set_clientip(request->clientip());
+        }
+        if (!session.has_clientport() && request->has_clientport()) {
+            session.set_clientport(request->clientport());
+        }
+
+        RefreshSessionInternal(cntl, &session, response->add_sessions());
+    }
+
+    response->set_statuscode(StatusCode::kOK);
+    DVLOG(6) << "logid = " << cntl->log_id()
+        << ", RefreshSessions ok, session num = " << request->sessions_size()
+        << ", clientip = " << butil::ip2str(cntl->remote_side().ip).c_str()
+        << ", clientport = " << cntl->remote_side().port
+        << ", cost = " << expiredTime.ExpiredMs() << " ms";
+}
+
+void NameSpaceService::RefreshSessionInternal(
+                    brpc::Controller* cntl,
+                    const ::curve::mds::ReFreshSessionRequest* request,
+                    ::curve::mds::ReFreshSessionResponse* response) {
     ExpiredTime expiredTime;
 
     std::string clientIP = butil::ip2str(cntl->remote_side().ip).c_str();
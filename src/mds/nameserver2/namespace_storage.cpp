@@ -40,8 +40,10 @@ std::ostream &operator<<(std::ostream &os, StoreStatus &s) {
 }
 
 NameServerStorageImp::NameServerStorageImp(
-    std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache)
-    : cache_(cache), client_(client), discardMetric_() {}
+    std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache,
+    std::shared_ptr<FileInfoCache> fileInfoCache)
+    : cache_(cache), fileInfoCache_(fileInfoCache), client_(client),
+      discardMetric_() {}
 
 StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
     std::string storeKey;
@@ -60,9 +62,11 @@ StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "put file: [" << fileInfo.filename()
                    << "] err: " << errCode;
+        // the put may have been applied, drop the cached one
+        RemoveFileInfoCache(storeKey);
     } else {
         // update to cache
-        cache_->Put(storeKey, encodeFileInfo);
+        PutFileInfoCache(storeKey, fileInfo, encodeFileInfo);
     }
 
     return getErrorCode(errCode);
@@ -78,12 +82,24 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
         return StoreStatus::InternalError;
     }
 
+    uint64_t cacheVersion = 0;
+    if (fileInfoCache_ != nullptr) {
+        switch (fileInfoCache_->Get(storeKey, fileInfo, &cacheVersion)) {
+        case FileInfoCacheResult::kHit:
+            return StoreStatus::OK;
+        case FileInfoCacheResult::kNegativeHit:
+            return StoreStatus::KeyNotExist;
+        default:
+            break;
+        }
+    }
+
     int errCode = EtcdErrCode::EtcdOK;
     std::string out;
-    if (!cache_->Get(storeKey, &out)) {
+    if (fileInfoCache_ != nullptr || !cache_->Get(storeKey, &out)) {
         errCode = client_->Get(storeKey, &out);
 
-        if (errCode == EtcdErrCode::EtcdOK) {
+        if (errCode == EtcdErrCode::EtcdOK && fileInfoCache_ == nullptr) {
             cache_->Put(storeKey, out);
         }
     }
@@ -91,6 +107,9 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
     if (errCode == EtcdErrCode::EtcdOK) {
         bool decodeOK = NameSpaceStorageCodec::DecodeFileInfo(out, fileInfo);
         if (decodeOK) {
+            if (fileInfoCache_ != nullptr) {
+                fileInfoCache_->Fill(storeKey, fileInfo, cacheVersion);
+            }
             return StoreStatus::OK;
         } else {
             LOG(ERROR) << "decode info error. parentid: " << parentid
@@ -100,6 +119,9 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
     } else if (errCode == EtcdErrCode::EtcdKeyNotExist) {
         LOG(INFO) << "file not exist. parentid: " << parentid
                   << ", filename: " << filename;
+        if (fileInfoCache_ != nullptr) {
+            fileInfoCache_->Fill(storeKey, nullptr, cacheVersion);
+        }
     } else {
         LOG(ERROR) << "get file err: " << errCode << "."
                    << " parentid: " << parentid << ", filename: " << filename;
@@ -118,8 +140,10 @@ StoreStatus NameServerStorageImp::DeleteFile(InodeID id,
     }
 
     // delete cache first, then Etcd
-    cache_->Remove(storeKey);
+    RemoveFileInfoCache(storeKey);
     int resCode = client_->Delete(storeKey);
+    // drop the entry filled by lookups during the deletion
+    RemoveFileInfoCache(storeKey);
 
     if (resCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "delete file err: " << resCode << ","
@@ -139,8 +163,10 @@ NameServerStorageImp::DeleteSnapshotFile(InodeID id,
     }
 
     // delete cache first, then Etcd
-    cache_->Remove(storeKey);
+    RemoveFileInfoCache(storeKey);
     int resCode = client_->Delete(storeKey);
+    // drop the entry filled by lookups during the deletion
+    RemoveFileInfoCache(storeKey);
 
     if (resCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "delete file err: " << resCode << "."
@@ -181,7 +207,7 @@ StoreStatus NameServerStorageImp::RenameFile(const FileInfo &oldFInfo,
     }
 
     // delete the data in the cache first
-    cache_->Remove(oldStoreKey);
+    RemoveFileInfoCache(oldStoreKey);
 
     // update Etcd
     Operation op1{OpType::OpDelete, const_cast<char *>(oldStoreKey.c_str()), "",
@@ -196,10 +222,12 @@ StoreStatus NameServerStorageImp::RenameFile(const FileInfo &oldFInfo,
         LOG(ERROR) << "rename file from [" << oldFInfo.id() << ", "
                    << oldFInfo.filename() << "] to [" << newFInfo.id() << ", "
                    << newFInfo.filename() << "] err: " << errCode;
+        RemoveFileInfoCache(newStoreKey);
     } else {
         // update to cache at last
-        cache_->Put(newStoreKey, encodeNewFileInfo);
+        PutFileInfoCache(newStoreKey, newFInfo, encodeNewFileInfo);
     }
+    RemoveFileInfoCache(oldStoreKey);
     return getErrorCode(errCode);
 }
 
@@ -259,8 +287,8 @@ StoreStatus NameServerStorageImp::ReplaceFileAndRecycleOldFile(
     }
 
     // delete data in cache
-    cache_->Remove(conflictStoreKey);
-    cache_->Remove(oldStoreKey);
+    RemoveFileInfoCache(conflictStoreKey);
+    RemoveFileInfoCache(oldStoreKey);
 
     // put recycleFInfo; delete oldFInfo; put newFInfo
     Operation op1{OpType::OpPut, const_cast<char *>(recycleStoreKey.c_str()),
@@ -279,11 +307,14 @@ StoreStatus NameServerStorageImp::ReplaceFileAndRecycleOldFile(
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "rename file from [" << oldFInfo.filename() << "] to ["
                    << newFInfo.filename() << "] err: " << errCode;
+        RemoveFileInfoCache(recycleStoreKey);
+        RemoveFileInfoCache(newStoreKey);
     } else {
         // update to cache
-        cache_->Put(recycleStoreKey, encodeRecycleFInfo);
-        cache_->Put(newStoreKey, encodeNewFInfo);
+        PutFileInfoCache(recycleStoreKey, recycleFInfo, encodeRecycleFInfo);
+        PutFileInfoCache(newStoreKey, newFInfo, encodeNewFInfo);
     }
+    RemoveFileInfoCache(oldStoreKey);
     return getErrorCode(errCode);
 }
 
@@ -317,7 +348,7 @@ NameServerStorageImp::MoveFileToRecycle(const FileInfo &originFileInfo,
     }
 
     // delete data in cache
-    cache_->Remove(originFileInfoKey);
+    RemoveFileInfoCache(originFileInfoKey);
 
     // remove originFileInfo from Etcd, and put recycleFileInfo
     Operation op1{OpType::OpDelete,
@@ -334,10 +365,13 @@ NameServerStorageImp::MoveFileToRecycle(const FileInfo &originFileInfo,
         LOG(ERROR) << "move file [" << originFileInfo.filename()
                    << "] to recycle file [" << recycleFileInfo.filename()
                    << "] err: " << errCode;
+        RemoveFileInfoCache(recycleFileInfoKey);
     } else {
         // update to cache
-        cache_->Put(recycleFileInfoKey, encodeRecycleFInfo);
+        PutFileInfoCache(recycleFileInfoKey, recycleFileInfo,
+                         encodeRecycleFInfo);
     }
+    RemoveFileInfoCache(originFileInfoKey);
     return getErrorCode(errCode);
 }
 
@@ -448,7 +482,24 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id, uint64_t off,
         return StoreStatus::InternalError;
     }
 
-    int errCode = client_->PutRewithRevision(storeKey, encodeSegment, revision);
+    // record the alloc change in the same transaction, so AllocStatistic
+    // can rebuild the allocation without scanning all segments
+    std::string changeKey =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeKey();
+    std::string changeValue =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(
+            segment->logicalpoolid(), segment->segmentsize());
+
+    Operation op1{OpType::OpPut, const_cast<char *>(storeKey.c_str()),
+                  const_cast<char *>(encodeSegment.c_str()),
+                  static_cast<int>(storeKey.size()),
+                  static_cast<int>(encodeSegment.size())};
+    Operation op2{OpType::OpPut, const_cast<char *>(changeKey.c_str()),
+                  const_cast<char *>(changeValue.c_str()),
+                  static_cast<int>(changeKey.size()),
+                  static_cast<int>(changeValue.size())};
+    std::vector<Operation> ops{op1, op2};
+    int errCode = client_->TxnNRewithRevision(ops, revision);
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "put segment of logicalPoolId:"
                    << segment->logicalpoolid() << "err:" << errCode;
@@ -458,6 +509,62 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id, uint64_t off,
     return getErrorCode(errCode);
 }
 
+StoreStatus NameServerStorageImp::PutSegments(
+    InodeID id, const std::vector<PageFileSegment> &segments,
+    int64_t *revision) {
+    std::vector<std::string> storeKeys;
+    std::vector<std::string> encodeSegments(segments.size());
+    std::map<uint16_t, int64_t> allocChanges;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        storeKeys.emplace_back(NameSpaceStorageCodec::EncodeSegmentStoreKey(
+            id, segments[i].startoffset()));
+        if (!NameSpaceStorageCodec::EncodeSegment(segments[i],
+                                                  &encodeSegments[i])) {
+            return StoreStatus::InternalError;
+        }
+        allocChanges[segments[i].logicalpoolid()] +=
+            segments[i].segmentsize();
+    }
+
+    // one alloc change record for each logical pool
+    std::vector<std::string> changeKeys;
+    std::vector<std::string> changeValues;
+    for (const auto &item : allocChanges) {
+        changeKeys.emplace_back(
+            NameSpaceStorageCodec::EncodeSegmentAllocChangeKey());
+        changeValues.emplace_back(
+            NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(
+                item.first, item.second));
+    }
+
+    std::vector<Operation> ops;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        ops.emplace_back(Operation{OpType::OpPut,
+            const_cast<char *>(storeKeys[i].c_str()),
+            const_cast<char *>(encodeSegments[i].c_str()),
+            static_cast<int>(storeKeys[i].size()),
+            static_cast<int>(encodeSegments[i].size())});
+    }
+    for (size_t i = 0; i < changeKeys.size(); ++i) {
+        ops.emplace_back(Operation{OpType::OpPut,
+            const_cast<char *>(changeKeys[i].c_str()),
+            const_cast<char *>(changeValues[i].c_str()),
+            static_cast<int>(changeKeys[i].size()),
+            static_cast<int>(changeValues[i].size())});
+    }
+
+    int errCode = client_->TxnNRewithRevision(ops, revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "put " << segments.size() << " segments of inodeid: "
+                   << id << " err: " << errCode;
+    } else {
+        for (size_t i = 0; i < segments.size(); ++i) {
+            cache_->Put(storeKeys[i], encodeSegments[i]);
+        }
+    }
+    return getErrorCode(errCode);
+}
+
 StoreStatus NameServerStorageImp::GetSegment(InodeID id, uint64_t off,
                                              PageFileSegment *segment) {
     std::string storeKey =
@@ -486,15 +593,37 @@ StoreStatus NameServerStorageImp::GetSegment(InodeID id, uint64_t off,
     return getErrorCode(errCode);
 }
 
-StoreStatus NameServerStorageImp::DeleteSegment(InodeID id, uint64_t off,
-                                                int64_t *revision) {
+StoreStatus NameServerStorageImp::DeleteSegment(
+    InodeID id, const PageFileSegment &segment, int64_t *revision) {
+    const uint64_t off = segment.startoffset();
     std::string storeKey =
         NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
-    int errCode = client_->DeleteRewithRevision(storeKey, revision);
+    std::string changeKey =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeKey();
+    std::string changeValue =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(
+            segment.logicalpoolid(),
+            0L - static_cast<int64_t>(segment.segmentsize()));
+
+    // the change is recorded only if the segment is really deleted
+    Compare cmp{CompareOp::CmpNotEqual, const_cast<char *>(storeKey.c_str()),
+                static_cast<int>(storeKey.size()), 0};
+    Operation op1{OpType::OpDelete, const_cast<char *>(storeKey.c_str()), "",
+                  static_cast<int>(storeKey.size()), 0};
+    Operation op2{OpType::OpPut, const_cast<char *>(changeKey.c_str()),
+                  const_cast<char *>(changeValue.c_str()),
+                  static_cast<int>(changeKey.size()),
+                  static_cast<int>(changeValue.size())};
+    std::vector<Operation> ops{op1, op2};
+    int errCode = client_->TxnNWithCompare({cmp}, ops, revision);
 
     // update the cache first, then update Etcd
     cache_->Remove(storeKey);
-    if (errCode != EtcdErrCode::EtcdOK) {
+    if (errCode == EtcdErrCode::EtcdTxnCompareFailed) {
+        LOG(WARNING) << "segment of inodeid: " << id << " off: " << off
+                     << " not exist";
+        return StoreStatus::KeyNotExist;
+    } else if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "delete segment of inodeid: " << id << "off: " << off
                    << ", err:" << errCode;
     }
@@ -573,15 +702,35 @@ NameServerStorageImp::DiscardSegment(const FileInfo &fileInfo,
     return getErrorCode(errCode);
 }
 
-StoreStatus NameServerStorageImp::CleanDiscardSegment(uint64_t segmentSize,
-                                                      const std::string &key,
-                                                      int64_t *revision) {
-    int errCode = client_->DeleteRewithRevision(key, revision);
-    if (errCode != EtcdErrCode::EtcdOK) {
+StoreStatus NameServerStorageImp::CleanDiscardSegment(
+    const PageFileSegment &segment, const std::string &key,
+    int64_t *revision) {
+    std::string changeKey =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeKey();
+    std::string changeValue =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(
+            segment.logicalpoolid(),
+            0L - static_cast<int64_t>(segment.segmentsize()));
+
+    // the change is recorded only if the discard segment is really removed
+    Compare cmp{CompareOp::CmpNotEqual, const_cast<char *>(key.c_str()),
+                static_cast<int>(key.size()), 0};
+    Operation op1{OpType::OpDelete, const_cast<char *>(key.c_str()), "",
+                  static_cast<int>(key.size()), 0};
+    Operation op2{OpType::OpPut, const_cast<char *>(changeKey.c_str()),
+                  const_cast<char *>(changeValue.c_str()),
+                  static_cast<int>(changeKey.size()),
+                  static_cast<int>(changeValue.size())};
+    std::vector<Operation> ops{op1, op2};
+    int errCode = client_->TxnNWithCompare({cmp}, ops, revision);
+    if (errCode == EtcdErrCode::EtcdTxnCompareFailed) {
+        LOG(WARNING) << "CleanDiscardSegment, key = " << key << " not exist";
+        return StoreStatus::KeyNotExist;
+    } else if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "CleanDiscardSegment failed, key = " << key
                    << ", err = " << errCode;
     } else {
-        discardMetric_.OnDiscardFinish(segmentSize);
+        discardMetric_.OnDiscardFinish(segment.segmentsize());
     }
 
     return getErrorCode(errCode);
@@ -620,7 +769,7 @@ StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
     }
 
     // delete the information in cache first
-    cache_->Remove(originFileKey);
+    RemoveFileInfoCache(originFileKey);
 
     // then update Etcd
     Operation op1{OpType::OpPut, const_cast<char *>(originFileKey.c_str()),
@@ -639,10 +788,12 @@ StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
                    << ", snapshot: " << snapshotFInfo->filename()
                    << ", fileinfo inodeid: " << originFInfo->id()
                    << ", fileinfo: " << originFInfo->filename() << "err";
+        RemoveFileInfoCache(originFileKey);
+        RemoveFileInfoCache(snapshotFileKey);
     } else {
         // update cache at last
-        cache_->Put(originFileKey, encodeFileInfo);
-        cache_->Put(snapshotFileKey, encodeSnapshot);
+        PutFileInfoCache(originFileKey, *originFInfo, encodeFileInfo);
+        PutFileInfoCache(snapshotFileKey, *snapshotFInfo, encodeSnapshot);
     }
     return getErrorCode(errCode);
 }
@@ -653,6 +804,24 @@ NameServerStorageImp::LoadSnapShotFile(std::vector<FileInfo> *snapshotFiles) {
                             snapshotFiles);
 }
 
+void NameServerStorageImp::PutFileInfoCache(const std::string &storeKey,
+                                            const FileInfo &fileInfo,
+                                            const std::string &encodeFileInfo) {
+    if (fileInfoCache_ != nullptr) {
+        fileInfoCache_->Put(storeKey, fileInfo);
+    } else {
+        cache_->Put(storeKey, encodeFileInfo);
+    }
+}
+
+void NameServerStorageImp::RemoveFileInfoCache(const std::string &storeKey) {
+    if (fileInfoCache_ != nullptr) {
+        fileInfoCache_->Remove(storeKey);
+    } else {
+        cache_->Remove(storeKey);
+    }
+}
+
 StoreStatus NameServerStorageImp::getErrorCode(int errCode) {
     switch (errCode) {
     case EtcdErrCode::EtcdOK:
@@ -34,6 +34,7 @@
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
 #include "src/mds/nameserver2/metric.h"
+#include "src/mds/nameserver2/file_info_cache.h"
 #include "src/common/lru_cache.h"
 
 namespace curve {
@@ -212,16 +213,30 @@ class NameServerStorage {
                                     int64_t *revision) = 0;
 
     /**
-     * @brief DeleteSegment: Delete the specified segment metadata
+     * @brief PutSegments: Store segments of one file in a single transaction
      *
      * @param[in] id: Inode ID of the target file
-     * @param[in] off: Offset of the target segment
+     * @param[in] segments: Segments to store, keyed by their startoffset
      * @param[out] revision: The version number of this operation
      *
      * @return StoreStatus: error code
      */
+    virtual StoreStatus PutSegments(
+        InodeID id, const std::vector<PageFileSegment> &segments,
+        int64_t *revision) = 0;
+
+    /**
+     * @brief DeleteSegment: Delete the specified segment metadata
+     *
+     * @param[in] id: Inode ID of the target file
+     * @param[in] segment: The segment to delete, located by its startoffset
+     * @param[out] revision: The version number of this operation
+     *
+     * @return StoreStatus: error code, KeyNotExist if the segment has been
+     *         deleted already and no alloc change is recorded
+     */
     virtual StoreStatus DeleteSegment(
-        InodeID id, uint64_t off, int64_t *revision) = 0;
+        InodeID id, const PageFileSegment &segment, int64_t *revision) = 0;
 
     /**
      * @brief Move segment metadata from SegmentTable to DiscardSegmentTable,
@@ -237,12 +252,13 @@ class NameServerStorage {
 
     /**
      * @brief Remove discard segment from DiscardSegmentTable
-     * @param[in] segmentSize segment's size
+     * @param[in] segment the discarded segment
      * @param[in] key discard segment's key
      * @param[out] revision: the version number of this operation
-     * @return On success, return StoreStatus::OK
+     * @return On success, return StoreStatus::OK, return
+     *         StoreStatus::KeyNotExist if the key has been removed already
      */
-    virtual StoreStatus CleanDiscardSegment(uint64_t segmentSize,
+    virtual StoreStatus CleanDiscardSegment(const PageFileSegment& segment,
                                             const std::string& key,
                                             int64_t* revision) = 0;
 
@@ -279,8 +295,15 @@ class NameServerStorage {
 
 class NameServerStorageImp : public NameServerStorage {
  public:
-    explicit NameServerStorageImp(
-        std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache);
+    /**
+     * @param client underlying kv storage
+     * @param cache cache of serialized values
+     * @param fileInfoCache cache of decoded file infos, if it's nullptr,
+     *        file infos are cached in the serialized cache
+     */
+    NameServerStorageImp(
+        std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache,
+        std::shared_ptr<FileInfoCache> fileInfoCache = nullptr);
     ~NameServerStorageImp() {}
 
     StoreStatus PutFile(const FileInfo & fileInfo) override;
@@ -326,13 +349,18 @@ class NameServerStorageImp : public NameServerStorage {
                             const PageFileSegment * segment,
                             int64_t *revision) override;
 
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override;
+
     StoreStatus DeleteSegment(
-        InodeID id, uint64_t off, int64_t *revision) override;
+        InodeID id, const PageFileSegment &segment,
+        int64_t *revision) override;
 
     StoreStatus DiscardSegment(const FileInfo& fileInfo,
                              const PageFileSegment& segment) override;
 
-    StoreStatus CleanDiscardSegment(uint64_t segmentSize,
+    StoreStatus CleanDiscardSegment(const PageFileSegment& segment,
                                     const std::string& key,
                                     int64_t* revision) override;
 
@@ -354,10 +382,18 @@ class NameServerStorageImp : public NameServerStorage {
                             std::string* storekey);
     StoreStatus getErrorCode(int errCode);
 
+    void PutFileInfoCache(const std::string &storeKey,
+                          const FileInfo &fileInfo,
+                          const std::string &encodeFileInfo);
+    void RemoveFileInfoCache(const std::string &storeKey);
+
  private:
     // namespace-meta cache
     std::shared_ptr<Cache> cache_;
 
+    // decoded file info cache, keyed by (parentid, filename)
+    std::shared_ptr<FileInfoCache> fileInfoCache_;
+
     // underlying storage
     std::shared_ptr<KVStorageClient> client_;
 
@@ -48,6 +48,9 @@ DEFINE_bool(enableRecoverScheduler, true, "switch of recover scheduler");
 DEFINE_validator(enableRecoverScheduler, &pass_bool);
 DEFINE_bool(enableScanScheduler, true, "switch of scan scheduler");
 DEFINE_validator(enableScanScheduler, &pass_bool);
+DEFINE_bool(enableLoadLeaderScheduler, true,
+            "switch of load leader scheduler");
+DEFINE_validator(enableLoadLeaderScheduler, &pass_bool);
 
 Coordinator::Coordinator(const std::shared_ptr<TopoAdapter> &topo) {
     this->topo_ = topo;
@@ -93,6 +96,12 @@ void Coordinator::InitScheduler(
             std::make_shared<ScanScheduler>(conf, topo_, opController_);
         LOG(INFO) << "init scan scheduler ok!";
     }
+
+    if (conf.enableLoadLeaderScheduler) {
+        schedulerController_[SchedulerType::LoadLeaderSchedulerType] =
+            std::make_shared<LoadLeaderScheduler>(conf, topo_, opController_);
+        LOG(INFO) << "init load leader scheduler ok!";
+    }
 }
 
 void Coordinator::Run() {
@@ -293,6 +302,14 @@ bool Coordinator::BuildCopySetConf(
     return true;
 }
 
+std::vector<CopySetKey> Coordinator::GetOperatorCopySets() {
+    std::vector<CopySetKey> keys;
+    for (const auto &op : opController_->GetOperators()) {
+        keys.emplace_back(op.copysetID);
+    }
+    return keys;
+}
+
 bool Coordinator::ChunkserverGoingToAdd(
     ChunkServerIdType csId, CopySetKey key) {
     Operator op;
@@ -339,6 +356,9 @@ bool Coordinator::ScheduleNeedRun(SchedulerType type) {
         case SchedulerType::ScanSchedulerType:
             return FLAGS_enableScanScheduler;
 
+        case SchedulerType::LoadLeaderSchedulerType:
+            return FLAGS_enableLoadLeaderScheduler;
+
         default:
             return false;
     }
@@ -361,6 +381,9 @@ std::string Coordinator::ScheduleName(SchedulerType type) {
         case SchedulerType::ScanSchedulerType:
             return "ScanScheduler";
 
+        case SchedulerType::LoadLeaderSchedulerType:
+            return "LoadLeaderScheduler";
+
         default:
             return "Unknown";
     }
@@ -84,6 +84,11 @@ class Coordinator {
      */
     virtual bool ChunkserverGoingToAdd(ChunkServerIdType csId, CopySetKey key);
 
+    /**
+     * @brief get copysets that have operator on them
+     */
+    virtual std::vector<CopySetKey> GetOperatorCopySets();
+
     /**
      * @brief Initialize the scheduler according to the configuration
      *
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <sys/time.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include "src/mds/schedule/scheduler.h"
+#include "src/mds/schedule/operatorFactory.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+int LoadLeaderScheduler::Schedule() {
+    LOG(INFO) << "schedule: loadLeaderScheduler begin.";
+    int oneRoundGenOp = 0;
+    for (auto lid : topo_->GetLogicalpools()) {
+        int quota = static_cast<int>(transferPerRound_) - oneRoundGenOp;
+        if (quota <= 0) {
+            break;
+        }
+        oneRoundGenOp += DoLoadLeaderSchedule(lid, quota);
+    }
+
+    LOG(INFO) << "schedule: loadLeaderScheduler end, generate operator num "
+              << oneRoundGenOp;
+    return oneRoundGenOp;
+}
+
+int LoadLeaderScheduler::DoLoadLeaderSchedule(PoolIdType lid, int quota) {
+    // collect the load of every leader copyset and every chunkserver
+    std::map<ChunkServerIdType, double> csLoads;
+    std::map<CopySetKey, double> copysetLoads;
+    double totalLoad = 0;
+    for (auto &csInfo : topo_->GetChunkServersInLogicalPool(lid)) {
+        if (csInfo.IsOffline() || csInfo.IsPendding()) {
+            hotChunkServers_.erase(csInfo.info.id);
+            continue;
+        }
+
+        std::map<CopySetKey, CopysetStatistics> stats;
+        if (!topo_->GetLeaderCopySetStatistics(csInfo.info.id, &stats)) {
+            continue;
+        }
+
+        double load = 0;
+        for (auto &item : stats) {
+            if (item.first.first != lid) {
+                continue;
+            }
+            double copysetLoad = CopySetLoad(item.second);
+            copysetLoads[item.first] = copysetLoad;
+            load += copysetLoad;
+        }
+        csLoads[csInfo.info.id] = load;
+        totalLoad += load;
+    }
+
+    if (csLoads.empty() || totalLoad <= 0) {
+        return 0;
+    }
+
+    double avgLoad = totalLoad / csLoads.size();
+    double highLoad = avgLoad * (1 + highPercent_);
+    double lowLoad = avgLoad * (1 + lowPercent_);
+
+    // update hot chunkservers with hysteresis
+    std::vector<std::pair<double, ChunkServerIdType>> sources;
+    for (auto &item : csLoads) {
+        if (item.second > highLoad) {
+            hotChunkServers_.insert(item.first);
+        } else if (item.second <= lowLoad) {
+            hotChunkServers_.erase(item.first);
+        }
+
+        if (hotChunkServers_.count(item.first) > 0) {
+            sources.emplace_back(item.second, item.first);
+        }
+    }
+
+    if (sources.empty()) {
+        LOG(INFO) << "loadLeaderScheduler no hot chunkserver in logical pool "
+                  << lid << ", average load: " << avgLoad;
+        return 0;
+    }
+
+    // leader copysets of the hot chunkservers, start from the hottest one
+    std::sort(sources.rbegin(), sources.rend());
+    std::map<ChunkServerIdType, std::vector<CopySetInfo>> leaderCopySets;
+    for (auto &cInfo : topo_->GetCopySetInfosInLogicalPool(lid)) {
+        if (hotChunkServers_.count(cInfo.leader) > 0) {
+            leaderCopySets[cInfo.leader].emplace_back(cInfo);
+        }
+    }
+
+    int oneRoundGenOp = 0;
+    for (auto &source : sources) {
+        ChunkServerIdType sourceId = source.second;
+        std::vector<CopySetInfo> &candidates = leaderCopySets[sourceId];
+        std::sort(candidates.begin(), candidates.end(),
+            [&copysetLoads](const CopySetInfo &a, const CopySetInfo &b) {
+                return copysetLoads[a.id] > copysetLoads[b.id];
+            });
+
+        for (auto &cInfo : candidates) {
+            if (oneRoundGenOp >= quota || csLoads[sourceId] <= lowLoad) {
+                break;
+            }
+
+            // copysets with no IO do not help
+            double load = copysetLoads[cInfo.id];
+            if (load <= 0) {
+                break;
+            }
+
+            // skip the copyset under configuration changing
+            if (cInfo.HasCandidate()) {
+                LOG(INFO) << cInfo.CopySetInfoStr() << " is on config change";
+                continue;
+            }
+
+            if (!CopysetAllPeersOnline(cInfo)) {
+                continue;
+            }
+
+            ChunkServerIdType targetId = SelectTarget(cInfo, csLoads);
+            if (targetId == UNINTIALIZE_ID) {
+                continue;
+            }
+
+            // the target should not become a new hot chunkserver, and the
+            // transfer should narrow the gap between the source and target
+            double targetLoad = csLoads[targetId] + load;
+            if (targetLoad > lowLoad ||
+                targetLoad >= csLoads[sourceId] - load) {
+                continue;
+            }
+
+            Operator op = operatorFactory.CreateTransferLeaderOperator(
+                cInfo, targetId, OperatorPriority::NormalPriority);
+            op.timeLimit = std::chrono::seconds(transTimeSec_);
+            if (!opController_->AddOperator(op)) {
+                continue;
+            }
+
+            LOG(INFO) << "loadLeaderScheduler generate operator "
+                      << op.OpToString() << " for " << cInfo.CopySetInfoStr()
+                      << ", copyset load: " << load
+                      << ", source load: " << csLoads[sourceId]
+                      << ", target load: " << csLoads[targetId]
+                      << ", average load: " << avgLoad;
+            csLoads[sourceId] -= load;
+            csLoads[targetId] += load;
+            oneRoundGenOp++;
+        }
+
+        if (csLoads[sourceId] <= lowLoad) {
+            hotChunkServers_.erase(sourceId);
+        }
+        if (oneRoundGenOp >= quota) {
+            break;
+        }
+    }
+
+    return oneRoundGenOp;
+}
+
+double LoadLeaderScheduler::CopySetLoad(const CopysetStatistics &statistics) {
+    double iops = statistics.readiops() + statistics.writeiops();
+    double bps = statistics.readrate() + statistics.writerate();
+    if (bytesPerIO_ == 0) {
+        return iops;
+    }
+    return iops + bps / bytesPerIO_;
+}
+
+ChunkServerIdType LoadLeaderScheduler::SelectTarget(const CopySetInfo &info,
+    const std::map<ChunkServerIdType, double> &loads) {
+    ChunkServerIdType targetId = UNINTIALIZE_ID;
+    double targetLoad = std::numeric_limits<double>::max();
+    for (auto &peerInfo : info.peers) {
+        if (peerInfo.id == info.leader) {
+            continue;
+        }
+
+        // chunkservers without load statistics are offline, pendding or
+        // have not reported yet, skip them
+        auto iter = loads.find(peerInfo.id);
+        if (iter == loads.end() || iter->second >= targetLoad) {
+            continue;
+        }
+
+        ChunkServerInfo csInfo;
+        if (!topo_->GetChunkServerInfo(peerInfo.id, &csInfo)) {
+            LOG(ERROR) << "loadLeaderScheduler cannot get info of chunkServer: "
+                       << peerInfo.id;
+            continue;
+        }
+
+        if (!coolingTimeExpired(csInfo.startUpTime)) {
+            continue;
+        }
+
+        targetId = peerInfo.id;
+        targetLoad = iter->second;
+    }
+    return targetId;
+}
+
+bool LoadLeaderScheduler::coolingTimeExpired(uint64_t startUpTime) {
+    if (startUpTime == 0) {
+        return false;
+    }
+
+    struct timeval tm;
+    gettimeofday(&tm, NULL);
+    return tm.tv_sec - startUpTime > chunkserverCoolingTimeSec_;
+}
+
+int64_t LoadLeaderScheduler::GetRunningInterval() { return runInterval_; }
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -24,6 +24,7 @@
 #include "src/mds/common/mds_define.h"
 #include "src/mds/schedule/scheduler.h"
 #include "src/mds/schedule/operatorFactory.h"
+#include "src/mds/schedule/operatorStep.h"
 
 using ::curve::mds::topology::UNINTIALIZE_ID;
 
@@ -37,9 +38,26 @@ int RecoverScheduler::Schedule() {
     // if over certain amount of chunkserver are downed on a server, these
     // chunkservers will be collected to the set excludes.
     std::set<ChunkServerIdType> excludes;
-    CalculateExcludesChunkServer(&excludes);
+    std::set<ChunkServerIdType> offlines;
+    CalculateExcludesChunkServer(&excludes, &offlines);
 
+    // the new replica installs snapshot from the leader of the copyset,
+    // limit the recovering operators on each leader so that the recovering
+    // reads spread over all the healthy replicas instead of a few disks
+    std::map<ChunkServerIdType, int> sourceLoad;
+    if (recoverSourceConcurrent_ > 0) {
+        CalculateSourceLoad(&sourceLoad);
+    }
+
+    uint32_t pendingNum = 0;
     for (auto copysetInfo : topo_->GetCopySetInfos()) {
+        for (auto &peer : copysetInfo.peers) {
+            if (offlines.count(peer.id) > 0 && excludes.count(peer.id) <= 0) {
+                pendingNum++;
+                break;
+            }
+        }
+
         // skip the copyset under configuration change
         Operator op;
         if (opController_->GetOperatorById(copysetInfo.id, &op)) {
@@ -111,8 +129,33 @@ int RecoverScheduler::Schedule() {
         if (!FixOfflinePeer(copysetInfo, *offlinelists.begin(), &fixRes,
                             &target)) {
             continue;
-            // succeeded but failed to add the operator to the controller
-        } else if (!opController_->AddOperator(fixRes)) {
+        }
+
+        // the leader has reached the limit of recovering operators, recover
+        // the replica from an idle follower instead
+        bool leaderOnline = copysetInfo.leader != UNINTIALIZE_ID &&
+                            offlines.count(copysetInfo.leader) <= 0;
+        if (target != UNINTIALIZE_ID && recoverSourceConcurrent_ > 0 &&
+            leaderOnline &&
+            sourceLoad[copysetInfo.leader] >= recoverSourceConcurrent_) {
+            Operator transferOp;
+            if (SelectRecoverSource(copysetInfo, offlines, sourceLoad,
+                                    &transferOp) &&
+                opController_->AddOperator(transferOp)) {
+                LOG(INFO) << "recoverScheduler generate operator:"
+                          << transferOp.OpToString() << " for "
+                          << copysetInfo.CopySetInfoStr()
+                          << ", leader " << copysetInfo.leader
+                          << " has " << sourceLoad[copysetInfo.leader]
+                          << " recovering operators";
+                sourceLoad[transferOp.step->GetTargetPeer()]++;
+                oneRoundGenOp++;
+            }
+            continue;
+        }
+
+        // succeeded but failed to add the operator to the controller
+        if (!opController_->AddOperator(fixRes)) {
             LOG(WARNING) << "recover scheduler add operator "
                          << fixRes.OpToString() << " on "
                          << copysetInfo.CopySetInfoStr() << " fail";
@@ -142,11 +185,15 @@ int RecoverScheduler::Schedule() {
                 opController_->RemoveOperator(copysetInfo.id);
                 continue;
             }
+            if (leaderOnline) {
+                sourceLoad[copysetInfo.leader]++;
+            }
             oneRoundGenOp++;
         }
     }
     LOG(INFO) << "recoverScheduler generate " << oneRoundGenOp
               << " operators at this round";
+    UpdateRecoverProgress(pendingNum);
     return 1;
 }
 
@@ -190,8 +237,94 @@ bool RecoverScheduler::FixOfflinePeer(const CopySetInfo &info,
     }
 }
 
+void RecoverScheduler::CalculateSourceLoad(
+    std::map<ChunkServerIdType, int> *sourceLoad) {
+    for (auto &op : opController_->GetOperators()) {
+        if (dynamic_cast<ChangePeer *>(op.step.get()) == nullptr &&
+            dynamic_cast<AddPeer *>(op.step.get()) == nullptr) {
+            continue;
+        }
+
+        CopySetInfo info;
+        if (!topo_->GetCopySetInfo(op.copysetID, &info)) {
+            continue;
+        }
+        (*sourceLoad)[info.leader]++;
+    }
+}
+
+bool RecoverScheduler::SelectRecoverSource(const CopySetInfo &info,
+    const std::set<ChunkServerIdType> &offlines,
+    const std::map<ChunkServerIdType, int> &sourceLoad, Operator *op) {
+    ChunkServerIdType source = UNINTIALIZE_ID;
+    int minLoad = recoverSourceConcurrent_;
+    for (auto &peer : info.peers) {
+        if (peer.id == info.leader || offlines.count(peer.id) > 0) {
+            continue;
+        }
+
+        auto iter = sourceLoad.find(peer.id);
+        int load = iter == sourceLoad.end() ? 0 : iter->second;
+        if (load >= minLoad) {
+            continue;
+        }
+
+        ChunkServerInfo csInfo;
+        if (!topo_->GetChunkServerInfo(peer.id, &csInfo)) {
+            LOG(WARNING) << "recoverScheduler can not get info of chunkServer: "
+                         << peer.id;
+            continue;
+        }
+        if (!csInfo.IsOnline() || csInfo.IsPendding()) {
+            continue;
+        }
+        source = peer.id;
+        minLoad = load;
+    }
+
+    if (source == UNINTIALIZE_ID) {
+        return false;
+    }
+
+    *op = operatorFactory.CreateTransferLeaderOperator(
+        info, source, OperatorPriority::HighPriority);
+    op->timeLimit = std::chrono::seconds(transTimeSec_);
+    return true;
+}
+
+void RecoverScheduler::UpdateRecoverProgress(uint32_t pendingNum) {
+    steady_clock::time_point now = steady_clock::now();
+    if (pendingNum == 0) {
+        recoverRate_ = 0;
+    } else if (lastPendingRecoverNum_ >= pendingNum &&
+               lastRoundTime_ != steady_clock::time_point()) {
+        // the copysets with new offline replicas are not counted in the rate
+        double seconds =
+            std::chrono::duration<double>(now - lastRoundTime_).count();
+        if (seconds > 0) {
+            double rate = (lastPendingRecoverNum_ - pendingNum) / seconds;
+            recoverRate_ = recoverRate_ <= 0 ? rate :
+                           0.7 * recoverRate_ + 0.3 * rate;
+        }
+    }
+    lastPendingRecoverNum_ = pendingNum;
+    lastRoundTime_ = now;
+
+    int64_t estimatedSec = 0;
+    if (pendingNum > 0) {
+        estimatedSec = recoverRate_ > 0 ?
+            static_cast<int64_t>(pendingNum / recoverRate_) : -1;
+        LOG(INFO) << "recoverScheduler has " << pendingNum
+                  << " copysets to recover, recover rate: " << recoverRate_
+                  << " copysets/s, estimated time: " << estimatedSec << "s";
+    }
+    pendingRecoverNum_.set_value(pendingNum);
+    recoverEstimatedSec_.set_value(estimatedSec);
+}
+
 void RecoverScheduler::CalculateExcludesChunkServer(
-    std::set<ChunkServerIdType> *excludes) {
+    std::set<ChunkServerIdType> *excludes,
+    std::set<ChunkServerIdType> *offlines) {
     // calculate the number of offline or pending chunkserver on a server
     std::map<ServerIdType, std::vector<ChunkServerIdType>> unhealthyStateCS;
     std::set<ChunkServerIdType> pendingCS;
@@ -205,6 +338,9 @@ void RecoverScheduler::CalculateExcludesChunkServer(
         if (cs.IsOnline()) {
             continue;
         }
+        if (cs.IsOffline()) {
+            offlines->emplace(cs.info.id);
+        }
 
         if (unhealthyStateCS.count(cs.info.serverId) <= 0) {
             unhealthyStateCS[cs.info.serverId] =
@@ -34,6 +34,7 @@ enum SchedulerType {
   ReplicaSchedulerType,
   RapidLeaderSchedulerType,
   ScanSchedulerType,
+  LoadLeaderSchedulerType,
 };
 
 struct ScheduleOption {
@@ -101,6 +102,28 @@ struct ScheduleOption {
     // ScanScheduler: maximum number of scan copysets at the same time
     // for every chunkserver
     uint32_t scanConcurrentPerChunkserver;
+
+    // load leader scheduler switch
+    bool enableLoadLeaderScheduler = false;
+    uint32_t loadLeaderSchedulerIntervalSec = 60;
+
+    // LoadLeaderScheduler: a chunkserver becomes hot when the IO load of its
+    // leaders exceeds average * (1 + loadLeaderHighPercent), and leaders are
+    // moved off it until the load drops below
+    // average * (1 + loadLeaderLowPercent)
+    float loadLeaderHighPercent = 0.3;
+    float loadLeaderLowPercent = 0.1;
+
+    // LoadLeaderScheduler: maximum number of leader transfers in one round
+    uint32_t loadLeaderTransferPerRound = 10;
+
+    // LoadLeaderScheduler: bandwidth (bytes/s) counted as one IOPS when
+    // combining IOPS and bandwidth into the load of a copyset
+    uint32_t loadLeaderBytesPerIO = 65536;
+
+    // RecoverScheduler: maximum number of recovering copysets that use the
+    // same chunkserver as source (leader), 0 means no limit
+    uint32_t recoverSourceConcurrent = 0;
 };
 
 }  // namespace schedule
@@ -30,6 +30,7 @@
 #include <unordered_map>
 #include <memory>
 #include <set>
+#include <bvar/bvar.h>
 #include "src/mds/schedule/schedule_define.h"
 #include "src/mds/schedule/topoAdapter.h"
 #include "src/mds/schedule/operatorController.h"
@@ -397,9 +398,14 @@ class RecoverScheduler : public Scheduler {
         const ScheduleOption &opt,
         const std::shared_ptr<TopoAdapter> &topo,
         const std::shared_ptr<OperatorController> &opController)
-        : Scheduler(opt, topo, opController) {
+        : Scheduler(opt, topo, opController),
+          pendingRecoverNum_(kRecoverMetricPrefix, "pending_copyset_num", 0),
+          recoverEstimatedSec_(kRecoverMetricPrefix, "estimated_sec", 0),
+          lastPendingRecoverNum_(0),
+          recoverRate_(0) {
         runInterval_ = opt.recoverSchedulerIntervalSec;
         chunkserverFailureTolerance_ = opt.chunkserverFailureTolerance;
+        recoverSourceConcurrent_ = opt.recoverSourceConcurrent;
     }
 
     /**
@@ -438,13 +444,60 @@ class RecoverScheduler : public Scheduler {
      * @param[out] excludes Chunkservers on the server that has offline
      *                      Chunkserver more than a specified number
      */
-    void CalculateExcludesChunkServer(std::set<ChunkServerIdType> *excludes);
+    void CalculateExcludesChunkServer(std::set<ChunkServerIdType> *excludes,
+        std::set<ChunkServerIdType> *offlines);
+
+    /**
+     * @brief calculate the number of recovering operators that every
+     *        chunkserver serves as the source. The new replica installs the
+     *        raft snapshot from the leader, so the leader is the source
+     *
+     * @param[out] sourceLoad chunkserver -> number of recovering operators
+     */
+    void CalculateSourceLoad(std::map<ChunkServerIdType, int> *sourceLoad);
+
+    /**
+     * @brief the leader of the copyset is busy with other recovering,
+     *        transfer the leader to an idle online follower so that the
+     *        replica can be recovered from it in the next round
+     *
+     * @param[in] info The copyset to be fixed
+     * @param[in] offlines Offline chunkservers
+     * @param[in] sourceLoad chunkserver -> number of recovering operators
+     * @param[out] op The operator generated
+     *
+     * @return Whether any operator has been generated
+     */
+    bool SelectRecoverSource(const CopySetInfo &info,
+        const std::set<ChunkServerIdType> &offlines,
+        const std::map<ChunkServerIdType, int> &sourceLoad, Operator *op);
+
+    /**
+     * @brief update recover rate and estimated time to finish recovering
+     *
+     * @param[in] pendingNum number of copysets with offline replicas
+     */
+    void UpdateRecoverProgress(uint32_t pendingNum);
 
  private:
+    const std::string kRecoverMetricPrefix = "mds_scheduler_metric_recover_";
+
     // running interval of RecoverScheduler
     int64_t runInterval_;
     // the threshold of the failing chunkserver that the server will not be recovered //NOLINT
     int32_t chunkserverFailureTolerance_;
+    // maximum number of recovering operators on one source chunkserver,
+    // 0 means no limit
+    int recoverSourceConcurrent_;
+
+    // number of copysets with offline replicas to recover
+    bvar::Status<uint32_t> pendingRecoverNum_;
+    // estimated seconds to finish recovering, -1 if unknown
+    bvar::Status<int64_t> recoverEstimatedSec_;
+    uint32_t lastPendingRecoverNum_;
+    steady_clock::time_point lastRoundTime_;
+    // moving average of recovered copysets per second
+    double recoverRate_;
 };
 
 // Check replica numbers of the copyset according to the configuration, and
@@ -657,6 +710,102 @@ class ScanScheduler : public Scheduler {
     uint32_t scanConcurrentPerChunkserver_;
 };
 
+// Balancing the IO load of leaders. Leader count is a poor proxy of the load
+// when the volumes are not equally hot, so LoadLeaderScheduler uses the
+// IOPS and bandwidth of every copyset reported through heartbeat to move
+// leaders off the chunkservers serving much more IO than the pool average
+class LoadLeaderScheduler : public Scheduler {
+ public:
+    LoadLeaderScheduler(
+        const ScheduleOption &opt,
+        const std::shared_ptr<TopoAdapter> &topo,
+        const std::shared_ptr<OperatorController> &opController)
+        : Scheduler(opt, topo, opController) {
+        runInterval_ = opt.loadLeaderSchedulerIntervalSec;
+        chunkserverCoolingTimeSec_ = opt.chunkserverCoolingTimeSec;
+        highPercent_ = opt.loadLeaderHighPercent;
+        lowPercent_ = opt.loadLeaderLowPercent;
+        transferPerRound_ = opt.loadLeaderTransferPerRound;
+        bytesPerIO_ = opt.loadLeaderBytesPerIO;
+    }
+
+    /**
+     * @brief Schedule Transfer leaders off the hot chunkservers, at most
+     *                 loadLeaderTransferPerRound operators in one round
+     *
+     * @return number of operators generated
+     */
+    int Schedule() override;
+
+    /**
+     * @brief Get running interval of LoadLeaderScheduler
+     *
+     * @return time interval
+     */
+    int64_t GetRunningInterval() override;
+
+ private:
+    /**
+     * @brief DoLoadLeaderSchedule Execute load balancing of leaders in
+     *                             specified logical pool
+     *
+     * @param[in] lid The ID of the logical pool specified
+     * @param[in] quota Maximum number of operators can be generated
+     *
+     * @return The number of operators generated
+     */
+    int DoLoadLeaderSchedule(PoolIdType lid, int quota);
+
+    /**
+     * @brief CopySetLoad Combine IOPS and bandwidth of a copyset into
+     *                    one load value
+     *
+     * @param[in] statistics IO statistics of the copyset
+     *
+     * @return the load of the copyset
+     */
+    double CopySetLoad(const CopysetStatistics &statistics);
+
+    /**
+     * @brief SelectTarget Select the follower with the minimum load which
+     *                     is able to take over the leader of the copyset
+     *
+     * @param[in] info The copyset specified
+     * @param[in] loads Load of the chunkservers in the logical pool
+     *
+     * @return target chunkserver, UNINTIALIZE_ID if no chunkserver selected
+     */
+    ChunkServerIdType SelectTarget(const CopySetInfo &info,
+        const std::map<ChunkServerIdType, double> &loads);
+
+    /**
+     * @brief coolingTimeExpired Check whether current-time - startUpTime is
+     *                           larger than chunkserverCoolingTimeSec_
+     */
+    bool coolingTimeExpired(uint64_t startUpTime);
+
+ private:
+    int64_t runInterval_;
+
+    // the minimum time that a chunkserver can become a target
+    // leader after it started
+    uint32_t chunkserverCoolingTimeSec_;
+
+    // a chunkserver is hot if its load > average * (1 + highPercent_), and
+    // stays hot until its load <= average * (1 + lowPercent_). The gap
+    // between the two thresholds keeps leaders from bouncing back and forth
+    // when the load fluctuates around the average
+    float highPercent_;
+    float lowPercent_;
+
+    uint32_t transferPerRound_;
+
+    uint32_t bytesPerIO_;
+
+    // chunkservers marked as hot in the previous rounds
+    std::set<ChunkServerIdType> hotChunkServers_;
+};
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
@@ -432,6 +432,30 @@ void TopoAdapterImpl::GetChunkServerScatterMap(
         }
     }
 }
+
+bool TopoAdapterImpl::GetLeaderCopySetStatistics(ChunkServerIdType id,
+    std::map<CopySetKey, CopysetStatistics> *out) {
+    assert(out != nullptr);
+
+    ChunkServerStat stat;
+    if (!topoStat_->GetChunkServerStat(id, &stat)) {
+        return false;
+    }
+
+    for (const auto &cstat : stat.copysetStats) {
+        // followers do not serve client IO
+        if (cstat.leader != id) {
+            continue;
+        }
+        CopysetStatistics &statistics =
+            (*out)[CopySetKey(cstat.logicalPoolId, cstat.copysetId)];
+        statistics.set_readrate(cstat.readRate);
+        statistics.set_writerate(cstat.writeRate);
+        statistics.set_readiops(cstat.readIOPS);
+        statistics.set_writeiops(cstat.writeIOPS);
+    }
+    return true;
+}
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
@@ -338,6 +338,20 @@ class TopoAdapter {
      */
     virtual void GetChunkServerScatterMap(const ChunkServerIdType &cs,
         std::map<ChunkServerIdType, int> *out) = 0;
+
+    /**
+     * @brief GetLeaderCopySetStatistics Get IO statistics of the copysets
+     *                                   that the chunkserver reported as
+     *                                   their leader in the latest heartbeat
+     *
+     * @param[in] id Chunkserver ID specified
+     * @param[out] out Copyset key -> IO statistics
+     *
+     * @return false if no heartbeat statistics of the chunkserver,
+     *         true if succeeded
+     */
+    virtual bool GetLeaderCopySetStatistics(ChunkServerIdType id,
+        std::map<CopySetKey, CopysetStatistics> *out) = 0;
 };
 
 // implementation of virtual class TopoAdapter
@@ -393,6 +407,9 @@ class TopoAdapterImpl : public TopoAdapter {
     void GetChunkServerScatterMap(const ChunkServerIdType &cs,
         std::map<ChunkServerIdType, int> *out) override;
 
+    bool GetLeaderCopySetStatistics(ChunkServerIdType id,
+        std::map<CopySetKey, CopysetStatistics> *out) override;
+
  private:
     bool GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo);
 
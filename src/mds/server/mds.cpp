@@ -73,6 +73,7 @@ void MDS::InitMdsOptions(std::shared_ptr<Configuration> conf) {
 
     // cache size of namestorage
     conf_->GetValueFatalIfFail("mds.cache.count", &options_.mdsCacheCount);
+    InitFileInfoCacheOption(&options_.fileInfoCacheOption);
 
     conf_->GetValueFatalIfFail("mds.listen.addr", &options_.mdsListenAddr);
 
@@ -134,7 +135,8 @@ void MDS::Init() {
 
     InitSegmentAllocStatistic(options_.retryInterTimes,
                               options_.periodicPersistInterMs);
-    InitNameServerStorage(options_.mdsCacheCount);
+    InitNameServerStorage(options_.mdsCacheCount,
+                          options_.fileInfoCacheOption);
     InitTopology(options_.topologyOption);
     InitTopologyStat();
     InitTopologyChunkAllocator(options_.topologyOption);
@@ -325,6 +327,10 @@ void MDS::InitTopologyOption(TopologyOption *topologyOption) {
     conf_->GetValueFatalIfFail(
         "mds.topology.enableLogicalPoolStatus",
         &topologyOption->enableLogicalPoolStatus);
+    if (!conf_->GetValue("mds.topology.chooseCopysetPolicy",
+                         &topologyOption->chooseCopysetPolicy)) {
+        topologyOption->chooseCopysetPolicy = 0;
+    }
 }
 
 void MDS::InitTopology(const TopologyOption& option) {
@@ -414,16 +420,42 @@ void MDS::InitTopologyChunkAllocator(const TopologyOption& option) {
     LOG(INFO) << "init topologyChunkAllocator success.";
 }
 
-void MDS::InitNameServerStorage(int mdsCacheCount) {
+void MDS::InitFileInfoCacheOption(FileInfoCacheOption *option) {
+    if (!conf_->GetValue("mds.cache.fileinfo.count", &option->capacity)) {
+        option->capacity = 0;
+    }
+    if (!conf_->GetValue("mds.cache.fileinfo.shardNum", &option->shardNum)) {
+        option->shardNum = 32;
+    }
+    if (!conf_->GetValue("mds.cache.fileinfo.cacheNegative",
+                         &option->cacheNegative)) {
+        option->cacheNegative = true;
+    }
+}
+
+void MDS::InitNameServerStorage(int mdsCacheCount,
+                                const FileInfoCacheOption &fileInfoOption) {
     // init LRUCache
 
     auto cache = std::make_shared<LRUCache>(mdsCacheCount,
         std::make_shared<CacheMetrics>("mds_nameserver_cache_metric"));
     LOG(INFO) << "init LRUCache success.";
 
+    // init decoded file info cache, file infos are kept in LRUCache
+    // if it's disabled
+    std::shared_ptr<FileInfoCache> fileInfoCache;
+    if (fileInfoOption.capacity > 0) {
+        fileInfoCache = std::make_shared<FileInfoCache>(
+            fileInfoOption, "mds_nameserver_fileinfo_cache_metric");
+        LOG(INFO) << "init FileInfoCache success, capacity: "
+                  << fileInfoOption.capacity
+                  << ", shard num: " << fileInfoOption.shardNum;
+    }
+
     // init NameServerStorage
     nameServerStorage_ = std::make_shared<NameServerStorageImp>(etcdClient_,
-                                                                cache);
+                                                                cache,
+                                                                fileInfoCache);
     LOG(INFO) << "init NameServerStorage success.";
 }
 
@@ -551,6 +583,25 @@ void MDS::InitDLockOption(std::shared_ptr<DLockOpts> dlockOpts) {
         "mds.etcd.dlock.ttlSec", &dlockOpts->ttlSec);
 }
 
+void MDS::InitCleanOption(CleanOption *option) {
+    if (!conf_->GetValue("mds.clean.batchDeleteChunkNum",
+                         &option->batchDeleteChunkNum)) {
+        option->batchDeleteChunkNum = 0;
+    }
+    if (!conf_->GetValue("mds.clean.segmentNumPerRound",
+                         &option->segmentNumPerRound)) {
+        option->segmentNumPerRound = 1;
+    }
+    if (!conf_->GetValue("mds.clean.deleteConcurrency",
+                         &option->deleteConcurrency)) {
+        option->deleteConcurrency = 0;
+    }
+    if (!conf_->GetValue("mds.clean.deleteChunksPerSecond",
+                         &option->deleteChunksPerSecond)) {
+        option->deleteChunksPerSecond = 0;
+    }
+}
+
 void MDS::InitCleanManager() {
     // TODO(hzsunjianliang): should add threadpoolsize & checktime from config
     auto channelPool = std::make_shared<ChannelPool>();
@@ -562,9 +613,12 @@ void MDS::InitCleanManager() {
         std::make_shared<CopysetClient>(topology_, chunkServerClientOption,
                                                         channelPool);
 
+    CleanOption cleanOption;
+    InitCleanOption(&cleanOption);
     auto cleanCore = std::make_shared<CleanCore>(nameServerStorage_,
                                                  copysetClient,
-                                                 segmentAllocStatistic_);
+                                                 segmentAllocStatistic_,
+                                                 cleanOption);
 
     // init dlock options
     auto dlockOpts = std::make_shared<DLockOpts>();
@@ -656,6 +710,28 @@ void MDS::InitScheduleOption(ScheduleOption *scheduleOption) {
         &scheduleOption->scanConcurrentPerPool);
     conf_->GetValueFatalIfFail("mds.scheduler.scan.concurrent.per.chunkserver",
         &scheduleOption->scanConcurrentPerChunkserver);
+
+    // the following options are optional, keep the defaults in
+    // ScheduleOption if not configured
+    conf_->GetValue("mds.enable.load.leader.scheduler",
+        &scheduleOption->enableLoadLeaderScheduler);
+    conf_->GetValue("mds.load.leader.scheduler.intervalSec",
+        &scheduleOption->loadLeaderSchedulerIntervalSec);
+    conf_->GetValue("mds.scheduler.load.leader.highPercent",
+        &scheduleOption->loadLeaderHighPercent);
+    conf_->GetValue("mds.scheduler.load.leader.lowPercent",
+        &scheduleOption->loadLeaderLowPercent);
+    conf_->GetValue("mds.scheduler.load.leader.transferPerRound",
+        &scheduleOption->loadLeaderTransferPerRound);
+    conf_->GetValue("mds.scheduler.load.leader.bytesPerIO",
+        &scheduleOption->loadLeaderBytesPerIO);
+    conf_->GetValue("mds.scheduler.recover.source.concurrent",
+        &scheduleOption->recoverSourceConcurrent);
+    if (scheduleOption->loadLeaderLowPercent >
+        scheduleOption->loadLeaderHighPercent) {
+        LOG(FATAL) << "mds.scheduler.load.leader.lowPercent should not be "
+                   << "larger than mds.scheduler.load.leader.highPercent";
+    }
 }
 
 void MDS::InitHeartbeatManager() {
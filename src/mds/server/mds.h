@@ -98,6 +98,8 @@ struct MDSOptions {
     uint64_t periodicPersistInterMs;
     // cache size of namestorage
     int mdsCacheCount;
+    // decoded file info cache of namestorage
+    FileInfoCacheOption fileInfoCacheOption;
     int mdsFilelockBucketNum;
 
     FileRecordOptions fileRecordOptions;
@@ -181,7 +183,10 @@ class MDS {
     void InitSegmentAllocStatistic(uint64_t retryInterTimes,
                                    uint64_t periodicPersistInterMs);
 
-    void InitNameServerStorage(int mdsCacheCount);
+    void InitFileInfoCacheOption(FileInfoCacheOption *option);
+
+    void InitNameServerStorage(int mdsCacheCount,
+                               const FileInfoCacheOption &fileInfoOption);
 
     void StartServer();
 
@@ -199,6 +204,8 @@ class MDS {
 
     void InitCurveFS(const CurveFSOption& curveFSOptions);
 
+    void InitCleanOption(CleanOption *option);
+
     void InitCleanManager();
 
     void InitCoordinator();
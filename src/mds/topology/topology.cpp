@@ -23,6 +23,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "src/common/namespace_define.h"
@@ -31,6 +32,7 @@
 #include "src/mds/common/mds_define.h"
 
 using ::curve::common::UUIDGenerator;
+using ::curve::common::LockGuard;
 using ::curve::common::kDefaultPoolsetId;
 using ::curve::common::kDefaultPoolsetName;
 
@@ -1034,7 +1036,6 @@ int TopologyImpl::Init(const TopologyOption &option) {
     WriteLockGuard wlockZone(zoneMutex_);
     WriteLockGuard wlockServer(serverMutex_);
     WriteLockGuard wlockChunkServer(chunkServerMutex_);
-    WriteLockGuard wlockCopySet(copySetMutex_);
 
     PoolsetIdType maxPoolsetId;
     if (!storage_->LoadPoolset(&poolsetMap_, &maxPoolsetId)) {
@@ -1135,14 +1136,21 @@ int TopologyImpl::Init(const TopologyOption &option) {
     }
     LOG(INFO) << "Calc physicalPool capacity success.";
 
+    std::map<CopySetKey, CopySetInfo> copySetMap;
     std::map<PoolIdType, CopySetIdType> copySetIdMaxMap;
-    if (!storage_->LoadCopySet(&copySetMap_, &copySetIdMaxMap)) {
+    if (!storage_->LoadCopySet(&copySetMap, &copySetIdMaxMap)) {
         LOG(ERROR) << "[TopologyImpl::init], LoadCopySet fail.";
         return kTopoErrCodeStorgeFail;
     }
     idGenerator_->initCopySetIdGenerator(copySetIdMaxMap);
+    for (auto &it : copySetMap) {
+        CopySetShard &shard = GetCopySetShard(it.first);
+        WriteLockGuard wlockCopySetShard(shard.mutex);
+        AddCopySetIndex(&shard, it.first, it.second.GetCopySetMembers());
+        shard.copySets[it.first] = it.second;
+    }
     LOG(INFO) << "[TopologyImpl::init], LoadCopySet success, "
-              << "copyset num = " << copySetMap_.size();
+              << "copyset num = " << copySetMap.size();
 
     for (auto& phy : physicalPoolMap_) {
         auto pid = phy.second.GetPoolsetId();
@@ -1194,14 +1202,18 @@ void TopologyImpl::SetChunkServerExternalIp() {
 int TopologyImpl::CleanInvalidLogicalPoolAndCopyset() {
     for (auto ix = logicalPoolMap_.begin(); ix != logicalPoolMap_.end();) {
         if (false == ix->second.GetLogicalPoolAvaliableFlag()) {
-            for (auto it = copySetMap_.begin(); it != copySetMap_.end();) {
-                if (it->second.GetLogicalPoolId() == ix->first) {
+            for (auto &shard : copySetShards_) {
+                WriteLockGuard wlockCopySetShard(shard.mutex);
+                auto it = shard.copySets.lower_bound(
+                    CopySetKey(ix->first, 0));
+                while (it != shard.copySets.end() &&
+                       it->first.first == ix->first) {
                     if (!storage_->DeleteCopySet(it->first)) {
                         return kTopoErrCodeStorgeFail;
                     }
-                    it = copySetMap_.erase(it);
-                } else {
-                    it++;
+                    RemoveCopySetIndex(&shard, it->first,
+                        it->second.GetCopySetMembers());
+                    it = shard.copySets.erase(it);
                 }
             }
             if (!storage_->DeleteLogicalPool(ix->first)) {
@@ -1220,17 +1232,56 @@ CopySetIdType TopologyImpl::AllocateCopySetId(PoolIdType logicalPoolId) {
     return idGenerator_->GenCopySetId(logicalPoolId);
 }
 
+TopologyImpl::CopySetShard& TopologyImpl::GetCopySetShard(
+    const CopySetKey &key) {
+    uint64_t hash = (static_cast<uint64_t>(key.first) << 32) | key.second;
+    return copySetShards_[hash % kCopySetShardNum];
+}
+
+const TopologyImpl::CopySetShard& TopologyImpl::GetCopySetShard(
+    const CopySetKey &key) const {
+    uint64_t hash = (static_cast<uint64_t>(key.first) << 32) | key.second;
+    return copySetShards_[hash % kCopySetShardNum];
+}
+
+void TopologyImpl::AddCopySetIndex(CopySetShard *shard,
+    const CopySetKey &key,
+    const std::set<ChunkServerIdType> &members) {
+    LockGuard lockIndex(shard->indexMutex);
+    for (auto csId : members) {
+        shard->csIndex[csId].insert(key);
+    }
+}
+
+void TopologyImpl::RemoveCopySetIndex(CopySetShard *shard,
+    const CopySetKey &key,
+    const std::set<ChunkServerIdType> &members) {
+    LockGuard lockIndex(shard->indexMutex);
+    for (auto csId : members) {
+        auto it = shard->csIndex.find(csId);
+        if (it == shard->csIndex.end()) {
+            continue;
+        }
+        it->second.erase(key);
+        if (it->second.empty()) {
+            shard->csIndex.erase(it);
+        }
+    }
+}
+
 int TopologyImpl::AddCopySet(const CopySetInfo &data) {
     ReadLockGuard rlockLogicalPool(logicalPoolMutex_);
-    WriteLockGuard wlockCopySetMap(copySetMutex_);
     auto it = logicalPoolMap_.find(data.GetLogicalPoolId());
     if (it != logicalPoolMap_.end()) {
         CopySetKey key(data.GetLogicalPoolId(), data.GetId());
-        if (copySetMap_.find(key) == copySetMap_.end()) {
+        CopySetShard &shard = GetCopySetShard(key);
+        WriteLockGuard wlockCopySetShard(shard.mutex);
+        if (shard.copySets.find(key) == shard.copySets.end()) {
             if (!storage_->StorageCopySet(data)) {
                 return kTopoErrCodeStorgeFail;
             }
-            copySetMap_[key] = data;
+            shard.copySets[key] = data;
+            AddCopySetIndex(&shard, key, data.GetCopySetMembers());
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -1241,13 +1292,15 @@ int TopologyImpl::AddCopySet(const CopySetInfo &data) {
 }
 
 int TopologyImpl::RemoveCopySet(CopySetKey key) {
-    WriteLockGuard wlockCopySetMap(copySetMutex_);
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    CopySetShard &shard = GetCopySetShard(key);
+    WriteLockGuard wlockCopySetShard(shard.mutex);
+    auto it = shard.copySets.find(key);
+    if (it != shard.copySets.end()) {
         if (!storage_->DeleteCopySet(key)) {
             return kTopoErrCodeStorgeFail;
         }
-        copySetMap_.erase(key);
+        RemoveCopySetIndex(&shard, key, it->second.GetCopySetMembers());
+        shard.copySets.erase(it);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeCopySetNotFound;
@@ -1255,14 +1308,23 @@ int TopologyImpl::RemoveCopySet(CopySetKey key) {
 }
 
 int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
-    ReadLockGuard rlockCopySetMap(copySetMutex_);
     CopySetKey key(data.GetLogicalPoolId(), data.GetId());
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    CopySetShard &shard = GetCopySetShard(key);
+    ReadLockGuard rlockCopySetShard(shard.mutex);
+    auto it = shard.copySets.find(key);
+    if (it != shard.copySets.end()) {
         WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
         it->second.SetLeader(data.GetLeader());
         it->second.SetEpoch(data.GetEpoch());
-        it->second.SetCopySetMembers(data.GetCopySetMembers());
+        std::set<ChunkServerIdType> oldMembers =
+            it->second.GetCopySetMembers();
+        const std::set<ChunkServerIdType> &newMembers =
+            data.GetCopySetMembers();
+        if (oldMembers != newMembers) {
+            RemoveCopySetIndex(&shard, key, oldMembers);
+            AddCopySetIndex(&shard, key, newMembers);
+            it->second.SetCopySetMembers(newMembers);
+        }
         if (data.HasCandidate()) {
             it->second.SetCandidate(data.GetCandidate());
         } else {
@@ -1289,9 +1351,10 @@ int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
 }
 
 int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
-    ReadLockGuard rlockCopySetMap(copySetMutex_);
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    CopySetShard &shard = GetCopySetShard(key);
+    ReadLockGuard rlockCopySetShard(shard.mutex);
+    auto it = shard.copySets.find(key);
+    if (it != shard.copySets.end()) {
         WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
         auto copysetInfo = it->second;
         copysetInfo.SetAvailableFlag(aval);
@@ -1311,9 +1374,10 @@ int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
 }
 
 bool TopologyImpl::GetCopySet(CopySetKey key, CopySetInfo *out) const {
-    ReadLockGuard rlockCopySetMap(copySetMutex_);
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    const CopySetShard &shard = GetCopySetShard(key);
+    ReadLockGuard rlockCopySetShard(shard.mutex);
+    auto it = shard.copySets.find(key);
+    if (it != shard.copySets.end()) {
         ReadLockGuard rlockCopySet(it->second.GetRWLockRef());
         *out = it->second;
         return true;
@@ -1326,12 +1390,18 @@ std::vector<CopySetIdType> TopologyImpl::GetCopySetsInLogicalPool(
     PoolIdType logicalPoolId,
     CopySetFilter filter) const {
     std::vector<CopySetIdType> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.first.first == logicalPoolId) {
-            ret.push_back(it.first.second);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySetShard(shard.mutex);
+        for (auto it = shard.copySets.lower_bound(
+                 CopySetKey(logicalPoolId, 0));
+             it != shard.copySets.end() && it->first.first == logicalPoolId;
+             ++it) {
+            if (filter(it->second)) {
+                ret.push_back(it->first.second);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
 
@@ -1339,24 +1409,36 @@ std::vector<CopySetInfo> TopologyImpl::GetCopySetInfosInLogicalPool(
     PoolIdType logicalPoolId,
     CopySetFilter filter) const {
     std::vector<CopySetInfo> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.first.first == logicalPoolId) {
-            ret.push_back(it.second);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySetShard(shard.mutex);
+        for (auto it = shard.copySets.lower_bound(
+                 CopySetKey(logicalPoolId, 0));
+             it != shard.copySets.end() && it->first.first == logicalPoolId;
+             ++it) {
+            if (filter(it->second)) {
+                ret.push_back(it->second);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end(),
+        [](const CopySetInfo &a, const CopySetInfo &b) {
+            return a.GetId() < b.GetId();
+        });
     return ret;
 }
 
 std::vector<CopySetKey> TopologyImpl::GetCopySetsInCluster(
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second)) {
-            ret.push_back(it.first);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySetShard(shard.mutex);
+        for (const auto &it : shard.copySets) {
+            if (filter(it.second)) {
+                ret.push_back(it.first);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
 
@@ -1364,12 +1446,21 @@ std::vector<CopySetKey> TopologyImpl::GetCopySetsInChunkServer(
     ChunkServerIdType id,
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.second.GetCopySetMembers().count(id) > 0) {
-            ret.push_back(it.first);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySetShard(shard.mutex);
+        LockGuard lockIndex(shard.indexMutex);
+        auto ix = shard.csIndex.find(id);
+        if (ix == shard.csIndex.end()) {
+            continue;
+        }
+        for (const auto &key : ix->second) {
+            auto it = shard.copySets.find(key);
+            if (it != shard.copySets.end() && filter(it->second)) {
+                ret.push_back(key);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
 
@@ -1400,21 +1491,27 @@ void TopologyImpl::BackEndFunc() {
 }
 
 void TopologyImpl::FlushCopySetToStorage() {
-    std::vector<PoolIdType> pools = GetLogicalPoolInCluster();
-    for (const auto poolId : pools) {
-        ReadLockGuard rlockCopySetMap(copySetMutex_);
-        for (auto &c : copySetMap_) {
-            WriteLockGuard wlockCopySet(c.second.GetRWLockRef());
-            if (c.second.GetDirtyFlag() &&
-                        c.second.GetLogicalPoolId() == poolId) {
-                c.second.SetDirtyFlag(false);
-                if (!storage_->UpdateCopySet(c.second)) {
-                    LOG(WARNING) << "update copyset("
-                                 << c.second.GetLogicalPoolId()
-                                 << "," << c.second.GetId() << ") to repo fail";
+    for (auto &shard : copySetShards_) {
+        // collect dirty copysets under lock, and write them to storage
+        // after the lock is released to not block heartbeat updates
+        std::vector<CopySetInfo> toUpdate;
+        {
+            ReadLockGuard rlockCopySetShard(shard.mutex);
+            for (auto &c : shard.copySets) {
+                WriteLockGuard wlockCopySet(c.second.GetRWLockRef());
+                if (c.second.GetDirtyFlag()) {
+                    c.second.SetDirtyFlag(false);
+                    toUpdate.push_back(c.second);
                 }
             }
         }
+        for (auto &c : toUpdate) {
+            if (!storage_->UpdateCopySet(c)) {
+                LOG(WARNING) << "update copyset("
+                             << c.GetLogicalPoolId()
+                             << "," << c.GetId() << ") to repo fail";
+            }
+        }
     }
 }
 
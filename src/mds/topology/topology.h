@@ -28,6 +28,8 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <set>
+#include <array>
 
 #include "proto/topology.pb.h"
 #include "src/mds/common/mds_define.h"
@@ -690,6 +692,29 @@ class TopologyImpl : public Topology {
 
     bool CreateDefaultPoolset();
 
+    // copysets are sharded by key, so that heartbeat updates and readers
+    // of different copysets do not contend on a single map lock
+    static constexpr uint32_t kCopySetShardNum = 64;
+
+    struct CopySetShard {
+        mutable curve::common::RWLock mutex;
+        std::map<CopySetKey, CopySetInfo> copySets;
+        // index of copysets in this shard by member chunkserver,
+        // protected by indexMutex, which is fetched after mutex
+        mutable curve::common::Mutex indexMutex;
+        std::unordered_map<ChunkServerIdType, std::set<CopySetKey>> csIndex;
+    };
+
+    CopySetShard& GetCopySetShard(const CopySetKey &key);
+    const CopySetShard& GetCopySetShard(const CopySetKey &key) const;
+
+    // caller must hold the write lock of the shard, or the read lock
+    // together with the write lock of the copyset
+    static void AddCopySetIndex(CopySetShard *shard, const CopySetKey &key,
+        const std::set<ChunkServerIdType> &members);
+    static void RemoveCopySetIndex(CopySetShard *shard, const CopySetKey &key,
+        const std::set<ChunkServerIdType> &members);
+
  private:
     std::unordered_map<PoolsetIdType, Poolset> poolsetMap_;
     std::unordered_map<PoolIdType, LogicalPool> logicalPoolMap_;
@@ -698,7 +723,7 @@ class TopologyImpl : public Topology {
     std::unordered_map<ServerIdType, Server> serverMap_;
     std::unordered_map<ChunkServerIdType, ChunkServer> chunkServerMap_;
 
-    std::map<CopySetKey, CopySetInfo> copySetMap_;
+    std::array<CopySetShard, kCopySetShardNum> copySetShards_;
 
     // cluster info
     ClusterInformation clusterInfo;
@@ -714,7 +739,7 @@ class TopologyImpl : public Topology {
     mutable curve::common::RWLock zoneMutex_;
     mutable curve::common::RWLock serverMutex_;
     mutable curve::common::RWLock chunkServerMutex_;
-    mutable curve::common::RWLock copySetMutex_;
+    // then the locks of copySetShards_, in ascending order of shard
 
     TopologyOption option_;
     curve::common::Thread backEndThread_;
@@ -24,6 +24,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
@@ -35,6 +36,29 @@ namespace curve {
 namespace mds {
 namespace topology {
 
+namespace {
+
+// weights of load metrics when comparing two copysets
+const double kDiskUsageWeight = 0.4;
+const double kIOPSWeight = 0.2;
+const double kBandwidthWeight = 0.2;
+const double kLeaderCountWeight = 0.2;
+
+double Normalize(double value, double other) {
+    double max = std::max(value, other);
+    return max > 0 ? value / max : 0;
+}
+
+// score of the load of copyset a relative to copyset b, lower is better
+double RelativeLoadScore(const CopysetLoad &a, const CopysetLoad &b) {
+    return kDiskUsageWeight * Normalize(a.diskUsage, b.diskUsage) +
+           kIOPSWeight * Normalize(a.iops, b.iops) +
+           kBandwidthWeight * Normalize(a.bandwidth, b.bandwidth) +
+           kLeaderCountWeight * Normalize(a.leaderCount, b.leaderCount);
+}
+
+}  // namespace
+
 // logical pool is not designated when calling this function. When executing,
 // a logical will be chosen following the policy (randomly or weighted)
 bool TopologyChunkAllocatorImpl::AllocateChunkRandomInSingleLogicalPool(
@@ -99,6 +123,17 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
         return false;
     }
 
+    if (ChooseCopysetPolicy::kLoadAware == copysetPolicy_) {
+        std::map<ChunkServerIdType, CopysetLoad> csLoads;
+        auto getLoad = [&](CopySetIdType copysetId, CopysetLoad *load) {
+            return GetCopysetLoad(logicalPoolChosenId, copysetId, &csLoads,
+                                  load);
+        };
+        return AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+            copySetIds, logicalPoolChosenId, chunkNumber, chunkSize, getLoad,
+            infos);
+    }
+
     uint32_t nextIndex = 0;
 
     ::curve::common::LockGuard guard(nextIndexMapLock_);
@@ -122,6 +157,67 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
     return ret;
 }
 
+bool TopologyChunkAllocatorImpl::GetCopysetLoad(PoolIdType logicalPoolId,
+    CopySetIdType copysetId,
+    std::map<ChunkServerIdType, CopysetLoad> *csLoads, CopysetLoad *load) {
+    CopySetInfo copyset;
+    if (!topology_->GetCopySet(CopySetKey(logicalPoolId, copysetId),
+                               &copyset)) {
+        return false;
+    }
+
+    *load = CopysetLoad();
+    bool leaderFound = false;
+    uint32_t maxLeaderCount = 0;
+    for (ChunkServerIdType csId : copyset.GetCopySetMembers()) {
+        auto it = csLoads->find(csId);
+        if (it == csLoads->end()) {
+            CopysetLoad csLoad;
+            ChunkServer cs;
+            if (topology_->GetChunkServer(csId, &cs)) {
+                ChunkServerState state = cs.GetChunkServerState();
+                csLoad.diskCapacity = state.GetDiskCapacity();
+                if (csLoad.diskCapacity > 0) {
+                    csLoad.diskUsage =
+                        static_cast<double>(state.GetDiskUsed()) /
+                        csLoad.diskCapacity;
+                }
+            }
+            // chunkserver without heartbeat statistic is regarded as idle
+            ChunkServerStat stat;
+            if (topoStat_->GetChunkServerStat(csId, &stat)) {
+                csLoad.iops = static_cast<uint64_t>(stat.readIOPS) +
+                              stat.writeIOPS;
+                csLoad.bandwidth = static_cast<uint64_t>(stat.readRate) +
+                                   stat.writeRate;
+                csLoad.leaderCount = stat.leaderCount;
+            }
+            it = csLoads->emplace(csId, csLoad).first;
+        }
+
+        const CopysetLoad &csLoad = it->second;
+        load->diskUsage = std::max(load->diskUsage, csLoad.diskUsage);
+        if (csLoad.diskCapacity > 0 && (load->diskCapacity == 0 ||
+                                        csLoad.diskCapacity <
+                                            load->diskCapacity)) {
+            load->diskCapacity = csLoad.diskCapacity;
+        }
+        load->iops = std::max(load->iops, csLoad.iops);
+        load->bandwidth = std::max(load->bandwidth, csLoad.bandwidth);
+        maxLeaderCount = std::max(maxLeaderCount, csLoad.leaderCount);
+        // io of new chunks goes to the leader
+        if (copyset.GetLeader() == csId) {
+            load->leaderCount = csLoad.leaderCount;
+            leaderFound = true;
+        }
+    }
+
+    if (!leaderFound) {
+        load->leaderCount = maxLeaderCount;
+    }
+    return true;
+}
+
 bool TopologyChunkAllocatorImpl::ChooseSingleLogicalPool(
     curve::mds::FileType fileType, const std::string& pstName,
     PoolIdType *poolOut) {
@@ -275,6 +371,71 @@ bool AllocateChunkPolicy::AllocateChunkRoundRobinInSingleLogicalPool(
     return true;
 }
 
+bool AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+    const std::vector<CopySetIdType> &copySetIds, PoolIdType logicalPoolId,
+    uint32_t chunkNumber, ChunkSizeType chunkSize,
+    const CopysetLoadGetter &getLoad, std::vector<CopysetIdInfo> *infos) {
+    if (copySetIds.empty()) {
+        return false;
+    }
+    infos->clear();
+
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, copySetIds.size() - 1);
+
+    // load of copysets sampled in this round
+    std::map<CopySetIdType, CopysetLoad> loads;
+    auto sample = [&](CopySetIdType *copysetId) -> CopysetLoad * {
+        *copysetId = copySetIds[dis(gen)];
+        auto it = loads.find(*copysetId);
+        if (it == loads.end()) {
+            CopysetLoad load;
+            if (!getLoad(*copysetId, &load)) {
+                return nullptr;
+            }
+            it = loads.emplace(*copysetId, load).first;
+        }
+        return &it->second;
+    };
+
+    for (uint32_t i = 0; i < chunkNumber; i++) {
+        CopySetIdType first, second;
+        CopysetLoad *firstLoad = sample(&first);
+        CopysetLoad *secondLoad = sample(&second);
+
+        CopySetIdType chosen;
+        CopysetLoad *chosenLoad;
+        if (firstLoad == nullptr && secondLoad == nullptr) {
+            LOG(ERROR) << "get load of copyset " << first << " and "
+                       << second << " fail, logicalPoolId = "
+                       << logicalPoolId;
+            return false;
+        } else if (secondLoad == nullptr ||
+                   (firstLoad != nullptr &&
+                    RelativeLoadScore(*firstLoad, *secondLoad) <=
+                        RelativeLoadScore(*secondLoad, *firstLoad))) {
+            chosen = first;
+            chosenLoad = firstLoad;
+        } else {
+            chosen = second;
+            chosenLoad = secondLoad;
+        }
+
+        // the chunk will take space of the copyset
+        if (chosenLoad->diskCapacity > 0) {
+            chosenLoad->diskUsage +=
+                static_cast<double>(chunkSize) / chosenLoad->diskCapacity;
+        }
+
+        CopysetIdInfo idInfo;
+        idInfo.logicalPoolId = logicalPoolId;
+        idInfo.copySetId = chosen;
+        infos->push_back(idInfo);
+    }
+    return true;
+}
+
 bool AllocateChunkPolicy::ChooseSingleLogicalPoolByWeight(
     const std::map<PoolIdType, double> &poolWeightMap, PoolIdType *poolIdOut) {
     if (poolWeightMap.empty()) {
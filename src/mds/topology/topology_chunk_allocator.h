@@ -47,6 +47,32 @@ enum class ChoosePoolPolicy {
     kWeight,
 };
 
+enum class ChooseCopysetPolicy {
+    // choose copysets by round robin
+    kRoundRobin = 0,
+    // choose the less loaded one of two random copysets
+    kLoadAware,
+};
+
+/**
+ * @brief load of a copyset, which is the load of its busiest replica
+ */
+struct CopysetLoad {
+    // max disk used ratio of replicas, [0, 1]
+    double diskUsage = 0;
+    // min disk capacity of replicas
+    uint64_t diskCapacity = 0;
+    // max read + write IOPS of replicas
+    uint64_t iops = 0;
+    // max read + write bandwidth of replicas
+    uint64_t bandwidth = 0;
+    // leader count of the chunkserver which is the copyset leader
+    uint32_t leaderCount = 0;
+};
+
+using CopysetLoadGetter =
+    std::function<bool(CopySetIdType copysetId, CopysetLoad *load)>;
+
 class ChunkFilePoolAllocHelp {
  public:
     ChunkFilePoolAllocHelp()
@@ -123,7 +149,9 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
           topoStat_(topologyStat),
           chunkFilePoolAllocHelp_(ChunkFilePoolAllocHelp),
           policy_(static_cast<ChoosePoolPolicy>(option.choosePoolPolicy)),
-          enableLogicalPoolStatus_(option.enableLogicalPoolStatus) {
+          enableLogicalPoolStatus_(option.enableLogicalPoolStatus),
+          copysetPolicy_(static_cast<ChooseCopysetPolicy>(
+              option.chooseCopysetPolicy)) {
         std::srand(std::time(nullptr));
     }
     ~TopologyChunkAllocatorImpl() {}
@@ -148,7 +176,8 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         std::vector<CopysetIdInfo> *infos) override;
 
     /**
-     * @brief allocate chunks by round robin in a single logical pool
+     * @brief allocate chunks by round robin in a single logical pool,
+     *        or by copyset load if ChooseCopysetPolicy::kLoadAware is set
      *
      * @param fileType file type
      * @param chunkNumber number of chunks to allocate
@@ -191,6 +220,21 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         const std::string& pstName,
         PoolIdType *poolOut);
 
+    /**
+     * @brief get load of a copyset from the chunkserver state and the
+     *        statistic reported by heartbeat
+     *
+     * @param logicalPoolId logical pool of the copyset
+     * @param copysetId copyset id
+     * @param[in][out] csLoads loads of chunkservers got already
+     * @param[out] load load of the copyset
+     *
+     * @retval true if succeeded
+     * @retval false if the copyset is not found
+     */
+    bool GetCopysetLoad(PoolIdType logicalPoolId, CopySetIdType copysetId,
+        std::map<ChunkServerIdType, CopysetLoad> *csLoads, CopysetLoad *load);
+
  private:
     std::shared_ptr<Topology> topology_;
 
@@ -220,6 +264,8 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     ChoosePoolPolicy policy_;
     // enableLogicalPoolStatus
     bool enableLogicalPoolStatus_;
+    // policy for choosing copyset
+    ChooseCopysetPolicy copysetPolicy_;
 };
 
 /**
@@ -265,6 +311,29 @@ class AllocateChunkPolicy {
         uint32_t *nextIndex, uint32_t chunkNumber,
         std::vector<CopysetIdInfo> *infos);
 
+    /**
+     * @brief allocate chunks by copyset load in a single logical pool.
+     *        For every chunk, two copysets are chosen randomly and the less
+     *        loaded one is used (power of two choices), so only a few
+     *        copysets' load is needed. Chunks allocated in this round are
+     *        counted into the disk usage of their copysets.
+     *
+     * @param copySetIds copyset id list in designated logical pool
+     * @param logicalPoolId target logical pool id
+     * @param chunkNumber number of chunks to allocate
+     * @param chunkSize size of a chunk
+     * @param getLoad function to get the load of a copyset
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed
+     */
+    static bool AllocateChunkByLoadInSingleLogicalPool(
+        const std::vector<CopySetIdType> &copySetIds,
+        PoolIdType logicalPoolId, uint32_t chunkNumber,
+        ChunkSizeType chunkSize, const CopysetLoadGetter &getLoad,
+        std::vector<CopysetIdInfo> *infos);
+
     /**
      * @brief choose a logical pool according to their weight
      *
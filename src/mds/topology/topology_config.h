@@ -46,6 +46,8 @@ struct TopologyOption {
     int choosePoolPolicy;
     // enable LogicalPool ALLOW/DENY status
     bool enableLogicalPoolStatus;
+    // policy of copyset choosing when allocating chunks
+    int chooseCopysetPolicy;
 
     TopologyOption()
         : TopologyUpdateToRepoSec(0),
@@ -54,7 +56,8 @@ struct TopologyOption {
           CreateCopysetRpcRetrySleepTimeMs(500),
           UpdateMetricIntervalSec(0),
           choosePoolPolicy(0),
-          enableLogicalPoolStatus(false) {}
+          enableLogicalPoolStatus(false),
+          chooseCopysetPolicy(0) {}
 };
 
 }  // namespace topology
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
 
 #include "src/snapshotcloneserver/clone/clone_task.h"
 #include "src/common/location_operator.h"
@@ -40,6 +41,14 @@ using ::curve::common::NameLockGuard;
 namespace curve {
 namespace snapshotcloneserver {
 
+namespace {
+
+uint64_t CopysetKey(const ChunkIDInfo &cidInfo) {
+    return (static_cast<uint64_t>(cidInfo.lpid_) << 32) | cidInfo.cpid_;
+}
+
+}  // namespace
+
 int CloneCoreImpl::Init() {
     int ret = client_->Mkdir(cloneTempDir_, mdsRootUser_);
     if (ret != LIBCURVE_ERROR::OK &&
@@ -538,6 +547,8 @@ int CloneCoreImpl::BuildFileInfoFromSnapshot(
         CloneChunkInfo info;
         info.location = chunkDataName.ToDataChunkKey();
         info.needRecover = true;
+        info.blockFormat =
+            snapMeta.GetChunkDataFormat(chunkIndex) == CHUNK_DATA_BLOCK;
         if (IsRecover(task)) {
             info.seqNum = chunkDataName.chunkSeqNum_;
         } else {
@@ -749,10 +760,23 @@ int CloneCoreImpl::CreateCloneChunk(
         correctSn = fInfo.seqnum;
     }
     auto tracker = std::make_shared<CreateCloneChunkTaskTracker>();
+    // 同一copyset上的chunk攒够一批后通过一次请求创建
+    bool useBatch = cloneChunkBatchSize_ > 1;
+    std::map<uint64_t, std::vector<CreateCloneChunkContextPtr>> batches;
     for (auto & cloneSegmentInfo : *segInfos) {
         for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
             std::string location;
-            if (IsSnapshot(task)) {
+            if (IsSnapshot(task) && snapshotDataStoreLocal_) {
+                // chunkserver从挂载的local快照数据存储目录读取
+                location = cloneChunkInfo.second.blockFormat ?
+                    LocationOperator::GenerateLocalBlockLocation(
+                        cloneChunkInfo.second.location) :
+                    LocationOperator::GenerateLocalLocation(
+                        cloneChunkInfo.second.location);
+            } else if (IsSnapshot(task) && cloneChunkInfo.second.blockFormat) {
+                location = LocationOperator::GenerateS3BlockLocation(
+                    cloneChunkInfo.second.location);
+            } else if (IsSnapshot(task)) {
                 location = LocationOperator::GenerateS3Location(
                     cloneChunkInfo.second.location);
             } else {
@@ -774,7 +798,17 @@ int CloneCoreImpl::CreateCloneChunk(
             context->clientAsyncMethodRetryTimeSec =
                 clientAsyncMethodRetryTimeSec_;
 
-            ret = StartAsyncCreateCloneChunk(task, tracker, context);
+            if (useBatch) {
+                auto &batch = batches[CopysetKey(cidInfo)];
+                batch.push_back(context);
+                if (batch.size() < cloneChunkBatchSize_) {
+                    continue;
+                }
+                ret = StartAsyncCreateCloneChunks(task, tracker, batch);
+                batch.clear();
+            } else {
+                ret = StartAsyncCreateCloneChunk(task, tracker, context);
+            }
             if (ret < 0) {
                 return kErrCodeInternalError;
             }
@@ -784,12 +818,42 @@ int CloneCoreImpl::CreateCloneChunk(
             }
             std::list<CreateCloneChunkContextPtr> results =
                 tracker->PopResultContexts();
-            ret = HandleCreateCloneChunkResultsAndRetry(task, tracker, results);
+            ret = HandleCreateCloneChunkResultsAndRetry(task, tracker, results,
+                &useBatch);
             if (ret < 0) {
                 return kErrCodeInternalError;
             }
         }
     }
+    // 各copyset上不足一批的chunk
+    for (auto &batch : batches) {
+        if (batch.second.empty()) {
+            continue;
+        }
+        if (useBatch) {
+            ret = StartAsyncCreateCloneChunks(task, tracker, batch.second);
+        } else {
+            for (auto &context : batch.second) {
+                ret = StartAsyncCreateCloneChunk(task, tracker, context);
+                if (ret < 0) {
+                    break;
+                }
+            }
+        }
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+        if (tracker->GetTaskNum() >= createCloneChunkConcurrency_) {
+            tracker->WaitSome(1);
+        }
+        std::list<CreateCloneChunkContextPtr> results =
+            tracker->PopResultContexts();
+        ret = HandleCreateCloneChunkResultsAndRetry(task, tracker, results,
+            &useBatch);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+    }
     // 最后剩余数量不足的任务
     do {
         tracker->WaitSome(1);
@@ -799,7 +863,8 @@ int CloneCoreImpl::CreateCloneChunk(
             // 已经完成，没有新的结果了
             break;
         }
-        ret = HandleCreateCloneChunkResultsAndRetry(task, tracker, results);
+        ret = HandleCreateCloneChunkResultsAndRetry(task, tracker, results,
+            &useBatch);
         if (ret < 0) {
             return kErrCodeInternalError;
         }
@@ -857,13 +922,64 @@ int CloneCoreImpl::StartAsyncCreateCloneChunk(
     return kErrCodeSuccess;
 }
 
+int CloneCoreImpl::StartAsyncCreateCloneChunks(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
+    const std::vector<CreateCloneChunkContextPtr> &contexts) {
+    if (contexts.size() == 1) {
+        return StartAsyncCreateCloneChunk(task, tracker, contexts.front());
+    }
+    std::vector<CloneChunkItem> chunks;
+    for (const auto &context : contexts) {
+        CloneChunkItem item;
+        item.chunkId = context->cidInfo.cid_;
+        item.location = context->location;
+        item.sn = context->sn;
+        item.correctedSn = context->csn;
+        item.len = context->chunkSize;
+        chunks.push_back(item);
+    }
+    const ChunkIDInfo &cidInfo = contexts.front()->cidInfo;
+    CreateCloneChunksClosure *cb =
+        new CreateCloneChunksClosure(tracker, contexts);
+    tracker->AddOneTrace();
+    LOG(INFO) << "Doing CreateCloneChunks"
+              << ", logicalPoolId = " << cidInfo.lpid_
+              << ", copysetId = " << cidInfo.cpid_
+              << ", chunkNum = " << chunks.size()
+              << ", firstChunkId = " << cidInfo.cid_
+              << ", taskid = " << task->GetTaskId();
+    int ret = client_->CreateCloneChunks(cidInfo.lpid_,
+        cidInfo.cpid_,
+        chunks,
+        cb);
+    if (ret != LIBCURVE_ERROR::OK) {
+        LOG(ERROR) << "CreateCloneChunks fail"
+                   << ", ret = " << ret
+                   << ", logicalPoolId = " << cidInfo.lpid_
+                   << ", copysetId = " << cidInfo.cpid_
+                   << ", chunkNum = " << chunks.size()
+                   << ", taskid = " << task->GetTaskId();
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
 int CloneCoreImpl::HandleCreateCloneChunkResultsAndRetry(
     std::shared_ptr<CloneTaskInfo> task,
     std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
-    const std::list<CreateCloneChunkContextPtr> &results) {
+    const std::list<CreateCloneChunkContextPtr> &results,
+    bool *useBatch) {
     int ret = kErrCodeSuccess;
     for (auto context : results) {
-        if (context->retCode == -LIBCURVE_ERROR::EXISTS) {
+        if (context->retCode == -LIBCURVE_ERROR::NOT_SUPPORT) {
+            // chunkserver不支持批量接口，之后逐个chunk请求
+            *useBatch = false;
+            ret = StartAsyncCreateCloneChunk(task, tracker, context);
+            if (ret < 0) {
+                return kErrCodeInternalError;
+            }
+        } else if (context->retCode == -LIBCURVE_ERROR::EXISTS) {
             LOG(INFO) << "CreateCloneChunk chunk exist"
                       << ", location = " << context->location
                       << ", logicalPoolId = " << context->cidInfo.lpid_
@@ -941,9 +1057,6 @@ int CloneCoreImpl::RecoverChunk(
 
     uint32_t totalProgress =
         kProgressRecoverChunkEnd - kProgressRecoverChunkBegin;
-    uint32_t segNum = segInfos.size();
-    double progressPerData = static_cast<double>(totalProgress) / segNum;
-    uint32_t index = 0;
 
     if (0 == cloneChunkSplitSize_ ||
         chunkSize % cloneChunkSplitSize_ != 0) {
@@ -953,28 +1066,61 @@ int CloneCoreImpl::RecoverChunk(
     }
 
     auto tracker = std::make_shared<RecoverChunkTaskTracker>();
-    uint64_t workingChunkNum = 0;
-    // 为避免发往同一个chunk碰撞，异步请求不同的chunk
+    RecoverChunkScheduler scheduler(recoverChunkConcurrency_,
+        recoverHotChunkNeighborNum_,
+        recoverChunkSlowPartMs_);
     for (auto & cloneSegmentInfo : segInfos) {
         for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
-            if (!cloneChunkInfo.second.needRecover) {
-                continue;
+            if (cloneChunkInfo.second.needRecover) {
+                scheduler.AddChunk(cloneChunkInfo.second.chunkIdInfo);
             }
-            // 当前并发工作的chunk数已大于要求的并发数时，先消化一部分
-            while (workingChunkNum >= recoverChunkConcurrency_) {
-                uint64_t completeChunkNum = 0;
-                ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
-                    tracker,
-                    &completeChunkNum);
-                if (ret < 0) {
-                    return kErrCodeInternalError;
-                }
-                workingChunkNum -= completeChunkNum;
+        }
+    }
+    double progressPerData = 0;
+    if (scheduler.GetChunkNum() > 0) {
+        progressPerData =
+            static_cast<double>(totalProgress) / scheduler.GetChunkNum();
+    }
+
+    uint64_t workingChunkNum = 0;
+    // 同一copyset上的chunk一起开始恢复，之后每个分片的请求合并发送
+    bool useBatch = cloneChunkBatchSize_ > 1;
+    ChunkIDInfo cidInfo;
+    // 为避免发往同一个chunk碰撞，异步请求不同的chunk
+    while (scheduler.HasPendingChunk()) {
+        // 当前并发工作的chunk数已达到并发数时，先消化一部分，
+        // 返回结果中读穿透的chunk会调整之后的恢复顺序
+        while (workingChunkNum >= scheduler.GetConcurrency()) {
+            uint64_t completeChunkNum = 0;
+            ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
+                tracker,
+                &scheduler,
+                &useBatch,
+                &completeChunkNum);
+            if (ret < 0) {
+                return kErrCodeInternalError;
             }
-            // 加入新的工作的chunk
+            workingChunkNum -= completeChunkNum;
+        }
+        if (!scheduler.NextChunk(&cidInfo)) {
+            break;
+        }
+        std::vector<ChunkIDInfo> cidInfos(1, cidInfo);
+        while (useBatch && cidInfos.size() < cloneChunkBatchSize_ &&
+               workingChunkNum + cidInfos.size() <
+                   scheduler.GetConcurrency()) {
+            ChunkIDInfo next = cidInfo;
+            if (!scheduler.NextChunkInCopyset(&next)) {
+                break;
+            }
+            cidInfos.push_back(next);
+        }
+        // 加入新的工作的chunk
+        std::vector<RecoverChunkContextPtr> contexts;
+        for (const auto &startInfo : cidInfos) {
             workingChunkNum++;
             auto context = std::make_shared<RecoverChunkContext>();
-            context->cidInfo = cloneChunkInfo.second.chunkIdInfo;
+            context->cidInfo = startInfo;
             context->totalPartNum = chunkSize / cloneChunkSplitSize_;
             context->partIndex = 0;
             context->partSize = cloneChunkSplitSize_;
@@ -990,22 +1136,27 @@ int CloneCoreImpl::RecoverChunk(
                        << ", chunkId = " << context->cidInfo.cid_
                        << ", len = " << context->partSize
                        << ", taskid = " << task->GetTaskId();
+            contexts.push_back(context);
+        }
 
-            ret = StartAsyncRecoverChunkPart(task, tracker, context);
-            if (ret < 0) {
-                return kErrCodeInternalError;
-            }
+        ret = StartAsyncRecoverChunkParts(task, tracker, contexts, useBatch);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+        uint32_t progress = static_cast<uint32_t>(kProgressRecoverChunkBegin
+            + scheduler.GetStartedNum() * progressPerData);
+        if (progress != task->GetProgress()) {
+            task->SetProgress(progress);
+            task->UpdateMetric();
         }
-        task->SetProgress(static_cast<uint32_t>(
-            kProgressRecoverChunkBegin + index * progressPerData));
-        task->UpdateMetric();
-        index++;
     }
 
     while (workingChunkNum > 0) {
         uint64_t completeChunkNum = 0;
         ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
             tracker,
+            &scheduler,
+            &useBatch,
             &completeChunkNum);
         if (ret < 0) {
             return kErrCodeInternalError;
@@ -1030,6 +1181,7 @@ int CloneCoreImpl::StartAsyncRecoverChunkPart(
     std::shared_ptr<RecoverChunkContext> context) {
     RecoverChunkClosure *cb = new RecoverChunkClosure(tracker, context);
     tracker->AddOneTrace();
+    context->partStartTimeMs = TimeUtility::GetTimeofDayMs();
     uint64_t offset = context->partIndex * context->partSize;
     LOG_EVERY_SECOND(INFO) << "Doing RecoverChunk"
                << ", logicalPoolId = "
@@ -1058,27 +1210,120 @@ int CloneCoreImpl::StartAsyncRecoverChunkPart(
     return kErrCodeSuccess;
 }
 
+int CloneCoreImpl::StartAsyncRecoverChunkParts(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<RecoverChunkTaskTracker> tracker,
+    const std::vector<RecoverChunkContextPtr> &contexts,
+    bool useBatch) {
+    int ret = kErrCodeSuccess;
+    if (!useBatch) {
+        for (const auto &context : contexts) {
+            ret = StartAsyncRecoverChunkPart(task, tracker, context);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return kErrCodeSuccess;
+    }
+    std::map<uint64_t, std::vector<RecoverChunkContextPtr>> batches;
+    for (const auto &context : contexts) {
+        auto &batch = batches[CopysetKey(context->cidInfo)];
+        batch.push_back(context);
+        if (batch.size() >= cloneChunkBatchSize_) {
+            ret = StartAsyncRecoverChunkBatch(task, tracker, batch);
+            if (ret < 0) {
+                return ret;
+            }
+            batch.clear();
+        }
+    }
+    for (auto &batch : batches) {
+        if (batch.second.empty()) {
+            continue;
+        }
+        ret = StartAsyncRecoverChunkBatch(task, tracker, batch.second);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return kErrCodeSuccess;
+}
+
+int CloneCoreImpl::StartAsyncRecoverChunkBatch(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<RecoverChunkTaskTracker> tracker,
+    const std::vector<RecoverChunkContextPtr> &contexts) {
+    if (contexts.size() == 1) {
+        return StartAsyncRecoverChunkPart(task, tracker, contexts.front());
+    }
+    uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+    std::vector<CloneChunkItem> chunks;
+    for (const auto &context : contexts) {
+        context->partStartTimeMs = nowMs;
+        CloneChunkItem item;
+        item.chunkId = context->cidInfo.cid_;
+        item.offset = context->partIndex * context->partSize;
+        item.len = context->partSize;
+        chunks.push_back(item);
+    }
+    const ChunkIDInfo &cidInfo = contexts.front()->cidInfo;
+    RecoverChunksClosure *cb = new RecoverChunksClosure(tracker, contexts);
+    tracker->AddOneTrace();
+    LOG_EVERY_SECOND(INFO) << "Doing RecoverChunks"
+               << ", logicalPoolId = " << cidInfo.lpid_
+               << ", copysetId = " << cidInfo.cpid_
+               << ", chunkNum = " << chunks.size()
+               << ", firstChunkId = " << cidInfo.cid_
+               << ", taskid = " << task->GetTaskId();
+    int ret = client_->RecoverChunks(cidInfo.lpid_,
+        cidInfo.cpid_,
+        chunks,
+        cb);
+    if (ret != LIBCURVE_ERROR::OK) {
+        LOG(ERROR) << "RecoverChunks fail"
+                   << ", ret = " << ret
+                   << ", logicalPoolId = " << cidInfo.lpid_
+                   << ", copysetId = " << cidInfo.cpid_
+                   << ", chunkNum = " << chunks.size()
+                   << ", taskid = " << task->GetTaskId();
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
 int CloneCoreImpl::ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(
     std::shared_ptr<CloneTaskInfo> task,
     std::shared_ptr<RecoverChunkTaskTracker> tracker,
+    RecoverChunkScheduler *scheduler,
+    bool *useBatch,
     uint64_t *completeChunkNum) {
     *completeChunkNum = 0;
     tracker->WaitSome(1);
     std::list<RecoverChunkContextPtr> results =
         tracker->PopResultContexts();
+    uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+    // 需要重试或继续下一个分片的chunk，处理完所有结果后一起发起，
+    // 同一copyset上的chunk可以合并成一次请求
+    std::vector<RecoverChunkContextPtr> nextParts;
+    bool needRetryWait = false;
     for (auto context : results) {
+        scheduler->PromoteHotChunks(context->hotChunks);
+        context->hotChunks.clear();
+        if (context->retCode == -LIBCURVE_ERROR::NOT_SUPPORT) {
+            // chunkserver不支持批量接口，之后逐个chunk请求
+            *useBatch = false;
+            nextParts.push_back(context);
+            continue;
+        }
+        scheduler->OnPartDone(context->retCode == LIBCURVE_ERROR::OK,
+            nowMs - context->partStartTimeMs);
         if (context->retCode != LIBCURVE_ERROR::OK) {
             uint64_t nowTime = TimeUtility::GetTimeofDaySec();
             if (nowTime - context->startTime <
                 context->clientAsyncMethodRetryTimeSec) {
                 // retry
-                std::this_thread::sleep_for(
-                    std::chrono::milliseconds(
-                        clientAsyncMethodRetryIntervalMs_));
-                int ret = StartAsyncRecoverChunkPart(task, tracker, context);
-                if (ret < 0) {
-                    return ret;
-                }
+                needRetryWait = true;
+                nextParts.push_back(context);
             } else {
                 LOG(ERROR) << "RecoverChunk tracker GetResult fail"
                            << ", ret = " << context->retCode
@@ -1090,10 +1335,7 @@ int CloneCoreImpl::ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(
             context->partIndex++;
             context->startTime = TimeUtility::GetTimeofDaySec();
             if (context->partIndex < context->totalPartNum) {
-                int ret = StartAsyncRecoverChunkPart(task, tracker, context);
-                if (ret < 0) {
-                    return ret;
-                }
+                nextParts.push_back(context);
             } else {
                 LOG(INFO) << "RecoverChunk Complete"
                            << ", logicalPoolId = "
@@ -1106,7 +1348,11 @@ int CloneCoreImpl::ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(
             }
         }
     }
-    return kErrCodeSuccess;
+    if (needRetryWait) {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(clientAsyncMethodRetryIntervalMs_));
+    }
+    return StartAsyncRecoverChunkParts(task, tracker, nextParts, *useBatch);
 }
 
 int CloneCoreImpl::ChangeOwner(
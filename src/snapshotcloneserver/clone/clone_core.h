@@ -35,6 +35,7 @@
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
 #include "src/snapshotcloneserver/clone/clone_reference.h"
+#include "src/snapshotcloneserver/clone/recover_chunk_scheduler.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
 #include "src/common/concurrent/name_lock.h"
 
@@ -208,6 +209,8 @@ struct CloneChunkInfo {
     uint64_t seqNum;
     // chunk是否需要recover
     bool needRecover;
+    // 快照chunk数据是否为CHUNK_DATA_BLOCK格式
+    bool blockFormat = false;
 };
 
 // 克隆/恢复所需segment信息，key是ChunkIndex In Segment, value是chunk信息
@@ -237,6 +240,10 @@ class CloneCoreImpl : public CloneCore {
         mdsRootUser_(option.mdsRootUser),
         createCloneChunkConcurrency_(option.createCloneChunkConcurrency),
         recoverChunkConcurrency_(option.recoverChunkConcurrency),
+        recoverChunkSlowPartMs_(option.recoverChunkSlowPartMs),
+        recoverHotChunkNeighborNum_(option.recoverHotChunkNeighborNum),
+        cloneChunkBatchSize_(option.cloneChunkBatchSize),
+        snapshotDataStoreLocal_(option.snapshotDataStoreLocal),
         clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
         clientAsyncMethodRetryIntervalMs_(
             option.clientAsyncMethodRetryIntervalMs) {}
@@ -410,19 +417,36 @@ class CloneCoreImpl : public CloneCore {
         std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
         std::shared_ptr<CreateCloneChunkContext> context);
 
+    /**
+     * @brief 开始同一copyset上多个chunk的CreateCloneChunks异步请求，
+     *        只有一个chunk时使用CreateCloneChunk
+     *
+     * @param task 任务信息
+     * @param tracker CreateCloneChunk任务追踪器
+     * @param contexts 同一copyset上的CreateCloneChunk上下文
+     *
+     * @return 错误码
+     */
+    int StartAsyncCreateCloneChunks(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
+        const std::vector<CreateCloneChunkContextPtr> &contexts);
+
     /**
      * @brief 处理CreateCloneChunk的结果并重试
      *
      * @param task 任务信息
      * @param tracker CreateCloneChunk任务追踪器
      * @param results CreateCloneChunk结果列表
+     * @param[out] useBatch chunkserver不支持批量接口时置为false
      *
      * @return 错误码
      */
     int HandleCreateCloneChunkResultsAndRetry(
         std::shared_ptr<CloneTaskInfo> task,
         std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
-        const std::list<CreateCloneChunkContextPtr> &results);
+        const std::list<CreateCloneChunkContextPtr> &results,
+        bool *useBatch);
 
     /**
      * @brief 通知mds完成源数据创建步骤
@@ -466,11 +490,44 @@ class CloneCoreImpl : public CloneCore {
         std::shared_ptr<RecoverChunkTaskTracker> tracker,
         std::shared_ptr<RecoverChunkContext> context);
 
+    /**
+     * @brief 开始多个chunk当前分片的RecoverChunk异步请求，
+     *        useBatch时同一copyset上的chunk合并成RecoverChunks请求
+     *
+     * @param task 任务信息
+     * @param tracker RecoverChunk异步任务跟踪器
+     * @param contexts RecoverChunk上下文
+     * @param useBatch 是否使用批量接口
+     *
+     * @return 错误码
+     */
+    int StartAsyncRecoverChunkParts(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<RecoverChunkTaskTracker> tracker,
+        const std::vector<RecoverChunkContextPtr> &contexts,
+        bool useBatch);
+
+    /**
+     * @brief 同一copyset上多个chunk当前分片合并成一次RecoverChunks异步请求
+     *
+     * @param task 任务信息
+     * @param tracker RecoverChunk异步任务跟踪器
+     * @param contexts 同一copyset上的RecoverChunk上下文
+     *
+     * @return 错误码
+     */
+    int StartAsyncRecoverChunkBatch(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<RecoverChunkTaskTracker> tracker,
+        const std::vector<RecoverChunkContextPtr> &contexts);
+
     /**
      * @brief 继续RecoverChunk的其他部分的请求以及等待完成某些RecoverChunk
      *
      * @param task 任务信息
      * @param tracker RecoverChunk异步任务跟踪者
+     * @param scheduler 根据返回结果调整恢复顺序和并发数
+     * @param[in,out] useBatch 是否使用批量接口，chunkserver不支持时置为false
      * @param[out] completeChunkNum 完成的chunk数
      *
      * @return 错误码
@@ -478,6 +535,8 @@ class CloneCoreImpl : public CloneCore {
     int ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(
         std::shared_ptr<CloneTaskInfo> task,
         std::shared_ptr<RecoverChunkTaskTracker> tracker,
+        RecoverChunkScheduler *scheduler,
+        bool *useBatch,
         uint64_t *completeChunkNum);
 
     /**
@@ -597,6 +656,14 @@ class CloneCoreImpl : public CloneCore {
     uint32_t createCloneChunkConcurrency_;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency_;
+    // RecoverChunk分片耗时超过该值时降低并发数
+    uint64_t recoverChunkSlowPartMs_;
+    // 读穿透的chunk之后一起提前恢复的chunk数量
+    uint32_t recoverHotChunkNeighborNum_;
+    // 同一copyset上一次CreateCloneChunk/RecoverChunk请求最多携带的chunk数
+    uint32_t cloneChunkBatchSize_;
+    // 快照数据是否存储在local
+    bool snapshotDataStoreLocal_;
     // client异步请求重试时间
     uint64_t clientAsyncMethodRetryTimeSec_;
     // 调用client异步方法重试时间间隔
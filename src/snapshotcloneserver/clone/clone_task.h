@@ -23,8 +23,10 @@
 #ifndef SRC_SNAPSHOTCLONESERVER_CLONE_CLONE_TASK_H_
 #define SRC_SNAPSHOTCLONESERVER_CLONE_CLONE_TASK_H_
 
+#include <set>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "src/snapshotcloneserver/clone/clone_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
@@ -196,6 +198,42 @@ struct CreateCloneChunkClosure : public SnapCloneClosure {
     CreateCloneChunkContextPtr context_;
 };
 
+// 同一copyset上的多个chunk通过一次CreateCloneChunks请求创建，
+// 返回后每个chunk的结果分别放入tracker，失败的chunk逐个重试
+struct CreateCloneChunksClosure : public SnapCloneClosure {
+    CreateCloneChunksClosure(
+        std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
+        const std::vector<CreateCloneChunkContextPtr> &contexts)
+        : tracker_(tracker),
+          contexts_(contexts) {}
+    void Run() {
+        std::unique_ptr<CreateCloneChunksClosure> self_guard(this);
+        int retCode = GetRetCode();
+        if (retCode < 0) {
+            LOG(WARNING) << "CreateCloneChunksClosure return fail"
+                         << ", ret = " << retCode
+                         << ", logicalPoolId = "
+                         << contexts_.front()->cidInfo.lpid_
+                         << ", copysetId = " << contexts_.front()->cidInfo.cpid_
+                         << ", chunkNum = " << contexts_.size()
+                         << ", taskid = " << contexts_.front()->taskid;
+        }
+        std::set<ChunkID> existChunks(GetExistChunks()->begin(),
+                                      GetExistChunks()->end());
+        for (auto &context : contexts_) {
+            context->retCode = retCode;
+            if (retCode == LIBCURVE_ERROR::OK &&
+                existChunks.count(context->cidInfo.cid_) > 0) {
+                context->retCode = -LIBCURVE_ERROR::EXISTS;
+            }
+            tracker_->PushResultContext(context);
+        }
+        tracker_->HandleResponse(retCode);
+    }
+    std::shared_ptr<CreateCloneChunkTaskTracker> tracker_;
+    std::vector<CreateCloneChunkContextPtr> contexts_;
+};
+
 struct RecoverChunkContext {
     // chunkid 信息
     ChunkIDInfo cidInfo;
@@ -213,6 +251,10 @@ struct RecoverChunkContext {
     uint64_t startTime;
     // 异步请求重试总时间
     uint64_t clientAsyncMethodRetryTimeSec;
+    // 当前分片请求的发送时间
+    uint64_t partStartTimeMs;
+    // chunkserver返回的同一copyset中最近被读穿透的chunk
+    std::vector<ChunkID> hotChunks;
 };
 
 using RecoverChunkContextPtr = std::shared_ptr<RecoverChunkContext>;
@@ -225,6 +267,7 @@ struct RecoverChunkClosure : public SnapCloneClosure {
     void Run() {
         std::unique_ptr<RecoverChunkClosure> self_guard(this);
         context_->retCode = GetRetCode();
+        context_->hotChunks.swap(*GetHotChunks());
         if (context_->retCode < 0) {
             LOG(WARNING) << "RecoverChunkClosure return fail"
                          << ", ret = " << context_->retCode
@@ -243,6 +286,37 @@ struct RecoverChunkClosure : public SnapCloneClosure {
     RecoverChunkContextPtr context_;
 };
 
+// 同一copyset上多个chunk的同一分片通过一次RecoverChunks请求恢复，
+// 返回后每个chunk的结果分别放入tracker
+struct RecoverChunksClosure : public SnapCloneClosure {
+    RecoverChunksClosure(std::shared_ptr<RecoverChunkTaskTracker> tracker,
+        const std::vector<RecoverChunkContextPtr> &contexts)
+        : tracker_(tracker),
+          contexts_(contexts) {}
+    void Run() {
+        std::unique_ptr<RecoverChunksClosure> self_guard(this);
+        int retCode = GetRetCode();
+        if (retCode < 0) {
+            LOG(WARNING) << "RecoverChunksClosure return fail"
+                         << ", ret = " << retCode
+                         << ", logicalPoolId = "
+                         << contexts_.front()->cidInfo.lpid_
+                         << ", copysetId = " << contexts_.front()->cidInfo.cpid_
+                         << ", chunkNum = " << contexts_.size()
+                         << ", taskid = " << contexts_.front()->taskid;
+        }
+        // 读穿透的chunk是整个copyset的，放在第一个chunk的结果中即可
+        contexts_.front()->hotChunks.swap(*GetHotChunks());
+        for (auto &context : contexts_) {
+            context->retCode = retCode;
+            tracker_->PushResultContext(context);
+        }
+        tracker_->HandleResponse(retCode);
+    }
+    std::shared_ptr<RecoverChunkTaskTracker> tracker_;
+    std::vector<RecoverChunkContextPtr> contexts_;
+};
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
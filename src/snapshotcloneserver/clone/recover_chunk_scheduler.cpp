@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/snapshotcloneserver/clone/recover_chunk_scheduler.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace curve {
+namespace snapshotcloneserver {
+
+RecoverChunkScheduler::RecoverChunkScheduler(uint32_t maxConcurrency,
+                                             uint32_t hotNeighborNum,
+                                             uint64_t slowPartMs)
+    : maxConcurrency_(std::max(maxConcurrency, 1u)),
+      hotNeighborNum_(hotNeighborNum),
+      slowPartMs_(slowPartMs),
+      concurrency_(std::max(maxConcurrency, 1u)),
+      partsSinceAdjust_(0),
+      cursor_(0),
+      startedNum_(0) {}
+
+void RecoverChunkScheduler::AddChunk(const ChunkIDInfo &cidInfo) {
+    chunkPos_[cidInfo.cid_] = chunks_.size();
+    copysetChunks_[CopysetKey(cidInfo)].push_back(chunks_.size());
+    chunks_.push_back(cidInfo);
+    started_.push_back(false);
+    queued_.push_back(false);
+}
+
+bool RecoverChunkScheduler::NextChunk(ChunkIDInfo *cidInfo) {
+    size_t pos = chunks_.size();
+    while (!hotQueue_.empty()) {
+        size_t hot = hotQueue_.front();
+        hotQueue_.pop_front();
+        if (!started_[hot]) {
+            pos = hot;
+            break;
+        }
+    }
+    if (pos == chunks_.size()) {
+        while (cursor_ < chunks_.size() && started_[cursor_]) {
+            cursor_++;
+        }
+        if (cursor_ == chunks_.size()) {
+            return false;
+        }
+        pos = cursor_;
+    }
+    Start(pos, cidInfo);
+    return true;
+}
+
+bool RecoverChunkScheduler::NextChunkInCopyset(ChunkIDInfo *cidInfo) {
+    auto iter = copysetChunks_.find(CopysetKey(*cidInfo));
+    if (iter == copysetChunks_.end()) {
+        return false;
+    }
+    std::deque<size_t> &positions = iter->second;
+    while (!positions.empty() && started_[positions.front()]) {
+        positions.pop_front();
+    }
+    if (positions.empty()) {
+        copysetChunks_.erase(iter);
+        return false;
+    }
+    Start(positions.front(), cidInfo);
+    positions.pop_front();
+    return true;
+}
+
+void RecoverChunkScheduler::Start(size_t pos, ChunkIDInfo *cidInfo) {
+    started_[pos] = true;
+    startedNum_++;
+    *cidInfo = chunks_[pos];
+}
+
+void RecoverChunkScheduler::PromoteHotChunks(
+    const std::vector<ChunkID> &hotChunks) {
+    for (ChunkID chunkId : hotChunks) {
+        auto iter = chunkPos_.find(chunkId);
+        if (iter == chunkPos_.end()) {
+            continue;
+        }
+        size_t end = std::min(iter->second + hotNeighborNum_ + 1,
+                              chunks_.size());
+        for (size_t pos = iter->second; pos < end; pos++) {
+            PushHot(pos);
+        }
+    }
+}
+
+void RecoverChunkScheduler::PushHot(size_t pos) {
+    if (started_[pos] || queued_[pos]) {
+        return;
+    }
+    queued_[pos] = true;
+    hotQueue_.push_back(pos);
+    LOG(INFO) << "RecoverChunk promote hot chunk"
+              << ", logicalPoolId = " << chunks_[pos].lpid_
+              << ", copysetId = " << chunks_[pos].cpid_
+              << ", chunkId = " << chunks_[pos].cid_;
+}
+
+void RecoverChunkScheduler::OnPartDone(bool success, uint64_t costMs) {
+    if (0 == slowPartMs_) {
+        return;
+    }
+    partsSinceAdjust_++;
+    if (!success || costMs > slowPartMs_) {
+        // 一轮内的多个慢请求只减一次，避免并发数骤降
+        if (partsSinceAdjust_ >= concurrency_ && concurrency_ > 1) {
+            concurrency_ = std::max(concurrency_ / 2, 1u);
+            partsSinceAdjust_ = 0;
+            LOG(INFO) << "RecoverChunk decrease concurrency to "
+                      << concurrency_ << ", success = " << success
+                      << ", costMs = " << costMs;
+        }
+        return;
+    }
+    if (partsSinceAdjust_ >= concurrency_) {
+        if (concurrency_ < maxConcurrency_) {
+            concurrency_++;
+            partsSinceAdjust_ = 0;
+        } else {
+            partsSinceAdjust_ = concurrency_;
+        }
+    }
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_CLONE_RECOVER_CHUNK_SCHEDULER_H_
+#define SRC_SNAPSHOTCLONESERVER_CLONE_RECOVER_CHUNK_SCHEDULER_H_
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "src/client/client_common.h"
+
+using ::curve::client::ChunkID;
+using ::curve::client::ChunkIDInfo;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief 决定RecoverChunk阶段chunk的恢复顺序和并发数，只在任务线程中使用
+ * @detail
+ *  chunk默认按在文件中的顺序恢复。chunkserver在RecoverChunk的响应中
+ *  返回同一copyset最近被用户读穿透的chunk，这些chunk和其后的若干个chunk
+ *  提前恢复，使正在被访问的区域尽快不再读源端。
+ *  并发数按加性增、乘性减调整：分片失败或耗时超过阈值时减半，
+ *  之后每完成并发数个正常的分片加1，上限为配置的并发数。
+ */
+class RecoverChunkScheduler {
+ public:
+    /**
+     * @param maxConcurrency 最大并发的chunk数
+     * @param hotNeighborNum 读穿透的chunk之后一起提前恢复的chunk数
+     * @param slowPartMs 分片耗时超过该值时降低并发数，为0时不调整并发数
+     */
+    RecoverChunkScheduler(uint32_t maxConcurrency,
+                          uint32_t hotNeighborNum,
+                          uint64_t slowPartMs);
+
+    /**
+     * @brief 按文件中的顺序加入待恢复的chunk
+     */
+    void AddChunk(const ChunkIDInfo &cidInfo);
+
+    /**
+     * @brief 是否还有未开始恢复的chunk
+     */
+    bool HasPendingChunk() const {
+        return startedNum_ < chunks_.size();
+    }
+
+    /**
+     * @brief 取下一个开始恢复的chunk，读穿透的chunk优先
+     *
+     * @param[out] cidInfo chunk信息
+     *
+     * @return 没有未开始恢复的chunk时返回false
+     */
+    bool NextChunk(ChunkIDInfo *cidInfo);
+
+    /**
+     * @brief 按文件中的顺序取同一copyset上下一个未开始恢复的chunk，
+     *        用于和NextChunk取到的chunk合并成一次请求
+     *
+     * @param[in,out] cidInfo 传入copyset信息，返回chunk信息
+     *
+     * @return 该copyset上没有未开始恢复的chunk时返回false
+     */
+    bool NextChunkInCopyset(ChunkIDInfo *cidInfo);
+
+    /**
+     * @brief chunkserver返回的读穿透的chunk，不属于本任务的忽略
+     */
+    void PromoteHotChunks(const std::vector<ChunkID> &hotChunks);
+
+    /**
+     * @brief 一个分片的请求返回，据此调整并发数
+     *
+     * @param success 是否成功
+     * @param costMs 分片请求耗时
+     */
+    void OnPartDone(bool success, uint64_t costMs);
+
+    uint32_t GetConcurrency() const {
+        return concurrency_;
+    }
+
+    uint64_t GetChunkNum() const {
+        return chunks_.size();
+    }
+
+    uint64_t GetStartedNum() const {
+        return startedNum_;
+    }
+
+ private:
+    void PushHot(size_t pos);
+
+    void Start(size_t pos, ChunkIDInfo *cidInfo);
+
+    static uint64_t CopysetKey(const ChunkIDInfo &cidInfo) {
+        return (static_cast<uint64_t>(cidInfo.lpid_) << 32) | cidInfo.cpid_;
+    }
+
+ private:
+    uint32_t maxConcurrency_;
+    uint32_t hotNeighborNum_;
+    uint64_t slowPartMs_;
+    uint32_t concurrency_;
+    // 上次调整并发数之后完成的分片数
+    uint32_t partsSinceAdjust_;
+
+    std::vector<ChunkIDInfo> chunks_;
+    std::vector<bool> started_;
+    std::vector<bool> queued_;
+    std::unordered_map<ChunkID, size_t> chunkPos_;
+    // 按顺序恢复的下一个位置
+    size_t cursor_;
+    uint64_t startedNum_;
+    // 需要提前恢复的chunk位置
+    std::deque<size_t> hotQueue_;
+    // 每个copyset上的chunk位置，按文件中的顺序
+    std::unordered_map<uint64_t, std::deque<size_t>> copysetChunks_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_CLONE_RECOVER_CHUNK_SCHEDULER_H_
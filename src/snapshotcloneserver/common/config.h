@@ -71,6 +71,14 @@ struct SnapshotCloneServerOptions {
     uint32_t mdsSessionTimeUs;
     // ReadChunkSnapshot同时进行的异步请求数量
     uint32_t readChunkSnapshotConcurrency;
+    // 快照数据是否按CHUNK_DATA_BLOCK格式(数据块去重、压缩)转储
+    bool snapshotBlockFormatEnable = false;
+    // 数据块压缩方式: none/snappy/zlib
+    std::string snapshotBlockCompressType = "snappy";
+    // 所有快照转储共享的分片缓冲区内存上限(字节)
+    uint64_t snapshotTransferBufferSize = 1073741824;
+    // 快照分片上传线程数，为0时读取分片后同步上传
+    int snapshotUploadThreadNum = 64;
 
     // 用于Lazy克隆元数据部分的线程池线程数
     int stage1PoolThreadNum;
@@ -90,6 +98,15 @@ struct SnapshotCloneServerOptions {
     uint32_t createCloneChunkConcurrency;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency;
+    // RecoverChunk分片耗时超过该值(ms)时降低并发数，为0时不调整并发数
+    uint64_t recoverChunkSlowPartMs = 3000;
+    // 优先恢复读穿透的chunk时，其后一起提前恢复的chunk数量
+    uint32_t recoverHotChunkNeighborNum = 2;
+    // CreateCloneChunk/RecoverChunk时同一copyset上一次rpc最多携带的chunk数，
+    // 不大于1时逐个chunk请求
+    uint32_t cloneChunkBatchSize = 1;
+    // 快照数据是否存储在local，是则chunkserver从挂载的同一目录读取快照数据
+    bool snapshotDataStoreLocal = false;
     // 引用计数后台扫描每条记录间隔
     uint32_t backEndReferenceRecordScanIntervalMs;
     // 引用计数后台扫描每轮间隔
@@ -237,6 +237,38 @@ int CurveFsClientImpl::RecoverChunk(
         clientMethodRetryIntervalMs_);
 }
 
+int CurveFsClientImpl::CreateCloneChunks(
+    LogicPoolID lpid,
+    CopysetID cpid,
+    const std::vector<CloneChunkItem> &chunks,
+    SnapCloneClosure* scc) {
+    RetryMethod method = [this, lpid, cpid, &chunks, scc] () {
+        return snapClient_->CreateCloneChunks(lpid, cpid, chunks, scc);
+    };
+    RetryCondition condition = [] (int ret) {
+        return ret < 0;
+    };
+    RetryHelper retryHelper(method, condition);
+    return retryHelper.RetryTimeSecAndReturn(clientMethodRetryTimeSec_,
+        clientMethodRetryIntervalMs_);
+}
+
+int CurveFsClientImpl::RecoverChunks(
+    LogicPoolID lpid,
+    CopysetID cpid,
+    const std::vector<CloneChunkItem> &chunks,
+    SnapCloneClosure* scc) {
+    RetryMethod method = [this, lpid, cpid, &chunks, scc] () {
+        return snapClient_->RecoverChunks(lpid, cpid, chunks, scc);
+    };
+    RetryCondition condition = [] (int ret) {
+        return ret < 0;
+    };
+    RetryHelper retryHelper(method, condition);
+    return retryHelper.RetryTimeSecAndReturn(clientMethodRetryTimeSec_,
+        clientMethodRetryIntervalMs_);
+}
+
 int CurveFsClientImpl::CompleteCloneMeta(
     const std::string &filename,
     const std::string &user) {
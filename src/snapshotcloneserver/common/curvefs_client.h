@@ -48,6 +48,7 @@ using ::curve::client::ChunkIDInfo;
 using ::curve::client::FInfo;
 using ::curve::client::FileStatus;
 using ::curve::client::SnapCloneClosure;
+using ::curve::client::CloneChunkItem;
 using ::curve::client::UserInfo;
 using ::curve::client::SnapshotClient;
 using ::curve::client::FileClient;
@@ -278,6 +279,40 @@ class CurveFsClient {
         uint64_t len,
         SnapCloneClosure* scc) = 0;
 
+    /**
+     * @brief 批量创建同一copyset上的clone chunk
+     *
+     * @param lpid 逻辑池id
+     * @param cpid copyset id
+     * @param chunks 需要创建的chunk
+     * @param: scc是异步回调，已存在的chunk通过scc->GetExistChunks()返回，
+     *         chunkserver不支持批量接口时返回-LIBCURVE_ERROR::NOT_SUPPORT
+     *
+     * @return 错误码
+     */
+    virtual int CreateCloneChunks(
+        LogicPoolID lpid,
+        CopysetID cpid,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure* scc) = 0;
+
+    /**
+     * @brief 批量恢复同一copyset上的chunk数据
+     *
+     * @param lpid 逻辑池id
+     * @param cpid copyset id
+     * @param chunks 需要恢复的chunk及其偏移和长度
+     * @param: scc是异步回调，chunkserver不支持批量接口时
+     *         返回-LIBCURVE_ERROR::NOT_SUPPORT
+     *
+     * @return 错误码
+     */
+    virtual int RecoverChunks(
+        LogicPoolID lpid,
+        CopysetID cpid,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure* scc) = 0;
+
     /**
      * @brief 通知mds完成Clone Meta
      *
@@ -476,6 +511,18 @@ class CurveFsClientImpl : public CurveFsClient {
         uint64_t len,
         SnapCloneClosure* scc) override;
 
+    int CreateCloneChunks(
+        LogicPoolID lpid,
+        CopysetID cpid,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure* scc) override;
+
+    int RecoverChunks(
+        LogicPoolID lpid,
+        CopysetID cpid,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure* scc) override;
+
     int CompleteCloneMeta(
         const std::string &filename,
         const std::string &user) override;
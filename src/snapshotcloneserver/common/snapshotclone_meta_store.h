@@ -145,6 +145,42 @@ class SnapshotCloneMetaStore {
      * @return: 0 获取成功/ -1 获取失败
      */
     virtual int GetCloneInfoList(std::vector<CloneInfo> *list) = 0;
+
+    /**
+     * @brief 增加快照数据块的引用计数，记录不存在时创建
+     * @param blockKey 数据块对象名
+     * @param[out] refCount 增加后的引用计数
+     * @return: 0 成功/ -1 失败
+     */
+    virtual int RefSnapshotBlock(const std::string &blockKey,
+                                 uint64_t *refCount) = 0;
+
+    /**
+     * @brief 减少快照数据块的引用计数，减为0时删除记录
+     * @param blockKey 数据块对象名
+     * @param[out] refCount 减少后的引用计数
+     * @return: 0 成功/ -1 失败或记录不存在
+     */
+    virtual int UnrefSnapshotBlock(const std::string &blockKey,
+                                   uint64_t *refCount) = 0;
+
+    /**
+     * @brief 在一个事务中增加一批快照数据块的引用计数，记录不存在时创建
+     * @param blockKeys 数据块对象名，可以重复，重复几次即增加几次引用
+     * @param[out] refCounts 按blockKeys的顺序依次增加后的引用计数
+     * @return: 0 成功/ -1 失败，失败时所有引用计数均未修改
+     */
+    virtual int RefSnapshotBlocks(const std::vector<std::string> &blockKeys,
+                                  std::vector<uint64_t> *refCounts) = 0;
+
+    /**
+     * @brief 在一个事务中减少一批快照数据块的引用计数，减为0时删除记录
+     * @param blockKeys 数据块对象名，可以重复，重复几次即减少几次引用
+     * @param[out] refCounts 按blockKeys的顺序依次减少后的引用计数
+     * @return: 0 成功/ -1 失败或记录不存在，失败时所有引用计数均未修改
+     */
+    virtual int UnrefSnapshotBlocks(const std::vector<std::string> &blockKeys,
+                                    std::vector<uint64_t> *refCounts) = 0;
 };
 
 }  // namespace snapshotcloneserver
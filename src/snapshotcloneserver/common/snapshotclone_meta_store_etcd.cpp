@@ -22,12 +22,17 @@
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store_etcd.h"
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <string>
 
 namespace curve {
 namespace snapshotcloneserver {
 
+// etcd默认限制单个事务最多128个操作
+const size_t kMaxBlockRefTxnOps = 128;
+
 int SnapshotCloneMetaStoreEtcd::Init() {
     int ret = LoadSnapshotInfos();
     if (ret < 0) {
@@ -37,6 +42,10 @@ int SnapshotCloneMetaStoreEtcd::Init() {
     if (ret < 0) {
         return -1;
     }
+    ret = LoadSnapshotBlockRefs();
+    if (ret < 0) {
+        return -1;
+    }
     return 0;
 }
 
@@ -294,6 +303,139 @@ int SnapshotCloneMetaStoreEtcd::GetCloneInfoList(std::vector<CloneInfo> *list) {
     return -1;
 }
 
+int SnapshotCloneMetaStoreEtcd::RefSnapshotBlock(
+    const std::string &blockKey, uint64_t *refCount) {
+    std::vector<uint64_t> refCounts;
+    int ret = UpdateSnapshotBlockRefs({blockKey}, true, &refCounts);
+    if (ret == 0) {
+        *refCount = refCounts[0];
+    }
+    return ret;
+}
+
+int SnapshotCloneMetaStoreEtcd::UnrefSnapshotBlock(
+    const std::string &blockKey, uint64_t *refCount) {
+    std::vector<uint64_t> refCounts;
+    int ret = UpdateSnapshotBlockRefs({blockKey}, false, &refCounts);
+    if (ret == 0) {
+        *refCount = refCounts[0];
+    }
+    return ret;
+}
+
+int SnapshotCloneMetaStoreEtcd::RefSnapshotBlocks(
+    const std::vector<std::string> &blockKeys,
+    std::vector<uint64_t> *refCounts) {
+    return UpdateSnapshotBlockRefs(blockKeys, true, refCounts);
+}
+
+int SnapshotCloneMetaStoreEtcd::UnrefSnapshotBlocks(
+    const std::vector<std::string> &blockKeys,
+    std::vector<uint64_t> *refCounts) {
+    return UpdateSnapshotBlockRefs(blockKeys, false, refCounts);
+}
+
+int SnapshotCloneMetaStoreEtcd::UpdateSnapshotBlockRefs(
+    const std::vector<std::string> &blockKeys, bool ref,
+    std::vector<uint64_t> *refCounts) {
+    // 同一数据块在事务中只能有一个操作，合并重复的数据块
+    std::map<std::string, uint64_t> deltas;
+    for (const auto &blockKey : blockKeys) {
+        deltas[blockKey]++;
+    }
+    if (deltas.empty()) {
+        refCounts->clear();
+        return 0;
+    }
+    if (deltas.size() > kMaxBlockRefTxnOps) {
+        LOG(ERROR) << "Too many block refs in one txn"
+                   << ", size = " << deltas.size();
+        return -1;
+    }
+
+    // 按数据块对象名的顺序加锁，不同批次之间不会死锁，
+    // etcd事务期间只锁住本批数据块，其他数据块的引用可以并发修改
+    std::vector<std::unique_ptr<NameLockGuard>> guards;
+    for (const auto &item : deltas) {
+        guards.emplace_back(new NameLockGuard(blockRefUpdateLock_,
+                                              item.first));
+    }
+
+    std::map<std::string, uint64_t> origins;
+    {
+        ReadLockGuard guard(blockRefs_lock_);
+        for (const auto &item : deltas) {
+            auto search = blockRefs_.find(item.first);
+            uint64_t count = 0;
+            if (search != blockRefs_.end()) {
+                count = search->second;
+            }
+            if (!ref && count < item.second) {
+                LOG(ERROR) << "UnrefSnapshotBlock block ref not exist"
+                           << ", blockKey = " << item.first
+                           << ", refCount = " << count;
+                return -1;
+            }
+            origins.emplace(item.first, count);
+        }
+    }
+
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    keys.reserve(deltas.size());
+    values.reserve(deltas.size());
+    std::vector<Operation> ops;
+    for (const auto &item : deltas) {
+        uint64_t origin = origins[item.first];
+        uint64_t count = ref ? origin + item.second : origin - item.second;
+        keys.emplace_back(codec_->EncodeSnapshotBlockRefKey(item.first));
+        if (count == 0) {
+            ops.emplace_back(Operation{OpType::OpDelete,
+                const_cast<char *>(keys.back().c_str()), "",
+                static_cast<int>(keys.back().size()), 0});
+        } else {
+            values.emplace_back(codec_->EncodeSnapshotBlockRefData(count));
+            ops.emplace_back(Operation{OpType::OpPut,
+                const_cast<char *>(keys.back().c_str()),
+                const_cast<char *>(values.back().c_str()),
+                static_cast<int>(keys.back().size()),
+                static_cast<int>(values.back().size())});
+        }
+    }
+    int64_t revision = 0;
+    int errCode = client_->TxnNRewithRevision(ops, &revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "Update block refs in etcd err"
+                   << ", errcode = " << errCode
+                   << ", blockNum = " << deltas.size()
+                   << ", ref = " << ref;
+        return -1;
+    }
+
+    {
+        WriteLockGuard guard(blockRefs_lock_);
+        for (const auto &item : deltas) {
+            uint64_t origin = origins[item.first];
+            uint64_t count = ref ? origin + item.second
+                                 : origin - item.second;
+            if (count == 0) {
+                blockRefs_.erase(item.first);
+            } else {
+                blockRefs_[item.first] = count;
+            }
+        }
+    }
+
+    // 按顺序依次修改的结果，重复的数据块得到的是中间值
+    refCounts->clear();
+    for (const auto &blockKey : blockKeys) {
+        uint64_t &count = origins[blockKey];
+        count = ref ? count + 1 : count - 1;
+        refCounts->push_back(count);
+    }
+    return 0;
+}
+
 int SnapshotCloneMetaStoreEtcd::LoadSnapshotInfos() {
     std::string startKey = SnapshotCloneCodec::GetSnapshotInfoKeyPrefix();
     std::string endKey = SnapshotCloneCodec::GetSnapshotInfoKeyEnd();
@@ -340,6 +482,30 @@ int SnapshotCloneMetaStoreEtcd::LoadCloneInfos() {
     return 0;
 }
 
+int SnapshotCloneMetaStoreEtcd::LoadSnapshotBlockRefs() {
+    std::string startKey = SnapshotCloneCodec::GetSnapshotBlockRefKeyPrefix();
+    std::string endKey = SnapshotCloneCodec::GetSnapshotBlockRefKeyEnd();
+    WriteLockGuard guard(blockRefs_lock_);
+    std::vector<std::pair<std::string, std::string>> out;
+    int errCode = client_->List(startKey, endKey, &out);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "etcd list err:" << errCode;
+        return -1;
+    }
+    for (const auto &kv : out) {
+        std::string blockKey;
+        uint64_t refCount = 0;
+        if (!codec_->DecodeSnapshotBlockRefKey(kv.first, &blockKey) ||
+            !codec_->DecodeSnapshotBlockRefData(kv.second, &refCount)) {
+            LOG(ERROR) << "Decode block ref err, key = " << kv.first;
+            return -1;
+        }
+        blockRefs_.emplace(blockKey, refCount);
+    }
+    LOG(INFO) << "LoadSnapshotBlockRefs size = " << blockRefs_.size();
+    return 0;
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
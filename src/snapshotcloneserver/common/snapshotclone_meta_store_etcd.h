@@ -33,11 +33,14 @@
 #include "src/snapshotcloneserver/common/snapshotclonecodec.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/rw_lock.h"
+#include "src/common/concurrent/name_lock.h"
 
 using ::curve::kvstorage::KVStorageClient;
 using ::curve::common::RWLock;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
+using ::curve::common::NameLock;
+using ::curve::common::NameLockGuard;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -81,6 +84,18 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int RefSnapshotBlock(const std::string &blockKey,
+                         uint64_t *refCount) override;
+
+    int UnrefSnapshotBlock(const std::string &blockKey,
+                           uint64_t *refCount) override;
+
+    int RefSnapshotBlocks(const std::vector<std::string> &blockKeys,
+                          std::vector<uint64_t> *refCounts) override;
+
+    int UnrefSnapshotBlocks(const std::vector<std::string> &blockKeys,
+                            std::vector<uint64_t> *refCounts) override;
+
  private:
     /**
      * @brief 加载快照信息
@@ -96,6 +111,25 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
      */
     int LoadCloneInfos();
 
+    /**
+     * @brief 加载快照数据块引用计数
+     *
+     * @return 0 加载成功/ -1 加载失败
+     */
+    int LoadSnapshotBlockRefs();
+
+    /**
+     * @brief 在一个事务中修改一批数据块的引用计数
+     *
+     * @param blockKeys 数据块对象名，可以重复
+     * @param ref true增加引用/ false减少引用
+     * @param[out] refCounts 按blockKeys的顺序依次修改后的引用计数
+     *
+     * @return 0 成功/ -1 失败
+     */
+    int UpdateSnapshotBlockRefs(const std::vector<std::string> &blockKeys,
+                                bool ref, std::vector<uint64_t> *refCounts);
+
  private:
     std::shared_ptr<KVStorageClient> client_;
     std::shared_ptr<SnapshotCloneCodec> codec_;
@@ -108,6 +142,13 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
     std::map<std::string, CloneInfo> cloneInfos_;
     // clone info map lock
     RWLock cloneInfos_lock_;
+    // key is block object name, value is reference count
+    std::map<std::string, uint64_t> blockRefs_;
+    // block ref map lock, only held while accessing blockRefs_
+    RWLock blockRefs_lock_;
+    // serialize the updates of the same block ref across the etcd txn,
+    // updates of different blocks go on concurrently
+    NameLock blockRefUpdateLock_;
 };
 
 }  // namespace snapshotcloneserver
@@ -76,6 +76,36 @@ struct SnapshotMetric {
             GetSnapshotTotalNum, metaStore_.get()) {}
 };
 
+struct SnapshotTransferMetric {
+    const std::string SnapshotTransferMetricPrefix =
+        "snapshotcloneserver_snapshot_transfer_";
+
+    // 累计从curvefs读取的快照数据字节数
+    bvar::Adder<uint64_t> readBytes;
+    bvar::PerSecond<bvar::Adder<uint64_t>> readBps;
+    // 累计上传的快照数据字节数
+    bvar::Adder<uint64_t> uploadBytes;
+    bvar::PerSecond<bvar::Adder<uint64_t>> uploadBps;
+    // 已申请的分片缓冲区字节数
+    bvar::Adder<int64_t> bufferUsed;
+    // 等待分片缓冲区的转储任务数量
+    bvar::Adder<int64_t> bufferWaiting;
+    // 已读取等待上传的分片数量
+    bvar::Adder<int64_t> uploadQueueing;
+    // 分片上传延时
+    bvar::LatencyRecorder uploadLatency;
+
+    SnapshotTransferMetric() :
+        readBytes(SnapshotTransferMetricPrefix, "read_bytes"),
+        readBps(SnapshotTransferMetricPrefix, "read_bps", &readBytes),
+        uploadBytes(SnapshotTransferMetricPrefix, "upload_bytes"),
+        uploadBps(SnapshotTransferMetricPrefix, "upload_bps", &uploadBytes),
+        bufferUsed(SnapshotTransferMetricPrefix, "buffer_used"),
+        bufferWaiting(SnapshotTransferMetricPrefix, "buffer_waiting"),
+        uploadQueueing(SnapshotTransferMetricPrefix, "upload_queueing"),
+        uploadLatency(SnapshotTransferMetricPrefix, "upload_latency") {}
+};
+
 struct SnapshotInfoMetric {
     const std::string SnapshotInfoMetricPrefix =
         "snapshotcloneserver_snapshotInfo_metric_";
@@ -59,6 +59,39 @@ bool SnapshotCloneCodec::DecodeCloneInfoData(
     return data->ParseFromString(value);
 }
 
+std::string SnapshotCloneCodec::EncodeSnapshotBlockRefKey(
+    const std::string &blockKey) {
+    std::string key = SnapshotCloneCodec::GetSnapshotBlockRefKeyPrefix();
+    key += blockKey;
+    return key;
+}
+
+bool SnapshotCloneCodec::DecodeSnapshotBlockRefKey(
+    const std::string &key, std::string *blockKey) {
+    std::string prefix = SnapshotCloneCodec::GetSnapshotBlockRefKeyPrefix();
+    if (key.size() <= prefix.size() ||
+        key.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    *blockKey = key.substr(prefix.size());
+    return true;
+}
+
+std::string SnapshotCloneCodec::EncodeSnapshotBlockRefData(
+    uint64_t refCount) {
+    return std::to_string(refCount);
+}
+
+bool SnapshotCloneCodec::DecodeSnapshotBlockRefData(
+    const std::string &value, uint64_t *refCount) {
+    if (value.empty() ||
+        value.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    *refCount = std::stoull(value);
+    return true;
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -32,6 +32,8 @@ using ::curve::common::SNAPINFOKEYPREFIX;
 using ::curve::common::SNAPINFOKEYEND;
 using ::curve::common::CLONEINFOKEYPREFIX;
 using ::curve::common::CLONEINFOKEYEND;
+using ::curve::common::SNAPBLOCKREFKEYPREFIX;
+using ::curve::common::SNAPBLOCKREFKEYEND;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -46,6 +48,13 @@ class SnapshotCloneCodec {
     bool EncodeCloneInfoData(const CloneInfo &data, std::string *value);
     bool DecodeCloneInfoData(const std::string &value, CloneInfo *data);
 
+    std::string EncodeSnapshotBlockRefKey(const std::string &blockKey);
+    bool DecodeSnapshotBlockRefKey(const std::string &key,
+                                   std::string *blockKey);
+    std::string EncodeSnapshotBlockRefData(uint64_t refCount);
+    bool DecodeSnapshotBlockRefData(const std::string &value,
+                                    uint64_t *refCount);
+
     static std::string GetSnapshotInfoKeyPrefix() {
         return std::string(SNAPINFOKEYPREFIX);
     }
@@ -61,6 +70,14 @@ class SnapshotCloneCodec {
     static std::string GetCloneInfoKeyEnd() {
         return std::string(CLONEINFOKEYEND);
     }
+
+    static std::string GetSnapshotBlockRefKeyPrefix() {
+        return std::string(SNAPBLOCKREFKEYPREFIX);
+    }
+
+    static std::string GetSnapshotBlockRefKeyEnd() {
+        return std::string(SNAPBLOCKREFKEYEND);
+    }
 };
 
 }  // namespace snapshotcloneserver
@@ -0,0 +1,304 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/snapshotcloneserver/snapshot/snapshot_block_store.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "src/common/snapshotclone/snapshotclone_define.h"
+
+using ::curve::common::NameLockGuard;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+// 每批数据块的引用计数在一个事务中修改，不能超过etcd事务的操作数限制，
+// 删除chunk数据时每批释放前持久化一次缩减后的数据块列表
+const int kBlockBatchSize = 16;
+
+int SnapshotBlockStore::PutBlock(const char *buf, size_t len,
+                                 ChunkBlock *block) {
+    // 成功后才填充block，失败时调用者无需释放该数据块
+    block->set_hash("");
+    block->set_compresstype(BLOCK_COMPRESS_NONE);
+    if (SnapshotBlockCodec::IsZeroBlock(buf, len)) {
+        return kErrCodeSuccess;
+    }
+    ChunkBlock newBlock;
+    newBlock.set_hash(SnapshotBlockCodec::CalcBlockHash(buf, len));
+    newBlock.set_compresstype(compressType_);
+    std::string key = SnapshotBlockCodec::BlockObjectKey(newBlock);
+
+    NameLockGuard lockGuard(blockLock_, key);
+    uint64_t refCount = 0;
+    int ret = metaStore_->RefSnapshotBlock(key, &refCount);
+    if (ret < 0) {
+        LOG(ERROR) << "RefSnapshotBlock fail"
+                   << ", ret = " << ret
+                   << ", blockKey = " << key;
+        return kErrCodeInternalError;
+    }
+    // 引用计数大于1时数据块一般已存在，
+    // 但前一次上传可能失败后引用计数残留，需检查对象是否存在
+    if (refCount > 1 && dataStore_->DataBlockExist(key)) {
+        *block = newBlock;
+        return kErrCodeSuccess;
+    }
+
+    std::string data;
+    if (!SnapshotBlockCodec::Compress(compressType_, buf, len, &data)) {
+        LOG(ERROR) << "Compress block fail, blockKey = " << key;
+        ret = kErrCodeInternalError;
+    } else {
+        ret = dataStore_->PutDataBlock(key, data);
+        if (ret < 0) {
+            LOG(ERROR) << "PutDataBlock fail"
+                       << ", ret = " << ret
+                       << ", blockKey = " << key;
+            ret = kErrCodeInternalError;
+        }
+    }
+    if (ret < 0) {
+        uint64_t count = 0;
+        int ret2 = metaStore_->UnrefSnapshotBlock(key, &count);
+        LOG_IF(ERROR, ret2 < 0) << "UnrefSnapshotBlock fail"
+                                << ", ret = " << ret2
+                                << ", blockKey = " << key;
+        return ret;
+    }
+    *block = newBlock;
+    return kErrCodeSuccess;
+}
+
+int SnapshotBlockStore::RefBlock(const ChunkBlock &block) {
+    if (block.hash().empty()) {
+        return kErrCodeSuccess;
+    }
+    std::string key = SnapshotBlockCodec::BlockObjectKey(block);
+    NameLockGuard lockGuard(blockLock_, key);
+    uint64_t refCount = 0;
+    int ret = metaStore_->RefSnapshotBlock(key, &refCount);
+    if (ret < 0) {
+        LOG(ERROR) << "RefSnapshotBlock fail"
+                   << ", ret = " << ret
+                   << ", blockKey = " << key;
+        return kErrCodeInternalError;
+    }
+    if (refCount == 1) {
+        // 原有引用已全部释放，撤销本次引用
+        uint64_t count = 0;
+        ret = metaStore_->UnrefSnapshotBlock(key, &count);
+        LOG_IF(ERROR, ret < 0) << "UnrefSnapshotBlock fail"
+                               << ", ret = " << ret
+                               << ", blockKey = " << key;
+        return kErrCodeInternalError;
+    }
+    return kErrCodeSuccess;
+}
+
+int SnapshotBlockStore::RefBlocks(const std::vector<ChunkBlock> &blocks,
+                                  std::vector<bool> *refed) {
+    refed->assign(blocks.size(), false);
+    int result = kErrCodeSuccess;
+    for (size_t pos = 0; pos < blocks.size(); pos += kBlockBatchSize) {
+        size_t end = std::min(blocks.size(), pos + kBlockBatchSize);
+        std::vector<size_t> indexes;
+        std::vector<std::string> keys;
+        for (size_t i = pos; i < end; i++) {
+            if (blocks[i].hash().empty()) {
+                (*refed)[i] = true;
+                continue;
+            }
+            indexes.push_back(i);
+            keys.push_back(SnapshotBlockCodec::BlockObjectKey(blocks[i]));
+        }
+        if (keys.empty()) {
+            continue;
+        }
+
+        std::vector<std::unique_ptr<NameLockGuard>> guards;
+        LockBlocks(keys, &guards);
+        std::vector<uint64_t> refCounts;
+        int ret = metaStore_->RefSnapshotBlocks(keys, &refCounts);
+        if (ret < 0) {
+            LOG(ERROR) << "RefSnapshotBlocks fail"
+                       << ", ret = " << ret
+                       << ", blockNum = " << keys.size();
+            result = kErrCodeInternalError;
+            continue;
+        }
+        // 原有引用已全部释放的数据块，撤销本次的全部引用
+        std::set<std::string> released;
+        for (size_t j = 0; j < keys.size(); j++) {
+            if (refCounts[j] == 1) {
+                released.insert(keys[j]);
+            }
+        }
+        std::vector<std::string> revoking;
+        for (size_t j = 0; j < keys.size(); j++) {
+            if (released.count(keys[j]) > 0) {
+                revoking.push_back(keys[j]);
+            } else {
+                (*refed)[indexes[j]] = true;
+            }
+        }
+        if (!revoking.empty()) {
+            std::vector<uint64_t> counts;
+            ret = metaStore_->UnrefSnapshotBlocks(revoking, &counts);
+            LOG_IF(ERROR, ret < 0) << "UnrefSnapshotBlocks fail"
+                                   << ", ret = " << ret
+                                   << ", blockNum = " << revoking.size();
+        }
+    }
+    return result;
+}
+
+int SnapshotBlockStore::ReleaseBlock(const ChunkBlock &block) {
+    if (block.hash().empty()) {
+        return kErrCodeSuccess;
+    }
+    std::string key = SnapshotBlockCodec::BlockObjectKey(block);
+    NameLockGuard lockGuard(blockLock_, key);
+    uint64_t refCount = 0;
+    int ret = metaStore_->UnrefSnapshotBlock(key, &refCount);
+    if (ret < 0) {
+        LOG(ERROR) << "UnrefSnapshotBlock fail"
+                   << ", ret = " << ret
+                   << ", blockKey = " << key;
+        return kErrCodeInternalError;
+    }
+    if (refCount == 0) {
+        // 引用计数已删除，删除对象失败只会残留对象
+        ret = dataStore_->DeleteDataBlock(key);
+        LOG_IF(WARNING, ret < 0) << "DeleteDataBlock fail"
+                                 << ", ret = " << ret
+                                 << ", blockKey = " << key;
+    }
+    return kErrCodeSuccess;
+}
+
+int SnapshotBlockStore::ReleaseBlocks(const ChunkBlockMap &blockMap) {
+    int result = kErrCodeSuccess;
+    for (int pos = 0; pos < blockMap.blocks_size(); pos += kBlockBatchSize) {
+        int end = std::min(blockMap.blocks_size(), pos + kBlockBatchSize);
+        std::vector<ChunkBlock> blocks(blockMap.blocks().begin() + pos,
+                                       blockMap.blocks().begin() + end);
+        int ret = ReleaseBlockBatch(blocks);
+        if (ret < 0 && result == kErrCodeSuccess) {
+            result = ret;
+        }
+    }
+    return result;
+}
+
+int SnapshotBlockStore::ReleaseBlockBatch(
+    const std::vector<ChunkBlock> &blocks) {
+    std::vector<std::string> keys;
+    for (const auto &block : blocks) {
+        if (!block.hash().empty()) {
+            keys.push_back(SnapshotBlockCodec::BlockObjectKey(block));
+        }
+    }
+    if (keys.empty()) {
+        return kErrCodeSuccess;
+    }
+
+    std::vector<std::unique_ptr<NameLockGuard>> guards;
+    LockBlocks(keys, &guards);
+    std::vector<uint64_t> refCounts;
+    int ret = metaStore_->UnrefSnapshotBlocks(keys, &refCounts);
+    if (ret < 0) {
+        LOG(ERROR) << "UnrefSnapshotBlocks fail"
+                   << ", ret = " << ret
+                   << ", blockNum = " << keys.size();
+        return kErrCodeInternalError;
+    }
+    // 重复的数据块只有最后一次释放后引用计数为0
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (refCounts[i] == 0) {
+            // 引用计数已删除，删除对象失败只会残留对象
+            ret = dataStore_->DeleteDataBlock(keys[i]);
+            LOG_IF(WARNING, ret < 0) << "DeleteDataBlock fail"
+                                     << ", ret = " << ret
+                                     << ", blockKey = " << keys[i];
+        }
+    }
+    return kErrCodeSuccess;
+}
+
+void SnapshotBlockStore::LockBlocks(const std::vector<std::string> &keys,
+    std::vector<std::unique_ptr<NameLockGuard>> *guards) {
+    std::set<std::string> sorted(keys.begin(), keys.end());
+    for (const auto &key : sorted) {
+        guards->emplace_back(new NameLockGuard(blockLock_, key));
+    }
+}
+
+int SnapshotBlockStore::DeleteChunkData(const ChunkDataName &name) {
+    ChunkBlockMap blockMap;
+    int ret = dataStore_->GetChunkBlockMap(name, &blockMap);
+    if (ret < 0) {
+        LOG(ERROR) << "GetChunkBlockMap fail"
+                   << ", ret = " << ret
+                   << ", chunkDataName = " << name.ToDataChunkKey();
+        return kErrCodeInternalError;
+    }
+    // 全零块不占用引用计数，无需释放
+    ChunkBlockMap remain;
+    remain.set_blocksize(blockMap.blocksize());
+    for (const auto &block : blockMap.blocks()) {
+        if (!block.hash().empty()) {
+            *remain.add_blocks() = block;
+        }
+    }
+
+    int result = kErrCodeSuccess;
+    do {
+        int batch = std::min(remain.blocks_size(), kBlockBatchSize);
+        std::vector<ChunkBlock> releasing(remain.blocks().begin(),
+                                          remain.blocks().begin() + batch);
+        remain.mutable_blocks()->DeleteSubrange(0, batch);
+        // 先持久化缩减后的数据块列表(最后一批直接删除列表对象)再释放，
+        // 释放失败或进程重启时本批数据块只会残留，重试不会重复释放
+        if (remain.blocks_size() > 0) {
+            ret = dataStore_->PutChunkBlockMap(name, remain);
+        } else {
+            ret = dataStore_->DeleteChunkData(name);
+        }
+        if (ret < 0) {
+            LOG(ERROR) << "Update chunk block map fail"
+                       << ", ret = " << ret
+                       << ", remainBlocks = " << remain.blocks_size()
+                       << ", chunkDataName = " << name.ToDataChunkKey();
+            return kErrCodeInternalError;
+        }
+        result = ReleaseBlockBatch(releasing);
+    } while (result == kErrCodeSuccess && remain.blocks_size() > 0);
+    return result;
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_BLOCK_STORE_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_BLOCK_STORE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/concurrent/name_lock.h"
+#include "src/common/snapshotclone/snapshot_block.h"
+#include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief CHUNK_DATA_BLOCK格式快照数据块的存储
+ * @detail
+ *  chunk按转储分片切分为数据块，数据块以内容的sha1寻址，
+ *  相同内容的数据块只存储一份，引用计数保存在metastore中，全零块不存储。
+ *  同一数据块的引用、上传和删除通过NameLock串行执行，
+ *  快照服务器同一时刻只有leader在工作，进程内加锁即可。
+ *
+ *  引用计数先于数据块列表对象持久化，转储中途失败或进程重启时
+ *  引用计数只会偏大，数据块可能残留但不会被误删。
+ */
+class SnapshotBlockStore {
+ public:
+    SnapshotBlockStore(std::shared_ptr<SnapshotDataStore> dataStore,
+                       std::shared_ptr<SnapshotCloneMetaStore> metaStore,
+                       BlockCompressType compressType)
+        : dataStore_(dataStore),
+          metaStore_(metaStore),
+          compressType_(compressType) {}
+
+    virtual ~SnapshotBlockStore() {}
+
+    /**
+     * @brief 存储一个数据块并增加其引用计数，
+     *        数据块对象已存在时不再上传
+     *
+     * @param buf 数据块内容
+     * @param len 数据块长度
+     * @param[out] block 数据块信息
+     *
+     * @return 错误码
+     */
+    virtual int PutBlock(const char *buf, size_t len, ChunkBlock *block);
+
+    /**
+     * @brief 增加一个已存在数据块的引用，用于增量快照复用未变化的数据块
+     *
+     * @param block 数据块信息
+     *
+     * @return 错误码，数据块的引用计数已不存在时返回失败，
+     *         此时数据块对象可能已被删除
+     */
+    virtual int RefBlock(const ChunkBlock &block);
+
+    /**
+     * @brief 批量增加已存在数据块的引用，每批数据块的引用计数在一个事务中修改
+     *
+     * @param blocks 数据块信息
+     * @param[out] refed 各数据块是否引用成功，全零块总是成功，
+     *             引用计数已不存在的数据块撤销本次引用
+     *
+     * @return 错误码，出错时继续引用剩余批次，
+     *         refed中为true的数据块均已引用
+     */
+    virtual int RefBlocks(const std::vector<ChunkBlock> &blocks,
+                          std::vector<bool> *refed);
+
+    /**
+     * @brief 释放一个数据块的引用，引用计数为0时删除数据块对象
+     *
+     * @param block 数据块信息
+     *
+     * @return 错误码
+     */
+    virtual int ReleaseBlock(const ChunkBlock &block);
+
+    /**
+     * @brief 释放数据块列表中的所有数据块
+     *
+     * @param blockMap 数据块列表
+     *
+     * @return 错误码，出错时继续释放剩余批次，返回第一个错误
+     */
+    virtual int ReleaseBlocks(const ChunkBlockMap &blockMap);
+
+    /**
+     * @brief 删除CHUNK_DATA_BLOCK格式的chunk数据，
+     *        分批释放数据块，每批释放前先从数据块列表中移除，
+     *        最后一批释放前删除数据块列表对象，
+     *        中途失败时已移除的数据块可能残留，但不会被重复释放，可重试
+     *
+     * @param name chunk数据对象名
+     *
+     * @return 错误码
+     */
+    virtual int DeleteChunkData(const ChunkDataName &name);
+
+ private:
+    /**
+     * @brief 释放一批数据块，引用计数在一个事务中修改
+     *
+     * @param blocks 数据块信息，数量不超过kBlockBatchSize
+     *
+     * @return 错误码，失败时本批数据块均未释放
+     */
+    int ReleaseBlockBatch(const std::vector<ChunkBlock> &blocks);
+
+    /**
+     * @brief 按对象名的顺序锁住一批数据块，不同批次之间不会死锁
+     *
+     * @param keys 数据块对象名
+     * @param[out] guards 锁
+     */
+    void LockBlocks(const std::vector<std::string> &keys,
+        std::vector<std::unique_ptr<curve::common::NameLockGuard>> *guards);
+
+ private:
+    std::shared_ptr<SnapshotDataStore> dataStore_;
+    std::shared_ptr<SnapshotCloneMetaStore> metaStore_;
+    // 新上传数据块的压缩方式
+    BlockCompressType compressType_;
+    // 数据块对象名锁
+    curve::common::NameLock blockLock_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_BLOCK_STORE_H_
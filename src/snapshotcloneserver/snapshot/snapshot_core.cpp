@@ -30,10 +30,12 @@
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
 
 #include "src/common/uuid.h"
+#include "src/common/bitmap.h"
 
 using ::curve::common::UUIDGenerator;
 using ::curve::common::NameLockGuard;
 using ::curve::common::LockGuard;
+using ::curve::common::Bitmap;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -44,6 +46,14 @@ int SnapshotCoreImpl::Init() {
         LOG(ERROR) << "SnapshotCoreImpl, thread start fail, ret = " << ret;
         return ret;
     }
+    if (transferPipeline_ != nullptr) {
+        ret = transferPipeline_->Start();
+        if (ret < 0) {
+            LOG(ERROR) << "SnapshotCoreImpl, transfer pipeline start fail"
+                       << ", ret = " << ret;
+            return ret;
+        }
+    }
     return kErrCodeSuccess;
 }
 
@@ -220,6 +230,9 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
     ChunkIndexDataName name(fileName, seqNum);
     // the key is segment index
     std::map<uint64_t, SegmentInfo> segInfos;
+    FileSnapMap fileSnapshotMap;
+    // 只有新构建索引时才获取chunk的变化块，重启后恢复的任务全量转储
+    std::map<ChunkIndexType, ChunkReuseInfo> reuseInfos;
     if (existIndexData) {
         ret = dataStore_->GetChunkIndexData(name, &indexData);
         if (ret < 0) {
@@ -244,7 +257,9 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             return;
         }
     } else {
-        ret = BuildChunkIndexData(*info, &indexData, &segInfos, task);
+        std::map<ChunkIndexType, ChunkChangedInfo> changedInfos;
+        ret = BuildChunkIndexData(*info, &indexData, &segInfos,
+            &changedInfos, task);
         if (ret < 0) {
             LOG(ERROR) << "BuildChunkIndexData error, "
                        << " ret = " << ret
@@ -253,6 +268,22 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             return;
         }
 
+        // 存储格式需在索引落盘前确定，因此先构建快照映射表
+        ret = BuildSnapshotMap(fileName,
+            seqNum,
+            &fileSnapshotMap);
+        if (ret < 0) {
+            LOG(ERROR) << "BuildSnapshotMap error, "
+                       << " fileName = " << task->GetFileName()
+                       << ", seqNum = " << seqNum
+                       << ", uuid = " << task->GetUuid();
+            HandleCreateSnapshotError(task);
+            return;
+        }
+        SetChunkDataFormat(fileSnapshotMap, &indexData);
+        BuildChunkReuseInfo(indexData, fileSnapshotMap, changedInfos,
+            info->GetChunkSize(), &reuseInfos);
+
         ret = dataStore_->PutChunkIndexData(name, indexData);
         if (ret < 0) {
             LOG(ERROR) << "PutChunkIndexData error, "
@@ -270,17 +301,18 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
         return CancelAfterCreateChunkIndexData(task);
     }
 
-    FileSnapMap fileSnapshotMap;
-    ret = BuildSnapshotMap(fileName,
-        seqNum,
-        &fileSnapshotMap);
-    if (ret < 0) {
-        LOG(ERROR) << "BuildSnapshotMap error, "
-                   << " fileName = " << task->GetFileName()
-                   << ", seqNum = " << seqNum
-                   << ", uuid = " << task->GetUuid();
-        HandleCreateSnapshotError(task);
-        return;
+    if (existIndexData) {
+        ret = BuildSnapshotMap(fileName,
+            seqNum,
+            &fileSnapshotMap);
+        if (ret < 0) {
+            LOG(ERROR) << "BuildSnapshotMap error, "
+                       << " fileName = " << task->GetFileName()
+                       << ", seqNum = " << seqNum
+                       << ", uuid = " << task->GetUuid();
+            HandleCreateSnapshotError(task);
+            return;
+        }
     }
     task->SetProgress(kProgressBuildSnapshotMapComplete);
     task->UpdateMetric();
@@ -292,6 +324,7 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             [this] (const ChunkDataName &chunkDataName) {
                 return dataStore_->ChunkDataExist(chunkDataName);
             },
+            reuseInfos,
             task);
     } else {
         ret = TransferSnapshotData(indexData,
@@ -300,6 +333,7 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             [&fileSnapshotMap] (const ChunkDataName &chunkDataName) {
                 return fileSnapshotMap.IsExistChunk(chunkDataName);
             },
+            reuseInfos,
             task);
     }
     if (ret < 0) {
@@ -389,7 +423,7 @@ void SnapshotCoreImpl::CancelAfterTransferSnapshotData(
         indexData.GetChunkDataName(chunkIndex, &chunkDataName);
         if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
             (dataStore_->ChunkDataExist(chunkDataName))) {
-            int ret =  dataStore_->DeleteChunkData(chunkDataName);
+            int ret = DeleteChunkData(indexData, chunkDataName);
             if (ret < 0) {
                 LOG(ERROR) << "DeleteChunkData error"
                            << "while canceling CreateSnapshot, "
@@ -645,6 +679,7 @@ int SnapshotCoreImpl::BuildChunkIndexData(
     const SnapshotInfo &info,
     ChunkIndexData *indexData,
     std::map<uint64_t, SegmentInfo> *segInfos,
+    std::map<ChunkIndexType, ChunkChangedInfo> *changedInfos,
     std::shared_ptr<SnapshotTaskInfo> task) {
     std::string fileName = info.GetFileName();
     std::string user = info.GetUser();
@@ -714,6 +749,14 @@ int SnapshotCoreImpl::BuildChunkIndexData(
                                << ", uuid = " << task->GetUuid();
                     return kErrCodeInternalError;
                 }
+                if (chunkInfo.changedTracked) {
+                    chunkIndex = i * (segmentSize / chunkSize) + j;
+                    ChunkChangedInfo changedInfo;
+                    changedInfo.baseSn = chunkInfo.changedBaseSn;
+                    changedInfo.blockSize = chunkInfo.changedBlockSize;
+                    changedInfo.bitmap = std::move(chunkInfo.changedBitmap);
+                    changedInfos->emplace(chunkIndex, std::move(changedInfo));
+                }
                 if (task->IsCanceled()) {
                     return kErrCodeSuccess;
                 }
@@ -779,6 +822,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
     const SnapshotInfo &info,
     const std::map<uint64_t, SegmentInfo> &segInfos,
     const ChunkDataExistFilter &filter,
+    const std::map<ChunkIndexType, ChunkReuseInfo> &reuseInfos,
     std::shared_ptr<SnapshotTaskInfo> task) {
     int ret = 0;
     uint64_t segmentSize = info.GetSegmentSize();
@@ -845,12 +889,24 @@ int SnapshotCoreImpl::TransferSnapshotData(
                         clientAsyncMethodRetryTimeSec_,
                         clientAsyncMethodRetryIntervalMs_,
                         readChunkSnapshotConcurrency_);
+                auto reuseIt = reuseInfos.find(chunkIndex);
+                if (reuseIt != reuseInfos.end()) {
+                    taskInfo->baseName_ = reuseIt->second.baseName;
+                    taskInfo->cleanParts_ = reuseIt->second.cleanParts;
+                }
                 UUID taskId = UUIDGenerator().GenerateUUID();
+                std::shared_ptr<SnapshotBlockStore> blockStore;
+                if (indexData.GetChunkDataFormat(chunkIndex) ==
+                    CHUNK_DATA_BLOCK) {
+                    blockStore = blockStore_;
+                }
                 auto task = new TransferSnapshotDataChunkTask(
                     taskId,
                     taskInfo,
                     client_,
-                    dataStore_);
+                    dataStore_,
+                    blockStore,
+                    transferPipeline_);
                 task->SetTracker(tracker);
                 tracker->AddOneTrace();
                 threadPool_->PushTask(task);
@@ -1010,7 +1066,7 @@ void SnapshotCoreImpl::HandleDeleteSnapshotTask(
             indexData.GetChunkDataName(chunkIndex, &chunkDataName);
             if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
                 (dataStore_->ChunkDataExist(chunkDataName))) {
-                ret =  dataStore_->DeleteChunkData(chunkDataName);
+                ret = DeleteChunkData(indexData, chunkDataName);
                 if (ret < 0) {
                     LOG(ERROR) << "DeleteChunkData error, "
                                << " ret = " << ret
@@ -1139,6 +1195,88 @@ int SnapshotCoreImpl::BuildSnapshotMap(const std::string &fileName,
     return kErrCodeSuccess;
 }
 
+int SnapshotCoreImpl::DeleteChunkData(const ChunkIndexData &indexData,
+    const ChunkDataName &chunkDataName) {
+    if (indexData.GetChunkDataFormat(chunkDataName.chunkIndex_) ==
+        CHUNK_DATA_BLOCK) {
+        return blockStore_->DeleteChunkData(chunkDataName);
+    }
+    return dataStore_->DeleteChunkData(chunkDataName);
+}
+
+void SnapshotCoreImpl::SetChunkDataFormat(
+    const FileSnapMap &fileSnapshotMap,
+    ChunkIndexData *indexData) {
+    ChunkDataFormat newFormat =
+        blockFormatEnable_ ? CHUNK_DATA_BLOCK : CHUNK_DATA_RAW;
+    for (auto chunkIndex : indexData->GetAllChunkIndex()) {
+        ChunkDataName chunkDataName;
+        indexData->GetChunkDataName(chunkIndex, &chunkDataName);
+        // 复用其他快照的chunk数据时沿用其存储格式
+        ChunkDataFormat format = newFormat;
+        fileSnapshotMap.GetChunkDataFormat(chunkDataName, &format);
+        indexData->SetChunkDataFormat(chunkIndex, format);
+    }
+}
+
+void SnapshotCoreImpl::BuildChunkReuseInfo(
+    const ChunkIndexData &indexData,
+    const FileSnapMap &fileSnapshotMap,
+    const std::map<ChunkIndexType, ChunkChangedInfo> &changedInfos,
+    uint64_t chunkSize,
+    std::map<ChunkIndexType, ChunkReuseInfo> *reuseInfos) {
+    if (0 == chunkSplitSize_ || chunkSize % chunkSplitSize_ != 0) {
+        return;
+    }
+    for (auto &item : changedInfos) {
+        ChunkIndexType chunkIndex = item.first;
+        const ChunkChangedInfo &changedInfo = item.second;
+        ChunkDataName chunkDataName;
+        if (indexData.GetChunkDataFormat(chunkIndex) != CHUNK_DATA_BLOCK ||
+            !indexData.GetChunkDataName(chunkIndex, &chunkDataName) ||
+            fileSnapshotMap.IsExistChunk(chunkDataName)) {
+            continue;
+        }
+        // 从chunk创建开始跟踪时，chunk可能被删除后重建，
+        // 未变化的分片不一定与更早快照的数据相同，不可复用
+        if (kUnInitializeSeqNum == changedInfo.baseSn) {
+            continue;
+        }
+        // 更早快照的数据版本不小于变化跟踪的起点时，
+        // 之后的所有修改都已在bitmap中标记
+        ChunkDataName baseName;
+        if (!fileSnapshotMap.GetPrevBlockChunkData(chunkDataName, &baseName) ||
+            baseName.chunkSeqNum_ < changedInfo.baseSn) {
+            continue;
+        }
+        uint32_t blockSize = changedInfo.blockSize;
+        if (0 == blockSize || chunkSplitSize_ % blockSize != 0 ||
+            changedInfo.bitmap.size() * 8 < chunkSize / blockSize) {
+            LOG(WARNING) << "Changed blocks not match chunk split size"
+                         << ", blockSize = " << blockSize
+                         << ", bitmap size = " << changedInfo.bitmap.size()
+                         << ", chunkDataName = "
+                         << chunkDataName.ToDataChunkKey();
+            continue;
+        }
+        Bitmap bitmap(chunkSize / blockSize, changedInfo.bitmap.data());
+        uint32_t blockPerPart = chunkSplitSize_ / blockSize;
+        ChunkReuseInfo reuseInfo;
+        reuseInfo.baseName = baseName;
+        bool anyClean = false;
+        for (uint64_t i = 0; i < chunkSize / chunkSplitSize_; i++) {
+            uint32_t begin = i * blockPerPart;
+            bool clean = bitmap.NextSetBit(begin, begin + blockPerPart - 1) ==
+                Bitmap::NO_POS;
+            reuseInfo.cleanParts.push_back(clean);
+            anyClean = anyClean || clean;
+        }
+        if (anyClean) {
+            reuseInfos->emplace(chunkIndex, std::move(reuseInfo));
+        }
+    }
+}
+
 int SnapshotCoreImpl::GetSnapshotList(std::vector<SnapshotInfo> *list) {
     metaStore_->GetSnapshotList(list);
     return kErrCodeSuccess;
@@ -31,6 +31,8 @@
 #include "src/snapshotcloneserver/common/curvefs_client.h"
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_block_store.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/config.h"
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
@@ -44,6 +46,27 @@ namespace snapshotcloneserver {
 
 class SnapshotTaskInfo;
 
+/**
+ * @brief chunk自更早快照以来的变化块信息
+ */
+struct ChunkChangedInfo {
+    // bitmap中标记了版本号大于baseSn的写入所修改的块
+    uint64_t baseSn;
+    // 每个bit对应的块大小
+    uint32_t blockSize;
+    std::string bitmap;
+};
+
+/**
+ * @brief 增量转储时chunk可复用的更早快照数据
+ */
+struct ChunkReuseInfo {
+    // 被复用数据块的更早快照的chunk数据
+    ChunkDataName baseName;
+    // 下标为分片索引，为true的分片未变化，直接引用baseName的数据块
+    std::vector<bool> cleanParts;
+};
+
 /**
  * @brief 文件的快照索引块映射表
  */
@@ -68,6 +91,52 @@ struct FileSnapMap {
         }
         return find;
     }
+
+    /**
+     * @brief 获取映射表中已存在的chunk数据的存储格式
+     *
+     * @param name chunk数据对象
+     * @param[out] format chunk数据存储格式
+     *
+     * @retval true 存在
+     * @retval false 不存在
+     */
+    bool GetChunkDataFormat(const ChunkDataName &name,
+        ChunkDataFormat *format) const {
+        for (auto &v : maps) {
+            if (v.IsExistChunkDataName(name)) {
+                *format = v.GetChunkDataFormat(name.chunkIndex_);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 获取映射表中同一chunk版本号小于name的
+     *        最新的CHUNK_DATA_BLOCK格式的chunk数据
+     *
+     * @param name chunk数据对象
+     * @param[out] prev 更早的chunk数据对象
+     *
+     * @retval true 存在
+     * @retval false 不存在
+     */
+    bool GetPrevBlockChunkData(const ChunkDataName &name,
+        ChunkDataName *prev) const {
+        bool find = false;
+        for (auto &v : maps) {
+            ChunkDataName other;
+            if (v.GetChunkDataName(name.chunkIndex_, &other) &&
+                other.chunkSeqNum_ < name.chunkSeqNum_ &&
+                v.GetChunkDataFormat(name.chunkIndex_) == CHUNK_DATA_BLOCK &&
+                (!find || other.chunkSeqNum_ > prev->chunkSeqNum_)) {
+                *prev = other;
+                find = true;
+            }
+        }
+        return find;
+    }
 };
 
 /**
@@ -195,15 +264,35 @@ class SnapshotCoreImpl : public SnapshotCore {
       clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
       clientAsyncMethodRetryIntervalMs_(
                 option.clientAsyncMethodRetryIntervalMs),
-      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency) {
+      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency),
+      blockFormatEnable_(option.snapshotBlockFormatEnable) {
         threadPool_ = std::make_shared<ThreadPool>(
             option.snapshotCoreThreadNum);
+        BlockCompressType compressType = BLOCK_COMPRESS_SNAPPY;
+        if (!SnapshotBlockCodec::ParseCompressType(
+                option.snapshotBlockCompressType, &compressType)) {
+            LOG(WARNING) << "Invalid snapshotBlockCompressType: "
+                         << option.snapshotBlockCompressType
+                         << ", use snappy";
+        }
+        // 关闭块格式时仍需要删除已有的块格式快照数据
+        blockStore_ = std::make_shared<SnapshotBlockStore>(
+            dataStore, metaStore, compressType);
+        // 上传线程数为0时不使用流水线，读取分片后在chunk任务中同步上传
+        if (option.snapshotUploadThreadNum > 0) {
+            transferPipeline_ = std::make_shared<SnapshotTransferPipeline>(
+                option.snapshotTransferBufferSize,
+                option.snapshotUploadThreadNum);
+        }
     }
 
     int Init();
 
     ~SnapshotCoreImpl() {
         threadPool_->Stop();
+        if (transferPipeline_ != nullptr) {
+            transferPipeline_->Stop();
+        }
     }
 
     // 公有接口定义见SnapshotCore接口注释
@@ -251,6 +340,43 @@ class SnapshotCoreImpl : public SnapshotCore {
         uint64_t seqNum,
         FileSnapMap *fileSnapshotMap);
 
+    /**
+     * @brief 按存储格式删除chunk数据
+     *
+     * @param indexData 快照索引
+     * @param chunkDataName chunk数据对象
+     *
+     * @return 错误码
+     */
+    int DeleteChunkData(const ChunkIndexData &indexData,
+        const ChunkDataName &chunkDataName);
+
+    /**
+     * @brief 设置快照索引中各chunk数据的存储格式，
+     *        已被其他快照转储的chunk沿用原有格式
+     *
+     * @param fileSnapshotMap 文件的快照映射表
+     * @param[in,out] indexData 快照索引
+     */
+    void SetChunkDataFormat(const FileSnapMap &fileSnapshotMap,
+        ChunkIndexData *indexData);
+
+    /**
+     * @brief 根据chunk的变化块信息，计算增量转储时各chunk可复用的数据，
+     *        只有CHUNK_DATA_BLOCK格式且需要转储的chunk可复用
+     *
+     * @param indexData 快照索引
+     * @param fileSnapshotMap 文件的快照映射表
+     * @param changedInfos chunk index => 变化块信息
+     * @param chunkSize chunk大小
+     * @param[out] reuseInfos chunk index => 可复用的数据
+     */
+    void BuildChunkReuseInfo(const ChunkIndexData &indexData,
+        const FileSnapMap &fileSnapshotMap,
+        const std::map<ChunkIndexType, ChunkChangedInfo> &changedInfos,
+        uint64_t chunkSize,
+        std::map<ChunkIndexType, ChunkReuseInfo> *reuseInfos);
+
     /**
      * @brief 构建Segment信息
      *
@@ -292,6 +418,7 @@ class SnapshotCoreImpl : public SnapshotCore {
      * @param info 快照信息
      * @param[out] indexData 索引块
      * @param[out] segInfos Segment信息
+     * @param[out] changedInfos 跟踪了变化块的chunk的变化块信息
      * @param task 快照任务信息
      *
      * @return 错误码
@@ -300,6 +427,7 @@ class SnapshotCoreImpl : public SnapshotCore {
         const SnapshotInfo &info,
         ChunkIndexData *indexData,
         std::map<uint64_t, SegmentInfo> *segInfos,
+        std::map<ChunkIndexType, ChunkChangedInfo> *changedInfos,
         std::shared_ptr<SnapshotTaskInfo> task);
 
     using ChunkDataExistFilter =
@@ -312,6 +440,7 @@ class SnapshotCoreImpl : public SnapshotCore {
      * @param info 快照信息
      * @param segInfos Segment信息
      * @param filter 转储数据块过滤器
+     * @param reuseInfos 各chunk可复用的更早快照数据
      * @param task 快照任务信息
      *
      * @return  错误码
@@ -321,6 +450,7 @@ class SnapshotCoreImpl : public SnapshotCore {
         const SnapshotInfo &info,
         const std::map<uint64_t, SegmentInfo> &segInfos,
         const ChunkDataExistFilter &filter,
+        const std::map<ChunkIndexType, ChunkReuseInfo> &reuseInfos,
         std::shared_ptr<SnapshotTaskInfo> task);
 
     /**
@@ -435,6 +565,13 @@ class SnapshotCoreImpl : public SnapshotCore {
     uint64_t clientAsyncMethodRetryIntervalMs_;
     // 异步ReadChunkSnapshot的并发数
     uint32_t readChunkSnapshotConcurrency_;
+
+    // CHUNK_DATA_BLOCK格式快照数据块存储
+    std::shared_ptr<SnapshotBlockStore> blockStore_;
+    // 新转储的chunk是否使用CHUNK_DATA_BLOCK格式
+    bool blockFormatEnable_;
+    // 所有快照共享的数据转储流水线
+    std::shared_ptr<SnapshotTransferPipeline> transferPipeline_;
 };
 
 }  // namespace snapshotcloneserver
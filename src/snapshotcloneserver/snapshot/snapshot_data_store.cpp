@@ -65,6 +65,9 @@ bool ChunkIndexData::Serialize(std::string *data) const {
                 ChunkDataName(fileName_, m.second, m.first).
                 ToDataChunkKey()});
     }
+    for (const auto &f : this->formatMap_) {
+        map.mutable_formatmap()->insert({f.first, f.second});
+    }
     // Todo：可以转化为stream给adpater接口使用SerializeToOstream
     return map.SerializeToString(data);
 }
@@ -82,6 +85,15 @@ bool ChunkIndexData::Unserialize(const std::string &data) {
                 return false;
             }
         }
+        for (const auto &f : map.formatmap()) {
+            if (!ChunkDataFormat_IsValid(f.second)) {
+                LOG(ERROR) << "Unknown chunk data format " << f.second
+                           << ", chunkIndex = " << f.first;
+                return false;
+            }
+            SetChunkDataFormat(f.first,
+                static_cast<ChunkDataFormat>(f.second));
+        }
         return true;
     } else {
         return false;
@@ -120,5 +132,23 @@ std::vector<ChunkIndexType> ChunkIndexData::GetAllChunkIndex() const {
     return ret;
 }
 
+void ChunkIndexData::SetChunkDataFormat(ChunkIndexType index,
+    ChunkDataFormat format) {
+    if (format == CHUNK_DATA_RAW) {
+        formatMap_.erase(index);
+    } else {
+        formatMap_[index] = format;
+    }
+}
+
+ChunkDataFormat ChunkIndexData::GetChunkDataFormat(
+    ChunkIndexType index) const {
+    auto it = formatMap_.find(index);
+    if (it != formatMap_.end()) {
+        return it->second;
+    }
+    return CHUNK_DATA_RAW;
+}
+
 }   // namespace snapshotcloneserver
 }   // namespace curve
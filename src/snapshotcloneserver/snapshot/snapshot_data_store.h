@@ -33,6 +33,7 @@
 #include <memory>
 
 #include "src/common/concurrent/concurrent.h"
+#include "proto/snapshotcloneserver.pb.h"
 
 using ::curve::common::SpinLock;
 using ::curve::common::LockGuard;
@@ -142,6 +143,16 @@ class ChunkIndexData {
 
     std::vector<ChunkIndexType> GetAllChunkIndex() const;
 
+    /**
+     * @brief 设置chunk数据对象的存储格式
+     */
+    void SetChunkDataFormat(ChunkIndexType index, ChunkDataFormat format);
+
+    /**
+     * @brief 获取chunk数据对象的存储格式，未设置的为CHUNK_DATA_RAW
+     */
+    ChunkDataFormat GetChunkDataFormat(ChunkIndexType index) const;
+
     void SetFileName(const std::string &fileName) {
         fileName_ = fileName;
     }
@@ -155,6 +166,8 @@ class ChunkIndexData {
     std::string fileName_;
     // 快照文件索引信息map
     std::map<ChunkIndexType, SnapshotSeqType> chunkMap_;
+    // 非CHUNK_DATA_RAW格式的chunk数据对象
+    std::map<ChunkIndexType, ChunkDataFormat> formatMap_;
 };
 
 
@@ -289,6 +302,43 @@ class SnapshotDataStore {
      */
     virtual int DataChunkTranferAbort(const ChunkDataName &name,
                                       std::shared_ptr<TransferTask> task) = 0;
+    /**
+     * 存储CHUNK_DATA_BLOCK格式的数据chunk，即数据块列表
+     * 在数据块全部存储之后调用，之后ChunkDataExist返回true
+     * @param 数据chunk名
+     * @param 数据块列表
+     * @return: 0 存储成功/ -1 存储失败
+     */
+    virtual int PutChunkBlockMap(const ChunkDataName &name,
+                                 const ChunkBlockMap &blockMap) = 0;
+    /**
+     * 获取CHUNK_DATA_BLOCK格式数据chunk的数据块列表
+     * @param 数据chunk名
+     * @param[out] 数据块列表
+     * @return: 0 获取成功/ -1 获取失败
+     */
+    virtual int GetChunkBlockMap(const ChunkDataName &name,
+                                 ChunkBlockMap *blockMap) = 0;
+    /**
+     * 存储一个数据块对象
+     * @param 数据块对象名
+     * @param 数据块对象内容
+     * @return: 0 存储成功/ -1 存储失败
+     */
+    virtual int PutDataBlock(const std::string &key,
+                             const std::string &data) = 0;
+    /**
+     * 删除一个数据块对象
+     * @param 数据块对象名
+     * @return: 0 删除成功/ -1 删除失败
+     */
+    virtual int DeleteDataBlock(const std::string &key) = 0;
+    /**
+     * 判断数据块对象是否存在
+     * @param 数据块对象名
+     * @return: true 存在/ false 不存在
+     */
+    virtual bool DataBlockExist(const std::string &key) = 0;
 };
 
 }   // namespace snapshotcloneserver
@@ -0,0 +1,626 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/snapshotcloneserver/snapshot/snapshot_data_store_local.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+#include "src/common/crc32.h"
+#include "src/common/snapshotclone/snapshot_block.h"
+#include "src/common/uuid.h"
+
+using ::curve::common::LockGuard;
+using ::curve::common::UUIDGenerator;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+namespace {
+
+const char kPackRecordPut = 'P';
+const char kPackRecordDelete = 'D';
+
+bool ParsePackId(const std::string &fileName, const std::string &suffix,
+                 uint64_t *id) {
+    if (fileName.size() <= suffix.size() ||
+        fileName.compare(fileName.size() - suffix.size(),
+                         suffix.size(), suffix) != 0) {
+        return false;
+    }
+    std::string idStr = fileName.substr(0, fileName.size() - suffix.size());
+    if (!std::all_of(idStr.begin(), idStr.end(), ::isdigit)) {
+        return false;
+    }
+    *id = std::stoull(idStr);
+    return true;
+}
+
+}  // namespace
+
+LocalSnapshotDataStore::~LocalSnapshotDataStore() {
+    LockGuard guard(packMutex_);
+    for (auto &pack : packs_) {
+        ClosePack(pack.second);
+    }
+    packs_.clear();
+    activePack_ = nullptr;
+}
+
+std::string LocalSnapshotDataStore::MetaPath(
+    const ChunkIndexDataName &name) const {
+    return rootPath_ + SnapshotLocalLayout::kMetaDir +
+        SnapshotLocalLayout::EncodeFileName(name.ToIndexDataChunkKey());
+}
+
+std::string LocalSnapshotDataStore::ChunkPath(
+    const ChunkDataName &name) const {
+    return SnapshotLocalLayout::ChunkPath(rootPath_, name.ToDataChunkKey());
+}
+
+std::string LocalSnapshotDataStore::PackPath(uint64_t packId) const {
+    return SnapshotLocalLayout::PackPath(rootPath_, packId);
+}
+
+std::string LocalSnapshotDataStore::PackIdxPath(uint64_t packId) const {
+    return SnapshotLocalLayout::PackIdxPath(rootPath_, packId);
+}
+
+int LocalSnapshotDataStore::Init(const std::string &path) {
+    rootPath_ = path;
+    for (const char *dir : {SnapshotLocalLayout::kMetaDir,
+                            SnapshotLocalLayout::kChunkDir,
+                            SnapshotLocalLayout::kPackDir,
+                            SnapshotLocalLayout::kTmpDir}) {
+        int ret = lfs_->Mkdir(rootPath_ + dir);
+        if (ret < 0) {
+            LOG(ERROR) << "Mkdir fail, ret = " << ret
+                       << ", path = " << rootPath_ + dir;
+            return -1;
+        }
+    }
+
+    // 清理上次退出时未完成的转储
+    std::vector<std::string> names;
+    int ret = lfs_->List(rootPath_ + SnapshotLocalLayout::kTmpDir, &names);
+    if (ret < 0) {
+        LOG(ERROR) << "List tmp dir fail, ret = " << ret;
+        return -1;
+    }
+    for (auto &name : names) {
+        ret = lfs_->Delete(rootPath_ + SnapshotLocalLayout::kTmpDir + name);
+        LOG_IF(WARNING, ret < 0) << "Delete tmp file fail, ret = " << ret
+                                 << ", name = " << name;
+    }
+
+    LockGuard guard(packMutex_);
+    ret = LoadPacks();
+    if (ret < 0) {
+        return ret;
+    }
+    ret = OpenNewPack();
+    if (ret < 0) {
+        return ret;
+    }
+    LOG(INFO) << "LocalSnapshotDataStore init success"
+              << ", rootPath = " << rootPath_
+              << ", packNum = " << packs_.size()
+              << ", blockNum = " << blockIndex_.size();
+    return 0;
+}
+
+int LocalSnapshotDataStore::LoadPacks() {
+    std::vector<std::string> names;
+    int ret = lfs_->List(rootPath_ + SnapshotLocalLayout::kPackDir, &names);
+    if (ret < 0) {
+        LOG(ERROR) << "List pack dir fail, ret = " << ret;
+        return -1;
+    }
+    std::vector<uint64_t> idxIds;
+    std::vector<uint64_t> packIds;
+    for (auto &name : names) {
+        uint64_t id = 0;
+        if (ParsePackId(name, SnapshotLocalLayout::kPackIdxSuffix, &id)) {
+            idxIds.push_back(id);
+        } else if (ParsePackId(name, SnapshotLocalLayout::kPackSuffix, &id)) {
+            packIds.push_back(id);
+        }
+    }
+    std::sort(idxIds.begin(), idxIds.end());
+    for (uint64_t id : idxIds) {
+        nextPackId_ = std::max(nextPackId_, id + 1);
+        if (std::find(packIds.begin(), packIds.end(), id) == packIds.end()) {
+            // pack文件已删除，.idx文件删除前退出
+            lfs_->Delete(PackIdxPath(id));
+            continue;
+        }
+        auto pack = std::make_shared<SnapshotPackFile>();
+        pack->id = id;
+        pack->sealed = true;
+        pack->fd = lfs_->Open(PackPath(id), O_RDWR);
+        pack->idxFd = lfs_->Open(PackIdxPath(id), O_RDWR);
+        packs_.emplace(id, pack);
+        if (pack->fd < 0 || pack->idxFd < 0) {
+            LOG(ERROR) << "Open pack file fail, packId = " << id;
+            return -1;
+        }
+        struct stat info;
+        ret = lfs_->Fstat(pack->fd, &info);
+        if (ret < 0) {
+            LOG(ERROR) << "Fstat pack file fail, packId = " << id;
+            return -1;
+        }
+        pack->size = info.st_size;
+        ret = ReplayPackIdx(pack);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    for (uint64_t id : packIds) {
+        nextPackId_ = std::max(nextPackId_, id + 1);
+        if (packs_.find(id) == packs_.end()) {
+            // 还未记录任何数据块
+            lfs_->Delete(PackPath(id));
+        }
+    }
+
+    std::vector<std::shared_ptr<SnapshotPackFile>> loaded;
+    for (auto &pack : packs_) {
+        loaded.push_back(pack.second);
+    }
+    for (auto &pack : loaded) {
+        TryRemovePack(pack);
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::ReplayPackIdx(
+    std::shared_ptr<SnapshotPackFile> pack) {
+    struct stat info;
+    int ret = lfs_->Fstat(pack->idxFd, &info);
+    if (ret < 0) {
+        LOG(ERROR) << "Fstat pack idx fail, packId = " << pack->id;
+        return -1;
+    }
+    std::string content(info.st_size, '\0');
+    if (info.st_size > 0) {
+        ret = lfs_->Read(pack->idxFd, &content[0], 0, info.st_size);
+        if (ret != info.st_size) {
+            LOG(ERROR) << "Read pack idx fail, ret = " << ret
+                       << ", packId = " << pack->id;
+            return -1;
+        }
+    }
+
+    // 最后一条记录可能没有写完，之后的记录从其开头写起
+    size_t validSize = content.rfind('\n');
+    validSize = (validSize == std::string::npos) ? 0 : validSize + 1;
+    pack->idxSize = validSize;
+
+    std::istringstream lines(content.substr(0, validSize));
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        char type = 0;
+        std::string key;
+        fields >> type >> key;
+        if (type == kPackRecordPut) {
+            SnapshotPackEntry entry;
+            entry.packId = pack->id;
+            if (!(fields >> entry.offset >> entry.length >> entry.crc) ||
+                entry.offset + entry.length > pack->size) {
+                LOG(WARNING) << "Skip invalid pack record: " << line
+                             << ", packId = " << pack->id;
+                continue;
+            }
+            auto it = blockIndex_.find(key);
+            if (it != blockIndex_.end()) {
+                packs_[it->second.packId]->liveCount--;
+            }
+            blockIndex_[key] = entry;
+            pack->liveCount++;
+        } else if (type == kPackRecordDelete) {
+            auto it = blockIndex_.find(key);
+            if (it != blockIndex_.end()) {
+                packs_[it->second.packId]->liveCount--;
+                blockIndex_.erase(it);
+            }
+        } else {
+            LOG(WARNING) << "Skip invalid pack record: " << line
+                         << ", packId = " << pack->id;
+        }
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::OpenNewPack() {
+    auto pack = std::make_shared<SnapshotPackFile>();
+    pack->id = nextPackId_++;
+    pack->fd = lfs_->Open(PackPath(pack->id), O_RDWR | O_CREAT);
+    if (pack->fd < 0) {
+        LOG(ERROR) << "Create pack file fail, packId = " << pack->id;
+        return -1;
+    }
+    pack->idxFd = lfs_->Open(PackIdxPath(pack->id), O_RDWR | O_CREAT);
+    if (pack->idxFd < 0) {
+        LOG(ERROR) << "Create pack idx fail, packId = " << pack->id;
+        ClosePack(pack);
+        lfs_->Delete(PackPath(pack->id));
+        return -1;
+    }
+    packs_.emplace(pack->id, pack);
+    std::shared_ptr<SnapshotPackFile> old = activePack_;
+    activePack_ = pack;
+    if (old != nullptr) {
+        old->sealed = true;
+        TryRemovePack(old);
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::AppendPackIdx(
+    std::shared_ptr<SnapshotPackFile> pack, const std::string &record) {
+    int ret = lfs_->Write(pack->idxFd, record.data(), pack->idxSize,
+                          record.size());
+    if (ret < 0) {
+        LOG(ERROR) << "Write pack idx fail, ret = " << ret
+                   << ", packId = " << pack->id;
+        return -1;
+    }
+    ret = lfs_->Sync(pack->idxFd);
+    if (ret < 0) {
+        LOG(ERROR) << "Sync pack idx fail, ret = " << ret
+                   << ", packId = " << pack->id;
+        return -1;
+    }
+    pack->idxSize += record.size();
+    return 0;
+}
+
+void LocalSnapshotDataStore::TryRemovePack(
+    std::shared_ptr<SnapshotPackFile> pack) {
+    if (pack == activePack_ || !pack->sealed ||
+        pack->liveCount > 0 || pack->writing > 0) {
+        return;
+    }
+    ClosePack(pack);
+    // 先删除pack文件，中途退出时重启会清理剩下的.idx文件
+    int ret = lfs_->Delete(PackPath(pack->id));
+    if (ret == 0) {
+        ret = lfs_->Delete(PackIdxPath(pack->id));
+    }
+    LOG_IF(WARNING, ret < 0) << "Delete pack file fail, ret = " << ret
+                             << ", packId = " << pack->id;
+    packs_.erase(pack->id);
+}
+
+void LocalSnapshotDataStore::ClosePack(
+    std::shared_ptr<SnapshotPackFile> pack) {
+    // 内存映射由最后一个持有者释放
+    if (pack->fd >= 0) {
+        lfs_->Close(pack->fd);
+        pack->fd = -1;
+    }
+    if (pack->idxFd >= 0) {
+        lfs_->Close(pack->idxFd);
+        pack->idxFd = -1;
+    }
+}
+
+int LocalSnapshotDataStore::WriteFile(const std::string &path,
+                                      const std::string &data) {
+    std::string tmpPath = rootPath_ + SnapshotLocalLayout::kTmpDir +
+        UUIDGenerator().GenerateUUID();
+    int fd = lfs_->Open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        LOG(ERROR) << "Open tmp file fail, ret = " << fd
+                   << ", path = " << path;
+        return -1;
+    }
+    int ret = lfs_->Write(fd, data.data(), 0, data.size());
+    if (ret >= 0) {
+        ret = lfs_->Sync(fd);
+    }
+    lfs_->Close(fd);
+    if (ret >= 0) {
+        ret = lfs_->Rename(tmpPath, path);
+    }
+    if (ret < 0) {
+        LOG(ERROR) << "Write file fail, ret = " << ret
+                   << ", path = " << path;
+        lfs_->Delete(tmpPath);
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::ReadFile(const std::string &path,
+                                     std::string *data) {
+    int fd = lfs_->Open(path, O_RDONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "Open file fail, ret = " << fd
+                   << ", path = " << path;
+        return -1;
+    }
+    struct stat info;
+    int ret = lfs_->Fstat(fd, &info);
+    if (ret >= 0) {
+        data->resize(info.st_size);
+        if (info.st_size > 0) {
+            ret = lfs_->Read(fd, &(*data)[0], 0, info.st_size);
+            if (ret >= 0 && ret != info.st_size) {
+                ret = -1;
+            }
+        }
+    }
+    lfs_->Close(fd);
+    if (ret < 0) {
+        LOG(ERROR) << "Read file fail, ret = " << ret
+                   << ", path = " << path;
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::DeleteFile(const std::string &path) {
+    if (!lfs_->FileExists(path)) {
+        return 0;
+    }
+    int ret = lfs_->Delete(path);
+    if (ret < 0) {
+        LOG(ERROR) << "Delete file fail, ret = " << ret
+                   << ", path = " << path;
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::PutChunkIndexData(const ChunkIndexDataName &name,
+    const ChunkIndexData &indexData) {
+    std::string data;
+    if (!indexData.Serialize(&data)) {
+        LOG(ERROR) << "Failed to serialize ChunkIndexData";
+        return -1;
+    }
+    return WriteFile(MetaPath(name), data);
+}
+
+int LocalSnapshotDataStore::GetChunkIndexData(const ChunkIndexDataName &name,
+    ChunkIndexData *indexData) {
+    std::string data;
+    if (ReadFile(MetaPath(name), &data) < 0 ||
+        !indexData->Unserialize(data)) {
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::DeleteChunkIndexData(
+    const ChunkIndexDataName &name) {
+    return DeleteFile(MetaPath(name));
+}
+
+bool LocalSnapshotDataStore::ChunkIndexDataExist(
+    const ChunkIndexDataName &name) {
+    return lfs_->FileExists(MetaPath(name));
+}
+
+int LocalSnapshotDataStore::DeleteChunkData(const ChunkDataName &name) {
+    return DeleteFile(ChunkPath(name));
+}
+
+bool LocalSnapshotDataStore::ChunkDataExist(const ChunkDataName &name) {
+    return lfs_->FileExists(ChunkPath(name));
+}
+
+int LocalSnapshotDataStore::DataChunkTranferInit(const ChunkDataName &name,
+    std::shared_ptr<TransferTask> task) {
+    // 分片直接写入临时文件的对应位置，完成时重命名
+    std::string tmpPath = rootPath_ + SnapshotLocalLayout::kTmpDir +
+        SnapshotLocalLayout::EncodeFileName(name.ToDataChunkKey()) + "." +
+        UUIDGenerator().GenerateUUID();
+    int fd = lfs_->Open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        LOG(ERROR) << "Create transfer file fail, ret = " << fd
+                   << ", chunkDataName = " << name.ToDataChunkKey();
+        return -1;
+    }
+    lfs_->Close(fd);
+    task->uploadId_ = tmpPath;
+    return 0;
+}
+
+int LocalSnapshotDataStore::DataChunkTranferAddPart(const ChunkDataName &name,
+    std::shared_ptr<TransferTask> task,
+    int partNum,
+    int partSize,
+    const char *buf) {
+    int fd = lfs_->Open(task->uploadId_, O_WRONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "Open transfer file fail, ret = " << fd
+                   << ", chunkDataName = " << name.ToDataChunkKey();
+        return -1;
+    }
+    uint64_t offset = static_cast<uint64_t>(partNum) * partSize;
+    int ret = lfs_->Write(fd, buf, offset, partSize);
+    if (ret >= 0) {
+        ret = lfs_->Sync(fd);
+    }
+    lfs_->Close(fd);
+    if (ret < 0) {
+        LOG(ERROR) << "Write transfer part fail, ret = " << ret
+                   << ", chunkDataName = " << name.ToDataChunkKey()
+                   << ", partNum = " << partNum;
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::DataChunkTranferComplete(
+    const ChunkDataName &name,
+    std::shared_ptr<TransferTask> task) {
+    int ret = lfs_->Rename(task->uploadId_, ChunkPath(name));
+    if (ret < 0) {
+        LOG(ERROR) << "Rename transfer file fail, ret = " << ret
+                   << ", chunkDataName = " << name.ToDataChunkKey();
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::DataChunkTranferAbort(const ChunkDataName &name,
+    std::shared_ptr<TransferTask> task) {
+    (void)name;
+    return DeleteFile(task->uploadId_);
+}
+
+int LocalSnapshotDataStore::PutChunkBlockMap(const ChunkDataName &name,
+    const ChunkBlockMap &blockMap) {
+    // 记录数据块在pack文件中的位置，chunkserver克隆时无需索引即可读取。
+    // 数据块列表引用的数据块不会被删除，pack文件也不会移动数据，位置不会失效
+    ChunkBlockMap located = blockMap;
+    {
+        LockGuard guard(packMutex_);
+        for (auto &block : *located.mutable_blocks()) {
+            if (block.hash().empty()) {
+                continue;
+            }
+            std::string key = SnapshotBlockCodec::BlockObjectKey(block);
+            auto it = blockIndex_.find(key);
+            if (it == blockIndex_.end()) {
+                LOG(ERROR) << "Data block of chunk block map not exist"
+                           << ", blockKey = " << key
+                           << ", chunkDataName = " << name.ToDataChunkKey();
+                return -1;
+            }
+            block.set_packid(it->second.packId);
+            block.set_packoffset(it->second.offset);
+            block.set_storelength(it->second.length);
+            block.set_storecrc(it->second.crc);
+        }
+    }
+    std::string data;
+    if (!located.SerializeToString(&data)) {
+        LOG(ERROR) << "Failed to serialize ChunkBlockMap"
+                   << ", chunkDataName = " << name.ToDataChunkKey();
+        return -1;
+    }
+    return WriteFile(ChunkPath(name), data);
+}
+
+int LocalSnapshotDataStore::GetChunkBlockMap(const ChunkDataName &name,
+    ChunkBlockMap *blockMap) {
+    std::string data;
+    if (ReadFile(ChunkPath(name), &data) < 0) {
+        return -1;
+    }
+    if (!blockMap->ParseFromString(data)) {
+        LOG(ERROR) << "Failed to parse ChunkBlockMap"
+                   << ", chunkDataName = " << name.ToDataChunkKey();
+        return -1;
+    }
+    return 0;
+}
+
+int LocalSnapshotDataStore::PutDataBlock(const std::string &key,
+                                         const std::string &data) {
+    std::shared_ptr<SnapshotPackFile> pack;
+    uint64_t offset = 0;
+    {
+        LockGuard guard(packMutex_);
+        if (blockIndex_.find(key) != blockIndex_.end()) {
+            return 0;
+        }
+        if (activePack_->size > 0 &&
+            activePack_->size + data.size() > packFileSize_) {
+            if (OpenNewPack() < 0) {
+                return -1;
+            }
+        }
+        pack = activePack_;
+        offset = pack->size;
+        pack->size += data.size();
+        pack->writing++;
+    }
+
+    // 数据写入不持锁，多个数据块并发写入同一pack文件的不同位置
+    int ret = lfs_->Write(pack->fd, data.data(), offset, data.size());
+    if (ret >= 0) {
+        ret = lfs_->Sync(pack->fd);
+    }
+    if (ret < 0) {
+        LOG(ERROR) << "Write pack file fail, ret = " << ret
+                   << ", packId = " << pack->id
+                   << ", blockKey = " << key;
+    }
+
+    LockGuard guard(packMutex_);
+    pack->writing--;
+    if (ret >= 0) {
+        SnapshotPackEntry entry;
+        entry.packId = pack->id;
+        entry.offset = offset;
+        entry.length = data.size();
+        entry.crc = curve::common::CRC32(data.data(), data.size());
+        std::ostringstream record;
+        record << kPackRecordPut << " " << key << " " << entry.offset
+               << " " << entry.length << " " << entry.crc << "\n";
+        ret = AppendPackIdx(pack, record.str());
+        if (ret >= 0) {
+            blockIndex_.emplace(key, entry);
+            pack->liveCount++;
+        }
+    }
+    TryRemovePack(pack);
+    return ret < 0 ? -1 : 0;
+}
+
+int LocalSnapshotDataStore::DeleteDataBlock(const std::string &key) {
+    LockGuard guard(packMutex_);
+    auto it = blockIndex_.find(key);
+    if (it == blockIndex_.end()) {
+        return 0;
+    }
+    std::shared_ptr<SnapshotPackFile> pack = packs_[it->second.packId];
+    std::string record = std::string(1, kPackRecordDelete) + " " + key + "\n";
+    if (AppendPackIdx(pack, record) < 0) {
+        return -1;
+    }
+    blockIndex_.erase(it);
+    pack->liveCount--;
+    TryRemovePack(pack);
+    return 0;
+}
+
+bool LocalSnapshotDataStore::DataBlockExist(const std::string &key) {
+    LockGuard guard(packMutex_);
+    return blockIndex_.find(key) != blockIndex_.end();
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
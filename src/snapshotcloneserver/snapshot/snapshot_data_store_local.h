@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_DATA_STORE_LOCAL_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_DATA_STORE_LOCAL_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/snapshotclone/snapshot_local_reader.h"
+#include "src/fs/local_filesystem.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
+
+using ::curve::fs::LocalFileSystem;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+// pack文件默认大小
+const uint64_t kDefaultPackFileSize = 4ULL * 1024 * 1024 * 1024;
+
+/**
+ * @brief pack文件，数据块按追加方式写入，
+ *        同名的.idx文件按顺序记录数据块的写入和删除
+ */
+struct SnapshotPackFile {
+    SnapshotPackFile()
+        : id(0),
+          fd(-1),
+          idxFd(-1),
+          size(0),
+          idxSize(0),
+          liveCount(0),
+          writing(0),
+          sealed(false) {}
+
+    uint64_t id;
+    int fd;
+    int idxFd;
+    // 已分配的数据长度，即下一个数据块的写入位置
+    uint64_t size;
+    uint64_t idxSize;
+    // 未删除的数据块数量
+    uint32_t liveCount;
+    // 已分配空间但未写完的数据块数量
+    uint32_t writing;
+    // 不再写入新数据块
+    bool sealed;
+};
+
+/**
+ * @brief 数据块在pack文件中的位置
+ */
+struct SnapshotPackEntry {
+    uint64_t packId;
+    uint64_t offset;
+    uint32_t length;
+    uint32_t crc;
+};
+
+/**
+ * @brief 基于本地文件系统的快照数据存储，根目录可以是挂载的NFS/NAS目录
+ * @detail
+ *  目录结构如下：
+ *  - meta/  快照的chunk索引数据，每个对象一个文件
+ *  - chunk/ CHUNK_DATA_RAW格式的chunk数据或CHUNK_DATA_BLOCK格式的
+ *           数据块列表，每个对象一个文件
+ *  - pack/  数据块，追加写入大的pack文件，避免NAS上产生大量小文件
+ *  - tmp/   转储中的chunk和待重命名的对象
+ *
+ *  对象先写入tmp目录再重命名，读到的对象总是完整的。
+ *  数据块先写入pack文件并落盘，之后才在.idx文件中记录，
+ *  进程重启时重放.idx文件重建内存中的索引，
+ *  未记录的数据只占用空间，pack文件中的数据块全部删除后删除该pack文件。
+ *  快照服务器同一时刻只有leader在工作，不考虑多个进程同时写入。
+ *  数据块列表中记录各数据块在pack文件中的位置，chunkserver挂载同一目录后
+ *  通过SnapshotLocalReader读取快照数据进行克隆/恢复。
+ */
+class LocalSnapshotDataStore : public SnapshotDataStore {
+ public:
+    LocalSnapshotDataStore(std::shared_ptr<LocalFileSystem> lfs,
+                           uint64_t packFileSize = kDefaultPackFileSize)
+        : lfs_(lfs),
+          packFileSize_(packFileSize),
+          nextPackId_(0) {}
+
+    ~LocalSnapshotDataStore();
+
+    /**
+     * @brief 初始化目录结构，清理残留的转储，重放.idx文件加载数据块索引
+     *
+     * @param path 根目录
+     *
+     * @return 0 成功/ -1 失败
+     */
+    int Init(const std::string &path) override;
+    int PutChunkIndexData(const ChunkIndexDataName &name,
+                          const ChunkIndexData &meta) override;
+    int GetChunkIndexData(const ChunkIndexDataName &name,
+                          ChunkIndexData *meta) override;
+    int DeleteChunkIndexData(const ChunkIndexDataName &name) override;
+    bool ChunkIndexDataExist(const ChunkIndexDataName &name) override;
+    int DeleteChunkData(const ChunkDataName &name) override;
+    bool ChunkDataExist(const ChunkDataName &name) override;
+    int DataChunkTranferInit(const ChunkDataName &name,
+                             std::shared_ptr<TransferTask> task) override;
+    int DataChunkTranferAddPart(const ChunkDataName &name,
+                                std::shared_ptr<TransferTask> task,
+                                int partNum,
+                                int partSize,
+                                const char* buf) override;
+    int DataChunkTranferComplete(const ChunkDataName &name,
+                                 std::shared_ptr<TransferTask> task) override;
+    int DataChunkTranferAbort(const ChunkDataName &name,
+                              std::shared_ptr<TransferTask> task) override;
+
+    /**
+     * @brief 写入数据块列表，同时记录各数据块在pack文件中的位置
+     */
+    int PutChunkBlockMap(const ChunkDataName &name,
+                         const ChunkBlockMap &blockMap) override;
+    int GetChunkBlockMap(const ChunkDataName &name,
+                         ChunkBlockMap *blockMap) override;
+    int PutDataBlock(const std::string &key,
+                     const std::string &data) override;
+    int DeleteDataBlock(const std::string &key) override;
+    bool DataBlockExist(const std::string &key) override;
+
+ private:
+    std::string MetaPath(const ChunkIndexDataName &name) const;
+    std::string ChunkPath(const ChunkDataName &name) const;
+    std::string PackPath(uint64_t packId) const;
+    std::string PackIdxPath(uint64_t packId) const;
+
+    int WriteFile(const std::string &path, const std::string &data);
+    int ReadFile(const std::string &path, std::string *data);
+    int DeleteFile(const std::string &path);
+
+    int LoadPacks();
+    int ReplayPackIdx(std::shared_ptr<SnapshotPackFile> pack);
+    // 以下需持有packMutex_调用
+    int OpenNewPack();
+    int AppendPackIdx(std::shared_ptr<SnapshotPackFile> pack,
+                      const std::string &record);
+    void TryRemovePack(std::shared_ptr<SnapshotPackFile> pack);
+    void ClosePack(std::shared_ptr<SnapshotPackFile> pack);
+
+ private:
+    std::shared_ptr<LocalFileSystem> lfs_;
+    std::string rootPath_;
+    uint64_t packFileSize_;
+
+    curve::common::Mutex packMutex_;
+    uint64_t nextPackId_;
+    // 当前写入的pack文件
+    std::shared_ptr<SnapshotPackFile> activePack_;
+    std::map<uint64_t, std::shared_ptr<SnapshotPackFile>> packs_;
+    // 数据块对象名 => 位置
+    std::unordered_map<std::string, SnapshotPackEntry> blockIndex_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_DATA_STORE_LOCAL_H_
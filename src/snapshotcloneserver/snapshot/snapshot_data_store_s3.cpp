@@ -199,6 +199,51 @@ int S3SnapshotDataStore::DataChunkTranferAbort(const ChunkDataName &name,
     const Aws::String uploadId(task->uploadId_.c_str(), task->uploadId_.size());
     return s3Adapter4Data_->AbortMultiUpload(aws_key, uploadId);
 }
+
+int S3SnapshotDataStore::PutChunkBlockMap(const ChunkDataName &name,
+                                          const ChunkBlockMap &blockMap) {
+    std::string key = name.ToDataChunkKey();
+    const Aws::String aws_key(key.c_str(), key.size());
+    std::string data;
+    if (!blockMap.SerializeToString(&data)) {
+        LOG(ERROR) << "Failed to serialize ChunkBlockMap"
+                   << ", chunkDataName = " << key;
+        return -1;
+    }
+    return s3Adapter4Data_->PutObject(aws_key, data);
+}
+
+int S3SnapshotDataStore::GetChunkBlockMap(const ChunkDataName &name,
+                                          ChunkBlockMap *blockMap) {
+    std::string key = name.ToDataChunkKey();
+    const Aws::String aws_key(key.c_str(), key.size());
+    std::string data;
+    if (s3Adapter4Data_->GetObject(aws_key, &data) != 0) {
+        return -1;
+    }
+    if (!blockMap->ParseFromString(data)) {
+        LOG(ERROR) << "Failed to parse ChunkBlockMap"
+                   << ", chunkDataName = " << key;
+        return -1;
+    }
+    return 0;
+}
+
+int S3SnapshotDataStore::PutDataBlock(const std::string &key,
+                                      const std::string &data) {
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Data_->PutObject(aws_key, data);
+}
+
+int S3SnapshotDataStore::DeleteDataBlock(const std::string &key) {
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Data_->DeleteObject(aws_key);
+}
+
+bool S3SnapshotDataStore::DataBlockExist(const std::string &key) {
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Data_->ObjectExist(aws_key);
+}
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -70,6 +70,14 @@ class S3SnapshotDataStore : public SnapshotDataStore {
                                 std::shared_ptr<TransferTask> task) override;
      int DataChunkTranferAbort(const ChunkDataName &name,
                                std::shared_ptr<TransferTask> task) override;
+    int PutChunkBlockMap(const ChunkDataName &name,
+                         const ChunkBlockMap &blockMap) override;
+    int GetChunkBlockMap(const ChunkDataName &name,
+                         ChunkBlockMap *blockMap) override;
+    int PutDataBlock(const std::string &key,
+                     const std::string &data) override;
+    int DeleteDataBlock(const std::string &key) override;
+    bool DataBlockExist(const std::string &key) override;
 
      void SetMetaAdapter(std::shared_ptr<S3Adapter> adapter) {
          s3Adapter4Meta_ = adapter;
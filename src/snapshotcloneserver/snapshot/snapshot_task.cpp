@@ -21,6 +21,7 @@
  */
 
 #include <list>
+#include <vector>
 
 #include "src/common/timeutility.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
@@ -56,6 +57,10 @@ void ReadChunkSnapshotClosure::Run() {
  *  4. 重复2、3直到所有分片转储完成，调用DataChunkTranferComplete结束转储任务
  *  5. 中间如有读取或转储发生错误，则调用DataChunkTranferAbort放弃转储，
  *  并返回错误码
+ *  CHUNK_DATA_BLOCK格式下，每个分片作为一个数据块存储，
+ *  全部完成后存储数据块列表，出错时释放已存储的数据块
+ *  指定流水线时，读取分片前先申请内存预算，读取完成的分片交给流水线
+ *  的上传线程池转储，上传完成后归还内存预算，返回前等待所有上传结束
  *
  * @return 错误码
  */
@@ -67,8 +72,18 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
 
     std::shared_ptr<TransferTask> transferTask =
         std::make_shared<TransferTask>();
-    int ret = dataStore_->DataChunkTranferInit(name,
-            transferTask);
+    int ret = kErrCodeSuccess;
+    if (blockStore_ != nullptr) {
+        blockMap_.Clear();
+        blockMap_.set_blocksize(chunkSplitSize);
+        for (uint64_t i = 0; i < chunkSize / chunkSplitSize; i++) {
+            ChunkBlock *block = blockMap_.add_blocks();
+            block->set_hash("");
+            block->set_compresstype(BLOCK_COMPRESS_NONE);
+        }
+    } else {
+        ret = dataStore_->DataChunkTranferInit(name, transferTask);
+    }
     if (ret < 0) {
         LOG(ERROR) << "DataChunkTranferInit error, "
                    << " ret = " << ret
@@ -79,11 +94,23 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         return ret;
     }
 
+    std::vector<bool> reused;
+    ReuseCleanParts(&reused);
+
     auto tracker = std::make_shared<ReadChunkSnapshotTaskTracker>();
+    auto uploadTracker = std::make_shared<TaskTracker>();
     for (uint64_t i = 0;
         i < chunkSize / chunkSplitSize;
         i++) {
+        if (reused[i]) {
+            continue;
+        }
+        ret = AcquirePartBuffer(tracker, uploadTracker, transferTask);
+        if (ret < 0) {
+            break;
+        }
         auto context = std::make_shared<ReadChunkSnapshotContext>();
+        context->pipeline = pipeline_;
         context->cidInfo = taskInfo_->cidInfo_;
         context->seqNum = taskInfo_->name_.chunkSeqNum_;
         context->partIndex = i;
@@ -102,7 +129,7 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         std::list<ReadChunkSnapshotContextPtr> results =
             tracker->PopResultContexts();
         ret = HandleReadChunkSnapshotResultsAndRetry(
-            tracker, transferTask, results);
+            tracker, uploadTracker, transferTask, results);
         if (ret < 0) {
             break;
         }
@@ -117,29 +144,40 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
                 break;
             }
             ret = HandleReadChunkSnapshotResultsAndRetry(
-                tracker, transferTask, results);
+                tracker, uploadTracker, transferTask, results);
             if (ret < 0) {
                 break;
             }
         } while (true);
-        if (ret >= 0) {
-            ret =
-                dataStore_->DataChunkTranferComplete(name, transferTask);
-            if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferComplete fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
+    }
+    // 异步上传会修改blockMap_，完成或放弃转储前必须等待其结束
+    uploadTracker->Wait();
+    if (ret >= 0) {
+        ret = uploadTracker->GetResult();
+    }
+    if (ret >= 0) {
+        if (blockStore_ != nullptr) {
+            ret = dataStore_->PutChunkBlockMap(name, blockMap_);
+        } else {
+            ret = dataStore_->DataChunkTranferComplete(name,
+                transferTask);
+        }
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferComplete fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo.lpid_
+                       << ", copysetId = " << cidInfo.cpid_
+                       << ", chunkId = " << cidInfo.cid_;
         }
     }
     if (ret < 0) {
-            int ret2 =
-                dataStore_->DataChunkTranferAbort(
-                name,
-                transferTask);
+            int ret2 = 0;
+            if (blockStore_ != nullptr) {
+                ret2 = blockStore_->ReleaseBlocks(blockMap_);
+            } else {
+                ret2 = dataStore_->DataChunkTranferAbort(name, transferTask);
+            }
             if (ret2 < 0) {
                 LOG(ERROR) << "DataChunkTranferAbort fail"
                            << ", ret = " << ret2
@@ -188,6 +226,7 @@ int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
 
 int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+    std::shared_ptr<TaskTracker> uploadTracker,
     std::shared_ptr<TransferTask> transferTask,
     const std::list<ReadChunkSnapshotContextPtr> &results) {
     int ret = kErrCodeSuccess;
@@ -210,13 +249,11 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
                            << ", ret = " << ret;
                 return ret;
             }
+        } else if (pipeline_ != nullptr) {
+            pipeline_->GetMetric()->readBytes << context->len;
+            PushUploadPart(uploadTracker, transferTask, context);
         } else {
-            ret = dataStore_->DataChunkTranferAddPart(
-                taskInfo_->name_,
-                transferTask,
-                context->partIndex,
-                context->len,
-                context->buf.get());
+            ret = TransferPart(transferTask, context);
             if (ret < 0) {
                 LOG(ERROR) << "DataChunkTranferAddPart fail"
                            << ", ret = " << ret
@@ -227,7 +264,118 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
             }
         }
     }
-    return ret;
+    // 已提交的上传失败时不再继续读取
+    return uploadTracker->GetResult();
+}
+
+int TransferSnapshotDataChunkTask::AcquirePartBuffer(
+    std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+    std::shared_ptr<TaskTracker> uploadTracker,
+    std::shared_ptr<TransferTask> transferTask) {
+    if (pipeline_ == nullptr) {
+        return kErrCodeSuccess;
+    }
+    // 等待内存预算期间处理本chunk已读取的分片，
+    // 使其尽快上传并归还预算，避免多个chunk任务互相等待
+    while (!pipeline_->AcquireBuffer(taskInfo_->chunkSplitSize_,
+                                     kAcquireTransferBufferWaitMs)) {
+        std::list<ReadChunkSnapshotContextPtr> results =
+            tracker->PopResultContexts();
+        int ret = HandleReadChunkSnapshotResultsAndRetry(
+            tracker, uploadTracker, transferTask, results);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return kErrCodeSuccess;
+}
+
+void TransferSnapshotDataChunkTask::PushUploadPart(
+    std::shared_ptr<TaskTracker> uploadTracker,
+    std::shared_ptr<TransferTask> transferTask,
+    const ReadChunkSnapshotContextPtr &context) {
+    uploadTracker->AddOneTrace();
+    pipeline_->PushUploadTask(
+        [this, uploadTracker, transferTask, context] () {
+        SnapshotTransferMetric *metric = pipeline_->GetMetric();
+        uint64_t startTime = TimeUtility::GetTimeofDayUs();
+        int ret = TransferPart(transferTask, context);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferAddPart fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = "
+                       << taskInfo_->name_.ToDataChunkKey()
+                       << ", index = " << context->partIndex;
+        } else {
+            metric->uploadBytes << context->len;
+            metric->uploadLatency <<
+                (TimeUtility::GetTimeofDayUs() - startTime);
+        }
+        context->ReleaseBuffer();
+        // 最后通知追踪器，之后本任务可能已被析构
+        uploadTracker->HandleResponse(ret);
+    });
+}
+
+int TransferSnapshotDataChunkTask::TransferPart(
+    std::shared_ptr<TransferTask> transferTask,
+    const ReadChunkSnapshotContextPtr &context) {
+    if (blockStore_ != nullptr) {
+        return blockStore_->PutBlock(context->buf.get(), context->len,
+            blockMap_.mutable_blocks(context->partIndex));
+    }
+    return dataStore_->DataChunkTranferAddPart(
+        taskInfo_->name_,
+        transferTask,
+        context->partIndex,
+        context->len,
+        context->buf.get());
+}
+
+void TransferSnapshotDataChunkTask::ReuseCleanParts(
+    std::vector<bool> *reused) {
+    uint64_t partNum = taskInfo_->chunkSize_ / taskInfo_->chunkSplitSize_;
+    reused->assign(partNum, false);
+    if (blockStore_ == nullptr || taskInfo_->cleanParts_.size() != partNum) {
+        return;
+    }
+    const ChunkDataName &baseName = taskInfo_->baseName_;
+    ChunkBlockMap baseMap;
+    int ret = dataStore_->GetChunkBlockMap(baseName, &baseMap);
+    if (ret < 0 || baseMap.blocksize() != taskInfo_->chunkSplitSize_ ||
+        baseMap.blocks_size() != static_cast<int>(partNum)) {
+        LOG(WARNING) << "Base chunk data can not be reused"
+                     << ", ret = " << ret
+                     << ", baseName = " << baseName.ToDataChunkKey()
+                     << ", chunkDataName = "
+                     << taskInfo_->name_.ToDataChunkKey();
+        return;
+    }
+    std::vector<uint64_t> parts;
+    std::vector<ChunkBlock> blocks;
+    for (uint64_t i = 0; i < partNum; i++) {
+        if (taskInfo_->cleanParts_[i]) {
+            parts.push_back(i);
+            blocks.push_back(baseMap.blocks(i));
+        }
+    }
+    // 引用失败的分片重新读取
+    std::vector<bool> refed;
+    ret = blockStore_->RefBlocks(blocks, &refed);
+    LOG_IF(WARNING, ret < 0) << "Ref base chunk blocks fail"
+                             << ", ret = " << ret
+                             << ", baseName = " << baseName.ToDataChunkKey();
+    uint64_t reusedNum = 0;
+    for (size_t j = 0; j < parts.size(); j++) {
+        if (refed[j]) {
+            *blockMap_.mutable_blocks(parts[j]) = blocks[j];
+            (*reused)[parts[j]] = true;
+            reusedNum++;
+        }
+    }
+    DLOG(INFO) << "Reuse " << reusedNum << " of " << partNum
+               << " parts from " << baseName.ToDataChunkKey()
+               << ", chunkDataName = " << taskInfo_->name_.ToDataChunkKey();
 }
 
 }  // namespace snapshotcloneserver
@@ -26,8 +26,11 @@
 #include <string>
 #include <memory>
 #include <list>
+#include <vector>
 
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_block_store.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/task.h"
 #include "src/snapshotcloneserver/common/task_info.h"
@@ -173,6 +176,9 @@ class SnapshotDeleteTask : public SnapshotTask {
     }
 };
 
+// 申请分片缓冲区内存预算时单次等待的时间(ms)
+const uint32_t kAcquireTransferBufferWaitMs = 100;
+
 struct ReadChunkSnapshotContext {
     // chunkid 信息
     ChunkIDInfo cidInfo;
@@ -190,6 +196,23 @@ struct ReadChunkSnapshotContext {
     uint64_t startTime;
     // 异步请求重试总时间
     uint64_t clientAsyncMethodRetryTimeSec;
+    // 分片缓冲区占用了其内存预算的流水线，为空时未占用
+    std::shared_ptr<SnapshotTransferPipeline> pipeline;
+
+    /**
+     * @brief 释放分片缓冲区并归还内存预算
+     */
+    void ReleaseBuffer() {
+        buf.reset();
+        if (pipeline != nullptr) {
+            pipeline->ReleaseBuffer(len);
+            pipeline = nullptr;
+        }
+    }
+
+    ~ReadChunkSnapshotContext() {
+        ReleaseBuffer();
+    }
 };
 
 using ReadChunkSnapshotContextPtr = std::shared_ptr<ReadChunkSnapshotContext>;
@@ -215,6 +238,10 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
     uint64_t clientAsyncMethodRetryTimeSec_;
     uint64_t clientAsyncMethodRetryIntervalMs_;
     uint32_t readChunkSnapshotConcurrency_;
+    // 增量转储时被复用数据块的更早快照的chunk数据
+    ChunkDataName baseName_;
+    // 下标为分片索引，为true的分片未变化，为空时全量转储
+    std::vector<bool> cleanParts_;
 
     TransferSnapshotDataChunkTaskInfo(const ChunkDataName &name,
         uint64_t chunkSize,
@@ -234,14 +261,24 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
 
 class TransferSnapshotDataChunkTask : public TrackerTask {
  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param blockStore 不为空时按CHUNK_DATA_BLOCK格式转储
+     * @param pipeline 不为空时分片交给流水线异步上传，否则读取后同步上传
+     */
     TransferSnapshotDataChunkTask(const TaskIdType &taskId,
         std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo,
         std::shared_ptr<CurveFsClient> client,
-        std::shared_ptr<SnapshotDataStore> dataStore)
+        std::shared_ptr<SnapshotDataStore> dataStore,
+        std::shared_ptr<SnapshotBlockStore> blockStore = nullptr,
+        std::shared_ptr<SnapshotTransferPipeline> pipeline = nullptr)
         : TrackerTask(taskId),
           taskInfo_(taskInfo),
           client_(client),
-          dataStore_(dataStore) {}
+          dataStore_(dataStore),
+          blockStore_(blockStore),
+          pipeline_(pipeline) {}
 
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> GetTaskInfo() const {
         return taskInfo_;
@@ -277,6 +314,7 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      * @brief 处理ReadChunkSnapshot的结果并重试
      *
      * @param tracker 异步ReadSnapshotChunk追踪器
+     * @param uploadTracker 流水线异步上传追踪器
      * @param transferTask 转储任务
      * @param results ReadChunkSnapshot结果列表
      *
@@ -284,13 +322,63 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      */
     int HandleReadChunkSnapshotResultsAndRetry(
         std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+        std::shared_ptr<TaskTracker> uploadTracker,
         std::shared_ptr<TransferTask> transferTask,
         const std::list<ReadChunkSnapshotContextPtr> &results);
 
+    /**
+     * @brief 从流水线申请一个分片缓冲区的内存预算，
+     *        等待期间把已读取的分片交给上传，归还内存预算
+     *
+     * @param tracker 异步ReadSnapshotChunk追踪器
+     * @param uploadTracker 流水线异步上传追踪器
+     * @param transferTask 转储任务
+     *
+     * @return 错误码
+     */
+    int AcquirePartBuffer(
+        std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+        std::shared_ptr<TaskTracker> uploadTracker,
+        std::shared_ptr<TransferTask> transferTask);
+
+    /**
+     * @brief 把已读取的分片交给流水线异步上传
+     *
+     * @param uploadTracker 流水线异步上传追踪器
+     * @param transferTask 转储任务
+     * @param context ReadChunkSnapshot上下文
+     */
+    void PushUploadPart(std::shared_ptr<TaskTracker> uploadTracker,
+        std::shared_ptr<TransferTask> transferTask,
+        const ReadChunkSnapshotContextPtr &context);
+
+    /**
+     * @brief 转储一个分片
+     *
+     * @param transferTask 转储任务
+     * @param context ReadChunkSnapshot上下文
+     *
+     * @return 错误码
+     */
+    int TransferPart(std::shared_ptr<TransferTask> transferTask,
+        const ReadChunkSnapshotContextPtr &context);
+
+    /**
+     * @brief 增量转储时直接引用更早快照中未变化分片的数据块，
+     *        引用失败的分片仍从curvefs读取
+     *
+     * @param[out] reused 下标为分片索引，为true的分片已复用
+     */
+    void ReuseCleanParts(std::vector<bool> *reused);
+
  protected:
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo_;
     std::shared_ptr<CurveFsClient> client_;
     std::shared_ptr<SnapshotDataStore> dataStore_;
+    std::shared_ptr<SnapshotBlockStore> blockStore_;
+    std::shared_ptr<SnapshotTransferPipeline> pipeline_;
+    // CHUNK_DATA_BLOCK格式下已转储的数据块，下标为分片索引
+    ChunkBlockMap blockMap_;
 };
 
 
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+
+#include <chrono>  // NOLINT
+
+using ::curve::common::UniqueLock;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+int SnapshotTransferPipeline::Start() {
+    return uploadPool_.Start(uploadThreadNum_);
+}
+
+void SnapshotTransferPipeline::Stop() {
+    uploadPool_.Stop();
+}
+
+bool SnapshotTransferPipeline::AcquireBuffer(uint64_t len,
+                                             uint32_t timeoutMs) {
+    UniqueLock lk(bufferMutex_);
+    auto canAcquire = [this, len] () {
+        return bufferUsed_ == 0 || bufferUsed_ + len <= bufferLimit_;
+    };
+    if (!canAcquire()) {
+        metric_.bufferWaiting << 1;
+        bool ok = bufferCond_.wait_for(lk,
+            std::chrono::milliseconds(timeoutMs), canAcquire);
+        metric_.bufferWaiting << -1;
+        if (!ok) {
+            return false;
+        }
+    }
+    bufferUsed_ += len;
+    metric_.bufferUsed << len;
+    return true;
+}
+
+void SnapshotTransferPipeline::ReleaseBuffer(uint64_t len) {
+    {
+        UniqueLock lk(bufferMutex_);
+        bufferUsed_ -= len;
+    }
+    metric_.bufferUsed << -static_cast<int64_t>(len);
+    bufferCond_.notify_all();
+}
+
+void SnapshotTransferPipeline::PushUploadTask(std::function<void()> task) {
+    metric_.uploadQueueing << 1;
+    uploadPool_.Enqueue([this, task] () {
+        metric_.uploadQueueing << -1;
+        task();
+    });
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
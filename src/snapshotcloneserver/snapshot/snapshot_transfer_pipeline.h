@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
+
+#include <functional>
+#include <memory>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/task_thread_pool.h"
+#include "src/snapshotcloneserver/common/snapshotclone_metric.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief 快照数据转储流水线
+ * @detail
+ *  chunk转储任务异步读取分片，读取完成的分片交给上传线程池上传，
+ *  读取和上传互不阻塞，多个chunk的读取和上传同时进行。
+ *  分片缓冲区从全局内存预算中申请，上传完成后归还，
+ *  预算耗尽时读取等待上传归还内存，所有快照的转储共享同一预算。
+ */
+class SnapshotTransferPipeline {
+ public:
+    /**
+     * @brief 构造函数
+     *
+     * @param bufferLimit 分片缓冲区的内存预算(字节)
+     * @param uploadThreadNum 上传线程数
+     */
+    SnapshotTransferPipeline(uint64_t bufferLimit, int uploadThreadNum)
+        : bufferLimit_(bufferLimit),
+          bufferUsed_(0),
+          uploadThreadNum_(uploadThreadNum) {}
+
+    virtual ~SnapshotTransferPipeline() {}
+
+    /**
+     * @brief 启动上传线程池
+     *
+     * @return 错误码
+     */
+    int Start();
+
+    /**
+     * @brief 停止上传线程池
+     */
+    void Stop();
+
+    /**
+     * @brief 申请分片缓冲区的内存预算，
+     *        超过预算的单次申请在预算全部空闲时放行
+     *
+     * @param len 申请的字节数
+     * @param timeoutMs 预算不足时的最长等待时间
+     *
+     * @retval true 申请成功
+     * @retval false 等待超时
+     */
+    bool AcquireBuffer(uint64_t len, uint32_t timeoutMs);
+
+    /**
+     * @brief 归还分片缓冲区的内存预算
+     *
+     * @param len 归还的字节数
+     */
+    void ReleaseBuffer(uint64_t len);
+
+    /**
+     * @brief 提交分片上传任务
+     *
+     * @param task 上传任务
+     */
+    void PushUploadTask(std::function<void()> task);
+
+    SnapshotTransferMetric* GetMetric() {
+        return &metric_;
+    }
+
+ private:
+    // 分片缓冲区的内存预算
+    uint64_t bufferLimit_;
+    // 已申请的分片缓冲区字节数
+    uint64_t bufferUsed_;
+    curve::common::Mutex bufferMutex_;
+    curve::common::ConditionVariable bufferCond_;
+
+    // 上传线程数
+    int uploadThreadNum_;
+    // 上传线程池
+    curve::common::TaskThreadPool<> uploadPool_;
+
+    SnapshotTransferMetric metric_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
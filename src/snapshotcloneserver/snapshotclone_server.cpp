@@ -30,6 +30,8 @@
 #include "src/common/curve_version.h"
 
 using LeaderElectionOptions = ::curve::election::LeaderElectionOptions;
+using ::curve::fs::LocalFsFactory;
+using ::curve::fs::FileSystemType;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -81,6 +83,22 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                                         &serverOption->mdsSessionTimeUs);
     conf->GetValueFatalIfFail("server.readChunkSnapshotConcurrency",
             &serverOption->readChunkSnapshotConcurrency);
+    if (!conf->GetBoolValue("server.snapshotBlockFormatEnable",
+            &serverOption->snapshotBlockFormatEnable)) {
+        serverOption->snapshotBlockFormatEnable = false;
+    }
+    if (!conf->GetStringValue("server.snapshotBlockCompressType",
+            &serverOption->snapshotBlockCompressType)) {
+        serverOption->snapshotBlockCompressType = "snappy";
+    }
+    if (!conf->GetUInt64Value("server.snapshotTransferBufferSize",
+            &serverOption->snapshotTransferBufferSize)) {
+        serverOption->snapshotTransferBufferSize = 1073741824;
+    }
+    if (!conf->GetIntValue("server.snapshotUploadThreadNum",
+            &serverOption->snapshotUploadThreadNum)) {
+        serverOption->snapshotUploadThreadNum = 64;
+    }
 
     conf->GetValueFatalIfFail("server.stage1PoolThreadNum",
                                      &serverOption->stage1PoolThreadNum);
@@ -102,6 +120,18 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                             &serverOption->createCloneChunkConcurrency);
     conf->GetValueFatalIfFail("server.recoverChunkConcurrency",
                             &serverOption->recoverChunkConcurrency);
+    if (!conf->GetUInt64Value("server.recoverChunkSlowPartMs",
+            &serverOption->recoverChunkSlowPartMs)) {
+        serverOption->recoverChunkSlowPartMs = 3000;
+    }
+    if (!conf->GetUInt32Value("server.recoverHotChunkNeighborNum",
+            &serverOption->recoverHotChunkNeighborNum)) {
+        serverOption->recoverHotChunkNeighborNum = 2;
+    }
+    if (!conf->GetUInt32Value("server.cloneChunkBatchSize",
+            &serverOption->cloneChunkBatchSize)) {
+        serverOption->cloneChunkBatchSize = 1;
+    }
     conf->GetValueFatalIfFail("server.backEndReferenceRecordScanIntervalMs",
                         &serverOption->backEndReferenceRecordScanIntervalMs);
     conf->GetValueFatalIfFail("server.backEndReferenceFuncScanIntervalMs",
@@ -151,6 +181,22 @@ void SnapShotCloneServer::InitAllSnapshotCloneOptions(void) {
 
     conf_->GetValueFatalIfFail("s3.config_path",
         &(snapshotCloneServerOptions_.s3ConfPath));
+
+    if (!conf_->GetStringValue("datastore.type",
+            &(snapshotCloneServerOptions_.dataStoreType))) {
+        snapshotCloneServerOptions_.dataStoreType = "s3";
+    }
+    if (snapshotCloneServerOptions_.dataStoreType == "local") {
+        conf_->GetValueFatalIfFail("datastore.local.path",
+            &(snapshotCloneServerOptions_.localDataStorePath));
+        snapshotCloneServerOptions_.serverOption.snapshotDataStoreLocal =
+            true;
+    }
+    if (!conf_->GetUInt64Value("datastore.local.pack_file_size",
+            &(snapshotCloneServerOptions_.localDataStorePackFileSize))) {
+        snapshotCloneServerOptions_.localDataStorePackFileSize =
+            kDefaultPackFileSize;
+    }
 }
 
 void SnapShotCloneServer::StartDummy() {
@@ -249,9 +295,19 @@ bool SnapShotCloneServer::Init() {
         return false;
     }
 
-    dataStore_ = std::make_shared<S3SnapshotDataStore>();
-    if (dataStore_->Init(snapshotCloneServerOptions_.s3ConfPath) < 0) {
-        LOG(ERROR) << "dataStore init fail.";
+    int ret = 0;
+    if (snapshotCloneServerOptions_.dataStoreType == "local") {
+        auto lfs = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        dataStore_ = std::make_shared<LocalSnapshotDataStore>(lfs,
+            snapshotCloneServerOptions_.localDataStorePackFileSize);
+        ret = dataStore_->Init(snapshotCloneServerOptions_.localDataStorePath);
+    } else {
+        dataStore_ = std::make_shared<S3SnapshotDataStore>();
+        ret = dataStore_->Init(snapshotCloneServerOptions_.s3ConfPath);
+    }
+    if (ret < 0) {
+        LOG(ERROR) << "dataStore init fail"
+                   << ", type = " << snapshotCloneServerOptions_.dataStoreType;
         return false;
     }
 
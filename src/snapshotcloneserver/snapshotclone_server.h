@@ -40,6 +40,7 @@
 
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store_s3.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_data_store_local.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task_manager.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
 #include "src/snapshotcloneserver/snapshotclone_service.h"
@@ -79,6 +80,13 @@ struct SnapShotCloneServerOptions {
 
     // s3
     std::string  s3ConfPath;
+
+    // 快照数据存储类型: s3/local
+    std::string dataStoreType;
+    // local类型快照数据存储的根目录，可以是挂载的NFS/NAS目录
+    std::string localDataStorePath;
+    // local类型快照数据存储的pack文件大小
+    uint64_t localDataStorePackFileSize;
 };
 
 class SnapShotCloneServer {
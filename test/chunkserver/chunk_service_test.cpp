@@ -788,6 +788,136 @@ TEST_F(ChunkserverTest, normal_read_write_test) {
                       response.status());
         }
     }
+    /* 批量创建 clone chunk 和批量 recover chunk */
+    {
+        brpc::Channel channel;
+        ASSERT_EQ(0, channel.Init(leader.addr, NULL));
+        ChunkService_Stub stub(&channel);
+        const uint32_t kChunkSize = 16 * 1024 * 1024;
+        const uint64_t kCloneChunkId = 1000;
+        const int kCloneChunkNum = 3;
+        /* 同一 copyset 上的 chunk 一次创建 */
+        {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            ChunkRequest request;
+            ChunkResponse response;
+            request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+            request.set_logicpoolid(logicPoolId);
+            request.set_copysetid(copysetId);
+            request.set_chunkid(kCloneChunkId);
+            for (int i = 0; i < kCloneChunkNum; ++i) {
+                CloneChunkItem *item = request.add_clonechunks();
+                item->set_chunkid(kCloneChunkId + i);
+                item->set_location("test@cs");
+                item->set_sn(sn);
+                item->set_correctedsn(0);
+                item->set_size(kChunkSize);
+            }
+            stub.CreateCloneChunks(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.status());
+            ASSERT_EQ(0, response.existchunks_size());
+        }
+        /* 创建的 chunk 都已存在 */
+        for (int i = 0; i < kCloneChunkNum; ++i) {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            GetChunkInfoRequest request;
+            GetChunkInfoResponse response;
+            request.set_logicpoolid(logicPoolId);
+            request.set_copysetid(copysetId);
+            request.set_chunkid(kCloneChunkId + i);
+            stub.GetChunkInfo(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.status());
+            ASSERT_EQ(1, response.chunksn_size());
+            ASSERT_EQ(sn, response.chunksn(0));
+        }
+        /* chunk 大小和 copyset 配置的不一致 */
+        {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            ChunkRequest request;
+            ChunkResponse response;
+            request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+            request.set_logicpoolid(logicPoolId);
+            request.set_copysetid(copysetId);
+            request.set_chunkid(kCloneChunkId);
+            CloneChunkItem *item = request.add_clonechunks();
+            item->set_chunkid(kCloneChunkId + kCloneChunkNum);
+            item->set_location("test@cs");
+            item->set_sn(sn);
+            item->set_size(kChunkSize / 2);
+            stub.CreateCloneChunks(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST,
+                      response.status());
+        }
+        /* 批量 recover 已存在的 chunk */
+        {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            ChunkRequest request;
+            ChunkResponse response;
+            request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+            request.set_logicpoolid(logicPoolId);
+            request.set_copysetid(copysetId);
+            request.set_chunkid(kCloneChunkId);
+            for (int i = 0; i < kCloneChunkNum; ++i) {
+                CloneChunkItem *item = request.add_clonechunks();
+                item->set_chunkid(kCloneChunkId + i);
+                item->set_offset(0);
+                item->set_size(kOpRequestAlignSize);
+            }
+            stub.RecoverChunks(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.status());
+        }
+        /* 批量 recover 中有不存在的 chunk */
+        {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            ChunkRequest request;
+            ChunkResponse response;
+            request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+            request.set_logicpoolid(logicPoolId);
+            request.set_copysetid(copysetId);
+            request.set_chunkid(kCloneChunkId);
+            for (int i = 0; i <= kCloneChunkNum; ++i) {
+                CloneChunkItem *item = request.add_clonechunks();
+                item->set_chunkid(kCloneChunkId + i);
+                item->set_offset(0);
+                item->set_size(kOpRequestAlignSize);
+            }
+            stub.RecoverChunks(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_NOTEXIST,
+                      response.status());
+        }
+        /* recover 的范围没有对齐 */
+        {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            ChunkRequest request;
+            ChunkResponse response;
+            request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+            request.set_logicpoolid(logicPoolId);
+            request.set_copysetid(copysetId);
+            request.set_chunkid(kCloneChunkId);
+            CloneChunkItem *item = request.add_clonechunks();
+            item->set_chunkid(kCloneChunkId);
+            item->set_offset(1);
+            item->set_size(kOpRequestAlignSize);
+            stub.RecoverChunks(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST,
+                      response.status());
+        }
+    }
 }
 
 }  // namespace chunkserver
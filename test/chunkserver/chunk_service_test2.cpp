@@ -442,6 +442,77 @@ TEST_F(ChunkService2Test, illegial_parameters_test) {
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
                   response.status());
     }
+    /* batch delete copyset 不存在*/
+    {
+        brpc::Controller cntl;
+        cntl.set_timeout_ms(rpcTimeoutMs);
+        DeleteChunksRequest request;
+        DeleteChunksResponse response;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE);
+        request.set_logicpoolid(logicPoolId + 1);
+        request.set_copysetid(copysetId + 1);
+        request.add_chunkid(chunkId);
+        request.add_chunkid(chunkId + 1);
+        request.set_sn(sn);
+        stub.DeleteChunks(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
+                  response.status());
+    }
+    /* batch delete snapshot 没有 correctedSn */
+    {
+        brpc::Controller cntl;
+        cntl.set_timeout_ms(rpcTimeoutMs);
+        DeleteChunksRequest request;
+        DeleteChunksResponse response;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE_SNAP);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        request.add_chunkid(chunkId);
+        stub.DeleteChunks(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST,
+                  response.status());
+    }
+    /* batch create clone chunk copyset 不存在*/
+    {
+        brpc::Controller cntl;
+        cntl.set_timeout_ms(rpcTimeoutMs);
+        ChunkRequest request;
+        ChunkResponse response;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+        request.set_logicpoolid(logicPoolId + 1);
+        request.set_copysetid(copysetId + 1);
+        request.set_chunkid(chunkId);
+        CloneChunkItem *item = request.add_clonechunks();
+        item->set_chunkid(chunkId);
+        item->set_location("test@cs");
+        item->set_sn(sn);
+        item->set_size(16 * 1024 * 1024);
+        stub.CreateCloneChunks(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
+                  response.status());
+    }
+    /* batch recover chunk copyset 不存在*/
+    {
+        brpc::Controller cntl;
+        cntl.set_timeout_ms(rpcTimeoutMs);
+        ChunkRequest request;
+        ChunkResponse response;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+        request.set_logicpoolid(logicPoolId + 1);
+        request.set_copysetid(copysetId + 1);
+        request.set_chunkid(chunkId);
+        CloneChunkItem *item = request.add_clonechunks();
+        item->set_chunkid(chunkId);
+        item->set_offset(0);
+        item->set_size(kOpRequestAlignSize);
+        stub.RecoverChunks(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
+                  response.status());
+    }
     /* get chunk info copyset not exist */
     {
         brpc::Controller cntl;
@@ -742,6 +813,148 @@ TEST_F(ChunkService2Test, overload_test) {
 
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD, response.status());
     }
+
+    // delete chunks
+    {
+        brpc::Controller cntl;
+        DeleteChunksRequest request;
+        DeleteChunksResponse response;
+        ChunkServiceTestClosure done;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        request.add_chunkid(chunkId);
+        chunkService.DeleteChunks(&cntl, &request, &response, &done);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD, response.status());
+    }
+
+    // create clone chunks
+    {
+        brpc::Controller cntl;
+        ChunkRequest request;
+        ChunkResponse response;
+        ChunkServiceTestClosure done;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        request.set_chunkid(chunkId);
+        request.add_clonechunks()->set_chunkid(chunkId);
+        chunkService.CreateCloneChunks(&cntl, &request, &response, &done);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD, response.status());
+    }
+
+    // recover chunks
+    {
+        brpc::Controller cntl;
+        ChunkRequest request;
+        ChunkResponse response;
+        ChunkServiceTestClosure done;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        request.set_chunkid(chunkId);
+        request.add_clonechunks()->set_chunkid(chunkId);
+        chunkService.RecoverChunks(&cntl, &request, &response, &done);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD, response.status());
+    }
+}
+
+TEST_F(ChunkService2Test, batch_overload_test) {
+    // inflight throttle
+    uint64_t maxInflight = 2;
+    std::shared_ptr<InflightThrottle> inflightThrottle
+        = std::make_shared<InflightThrottle>(maxInflight);
+    CHECK(nullptr != inflightThrottle) << "new inflight throttle failed";
+
+    // chunk service
+    CopysetNodeManager &nodeManager = CopysetNodeManager::GetInstance();
+    ChunkServiceOptions chunkServiceOptions;
+    chunkServiceOptions.copysetNodeManager = &nodeManager;
+    chunkServiceOptions.inflightThrottle = inflightThrottle;
+    auto epochMap = std::make_shared<EpochMap>();
+    ChunkServiceImpl chunkService(chunkServiceOptions, epochMap);
+
+    LogicPoolID logicPoolId = 1;
+    CopysetID copysetId = 10000;
+    ChunkID chunkId = 1;
+    uint32_t chunkSize = nodeManager.GetCopysetNodeOptions().maxChunkSize;
+
+    auto createCloneChunks = [&](int chunkNum) {
+        brpc::Controller cntl;
+        ChunkRequest request;
+        ChunkResponse response;
+        ChunkServiceTestClosure done;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        request.set_chunkid(chunkId);
+        for (int i = 0; i < chunkNum; ++i) {
+            CloneChunkItem *item = request.add_clonechunks();
+            item->set_chunkid(chunkId + i);
+            item->set_location("test@cs");
+            item->set_sn(1);
+            item->set_size(chunkSize);
+        }
+        chunkService.CreateCloneChunks(&cntl, &request, &response, &done);
+        return response.status();
+    };
+
+    auto recoverChunks = [&](int chunkNum) {
+        brpc::Controller cntl;
+        ChunkRequest request;
+        ChunkResponse response;
+        ChunkServiceTestClosure done;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        request.set_chunkid(chunkId);
+        for (int i = 0; i < chunkNum; ++i) {
+            CloneChunkItem *item = request.add_clonechunks();
+            item->set_chunkid(chunkId + i);
+            item->set_offset(0);
+            item->set_size(kOpRequestAlignSize);
+        }
+        chunkService.RecoverChunks(&cntl, &request, &response, &done);
+        return response.status();
+    };
+
+    auto deleteChunks = [&](int chunkNum) {
+        brpc::Controller cntl;
+        DeleteChunksRequest request;
+        DeleteChunksResponse response;
+        ChunkServiceTestClosure done;
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE);
+        request.set_logicpoolid(logicPoolId);
+        request.set_copysetid(copysetId);
+        for (int i = 0; i < chunkNum; ++i) {
+            request.add_chunkid(chunkId + i);
+        }
+        chunkService.DeleteChunks(&cntl, &request, &response, &done);
+        return response.status();
+    };
+
+    // 批量请求中每个chunk都计入inflight，chunk数超过上限时直接拒绝
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD,
+              createCloneChunks(maxInflight + 1));
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD,
+              recoverChunks(maxInflight + 1));
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD,
+              deleteChunks(maxInflight + 1));
+
+    // chunk数不超过上限时正常处理
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
+              createCloneChunks(maxInflight));
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
+              recoverChunks(maxInflight));
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST,
+              deleteChunks(maxInflight));
+
+    // 请求返回之后所有计数都已释放
+    inflightThrottle->Increment(maxInflight);
+    ASSERT_FALSE(inflightThrottle->IsOverLoad());
+    inflightThrottle->Increment();
+    ASSERT_TRUE(inflightThrottle->IsOverLoad());
+    inflightThrottle->Decrement(maxInflight + 1);
 }
 
 TEST_F(ChunkService2Test, overload_concurrency_test) {
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/chunkserver/clone_access_tracker.h"
+
+namespace curve {
+namespace chunkserver {
+
+TEST(CloneAccessTrackerTest, RecordAndListTest) {
+    CloneAccessTracker tracker(3, 300);
+    std::vector<ChunkID> chunkIds;
+
+    tracker.List(1, 1, &chunkIds);
+    ASSERT_TRUE(chunkIds.empty());
+
+    tracker.Record(1, 1, 10);
+    tracker.Record(1, 1, 11);
+    tracker.Record(1, 2, 20);
+    // 重复访问的chunk移到最前面
+    tracker.Record(1, 1, 10);
+    tracker.List(1, 1, &chunkIds);
+    ASSERT_EQ(std::vector<ChunkID>({10, 11}), chunkIds);
+
+    // 超过数量限制时淘汰最早访问的chunk
+    tracker.Record(1, 1, 12);
+    tracker.Record(1, 1, 13);
+    chunkIds.clear();
+    tracker.List(1, 1, &chunkIds);
+    ASSERT_EQ(std::vector<ChunkID>({13, 12, 10}), chunkIds);
+
+    tracker.Remove(1, 1, 12);
+    chunkIds.clear();
+    tracker.List(1, 1, &chunkIds);
+    ASSERT_EQ(std::vector<ChunkID>({13, 10}), chunkIds);
+
+    // 不同copyset的记录互不影响
+    chunkIds.clear();
+    tracker.List(1, 2, &chunkIds);
+    ASSERT_EQ(std::vector<ChunkID>({20}), chunkIds);
+}
+
+TEST(CloneAccessTrackerTest, ExpireAndDisableTest) {
+    CloneAccessTracker tracker(3, 1);
+    std::vector<ChunkID> chunkIds;
+    tracker.Record(1, 1, 10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    tracker.List(1, 1, &chunkIds);
+    ASSERT_TRUE(chunkIds.empty());
+
+    // 数量为0时不记录
+    CloneAccessTracker disabled(0, 300);
+    disabled.Record(1, 1, 10);
+    disabled.List(1, 1, &chunkIds);
+    ASSERT_TRUE(chunkIds.empty());
+}
+
+}  // namespace chunkserver
+}  // namespace curve
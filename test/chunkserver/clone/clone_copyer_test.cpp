@@ -23,10 +23,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <glog/logging.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "include/client/libcurve.h"
 #include "src/chunkserver/clone_copyer.h"
 #include "src/chunkserver/clone_core.h"
+#include "src/common/crc32.h"
 #include "test/chunkserver/clone/clone_test_util.h"
 #include "test/client/mock/mock_file_client.h"
 #include "test/common/mock_s3_adapter.h"
@@ -36,6 +39,7 @@ namespace chunkserver {
 
 using curve::client::MockFileClient;
 using curve::common::MockS3Adapter;
+using curve::snapshotcloneserver::SnapshotLocalLayout;
 
 const char CURVE_CONF[] = "client.conf";
 const char S3_CONF[] = "s3.conf";
@@ -364,5 +368,296 @@ TEST_F(CloneCopyerTest, ExpiredTest) {
     ASSERT_EQ(0, copyer.Fini());
 }
 
+TEST_F(CloneCopyerTest, S3BlockTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.s3Conf = S3_CONF;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.curveFileTimeoutSec = EXPIRED_USE;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    // 数据块大小1024，第0块为全零块，第1块为'a'，第2块为'b'
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(1024);
+    auto block = blockMap.add_blocks();
+    block->set_hash("");
+    block->set_compresstype(curve::snapshotcloneserver::BLOCK_COMPRESS_NONE);
+    block = blockMap.add_blocks();
+    block->set_hash("a");
+    block->set_compresstype(curve::snapshotcloneserver::BLOCK_COMPRESS_NONE);
+    block = blockMap.add_blocks();
+    block->set_hash("b");
+    block->set_compresstype(curve::snapshotcloneserver::BLOCK_COMPRESS_NONE);
+    std::string blockMapData;
+    ASSERT_TRUE(blockMap.SerializeToString(&blockMapData));
+
+    auto fillBlock =
+        [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
+            char c = context->key.find("snapblock/a.") == 0 ? 'a' : 'b';
+            memset(context->buf, c, 1024);
+            context->actualLen = 1024;
+            context->retCode = 0;
+            context->cb(s3Client_.get(), context);
+        };
+
+    char* buf = new char[2048];
+    AsyncDownloadContext context;
+    context.location = "test@s3block";
+    context.offset = 512;
+    context.size = 2048;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    /* 用例:读取跨越三个数据块的数据
+     * 预期:全零块不读取对象，其余数据块各读取一次，数据块列表只读取一次
+     */
+    EXPECT_CALL(*s3Client_, GetObject(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(blockMapData),
+                        Return(0)));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(2)
+        .WillRepeatedly(Invoke(fillBlock));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(512, '\0'), std::string(buf, 512));
+    ASSERT_EQ(std::string(1024, 'a'), std::string(buf + 512, 1024));
+    ASSERT_EQ(std::string(512, 'b'), std::string(buf + 1536, 512));
+    closure.Reset();
+
+    /* 用例:数据块读取失败
+     * 预期:使用缓存的数据块列表，返回失败
+     */
+    EXPECT_CALL(*s3Client_, GetObject(_, _))
+        .Times(0);
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(fillBlock))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
+                context->retCode = -1;
+                context->cb(s3Client_.get(), context);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:读取范围超出数据块列表
+     * 预期:返回失败
+     */
+    context.offset = 2048;
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(0);
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:读取数据块列表失败
+     * 预期:返回失败
+     */
+    context.location = "test2@s3block";
+    context.offset = 0;
+    EXPECT_CALL(*s3Client_, GetObject(_, _))
+        .WillOnce(Return(-1));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
+TEST_F(CloneCopyerTest, LocalTest) {
+    const std::string root = "./clone_copyer_local_test";
+    ASSERT_EQ(0, system(("rm -rf " + root).c_str()));
+    ASSERT_EQ(0, system(("mkdir -p " + root + "/chunk " + root + "/pack")
+                        .c_str()));
+    auto writeFile = [] (const std::string& path, const std::string& data) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(data.size(), ::write(fd, data.data(), data.size()));
+        ::close(fd);
+    };
+
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveClient = nullptr;
+    options.s3Client = nullptr;
+    options.curveFileTimeoutSec = EXPIRED_USE;
+    options.localDataStorePath = root;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    // CHUNK_DATA_RAW格式的chunk
+    std::string rawData(4096, 'r');
+    writeFile(SnapshotLocalLayout::ChunkPath(root, "raw"), rawData);
+
+    // 数据块大小1024，第0块为全零块，第1块为'a'，第2块为'b'，
+    // 数据块依次写入pack文件
+    std::string pack = std::string(100, 'x') + std::string(1024, 'a') +
+                       std::string(1024, 'b');
+    writeFile(SnapshotLocalLayout::PackPath(root, 0), pack);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(1024);
+    auto block = blockMap.add_blocks();
+    block->set_hash("");
+    block->set_compresstype(curve::snapshotcloneserver::BLOCK_COMPRESS_NONE);
+    for (int i = 0; i < 2; ++i) {
+        block = blockMap.add_blocks();
+        block->set_hash(i == 0 ? "a" : "b");
+        block->set_compresstype(
+            curve::snapshotcloneserver::BLOCK_COMPRESS_NONE);
+        block->set_packid(0);
+        block->set_packoffset(100 + i * 1024);
+        block->set_storelength(1024);
+        block->set_storecrc(
+            curve::common::CRC32(pack.data() + 100 + i * 1024, 1024));
+    }
+    std::string blockMapData;
+    ASSERT_TRUE(blockMap.SerializeToString(&blockMapData));
+    writeFile(SnapshotLocalLayout::ChunkPath(root, "test"), blockMapData);
+
+    char* buf = new char[4096];
+    AsyncDownloadContext context;
+    context.location = "raw@local";
+    context.offset = 1024;
+    context.size = 2048;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    /* 用例:读取CHUNK_DATA_RAW格式的chunk
+     * 预期:读取成功
+     */
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(2048, 'r'), std::string(buf, 2048));
+    closure.Reset();
+
+    /* 用例:读取超出chunk文件长度
+     * 预期:返回失败
+     */
+    context.size = 4096;
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:读取跨越三个数据块的数据
+     * 预期:全零块填零，其余数据块从pack文件读取
+     */
+    context.location = "test@localblock";
+    context.offset = 512;
+    context.size = 2048;
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(512, '\0'), std::string(buf, 512));
+    ASSERT_EQ(std::string(1024, 'a'), std::string(buf + 512, 1024));
+    ASSERT_EQ(std::string(512, 'b'), std::string(buf + 1536, 512));
+    closure.Reset();
+
+    /* 用例:读取范围超出数据块列表
+     * 预期:返回失败
+     */
+    context.offset = 2048;
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:数据块与记录的crc不一致
+     * 预期:返回失败
+     */
+    blockMap.mutable_blocks(2)->set_storecrc(0);
+    ASSERT_TRUE(blockMap.SerializeToString(&blockMapData));
+    writeFile(SnapshotLocalLayout::ChunkPath(root, "test2"), blockMapData);
+    context.location = "test2@localblock";
+    context.offset = 1024;
+    context.size = 2048;
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:数据块列表不存在
+     * 预期:返回失败
+     */
+    context.location = "test3@localblock";
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    delete [] buf;
+    ASSERT_EQ(0, copyer.Fini());
+    ASSERT_EQ(0, system(("rm -rf " + root).c_str()));
+}
+
+TEST_F(CloneCopyerTest, S3SourceCacheTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.s3Conf = S3_CONF;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.curveFileTimeoutSec = EXPIRED_USE;
+    options.sourceCacheOptions.memoryBytes = 8192;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    char* buf = new char[4096];
+    AsyncDownloadContext context;
+    context.location = "test@s3";
+    context.offset = 0;
+    context.size = 4096;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    /* 用例:读取失败后再次读取相同的数据
+     * 预期:失败的数据不缓存，重新下载
+     */
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
+                context->retCode = -1;
+                context->cb(s3Client_.get(), context);
+            }))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
+                memset(context->buf, 'a', context->len);
+                context->retCode = 0;
+                context->cb(s3Client_.get(), context);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(4096, 'a'), std::string(buf, 4096));
+    closure.Reset();
+
+    /* 用例:其他chunk读取相同的数据
+     * 预期:从缓存中获取，不再下载
+     */
+    memset(buf, 0, 4096);
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(0);
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(4096, 'a'), std::string(buf, 4096));
+    closure.Reset();
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/chunkserver/clone_source_cache.h"
+#include "src/fs/local_filesystem.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::fs::FileSystemType;
+using curve::fs::LocalFsFactory;
+
+const char kCacheDir[] = "./clone_source_cache_test";
+
+class CloneSourceCacheTest : public testing::Test {
+ public:
+    void SetUp() {
+        fs_ = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        fs_->Delete(kCacheDir);
+    }
+
+    void TearDown() {
+        fs_->Delete(kCacheDir);
+    }
+
+    // 返回固定数据的下载函数，记录下载次数
+    CloneSourceCache::FetchFunc MakeFetch(const std::string& value) {
+        return [this, value] (const CloneSourceCache::DoneCallback& fetched) {
+            fetchNum_++;
+            fetched(std::make_shared<std::string>(value));
+        };
+    }
+
+    CloneSourceCache::DoneCallback MakeDone(std::string* result) {
+        return [result] (CloneSourceCache::Data data) {
+            *result = (data == nullptr) ? "failed" : *data;
+        };
+    }
+
+ protected:
+    std::shared_ptr<LocalFileSystem> fs_;
+    int fetchNum_ = 0;
+};
+
+TEST_F(CloneSourceCacheTest, MemoryCacheTest) {
+    CloneSourceCache cache;
+    CloneSourceCacheOptions options;
+    options.memoryBytes = 8;
+    ASSERT_EQ(0, cache.Init(options));
+
+    std::string result;
+    std::string keyA = CloneSourceCache::RangeKey("obj", 0, 4);
+    std::string keyB = CloneSourceCache::RangeKey("obj", 4, 4);
+    std::string keyC = CloneSourceCache::RangeKey("obj", 8, 4);
+    cache.Get(keyA, MakeFetch("aaaa"), MakeDone(&result));
+    ASSERT_EQ("aaaa", result);
+    cache.Get(keyA, MakeFetch("xxxx"), MakeDone(&result));
+    ASSERT_EQ("aaaa", result);
+    ASSERT_EQ(1, fetchNum_);
+
+    // 超过容量时淘汰最久未访问的数据
+    cache.Get(keyB, MakeFetch("bbbb"), MakeDone(&result));
+    cache.Get(keyA, MakeFetch("xxxx"), MakeDone(&result));
+    cache.Get(keyC, MakeFetch("cccc"), MakeDone(&result));
+    ASSERT_EQ(3, fetchNum_);
+    ASSERT_EQ(8, cache.GetMemoryBytes());
+    cache.Get(keyA, MakeFetch("xxxx"), MakeDone(&result));
+    ASSERT_EQ("aaaa", result);
+    cache.Get(keyB, MakeFetch("bbbb"), MakeDone(&result));
+    ASSERT_EQ(4, fetchNum_);
+
+    // 下载失败的数据不缓存
+    std::string keyD = CloneSourceCache::RangeKey("obj", 12, 4);
+    auto failFetch = [this] (const CloneSourceCache::DoneCallback& fetched) {
+        fetchNum_++;
+        fetched(nullptr);
+    };
+    cache.Get(keyD, failFetch, MakeDone(&result));
+    ASSERT_EQ("failed", result);
+    cache.Get(keyD, MakeFetch("dddd"), MakeDone(&result));
+    ASSERT_EQ("dddd", result);
+    ASSERT_EQ(6, fetchNum_);
+}
+
+TEST_F(CloneSourceCacheTest, SingleFlightTest) {
+    CloneSourceCache cache;
+    CloneSourceCacheOptions options;
+    options.memoryBytes = 1024;
+    ASSERT_EQ(0, cache.Init(options));
+
+    // 第一个请求的下载未完成时，相同数据的请求等待其结果
+    CloneSourceCache::DoneCallback pending;
+    auto deferFetch = [&] (const CloneSourceCache::DoneCallback& fetched) {
+        fetchNum_++;
+        pending = fetched;
+    };
+    std::string key = CloneSourceCache::RangeKey("obj", 0, 4);
+    std::vector<std::string> results(3);
+    for (auto& result : results) {
+        cache.Get(key, deferFetch, MakeDone(&result));
+    }
+    ASSERT_EQ(1, fetchNum_);
+    ASSERT_EQ("", results[0]);
+    pending(std::make_shared<std::string>("aaaa"));
+    for (auto& result : results) {
+        ASSERT_EQ("aaaa", result);
+    }
+    ASSERT_EQ(1, cache.GetFetchCount());
+    ASSERT_EQ(2, cache.GetHitCount());
+}
+
+TEST_F(CloneSourceCacheTest, DiskCacheTest) {
+    CloneSourceCacheOptions options;
+    options.memoryBytes = 4;
+    options.diskBytes = 8;
+    options.diskPath = kCacheDir;
+    // 开启本地盘缓存时需要本地文件系统
+    {
+        CloneSourceCache cache;
+        ASSERT_EQ(-1, cache.Init(options));
+    }
+    options.fs = fs_;
+
+    CloneSourceCache cache;
+    ASSERT_EQ(0, cache.Init(options));
+    std::string result;
+    std::string keyA = CloneSourceCache::RangeKey("obj", 0, 4);
+    std::string keyB = CloneSourceCache::RangeKey("obj", 4, 4);
+    std::string keyC = CloneSourceCache::RangeKey("obj", 8, 4);
+    cache.Get(keyA, MakeFetch("aaaa"), MakeDone(&result));
+    cache.Get(keyB, MakeFetch("bbbb"), MakeDone(&result));
+    ASSERT_EQ(8, cache.GetDiskBytes());
+
+    // 内存中已淘汰的数据从本地盘读取
+    cache.Get(keyA, MakeFetch("xxxx"), MakeDone(&result));
+    ASSERT_EQ("aaaa", result);
+    ASSERT_EQ(2, fetchNum_);
+
+    // 本地盘超过容量时淘汰最久未访问的数据并删除文件
+    cache.Get(keyC, MakeFetch("cccc"), MakeDone(&result));
+    ASSERT_EQ(8, cache.GetDiskBytes());
+    std::vector<std::string> names;
+    ASSERT_EQ(0, fs_->List(kCacheDir, &names));
+    ASSERT_EQ(2, names.size());
+    cache.Get(keyB, MakeFetch("bbbb"), MakeDone(&result));
+    ASSERT_EQ(4, fetchNum_);
+
+    // 重新初始化时清空上次的缓存文件
+    CloneSourceCache other;
+    ASSERT_EQ(0, other.Init(options));
+    names.clear();
+    ASSERT_EQ(0, fs_->List(kCacheDir, &names));
+    ASSERT_TRUE(names.empty());
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -319,6 +319,230 @@ TEST_P(OpRequestTest, CreateCloneTest) {
     closure->Release();
 }
 
+TEST_P(OpRequestTest, CreateCloneChunksTest) {
+    // 创建CreateCloneChunksRequest，同一copyset上的3个chunk
+    LogicPoolID logicPoolId = 1;
+    CopysetID copysetId = 10001;
+    uint64_t chunkId = 12345;
+    uint32_t size = chunksize_;
+    uint64_t sn = 1;
+    string location("test@cs");
+    ChunkRequest* request = new ChunkRequest();
+    request->set_logicpoolid(logicPoolId);
+    request->set_copysetid(copysetId);
+    request->set_chunkid(chunkId);
+    request->set_optype(CHUNK_OP_CREATE_CLONE_BATCH);
+    for (uint64_t i = 0; i < 3; ++i) {
+        CloneChunkItem* item = request->add_clonechunks();
+        item->set_chunkid(chunkId + i);
+        item->set_location(location);
+        item->set_sn(sn);
+        item->set_correctedsn(0);
+        item->set_size(size);
+    }
+    brpc::Controller *cntl = new brpc::Controller();
+    ChunkResponse *response = new ChunkResponse();
+    UnitTestClosure *closure = new UnitTestClosure();
+    closure->SetCntl(cntl);
+    closure->SetRequest(request);
+    closure->SetResponse(response);
+    std::shared_ptr<CreateCloneChunksRequest> opReq =
+        std::make_shared<CreateCloneChunksRequest>(node_,
+                                                   cntl,
+                                                   request,
+                                                   response,
+                                                   closure);
+    /**
+     * 测试Encode/Decode
+     */
+    {
+        butil::IOBuf log;
+        ASSERT_EQ(0, opReq->Encode(request, &cntl->request_attachment(), &log));
+
+        butil::IOBuf data;
+        auto req = ChunkOpRequest::Decode(log, request, &data, 0,
+                                          PeerId("127.0.0.1:8200:0"));
+        auto req1 = dynamic_cast<CreateCloneChunksRequest*>(req.get());
+        ASSERT_TRUE(req1 != nullptr);
+
+        ASSERT_EQ(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH,
+                  request->optype());
+        ASSERT_EQ(logicPoolId, request->logicpoolid());
+        ASSERT_EQ(copysetId, request->copysetid());
+        ASSERT_EQ(3, request->clonechunks_size());
+        for (int i = 0; i < request->clonechunks_size(); ++i) {
+            ASSERT_EQ(chunkId + i, request->clonechunks(i).chunkid());
+            ASSERT_EQ(location, request->clonechunks(i).location());
+            ASSERT_EQ(sn, request->clonechunks(i).sn());
+            ASSERT_EQ(size, request->clonechunks(i).size());
+        }
+    }
+    /**
+     * 测试Process
+     * 用例： node_->IsLeaderTerm() == true
+     * 预期： 所有chunk只Propose一条日志，且不会调用closure
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        EXPECT_CALL(*node_, IsLeaderTerm())
+            .WillRepeatedly(Return(true));
+        braft::Task task;
+        EXPECT_CALL(*node_, Propose(_))
+            .WillOnce(SaveArg<0>(&task));
+
+        opReq->Process();
+
+        // 验证结果
+        ASSERT_FALSE(closure->isDone_);
+        ASSERT_FALSE(closure->response_->has_status());
+        // 由于这里node是mock的，因此需要主动来执行task.done.Run来释放资源
+        ASSERT_NE(nullptr, task.done);
+        task.done->Run();
+        ASSERT_TRUE(closure->isDone_);
+    }
+    /**
+     * 测试OnApply
+     * 用例：所有chunk CreateCloneChunk成功
+     * 预期：返回 CHUNK_OP_STATUS_SUCCESS ，并更新apply index
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        for (uint64_t i = 0; i < 3; ++i) {
+            EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + i, sn, 0,
+                                                      size, location))
+                .WillOnce(Return(CSErrorCode::Success));
+        }
+        EXPECT_CALL(*node_, UpdateAppliedIndex(3))
+            .Times(1);
+
+        opReq->OnApply(3, closure);
+
+        // 验证结果
+        ASSERT_TRUE(closure->isDone_);
+        ASSERT_EQ(LAST_INDEX, response->appliedindex());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  closure->response_->status());
+        ASSERT_EQ(0, response->existchunks_size());
+    }
+    /**
+     * 测试OnApply
+     * 用例：其中一个chunk已存在
+     * 预期：返回 CHUNK_OP_STATUS_SUCCESS，已存在的chunk通过existchunks返回
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::Success));
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + 1, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::ChunkConflictError));
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + 2, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::Success));
+        EXPECT_CALL(*node_, UpdateAppliedIndex(3))
+            .Times(1);
+
+        opReq->OnApply(3, closure);
+
+        // 验证结果
+        ASSERT_TRUE(closure->isDone_);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  closure->response_->status());
+        ASSERT_EQ(1, response->existchunks_size());
+        ASSERT_EQ(chunkId + 1, response->existchunks(0));
+    }
+    /**
+     * 测试OnApply
+     * 用例：其中一个chunk创建失败,返回其他错误
+     * 预期：其余chunk仍然创建，返回CHUNK_OP_STATUS_FAILURE_UNKNOWN，
+     *      不更新apply index
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::InvalidArgError));
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + 1, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::Success));
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + 2, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::Success));
+        EXPECT_CALL(*node_, UpdateAppliedIndex(_))
+            .Times(0);
+
+        opReq->OnApply(3, closure);
+
+        // 验证结果
+        ASSERT_TRUE(closure->isDone_);
+        ASSERT_EQ(LAST_INDEX, response->appliedindex());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN,
+                  closure->response_->status());
+    }
+    /**
+     * 测试OnApply
+     * 用例：CreateCloneChunk失败，返回InternalError
+     * 预期：进程退出
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        EXPECT_CALL(*datastore_, CreateCloneChunk(_, _, _, _, _))
+            .WillRepeatedly(Return(CSErrorCode::InternalError));
+        EXPECT_CALL(*node_, UpdateAppliedIndex(_))
+            .Times(0);
+
+        ASSERT_DEATH(opReq->OnApply(3, closure), "");
+    }
+    /**
+     * 测试 OnApplyFromLog
+     * 用例：其中一个chunk已存在
+     * 预期：所有chunk都会调用CreateCloneChunk
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::Success));
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + 1, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::ChunkConflictError));
+        EXPECT_CALL(*datastore_, CreateCloneChunk(chunkId + 2, _, _, _, _))
+            .WillOnce(Return(CSErrorCode::Success));
+
+        butil::IOBuf data;
+        opReq->OnApplyFromLog(datastore_, *request, data);
+    }
+    /**
+     * 测试 OnApplyFromLog
+     * 用例：CreateCloneChunk失败，返回InternalError
+     * 预期：进程退出
+     */
+    {
+        // 重置closure
+        closure->Reset();
+
+        // 设置预期
+        EXPECT_CALL(*datastore_, CreateCloneChunk(_, _, _, _, _))
+            .WillRepeatedly(Return(CSErrorCode::InternalError));
+
+        butil::IOBuf data;
+        ASSERT_DEATH(opReq->OnApplyFromLog(datastore_, *request, data), "");
+    }
+    // 释放资源
+    closure->Release();
+}
+
 TEST_P(OpRequestTest, PasteChunkTest) {
     // 生成临时的readrequest
     ChunkResponse *response = new ChunkResponse();
@@ -25,6 +25,7 @@
 #include <brpc/server.h>
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <cstdio>
 #include <vector>
 #include <string>
@@ -789,6 +790,57 @@ TEST_F(CopysetNodeTest, get_conf_change) {
     }
 }
 
+TEST_F(CopysetNodeTest, apply_barrier) {
+    // 只有涉及多个chunk的批量创建clone chunk需要作为屏障apply
+    ASSERT_TRUE(CopysetNode::IsApplyBarrier(
+        CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH));
+    ASSERT_FALSE(CopysetNode::IsApplyBarrier(CHUNK_OP_TYPE::CHUNK_OP_WRITE));
+    ASSERT_FALSE(CopysetNode::IsApplyBarrier(
+        CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE));
+    ASSERT_FALSE(CopysetNode::IsApplyBarrier(CHUNK_OP_TYPE::CHUNK_OP_PASTE));
+    ASSERT_FALSE(CopysetNode::IsApplyBarrier(CHUNK_OP_TYPE::CHUNK_OP_DELETE));
+
+    LogicPoolID logicPoolID = 1 + 1;
+    CopysetID copysetID = 1 + 1;
+    Configuration conf;
+    PeerId peer("127.0.0.1:3200:0");
+    conf.add_peer(peer);
+    CopysetNode copysetNode(logicPoolID, copysetID, conf);
+    ASSERT_EQ(0, copysetNode.Init(defaultOptions_));
+
+    std::mutex mtx;
+    std::vector<int> applied;
+    auto applyOp = [&](int id, int sleepUs) {
+        ::usleep(sleepUs);
+        std::lock_guard<std::mutex> lk(mtx);
+        applied.push_back(id);
+    };
+
+    // 有2个写线程，chunk 1和chunk 2的op在不同的队列中并发apply，
+    // 普通op之间不保证不同chunk上的apply顺序
+    {
+        copysetNode.PushApplyTask(1, CHUNK_OP_TYPE::CHUNK_OP_WRITE,
+                                  applyOp, 1, 200 * 1000);
+        copysetNode.PushApplyTask(2, CHUNK_OP_TYPE::CHUNK_OP_WRITE,
+                                  applyOp, 2, 0);
+        concurrentModule_.Flush();
+        ASSERT_EQ(std::vector<int>({2, 1}), applied);
+    }
+    // 屏障op等之前的op都apply完再apply，返回时已经apply完
+    {
+        applied.clear();
+        copysetNode.PushApplyTask(1, CHUNK_OP_TYPE::CHUNK_OP_WRITE,
+                                  applyOp, 1, 200 * 1000);
+        copysetNode.PushApplyTask(2, CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH,
+                                  applyOp, 2, 0);
+        ASSERT_EQ(std::vector<int>({1, 2}), applied);
+        copysetNode.PushApplyTask(1, CHUNK_OP_TYPE::CHUNK_OP_WRITE,
+                                  applyOp, 3, 0);
+        concurrentModule_.Flush();
+        ASSERT_EQ(std::vector<int>({1, 2, 3}), applied);
+    }
+}
+
 TEST_F(CopysetNodeTest, get_hash) {
     std::shared_ptr<LocalFileSystem>
         fs(LocalFsFactory::CreateFs(FileSystemType::EXT4, ""));    //NOLINT
@@ -66,6 +66,8 @@ class MockDataStore : public CSDataStore {
                                          off_t,
                                          size_t));
     MOCK_METHOD2(GetChunkInfo, CSErrorCode(ChunkID, CSChunkInfo*));
+    MOCK_METHOD2(GetChunkChangedBlocks,
+                 CSErrorCode(ChunkID, ChangedBlocks*));
     MOCK_METHOD0(GetStatus, DataStoreStatus());
     MOCK_METHOD0(GetChunkMap, ChunkMap());
 };
@@ -208,6 +208,76 @@ TEST(HeartbeatHelperTest, test_ChunkServerLoadCopySetFin) {
     delete copysetNodeManager;
 }
 
+TEST(HeartbeatHelperTest, test_CopySetInfoChanged) {
+    ::curve::mds::heartbeat::CopySetInfo last;
+    last.set_logicalpoolid(1);
+    last.set_copysetid(1);
+    last.set_epoch(2);
+    for (int i = 1; i <= 3; i++) {
+        last.add_peers()->set_address(
+            "192.0.0." + std::to_string(i) + ":8200:0");
+    }
+    last.mutable_leaderpeer()->set_address("192.0.0.1:8200:0");
+    auto stats = last.mutable_stats();
+    stats->set_readrate(1000);
+    stats->set_writerate(1000);
+    stats->set_readiops(100);
+    stats->set_writeiops(0);
+
+    // 1. 完全相同
+    auto cur = last;
+    ASSERT_FALSE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+
+    // 2. epoch、leader、成员变化
+    {
+        cur.set_epoch(3);
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+        cur = last;
+        cur.mutable_leaderpeer()->set_address("192.0.0.2:8200:0");
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+        cur = last;
+        cur.mutable_peers(2)->set_address("192.0.0.4:8200:0");
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+    }
+
+    // 3. 有配置变更时每次都上报
+    {
+        cur = last;
+        auto confChange = cur.mutable_configchangeinfo();
+        confChange->mutable_peer()->set_address("192.0.0.4:8200:0");
+        confChange->set_type(curve::mds::heartbeat::ADD_PEER);
+        confChange->set_finished(false);
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(cur, cur, 20));
+    }
+
+    // 4. scan状态变化
+    {
+        cur = last;
+        cur.set_scaning(true);
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+        cur = last;
+        cur.set_lastscansec(100);
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+    }
+
+    // 5. 统计信息变化未超过阈值不上报, 超过阈值上报
+    {
+        cur = last;
+        cur.mutable_stats()->set_readrate(1100);
+        cur.mutable_stats()->set_readiops(90);
+        ASSERT_FALSE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 0));
+        cur.mutable_stats()->set_writerate(500);
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+        cur = last;
+        cur.mutable_stats()->set_writeiops(1);
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+        cur = last;
+        cur.clear_stats();
+        ASSERT_TRUE(HeartbeatHelper::CopySetInfoChanged(last, cur, 20));
+    }
+}
+
 }  // namespace chunkserver
 }  // namespace curve
 
@@ -45,6 +45,19 @@ TEST(InflightThrottleTest, basic) {
         ASSERT_FALSE(inflightThrottle.IsOverLoad());
     }
 
+    // 批量请求按op个数计数
+    {
+        uint64_t maxInflight = 4;
+        InflightThrottle inflightThrottle(maxInflight);
+        inflightThrottle.Increment(4);
+        ASSERT_FALSE(inflightThrottle.IsOverLoad());
+        inflightThrottle.Increment(2);
+        ASSERT_TRUE(inflightThrottle.IsOverLoad());
+
+        inflightThrottle.Decrement(2);
+        ASSERT_FALSE(inflightThrottle.IsOverLoad());
+    }
+
     // 并发加
     {
         uint64_t maxInflight = 10000;
@@ -31,6 +31,7 @@
 #include <brpc/server.h>
 #include "src/chunkserver/raftsnapshot/curve_snapshot_storage.h"
 #include "src/chunkserver/raftsnapshot/curve_file_service.h"
+#include "src/chunkserver/raftsnapshot/curve_snapshot_file_reader.h"
 
 namespace braft {
 DECLARE_int64(raft_minimal_throttle_threshold_mb);
@@ -950,5 +951,168 @@ TEST_F(CurveSnapshotStorageTest, dynamically_change_throttle_threshold) {
     braft::FLAGS_raft_minimal_throttle_threshold_mb = 0;
 }
 
+
+TEST_F(CurveSnapshotStorageTest, delta_install_existing_file) {
+    scoped_refptr<braft::PosixFileSystemAdaptor> fs(
+                new braft::PosixFileSystemAdaptor());
+    fs->delete_file("data", true);
+    FLAGS_raft_snapshot_checksum_block_size = 4;
+
+    brpc::Server server;
+    ASSERT_EQ(0, server.AddService(&kCurveFileService,
+                                   brpc::SERVER_DOESNT_OWN_SERVICE));
+    ASSERT_EQ(0, server.Start(serverAddr, NULL));
+
+    braft::SnapshotMeta meta;
+    meta.set_last_included_index(1000);
+    meta.set_last_included_term(2);
+
+    // storage1作为leader，快照包含快照目录外的3个文件
+    CurveSnapshotStorage* storage1
+            = new CurveSnapshotStorage("./data/snapshot1/data");
+    ASSERT_EQ(storage1->set_file_system_adaptor(fs), 0);
+    ASSERT_EQ(0, storage1->init());
+    ASSERT_TRUE(fs->create_directory("./data/snapshot1/dir1/", NULL, true));
+    write_file(fs, "./data/snapshot1/dir1/file1", "aaaabbbbccccdddd");
+    write_file(fs, "./data/snapshot1/dir1/file2", "aaaabbbbcc");
+    write_file(fs, "./data/snapshot1/dir1/file3", "aaaabbbb");
+    butil::EndPoint ep;
+    ASSERT_EQ(0, butil::str2endpoint(serverAddr, &ep));
+    storage1->set_server_addr(ep);
+    braft::SnapshotWriter* writer1 = storage1->create();
+    ASSERT_TRUE(writer1 != NULL);
+    for (int i = 1; i <= 3; ++i) {
+        ASSERT_EQ(0, writer1->add_file("../../dir1/file" + std::to_string(i)));
+    }
+    ASSERT_EQ(0, writer1->save_meta(meta));
+    ASSERT_EQ(0, storage1->close(writer1));
+    braft::SnapshotReader* reader1 = storage1->open();
+    ASSERT_TRUE(reader1 != NULL);
+    std::string uri = reader1->generate_uri_for_copy();
+
+    // storage2作为follower，file1大小相同但部分数据块不同，走增量下载；
+    // file2大小不同、file3本地不存在，走全量下载
+    CurveSnapshotStorage* storage2
+            = new CurveSnapshotStorage("./data/snapshot2/data");
+    ASSERT_EQ(storage2->set_file_system_adaptor(fs), 0);
+    ASSERT_EQ(0, storage2->init());
+    ASSERT_TRUE(fs->create_directory("./data/snapshot2/dir1/", NULL, true));
+    write_file(fs, "./data/snapshot2/dir1/file1", "aaaaxxxxccccyyyy");
+    write_file(fs, "./data/snapshot2/dir1/file2", "aaaa");
+    braft::SnapshotCopier* copier = storage2->start_to_copy_from(uri);
+    ASSERT_TRUE(copier != NULL);
+    copier->join();
+    // file1只下载不同的2个数据块，其余数据块从本地复用
+    CurveSnapshotCopier* curveCopier =
+        dynamic_cast<CurveSnapshotCopier*>(copier);
+    ASSERT_TRUE(curveCopier != NULL);
+    ASSERT_EQ(8, curveCopier->delta_reused_bytes());
+    ASSERT_EQ(8, curveCopier->delta_downloaded_bytes());
+    braft::SnapshotReader* reader2 = copier->get_reader();
+    ASSERT_EQ(0, storage2->close(copier));
+    ASSERT_TRUE(reader2 != NULL);
+    std::string path2 = reader2->get_path() + "/dir1";
+    ASSERT_EQ("aaaabbbbccccdddd", read_from_file(fs, path2, 1));
+    ASSERT_EQ("aaaabbbbcc", read_from_file(fs, path2, 2));
+    ASSERT_EQ("aaaabbbb", read_from_file(fs, path2, 3));
+    // 本地原有的文件不受影响
+    ASSERT_EQ("aaaaxxxxccccyyyy",
+              read_from_file(fs, "./data/snapshot2/dir1", 1));
+    ASSERT_EQ(0, storage2->close(reader2));
+
+    // 关闭增量下载时全量下载
+    FLAGS_raft_enable_delta_install_snapshot = false;
+    reader2 = storage2->copy_from(uri);
+    ASSERT_TRUE(reader2 != NULL);
+    path2 = reader2->get_path() + "/dir1";
+    ASSERT_EQ("aaaabbbbccccdddd", read_from_file(fs, path2, 1));
+    ASSERT_EQ(0, storage2->close(reader2));
+    FLAGS_raft_enable_delta_install_snapshot = true;
+
+    ASSERT_EQ(0, storage1->close(reader1));
+    delete storage2;
+    delete storage1;
+    FLAGS_raft_snapshot_checksum_block_size = 128 * 1024;
+}
+
+TEST_F(CurveSnapshotStorageTest, read_checksum_with_throttle) {
+    scoped_refptr<braft::PosixFileSystemAdaptor> fs(
+                new braft::PosixFileSystemAdaptor());
+    fs->delete_file("data", true);
+    FLAGS_raft_snapshot_checksum_block_size = 4;
+    ASSERT_TRUE(fs->create_directory("./data/snapshot", NULL, true));
+    const std::string content("aaaabbbbccccdd");
+    write_file(fs, "./data/snapshot/file1", content);
+
+    // 每个周期只能读6个字节，计算校验和时每个周期最多读一个数据块
+    scoped_refptr<braft::SnapshotThrottle> throttle(
+            new braft::ThroughputSnapshotThrottle(60, 10));
+    scoped_refptr<CurveSnapshotFileReader> reader(
+            new CurveSnapshotFileReader(fs.get(), "./data/snapshot",
+                                        throttle.get()));
+    braft::LocalSnapshotMetaTable meta_table;
+    ASSERT_EQ(0, meta_table.add_file("file1", braft::LocalFileMeta()));
+    reader->set_meta_table(meta_table);
+
+    // 被限流时返回EAGAIN，重试时接着之前的位置计算
+    const std::string name =
+            CurveSnapshotFileReader::checksum_filename("file1");
+    butil::IOBuf buf;
+    size_t read_count = 0;
+    bool is_eof = false;
+    int throttled = 0;
+    int ret = 0;
+    while ((ret = reader->read_file(&buf, name, 0, 1024 * 1024, false,
+                                    &read_count, &is_eof)) == EAGAIN) {
+        ASSERT_LT(++throttled, 100);
+        ::usleep(100 * 1000);
+    }
+    ASSERT_EQ(0, ret);
+    ASSERT_GT(throttled, 0);
+    ASSERT_TRUE(is_eof);
+    ASSERT_EQ(buf.size(), read_count);
+
+    CurveSnapshotPbChecksum checksum;
+    butil::IOBufAsZeroCopyInputStream wrapper(buf);
+    ASSERT_TRUE(checksum.ParseFromZeroCopyStream(&wrapper));
+    ASSERT_EQ(content.size(), checksum.file_size());
+    ASSERT_EQ(4, checksum.block_size());
+    ASSERT_EQ(4, checksum.block_crc_size());
+    ASSERT_EQ(4, checksum.block_sha1_size());
+    for (int i = 0; i < checksum.block_crc_size(); ++i) {
+        butil::IOBuf block;
+        block.append(content.substr(i * 4, 4));
+        ASSERT_EQ(CurveSnapshotFileReader::block_crc(block),
+                  checksum.block_crc(i));
+        ASSERT_EQ(CurveSnapshotFileReader::block_sha1(block),
+                  checksum.block_sha1(i));
+    }
+    ASSERT_NE(checksum.block_sha1(0), checksum.block_sha1(1));
+    FLAGS_raft_snapshot_checksum_block_size = 128 * 1024;
+}
+
+TEST_F(CurveSnapshotStorageTest, range_filename) {
+    std::string name = CurveSnapshotFileReader::range_filename(
+                                        "../../data/chunk_1", 4096, 8192);
+    std::string filename;
+    off_t offset = 0;
+    size_t length = 0;
+    ASSERT_TRUE(CurveSnapshotFileReader::parse_range_filename(
+                                        name, &filename, &offset, &length));
+    ASSERT_EQ("../../data/chunk_1", filename);
+    ASSERT_EQ(4096, offset);
+    ASSERT_EQ(8192, length);
+
+    std::string prefix(BRAFT_SNAPSHOT_RANGE_PREFIX);
+    ASSERT_FALSE(CurveSnapshotFileReader::parse_range_filename(
+                            "../../data/chunk_1", &filename, &offset, &length));
+    ASSERT_FALSE(CurveSnapshotFileReader::parse_range_filename(
+                            prefix + "1/2", &filename, &offset, &length));
+    ASSERT_FALSE(CurveSnapshotFileReader::parse_range_filename(
+                            prefix + "1/2/", &filename, &offset, &length));
+    ASSERT_FALSE(CurveSnapshotFileReader::parse_range_filename(
+                            prefix + "a/2/file", &filename, &offset, &length));
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -1098,6 +1098,54 @@ TEST_F(MDSClientTest, GetOrAllocateSegment) {
     delete faktopologyeret;
 }
 
+TEST_F(MDSClientTest, GetOrAllocateSegments) {
+    curve::client::FInfo_t fi;
+    fi.userinfo = userinfo;
+    fi.chunksize = 4 * 1024 * 1024;
+    fi.segmentsize = 1 * 1024 * 1024 * 1024ul;
+
+    curve::mds::GetOrAllocateSegmentResponse response;
+    response.set_statuscode(::curve::mds::StatusCode::kOK);
+    for (int s = 0; s < 3; s++) {
+        curve::mds::PageFileSegment *pfs =
+            s == 0 ? response.mutable_pagefilesegment()
+                   : response.add_extrasegments();
+        pfs->set_logicalpoolid(1234);
+        pfs->set_segmentsize(fi.segmentsize);
+        pfs->set_chunksize(fi.chunksize);
+        pfs->set_startoffset(s * fi.segmentsize);
+        // the last one has no chunks, and is ignored
+        for (int i = 0; s < 2 && i < 256; i++) {
+            auto chunk = pfs->add_chunks();
+            chunk->set_copysetid(i);
+            chunk->set_chunkid(s * 256 + i);
+        }
+    }
+    FakeReturn *fakeret =
+        new FakeReturn(nullptr, static_cast<void *>(&response));
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(fakeret);
+
+    std::vector<SegmentInfo> segInfos;
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsclient_.GetOrAllocateSegments(true, 0, 3, &fi, nullptr,
+                                               &segInfos));
+    ASSERT_EQ(2, segInfos.size());
+    ASSERT_EQ(0, segInfos[0].startoffset);
+    ASSERT_EQ(fi.segmentsize, segInfos[1].startoffset);
+    ASSERT_EQ(256, segInfos[1].chunkvec.size());
+    ASSERT_EQ(256, segInfos[1].chunkvec[0].cid_);
+
+    // single segment interface only returns the first one
+    SegmentInfo segInfo;
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsclient_.GetOrAllocateSegment(true, 0, &fi, nullptr,
+                                              &segInfo));
+    ASSERT_EQ(0, segInfo.startoffset);
+    ASSERT_EQ(256, segInfo.chunkvec.size());
+
+    delete fakeret;
+}
+
 TEST_F(MDSClientTest, GetServerList) {
     brpc::Server server;
 
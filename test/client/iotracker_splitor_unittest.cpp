@@ -28,7 +28,9 @@
 #include <gtest/gtest.h>
 
 #include <chrono>              //NOLINT
+#include <atomic>
 #include <condition_variable>  //NOLINT
+#include <memory>
 #include <mutex>               // NOLINT
 #include <string>
 #include <thread>              //NOLINT
@@ -572,6 +574,97 @@ TEST_F(IOTrackerSplitorTest, ManagerAsyncStartWrite) {
     ASSERT_EQ('c', writebuffer[aioctx->length - 1]);
 }
 
+TEST_F(IOTrackerSplitorTest, ManagerAsyncStartReadv) {
+    MockRequestScheduler* mockschuler = new MockRequestScheduler;
+    mockschuler->DelegateToFake();
+
+    auto ioctxmana = fileinstance_->GetIOManager4File();
+    ioctxmana->SetRequestScheduler(mockschuler);
+
+    // split user buffer into three segments, the middle one crosses chunk
+    const size_t length = 4 * 1024 * 1024 + 8 * 1024;
+    std::unique_ptr<char[]> buf1(new char[4 * 1024]);
+    std::unique_ptr<char[]> buf2(new char[chunk_size]);
+    std::unique_ptr<char[]> buf3(new char[4 * 1024]);
+    struct iovec iovs[3] = {{buf1.get(), 4 * 1024},
+                            {buf2.get(), chunk_size},
+                            {buf3.get(), 4 * 1024}};
+    CurveIOVector iov;
+    iov.iov = iovs;
+    iov.iovcnt = 3;
+
+    CurveAioContext* aioctx = new CurveAioContext;
+    aioctx->offset = 4 * 1024 * 1024 - 4 * 1024;
+    aioctx->length = length;
+    aioctx->ret = LIBCURVE_ERROR::OK;
+    aioctx->cb = readcallback;
+    aioctx->buf = &iov;
+    aioctx->op = LIBCURVE_OP::LIBCURVE_OP_READ;
+
+    ioreadflag = false;
+    ioctxmana->AioRead(aioctx, mdsclient_.get(), UserDataType::IOVector);
+
+    {
+        std::unique_lock<std::mutex> lk(readmtx);
+        readcv.wait(lk, []()->bool{return ioreadflag;});
+    }
+    ASSERT_EQ('a', buf1[0]);
+    ASSERT_EQ('a', buf1[4 * 1024 - 1]);
+    ASSERT_EQ('b', buf2[0]);
+    ASSERT_EQ('e', buf2[chunk_size - 1]);
+    ASSERT_EQ('f', buf3[0]);
+    ASSERT_EQ('f', buf3[4 * 1024 - 1]);
+}
+
+TEST_F(IOTrackerSplitorTest, ManagerAsyncStartWritev) {
+    MockRequestScheduler* mockschuler = new MockRequestScheduler;
+    mockschuler->DelegateToFake();
+
+    auto ioctxmana = fileinstance_->GetIOManager4File();
+    ioctxmana->SetRequestScheduler(mockschuler);
+
+    const size_t length = 4 * 1024 * 1024 + 8 * 1024;
+    std::unique_ptr<char[]> buf1(new char[4 * 1024]);
+    std::unique_ptr<char[]> buf2(new char[chunk_size]);
+    std::unique_ptr<char[]> buf3(new char[4 * 1024]);
+    memset(buf1.get(), 'a', 4 * 1024);
+    memset(buf2.get(), 'b', chunk_size);
+    memset(buf3.get(), 'c', 4 * 1024);
+    // zero-length segment is skipped
+    struct iovec iovs[4] = {{buf1.get(), 4 * 1024},
+                            {buf2.get(), 0},
+                            {buf2.get(), chunk_size},
+                            {buf3.get(), 4 * 1024}};
+    CurveIOVector iov;
+    iov.iov = iovs;
+    iov.iovcnt = 4;
+
+    CurveAioContext* aioctx = new CurveAioContext;
+    aioctx->offset = 4 * 1024 * 1024 - 4 * 1024;
+    aioctx->length = length;
+    aioctx->ret = LIBCURVE_ERROR::OK;
+    aioctx->cb = writecallback;
+    aioctx->buf = &iov;
+    aioctx->op = LIBCURVE_OP::LIBCURVE_OP_WRITE;
+
+    iowriteflag = false;
+    ioctxmana->AioWrite(aioctx, mdsclient_.get(), UserDataType::IOVector);
+
+    {
+        std::unique_lock<std::mutex> lk(writemtx);
+        writecv.wait(lk, []()->bool{return iowriteflag;});
+    }
+
+    std::string written = writeData.to_string();
+    ASSERT_EQ(length, written.size());
+    ASSERT_EQ('a', written[0]);
+    ASSERT_EQ('a', written[4 * 1024 - 1]);
+    ASSERT_EQ('b', written[4 * 1024]);
+    ASSERT_EQ('b', written[4 * 1024 + chunk_size - 1]);
+    ASSERT_EQ('c', written[4 * 1024 + chunk_size]);
+    ASSERT_EQ('c', written[length - 1]);
+}
+
 /*
 TEST_F(IOTrackerSplitorTest, ManagerAsyncStartWriteReadGetSegmentFail) {
     MockRequestScheduler* mockschuler = new MockRequestScheduler;
@@ -1478,6 +1571,101 @@ TEST_F(IOTrackerSplitorTest, AsyncStartReadNotAllocateSegmentFromOrigin) {
     delete[] data;
 }
 
+// read from clone source through the shared source cache, and replace the
+// cache by SetOption while reads are in flight
+TEST_F(IOTrackerSplitorTest, StartReadFromOriginWithSourceCache) {
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(notallocatefakeret);
+    curvefsservice.SetGetOrAllocateSegmentFakeReturnForClone(
+        getsegmentfakeretclone);
+
+    PrepareOpenFile();
+
+    FileServiceOption cacheOpt = fopt;
+    cacheOpt.ioOpt.sourceCacheOpt.enable = true;
+    cacheOpt.ioOpt.sourceCacheOpt.blockSize = 4 * 1024;
+    cacheOpt.ioOpt.sourceCacheOpt.capacityMB = 16;
+    SourceReader::GetInstance().SetOption(cacheOpt);
+
+    MockRequestScheduler* mockschuler = new MockRequestScheduler;
+    mockschuler->DelegateToFake();
+
+    FileInstance* fileinstance2 = new FileInstance();
+    userinfo.owner = "cloneuser-test3";
+    userinfo.password = "12345";
+    mdsclient_->Initialize(fopt.metaServerOpt);
+    fileinstance2->Initialize("/clonesource", mdsclient_, userinfo, OpenFlags{},
+                              fopt);
+    ASSERT_EQ(LIBCURVE_ERROR::OK, fileinstance2->Open());
+
+    MockRequestScheduler* mockschuler2 = new MockRequestScheduler;
+    mockschuler2->DelegateToFake();
+
+    fileinstance2->GetIOManager4File()->SetRequestScheduler(mockschuler2);
+
+    auto& handlers = SourceReader::GetInstance().GetReadHandlers();
+    handlers.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple("/clonesource"),
+        std::forward_as_tuple(fileinstance2, ::time(nullptr), false));
+
+    curve::client::IOManager4File* iomana = fileinstance_->GetIOManager4File();
+    MetaCache* mc = fileinstance_->GetIOManager4File()->GetMetaCache();
+    ChunkIDInfo chunkIdInfo(1, 1, 257);
+    mc->UpdateChunkInfoByIndex(257, chunkIdInfo);
+
+    FInfo_t fileInfo;
+    fileInfo.chunksize = 4 * 1024 * 1024;
+    fileInfo.fullPathName = "/1_userinfo_.txt";
+    fileInfo.owner = "userinfo";
+    fileInfo.filestatus = FileStatus::CloneMetaInstalled;
+    fileInfo.sourceInfo.name = "/clonesource";
+    fileInfo.sourceInfo.segmentSize = 1ull * 1024 * 1024 * 1024;
+    fileInfo.sourceInfo.length = 10ull * 1024 * 1024 * 1024;
+    for (uint64_t i = 0; i < fileInfo.sourceInfo.length;
+         i += fileInfo.sourceInfo.segmentSize) {
+        fileInfo.sourceInfo.allocatedSegmentOffsets.insert(i);
+    }
+    fileInfo.userinfo = userinfo;
+    mc->UpdateFileInfo(fileInfo);
+
+    iomana->SetRequestScheduler(mockschuler);
+
+    uint64_t offset = 1 * 1024 * 1024 * 1024 + 4 * 1024 * 1024 - 4 * 1024;
+    uint64_t length = 4 * 1024 * 1024 + 8 * 1024;
+
+    // the first read misses the cache, the second one hits
+    for (int i = 0; i < 2; ++i) {
+        std::unique_ptr<char[]> data(new char[length]);
+        int ret = iomana->Read(data.get(), offset, length, mdsclient_.get());
+        ASSERT_EQ(static_cast<int>(length), ret);
+        ASSERT_EQ('a', data[0]);
+        ASSERT_EQ('a', data[4 * 1024 - 1]);
+        ASSERT_EQ('a', data[length - 1]);
+    }
+
+    // FileClient::Init calls SetOption, it must not free the cache which
+    // in-flight reads are using
+    std::atomic<bool> stop(false);
+    std::thread setter([&]() {
+        while (!stop.load()) {
+            SourceReader::GetInstance().SetOption(cacheOpt);
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        std::unique_ptr<char[]> data(new char[length]);
+        int ret = iomana->Read(data.get(), offset, length, mdsclient_.get());
+        ASSERT_EQ(static_cast<int>(length), ret);
+        ASSERT_EQ('a', data[0]);
+        ASSERT_EQ('a', data[length - 1]);
+    }
+    stop.store(true);
+    setter.join();
+
+    SourceReader::GetInstance().SetOption(fopt);
+    fileinstance2->UnInitialize();
+    delete fileinstance2;
+}
+
 TEST_F(IOTrackerSplitorTest, TimedCloseFd) {
     std::unordered_map<std::string, SourceReader::ReadHandler> fakeHandlers;
     fakeHandlers.emplace(
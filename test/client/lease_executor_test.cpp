@@ -28,6 +28,7 @@
 #include "src/client/iomanager4file.h"
 #include "src/client/lease_executor.h"
 #include "src/client/mds_client.h"
+#include "src/client/session_refresher.h"
 #include "test/client/mock/mock_namespace_service.h"
 
 namespace curve {
@@ -52,6 +53,38 @@ static void MockRefreshSession(::google::protobuf::RpcController* controller,
     response->set_sessionid("");
 }
 
+static void MockRefreshSessions(
+    ::google::protobuf::RpcController* controller,
+    const curve::mds::RefreshSessionsRequest* request,
+    curve::mds::RefreshSessionsResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard guard(done);
+
+    response->set_statuscode(curve::mds::StatusCode::kOK);
+    for (const auto& session : request->sessions()) {
+        auto* resp = response->add_sessions();
+        // the second file is deleted
+        if (session.filename() == "/file2") {
+            resp->set_statuscode(curve::mds::StatusCode::kFileNotExists);
+        } else {
+            resp->set_statuscode(curve::mds::StatusCode::kOK);
+            resp->mutable_fileinfo()->set_filestatus(
+                curve::mds::FileStatus::kFileCreated);
+        }
+        resp->set_sessionid(session.sessionid());
+    }
+}
+
+static void MockRefreshSessionsNotSupport(
+    ::google::protobuf::RpcController* controller,
+    const curve::mds::RefreshSessionsRequest* request,
+    curve::mds::RefreshSessionsResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard guard(done);
+    static_cast<brpc::Controller*>(controller)->SetFailed(
+        brpc::ENOMETHOD, "not support");
+}
+
 class LeaseExecutorTest : public ::testing::Test {
  protected:
     void SetUp() override {
@@ -177,5 +210,80 @@ TEST_F(LeaseExecutorTest, TestNoStop) {
     // ASSERT_NO_FATAL_FAILURE(exec.Stop());
 }
 
+TEST_F(LeaseExecutorTest, TestBatchRefresh) {
+    PrepareMockService();
+
+    curve::mds::RefreshSessionsRequest request;
+    EXPECT_CALL(curveFsService_, RefreshSession(_, _, _, _)).Times(0);
+    EXPECT_CALL(curveFsService_, RefreshSessions(_, _, _, _))
+        .Times(2)
+        .WillRepeatedly(
+            DoAll(SaveArgPointee<1>(&request), Invoke(MockRefreshSessions)));
+
+    // two files per rpc
+    SessionRefresher refresher(&mdsClient_, 2);
+
+    // refresh manually
+    leaseOpt_.mdsRefreshTimesPerLease = 1;
+    lease_.leaseTime = 1000000000;
+    fi_.filestatus = FileStatus::Created;
+
+    std::vector<std::unique_ptr<LeaseExecutor>> execs;
+    for (int i = 1; i <= 3; ++i) {
+        fi_.fullPathName = "/file" + std::to_string(i);
+        execs.emplace_back(
+            new LeaseExecutor(leaseOpt_, userInfo_, &mdsClient_, &io4File_));
+        execs.back()->SetSessionRefresher(&refresher);
+        ASSERT_TRUE(execs.back()->Start(fi_, lease_));
+    }
+    ASSERT_EQ(3, refresher.ExecutorNum());
+
+    ASSERT_TRUE(refresher.RefreshLease());
+    ASSERT_EQ(1, request.sessions_size());
+
+    // file not exist, no longer refresh
+    ASSERT_FALSE(execs[1]->LeaseValid());
+    ASSERT_TRUE(execs[0]->LeaseValid());
+    ASSERT_TRUE(execs[2]->LeaseValid());
+    ASSERT_EQ(2, refresher.ExecutorNum());
+
+    execs[0]->Stop();
+    ASSERT_EQ(1, refresher.ExecutorNum());
+    execs.clear();
+    ASSERT_EQ(0, refresher.ExecutorNum());
+}
+
+TEST_F(LeaseExecutorTest, TestBatchRefreshNotSupport) {
+    PrepareMockService();
+
+    EXPECT_CALL(curveFsService_, RefreshSession(_, _, _, _))
+        .Times(4)
+        .WillRepeatedly(DoAll(SetArgPointee<2>(response_),
+                              Invoke(MockRefreshSession)));
+    EXPECT_CALL(curveFsService_, RefreshSessions(_, _, _, _))
+        .Times(1)
+        .WillOnce(Invoke(MockRefreshSessionsNotSupport));
+
+    SessionRefresher refresher(&mdsClient_, 16);
+
+    leaseOpt_.mdsRefreshTimesPerLease = 1;
+    lease_.leaseTime = 1000000000;
+    fi_.filestatus = FileStatus::Created;
+
+    std::vector<std::unique_ptr<LeaseExecutor>> execs;
+    for (int i = 1; i <= 2; ++i) {
+        fi_.fullPathName = "/notsupport" + std::to_string(i);
+        execs.emplace_back(
+            new LeaseExecutor(leaseOpt_, userInfo_, &mdsClient_, &io4File_));
+        execs.back()->SetSessionRefresher(&refresher);
+        ASSERT_TRUE(execs.back()->Start(fi_, lease_));
+    }
+
+    // fall back to refresh each file, and don't try batch rpc again
+    ASSERT_TRUE(refresher.RefreshLease());
+    ASSERT_TRUE(refresher.RefreshLease());
+    ASSERT_EQ(2, refresher.ExecutorNum());
+}
+
 }  // namespace client
 }  // namespace curve
@@ -59,6 +59,12 @@ class MockNameService : public CurveFSService {
                       curve::mds::ReFreshSessionResponse* response,
                       ::google::protobuf::Closure* done));
 
+    MOCK_METHOD4(RefreshSessions,
+                 void(::google::protobuf::RpcController* controller,
+                      const curve::mds::RefreshSessionsRequest* request,
+                      curve::mds::RefreshSessionsResponse* response,
+                      ::google::protobuf::Closure* done));
+
     MOCK_METHOD4(IncreaseFileEpoch,
                  void(::google::protobuf::RpcController* controller,
                       const curve::mds::IncreaseFileEpochRequest* request,
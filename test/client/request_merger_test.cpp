@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * File Created: 2022-10-11
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/client/client_metric.h"
+#include "src/client/request_merger.h"
+#include "src/common/concurrent/count_down_event.h"
+#include "test/client/mock/mock_request_context.h"
+
+namespace curve {
+namespace client {
+
+using curve::common::CountDownEvent;
+
+class RequestMergerTest : public ::testing::Test {
+ protected:
+    void TearDown() override {
+        for (auto* req : requests_) {
+            delete req->done_;
+            delete req;
+        }
+        requests_.clear();
+    }
+
+    RequestContext* NewRequest(OpType type, off_t offset, size_t length,
+                               CountDownEvent* cond = nullptr,
+                               ChunkID chunkId = 1) {
+        RequestContext* req = new RequestContext();
+        req->optype_ = type;
+        req->idinfo_ = ChunkIDInfo(chunkId, 1, 1);
+        req->offset_ = offset;
+        req->rawlength_ = length;
+        req->done_ = new FakeRequestClosure(cond, req);
+        if (type == OpType::WRITE) {
+            req->writeData_.append(std::string(length, 'a' + offset / 4096));
+        }
+        requests_.push_back(req);
+        return req;
+    }
+
+    std::vector<RequestContext*> requests_;
+    RequestMergeOption opt_;
+};
+
+TEST_F(RequestMergerTest, CanMergeTest) {
+    opt_.maxMergeBytes = 16 * 1024;
+    opt_.maxMergeRequests = 4;
+
+    auto* w1 = NewRequest(OpType::WRITE, 0, 4096);
+    auto* w2 = NewRequest(OpType::WRITE, 4096, 4096);
+    auto* w3 = NewRequest(OpType::WRITE, 16384, 4096);
+    auto* r1 = NewRequest(OpType::READ, 4096, 4096);
+    auto* w4 = NewRequest(OpType::WRITE, 4096, 4096, nullptr, 2);
+
+    ASSERT_TRUE(RequestMerger::CanMerge(w1, w2, 4096, 1, opt_));
+    // not contiguous
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, w3, 4096, 1, opt_));
+    // different op type
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, r1, 4096, 1, opt_));
+    // different chunk
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, w4, 4096, 1, opt_));
+    // exceed size or count limit
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, w2, 16 * 1024, 1, opt_));
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, w2, 4096, 4, opt_));
+
+    // request reads from clone source can't be merged
+    w2->sourceInfo_ = RequestSourceInfo("/clonesource", 0);
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, w2, 4096, 1, opt_));
+    w2->sourceInfo_ = RequestSourceInfo();
+
+    // retried request can't be merged
+    w2->done_->IncremRetriedTimes();
+    ASSERT_FALSE(RequestMerger::CanMerge(w1, w2, 4096, 1, opt_));
+}
+
+TEST_F(RequestMergerTest, MergeWriteTest) {
+    CountDownEvent cond(3);
+    std::vector<RequestContext*> subs{
+        NewRequest(OpType::WRITE, 0, 4096, &cond),
+        NewRequest(OpType::WRITE, 4096, 4096, &cond),
+        NewRequest(OpType::WRITE, 8192, 4096, &cond)};
+    FileMetric metric("request_merger_test");
+    subs.front()->done_->SetFileMetric(&metric);
+
+    RequestContext* merged = RequestMerger::Merge(subs);
+    ASSERT_NE(nullptr, merged);
+    ASSERT_TRUE(RequestMerger::IsMergedRequest(merged));
+    ASSERT_FALSE(RequestMerger::IsMergeable(merged));
+    ASSERT_EQ(0, merged->offset_);
+    ASSERT_EQ(3 * 4096, merged->rawlength_);
+    ASSERT_EQ(3 * 4096, merged->writeData_.size());
+    ASSERT_EQ(std::string(4096, 'a') + std::string(4096, 'b') +
+                  std::string(4096, 'c'),
+              merged->writeData_.to_string());
+    // 3 requests are sent as 1, 2 of them are merged away
+    ASSERT_EQ(2, metric.mergedRequestQPS.count.get_value());
+
+    merged->done_->SetFailed(0);
+    merged->done_->Run();
+    cond.Wait();
+
+    for (auto* sub : subs) {
+        ASSERT_EQ(0, sub->done_->GetErrorCode());
+    }
+}
+
+TEST_F(RequestMergerTest, MergeReadTest) {
+    // success, read data is dispatched to each sub-request
+    {
+        CountDownEvent cond(2);
+        std::vector<RequestContext*> subs{
+            NewRequest(OpType::READ, 0, 4096, &cond),
+            NewRequest(OpType::READ, 4096, 8192, &cond)};
+
+        RequestContext* merged = RequestMerger::Merge(subs);
+        ASSERT_NE(nullptr, merged);
+        ASSERT_EQ(3 * 4096, merged->rawlength_);
+
+        merged->readData_.append(std::string(4096, 'x'));
+        merged->readData_.append(std::string(8192, 'y'));
+        merged->done_->SetFailed(0);
+        merged->done_->Run();
+        cond.Wait();
+
+        ASSERT_EQ(std::string(4096, 'x'), subs[0]->readData_.to_string());
+        ASSERT_EQ(std::string(8192, 'y'), subs[1]->readData_.to_string());
+    }
+
+    // failure, error code is dispatched to each sub-request
+    {
+        CountDownEvent cond(2);
+        std::vector<RequestContext*> subs{
+            NewRequest(OpType::READ, 0, 4096, &cond),
+            NewRequest(OpType::READ, 4096, 4096, &cond)};
+
+        RequestContext* merged = RequestMerger::Merge(subs);
+        ASSERT_NE(nullptr, merged);
+
+        merged->done_->SetFailed(-1);
+        merged->done_->Run();
+        cond.Wait();
+
+        for (auto* sub : subs) {
+            ASSERT_EQ(-1, sub->done_->GetErrorCode());
+            ASSERT_EQ(0, sub->readData_.size());
+        }
+    }
+}
+
+TEST_F(RequestMergerTest, MergeSingleRequestTest) {
+    std::vector<RequestContext*> subs{NewRequest(OpType::WRITE, 0, 4096)};
+    ASSERT_EQ(nullptr, RequestMerger::Merge(subs));
+}
+
+}  // namespace client
+}  // namespace curve
@@ -25,9 +25,12 @@
 #include <gmock/gmock.h>
 #include <brpc/channel.h>
 #include <butil/iobuf.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "src/client/request_scheduler.h"
 #include "src/client/client_common.h"
+#include "src/client/io_tracker.h"
 #include "test/client/mock/mock_meta_cache.h"
 #include "test/client/mock/mock_chunkservice.h"
 #include "test/client/mock/mock_request_context.h"
@@ -599,5 +602,106 @@ TEST(RequestSchedulerTest, CommonTest) {
     ASSERT_EQ(0, sche.Fini());
 }
 
+TEST(RequestSchedulerTest, MultiQueueTest) {
+    RequestScheduleOption opt;
+    opt.scheduleQueueCapacity = 4096;
+    opt.scheduleThreadpoolSize = 1;
+    opt.ioSenderOpt.failRequestOpt.chunkserverRPCTimeoutMS = 200;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry = 5;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPRetryIntervalUS = 5000;
+
+    RequestScheduler sche;
+    MetaCache metaCache;
+    FileMetric fm("multi_queue_test");
+
+    // scheduleQueueNum 设置为 0
+    opt.scheduleQueueNum = 0;
+    ASSERT_EQ(-1, sche.Init(opt, &metaCache, &fm));
+
+    opt.scheduleQueueNum = 4;
+    ASSERT_EQ(0, sche.Init(opt, &metaCache, &fm));
+
+    // user io is dispatched by chunk index
+    RequestContext req;
+    req.optype_ = OpType::WRITE;
+    req.idinfo_ = ChunkIDInfo(100, 1, 1);
+    for (ChunkIndex idx = 0; idx < 8; ++idx) {
+        req.chunkIndex_ = idx;
+        ASSERT_EQ(idx % 4, sche.GetQueueIndex(&req));
+    }
+
+    // other requests are dispatched by chunk id
+    req.optype_ = OpType::GET_CHUNK_INFO;
+    ASSERT_EQ(100 % 4, sche.GetQueueIndex(&req));
+
+    ASSERT_EQ(0, sche.Run());
+    ASSERT_EQ(0, sche.Fini());
+}
+
+TEST(RequestSchedulerTest, DispatchByCPUTest) {
+    RequestScheduleOption opt;
+    opt.scheduleQueueCapacity = 4096;
+    opt.scheduleThreadpoolSize = 1;
+    opt.scheduleQueueNum = 2;
+    opt.dispatchByCPU = true;
+    opt.cpuAffinity = {0};
+    opt.ioSenderOpt.failRequestOpt.chunkserverRPCTimeoutMS = 200;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry = 5;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPRetryIntervalUS = 5000;
+
+    RequestScheduler sche;
+    MetaCache metaCache;
+    FileMetric fm("dispatch_by_cpu_test");
+    ASSERT_EQ(0, sche.Init(opt, &metaCache, &fm));
+
+    // user io is dispatched by the cpu of its submitting thread
+    RequestContext req;
+    req.optype_ = OpType::READ;
+    req.idinfo_ = ChunkIDInfo(101, 1, 1);
+    for (ChunkIndex idx = 0; idx < 4; ++idx) {
+        req.chunkIndex_ = idx;
+        req.submitCPU_ = 0;
+        ASSERT_EQ(0, sche.GetQueueIndex(&req));
+        req.submitCPU_ = 3;
+        ASSERT_EQ(1, sche.GetQueueIndex(&req));
+    }
+
+    // fallback to chunk index if the submitting cpu is unknown
+    req.submitCPU_ = -1;
+    req.chunkIndex_ = 2;
+    ASSERT_EQ(0, sche.GetQueueIndex(&req));
+    req.chunkIndex_ = 3;
+    ASSERT_EQ(1, sche.GetQueueIndex(&req));
+
+    // other requests are still dispatched by chunk id
+    req.submitCPU_ = 0;
+    req.optype_ = OpType::GET_CHUNK_INFO;
+    ASSERT_EQ(1, sche.GetQueueIndex(&req));
+
+    ASSERT_EQ(0, sche.Run());
+    ASSERT_EQ(0, sche.Fini());
+}
+
+TEST(RequestSchedulerTest, TrackerCaptureSubmitCPUTest) {
+    cpu_set_t origin;
+    CPU_ZERO(&origin);
+    ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(origin),
+                                        &origin));
+
+    // the tracker is created in the caller's thread and records its cpu
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(0, &cpuset);
+    ASSERT_EQ(0, pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+                                        &cpuset));
+    IOTracker tracker(nullptr, nullptr, nullptr, nullptr);
+    int cpu = tracker.GetSubmitCPU();
+
+    // restore affinity before asserting, following tests run on this thread
+    ASSERT_EQ(0, pthread_setaffinity_np(pthread_self(), sizeof(origin),
+                                        &origin));
+    ASSERT_EQ(0, cpu);
+}
+
 }   // namespace client
 }   // namespace curve
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * Project: curve
+ * File Created: 2022-10-12
+ * Author: curve
+ */
+
+#include <bvar/bvar.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/client/source_cache.h"
+
+namespace curve {
+namespace client {
+
+const uint64_t kFileId = 1;
+
+TEST(SourceCacheTest, LookupAndFetchTest) {
+    SourceCacheOption opt;
+    opt.enable = true;
+    opt.blockSize = 4096;
+    opt.capacityMB = 1;
+    SourceCache cache(opt);
+
+    const std::string fileName = "/source";
+    butil::IOBuf data;
+
+    // first lookup should fetch
+    ASSERT_EQ(SourceCache::LookupResult::kFetch,
+              cache.Lookup(fileName, kFileId, 0, &data, nullptr));
+
+    // following lookups wait for the fetcher
+    int waitCount = 0;
+    butil::IOBuf waitData;
+    ASSERT_EQ(SourceCache::LookupResult::kWait,
+              cache.Lookup(fileName, kFileId, 0, &data,
+                           [&](bool ok, const butil::IOBuf& block) {
+                               ASSERT_TRUE(ok);
+                               waitData = block;
+                               ++waitCount;
+                           }));
+    // lookup without waiter doesn't register
+    ASSERT_EQ(SourceCache::LookupResult::kWait,
+              cache.Lookup(fileName, kFileId, 0, nullptr, nullptr));
+
+    butil::IOBuf block;
+    block.append(std::string(4096, 'a'));
+    cache.OnFetched(fileName, kFileId, 0, true, block);
+    ASSERT_EQ(1, waitCount);
+    ASSERT_EQ(std::string(4096, 'a'), waitData.to_string());
+
+    // block is cached now
+    ASSERT_EQ(SourceCache::LookupResult::kHit,
+              cache.Lookup(fileName, kFileId, 0, &data, nullptr));
+    ASSERT_EQ(std::string(4096, 'a'), data.to_string());
+
+    // same block index of another file is not cached
+    ASSERT_EQ(SourceCache::LookupResult::kFetch,
+              cache.Lookup("/source2", kFileId, 0, &data, nullptr));
+
+    // source recreated with the same name doesn't hit blocks of the old file
+    ASSERT_EQ(SourceCache::LookupResult::kFetch,
+              cache.Lookup(fileName, kFileId + 1, 0, &data, nullptr));
+}
+
+TEST(SourceCacheTest, FetchFailedTest) {
+    SourceCacheOption opt;
+    opt.enable = true;
+    opt.blockSize = 4096;
+    opt.capacityMB = 1;
+    SourceCache cache(opt);
+
+    const std::string fileName = "/source";
+    ASSERT_EQ(SourceCache::LookupResult::kFetch,
+              cache.Lookup(fileName, kFileId, 1, nullptr, nullptr));
+
+    bool waitOk = true;
+    ASSERT_EQ(SourceCache::LookupResult::kWait,
+              cache.Lookup(fileName, kFileId, 1, nullptr,
+                           [&](bool ok, const butil::IOBuf&) {
+                               waitOk = ok;
+                           }));
+
+    cache.OnFetched(fileName, kFileId, 1, false, butil::IOBuf());
+    ASSERT_FALSE(waitOk);
+
+    // failed block is not cached, next lookup fetches again
+    ASSERT_EQ(SourceCache::LookupResult::kFetch,
+              cache.Lookup(fileName, kFileId, 1, nullptr, nullptr));
+}
+
+TEST(SourceCacheTest, EvictTest) {
+    SourceCacheOption opt;
+    opt.enable = true;
+    opt.blockSize = 512 * 1024;
+    opt.capacityMB = 1;
+    SourceCache cache(opt);
+
+    const std::string fileName = "/source";
+    butil::IOBuf block;
+    block.append(std::string(opt.blockSize, 'a'));
+
+    for (uint64_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(SourceCache::LookupResult::kFetch,
+                  cache.Lookup(fileName, kFileId, i, nullptr, nullptr));
+        cache.OnFetched(fileName, kFileId, i, true, block);
+    }
+
+    // only two blocks fit in the cache, the oldest one is evicted
+    ASSERT_EQ(SourceCache::LookupResult::kFetch,
+              cache.Lookup(fileName, kFileId, 0, nullptr, nullptr));
+    ASSERT_EQ(SourceCache::LookupResult::kHit,
+              cache.Lookup(fileName, kFileId, 2, nullptr, nullptr));
+}
+
+TEST(SourceCacheTest, MetricNameTest) {
+    SourceCacheOption opt;
+    opt.enable = true;
+    opt.blockSize = 4096;
+    opt.capacityMB = 1;
+    SourceCache cache(opt);
+
+    // a new cache replacing an in-use one exposes its own metrics
+    size_t exposed = bvar::Variable::count_exposed();
+    SourceCache cache2(opt);
+    ASSERT_EQ(exposed + 4, bvar::Variable::count_exposed());
+}
+
+}  // namespace client
+}  // namespace curve
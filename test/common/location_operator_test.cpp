@@ -33,6 +33,15 @@ TEST(LocationOperatorTest, GenerateTest) {
     std::string location = LocationOperator::GenerateS3Location("test");
     ASSERT_STREQ("test@s3", location.c_str());
 
+    location = LocationOperator::GenerateS3BlockLocation("test");
+    ASSERT_STREQ("test@s3block", location.c_str());
+
+    location = LocationOperator::GenerateLocalLocation("test");
+    ASSERT_STREQ("test@local", location.c_str());
+
+    location = LocationOperator::GenerateLocalBlockLocation("test");
+    ASSERT_STREQ("test@localblock", location.c_str());
+
     location = LocationOperator::GenerateCurveLocation("test", 0);
     ASSERT_STREQ("test:0@cs", location.c_str());
 }
@@ -58,6 +67,21 @@ TEST(LocationOperatorTest, GenerateCurveLocationTest) {
               LocationOperator::ParseLocation(location, &originPath));
     ASSERT_STREQ(originPath.c_str(), "test");
 
+    location = "test@s3block";
+    ASSERT_EQ(OriginType::S3BlockOrigin,
+              LocationOperator::ParseLocation(location, &originPath));
+    ASSERT_STREQ(originPath.c_str(), "test");
+
+    location = "test@local";
+    ASSERT_EQ(OriginType::LocalOrigin,
+              LocationOperator::ParseLocation(location, &originPath));
+    ASSERT_STREQ(originPath.c_str(), "test");
+
+    location = "test@localblock";
+    ASSERT_EQ(OriginType::LocalBlockOrigin,
+              LocationOperator::ParseLocation(location, &originPath));
+    ASSERT_STREQ(originPath.c_str(), "test");
+
     location = "test@cs";
     ASSERT_EQ(OriginType::CurveOrigin,
               LocationOperator::ParseLocation(location, &originPath));
@@ -352,5 +352,59 @@ TEST_F(SnapshotTestSuit, SnapshotTest) {
     ASSERT_EQ(errorCode, CSErrorCode::ChunkNotExistError);
 }
 
+/**
+ * 变化块跟踪测试
+ * 1.新建chunk并写入，从chunk创建开始跟踪变化块
+ * 2.打快照后写入，快照文件接管快照前的变化块，chunk从快照版本开始重新跟踪
+ * 3.删除快照后，返回chunk自快照以来的变化块
+ */
+TEST_F(SnapshotTestSuit, ChangedBlocksTest) {
+    SequenceNum fileSn = 1;
+    CSErrorCode errorCode;
+    ChunkID id = 1;
+    ChangedBlocks changedBlocks;
+    char buf[PAGE_SIZE];
+    memset(buf, '1', PAGE_SIZE);
+
+    // 写chunk的[0, 4KB)区域
+    errorCode = dataStore_->WriteChunk(id, fileSn, buf, 0, PAGE_SIZE, nullptr);
+    ASSERT_EQ(errorCode, CSErrorCode::Success);
+    errorCode = dataStore_->GetChunkChangedBlocks(id, &changedBlocks);
+    ASSERT_EQ(errorCode, CSErrorCode::Success);
+    ASSERT_NE(nullptr, changedBlocks.bitmap);
+    ASSERT_EQ(CHUNK_SIZE / PAGE_SIZE, changedBlocks.bitmap->Size());
+    ASSERT_EQ(0, changedBlocks.baseSn);
+    ASSERT_TRUE(changedBlocks.bitmap->Test(0));
+    ASSERT_EQ(Bitmap::NO_POS, changedBlocks.bitmap->NextSetBit(1));
+
+    // 模拟打快照，写chunk的[8KB, 12KB)区域，产生快照文件
+    ++fileSn;   // fileSn == 2
+    errorCode = dataStore_->WriteChunk(id, fileSn, buf,
+                                       2 * PAGE_SIZE, PAGE_SIZE, nullptr);
+    ASSERT_EQ(errorCode, CSErrorCode::Success);
+    // 转储读取的快照数据的变化块为快照前的写入
+    errorCode = dataStore_->GetChunkChangedBlocks(id, &changedBlocks);
+    ASSERT_EQ(errorCode, CSErrorCode::Success);
+    ASSERT_NE(nullptr, changedBlocks.bitmap);
+    ASSERT_EQ(0, changedBlocks.baseSn);
+    ASSERT_TRUE(changedBlocks.bitmap->Test(0));
+    ASSERT_FALSE(changedBlocks.bitmap->Test(2));
+
+    // 删除快照，chunk的变化块为快照之后的写入
+    errorCode = dataStore_->DeleteSnapshotChunkOrCorrectSn(id, fileSn);
+    ASSERT_EQ(errorCode, CSErrorCode::Success);
+    errorCode = dataStore_->GetChunkChangedBlocks(id, &changedBlocks);
+    ASSERT_EQ(errorCode, CSErrorCode::Success);
+    ASSERT_NE(nullptr, changedBlocks.bitmap);
+    ASSERT_EQ(1, changedBlocks.baseSn);
+    ASSERT_FALSE(changedBlocks.bitmap->Test(0));
+    ASSERT_TRUE(changedBlocks.bitmap->Test(2));
+    ASSERT_EQ(Bitmap::NO_POS, changedBlocks.bitmap->NextSetBit(3));
+
+    // chunk不存在
+    errorCode = dataStore_->GetChunkChangedBlocks(2, &changedBlocks);
+    ASSERT_EQ(errorCode, CSErrorCode::ChunkNotExistError);
+}
+
 }  // namespace chunkserver
 }  // namespace curve
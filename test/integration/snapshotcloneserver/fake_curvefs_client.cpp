@@ -228,6 +228,30 @@ int FakeCurveFsClient::RecoverChunk(
     return LIBCURVE_ERROR::OK;
 }
 
+int FakeCurveFsClient::CreateCloneChunks(
+    LogicPoolID logicPoolId,
+    CopysetID copysetId,
+    const std::vector<CloneChunkItem> &chunks,
+    SnapCloneClosure *scc) {
+    scc->SetRetCode(LIBCURVE_ERROR::OK);
+    scc->Run();
+    fiu_return_on(
+        "test/integration/snapshotcloneserver/FakeCurveFsClient.CreateCloneChunk", -LIBCURVE_ERROR::FAILED);  // NOLINT
+    return LIBCURVE_ERROR::OK;
+}
+
+int FakeCurveFsClient::RecoverChunks(
+    LogicPoolID logicPoolId,
+    CopysetID copysetId,
+    const std::vector<CloneChunkItem> &chunks,
+    SnapCloneClosure *scc) {
+    scc->SetRetCode(LIBCURVE_ERROR::OK);
+    scc->Run();
+    fiu_return_on(
+        "test/integration/snapshotcloneserver/FakeCurveFsClient.RecoverChunk", -LIBCURVE_ERROR::FAILED);  // NOLINT
+    return LIBCURVE_ERROR::OK;
+}
+
 int FakeCurveFsClient::CompleteCloneMeta(
     const std::string &filename,
     const std::string &user) {
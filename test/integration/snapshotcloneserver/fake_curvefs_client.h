@@ -25,6 +25,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "src/snapshotcloneserver/common/curvefs_client.h"
 
@@ -111,6 +112,18 @@ class FakeCurveFsClient : public CurveFsClient {
         uint64_t len,
         SnapCloneClosure *scc) override;
 
+    int CreateCloneChunks(
+        LogicPoolID logicPoolId,
+        CopysetID copysetId,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure *scc) override;
+
+    int RecoverChunks(
+        LogicPoolID logicPoolId,
+        CopysetID copysetId,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure *scc) override;
+
     int CompleteCloneMeta(
         const std::string &filename,
         const std::string &user) override;
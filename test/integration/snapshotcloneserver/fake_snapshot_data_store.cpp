@@ -75,6 +75,7 @@ int FakeSnapshotDataStore::DeleteChunkData(const ChunkDataName &name) {
     fiu_return_on(
         "test/integration/snapshotcloneserver/FakeSnapshotDataStore.DeleteChunkData", -1);  // NOLINT
     chunkData_.erase(name.ToDataChunkKey());
+    blockMaps_.erase(name.ToDataChunkKey());
     return 0;
 }
 
@@ -110,5 +111,42 @@ int FakeSnapshotDataStore::DataChunkTranferAbort(const ChunkDataName &name,
     return 0;
 }
 
+int FakeSnapshotDataStore::PutChunkBlockMap(const ChunkDataName &name,
+        const ChunkBlockMap &blockMap) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    chunkData_.insert(name.ToDataChunkKey());
+    blockMaps_[name.ToDataChunkKey()] = blockMap;
+    return 0;
+}
+
+int FakeSnapshotDataStore::GetChunkBlockMap(const ChunkDataName &name,
+        ChunkBlockMap *blockMap) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    auto it = blockMaps_.find(name.ToDataChunkKey());
+    if (it == blockMaps_.end()) {
+        return -1;
+    }
+    *blockMap = it->second;
+    return 0;
+}
+
+int FakeSnapshotDataStore::PutDataBlock(const std::string &key,
+        const std::string &data) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    dataBlocks_.insert(key);
+    return 0;
+}
+
+int FakeSnapshotDataStore::DeleteDataBlock(const std::string &key) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    dataBlocks_.erase(key);
+    return 0;
+}
+
+bool FakeSnapshotDataStore::DataBlockExist(const std::string &key) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    return dataBlocks_.count(key) != 0;
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
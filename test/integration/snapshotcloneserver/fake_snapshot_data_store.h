@@ -58,11 +58,22 @@ class FakeSnapshotDataStore : public SnapshotDataStore {
     int DataChunkTranferAbort(const ChunkDataName &name,
                                std::shared_ptr<TransferTask> task) override;
 
+    int PutChunkBlockMap(const ChunkDataName &name,
+                         const ChunkBlockMap &blockMap) override;
+    int GetChunkBlockMap(const ChunkDataName &name,
+                         ChunkBlockMap *blockMap) override;
+    int PutDataBlock(const std::string &key,
+                     const std::string &data) override;
+    int DeleteDataBlock(const std::string &key) override;
+    bool DataBlockExist(const std::string &key) override;
+
  private:
     std::map<std::string, ChunkIndexData> indexDataMap_;
     std::mutex indexMapMutex_;
     std::set<std::string> chunkData_;
     std::mutex chunkDataMutex_;
+    std::map<std::string, ChunkBlockMap> blockMaps_;
+    std::set<std::string> dataBlocks_;
 };
 
 }  // namespace snapshotcloneserver
@@ -181,7 +181,61 @@ int FakeSnapshotCloneMetaStore::GetCloneInfoList(
     return -1;
 }
 
+int FakeSnapshotCloneMetaStore::RefSnapshotBlock(
+    const std::string &blockKey, uint64_t *refCount) {
+    std::lock_guard<std::mutex> guard(blockRefs_mutex_);
+    *refCount = ++blockRefs_[blockKey];
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::UnrefSnapshotBlock(
+    const std::string &blockKey, uint64_t *refCount) {
+    std::lock_guard<std::mutex> guard(blockRefs_mutex_);
+    auto search = blockRefs_.find(blockKey);
+    if (search == blockRefs_.end()) {
+        return -1;
+    }
+    *refCount = --search->second;
+    if (*refCount == 0) {
+        blockRefs_.erase(search);
+    }
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::RefSnapshotBlocks(
+    const std::vector<std::string> &blockKeys,
+    std::vector<uint64_t> *refCounts) {
+    std::lock_guard<std::mutex> guard(blockRefs_mutex_);
+    refCounts->clear();
+    for (const auto &blockKey : blockKeys) {
+        refCounts->push_back(++blockRefs_[blockKey]);
+    }
+    return 0;
+}
 
+int FakeSnapshotCloneMetaStore::UnrefSnapshotBlocks(
+    const std::vector<std::string> &blockKeys,
+    std::vector<uint64_t> *refCounts) {
+    std::lock_guard<std::mutex> guard(blockRefs_mutex_);
+    // 全部检查通过后再修改，与事务的语义一致
+    std::map<std::string, uint64_t> deltas;
+    for (const auto &blockKey : blockKeys) {
+        auto search = blockRefs_.find(blockKey);
+        if (search == blockRefs_.end() ||
+            search->second < ++deltas[blockKey]) {
+            return -1;
+        }
+    }
+    refCounts->clear();
+    for (const auto &blockKey : blockKeys) {
+        auto search = blockRefs_.find(blockKey);
+        refCounts->push_back(--search->second);
+        if (search->second == 0) {
+            blockRefs_.erase(search);
+        }
+    }
+    return 0;
+}
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
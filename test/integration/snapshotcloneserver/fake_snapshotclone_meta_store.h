@@ -57,12 +57,27 @@ class FakeSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int RefSnapshotBlock(const std::string &blockKey,
+                         uint64_t *refCount) override;
+
+    int UnrefSnapshotBlock(const std::string &blockKey,
+                           uint64_t *refCount) override;
+
+    int RefSnapshotBlocks(const std::vector<std::string> &blockKeys,
+                          std::vector<uint64_t> *refCounts) override;
+
+    int UnrefSnapshotBlocks(const std::vector<std::string> &blockKeys,
+                            std::vector<uint64_t> *refCounts) override;
+
  private:
     std::map<UUID, SnapshotInfo> snapInfos_;
     std::mutex snapInfos_mutex;
 
     std::map<std::string, CloneInfo> cloneInfos_;
     curve::common::RWLock cloneInfos_lock_;
+
+    std::map<std::string, uint64_t> blockRefs_;
+    std::mutex blockRefs_mutex_;
 };
 
 
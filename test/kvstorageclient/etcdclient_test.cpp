@@ -385,6 +385,64 @@ TEST_F(TestEtcdClinetImp, test_return_with_revision) {
     ASSERT_EQ(startRevision + 2, revision);
 }
 
+TEST_F(TestEtcdClinetImp, test_TxnNWithCompare) {
+    std::string key = "txncompare";
+    std::string value;
+    int64_t modRevision;
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist,
+              client_->GetWithModRevision(key, &value, &modRevision));
+    ASSERT_EQ(0, modRevision);
+
+    std::string value1 = "value1";
+    Compare notExist{CompareOp::CmpEqual, const_cast<char *>(key.c_str()),
+                     static_cast<int>(key.size()), 0};
+    Operation put1{OpType::OpPut, const_cast<char *>(key.c_str()),
+                   const_cast<char *>(value1.c_str()),
+                   static_cast<int>(key.size()),
+                   static_cast<int>(value1.size())};
+    int64_t revision;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->TxnNWithCompare({notExist}, {put1}, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->GetWithModRevision(key, &value, &modRevision));
+    ASSERT_EQ(value1, value);
+    ASSERT_EQ(revision, modRevision);
+
+    // key已经被修改，比较失败时不执行任何操作
+    std::string value2 = "value2";
+    Operation put2{OpType::OpPut, const_cast<char *>(key.c_str()),
+                   const_cast<char *>(value2.c_str()),
+                   static_cast<int>(key.size()),
+                   static_cast<int>(value2.size())};
+    ASSERT_EQ(EtcdErrCode::EtcdTxnCompareFailed,
+              client_->TxnNWithCompare({notExist}, {put2}, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client_->Get(key, &value));
+    ASSERT_EQ(value1, value);
+
+    Compare unchanged{CompareOp::CmpEqual, const_cast<char *>(key.c_str()),
+                      static_cast<int>(key.size()), modRevision};
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->TxnNWithCompare({unchanged}, {put2}, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdTxnCompareFailed,
+              client_->TxnNWithCompare({unchanged}, {put1}, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client_->Get(key, &value));
+    ASSERT_EQ(value2, value);
+
+    // key存在时才删除
+    Compare exist{CompareOp::CmpNotEqual, const_cast<char *>(key.c_str()),
+                  static_cast<int>(key.size()), 0};
+    Operation del{OpType::OpDelete, const_cast<char *>(key.c_str()), "",
+                  static_cast<int>(key.size()), 0};
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->TxnNWithCompare({exist}, {del}, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdTxnCompareFailed,
+              client_->TxnNWithCompare({exist}, {del}, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist, client_->Get(key, &value));
+
+    ASSERT_EQ(EtcdErrCode::EtcdInvalidArgument,
+              client_->TxnNWithCompare({}, {del}, &revision));
+}
+
 TEST_F(TestEtcdClinetImp, test_CampaignLeader) {
     std::string pfx("/leadere-election/");
     int sessionnInterSec = 1;
@@ -35,6 +35,7 @@ using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::_;
+using ::testing::SaveArg;
 using ::curve::mds::topology::MockTopology;
 using ::curve::mds::topology::MockTopologyStat;
 
@@ -934,6 +935,89 @@ TEST_F(TestHeartbeatManager, test_patrol_copySetInfo_return_order) {
     ASSERT_EQ(TRANSFER_LEADER, response.needupdatecopysets(0).type());
     ASSERT_EQ(3, response.needupdatecopysets(0).peers_size());
 }
+TEST_F(TestHeartbeatManager, test_delta_heartbeat) {
+    auto request = GetChunkServerHeartbeatRequestForTest();
+    request.set_copysetcount(1);
+    request.set_reportseq(100);
+    ChunkServerHeartbeatResponse response;
+    ::curve::mds::topology::ChunkServer chunkServer1(
+        1, "hello", "", 1, "192.168.10.1", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer2(
+        2, "hello", "", 1, "192.168.10.2", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer3(
+        3, "hello", "", 1, "192.168.10.3", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    EXPECT_CALL(*topology_, GetChunkServer(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired("192.168.10.1", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(chunkServer1), Return(true)));
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired("192.168.10.2", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(chunkServer2), Return(true)));
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired("192.168.10.3", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(chunkServer3), Return(true)));
+    EXPECT_CALL(*topology_, FindChunkServerNotRetired("192.168.10.1", 9000))
+        .WillRepeatedly(Return(1));
+    ::curve::mds::topology::CopySetInfo recordCopySetInfo(1, 1);
+    recordCopySetInfo.SetEpoch(10);
+    recordCopySetInfo.SetLeader(1);
+    recordCopySetInfo.SetCopySetMembers({1, 2, 3});
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(recordCopySetInfo), Return(true)));
+    ::curve::mds::topology::ChunkServerStat stat;
+    EXPECT_CALL(*topologyStat_, UpdateChunkServerStat(1, _))
+        .WillRepeatedly(SaveArg<1>(&stat));
+
+    // 1. full heartbeat
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+        .WillOnce(Return(::curve::mds::topology::UNINTIALIZE_ID));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_TRUE(response.has_needfullreport());
+    ASSERT_FALSE(response.needfullreport());
+    ASSERT_EQ(1, stat.copysetStats.size());
+    ASSERT_EQ(1, stat.copysetStats[0].leader);
+
+    // 2. delta heartbeat without changed copyset, the copyset with operator
+    //    is still handled
+    request.clear_copysetinfos();
+    request.set_basereportseq(100);
+    request.set_reportseq(101);
+    response.Clear();
+    EXPECT_CALL(*coordinator_, GetOperatorCopySets())
+        .WillOnce(Return(std::vector<CopySetKey>{CopySetKey(1, 1),
+                                                 CopySetKey(1, 2)}));
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+        .WillOnce(Return(::curve::mds::topology::UNINTIALIZE_ID));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_FALSE(response.needfullreport());
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+    ASSERT_EQ(1, stat.copysetStats.size());
+
+    // 3. copyset removed, but copyset count is not consistent
+    response.Clear();
+    request.set_basereportseq(101);
+    request.set_reportseq(102);
+    auto removed = request.add_removedcopysets();
+    removed->set_logicalpoolid(1);
+    removed->set_copysetid(1);
+    EXPECT_CALL(*coordinator_, GetOperatorCopySets())
+        .WillOnce(Return(std::vector<CopySetKey>{}));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_TRUE(response.needfullreport());
+    ASSERT_EQ(0, stat.copysetStats.size());
+
+    // 4. delta heartbeat based on a stale heartbeat
+    response.Clear();
+    request.clear_removedcopysets();
+    request.set_basereportseq(101);
+    request.set_reportseq(103);
+    EXPECT_CALL(*coordinator_, GetOperatorCopySets())
+        .WillOnce(Return(std::vector<CopySetKey>{}));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_TRUE(response.needfullreport());
+}
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
@@ -24,6 +24,7 @@
 #define TEST_MDS_MOCK_MOCK_CHUNKSERVERCLIENT_H_
 
 #include <memory>
+#include <vector>
 #include "src/mds/chunkserverclient/chunkserver_client.h"
 #include "src/mds/chunkserverclient/chunkserverclient_config.h"
 
@@ -54,6 +55,20 @@ class MockChunkServerClient : public ChunkServerClient {
         ChunkID chunkId,
         uint64_t sn));
 
+    MOCK_METHOD5(DeleteChunks,
+        int(ChunkServerIdType csId,
+        LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t sn));
+
+    MOCK_METHOD5(DeleteChunkSnapshotsOrCorrectSn,
+        int(ChunkServerIdType csId,
+        LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t correctedSn));
+
     MOCK_METHOD4(GetLeader,
         int(ChunkServerIdType csId,
         LogicalPoolID logicalPoolId,
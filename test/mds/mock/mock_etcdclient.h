@@ -49,8 +49,14 @@ class MockEtcdClient : public EtcdClientImp {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNRewithRevision,
+        int(const std::vector<Operation>&, int64_t *));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
+    MOCK_METHOD3(GetWithModRevision,
+        int(const std::string&, std::string*, int64_t*));
+    MOCK_METHOD3(TxnNWithCompare, int(const std::vector<Compare>&,
+        const std::vector<Operation>&, int64_t*));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
         uint32_t, uint32_t, uint64_t*));
     MOCK_METHOD2(LeaderObserve, int(uint64_t, const std::string&));
@@ -32,7 +32,13 @@ using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::Matcher;
+using ::testing::Invoke;
 
+using ::curve::common::DISCARDSEGMENTKEYEND;
+using ::curve::common::DISCARDSEGMENTKEYPREFIX;
+using ::curve::common::SEGMENTALLOCCHANGEKEYEND;
+using ::curve::common::SEGMENTALLOCCHANGEKEYPREFIX;
+using ::curve::common::SEGMENTALLOCJOURNALKEY;
 using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTINFOKEYEND;
@@ -91,6 +97,8 @@ TEST_F(AllocStatisticTest, test_Init) {
                          Matcher<std::vector<std::string>*>(_)))
             .WillOnce(
                 DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCJOURNALKEY, _))
+            .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
         ASSERT_EQ(0, allocStatistic_->Init());
         int64_t alloc;
         ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
@@ -98,6 +106,208 @@ TEST_F(AllocStatisticTest, test_Init) {
     }
 }
 
+TEST_F(AllocStatisticTest, test_InitFromJournal) {
+    // 持久化值: logicalPoolId(1):1024, 未合并的变化: (1):+512, (2):+256
+    std::vector<std::string> values{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024)};
+    std::vector<std::string> changes{
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(1, 1024),
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(1, -512),
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(2, 256)};
+    EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCJOURNALKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCCHANGEKEYPREFIX, SEGMENTALLOCCHANGEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(
+            DoAll(SetArgPointee<2>(changes), Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(0, allocStatistic_->Init());
+
+    // 不需要全量扫描segment
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(_, _, _, _, _, _))
+        .Times(0);
+    EXPECT_CALL(*mockEtcdClient_, List(SEGMENTALLOCCHANGEKEYPREFIX,
+        SEGMENTALLOCCHANGEKEYEND,
+        Matcher<std::vector<std::pair<std::string, std::string>>*>(_)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_, GetWithModRevision(SEGMENTALLOCJOURNALKEY,
+                                                     _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(10),
+                              Return(EtcdErrCode::EtcdOK)));
+    allocStatistic_->Run();
+
+    int64_t alloc;
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(1536, alloc);
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(2, &alloc));
+    ASSERT_EQ(256, alloc);
+
+    allocStatistic_->AllocSpace(2, 1024, 3);
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(2, &alloc));
+    ASSERT_EQ(1280, alloc);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    allocStatistic_->Stop();
+}
+
+TEST_F(AllocStatisticTest, test_FoldChangesWithinTxnOpLimit) {
+    // 持久化值: 100个logicalPool, 未合并的变化: (1):+1 * 300
+    std::vector<std::string> values;
+    for (PoolIdType lid = 1; lid <= 100; lid++) {
+        values.emplace_back(
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(lid, 1024));
+    }
+    std::vector<std::pair<std::string, std::string>> changes;
+    for (int i = 0; i < 300; i++) {
+        changes.emplace_back(
+            NameSpaceStorageCodec::EncodeSegmentAllocChangeKey(),
+            NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(1, 1));
+    }
+    EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCJOURNALKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCCHANGEKEYPREFIX, SEGMENTALLOCCHANGEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(0, allocStatistic_->Init());
+
+    EXPECT_CALL(*mockEtcdClient_, List(SEGMENTALLOCCHANGEKEYPREFIX,
+        SEGMENTALLOCCHANGEKEYEND,
+        Matcher<std::vector<std::pair<std::string, std::string>>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(changes),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_, GetWithModRevision(SEGMENTALLOCJOURNALKEY,
+                                                     _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>("2"), SetArgPointee<2>(10),
+                              Return(EtcdErrCode::EtcdOK)));
+    // 每个事务的操作数不超过etcd的限制, 所有变化都被合并,
+    // 每个事务都要求journal在上一个事务之后没有被修改
+    std::string lastPut;
+    int deletes = 0;
+    int64_t journalRevision = 10;
+    EXPECT_CALL(*mockEtcdClient_, TxnNWithCompare(_, _, _))
+        .WillRepeatedly(Invoke([&](const std::vector<Compare> &cmps,
+                                   const std::vector<Operation> &ops,
+                                   int64_t *revision) {
+            EXPECT_EQ(1, cmps.size());
+            EXPECT_EQ(SEGMENTALLOCJOURNALKEY,
+                      std::string(cmps[0].key, cmps[0].keyLen));
+            EXPECT_EQ(journalRevision, cmps[0].modRevision);
+            EXPECT_GE(128, ops.size());
+            for (const auto &op : ops) {
+                if (op.opType == OpType::OpDelete) {
+                    deletes++;
+                } else if (std::string(op.key, op.keyLen) ==
+                           NameSpaceStorageCodec::EncodeSegmentAllocKey(1)) {
+                    lastPut = std::string(op.value, op.valueLen);
+                }
+            }
+            *revision = ++journalRevision;
+            return EtcdErrCode::EtcdOK;
+        }));
+    allocStatistic_->Run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    allocStatistic_->Stop();
+
+    ASSERT_EQ(300, deletes);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1324),
+              lastPut);
+}
+
+TEST_F(AllocStatisticTest, test_FoldChangesConflict) {
+    // 持久化值: logicalPoolId(1):1024
+    std::vector<std::string> values{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024)};
+    EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCJOURNALKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCCHANGEKEYPREFIX, SEGMENTALLOCCHANGEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(0, allocStatistic_->Init());
+
+    // 读取之后其他mds合并了变化(1):+5, 本次合并的事务比较失败,
+    // 重新读取持久化值和变化后再合并(1):+1
+    std::vector<std::string> foldedValues{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1029)};
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(foldedValues),
+                              Return(EtcdErrCode::EtcdOK)));
+    std::vector<std::pair<std::string, std::string>> changes{
+        {NameSpaceStorageCodec::EncodeSegmentAllocChangeKey(),
+         NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(1, 1)}};
+    EXPECT_CALL(*mockEtcdClient_, List(SEGMENTALLOCCHANGEKEYPREFIX,
+        SEGMENTALLOCCHANGEKEYEND,
+        Matcher<std::vector<std::pair<std::string, std::string>>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(changes),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<2>(changes),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_, GetWithModRevision(SEGMENTALLOCJOURNALKEY,
+                                                     _, _))
+        .WillOnce(DoAll(SetArgPointee<1>("2"), SetArgPointee<2>(10),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillRepeatedly(DoAll(SetArgPointee<1>("2"), SetArgPointee<2>(11),
+                              Return(EtcdErrCode::EtcdOK)));
+    std::string lastPut;
+    EXPECT_CALL(*mockEtcdClient_, TxnNWithCompare(_, _, _))
+        .WillOnce(Invoke([](const std::vector<Compare> &cmps,
+                            const std::vector<Operation> &ops,
+                            int64_t *revision) {
+            EXPECT_EQ(10, cmps[0].modRevision);
+            *revision = 12;
+            return EtcdErrCode::EtcdTxnCompareFailed;
+        }))
+        .WillOnce(Invoke([&](const std::vector<Compare> &cmps,
+                             const std::vector<Operation> &ops,
+                             int64_t *revision) {
+            EXPECT_EQ(11, cmps[0].modRevision);
+            for (const auto &op : ops) {
+                if (op.opType == OpType::OpPut &&
+                    std::string(op.key, op.keyLen) ==
+                        NameSpaceStorageCodec::EncodeSegmentAllocKey(1)) {
+                    lastPut = std::string(op.value, op.valueLen);
+                }
+            }
+            *revision = 13;
+            return EtcdErrCode::EtcdOK;
+        }));
+    allocStatistic_->Run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    allocStatistic_->Stop();
+
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1030),
+              lastPut);
+}
+
 TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
     // 初始化 allocStatistic
     // 旧值: logicalPooId(1):1024
@@ -109,6 +319,8 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
                 List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
                      Matcher<std::vector<std::string>*>(_)))
         .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCJOURNALKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
     ASSERT_EQ(0, allocStatistic_->Init());
 
     PageFileSegment segment;
@@ -167,7 +379,7 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
         .WillOnce(Return(EtcdErrCode::EtcdCanceled))
         .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
 
-    // 设置mock的Put结果
+    // 设置mock的Put结果, 扫描完成前持久化的旧值
     EXPECT_CALL(*mockEtcdClient_, Put(
         NameSpaceStorageCodec::EncodeSegmentAllocKey(1),
         NameSpaceStorageCodec::EncodeSegmentAllocValue(
@@ -177,26 +389,74 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
         NameSpaceStorageCodec::EncodeSegmentAllocKey(2),
         NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 1L << 30)))
         .WillOnce(Return(EtcdErrCode::EtcdOK));
-    EXPECT_CALL(*mockEtcdClient_, Put(
-        NameSpaceStorageCodec::EncodeSegmentAllocKey(1),
-        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 501L *(1 << 30))))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
-    EXPECT_CALL(*mockEtcdClient_, Put(
-        NameSpaceStorageCodec::EncodeSegmentAllocKey(2),
-        NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 502L *(1 << 30))))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
-    EXPECT_CALL(*mockEtcdClient_, Put(
-        NameSpaceStorageCodec::EncodeSegmentAllocKey(1),
-        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 500L *(1 << 30))))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
-    EXPECT_CALL(*mockEtcdClient_, Put(
-        NameSpaceStorageCodec::EncodeSegmentAllocKey(2),
-        NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 501L *(1 << 30))))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
-    EXPECT_CALL(*mockEtcdClient_, Put(
-        NameSpaceStorageCodec::EncodeSegmentAllocKey(3),
-        NameSpaceStorageCodec::EncodeSegmentAllocValue(3, 1L << 30)))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
+
+    // revision 2时, 已经计入segment的变化: (1):+1G,
+    // 尚未清理的discard segment: (2):1G
+    std::string encodeChange =
+        NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(1, 1L << 30);
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTALLOCCHANGEKEYPREFIX, SEGMENTALLOCCHANGEKEYEND, GETBUNDLE, 2,
+        _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(
+                            std::vector<std::string>{encodeChange}),
+                        Return(EtcdErrCode::EtcdOK)));
+    DiscardSegmentInfo discardInfo;
+    discardInfo.mutable_fileinfo()->set_filename("/discard");
+    discardInfo.mutable_pagefilesegment()->CopyFrom(segment);
+    std::string encodeDiscard;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeDiscardSegment(
+        discardInfo, &encodeDiscard));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        DISCARDSEGMENTKEYPREFIX, DISCARDSEGMENTKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(
+                            std::vector<std::string>{encodeDiscard}),
+                        Return(EtcdErrCode::EtcdOK)));
+
+    // 合并变化: revision 2之前的(1):+1G, 之后的(2):-1G
+    std::vector<std::pair<std::string, std::string>> changes{
+        {NameSpaceStorageCodec::EncodeSegmentAllocChangeKey(), encodeChange},
+        {NameSpaceStorageCodec::EncodeSegmentAllocChangeKey(),
+         NameSpaceStorageCodec::EncodeSegmentAllocChangeValue(
+             2, -(1L << 30))}};
+    EXPECT_CALL(*mockEtcdClient_, List(SEGMENTALLOCCHANGEKEYPREFIX,
+        SEGMENTALLOCCHANGEKEYEND,
+        Matcher<std::vector<std::pair<std::string, std::string>>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(changes),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    // 第一次合并时journal还不存在, 之后的合并都读到第一次合并写入的journal
+    EXPECT_CALL(*mockEtcdClient_, GetWithModRevision(SEGMENTALLOCJOURNALKEY,
+                                                     _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(0),
+                        Return(EtcdErrCode::EtcdKeyNotExist)))
+        .WillRepeatedly(DoAll(SetArgPointee<1>("2"), SetArgPointee<2>(20),
+                              Return(EtcdErrCode::EtcdOK)));
+    std::map<std::string, std::string> puts;
+    int deletes = 0;
+    EXPECT_CALL(*mockEtcdClient_, TxnNWithCompare(_, _, _))
+        .WillOnce(Invoke([&](const std::vector<Compare> &cmps,
+                             const std::vector<Operation> &ops,
+                             int64_t *revision) {
+            EXPECT_EQ(1, cmps.size());
+            EXPECT_EQ(SEGMENTALLOCJOURNALKEY,
+                      std::string(cmps[0].key, cmps[0].keyLen));
+            EXPECT_EQ(CompareOp::CmpEqual, cmps[0].op);
+            EXPECT_EQ(0, cmps[0].modRevision);
+            for (const auto &op : ops) {
+                if (op.opType == OpType::OpPut) {
+                    puts[std::string(op.key, op.keyLen)] =
+                        std::string(op.value, op.valueLen);
+                } else {
+                    deletes++;
+                }
+            }
+            *revision = 20;
+            return EtcdErrCode::EtcdOK;
+        }));
 
     // 2. 启动定期持久化线程和统计线程
     for (int i = 1; i <= 2; i++) {
@@ -224,8 +484,18 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
     ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(3, &alloc));
     ASSERT_EQ(1L << 30, alloc);
     std::this_thread::sleep_for(std::chrono::milliseconds(30));
-
     allocStatistic_->Stop();
+
+    // 持久化值 = 全量扫描 + discard segment - 已计入的变化 + 所有变化
+    ASSERT_EQ(2, deletes);
+    ASSERT_EQ(3, puts.size());
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                  1, 500L * (1 << 30)),
+              puts[NameSpaceStorageCodec::EncodeSegmentAllocKey(1)]);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                  2, 501L * (1 << 30)),
+              puts[NameSpaceStorageCodec::EncodeSegmentAllocKey(2)]);
+    ASSERT_EQ(1, puts.count(SEGMENTALLOCJOURNALKEY));
 }
 
 }  // namespace mds
@@ -34,6 +34,7 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using curve::mds::topology::MockTopology;
 using ::curve::mds::chunkserverclient::ChunkServerClientOption;
 using ::curve::mds::chunkserverclient::MockChunkServerClient;
@@ -351,6 +352,33 @@ TEST_F(CleanCoreTest, TestCleanDiscardSegment) {
         ASSERT_EQ(TaskStatus::FAILED, progress.GetStatus());
     }
 
+    // discard segment已经被清理, 不再重复释放空间
+    {
+        client_->SetChunkServerClient(csClient_);
+
+        CopySetInfo copyset;
+
+        copyset.SetLeader(1);
+
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+            .Times(segment.chunks_size())
+            .WillRepeatedly(
+                DoAll(SetArgPointee<1>(copyset), Return(true)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, _, _, _, _))
+            .Times(segment.chunks_size())
+            .WillRepeatedly(Return(kMdsSuccess));
+
+        EXPECT_CALL(*storage_, CleanDiscardSegment(_, _, _))
+            .WillOnce(Return(StoreStatus::KeyNotExist));
+        EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+            .Times(0);
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kOK, cleanCore_->CleanDiscardSegment(
+                                       fakeKey, discardSegmentInfo, &progress));
+        ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+    }
+
     // ok
     {
         client_->SetChunkServerClient(csClient_);
@@ -380,5 +408,154 @@ TEST_F(CleanCoreTest, TestCleanDiscardSegment) {
     }
 }
 
+TEST_F(CleanCoreTest, TestCleanFileBatchDelete) {
+    const int kDefaultChunkSize = 16 * 1024 * 1024;
+    const int kChunkNumPerSegment = 8;
+
+    CleanOption option;
+    option.batchDeleteChunkNum = 4;
+    option.segmentNumPerRound = 2;
+    option.deleteConcurrency = 4;
+    auto cleanCore =
+        std::make_shared<CleanCore>(storage_, client_, allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    // segment 0~3 are allocated, chunks of each segment are in 2 copysets
+    EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .WillRepeatedly(Return(StoreStatus::KeyNotExist));
+    for (int i = 0; i < 4; i++) {
+        PageFileSegment segment;
+        segment.set_logicalpoolid(1);
+        segment.set_segmentsize(DefaultSegmentSize);
+        segment.set_chunksize(kDefaultChunkSize);
+        segment.set_startoffset(i * DefaultSegmentSize);
+        for (int j = 0; j < kChunkNumPerSegment; j++) {
+            auto* chunk = segment.add_chunks();
+            chunk->set_copysetid(j % 2);
+            chunk->set_chunkid(i * kChunkNumPerSegment + j);
+        }
+        EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
+            .WillOnce(DoAll(SetArgPointee<2>(segment),
+                            Return(StoreStatus::OK)));
+    }
+
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+
+    // 2 rounds, 8 chunks of each copyset are deleted by 2 rpcs per round
+    EXPECT_CALL(*csClient_, DeleteChunk(_, _, _, _, _))
+        .Times(0);
+    EXPECT_CALL(*csClient_, DeleteChunks(_, 1, _, _, 10))
+        .Times(8)
+        .WillRepeatedly(Return(kMdsSuccess));
+    EXPECT_CALL(*storage_, DeleteSegment(_, _, _))
+        .Times(4)
+        .WillRepeatedly(Return(StoreStatus::OK));
+    EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+        .Times(4);
+    EXPECT_CALL(*storage_, DeleteFile(_, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+    FileInfo cleanFile;
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+    cleanFile.set_seqnum(10);
+    TaskProgress progress;
+    ASSERT_EQ(StatusCode::kOK, cleanCore->CleanFile(cleanFile, &progress));
+    ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+
+    // one rpc failed, segments of the round are kept
+    {
+        EXPECT_CALL(*storage_, GetSegment(_, 0, _))
+            .WillOnce(Return(StoreStatus::OK));
+        PageFileSegment segment;
+        segment.set_logicalpoolid(1);
+        for (int j = 0; j < kChunkNumPerSegment; j++) {
+            auto* chunk = segment.add_chunks();
+            chunk->set_copysetid(j % 2);
+            chunk->set_chunkid(j);
+        }
+        EXPECT_CALL(*storage_, GetSegment(_, DefaultSegmentSize, _))
+            .WillOnce(DoAll(SetArgPointee<2>(segment),
+                            Return(StoreStatus::OK)));
+        EXPECT_CALL(*csClient_, DeleteChunks(_, _, _, _, _))
+            .WillOnce(Return(kCsClientReturnFail))
+            .WillRepeatedly(Return(kMdsSuccess));
+        EXPECT_CALL(*storage_, DeleteSegment(_, _, _))
+            .Times(0);
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kCommonFileDeleteError,
+                  cleanCore->CleanFile(cleanFile, &progress));
+        ASSERT_EQ(TaskStatus::FAILED, progress.GetStatus());
+    }
+}
+
+TEST_F(CleanCoreTest, TestCleanSnapShotFileResumeFromCheckpoint) {
+    const int kChunkNumPerSegment = 8;
+
+    CleanOption option;
+    option.batchDeleteChunkNum = 4;
+    option.segmentNumPerRound = 2;
+    auto cleanCore =
+        std::make_shared<CleanCore>(storage_, client_, allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    for (int j = 0; j < kChunkNumPerSegment; j++) {
+        auto* chunk = segment.add_chunks();
+        chunk->set_copysetid(j % 2);
+        chunk->set_chunkid(j);
+    }
+
+    // segments before the checkpoint are skipped
+    uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
+    for (uint32_t i = 0; i < segmentNum; i++) {
+        if (i < 4) {
+            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
+                .Times(0);
+        } else {
+            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
+                .WillOnce(DoAll(SetArgPointee<2>(segment),
+                                Return(StoreStatus::OK)));
+        }
+    }
+
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+    EXPECT_CALL(*csClient_, DeleteChunkSnapshotsOrCorrectSn(_, 1, _, _, 11))
+        .Times(12)
+        .WillRepeatedly(Return(kMdsSuccess));
+
+    // checkpoint is persisted after each round except the last one
+    std::vector<uint64_t> checkpoints;
+    EXPECT_CALL(*storage_, PutFile(_))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](const FileInfo& fileInfo) {
+            checkpoints.push_back(fileInfo.cleanedoffset());
+            return StoreStatus::OK;
+        }));
+    EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+    FileInfo cleanFile;
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+    cleanFile.set_seqnum(10);
+    cleanFile.set_cleanedoffset(4 * DefaultSegmentSize);
+    TaskProgress progress;
+    ASSERT_EQ(StatusCode::kOK,
+              cleanCore->CleanSnapShotFile(cleanFile, &progress));
+    ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+    ASSERT_EQ(std::vector<uint64_t>({6 * DefaultSegmentSize,
+                                     8 * DefaultSegmentSize}),
+              checkpoints);
+}
+
 }  // namespace mds
 }  // namespace curve
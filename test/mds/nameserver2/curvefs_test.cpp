@@ -2511,6 +2511,137 @@ TEST_F(CurveFSTest, testGetOrAllocateSegment) {
     }
 }
 
+TEST_F(CurveFSTest, testGetOrAllocateSegments) {
+    FileInfo fileInfo1;
+    fileInfo1.set_filetype(FileType::INODE_DIRECTORY);
+
+    FileInfo fileInfo2;
+    fileInfo2.set_filetype(FileType::INODE_PAGEFILE);
+    fileInfo2.set_length(4 * DefaultSegmentSize);
+    fileInfo2.set_segmentsize(DefaultSegmentSize);
+    fileInfo2.set_poolset("default");
+
+    auto allocate = [](FileType, SegmentSizeType, ChunkSizeType,
+                       const std::string&, offset_t offset,
+                       PageFileSegment* segment) {
+        segment->set_startoffset(offset);
+        return true;
+    };
+
+    // first segment exists, the following two are allocated and
+    // stored in one transaction
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .Times(3)
+        .WillOnce(Return(StoreStatus::OK))
+        .WillRepeatedly(Return(StoreStatus::KeyNotExist));
+
+        EXPECT_CALL(*mockChunkAllocator_,
+                   AllocateChunkSegment(_, _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke(allocate));
+
+        std::vector<PageFileSegment> stored;
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&stored),
+                        Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, PutSegment(_, _, _, _))
+        .Times(0);
+
+        ASSERT_EQ(StatusCode::kOK, curvefs_->GetOrAllocateSegments(
+                  "/user1/file2", 0, true, 3, &segments));
+        ASSERT_EQ(3, segments.size());
+        ASSERT_EQ(2, stored.size());
+        ASSERT_EQ(DefaultSegmentSize, stored[0].startoffset());
+        ASSERT_EQ(2 * DefaultSegmentSize, stored[1].startoffset());
+    }
+
+    // not allocated segments are skipped when not allocate,
+    // and segments beyond file length are not returned
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .Times(3)
+        .WillOnce(Return(StoreStatus::OK))
+        .WillOnce(Return(StoreStatus::KeyNotExist))
+        .WillOnce(Return(StoreStatus::OK));
+
+        ASSERT_EQ(StatusCode::kOK, curvefs_->GetOrAllocateSegments(
+                  "/user1/file2", DefaultSegmentSize, false, 8, &segments));
+        ASSERT_EQ(2, segments.size());
+    }
+
+    // allocate failure of following segments doesn't fail the request
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .Times(2)
+        .WillRepeatedly(Return(StoreStatus::KeyNotExist));
+
+        EXPECT_CALL(*mockChunkAllocator_,
+                   AllocateChunkSegment(_, _, _, _, _, _))
+        .Times(2)
+        .WillOnce(Invoke(allocate))
+        .WillOnce(Return(false));
+
+        EXPECT_CALL(*storage_, PutSegment(_, 0, _, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+        ASSERT_EQ(StatusCode::kOK, curvefs_->GetOrAllocateSegments(
+                  "/user1/file2", 0, true, 4, &segments));
+        ASSERT_EQ(1, segments.size());
+    }
+
+    // store failure
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .Times(2)
+        .WillRepeatedly(Return(StoreStatus::KeyNotExist));
+
+        EXPECT_CALL(*mockChunkAllocator_,
+                   AllocateChunkSegment(_, _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke(allocate));
+
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+        .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(StatusCode::kStorageError, curvefs_->GetOrAllocateSegments(
+                  "/user1/file2", 2 * DefaultSegmentSize, true, 2, &segments));
+        ASSERT_TRUE(segments.empty());
+    }
+}
+
 TEST_F(CurveFSTest, TestDeAllocateSegment) {
     const std::string filename = "/TestDeAllocateSegment";
     const uint64_t offset = 1ull * 1024 * 1024 * 1024;
@@ -393,11 +393,24 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (const auto &segment : segments) {
+            std::string storeKey = NameSpaceStorageCodec::EncodeSegmentStoreKey(
+                id, segment.startoffset());
+            memKvMap_.emplace(storeKey, segment.SerializeAsString());
+        }
+        return StoreStatus::OK;
+    }
+
     StoreStatus DeleteSegment(
-        InodeID id, uint64_t off, int64_t *revision) override {
+        InodeID id, const PageFileSegment &segment,
+        int64_t *revision) override {
         std::lock_guard<std::mutex> guard(lock_);
-        std::string storeKey =
-            NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
+        std::string storeKey = NameSpaceStorageCodec::EncodeSegmentStoreKey(
+            id, segment.startoffset());
 
         auto iter = memKvMap_.find(storeKey);
         if (iter == memKvMap_.end()) {
@@ -478,7 +491,8 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
-    StoreStatus CleanDiscardSegment(uint64_t size, const std::string& key,
+    StoreStatus CleanDiscardSegment(const PageFileSegment& segment,
+                                    const std::string& key,
                                     int64_t* revision) override {
         std::lock_guard<std::mutex> guard(lock_);
         if (memKvMap_.count(key) == 0) {
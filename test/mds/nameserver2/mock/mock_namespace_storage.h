@@ -77,7 +77,13 @@ class MockNameServerStorage : public NameServerStorage {
                                          const PageFileSegment *,
                                          int64_t *));
 
-    MOCK_METHOD3(DeleteSegment, StoreStatus(InodeID, uint64_t, int64_t*));
+    MOCK_METHOD3(PutSegments, StoreStatus(InodeID,
+                              const std::vector<PageFileSegment> &,
+                              int64_t *));
+
+    MOCK_METHOD3(DeleteSegment, StoreStatus(InodeID,
+                                            const PageFileSegment &,
+                                            int64_t *));
 
     MOCK_METHOD2(SnapShotFile, StoreStatus(const FileInfo *,
                                     const FileInfo *));
@@ -89,7 +95,8 @@ class MockNameServerStorage : public NameServerStorage {
     MOCK_METHOD2(DiscardSegment,
                  StoreStatus(const FileInfo&, const PageFileSegment&));
     MOCK_METHOD3(CleanDiscardSegment,
-                 StoreStatus(uint64_t, const std::string&, int64_t*));
+                 StoreStatus(const PageFileSegment&, const std::string&,
+                             int64_t*));
     MOCK_METHOD1(ListDiscardSegment,
                  StoreStatus(std::map<std::string, DiscardSegmentInfo>*));
 };
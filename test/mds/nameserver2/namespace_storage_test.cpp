@@ -27,6 +27,7 @@
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/common/timeutility.h"
+#include "src/common/namespace_define.h"
 #include "test/mds/mock/mock_etcdclient.h"
 
 using ::testing::_;
@@ -35,6 +36,10 @@ using ::testing::AtLeast;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::Matcher;
+using ::testing::SaveArg;
+using ::testing::Invoke;
+using ::curve::common::COMMON_PREFIX_LENGTH;
+using ::curve::common::SEGMENTALLOCCHANGEKEYPREFIX;
 
 namespace curve {
 namespace mds {
@@ -357,15 +362,60 @@ TEST_F(TestNameServerStorageImp, test_putsegment) {
     segment.set_chunksize(16*1024*1024);
     segment.set_startoffset(0);
     segment.set_logicalpoolid(1);
-    EXPECT_CALL(*client_, PutRewithRevision(_, _, _))
-        .WillOnce(Return(EtcdErrCode::EtcdOK))
+    // segment and its alloc change are put in one transaction
+    uint16_t lid = 0;
+    int64_t change = 0;
+    EXPECT_CALL(*client_, TxnNRewithRevision(_, _))
+        .WillOnce(Invoke([&](const std::vector<Operation> &ops,
+                             int64_t *rev) {
+            EXPECT_EQ(2, ops.size());
+            EXPECT_EQ(OpType::OpPut, ops[1].opType);
+            EXPECT_EQ(SEGMENTALLOCCHANGEKEYPREFIX,
+                      std::string(ops[1].key, COMMON_PREFIX_LENGTH));
+            EXPECT_TRUE(NameSpaceStorageCodec::DecodeSegmentAllocChangeValue(
+                std::string(ops[1].value, ops[1].valueLen), &lid, &change));
+            *rev = 10;
+            return EtcdErrCode::EtcdOK;
+        }))
         .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    EXPECT_CALL(*cache_, Put(_, _)).Times(1);
     int64_t revision;
     ASSERT_EQ(StoreStatus::OK, storage_->PutSegment(0, 0, &segment, &revision));
+    ASSERT_EQ(10, revision);
+    ASSERT_EQ(1, lid);
+    ASSERT_EQ(1024*1024*1024, change);
     ASSERT_EQ(StoreStatus::InternalError,
         storage_->PutSegment(0, 0, &segment, &revision));
 }
 
+TEST_F(TestNameServerStorageImp, test_putsegments) {
+    std::vector<PageFileSegment> segments(3);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        segments[i].set_segmentsize(1024*1024*1024);
+        segments[i].set_chunksize(16*1024*1024);
+        segments[i].set_startoffset(i * 1024*1024*1024);
+        segments[i].set_logicalpoolid(1);
+    }
+
+    std::vector<Operation> ops;
+    EXPECT_CALL(*client_, TxnNRewithRevision(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&ops), SetArgPointee<1>(10),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    EXPECT_CALL(*cache_, Put(_, _)).Times(3);
+    int64_t revision = 0;
+    ASSERT_EQ(StoreStatus::OK, storage_->PutSegments(1, segments, &revision));
+    ASSERT_EQ(10, revision);
+    // three segments and one alloc change record of logical pool 1
+    ASSERT_EQ(4, ops.size());
+    for (const auto &op : ops) {
+        ASSERT_EQ(OpType::OpPut, op.opType);
+    }
+
+    ASSERT_EQ(StoreStatus::InternalError,
+        storage_->PutSegments(1, segments, &revision));
+}
+
 TEST_F(TestNameServerStorageImp, test_getSegment) {
     // 1. get err
     PageFileSegment segment;
@@ -398,13 +448,41 @@ TEST_F(TestNameServerStorageImp, test_getSegment) {
 }
 
 TEST_F(TestNameServerStorageImp, test_deleteSegment) {
-    EXPECT_CALL(*client_, DeleteRewithRevision(_, _))
-        .WillOnce(Return(EtcdErrCode::EtcdOK))
+    PageFileSegment segment;
+    segment.set_segmentsize(1024*1024*1024);
+    segment.set_chunksize(16*1024*1024);
+    segment.set_startoffset(0);
+    segment.set_logicalpoolid(1);
+
+    uint16_t lid = 0;
+    int64_t change = 0;
+    std::string storeKey = NameSpaceStorageCodec::EncodeSegmentStoreKey(0, 0);
+    EXPECT_CALL(*client_, TxnNWithCompare(_, _, _))
+        .WillOnce(Invoke([&](const std::vector<Compare> &cmps,
+                             const std::vector<Operation> &ops,
+                             int64_t *rev) {
+            // segment存在时才删除并记录变化
+            EXPECT_EQ(1, cmps.size());
+            EXPECT_EQ(CompareOp::CmpNotEqual, cmps[0].op);
+            EXPECT_EQ(storeKey, std::string(cmps[0].key, cmps[0].keyLen));
+            EXPECT_EQ(0, cmps[0].modRevision);
+            EXPECT_EQ(2, ops.size());
+            EXPECT_EQ(OpType::OpDelete, ops[0].opType);
+            EXPECT_EQ(storeKey, std::string(ops[0].key, ops[0].keyLen));
+            EXPECT_TRUE(NameSpaceStorageCodec::DecodeSegmentAllocChangeValue(
+                std::string(ops[1].value, ops[1].valueLen), &lid, &change));
+            return EtcdErrCode::EtcdOK;
+        }))
+        .WillOnce(Return(EtcdErrCode::EtcdTxnCompareFailed))
         .WillOnce(Return(EtcdErrCode::EtcdAborted));
     int64_t revision;
-    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegment(0, 0, &revision));
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegment(0, segment, &revision));
+    ASSERT_EQ(1, lid);
+    ASSERT_EQ(-1024*1024*1024, change);
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+        storage_->DeleteSegment(0, segment, &revision));
     ASSERT_EQ(StoreStatus::InternalError,
-        storage_->DeleteSegment(0, 0, &revision));
+        storage_->DeleteSegment(0, segment, &revision));
 }
 
 TEST_F(TestNameServerStorageImp, test_Snapshotfile) {
@@ -475,27 +553,41 @@ TEST_F(TestNameServerStorageImp, test_DiscardSegment) {
 }
 
 TEST_F(TestNameServerStorageImp, test_CleanDisardSegment) {
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(1);
     // delete failed
     {
-        EXPECT_CALL(*client_, DeleteRewithRevision(_, _))
+        EXPECT_CALL(*client_, TxnNWithCompare(_, _, _))
             .WillOnce(Return(EtcdErrCode::EtcdUnknown));
 
         std::string key = "fakekey";
         int64_t revision;
         ASSERT_EQ(StoreStatus::InternalError,
-                  storage_->CleanDiscardSegment(1, key, &revision));
+                  storage_->CleanDiscardSegment(segment, key, &revision));
+    }
+
+    // already deleted
+    {
+        EXPECT_CALL(*client_, TxnNWithCompare(_, _, _))
+            .WillOnce(Return(EtcdErrCode::EtcdTxnCompareFailed));
+
+        std::string key = "fakekey";
+        int64_t revision;
+        ASSERT_EQ(StoreStatus::KeyNotExist,
+                  storage_->CleanDiscardSegment(segment, key, &revision));
     }
 
     // delete ok
     {
-        EXPECT_CALL(*client_, DeleteRewithRevision(_, _))
+        EXPECT_CALL(*client_, TxnNWithCompare(_, _, _))
             .WillOnce(
-                DoAll(SetArgPointee<1>(100), Return(EtcdErrCode::EtcdOK)));
+                DoAll(SetArgPointee<2>(100), Return(EtcdErrCode::EtcdOK)));
 
         std::string key = "fakekey";
         int64_t revision;
         ASSERT_EQ(StoreStatus::OK,
-                  storage_->CleanDiscardSegment(1, key, &revision));
+                  storage_->CleanDiscardSegment(segment, key, &revision));
         ASSERT_EQ(100, revision);
     }
 }
@@ -573,5 +665,89 @@ TEST_F(TestNameServerStorageImp, test_ListDiscardSegment) {
     }
 }
 
+TEST_F(TestNameServerStorageImp, test_FileInfoCache) {
+    FileInfoCacheOption option;
+    option.capacity = 100;
+    option.shardNum = 4;
+    auto fileInfoCache = std::make_shared<FileInfoCache>(
+        option, "test_namespace_storage_fileinfo_cache");
+    storage_ = std::make_shared<NameServerStorageImp>(client_, cache_,
+                                                      fileInfoCache);
+
+    FileInfo fileinfo;
+    GetFileInfoForTest(&fileinfo);
+
+    // 1. non-existent file is cached after the first lookup
+    FileInfo getInfo;
+    EXPECT_CALL(*cache_, Get(_, _)).Times(0);
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    ASSERT_EQ(StoreStatus::KeyNotExist, storage_->GetFile(
+        fileinfo.parentid(), fileinfo.filename(), &getInfo));
+    ASSERT_EQ(StoreStatus::KeyNotExist, storage_->GetFile(
+        fileinfo.parentid(), fileinfo.filename(), &getInfo));
+
+    // 2. put file replaces the negative entry
+    EXPECT_CALL(*client_, Put(_, _)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, storage_->PutFile(fileinfo));
+    ASSERT_EQ(StoreStatus::OK, storage_->GetFile(
+        fileinfo.parentid(), fileinfo.filename(), &getInfo));
+    ASSERT_EQ(fileinfo.DebugString(), getInfo.DebugString());
+
+    // 3. rename invalidates the old name and caches the new one
+    FileInfo newFileInfo(fileinfo);
+    newFileInfo.set_filename("renamed.log");
+    EXPECT_CALL(*client_, TxnN(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, storage_->RenameFile(fileinfo, newFileInfo));
+    ASSERT_EQ(StoreStatus::OK, storage_->GetFile(
+        newFileInfo.parentid(), newFileInfo.filename(), &getInfo));
+    ASSERT_EQ(newFileInfo.DebugString(), getInfo.DebugString());
+
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    ASSERT_EQ(StoreStatus::KeyNotExist, storage_->GetFile(
+        fileinfo.parentid(), fileinfo.filename(), &getInfo));
+
+    // 4. delete invalidates the file
+    EXPECT_CALL(*client_, Delete(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteFile(
+        newFileInfo.parentid(), newFileInfo.filename()));
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    ASSERT_EQ(StoreStatus::KeyNotExist, storage_->GetFile(
+        newFileInfo.parentid(), newFileInfo.filename(), &getInfo));
+}
+
+TEST(TestFileInfoCache, test_StaleFill) {
+    FileInfoCacheOption option;
+    option.capacity = 2;
+    option.shardNum = 1;
+    FileInfoCache cache(option, "test_fileinfo_cache_stale_fill");
+
+    FileInfo fileinfo;
+    fileinfo.set_filename("file");
+    uint64_t version;
+    ASSERT_EQ(FileInfoCacheResult::kMiss, cache.Get("a", &fileinfo, &version));
+
+    // the key is updated during the lookup, result of the lookup is dropped
+    cache.Remove("a");
+    cache.Fill("a", nullptr, version);
+    ASSERT_EQ(FileInfoCacheResult::kMiss, cache.Get("a", &fileinfo, &version));
+
+    cache.Fill("a", nullptr, version);
+    ASSERT_EQ(FileInfoCacheResult::kNegativeHit,
+              cache.Get("a", &fileinfo, &version));
+    cache.Put("a", fileinfo);
+    FileInfo getInfo;
+    ASSERT_EQ(FileInfoCacheResult::kHit, cache.Get("a", &getInfo, &version));
+    ASSERT_EQ("file", getInfo.filename());
+
+    // capacity is limited
+    cache.Put("b", fileinfo);
+    cache.Put("c", fileinfo);
+    ASSERT_EQ(2, cache.Size());
+    ASSERT_EQ(FileInfoCacheResult::kMiss, cache.Get("a", &getInfo, &version));
+}
+
 }  // namespace mds
 }  // namespace curve
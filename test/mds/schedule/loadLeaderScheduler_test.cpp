@@ -0,0 +1,246 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <sys/time.h>
+#include "src/mds/schedule/scheduler.h"
+#include "src/mds/schedule/scheduleMetrics.h"
+#include "test/mds/schedule/mock_topoAdapter.h"
+#include "test/mds/mock/mock_topology.h"
+#include "test/mds/schedule/common.h"
+
+using ::curve::mds::topology::MockTopology;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+
+namespace curve {
+namespace mds {
+namespace schedule {
+class TestLoadLeaderSchedule : public ::testing::Test {
+ protected:
+    TestLoadLeaderSchedule() {}
+    ~TestLoadLeaderSchedule() {}
+
+    void SetUp() override {
+        auto topo = std::make_shared<MockTopology>();
+        auto metric = std::make_shared<ScheduleMetrics>(topo);
+        opController_ = std::make_shared<OperatorController>(2, metric);
+        topoAdapter_ = std::make_shared<MockTopoAdapter>();
+
+        opt_.transferLeaderTimeLimitSec = 10;
+        opt_.removePeerTimeLimitSec = 100;
+        opt_.addPeerTimeLimitSec = 1000;
+        opt_.changePeerTimeLimitSec = 1000;
+        opt_.scatterWithRangePerent = 0.2;
+        opt_.chunkserverCoolingTimeSec = 0;
+        opt_.loadLeaderSchedulerIntervalSec = 1;
+        opt_.loadLeaderHighPercent = 0.3;
+        opt_.loadLeaderLowPercent = 0.1;
+        opt_.loadLeaderTransferPerRound = 10;
+        opt_.loadLeaderBytesPerIO = 100;
+
+        // chunkserver1~4, all online
+        struct timeval tm;
+        gettimeofday(&tm, NULL);
+        for (int i = 1; i <= 4; i++) {
+            PeerInfo peer(i, i, i, "192.168.10." + std::to_string(i), 9000);
+            ChunkServerInfo csInfo(peer, OnlineState::ONLINE,
+                DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                1, 100, 10, ChunkServerStatisticInfo{});
+            csInfo.startUpTime = tm.tv_sec - 2;
+            peers_.emplace_back(peer);
+            csInfos_.emplace_back(csInfo);
+        }
+    }
+
+    void TearDown() override {
+        topoAdapter_ = nullptr;
+        opController_ = nullptr;
+    }
+
+    CopySetInfo MakeCopySet(CopySetIdType id, ChunkServerIdType leader,
+        const std::vector<ChunkServerIdType> &peerIds) {
+        std::vector<PeerInfo> peers;
+        for (auto peerId : peerIds) {
+            peers.emplace_back(peers_[peerId - 1]);
+        }
+        return CopySetInfo(CopySetKey{1, id}, 1, leader, peers,
+            ConfigChangeInfo{}, CopysetStatistics{});
+    }
+
+    CopysetStatistics MakeStat(uint32_t iops, uint32_t bps) {
+        CopysetStatistics stat;
+        stat.set_readiops(iops);
+        stat.set_writeiops(0);
+        stat.set_readrate(0);
+        stat.set_writerate(bps);
+        return stat;
+    }
+
+    // set the leader copysets and their IO statistics reported by heartbeat
+    void SetUpTopo(const std::vector<CopySetInfo> &copysets,
+        const std::map<CopySetKey, CopysetStatistics> &stats) {
+        std::map<ChunkServerIdType,
+            std::map<CopySetKey, CopysetStatistics>> leaderStats;
+        for (auto &info : csInfos_) {
+            leaderStats[info.info.id];
+        }
+        for (auto &copyset : copysets) {
+            leaderStats[copyset.leader][copyset.id] = stats.at(copyset.id);
+        }
+
+        EXPECT_CALL(*topoAdapter_, GetLogicalpools())
+            .WillRepeatedly(Return(std::vector<PoolIdType>({1})));
+        EXPECT_CALL(*topoAdapter_, GetChunkServersInLogicalPool(1))
+            .WillRepeatedly(Return(csInfos_));
+        EXPECT_CALL(*topoAdapter_, GetCopySetInfosInLogicalPool(1))
+            .WillRepeatedly(Return(copysets));
+        for (auto &info : csInfos_) {
+            EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(info.info.id, _))
+                .WillRepeatedly(DoAll(SetArgPointee<1>(info), Return(true)));
+            EXPECT_CALL(*topoAdapter_,
+                GetLeaderCopySetStatistics(info.info.id, _))
+                .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(leaderStats[info.info.id]),
+                    Return(true)));
+        }
+    }
+
+    void CheckTransferTarget(const CopySetKey &key, ChunkServerIdType target) {
+        Operator op;
+        ASSERT_TRUE(opController_->GetOperatorById(key, &op));
+        ASSERT_EQ(OperatorPriority::NormalPriority, op.priority);
+        ASSERT_EQ(std::chrono::seconds(10), op.timeLimit);
+        TransferLeader *res = dynamic_cast<TransferLeader *>(op.step.get());
+        ASSERT_TRUE(res != nullptr);
+        ASSERT_EQ(target, res->GetTargetPeer());
+    }
+
+ protected:
+    std::shared_ptr<MockTopoAdapter> topoAdapter_;
+    std::shared_ptr<OperatorController> opController_;
+    ScheduleOption opt_;
+    std::vector<PeerInfo> peers_;
+    std::vector<ChunkServerInfo> csInfos_;
+};
+
+TEST_F(TestLoadLeaderSchedule, test_load_balanced) {
+    // the load of every chunkserver is close to the average
+    auto copySet1 = MakeCopySet(1, 1, {1, 2, 3});
+    auto copySet2 = MakeCopySet(2, 2, {2, 3, 4});
+    auto copySet3 = MakeCopySet(3, 3, {3, 4, 1});
+    auto copySet4 = MakeCopySet(4, 4, {4, 1, 2});
+    SetUpTopo({copySet1, copySet2, copySet3, copySet4}, {
+        {copySet1.id, MakeStat(100, 0)},
+        {copySet2.id, MakeStat(110, 0)},
+        {copySet3.id, MakeStat(90, 0)},
+        {copySet4.id, MakeStat(50, 5000)}});
+
+    LoadLeaderScheduler scheduler(opt_, topoAdapter_, opController_);
+    ASSERT_EQ(0, scheduler.Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
+TEST_F(TestLoadLeaderSchedule, test_transfer_leader_off_hot_chunkserver) {
+    // chunkserver1 is the leader of copyset1~3 with load 450, the average
+    // load is 125, high threshold 162.5, low threshold 137.5
+    auto copySet1 = MakeCopySet(1, 1, {1, 2, 3});
+    auto copySet2 = MakeCopySet(2, 1, {1, 3, 4});
+    auto copySet3 = MakeCopySet(3, 1, {1, 2, 4});
+    auto copySet4 = MakeCopySet(4, 2, {2, 3, 4});
+    std::vector<CopySetInfo> copysets(
+        {copySet1, copySet2, copySet3, copySet4});
+    std::map<CopySetKey, CopysetStatistics> stats({
+        {copySet1.id, MakeStat(300, 0)},
+        {copySet2.id, MakeStat(50, 5000)},
+        {copySet3.id, MakeStat(50, 0)},
+        {copySet4.id, MakeStat(50, 0)}});
+
+    // copyset1 is too hot to move, otherwise chunkserver3 becomes hot
+    {
+        SetUpTopo(copysets, stats);
+        LoadLeaderScheduler scheduler(opt_, topoAdapter_, opController_);
+        ASSERT_EQ(2, scheduler.Schedule());
+        ASSERT_EQ(2, opController_->GetOperators().size());
+        CheckTransferTarget(copySet2.id, 3);
+        CheckTransferTarget(copySet3.id, 4);
+    }
+
+    // at most loadLeaderTransferPerRound operators in one round
+    {
+        opController_->RemoveOperator(copySet2.id);
+        opController_->RemoveOperator(copySet3.id);
+        opt_.loadLeaderTransferPerRound = 1;
+        LoadLeaderScheduler scheduler(opt_, topoAdapter_, opController_);
+        ASSERT_EQ(1, scheduler.Schedule());
+        ASSERT_EQ(1, opController_->GetOperators().size());
+        CheckTransferTarget(copySet2.id, 3);
+    }
+}
+
+TEST_F(TestLoadLeaderSchedule, test_hysteresis) {
+    LoadLeaderScheduler scheduler(opt_, topoAdapter_, opController_);
+
+    // round 1: chunkserver1 exceeds the high threshold and becomes hot
+    auto copySet1 = MakeCopySet(1, 1, {1, 2, 3});
+    auto copySet2 = MakeCopySet(2, 1, {1, 3, 4});
+    auto copySet3 = MakeCopySet(3, 2, {2, 3, 4});
+    SetUpTopo({copySet1, copySet2, copySet3}, {
+        {copySet1.id, MakeStat(300, 0)},
+        {copySet2.id, MakeStat(100, 0)},
+        {copySet3.id, MakeStat(100, 0)}});
+    ASSERT_EQ(1, scheduler.Schedule());
+    CheckTransferTarget(copySet2.id, 3);
+    opController_->RemoveOperator(copySet2.id);
+
+    // round 2: average 100, high threshold 130, low threshold 110.
+    // chunkserver1 and chunkserver2 both have load 120, only chunkserver1
+    // which is still hot from the last round transfers leader out
+    auto copySet4 = MakeCopySet(4, 1, {1, 2, 3});
+    auto copySet5 = MakeCopySet(5, 1, {1, 3, 4});
+    auto copySet6 = MakeCopySet(6, 2, {2, 3, 4});
+    auto copySet7 = MakeCopySet(7, 2, {2, 1, 3});
+    auto copySet8 = MakeCopySet(8, 3, {3, 4, 1});
+    auto copySet9 = MakeCopySet(9, 4, {4, 1, 2});
+    ::testing::Mock::VerifyAndClearExpectations(topoAdapter_.get());
+    SetUpTopo({copySet4, copySet5, copySet6, copySet7, copySet8, copySet9}, {
+        {copySet4.id, MakeStat(100, 0)},
+        {copySet5.id, MakeStat(20, 0)},
+        {copySet6.id, MakeStat(100, 0)},
+        {copySet7.id, MakeStat(20, 0)},
+        {copySet8.id, MakeStat(60, 0)},
+        {copySet9.id, MakeStat(100, 0)}});
+    ASSERT_EQ(1, scheduler.Schedule());
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    CheckTransferTarget(copySet5.id, 3);
+
+    // round 3: chunkserver1 drops below the low threshold and is no longer
+    // hot, load 120 does not trigger transfer again
+    opController_->RemoveOperator(copySet5.id);
+    ASSERT_EQ(0, scheduler.Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
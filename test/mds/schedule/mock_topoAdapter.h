@@ -78,6 +78,10 @@ class MockTopoAdapter : public TopoAdapter {
 
     MOCK_METHOD1(GetChunkServersInLogicalPool,
         std::vector<ChunkServerInfo>(PoolIdType));
+
+    MOCK_METHOD2(GetLeaderCopySetStatistics,
+        bool(ChunkServerIdType id,
+            std::map<CopySetKey, CopysetStatistics> *out));
 };
 }  // namespace schedule
 }  // namespace mds
@@ -332,6 +332,99 @@ TEST_F(TestRecoverSheduler, test_all_chunkServer_online_offline) {
         ASSERT_EQ(0, opController_->GetOperators().size());
     }
 }
+
+TEST_F(TestRecoverSheduler, test_recover_source_concurrent) {
+    // copyset1和copyset2的leader都是chunkserver1, copyset2正在恢复中,
+    // copyset1的副本3 offline
+    auto copySet1 = GetCopySetInfoForTest();
+    PeerInfo peer4(4, 4, 4, "192.168.10.4", 9000);
+    CopySetInfo copySet2(CopySetKey{1, 2}, 1, 1,
+        std::vector<PeerInfo>({copySet1.peers[0], copySet1.peers[1], peer4}),
+        ConfigChangeInfo{}, CopysetStatistics{});
+    Operator recoverOp(1, copySet2.id, OperatorPriority::HighPriority,
+        steady_clock::now(), std::make_shared<ChangePeer>(4, 5));
+    ASSERT_TRUE(opController_->AddOperator(recoverOp));
+
+    ChunkServerInfo csInfo1(copySet1.peers[0], OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo2(copySet1.peers[1], OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo3(copySet1.peers[2], OnlineState::OFFLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo4(peer4, OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    std::vector<ChunkServerInfo> chunkserverList(
+        {csInfo1, csInfo2, csInfo3, csInfo4});
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos())
+        .WillRepeatedly(Return(std::vector<CopySetInfo>({copySet1, copySet2})));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySet2.id, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copySet2), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+        .WillRepeatedly(Return(chunkserverList));
+    EXPECT_CALL(*topoAdapter_, GetChunkServersInLogicalPool(_))
+        .WillRepeatedly(Return(chunkserverList));
+    for (auto &info : chunkserverList) {
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(info.info.id, _))
+            .WillRepeatedly(DoAll(SetArgPointee<1>(info), Return(true)));
+    }
+    EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+        .WillRepeatedly(Return(3));
+    EXPECT_CALL(*topoAdapter_, GetStandardZoneNumInLogicalPool(_))
+        .WillRepeatedly(Return(3));
+    EXPECT_CALL(*topoAdapter_, GetAvgScatterWidthInLogicalPool(_))
+        .WillRepeatedly(Return(90));
+    std::map<ChunkServerIdType, int> map1{{3, 1}};
+    EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(1, _))
+        .WillRepeatedly(SetArgPointee<1>(map1));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(2, _))
+        .WillRepeatedly(SetArgPointee<1>(map1));
+    std::map<ChunkServerIdType, int> map3{{1, 1}};
+    EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(3, _))
+        .WillRepeatedly(SetArgPointee<1>(map3));
+    std::map<ChunkServerIdType, int> map4;
+    EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(4, _))
+        .WillRepeatedly(SetArgPointee<1>(map4));
+
+    ScheduleOption opt;
+    opt.transferLeaderTimeLimitSec = 10;
+    opt.removePeerTimeLimitSec = 100;
+    opt.addPeerTimeLimitSec = 1000;
+    opt.changePeerTimeLimitSec = 1000;
+    opt.recoverSchedulerIntervalSec = 1;
+    opt.scatterWithRangePerent = 0.2;
+    opt.chunkserverFailureTolerance = 3;
+    Operator op;
+    {
+        // 1. leader上恢复的数量达到上限, 先把leader迁移到空闲的follower
+        opt.recoverSourceConcurrent = 1;
+        RecoverScheduler scheduler(opt, topoAdapter_, opController_);
+        EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, _))
+            .Times(0);
+        scheduler.Schedule();
+        ASSERT_TRUE(opController_->GetOperatorById(copySet1.id, &op));
+        ASSERT_TRUE(dynamic_cast<TransferLeader *>(op.step.get()) != nullptr);
+        ASSERT_EQ(2, op.step->GetTargetPeer());
+        ASSERT_EQ(OperatorPriority::HighPriority, op.priority);
+        ASSERT_EQ(std::chrono::seconds(10), op.timeLimit);
+    }
+
+    {
+        // 2. leader上恢复的数量未达到上限, 直接从leader恢复
+        opController_->RemoveOperator(copySet1.id);
+        opt.recoverSourceConcurrent = 2;
+        RecoverScheduler scheduler(opt, topoAdapter_, opController_);
+        EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, _))
+            .WillOnce(Return(true));
+        scheduler.Schedule();
+        ASSERT_TRUE(opController_->GetOperatorById(copySet1.id, &op));
+        ASSERT_TRUE(dynamic_cast<ChangePeer *>(op.step.get()) != nullptr);
+        ASSERT_EQ(4, op.step->GetTargetPeer());
+    }
+}
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
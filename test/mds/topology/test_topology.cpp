@@ -2926,6 +2926,59 @@ TEST_F(TestTopology, GetCopySetsInChunkServer_success) {
     ASSERT_EQ(1, csList.size());
 }
 
+TEST_F(TestTopology, GetCopySetsInChunkServer_AfterMembersChanged) {
+    PrepareAddPoolset();
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(
+        0x31, "server1", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x21, 0x11);
+    PrepareAddServer(
+        0x32, "server2", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x22, 0x11);
+    PrepareAddServer(
+        0x33, "server3", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x23, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x32, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId);
+
+    // copysets are spread over shards, results are still ordered by key
+    std::set<ChunkServerIdType> replicas{0x41, 0x42, 0x43};
+    for (CopySetIdType id = 1; id <= 100; ++id) {
+        PrepareAddCopySet(id, logicalPoolId, replicas);
+    }
+
+    std::vector<CopySetKey> csList =
+        topology_->GetCopySetsInChunkServer(0x43);
+    ASSERT_EQ(100, csList.size());
+    for (CopySetIdType id = 1; id <= 100; ++id) {
+        ASSERT_EQ(CopySetKey(logicalPoolId, id), csList[id - 1]);
+    }
+    ASSERT_TRUE(topology_->GetCopySetsInChunkServer(0x44).empty());
+
+    // 0x43 is replaced by 0x44 in copyset 10
+    CopySetInfo csInfo(logicalPoolId, 10);
+    csInfo.SetCopySetMembers({0x41, 0x42, 0x44});
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(csInfo));
+
+    ASSERT_EQ(99, topology_->GetCopySetsInChunkServer(0x43).size());
+    csList = topology_->GetCopySetsInChunkServer(0x44);
+    ASSERT_EQ(1, csList.size());
+    ASSERT_EQ(CopySetKey(logicalPoolId, 10), csList[0]);
+
+    EXPECT_CALL(*storage_, DeleteCopySet(_))
+        .WillOnce(Return(true));
+    ASSERT_EQ(kTopoErrCodeSuccess,
+        topology_->RemoveCopySet(CopySetKey(logicalPoolId, 10)));
+    ASSERT_TRUE(topology_->GetCopySetsInChunkServer(0x44).empty());
+    ASSERT_EQ(99, topology_->GetCopySetsInChunkServer(0x41).size());
+}
+
 TEST_F(TestTopology, test_create_default_poolset) {
     EXPECT_CALL(*storage_, LoadClusterInfo(_))
         .WillOnce(Return(true));
@@ -572,6 +572,68 @@ TEST_F(TestTopologyChunkAllocator,
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestTopologyChunkAllocator,
+    Test_AllocateChunkRoundRobinInSingleLogicalPool_loadAware) {
+    TopologyOption option;
+    option.PoolUsagePercentLimit = 85;
+    option.enableLogicalPoolStatus = true;
+    option.chooseCopysetPolicy =
+        static_cast<int>(ChooseCopysetPolicy::kLoadAware);
+    testObj_ = std::make_shared<TopologyChunkAllocatorImpl>(topology_,
+        allocStatistic_, topoStat_, chunkFilePoolAllocHelp_, option);
+
+    std::vector<CopysetIdInfo> infos;
+    PrepareAddPoolset();
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", "127.0.0.1", 0x21, 0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", "127.0.0.1", 0x22, 0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", "127.0.0.1", 0x23, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x32, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x31, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x45, "token5", "nvme", 0x32, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x46, "token6", "nvme", 0x33, "127.0.0.1", 8201);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId,
+        PAGEFILE);
+    PrepareAddCopySet(0x51, logicalPoolId, {0x41, 0x42, 0x43});
+    PrepareAddCopySet(0x52, logicalPoolId, {0x44, 0x45, 0x46});
+
+    // chunkserver 0x41 is busy
+    ChunkServerStat stat;
+    stat.chunkFilepoolSize = 512;
+    stat.leaderCount = 10;
+    stat.readIOPS = 10000;
+    stat.writeRate = 10000;
+    topoStat_->UpdateChunkServerStat(0x41, stat);
+
+    EXPECT_CALL(*allocStatistic_, GetAllocByLogicalPool(_, _))
+        .WillRepeatedly(Return(true));
+
+    bool ret =
+        testObj_->AllocateChunkRoundRobinInSingleLogicalPool(INODE_PAGEFILE,
+            "testPoolset",
+            1000,
+            1,
+            &infos);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(1000, infos.size());
+
+    std::map<CopySetIdType, int> copysetMap;
+    for (const auto &info : infos) {
+        ASSERT_EQ(logicalPoolId, info.logicalPoolId);
+        copysetMap[info.copySetId]++;
+    }
+    // the busy copyset is chosen only if it is sampled twice
+    ASSERT_GT(copysetMap[0x52], copysetMap[0x51]);
+}
+
 TEST(TestAllocateChunkPolicy, TestAllocateChunkRandomInSingleLogicalPoolPoc) {
     // 2000个copyset分配100000次，每次分配64个chunk
     std::vector<CopySetIdType> copySetIds;
@@ -698,6 +760,55 @@ TEST(TestAllocateChunkPolicy,
     ASSERT_EQ(0, infos.size());
 }
 
+TEST(TestAllocateChunkPolicy, TestAllocateChunkByLoadInSingleLogicalPool) {
+    std::vector<CopySetIdType> copySetIds{0, 1, 2, 3};
+    std::vector<CopysetIdInfo> infos;
+
+    // 1. copyset为空或者获取负载失败
+    CopysetLoadGetter failGetter = [](CopySetIdType, CopysetLoad *) {
+        return false;
+    };
+    ASSERT_FALSE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        {}, 1, 10, 1024, failGetter, &infos));
+    ASSERT_FALSE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        copySetIds, 1, 10, 1024, failGetter, &infos));
+
+    // 2. copyset 0磁盘使用率高, 只有两次都选中它时才会分配
+    CopysetLoadGetter getter = [](CopySetIdType id, CopysetLoad *load) {
+        load->diskUsage = (id == 0) ? 0.9 : 0.1;
+        load->diskCapacity = 1024L * 1024 * 1024 * 1024;
+        return true;
+    };
+    const uint32_t chunkNumber = 10000;
+    ASSERT_TRUE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        copySetIds, 1, chunkNumber, 16 * 1024 * 1024, getter, &infos));
+    ASSERT_EQ(chunkNumber, infos.size());
+    std::map<CopySetIdType, int> copySetMap;
+    for (const auto &info : infos) {
+        ASSERT_EQ(1, info.logicalPoolId);
+        copySetMap[info.copySetId]++;
+    }
+    for (CopySetIdType id = 1; id < copySetIds.size(); id++) {
+        ASSERT_GT(copySetMap[id], copySetMap[0]);
+    }
+
+    // 3. 本轮分配的chunk计入磁盘使用率, 两个copyset的使用率逐渐拉平
+    getter = [](CopySetIdType id, CopysetLoad *load) {
+        load->diskUsage = (id == 0) ? 0 : 0.5;
+        load->diskCapacity = 1024;
+        return true;
+    };
+    ASSERT_TRUE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        {0, 1}, 1, 1000, 64, getter, &infos));
+    copySetMap.clear();
+    for (const auto &info : infos) {
+        copySetMap[info.copySetId]++;
+    }
+    // 不计入时copyset 0大约分到750个
+    ASSERT_LT(copySetMap[0], 600);
+    ASSERT_GT(copySetMap[1], 400);
+}
+
 TEST(TestAllocateChunkPolicy,
     TestChooseSingleLogicalPoolByWeightPoc) {
     std::map<PoolIdType, double> poolWeightMap;
@@ -108,6 +108,16 @@ class MockSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
         int(const std::string &fileName, std::vector<CloneInfo> *list));
     MOCK_METHOD1(GetCloneInfoList,
         int(std::vector<CloneInfo> *list));
+    MOCK_METHOD2(RefSnapshotBlock,
+        int(const std::string &blockKey, uint64_t *refCount));
+    MOCK_METHOD2(UnrefSnapshotBlock,
+        int(const std::string &blockKey, uint64_t *refCount));
+    MOCK_METHOD2(RefSnapshotBlocks,
+        int(const std::vector<std::string> &blockKeys,
+            std::vector<uint64_t> *refCounts));
+    MOCK_METHOD2(UnrefSnapshotBlocks,
+        int(const std::vector<std::string> &blockKeys,
+            std::vector<uint64_t> *refCounts));
 };
 
 class MockSnapshotDataStore : public SnapshotDataStore {
@@ -149,6 +159,19 @@ class MockSnapshotDataStore : public SnapshotDataStore {
     MOCK_METHOD2(DataChunkTranferAbort,
         int(const ChunkDataName &name,
              std::shared_ptr<TransferTask> task));
+    MOCK_METHOD2(PutChunkBlockMap,
+        int(const ChunkDataName &name,
+            const ChunkBlockMap &blockMap));
+    MOCK_METHOD2(GetChunkBlockMap,
+        int(const ChunkDataName &name,
+            ChunkBlockMap *blockMap));
+    MOCK_METHOD2(PutDataBlock,
+        int(const std::string &key,
+            const std::string &data));
+    MOCK_METHOD1(DeleteDataBlock,
+        int(const std::string &key));
+    MOCK_METHOD1(DataBlockExist,
+        bool(const std::string &key));
 };
 
 class MockCurveFsClient : public CurveFsClient {
@@ -221,6 +244,18 @@ class MockCurveFsClient : public CurveFsClient {
         uint64_t len,
         SnapCloneClosure* scc));
 
+    MOCK_METHOD4(CreateCloneChunks,
+        int(LogicPoolID logicPoolId,
+        CopysetID copysetId,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure* scc));
+
+    MOCK_METHOD4(RecoverChunks,
+        int(LogicPoolID logicPoolId,
+        CopysetID copysetId,
+        const std::vector<CloneChunkItem> &chunks,
+        SnapCloneClosure* scc));
+
     MOCK_METHOD2(CompleteCloneMeta,
         int(const std::string &filename,
         const std::string &user));
@@ -433,8 +468,14 @@ class MockKVStorageClient : public KVStorageClient {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNRewithRevision,
+        int(const std::vector<Operation>&, int64_t *));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
+    MOCK_METHOD3(GetWithModRevision,
+        int(const std::string&, std::string*, int64_t*));
+    MOCK_METHOD3(TxnNWithCompare, int(const std::vector<Compare>&,
+        const std::vector<Operation>&, int64_t*));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
         uint32_t, uint32_t, uint64_t*));
     MOCK_METHOD2(LeaderObserve, int(uint64_t, const std::string&));
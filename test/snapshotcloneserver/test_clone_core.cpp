@@ -99,6 +99,10 @@ class TestCloneCoreImpl : public ::testing::Test {
     void MockCloneMetaSuccess(
         std::shared_ptr<CloneTaskInfo> task);
 
+    // 所有chunk在同一个copyset上
+    void MockCloneMetaInOneCopysetSuccess(
+        std::shared_ptr<CloneTaskInfo> task);
+
     void MockCreateCloneChunkSuccess(
         std::shared_ptr<CloneTaskInfo> task);
 
@@ -704,6 +708,58 @@ TEST_F(TestCloneCoreImpl,
     core_->HandleCloneOrRecoverTask(task);
 }
 
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage1SuccessForCloneByLocalSnapshot) {
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", kDefaultPoolset, CloneFileType::kSnapshot, true);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    // 快照数据存储在local时，chunkserver从挂载的目录读取
+    option.snapshotDataStoreLocal = true;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCreateCloneFileSuccess(task);
+    MockCloneMetaSuccess(task);
+    MockCompleteCloneMetaSuccess(task);
+    MockChangeOwnerSuccess(task);
+    MockRenameCloneFileSuccess(task);
+
+    std::string location1 = LocationOperator::GenerateLocalLocation(
+        "file1-0-1");
+    std::string location2 = LocationOperator::GenerateLocalLocation(
+        "file1-1-1");
+    EXPECT_CALL(*client_, CreateCloneChunk(
+         AnyOf(location1, location2), _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([](const std::string &location,
+                      const ChunkIDInfo &chunkidinfo,
+                      uint64_t sn,
+                      uint64_t csn,
+                      uint64_t chunkSize,
+                      SnapCloneClosure* scc){
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::metaInstalled, task->GetCloneInfo().GetStatus());
+}
+
 TEST_F(TestCloneCoreImpl,
     HandleCloneOrRecoverTaskStage2SuccessForCloneBySnapshot) {
     CloneInfo info("id1", "user1", CloneTaskType::kClone, "snapid1", "file1",
@@ -751,6 +807,183 @@ TEST_F(TestCloneCoreImpl,
     core_->HandleCloneOrRecoverTask(task);
 }
 
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskSuccessForCloneBySnapshotWithBatch) {
+    CloneInfo info("id1", "user1", CloneTaskType::kClone, "snapid1", "file1",
+                   kDefaultPoolset, CloneFileType::kSnapshot, false);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    option.cloneChunkBatchSize = 2;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCreateCloneFileSuccess(task);
+    MockCloneMetaInOneCopysetSuccess(task);
+    MockCompleteCloneMetaSuccess(task);
+    MockCompleteCloneFileSuccess(task);
+    MockChangeOwnerSuccess(task);
+    MockRenameCloneFileSuccess(task);
+
+    // 同一copyset上的2个chunk一次请求创建，chunk 2已存在
+    EXPECT_CALL(*client_, CreateCloneChunks(1, 1, _, _))
+        .WillOnce(DoAll(
+            Invoke([](LogicPoolID lpid,
+                      CopysetID cpid,
+                      const std::vector<CloneChunkItem> &chunks,
+                      SnapCloneClosure* scc){
+                    EXPECT_EQ(2, chunks.size());
+                    EXPECT_EQ(1, chunks[0].chunkId);
+                    EXPECT_EQ(2, chunks[1].chunkId);
+                    scc->GetExistChunks()->push_back(2);
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*client_, CreateCloneChunk(_, _, _, _, _, _))
+        .Times(0);
+
+    // 已存在的chunk不需要恢复，只剩一个chunk时不走批量接口
+    EXPECT_CALL(*client_, RecoverChunks(_, _, _, _))
+        .Times(0);
+    EXPECT_CALL(*client_, RecoverChunk(_, _, _, _))
+        .WillOnce(DoAll(
+                    Invoke([](const ChunkIDInfo &chunkidinfo,
+                              uint64_t offset,
+                              uint64_t len,
+                              SnapCloneClosure* scc){
+                        EXPECT_EQ(1, chunkidinfo.cid_);
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+}
+
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage1CreateCloneChunksNotSupport) {
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", kDefaultPoolset, CloneFileType::kSnapshot, true);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    option.cloneChunkBatchSize = 2;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCreateCloneFileSuccess(task);
+    MockCloneMetaInOneCopysetSuccess(task);
+    MockCompleteCloneMetaSuccess(task);
+    MockChangeOwnerSuccess(task);
+    MockRenameCloneFileSuccess(task);
+
+    // 老版本的chunkserver不支持批量接口，退回逐个chunk创建
+    EXPECT_CALL(*client_, CreateCloneChunks(1, 1, _, _))
+        .WillOnce(DoAll(
+            Invoke([](LogicPoolID lpid,
+                      CopysetID cpid,
+                      const std::vector<CloneChunkItem> &chunks,
+                      SnapCloneClosure* scc){
+                    scc->SetRetCode(-LIBCURVE_ERROR::NOT_SUPPORT);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*client_, CreateCloneChunk(_, _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([](const std::string &location,
+                      const ChunkIDInfo &chunkidinfo,
+                      uint64_t sn,
+                      uint64_t csn,
+                      uint64_t chunkSize,
+                      SnapCloneClosure* scc){
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::metaInstalled, task->GetCloneInfo().GetStatus());
+}
+
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage2RecoverChunksNotSupport) {
+    CloneInfo info("id1", "user1", CloneTaskType::kClone, "snapid1", "file1",
+                   kDefaultPoolset, 1, 2, 100, CloneFileType::kSnapshot, true,
+                   CloneStep::kRecoverChunk, CloneStatus::cloning);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    option.cloneChunkBatchSize = 2;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCloneMetaInOneCopysetSuccess(task);
+    MockCompleteCloneFileSuccess(task);
+
+    // 老版本的chunkserver不支持批量接口，退回逐个chunk恢复
+    EXPECT_CALL(*client_, RecoverChunks(1, 1, _, _))
+        .WillOnce(DoAll(
+            Invoke([](LogicPoolID lpid,
+                      CopysetID cpid,
+                      const std::vector<CloneChunkItem> &chunks,
+                      SnapCloneClosure* scc){
+                    EXPECT_EQ(2, chunks.size());
+                    scc->SetRetCode(-LIBCURVE_ERROR::NOT_SUPPORT);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*client_, RecoverChunk(_, _, _, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+                    Invoke([](const ChunkIDInfo &chunkidinfo,
+                              uint64_t offset,
+                              uint64_t len,
+                              SnapCloneClosure* scc){
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+}
+
 TEST_F(TestCloneCoreImpl,
     HandleCloneOrRecoverTaskFailOnBuildFileInfoFromSnapshot) {
     CloneInfo info("id1", "user1", CloneTaskType::kClone,
@@ -1248,6 +1481,24 @@ void TestCloneCoreImpl::MockCloneMetaSuccess(
                 Return(LIBCURVE_ERROR::OK)));
 }
 
+void TestCloneCoreImpl::MockCloneMetaInOneCopysetSuccess(
+    std::shared_ptr<CloneTaskInfo> task) {
+    uint32_t chunksize = 1024 * 1024;
+    uint64_t segmentsize = 2 * chunksize;
+    SegmentInfo segInfoOut;
+    segInfoOut.segmentsize = segmentsize;
+    segInfoOut.chunksize = chunksize;
+    segInfoOut.startoffset = 0;
+    segInfoOut.chunkvec = {{1, 1, 1},
+                           {2, 1, 1}};
+    segInfoOut.lpcpIDInfo.lpid = 1;
+    segInfoOut.lpcpIDInfo.cpidVec = {1};
+    EXPECT_CALL(*client_, GetOrAllocateSegmentInfo(_, 0, _, _, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<4>(segInfoOut),
+                Return(LIBCURVE_ERROR::OK)));
+}
+
 void TestCloneCoreImpl::MockCreateCloneChunkSuccess(
     std::shared_ptr<CloneTaskInfo> task) {
     std::string location1, location2;
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/snapshotcloneserver/clone/recover_chunk_scheduler.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+static std::vector<ChunkID> PopAll(RecoverChunkScheduler *scheduler) {
+    std::vector<ChunkID> order;
+    ChunkIDInfo cidInfo;
+    while (scheduler->NextChunk(&cidInfo)) {
+        order.push_back(cidInfo.cid_);
+    }
+    return order;
+}
+
+TEST(TestRecoverChunkScheduler, TestRecoverOrder) {
+    RecoverChunkScheduler scheduler(4, 1, 1000);
+    for (ChunkID id = 1; id <= 8; id++) {
+        scheduler.AddChunk(ChunkIDInfo(id, 1, 1));
+    }
+    ASSERT_EQ(8, scheduler.GetChunkNum());
+
+    ChunkIDInfo cidInfo;
+    ASSERT_TRUE(scheduler.NextChunk(&cidInfo));
+    ASSERT_EQ(1, cidInfo.cid_);
+
+    // 读穿透的chunk和其后的chunk提前恢复，
+    // 已开始恢复的chunk只提前其后的chunk，其他文件的chunk忽略
+    scheduler.PromoteHotChunks({6, 1, 100});
+    ASSERT_TRUE(scheduler.NextChunk(&cidInfo));
+    ASSERT_EQ(6, cidInfo.cid_);
+    // 已在排队的chunk不重复排队
+    scheduler.PromoteHotChunks({7});
+    ASSERT_EQ(std::vector<ChunkID>({7, 2, 8, 3, 4, 5}), PopAll(&scheduler));
+    ASSERT_FALSE(scheduler.HasPendingChunk());
+    ASSERT_EQ(8, scheduler.GetStartedNum());
+}
+
+TEST(TestRecoverChunkScheduler, TestNextChunkInCopyset) {
+    RecoverChunkScheduler scheduler(4, 0, 1000);
+    for (ChunkID id = 1; id <= 6; id++) {
+        scheduler.AddChunk(ChunkIDInfo(id, 1, id % 2 + 1));
+    }
+
+    // 按文件中的顺序取同一copyset上未开始恢复的chunk
+    ChunkIDInfo cidInfo;
+    ASSERT_TRUE(scheduler.NextChunk(&cidInfo));
+    ASSERT_EQ(1, cidInfo.cid_);
+    ASSERT_TRUE(scheduler.NextChunkInCopyset(&cidInfo));
+    ASSERT_EQ(3, cidInfo.cid_);
+    ASSERT_EQ(2, cidInfo.cpid_);
+
+    // 已开始恢复的chunk跳过
+    scheduler.PromoteHotChunks({5});
+    ASSERT_TRUE(scheduler.NextChunk(&cidInfo));
+    ASSERT_EQ(5, cidInfo.cid_);
+    ASSERT_FALSE(scheduler.NextChunkInCopyset(&cidInfo));
+
+    ChunkIDInfo other(0, 1, 1);
+    ASSERT_TRUE(scheduler.NextChunkInCopyset(&other));
+    ASSERT_EQ(2, other.cid_);
+    ASSERT_EQ(std::vector<ChunkID>({4, 6}), PopAll(&scheduler));
+    ASSERT_FALSE(scheduler.NextChunkInCopyset(&other));
+}
+
+TEST(TestRecoverChunkScheduler, TestAdjustConcurrency) {
+    RecoverChunkScheduler scheduler(4, 0, 1000);
+    ASSERT_EQ(4, scheduler.GetConcurrency());
+
+    // 慢请求使并发数减半，同一轮内的慢请求不再减少
+    for (int i = 0; i < 4; i++) {
+        scheduler.OnPartDone(true, 10);
+    }
+    scheduler.OnPartDone(true, 2000);
+    ASSERT_EQ(2, scheduler.GetConcurrency());
+    scheduler.OnPartDone(false, 10);
+    ASSERT_EQ(2, scheduler.GetConcurrency());
+    scheduler.OnPartDone(false, 10);
+    ASSERT_EQ(1, scheduler.GetConcurrency());
+    scheduler.OnPartDone(false, 10);
+    ASSERT_EQ(1, scheduler.GetConcurrency());
+
+    // 正常的请求使并发数逐步恢复，不超过上限
+    for (int i = 0; i < 20; i++) {
+        scheduler.OnPartDone(true, 10);
+    }
+    ASSERT_EQ(4, scheduler.GetConcurrency());
+
+    // 阈值为0时不调整并发数
+    RecoverChunkScheduler fixed(4, 0, 0);
+    fixed.OnPartDone(false, 10);
+    ASSERT_EQ(4, fixed.GetConcurrency());
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,442 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "src/snapshotcloneserver/snapshot/snapshot_block_store.h"
+#include "src/common/snapshotclone/snapshotclone_define.h"
+
+#include "test/snapshotcloneserver/mock_snapshot_server.h"
+
+using ::testing::Return;
+using ::testing::_;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::InSequence;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+class TestSnapshotBlockStore : public ::testing::Test {
+ public:
+    void SetUp() {
+        metaStore_ = std::make_shared<MockSnapshotCloneMetaStore>();
+        dataStore_ = std::make_shared<MockSnapshotDataStore>();
+        blockStore_ = std::make_shared<SnapshotBlockStore>(
+            dataStore_, metaStore_, BLOCK_COMPRESS_SNAPPY);
+    }
+
+    void TearDown() {
+        blockStore_ = nullptr;
+        metaStore_ = nullptr;
+        dataStore_ = nullptr;
+    }
+
+ protected:
+    std::shared_ptr<MockSnapshotCloneMetaStore> metaStore_;
+    std::shared_ptr<MockSnapshotDataStore> dataStore_;
+    std::shared_ptr<SnapshotBlockStore> blockStore_;
+};
+
+TEST(TestSnapshotBlockCodec, TestCompressAndDecompress) {
+    std::string buf(4096, 'a');
+    buf[100] = 'b';
+    for (auto type : {BLOCK_COMPRESS_NONE,
+                      BLOCK_COMPRESS_SNAPPY,
+                      BLOCK_COMPRESS_ZLIB}) {
+        std::string out;
+        ASSERT_TRUE(SnapshotBlockCodec::Compress(
+            type, buf.data(), buf.size(), &out));
+        ASSERT_LE(out.size(),
+            SnapshotBlockCodec::MaxStoreLength(type, buf.size()));
+        std::string data(buf.size(), '\0');
+        ASSERT_TRUE(SnapshotBlockCodec::Decompress(
+            type, out, buf.size(), &data[0]));
+        ASSERT_EQ(buf, data);
+        // 长度不匹配
+        ASSERT_FALSE(SnapshotBlockCodec::Decompress(
+            type, out, buf.size() / 2, &data[0]));
+    }
+
+    BlockCompressType type;
+    ASSERT_TRUE(SnapshotBlockCodec::ParseCompressType("zlib", &type));
+    ASSERT_EQ(BLOCK_COMPRESS_ZLIB, type);
+    ASSERT_FALSE(SnapshotBlockCodec::ParseCompressType("lz4", &type));
+
+    ASSERT_TRUE(SnapshotBlockCodec::IsZeroBlock(
+        std::string(4096, '\0').data(), 4096));
+    ASSERT_FALSE(SnapshotBlockCodec::IsZeroBlock(buf.data(), buf.size()));
+}
+
+TEST_F(TestSnapshotBlockStore, TestPutZeroBlock) {
+    std::string buf(4096, '\0');
+    ChunkBlock block;
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(_, _))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, PutDataBlock(_, _))
+        .Times(0);
+    ASSERT_EQ(kErrCodeSuccess,
+        blockStore_->PutBlock(buf.data(), buf.size(), &block));
+    ASSERT_TRUE(block.hash().empty());
+}
+
+TEST_F(TestSnapshotBlockStore, TestPutNewBlockSuccess) {
+    std::string buf(4096, 'a');
+    ChunkBlock block;
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(1),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DataBlockExist(_))
+        .Times(0);
+    std::string stored;
+    EXPECT_CALL(*dataStore_, PutDataBlock(_, _))
+        .WillOnce(Invoke([&stored] (const std::string &key,
+                                    const std::string &data) {
+            stored = data;
+            return 0;
+        }));
+    ASSERT_EQ(kErrCodeSuccess,
+        blockStore_->PutBlock(buf.data(), buf.size(), &block));
+    ASSERT_EQ(SnapshotBlockCodec::CalcBlockHash(buf.data(), buf.size()),
+        block.hash());
+    ASSERT_EQ(BLOCK_COMPRESS_SNAPPY, block.compresstype());
+    ASSERT_LT(stored.size(), buf.size());
+}
+
+TEST_F(TestSnapshotBlockStore, TestPutDuplicateBlock) {
+    std::string buf(4096, 'a');
+    ChunkBlock block;
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(2),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DataBlockExist(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*dataStore_, PutDataBlock(_, _))
+        .Times(0);
+    ASSERT_EQ(kErrCodeSuccess,
+        blockStore_->PutBlock(buf.data(), buf.size(), &block));
+    ASSERT_FALSE(block.hash().empty());
+}
+
+TEST_F(TestSnapshotBlockStore, TestPutBlockUploadFail) {
+    std::string buf(4096, 'a');
+    ChunkBlock block;
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(1),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, PutDataBlock(_, _))
+        .WillOnce(Return(-1));
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlock(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(0),
+                        Return(kErrCodeSuccess)));
+    ASSERT_EQ(kErrCodeInternalError,
+        blockStore_->PutBlock(buf.data(), buf.size(), &block));
+    // 失败时不填充数据块信息，调用者释放时会跳过
+    ASSERT_TRUE(block.hash().empty());
+}
+
+TEST_F(TestSnapshotBlockStore, TestPutBlockRefFail) {
+    std::string buf(4096, 'a');
+    ChunkBlock block;
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(_, _))
+        .WillOnce(Return(kErrCodeInternalError));
+    EXPECT_CALL(*dataStore_, PutDataBlock(_, _))
+        .Times(0);
+    ASSERT_EQ(kErrCodeInternalError,
+        blockStore_->PutBlock(buf.data(), buf.size(), &block));
+}
+
+TEST_F(TestSnapshotBlockStore, TestReleaseBlock) {
+    ChunkBlock block;
+    block.set_hash("abc");
+    block.set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    std::string key = SnapshotBlockCodec::BlockObjectKey(block);
+
+    // 仍有引用，不删除对象
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlock(key, _))
+        .WillOnce(DoAll(SetArgPointee<1>(1),
+                        Return(kErrCodeSuccess)))
+        .WillOnce(DoAll(SetArgPointee<1>(0),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DeleteDataBlock(key))
+        .WillOnce(Return(0));
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->ReleaseBlock(block));
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->ReleaseBlock(block));
+
+    // 全零块
+    ChunkBlock zeroBlock;
+    zeroBlock.set_hash("");
+    zeroBlock.set_compresstype(BLOCK_COMPRESS_NONE);
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->ReleaseBlock(zeroBlock));
+}
+
+TEST_F(TestSnapshotBlockStore, TestRefBlock) {
+    ChunkBlock block;
+    block.set_hash("abc");
+    block.set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    std::string key = SnapshotBlockCodec::BlockObjectKey(block);
+
+    // 数据块仍被引用
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(key, _))
+        .WillOnce(DoAll(SetArgPointee<1>(2),
+                        Return(kErrCodeSuccess)));
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->RefBlock(block));
+
+    // 原有引用已释放，撤销本次引用
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(key, _))
+        .WillOnce(DoAll(SetArgPointee<1>(1),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlock(key, _))
+        .WillOnce(DoAll(SetArgPointee<1>(0),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DeleteDataBlock(_))
+        .Times(0);
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->RefBlock(block));
+
+    // 增加引用失败
+    EXPECT_CALL(*metaStore_, RefSnapshotBlock(key, _))
+        .WillOnce(Return(kErrCodeInternalError));
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->RefBlock(block));
+
+    // 全零块
+    ChunkBlock zeroBlock;
+    zeroBlock.set_hash("");
+    zeroBlock.set_compresstype(BLOCK_COMPRESS_NONE);
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->RefBlock(zeroBlock));
+}
+
+TEST_F(TestSnapshotBlockStore, TestRefBlocks) {
+    // b0仍被引用，b1的引用已全部释放，b0和b1各出现两次，最后一个为全零块
+    std::vector<ChunkBlock> blocks(5);
+    std::vector<std::string> hashes{"b0", "b1", "b0", "b1", ""};
+    for (size_t i = 0; i < blocks.size(); i++) {
+        blocks[i].set_hash(hashes[i]);
+        blocks[i].set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    }
+    std::string key0 = SnapshotBlockCodec::BlockObjectKey(blocks[0]);
+    std::string key1 = SnapshotBlockCodec::BlockObjectKey(blocks[1]);
+
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(
+            ElementsAre(key0, key1, key0, key1), _))
+        .WillOnce(DoAll(
+            SetArgPointee<1>(std::vector<uint64_t>{2, 1, 3, 2}),
+            Return(kErrCodeSuccess)));
+    // 撤销b1的全部引用，不删除对象
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(ElementsAre(key1, key1), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>{1, 0}),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DeleteDataBlock(_))
+        .Times(0);
+    std::vector<bool> refed;
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->RefBlocks(blocks, &refed));
+    ASSERT_EQ(std::vector<bool>({true, false, true, false, true}), refed);
+
+    // 增加引用失败
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(_, _))
+        .WillOnce(Return(kErrCodeInternalError));
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->RefBlocks(blocks, &refed));
+    ASSERT_EQ(std::vector<bool>({false, false, false, false, true}), refed);
+}
+
+TEST_F(TestSnapshotBlockStore, TestRefBlocksInBatches) {
+    std::vector<ChunkBlock> blocks(20);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        blocks[i].set_hash(std::to_string(i));
+        blocks[i].set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    }
+
+    // 第一批失败时继续引用下一批
+    InSequence s;
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(SizeIs(16), _))
+        .WillOnce(Return(kErrCodeInternalError));
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(SizeIs(4), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>(4, 2)),
+                        Return(kErrCodeSuccess)));
+    std::vector<bool> refed;
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->RefBlocks(blocks, &refed));
+    std::vector<bool> expect(20, false);
+    std::fill(expect.begin() + 16, expect.end(), true);
+    ASSERT_EQ(expect, refed);
+}
+
+TEST_F(TestSnapshotBlockStore, TestReleaseBlocks) {
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(4096);
+    for (auto hash : {"b0", "b1", "b0", ""}) {
+        auto block = blockMap.add_blocks();
+        block->set_hash(hash);
+        block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    }
+    std::string key0 = SnapshotBlockCodec::BlockObjectKey(blockMap.blocks(0));
+    std::string key1 = SnapshotBlockCodec::BlockObjectKey(blockMap.blocks(1));
+
+    // 全零块不释放，引用计数减为0的数据块删除对象
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(
+            ElementsAre(key0, key1, key0), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>{1, 1, 0}),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DeleteDataBlock(key0))
+        .WillOnce(Return(0));
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->ReleaseBlocks(blockMap));
+
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(_, _))
+        .WillOnce(Return(kErrCodeInternalError));
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->ReleaseBlocks(blockMap));
+}
+
+TEST_F(TestSnapshotBlockStore, TestDeleteChunkDataSuccess) {
+    ChunkDataName name("file", 1, 0);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(4096);
+    auto block = blockMap.add_blocks();
+    block->set_hash("abc");
+    block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    block = blockMap.add_blocks();
+    block->set_hash("");
+    block->set_compresstype(BLOCK_COMPRESS_NONE);
+
+    // 先删除数据块列表对象，再释放数据块
+    InSequence s;
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(blockMap),
+                        Return(0)));
+    EXPECT_CALL(*dataStore_, PutChunkBlockMap(_, _))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(
+            ElementsAre(SnapshotBlockCodec::BlockObjectKey(
+                blockMap.blocks(0))), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>{0}),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DeleteDataBlock(_))
+        .WillOnce(Return(0));
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->DeleteChunkData(name));
+}
+
+TEST_F(TestSnapshotBlockStore, TestDeleteChunkDataInBatches) {
+    ChunkDataName name("file", 1, 0);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(4096);
+    for (int i = 0; i < 20; i++) {
+        auto block = blockMap.add_blocks();
+        block->set_hash(std::to_string(i));
+        block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    }
+
+    // 每批释放前先持久化缩减后的数据块列表
+    InSequence s;
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(blockMap),
+                        Return(0)));
+    ChunkBlockMap remain;
+    EXPECT_CALL(*dataStore_, PutChunkBlockMap(_, _))
+        .WillOnce(Invoke([&remain] (const ChunkDataName &name,
+                                    const ChunkBlockMap &blockMap) {
+            remain = blockMap;
+            return 0;
+        }));
+    // 每批数据块的引用计数在一个事务中修改
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(SizeIs(16), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>(16, 1)),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(SizeIs(4), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>(4, 1)),
+                        Return(kErrCodeSuccess)));
+    ASSERT_EQ(kErrCodeSuccess, blockStore_->DeleteChunkData(name));
+    ASSERT_EQ(4, remain.blocks_size());
+    ASSERT_EQ("16", remain.blocks(0).hash());
+}
+
+TEST_F(TestSnapshotBlockStore, TestDeleteChunkDataReleaseFail) {
+    ChunkDataName name("file", 1, 0);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(4096);
+    for (int i = 0; i < 20; i++) {
+        auto block = blockMap.add_blocks();
+        block->set_hash(std::to_string(i));
+        block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    }
+
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(blockMap),
+                        Return(0)));
+    ChunkBlockMap remain;
+    EXPECT_CALL(*dataStore_, PutChunkBlockMap(_, _))
+        .WillOnce(Invoke([&remain] (const ChunkDataName &name,
+                                    const ChunkBlockMap &blockMap) {
+            remain = blockMap;
+            return 0;
+        }));
+    // 本批数据块均未释放，残留，不再释放下一批
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(SizeIs(16), _))
+        .WillOnce(Return(kErrCodeInternalError));
+    EXPECT_CALL(*dataStore_, DeleteDataBlock(_))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .Times(0);
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->DeleteChunkData(name));
+    // 重试时只释放未移除的数据块
+    ASSERT_EQ(4, remain.blocks_size());
+    ASSERT_EQ("16", remain.blocks(0).hash());
+}
+
+TEST_F(TestSnapshotBlockStore, TestDeleteChunkDataUpdateBlockMapFail) {
+    ChunkDataName name("file", 1, 0);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(4096);
+    auto block = blockMap.add_blocks();
+    block->set_hash("abc");
+    block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(blockMap),
+                        Return(0)));
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .WillOnce(Return(-1));
+    // 数据块列表未更新时不释放数据块
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(_, _))
+        .Times(0);
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->DeleteChunkData(name));
+}
+
+TEST_F(TestSnapshotBlockStore, TestDeleteChunkDataGetBlockMapFail) {
+    ChunkDataName name("file", 1, 0);
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(_, _))
+        .WillOnce(Return(-1));
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .Times(0);
+    ASSERT_EQ(kErrCodeInternalError, blockStore_->DeleteChunkData(name));
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
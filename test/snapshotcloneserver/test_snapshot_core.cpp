@@ -23,6 +23,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <map>
+#include <mutex>  // NOLINT
+#include <set>
+
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
@@ -40,6 +44,8 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::SaveArg;
+using ::testing::ElementsAre;
 
 class TestSnapshotCoreImpl : public ::testing::Test {
  public:
@@ -3418,6 +3424,311 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::error, task->GetSnapshotInfo().GetStatus());
 }
 
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTask_ReuseCleanParts) {
+    option.snapshotBlockFormatEnable = true;
+    option.readChunkSnapshotConcurrency = 16;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, "snap1");
+    info.SetStatus(Status::pending);
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(SetArgPointee<2>(seqNum),
+                        Return(LIBCURVE_ERROR::OK)));
+    // 1个segment，2个chunk，每个chunk 2个分片
+    FInfo snapInfo;
+    snapInfo.seqnum = seqNum;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(SetArgPointee<3>(snapInfo),
+                        Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 1, 1));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName, user, seqNum,
+            _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                        Return(LIBCURVE_ERROR::OK)));
+
+    // chunk1自版本95的快照以来只修改了第2个分片;
+    // chunk2被删除后重建，从创建开始跟踪，不能复用更早快照的数据
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([](const ChunkIDInfo &cidinfo,
+                                  ChunkInfoDetail *chunkInfo) {
+            chunkInfo->chunkSn.push_back(100);
+            chunkInfo->changedTracked = true;
+            chunkInfo->changedBaseSn = cidinfo.cid_ == 1 ? 95 : 0;
+            chunkInfo->changedBlockSize = 1024u * 1024u;
+            chunkInfo->changedBitmap = std::string(1, '\x02');
+            return LIBCURVE_ERROR::OK;
+        }));
+
+    // 更早的快照，chunk数据为CHUNK_DATA_BLOCK格式
+    SnapshotInfo info2("uuid2", user, fileName, "snap2");
+    info.SetSeqNum(seqNum);
+    info2.SetSeqNum(seqNum - 1);
+    info2.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos{info, info2};
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(snapInfos),
+                              Return(kErrCodeSuccess)));
+    ChunkIndexData indexData;
+    indexData.SetFileName(fileName);
+    for (ChunkIndexType i = 0; i < 2; i++) {
+        indexData.PutChunkDataName(ChunkDataName(fileName, 95, i));
+        indexData.SetChunkDataFormat(i, CHUNK_DATA_BLOCK);
+    }
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(indexData),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    // 只有chunk1获取更早快照的数据块列表，第1个分片引用其数据块
+    ChunkBlockMap baseMap;
+    baseMap.set_blocksize(option.chunkSplitSize);
+    for (auto hash : {"b0", "b1"}) {
+        auto block = baseMap.add_blocks();
+        block->set_hash(hash);
+        block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+    }
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(ChunkDataName(fileName, 95, 0),
+            _))
+        .WillOnce(DoAll(SetArgPointee<1>(baseMap),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(
+            ElementsAre(SnapshotBlockCodec::BlockObjectKey(
+                baseMap.blocks(0))), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>{2}),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(ChunkDataName(fileName, 95, 1),
+            _))
+        .Times(0);
+
+    std::mutex mtx;
+    std::set<std::pair<ChunkID, uint64_t>> readParts;
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](ChunkIDInfo cidinfo,
+                                   uint64_t seq,
+                                   uint64_t offset,
+                                   uint64_t len,
+                                   char *buf,
+                                   SnapCloneClosure* scc) {
+            {
+                std::lock_guard<std::mutex> guard(mtx);
+                readParts.emplace(cidinfo.cid_, offset);
+            }
+            memset(buf, 0, len);
+            scc->SetRetCode(LIBCURVE_ERROR::OK);
+            scc->Run();
+            return LIBCURVE_ERROR::OK;
+        }));
+
+    std::map<ChunkIndexType, ChunkBlockMap> blockMaps;
+    EXPECT_CALL(*dataStore_, PutChunkBlockMap(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](const ChunkDataName &name,
+                                   const ChunkBlockMap &blockMap) {
+            std::lock_guard<std::mutex> guard(mtx);
+            blockMaps[name.chunkIndex_] = blockMap;
+            return kErrCodeSuccess;
+        }));
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    std::set<std::pair<ChunkID, uint64_t>> expectParts{
+        {1, option.chunkSplitSize}, {2, 0}, {2, option.chunkSplitSize}};
+    ASSERT_EQ(expectParts, readParts);
+    ASSERT_EQ(2, blockMaps.size());
+    ASSERT_EQ("b0", blockMaps[0].blocks(0).hash());
+    ASSERT_EQ("", blockMaps[0].blocks(1).hash());
+    ASSERT_EQ("", blockMaps[1].blocks(0).hash());
+    ASSERT_EQ("", blockMaps[1].blocks(1).hash());
+}
+
+class TestTransferSnapshotDataChunkTask : public ::testing::Test {
+ public:
+    void SetUp() override {
+        client_ = std::make_shared<MockCurveFsClient>();
+        metaStore_ = std::make_shared<MockSnapshotCloneMetaStore>();
+        dataStore_ = std::make_shared<MockSnapshotDataStore>();
+        blockStore_ = std::make_shared<SnapshotBlockStore>(
+            dataStore_, metaStore_, BLOCK_COMPRESS_SNAPPY);
+
+        // chunk 4个分片，更早快照的数据块列表中第4个为全零块
+        baseMap_.set_blocksize(kSplitSize);
+        for (auto hash : {"b0", "b1", "b2", ""}) {
+            auto block = baseMap_.add_blocks();
+            block->set_hash(hash);
+            block->set_compresstype(BLOCK_COMPRESS_SNAPPY);
+        }
+
+        EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+            .WillRepeatedly(Invoke([this](ChunkIDInfo cidinfo,
+                                          uint64_t seq,
+                                          uint64_t offset,
+                                          uint64_t len,
+                                          char *buf,
+                                          SnapCloneClosure* scc) {
+                readOffsets_.insert(offset);
+                memset(buf, 0, len);
+                scc->SetRetCode(LIBCURVE_ERROR::OK);
+                scc->Run();
+                return LIBCURVE_ERROR::OK;
+            }));
+        EXPECT_CALL(*dataStore_, PutChunkBlockMap(name_, _))
+            .WillOnce(DoAll(SaveArg<1>(&blockMap_),
+                            Return(kErrCodeSuccess)));
+    }
+
+    int RunTask(const std::vector<bool> &cleanParts) {
+        auto taskInfo = std::make_shared<TransferSnapshotDataChunkTaskInfo>(
+            name_, 4 * kSplitSize, ChunkIDInfo(1, 1, 1), kSplitSize,
+            1, 0, 4);
+        taskInfo->baseName_ = baseName_;
+        taskInfo->cleanParts_ = cleanParts;
+        auto task = new TransferSnapshotDataChunkTask("task", taskInfo,
+            client_, dataStore_, blockStore_);
+        auto tracker = std::make_shared<TaskTracker>();
+        task->SetTracker(tracker);
+        tracker->AddOneTrace();
+        task->Run();
+        tracker->Wait();
+        return tracker->GetResult();
+    }
+
+ protected:
+    const uint64_t kSplitSize = 4096;
+    ChunkDataName name_ = ChunkDataName("file", 100, 0);
+    ChunkDataName baseName_ = ChunkDataName("file", 95, 0);
+    ChunkBlockMap baseMap_;
+    ChunkBlockMap blockMap_;
+    std::set<uint64_t> readOffsets_;
+    std::shared_ptr<MockCurveFsClient> client_;
+    std::shared_ptr<MockSnapshotCloneMetaStore> metaStore_;
+    std::shared_ptr<MockSnapshotDataStore> dataStore_;
+    std::shared_ptr<SnapshotBlockStore> blockStore_;
+};
+
+TEST_F(TestTransferSnapshotDataChunkTask, TestReuseCleanParts) {
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(baseName_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(baseMap_),
+                        Return(kErrCodeSuccess)));
+    // 第3个分片已修改，不引用b2，其余分片的数据块在一个事务中引用，
+    // b0仍被引用，复用
+    std::string key0 =
+        SnapshotBlockCodec::BlockObjectKey(baseMap_.blocks(0));
+    std::string key1 =
+        SnapshotBlockCodec::BlockObjectKey(baseMap_.blocks(1));
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(ElementsAre(key0, key1), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>{2, 1}),
+                        Return(kErrCodeSuccess)));
+    // b1的引用已全部释放，撤销本次引用后重新读取
+    EXPECT_CALL(*metaStore_, UnrefSnapshotBlocks(ElementsAre(key1), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::vector<uint64_t>{0}),
+                        Return(kErrCodeSuccess)));
+
+    ASSERT_EQ(kErrCodeSuccess, RunTask({true, true, false, true}));
+    std::set<uint64_t> expectOffsets{kSplitSize, 2 * kSplitSize};
+    ASSERT_EQ(expectOffsets, readOffsets_);
+    ASSERT_EQ(4, blockMap_.blocks_size());
+    ASSERT_EQ("b0", blockMap_.blocks(0).hash());
+    ASSERT_EQ("", blockMap_.blocks(1).hash());
+    ASSERT_EQ("", blockMap_.blocks(2).hash());
+    ASSERT_EQ("", blockMap_.blocks(3).hash());
+}
+
+TEST_F(TestTransferSnapshotDataChunkTask, TestReuseBaseMapNotMatch) {
+    // 更早快照的分片大小不同，全部重新读取
+    baseMap_.set_blocksize(2 * kSplitSize);
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(baseName_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(baseMap_),
+                        Return(kErrCodeSuccess)));
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(_, _))
+        .Times(0);
+
+    ASSERT_EQ(kErrCodeSuccess, RunTask({true, true, true, true}));
+    ASSERT_EQ(4, readOffsets_.size());
+}
+
+TEST_F(TestTransferSnapshotDataChunkTask, TestReuseGetBaseMapFail) {
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(baseName_, _))
+        .WillOnce(Return(kErrCodeInternalError));
+    EXPECT_CALL(*metaStore_, RefSnapshotBlocks(_, _))
+        .Times(0);
+
+    ASSERT_EQ(kErrCodeSuccess, RunTask({true, true, true, true}));
+    ASSERT_EQ(4, readOffsets_.size());
+}
+
+TEST_F(TestTransferSnapshotDataChunkTask, TestFullTransfer) {
+    // 没有可复用的分片时不获取更早快照的数据块列表
+    EXPECT_CALL(*dataStore_, GetChunkBlockMap(_, _))
+        .Times(0);
+
+    ASSERT_EQ(kErrCodeSuccess, RunTask({}));
+    ASSERT_EQ(4, readOffsets_.size());
+}
+
+TEST(TestFileSnapMap, TestGetPrevBlockChunkData) {
+    FileSnapMap fileSnapMap;
+    // seq 1和seq 3为CHUNK_DATA_BLOCK格式，seq 2为CHUNK_DATA_RAW格式
+    for (uint64_t seq : {1, 2, 3}) {
+        ChunkIndexData indexData;
+        indexData.SetFileName("file");
+        indexData.PutChunkDataName(ChunkDataName("file", seq, 1));
+        indexData.SetChunkDataFormat(1,
+            seq == 2 ? CHUNK_DATA_RAW : CHUNK_DATA_BLOCK);
+        fileSnapMap.maps.push_back(indexData);
+    }
+
+    ChunkDataName prev;
+    ASSERT_TRUE(fileSnapMap.GetPrevBlockChunkData(
+        ChunkDataName("file", 5, 1), &prev));
+    ASSERT_EQ(3, prev.chunkSeqNum_);
+    ASSERT_EQ(1, prev.chunkIndex_);
+    // 跳过CHUNK_DATA_RAW格式的数据
+    ASSERT_TRUE(fileSnapMap.GetPrevBlockChunkData(
+        ChunkDataName("file", 3, 1), &prev));
+    ASSERT_EQ(1, prev.chunkSeqNum_);
+    ASSERT_FALSE(fileSnapMap.GetPrevBlockChunkData(
+        ChunkDataName("file", 1, 1), &prev));
+    ASSERT_FALSE(fileSnapMap.GetPrevBlockChunkData(
+        ChunkDataName("file", 5, 2), &prev));
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -280,6 +280,23 @@ TEST(TestChunkIndexData, TestGetAllChunkIndex) {
     ASSERT_EQ(100, ret[0]);
 }
 
+TEST(TestChunkIndexData, TestChunkDataFormat) {
+    ChunkIndexData indexData;
+    indexData.SetFileName("file1");
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 100));
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 101));
+    indexData.SetChunkDataFormat(101, CHUNK_DATA_BLOCK);
+    ASSERT_EQ(CHUNK_DATA_RAW, indexData.GetChunkDataFormat(100));
+    ASSERT_EQ(CHUNK_DATA_BLOCK, indexData.GetChunkDataFormat(101));
+
+    std::string data;
+    ASSERT_TRUE(indexData.Serialize(&data));
+    ChunkIndexData out;
+    ASSERT_TRUE(out.Unserialize(data));
+    ASSERT_EQ(CHUNK_DATA_RAW, out.GetChunkDataFormat(100));
+    ASSERT_EQ(CHUNK_DATA_BLOCK, out.GetChunkDataFormat(101));
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
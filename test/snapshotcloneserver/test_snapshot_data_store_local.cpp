@@ -0,0 +1,316 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+
+#include <memory>
+#include <string>
+
+#include "src/common/snapshotclone/snapshot_block.h"
+#include "src/common/snapshotclone/snapshot_local_reader.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_data_store_local.h"
+#include "src/fs/local_filesystem.h"
+
+using ::curve::fs::LocalFsFactory;
+using ::curve::fs::FileSystemType;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+const char kLocalStoreTestPath[] = "./local_snapshot_data_store_test";
+// 每个pack文件最多容纳两个4KB的数据块
+const uint64_t kTestPackFileSize = 8192;
+
+class TestLocalSnapshotDataStore : public ::testing::Test {
+ public:
+    void SetUp() {
+        lfs_ = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        lfs_->Delete(kLocalStoreTestPath);
+        store_ = std::make_shared<LocalSnapshotDataStore>(
+            lfs_, kTestPackFileSize);
+        ASSERT_EQ(0, store_->Init(kLocalStoreTestPath));
+    }
+
+    void TearDown() {
+        store_ = nullptr;
+        lfs_->Delete(kLocalStoreTestPath);
+    }
+
+    void Reopen() {
+        store_ = nullptr;
+        store_ = std::make_shared<LocalSnapshotDataStore>(
+            lfs_, kTestPackFileSize);
+        ASSERT_EQ(0, store_->Init(kLocalStoreTestPath));
+    }
+
+    int PackFileNum() {
+        std::vector<std::string> names;
+        lfs_->List(std::string(kLocalStoreTestPath) + "/pack", &names);
+        int num = 0;
+        for (auto &name : names) {
+            if (name.find(".pack") != std::string::npos) {
+                num++;
+            }
+        }
+        return num;
+    }
+
+ protected:
+    std::shared_ptr<curve::fs::LocalFileSystem> lfs_;
+    std::shared_ptr<LocalSnapshotDataStore> store_;
+};
+
+TEST_F(TestLocalSnapshotDataStore, TestEncodeFileName) {
+    ASSERT_EQ("%2Fdir%2Ffile-1-2",
+        SnapshotLocalLayout::EncodeFileName("/dir/file-1-2"));
+    ASSERT_EQ("a%25b", SnapshotLocalLayout::EncodeFileName("a%b"));
+}
+
+TEST_F(TestLocalSnapshotDataStore, TestChunkIndexData) {
+    ChunkIndexDataName name("/dir/file", 1);
+    ChunkIndexData indexData;
+    indexData.SetFileName("/dir/file");
+    indexData.PutChunkDataName(ChunkDataName("/dir/file", 1, 0));
+    indexData.PutChunkDataName(ChunkDataName("/dir/file", 1, 1));
+
+    ASSERT_FALSE(store_->ChunkIndexDataExist(name));
+    ASSERT_EQ(-1, store_->GetChunkIndexData(name, &indexData));
+    ASSERT_EQ(0, store_->PutChunkIndexData(name, indexData));
+    ASSERT_TRUE(store_->ChunkIndexDataExist(name));
+
+    ChunkIndexData out;
+    ASSERT_EQ(0, store_->GetChunkIndexData(name, &out));
+    ASSERT_EQ(2, out.GetAllChunkIndex().size());
+
+    ASSERT_EQ(0, store_->DeleteChunkIndexData(name));
+    ASSERT_FALSE(store_->ChunkIndexDataExist(name));
+    // 删除不存在的对象返回成功
+    ASSERT_EQ(0, store_->DeleteChunkIndexData(name));
+}
+
+TEST_F(TestLocalSnapshotDataStore, TestDataChunkTransfer) {
+    ChunkDataName name("/dir/file", 1, 0);
+    const int partSize = 4096;
+    std::string part0(partSize, 'a');
+    std::string part1(partSize, 'b');
+
+    // 分片乱序写入
+    auto task = std::make_shared<TransferTask>();
+    ASSERT_EQ(0, store_->DataChunkTranferInit(name, task));
+    ASSERT_EQ(0, store_->DataChunkTranferAddPart(
+        name, task, 1, partSize, part1.data()));
+    ASSERT_EQ(0, store_->DataChunkTranferAddPart(
+        name, task, 0, partSize, part0.data()));
+    ASSERT_FALSE(store_->ChunkDataExist(name));
+    ASSERT_EQ(0, store_->DataChunkTranferComplete(name, task));
+    ASSERT_TRUE(store_->ChunkDataExist(name));
+
+    std::string path = std::string(kLocalStoreTestPath) + "/chunk/" +
+        SnapshotLocalLayout::EncodeFileName(name.ToDataChunkKey());
+    int fd = lfs_->Open(path, O_RDONLY);
+    ASSERT_GE(fd, 0);
+    char buf[2 * partSize];
+    ASSERT_EQ(2 * partSize, lfs_->Read(fd, buf, 0, 2 * partSize));
+    lfs_->Close(fd);
+    ASSERT_EQ(part0 + part1, std::string(buf, 2 * partSize));
+
+    ASSERT_EQ(0, store_->DeleteChunkData(name));
+    ASSERT_FALSE(store_->ChunkDataExist(name));
+
+    // 放弃转储不留下对象
+    task = std::make_shared<TransferTask>();
+    ASSERT_EQ(0, store_->DataChunkTranferInit(name, task));
+    ASSERT_EQ(0, store_->DataChunkTranferAddPart(
+        name, task, 0, partSize, part0.data()));
+    ASSERT_EQ(0, store_->DataChunkTranferAbort(name, task));
+    ASSERT_FALSE(store_->ChunkDataExist(name));
+    ASSERT_FALSE(lfs_->FileExists(task->uploadId_));
+}
+
+TEST_F(TestLocalSnapshotDataStore, TestChunkBlockMap) {
+    const size_t blockSize = 4096;
+    std::string content(blockSize, 'a');
+    ChunkDataName name("/dir/file", 1, 0);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(blockSize);
+    ChunkBlock *block = blockMap.add_blocks();
+    block->set_hash(SnapshotBlockCodec::CalcBlockHash(
+        content.data(), content.size()));
+    block->set_compresstype(BLOCK_COMPRESS_NONE);
+    // 全零块
+    blockMap.add_blocks()->set_compresstype(BLOCK_COMPRESS_NONE);
+
+    ChunkBlockMap out;
+    ASSERT_EQ(-1, store_->GetChunkBlockMap(name, &out));
+    // 数据块不存在时无法记录位置
+    ASSERT_EQ(-1, store_->PutChunkBlockMap(name, blockMap));
+
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/0", std::string(100, 'x')));
+    ASSERT_EQ(0, store_->PutDataBlock(
+        SnapshotBlockCodec::BlockObjectKey(*block), content));
+    ASSERT_EQ(0, store_->PutChunkBlockMap(name, blockMap));
+    ASSERT_TRUE(store_->ChunkDataExist(name));
+    ASSERT_EQ(0, store_->GetChunkBlockMap(name, &out));
+    ASSERT_EQ(blockSize, out.blocksize());
+    ASSERT_EQ(2, out.blocks_size());
+    ASSERT_EQ(block->hash(), out.blocks(0).hash());
+    ASSERT_EQ(0, out.blocks(0).packid());
+    ASSERT_EQ(100, out.blocks(0).packoffset());
+    ASSERT_EQ(blockSize, out.blocks(0).storelength());
+    ASSERT_FALSE(out.blocks(1).has_packid());
+}
+
+TEST_F(TestLocalSnapshotDataStore, TestLocalReader) {
+    const size_t blockSize = 4096;
+    std::string content(blockSize, 'a');
+    ChunkDataName name("/dir/file", 1, 0);
+    ChunkBlockMap blockMap;
+    blockMap.set_blocksize(blockSize);
+    ChunkBlock *block = blockMap.add_blocks();
+    block->set_hash(SnapshotBlockCodec::CalcBlockHash(
+        content.data(), content.size()));
+    block->set_compresstype(BLOCK_COMPRESS_NONE);
+    ASSERT_EQ(0, store_->PutDataBlock(
+        SnapshotBlockCodec::BlockObjectKey(*block), content));
+    ASSERT_EQ(0, store_->PutChunkBlockMap(name, blockMap));
+
+    SnapshotLocalReader reader(kLocalStoreTestPath, 1);
+    std::string data;
+    ASSERT_EQ(0, reader.ReadChunk(name.ToDataChunkKey(), &data));
+    ChunkBlockMap out;
+    ASSERT_TRUE(out.ParseFromString(data));
+    ASSERT_EQ(1, out.blocks_size());
+
+    char buf[blockSize];
+    ASSERT_EQ(0, reader.ReadBlock(out.blocks(0), blockSize, buf));
+    ASSERT_EQ(content, std::string(buf, blockSize));
+
+    // 写入后面的pack文件，淘汰已有的映射
+    std::string content2(blockSize, 'b');
+    ChunkBlock block2;
+    block2.set_hash(SnapshotBlockCodec::CalcBlockHash(
+        content2.data(), content2.size()));
+    block2.set_compresstype(BLOCK_COMPRESS_NONE);
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/1", content));
+    ASSERT_EQ(0, store_->PutDataBlock(
+        SnapshotBlockCodec::BlockObjectKey(block2), content2));
+    ChunkBlockMap blockMap2;
+    blockMap2.set_blocksize(blockSize);
+    *blockMap2.add_blocks() = block2;
+    ChunkDataName name2("/dir/file", 1, 1);
+    ASSERT_EQ(0, store_->PutChunkBlockMap(name2, blockMap2));
+    ASSERT_EQ(0, reader.ReadChunk(name2.ToDataChunkKey(), &data));
+    ASSERT_TRUE(out.ParseFromString(data));
+    ASSERT_EQ(1, out.blocks(0).packid());
+    ASSERT_EQ(0, reader.ReadBlock(out.blocks(0), blockSize, buf));
+    ASSERT_EQ(content2, std::string(buf, blockSize));
+
+    // 读取chunk数据的一部分
+    ASSERT_EQ(0, reader.ReadChunk(name.ToDataChunkKey(), 0, 1, buf));
+    ASSERT_EQ(-1, reader.ReadChunk(name.ToDataChunkKey(), 0,
+                                   data.size() + blockSize, buf));
+
+    // 没有位置或者crc不匹配时失败
+    ChunkBlock broken = out.blocks(0);
+    broken.set_storecrc(broken.storecrc() + 1);
+    ASSERT_EQ(-1, reader.ReadBlock(broken, blockSize, buf));
+    broken.clear_packid();
+    ASSERT_EQ(-1, reader.ReadBlock(broken, blockSize, buf));
+    // pack文件不存在
+    broken = out.blocks(0);
+    broken.set_packid(100);
+    ASSERT_EQ(-1, reader.ReadBlock(broken, blockSize, buf));
+}
+
+TEST_F(TestLocalSnapshotDataStore, TestDataBlock) {
+    std::string data1(4096, '1');
+    std::string data2(4096, '2');
+    std::string data3(4096, '3');
+
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/1"));
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/1", data1));
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/2", data2));
+    // 第一个pack文件已满，写入新的pack文件
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/3", data3));
+    ASSERT_EQ(2, PackFileNum());
+    // 已存在的数据块不重复写入
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/1", data1));
+    ASSERT_EQ(2, PackFileNum());
+
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/1"));
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/3"));
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/4"));
+
+    // 重启后重放.idx文件恢复索引
+    Reopen();
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/1"));
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/2"));
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/3"));
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/4"));
+
+    // pack文件中的数据块全部删除后删除该pack文件
+    ASSERT_EQ(0, store_->DeleteDataBlock("snapblock/1"));
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/1"));
+    ASSERT_EQ(3, PackFileNum());
+    ASSERT_EQ(0, store_->DeleteDataBlock("snapblock/2"));
+    ASSERT_EQ(2, PackFileNum());
+    // 删除不存在的数据块返回成功
+    ASSERT_EQ(0, store_->DeleteDataBlock("snapblock/1"));
+
+    // 删除记录在重启后仍然有效
+    Reopen();
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/1"));
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/2"));
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/3"));
+    ASSERT_EQ(0, store_->DeleteDataBlock("snapblock/3"));
+    // 只剩当前写入的空pack文件
+    ASSERT_EQ(1, PackFileNum());
+}
+
+TEST_F(TestLocalSnapshotDataStore, TestIncompletePackRecord) {
+    std::string data(4096, 'x');
+    ASSERT_EQ(0, store_->PutDataBlock("snapblock/1", data));
+    store_ = nullptr;
+
+    // 模拟写.idx文件时进程退出，最后一条记录不完整
+    std::string idxPath = std::string(kLocalStoreTestPath) + "/pack/0.idx";
+    int fd = lfs_->Open(idxPath, O_RDWR);
+    ASSERT_GE(fd, 0);
+    struct stat info;
+    ASSERT_EQ(0, lfs_->Fstat(fd, &info));
+    std::string torn = "P snapblock/2 40";
+    ASSERT_EQ(torn.size(),
+        lfs_->Write(fd, torn.data(), info.st_size, torn.size()));
+    lfs_->Close(fd);
+
+    Reopen();
+    ASSERT_TRUE(store_->DataBlockExist("snapblock/1"));
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/2"));
+    // 新的记录覆盖不完整的记录
+    ASSERT_EQ(0, store_->DeleteDataBlock("snapblock/1"));
+    Reopen();
+    ASSERT_FALSE(store_->DataBlockExist("snapblock/1"));
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2022-10-19
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+#include "src/common/concurrent/count_down_event.h"
+
+using ::curve::common::CountDownEvent;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TEST(TestSnapshotTransferPipeline, TestAcquireAndReleaseBuffer) {
+    SnapshotTransferPipeline pipeline(4096, 2);
+
+    ASSERT_TRUE(pipeline.AcquireBuffer(2048, 10));
+    ASSERT_TRUE(pipeline.AcquireBuffer(2048, 10));
+    ASSERT_EQ(4096, pipeline.GetMetric()->bufferUsed.get_value());
+
+    // 预算耗尽，等待超时
+    ASSERT_FALSE(pipeline.AcquireBuffer(1024, 10));
+
+    // 其他线程归还预算后等待者被唤醒
+    std::thread releaser([&pipeline] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        pipeline.ReleaseBuffer(2048);
+    });
+    ASSERT_TRUE(pipeline.AcquireBuffer(1024, 5000));
+    releaser.join();
+    ASSERT_EQ(3072, pipeline.GetMetric()->bufferUsed.get_value());
+
+    pipeline.ReleaseBuffer(2048);
+    pipeline.ReleaseBuffer(1024);
+    ASSERT_EQ(0, pipeline.GetMetric()->bufferUsed.get_value());
+}
+
+TEST(TestSnapshotTransferPipeline, TestAcquireLargerThanLimit) {
+    SnapshotTransferPipeline pipeline(1024, 2);
+
+    // 预算全部空闲时放行超过预算的申请，避免永久等待
+    ASSERT_TRUE(pipeline.AcquireBuffer(4096, 10));
+    ASSERT_FALSE(pipeline.AcquireBuffer(1, 10));
+    pipeline.ReleaseBuffer(4096);
+    ASSERT_TRUE(pipeline.AcquireBuffer(1, 10));
+    pipeline.ReleaseBuffer(1);
+}
+
+TEST(TestSnapshotTransferPipeline, TestPushUploadTask) {
+    SnapshotTransferPipeline pipeline(4096, 4);
+    ASSERT_EQ(0, pipeline.Start());
+
+    const int taskNum = 16;
+    std::atomic<int> doneNum(0);
+    CountDownEvent event(taskNum);
+    for (int i = 0; i < taskNum; i++) {
+        pipeline.PushUploadTask([&doneNum, &event] () {
+            doneNum.fetch_add(1);
+            event.Signal();
+        });
+    }
+    event.Wait();
+    ASSERT_EQ(taskNum, doneNum.load());
+    pipeline.Stop();
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
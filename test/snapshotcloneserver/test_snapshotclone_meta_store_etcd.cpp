@@ -70,6 +70,26 @@ class TestSnapshotCloneMetaStoreEtcd : public ::testing::Test {
         metaStore_ = nullptr;
     }
 
+    // 期望一次修改数据块引用计数的事务，put记为key=value，delete记为key
+    void ExpectBlockRefTxn(const std::vector<std::string> &expectOps,
+                           int errCode) {
+        EXPECT_CALL(*kvStorageClient_, TxnNRewithRevision(_, _))
+            .WillOnce(Invoke([expectOps, errCode](
+                    const std::vector<Operation> &ops, int64_t *revision) {
+                std::vector<std::string> items;
+                for (const auto &op : ops) {
+                    std::string item(op.key, op.keyLen);
+                    if (op.opType == OpType::OpPut) {
+                        item += "=" + std::string(op.value, op.valueLen);
+                    }
+                    items.push_back(item);
+                }
+                EXPECT_EQ(expectOps, items);
+                *revision = 1;
+                return errCode;
+            }));
+    }
+
  protected:
     std::shared_ptr<MockKVStorageClient> kvStorageClient_;
     std::shared_ptr<SnapshotCloneCodec> codec_;
@@ -761,8 +781,118 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
     ASSERT_EQ(-1, ret);
 }
 
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestRefAndUnrefSnapshotBlock) {
+    SnapshotCloneCodec codec;
+    std::string key = codec.EncodeSnapshotBlockRefKey("block1");
+    uint64_t refCount = 0;
+
+    // 1. 首次引用创建记录
+    ExpectBlockRefTxn({key + "=1"}, EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->RefSnapshotBlock("block1", &refCount));
+    ASSERT_EQ(1, refCount);
+
+    // 2. 再次引用
+    ExpectBlockRefTxn({key + "=2"}, EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->RefSnapshotBlock("block1", &refCount));
+    ASSERT_EQ(2, refCount);
+
+    // 3. 写etcd失败，引用计数不变
+    ExpectBlockRefTxn({key + "=1"}, EtcdErrCode::EtcdUnknown);
+    ASSERT_EQ(-1, metaStore_->UnrefSnapshotBlock("block1", &refCount));
+
+    ExpectBlockRefTxn({key + "=1"}, EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->UnrefSnapshotBlock("block1", &refCount));
+    ASSERT_EQ(1, refCount);
+
+    // 4. 引用计数减为0时删除记录
+    ExpectBlockRefTxn({key}, EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->UnrefSnapshotBlock("block1", &refCount));
+    ASSERT_EQ(0, refCount);
+
+    // 5. 记录不存在
+    EXPECT_CALL(*kvStorageClient_, TxnNRewithRevision(_, _))
+        .Times(0);
+    ASSERT_EQ(-1, metaStore_->UnrefSnapshotBlock("block1", &refCount));
+}
+
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestRefAndUnrefSnapshotBlocks) {
+    SnapshotCloneCodec codec;
+    std::string key1 = codec.EncodeSnapshotBlockRefKey("block1");
+    std::string key2 = codec.EncodeSnapshotBlockRefKey("block2");
+    std::vector<uint64_t> refCounts;
+
+    // 1. 重复的数据块在事务中合并为一个操作，按顺序返回中间值
+    ExpectBlockRefTxn({key1 + "=2", key2 + "=1"}, EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->RefSnapshotBlocks(
+        {"block1", "block2", "block1"}, &refCounts));
+    ASSERT_EQ(std::vector<uint64_t>({1, 1, 2}), refCounts);
+
+    // 2. 事务失败，所有引用计数不变
+    ExpectBlockRefTxn({key1 + "=1", key2}, EtcdErrCode::EtcdUnknown);
+    ASSERT_EQ(-1, metaStore_->UnrefSnapshotBlocks(
+        {"block1", "block2"}, &refCounts));
+
+    ExpectBlockRefTxn({key1 + "=1", key2}, EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->UnrefSnapshotBlocks(
+        {"block2", "block1"}, &refCounts));
+    ASSERT_EQ(std::vector<uint64_t>({0, 1}), refCounts);
+
+    // 3. 释放次数超过引用计数或记录不存在时不修改任何引用计数
+    EXPECT_CALL(*kvStorageClient_, TxnNRewithRevision(_, _))
+        .Times(0);
+    ASSERT_EQ(-1, metaStore_->UnrefSnapshotBlocks(
+        {"block1", "block1"}, &refCounts));
+    ASSERT_EQ(-1, metaStore_->UnrefSnapshotBlocks(
+        {"block1", "block2"}, &refCounts));
+
+    // 4. 超出单个事务的操作数限制
+    std::vector<std::string> blockKeys;
+    for (int i = 0; i < 129; i++) {
+        blockKeys.push_back("block" + std::to_string(i));
+    }
+    ASSERT_EQ(-1, metaStore_->RefSnapshotBlocks(blockKeys, &refCounts));
 
+    // 5. 空列表
+    ASSERT_EQ(0, metaStore_->RefSnapshotBlocks({}, &refCounts));
+    ASSERT_TRUE(refCounts.empty());
+}
 
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestInitLoadSnapshotBlockRefs) {
+    SnapshotCloneCodec codec;
+    std::vector<std::pair<std::string, std::string>> refs;
+    refs.emplace_back(codec.EncodeSnapshotBlockRefKey("block1"), "3");
+
+    EXPECT_CALL(*kvStorageClient_,
+        List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .Times(2)
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*kvStorageClient_, List(_, _,
+        Matcher<std::vector<std::pair<std::string, std::string>>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(refs),
+            Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(0, metaStore_->Init());
+
+    uint64_t refCount = 0;
+    ExpectBlockRefTxn({codec.EncodeSnapshotBlockRefKey("block1") + "=4"},
+                      EtcdErrCode::EtcdOK);
+    ASSERT_EQ(0, metaStore_->RefSnapshotBlock("block1", &refCount));
+    ASSERT_EQ(4, refCount);
+}
+
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestInitDecodeSnapshotBlockRefFail) {
+    std::vector<std::pair<std::string, std::string>> refs;
+    refs.emplace_back("18block1", "xxx");
+
+    EXPECT_CALL(*kvStorageClient_,
+        List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .Times(2)
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*kvStorageClient_, List(_, _,
+        Matcher<std::vector<std::pair<std::string, std::string>>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(refs),
+            Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(-1, metaStore_->Init());
+}
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
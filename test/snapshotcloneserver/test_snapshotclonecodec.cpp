@@ -116,6 +116,23 @@ TEST(TestSnapshotCloneServerCodec, TestEncodeKeyNotEqual) {
     ASSERT_EQ(keyNum * 2, keySet.size());
 }
 
+TEST(TestSnapshotCloneServerCodec, TestSnapshotBlockRefEncodeDecode) {
+    SnapshotCloneCodec testObj;
+    std::string key = testObj.EncodeSnapshotBlockRefKey("snapblock/abc.zlib");
+    std::string blockKey;
+    ASSERT_TRUE(testObj.DecodeSnapshotBlockRefKey(key, &blockKey));
+    ASSERT_EQ("snapblock/abc.zlib", blockKey);
+    ASSERT_FALSE(testObj.DecodeSnapshotBlockRefKey(
+        testObj.EncodeSnapshotKey("abc"), &blockKey));
+
+    uint64_t refCount = 0;
+    ASSERT_TRUE(testObj.DecodeSnapshotBlockRefData(
+        testObj.EncodeSnapshotBlockRefData(12345), &refCount));
+    ASSERT_EQ(12345, refCount);
+    ASSERT_FALSE(testObj.DecodeSnapshotBlockRefData("", &refCount));
+    ASSERT_FALSE(testObj.DecodeSnapshotBlockRefData("1x", &refCount));
+}
+
 
 
 }  // namespace snapshotcloneserver
@@ -17,6 +17,7 @@
 package main
 
 /*
+#include <stdint.h>
 #include <stdlib.h>
 
 enum EtcdErrCode
@@ -57,6 +58,7 @@ enum EtcdErrCode
     EtcdGetLeaderKeyOK = 28,
     EtcdObserverLeaderNotExist = 29,
     EtcdObjectLenNotEnough = 30,
+    EtcdTxnCompareFailed = 31,
 };
 
 enum OpType {
@@ -77,6 +79,19 @@ struct Operation {
     int keyLen;
     int valueLen;
 };
+
+// 比较key的mod revision，key不存在时mod revision为0
+enum CompareOp {
+  CmpEqual = 1,
+  CmpNotEqual = 2
+};
+
+struct Compare {
+    enum CompareOp op;
+    char *key;
+    int keyLen;
+    int64_t modRevision;
+};
 */
 import "C"
 import (
@@ -93,6 +108,7 @@ import (
 	"strings"
 	"sync"
 	"time"
+	"unsafe"
 )
 
 const (
@@ -103,6 +119,7 @@ const (
 	EtcdDelete     = "Delete"
 	EtcdTxn2       = "Txn2"
 	EtcdTxn3       = "Txn3"
+	EtcdTxnN       = "TxnN"
 	EtcdCmpAndSwp  = "CmpAndSwp"
 	EtcdNewMutex   = "NewMutex"
 	EtcdNewSession = "NewSession"
@@ -142,6 +159,26 @@ func GenOpList(cops []C.struct_Operation) ([]clientv3.Op, error) {
 	return res, nil
 }
 
+func GenCmpList(ccmps []C.struct_Compare) ([]clientv3.Cmp, error) {
+	res := make([]clientv3.Cmp, 0, len(ccmps))
+	for _, cmp := range ccmps {
+		goKey := C.GoStringN(cmp.key, cmp.keyLen)
+		modRevision := int64(cmp.modRevision)
+		switch cmp.op {
+		case C.CmpEqual:
+			res = append(res, clientv3.Compare(
+				clientv3.ModRevision(goKey), "=", modRevision))
+		case C.CmpNotEqual:
+			res = append(res, clientv3.Compare(
+				clientv3.ModRevision(goKey), "!=", modRevision))
+		default:
+			log.Printf("compareOp:%v do not exist", cmp.op)
+			return res, errors.New("compareOp do not exist")
+		}
+	}
+	return res, nil
+}
+
 func GetErrCode(op string, err error) C.enum_EtcdErrCode {
 	errCode := codes.Unknown
 	if entity, ok := err.(rpctypes.EtcdError); ok {
@@ -249,7 +286,7 @@ func EtcdClientPutRewtihRevision(timeout C.int, key, value *C.char,
 
 //export EtcdClientGet
 func EtcdClientGet(timeout C.int, key *C.char,
-	keyLen C.int) (C.enum_EtcdErrCode, *C.char, int, int64) {
+	keyLen C.int) (C.enum_EtcdErrCode, *C.char, int, int64, int64) {
 	goKey := C.GoStringN(key, keyLen)
 	ctx, cancel := context.WithTimeout(context.Background(),
 		time.Duration(int(timeout))*time.Millisecond)
@@ -258,17 +295,18 @@ func EtcdClientGet(timeout C.int, key *C.char,
 	resp, err := globalClient.Get(ctx, goKey)
 	errCode := GetErrCode(EtcdGet, err)
 	if errCode != C.EtcdOK {
-		return errCode, nil, 0, 0
+		return errCode, nil, 0, 0, 0
 	}
 
 	if resp.Count <= 0 {
-		return C.EtcdKeyNotExist, nil, 0, resp.Header.Revision
+		return C.EtcdKeyNotExist, nil, 0, resp.Header.Revision, 0
 	}
 
 	return errCode,
 		C.CString(string(resp.Kvs[0].Value)),
 		len(resp.Kvs[0].Value),
-		resp.Header.Revision
+		resp.Header.Revision,
+		resp.Kvs[0].ModRevision
 }
 
 // TODO(lixiaocui): list可能需要有长度限制
@@ -394,6 +432,59 @@ func EtcdClientTxn3(
 	return GetErrCode(EtcdTxn3, err)
 }
 
+//export EtcdClientTxnNRewithRevision
+func EtcdClientTxnNRewithRevision(timeout C.int, cops *C.struct_Operation,
+	opNum C.int) (C.enum_EtcdErrCode, int64) {
+	ops := (*[1 << 20]C.struct_Operation)(unsafe.Pointer(cops))[:opNum:opNum]
+	etcdOps, err := GenOpList(ops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).Then(etcdOps...).Commit()
+	if err == nil {
+		return GetErrCode(EtcdTxnN, err), resp.Header.Revision
+	}
+	return GetErrCode(EtcdTxnN, err), 0
+}
+
+//export EtcdClientTxnNWithCompare
+func EtcdClientTxnNWithCompare(timeout C.int, ccmps *C.struct_Compare,
+	cmpNum C.int, cops *C.struct_Operation,
+	opNum C.int) (C.enum_EtcdErrCode, int64) {
+	cmps := (*[1 << 20]C.struct_Compare)(unsafe.Pointer(ccmps))[:cmpNum:cmpNum]
+	ops := (*[1 << 20]C.struct_Operation)(unsafe.Pointer(cops))[:opNum:opNum]
+	etcdCmps, err := GenCmpList(cmps)
+	if err != nil {
+		log.Printf("unknown compare types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+	etcdOps, err := GenOpList(ops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).
+		If(etcdCmps...).Then(etcdOps...).Commit()
+	if err != nil {
+		return GetErrCode(EtcdTxnN, err), 0
+	}
+	if !resp.Succeeded {
+		return C.EtcdTxnCompareFailed, resp.Header.Revision
+	}
+	return C.EtcdOK, resp.Header.Revision
+}
+
 //export EtcdClientCompareAndSwap
 func EtcdClientCompareAndSwap(timeout C.int, key, prev, target *C.char,
 	keyLen, preLen, targetLen C.int) C.enum_EtcdErrCode {